@@ -7,6 +7,15 @@ ELSE(DCMTK_WITH_PRIVATE_TAGS)
   MESSAGE(STATUS "Info: DCMTK's builtin private dictionary support will be disabled")
 ENDIF(DCMTK_WITH_PRIVATE_TAGS)
 
+# Memory arena allocation
+IF(DCMTK_WITH_ARENA_ALLOCATION)
+  SET(WITH_ARENA_ALLOCATION 1)
+  MESSAGE(STATUS "Info: DCMTK's memory arena allocation support will be enabled")
+ELSE(DCMTK_WITH_ARENA_ALLOCATION)
+  SET(WITH_ARENA_ALLOCATION "")
+  MESSAGE(STATUS "Info: DCMTK's memory arena allocation support will be disabled")
+ENDIF(DCMTK_WITH_ARENA_ALLOCATION)
+
 # Thread support
 IF(DCMTK_WITH_THREADS)
   SET(WITH_THREADS 1)
@@ -141,6 +150,7 @@ ENDIF(WIN32 AND NOT CYGWIN)
   CHECK_INCLUDE_FILE_CXX("ndir.h" HAVE_NDIR_H)
   CHECK_INCLUDE_FILE_CXX("netdb.h" HAVE_NETDB_H)
   CHECK_INCLUDE_FILE_CXX("new.h" HAVE_NEW_H)
+  CHECK_INCLUDE_FILE_CXX("poll.h" HAVE_POLL_H)
   CHECK_INCLUDE_FILE_CXX("pwd.h" HAVE_PWD_H)
   CHECK_INCLUDE_FILE_CXX("semaphore.h" HAVE_SEMAPHORE_H)
   CHECK_INCLUDE_FILE_CXX("setjmp.h" HAVE_SETJMP_H)
@@ -164,6 +174,7 @@ ENDIF(WIN32 AND NOT CYGWIN)
   CHECK_INCLUDE_FILE_CXX("sys/errno.h" HAVE_SYS_ERRNO_H)
   CHECK_INCLUDE_FILE_CXX("sys/dir.h" HAVE_SYS_DIR_H)
   CHECK_INCLUDE_FILE_CXX("sys/file.h" HAVE_SYS_FILE_H)
+  CHECK_INCLUDE_FILE_CXX("sys/mman.h" HAVE_SYS_MMAN_H)
   CHECK_INCLUDE_FILE_CXX("sys/ndir.h" HAVE_SYS_NDIR_H)
   CHECK_INCLUDE_FILE_CXX("sys/param.h" HAVE_SYS_PARAM_H)
   CHECK_INCLUDE_FILE_CXX("sys/resource.h" HAVE_SYS_RESOURCE_H)
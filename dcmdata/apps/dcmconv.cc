@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -36,6 +36,7 @@
 #include "dcmtk/dcmdata/dcuid.h"       /* for dcmtk version name */
 #include "dcmtk/dcmdata/dcostrmz.h"    /* for dcmZlibCompressionLevel */
 #include "dcmtk/dcmdata/dcistrmz.h"    /* for dcmZlibExpectRFC1950Encoding */
+#include "dcmtk/dcmdata/dcistrmf.h"    /* for dcmUseMemoryMappedFiles */
 
 #ifdef WITH_ZLIB
 #include <zlib.h>                      /* for zlibVersion() */
@@ -104,6 +105,7 @@ int main(int argc, char *argv[])
   OFCmdUnsignedInt opt_itempad = 0;
 #ifdef WITH_ZLIB
   OFCmdUnsignedInt opt_compressionLevel = 0;
+  OFCmdUnsignedInt opt_compressionThreads = 1;
 #endif
 #ifdef WITH_LIBICONV
   const char *opt_convertToCharset = NULL;
@@ -166,6 +168,11 @@ int main(int argc, char *argv[])
     cmd.addSubGroup("other parsing options:");
       cmd.addOption("--stop-after-elem",     "+st", 1, "[t]ag: \"gggg,eeee\" or dictionary name",
                                                        "stop parsing after element specified by t");
+#ifdef HAVE_SYS_MMAN_H
+    cmd.addSubGroup("file access:");
+      cmd.addOption("--read-stdio",          "-mm",    "read input files with stdio (default)");
+      cmd.addOption("--memory-map",          "+mm",    "map input files into memory");
+#endif
     cmd.addSubGroup("automatic data correction:");
       cmd.addOption("--enable-correction",   "+dc",    "enable automatic data correction (default)");
       cmd.addOption("--disable-correction",  "-dc",    "disable automatic data correction");
@@ -223,6 +230,9 @@ int main(int argc, char *argv[])
     cmd.addSubGroup("deflate compression level (only with --write-xfer-deflated):");
       cmd.addOption("--compression-level",   "+cl", 1, "[l]evel: integer (default: 6)",
                                                        "0=uncompressed, 1=fastest, 9=best compression");
+    cmd.addSubGroup("deflate multi-threading (only with --write-xfer-deflated):");
+      cmd.addOption("--compression-threads", "+ct", 1, "[n]umber: integer (default: 1)",
+                                                       "compress blocks of data using n threads");
 #endif
 
     /* evaluate command line */
@@ -396,6 +406,13 @@ int main(int argc, char *argv[])
           app.printError("no valid key given for option --stop-after-elem");
       }
 
+#ifdef HAVE_SYS_MMAN_H
+      cmd.beginOptionBlock();
+      if (cmd.findOption("--read-stdio")) dcmUseMemoryMappedFiles.set(OFFalse);
+      if (cmd.findOption("--memory-map")) dcmUseMemoryMappedFiles.set(OFTrue);
+      cmd.endOptionBlock();
+#endif
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--enable-correction"))
       {
@@ -508,6 +525,12 @@ int main(int argc, char *argv[])
         app.checkValue(cmd.getValueAndCheckMinMax(opt_compressionLevel, 0, 9));
         dcmZlibCompressionLevel.set(OFstatic_cast(int, opt_compressionLevel));
       }
+      if (cmd.findOption("--compression-threads"))
+      {
+        app.checkDependence("--compression-threads", "--write-xfer-deflated", opt_oxfer == EXS_DeflatedLittleEndianExplicit);
+        app.checkValue(cmd.getValueAndCheckMin(opt_compressionThreads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+        dcmZlibCompressionThreads.set(OFstatic_cast(Uint32, opt_compressionThreads));
+      }
 #endif
     }
 
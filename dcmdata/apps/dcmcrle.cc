@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -78,6 +78,7 @@ int main(int argc, char *argv[])
   OFBool           opt_createOffsetTable = OFTrue;
   OFBool           opt_uidcreation = OFFalse;
   OFBool           opt_secondarycapture = OFFalse;
+  OFCmdUnsignedInt opt_threads = 1;
 
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "Encode DICOM file to RLE transfer syntax", rcsid);
   OFCommandLine cmd;
@@ -121,6 +122,10 @@ int main(int argc, char *argv[])
       cmd.addOption("--uid-never",           "+un",    "never assign new UID (default)");
       cmd.addOption("--uid-always",          "+ua",    "always assign new UID");
 
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",             "+mt", 1, "[n]umber: integer (default: 1)",
+                                                       "use n threads for compressing the frames\nand byte segments of an image");
+
   cmd.addGroup("output options:");
     cmd.addSubGroup("post-1993 value representations:");
       cmd.addOption("--enable-new-vr",       "+u",     "enable support for new VRs (UN/UT) (default)");
@@ -218,6 +223,9 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--uid-never")) opt_uidcreation = OFFalse;
       cmd.endOptionBlock();
 
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMin(opt_threads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--enable-new-vr")) dcmEnableGenerationOfNewVRs();
       if (cmd.findOption("--disable-new-vr")) dcmDisableGenerationOfNewVRs();
@@ -251,7 +259,8 @@ int main(int argc, char *argv[])
 
     // register RLE compression codec
     DcmRLEEncoderRegistration::registerCodecs(opt_uidcreation,
-      OFstatic_cast(Uint32, opt_fragmentSize), opt_createOffsetTable, opt_secondarycapture);
+      OFstatic_cast(Uint32, opt_fragmentSize), opt_createOffsetTable, opt_secondarycapture,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
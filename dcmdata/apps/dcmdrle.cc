@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -77,6 +77,7 @@ int main(int argc, char *argv[])
   // RLE parameters
   OFBool opt_uidcreation = OFFalse;
   OFBool opt_reversebyteorder = OFFalse;
+  OFCmdUnsignedInt opt_threads = 1;
 
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "Decode RLE-compressed DICOM file", rcsid);
   OFCommandLine cmd;
@@ -104,6 +105,9 @@ int main(int argc, char *argv[])
     cmd.addSubGroup("RLE byte segment order:");
       cmd.addOption("--byte-order-default",  "+bd",    "most significant byte first (default)");
       cmd.addOption("--byte-order-reverse",  "+br",    "least significant byte first");
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",             "+mt", 1, "[n]umber: integer (default: 1)",
+                                                       "use n threads for decompressing the frames\nand byte segments of an image");
 
   cmd.addGroup("output options:");
     cmd.addSubGroup("output file format:");
@@ -166,6 +170,9 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--byte-order-reverse")) opt_reversebyteorder = OFTrue;
       cmd.endOptionBlock();
 
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMin(opt_threads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--read-file"))
       {
@@ -232,7 +239,8 @@ int main(int argc, char *argv[])
     OFLOG_DEBUG(dcmdrleLogger, rcsid << OFendl);
 
     // register global decompression codecs
-    DcmRLEDecoderRegistration::registerCodecs(opt_uidcreation, opt_reversebyteorder);
+    DcmRLEDecoderRegistration::registerCodecs(opt_uidcreation, opt_reversebyteorder,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -28,6 +28,7 @@
 #include "dcmtk/ofstd/ofstd.h"
 #include "dcmtk/dcmdata/dcuid.h"      /* for dcmtk version name */
 #include "dcmtk/dcmdata/dcistrmz.h"   /* for dcmZlibExpectRFC1950Encoding */
+#include "dcmtk/dcmdata/dcistrmf.h"   /* for dcmUseMemoryMappedFiles */
 
 #define INCLUDE_CSTDLIB
 #define INCLUDE_CSTRING
@@ -82,6 +83,7 @@ static const int MAX_PRINT_TAG_NAMES = 1024;
 static const char *printTagNames[MAX_PRINT_TAG_NAMES];
 static const DcmTagKey *printTagKeys[MAX_PRINT_TAG_NAMES];
 static OFCmdUnsignedInt maxReadLength = 4096; // default is 4 KB
+static DcmTagKey stopParsingAtElement = DCM_UndefinedTagKey; // default is to parse all elements
 static size_t fileCounter = 0;
 
 
@@ -241,6 +243,13 @@ DCMTK_MAIN_FUNCTION
       cmd.addSubGroup("other parsing options:");
         cmd.addOption("--stop-after-elem",     "+st", 1, "[t]ag: \"gggg,eeee\" or dictionary name",
                                                          "stop parsing after element specified by t");
+        cmd.addOption("--stop-before-elem",    "+sb", 1, "[t]ag: \"gggg,eeee\" or dictionary name",
+                                                         "stop parsing before element specified by t\nor any following element");
+#ifdef HAVE_SYS_MMAN_H
+      cmd.addSubGroup("file access:");
+        cmd.addOption("--read-stdio",          "-mm",    "read input files with stdio (default)");
+        cmd.addOption("--memory-map",          "+mm",    "map input files into memory");
+#endif
       cmd.addSubGroup("automatic data correction:");
         cmd.addOption("--enable-correction",   "+dc",    "enable automatic data correction (default)");
         cmd.addOption("--disable-correction",  "-dc",    "disable automatic data correction");
@@ -476,6 +485,13 @@ DCMTK_MAIN_FUNCTION
       }
       cmd.endOptionBlock();
 
+#ifdef HAVE_SYS_MMAN_H
+      cmd.beginOptionBlock();
+      if (cmd.findOption("--read-stdio")) dcmUseMemoryMappedFiles.set(OFFalse);
+      if (cmd.findOption("--memory-map")) dcmUseMemoryMappedFiles.set(OFTrue);
+      cmd.endOptionBlock();
+#endif
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--enable-correction"))
       {
@@ -566,6 +582,15 @@ DCMTK_MAIN_FUNCTION
           app.printError("no valid key given for option --stop-after-elem");
       }
 
+      if (cmd.findOption("--stop-before-elem"))
+      {
+        const char *tagName = NULL;
+        app.checkValue(cmd.getValue(tagName));
+        stopParsingAtElement = parseTagKey(tagName);
+        if (stopParsingAtElement == DCM_UndefinedTagKey)
+          app.printError("no valid key given for option --stop-before-elem");
+      }
+
       if (cmd.findOption("--search", 0, OFCommandLine::FOM_FirstFromLeft))
       {
         const char *tagName = NULL;
@@ -736,7 +761,7 @@ static int dumpFile(STD_NAMESPACE ostream &out,
     DcmFileFormat dfile;
     DcmObject *dset = &dfile;
     if (readMode == ERM_dataset) dset = dfile.getDataset();
-    OFCondition cond = dfile.loadFile(ifname, xfer, EGL_noChange, OFstatic_cast(Uint32, maxReadLength), readMode);
+    OFCondition cond = dfile.loadFileUntilTag(ifname, xfer, EGL_noChange, OFstatic_cast(Uint32, maxReadLength), readMode, stopParsingAtElement);
     if (cond.bad())
     {
         OFLOG_ERROR(dcmdumpLogger, OFFIS_CONSOLE_APPLICATION << ": " << cond.text()
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -183,6 +183,9 @@ DCMTK_MAIN_FUNCTION
         cmd.addOption("--default-icon",          "-Xd", 1, "[f]ilename: string",
                                                            "use specified PGM image if icon cannot be\ncreated automatically (default: black image)");
 #endif
+      cmd.addSubGroup("multi-threading:");
+        cmd.addOption("--threads",               "+mt", 1, "[n]umber: integer (default: 1)",
+                                                           "use n threads for loading and checking the\ninput files");
     cmd.addGroup("output options:");
       cmd.addSubGroup("DICOMDIR file:");
         cmd.addOption("--output-file",           "+D",  1, "[f]ilename: string",
@@ -356,6 +359,13 @@ DCMTK_MAIN_FUNCTION
         }
 #endif
 
+        if (cmd.findOption("--threads"))
+        {
+            OFCmdUnsignedInt numThreads = 1;
+            app.checkValue(cmd.getValueAndCheckMin(numThreads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+            ddir.setNumberOfThreads(OFstatic_cast(unsigned int, numThreads));
+        }
+
         /* output options */
         if (cmd.findOption("--output-file"))
             app.checkValue(cmd.getValue(opt_output));
@@ -563,26 +573,9 @@ DCMTK_MAIN_FUNCTION
         {
             /* collect 'bad' files */
             OFList<OFFilename> badFiles;
-            unsigned int goodFiles = 0;
-            OFListIterator(OFFilename) iter = fileNames.begin();
-            OFListIterator(OFFilename) last = fileNames.end();
-            /* iterate over all input filenames */
-            while ((iter != last) && result.good())
-            {
-                /* add files to the DICOMDIR */
-                result = ddir.addDicomFile((*iter), opt_directory);
-                if (result.bad())
-                {
-                    badFiles.push_back(*iter);
-                    if (!ddir.abortMode())
-                    {
-                        /* ignore inconsistent file, just warn (already done inside "ddir") */
-                        result = EC_Normal;
-                    }
-                } else
-                    ++goodFiles;
-                ++iter;
-            }
+            unsigned long goodFiles = 0;
+            /* add all input files to the DICOMDIR (inconsistent files are reported inside "ddir") */
+            result = ddir.addDicomFiles(fileNames, opt_directory, badFiles, goodFiles);
             /* evaluate result of file checking/adding procedure */
             if (goodFiles == 0)
             {
@@ -593,8 +586,8 @@ DCMTK_MAIN_FUNCTION
             {
                 OFOStringStream oss;
                 oss << badFiles.size() << " file(s) cannot be added to DICOMDIR: ";
-                iter = badFiles.begin();
-                last = badFiles.end();
+                OFListIterator(OFFilename) iter = badFiles.begin();
+                OFListIterator(OFFilename) last = badFiles.end();
                 while (iter != last)
                 {
                     oss << OFendl << "  " << (*iter);
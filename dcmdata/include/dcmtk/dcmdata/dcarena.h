@@ -0,0 +1,280 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: classes DcmMemoryArena, DcmMemoryArenaScope and DcmMemoryArenaObject
+ *
+ */
+
+#ifndef DCARENA_H
+#define DCARENA_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+#include "dcmtk/ofstd/oftypes.h"     /* for OFBool */
+#include "dcmtk/dcmdata/dcdefine.h"   /* for DCMTK_DCMDATA_EXPORT */
+
+#define INCLUDE_CSTDDEF               /* for size_t */
+#define INCLUDE_NEW                   /* for std::nothrow_t */
+#include "dcmtk/ofstd/ofstdinc.h"
+
+#if defined(HAVE_SYNC_ADD_AND_FETCH) && defined(HAVE_SYNC_SUB_AND_FETCH)
+#define DCMTK_ARENA_COUNTER_TYPE size_t
+#elif defined(HAVE_INTERLOCKED_INCREMENT) && defined(HAVE_INTERLOCKED_DECREMENT)
+#define DCMTK_ARENA_COUNTER_TYPE volatile long
+#else
+#define DCMTK_ARENA_COUNTER_TYPE size_t
+#define DCMTK_ARENA_NEED_MUTEX 1
+#include "dcmtk/ofstd/ofthread.h"    /* for OFMutex */
+#endif
+
+/// default size of the memory blocks of a DcmMemoryArena (in bytes)
+const size_t DCM_DefaultArenaBlockSize = 65536;
+
+/** memory arena from which the objects of a DICOM dataset (elements, items,
+ *  sequences, list nodes) and their small element values can be allocated
+ *  while the dataset is being parsed. The memory is taken from a few large
+ *  blocks, which avoids a separate heap allocation for each of these objects,
+ *  and is returned to the heap in one go.
+ *  An arena is reference counted: the owner (e.g. a DcmDataset) holds one
+ *  reference and each allocation holds another one, which is given back when
+ *  the object is deleted. The blocks are freed as soon as the last reference
+ *  is released, i.e. objects that are removed from the dataset and kept by the
+ *  caller remain valid after the dataset has been deleted. Memory of deleted
+ *  objects is not reused before the whole arena is freed.
+ *  Allocations are only made from the arena that has been made the current
+ *  arena of the calling thread by means of a DcmMemoryArenaScope. The arena
+ *  must therefore not be current in more than one thread at the same time,
+ *  whereas objects allocated from it may be deleted in any thread.
+ */
+class DCMTK_DCMDATA_EXPORT DcmMemoryArena
+{
+public:
+
+  /** constructor. The reference count is initialized to 1, i.e. the caller
+   *  has to call release() when the arena is no longer needed.
+   *  @param blockSize size of the memory blocks (in bytes) that are allocated
+   *    from the heap
+   */
+  DcmMemoryArena(const size_t blockSize = DCM_DefaultArenaBlockSize);
+
+  /** allocate memory from this arena. Each allocation increases the reference
+   *  count of the arena, so it has to be given back by calling release().
+   *  @param size number of bytes to be allocated
+   *  @return pointer to memory aligned for any of the DICOM value types,
+   *    NULL if the memory could not be allocated
+   */
+  void *allocate(const size_t size);
+
+  /// increase the reference count of this arena
+  void addReference();
+
+  /** decrease the reference count of this arena. If the reference count
+   *  drops to zero, all memory blocks and the arena itself are deleted.
+   */
+  void release();
+
+  /** returns the maximum size of an element value that is allocated from this
+   *  arena. Larger values (e.g. pixel data) are allocated from the heap so that
+   *  their memory can be given back individually.
+   *  @return maximum value size in bytes
+   */
+  size_t getMaxValueSize() const
+  {
+    return blockSize_ / 8;
+  }
+
+  /** returns the arena that is current for the calling thread
+   *  @return pointer to current arena, NULL if none
+   */
+  static DcmMemoryArena *getCurrentArena();
+
+  /** allocate memory for a new DICOM object, either from the arena that is
+   *  current for the calling thread or from the heap. Used by the class
+   *  specific operator new of DcmMemoryArenaObject.
+   *  @param size number of bytes to be allocated
+   *  @param nothrow if OFTrue, NULL is returned in case of error. Otherwise,
+   *    std::bad_alloc is thrown like by the global operator new.
+   *  @return pointer to allocated memory
+   */
+  static void *allocateObject(const size_t size,
+                              const OFBool nothrow = OFFalse);
+
+  /** delete memory allocated with allocateObject()
+   *  @param ptr pointer to memory, may be NULL
+   */
+  static void deleteObject(void *ptr);
+
+private:
+
+  friend class DcmMemoryArenaScope;
+
+  /// destructor, frees all memory blocks. Called by release().
+  ~DcmMemoryArena();
+
+  /** make the given arena current for the calling thread
+   *  @param arena pointer to arena, NULL for none
+   */
+  static void setCurrentArena(DcmMemoryArena *arena);
+
+  /** allocate a new memory block and add it to the list of blocks
+   *  @param size size of the block (in bytes, excluding the block header)
+   *  @return pointer to first usable byte of the block, NULL in case of error
+   */
+  unsigned char *newBlock(const size_t size);
+
+  /// size of the memory blocks
+  size_t blockSize_;
+
+  /// list of allocated memory blocks, most recent one first
+  void *blocks_;
+
+  /// next free byte in the current memory block
+  unsigned char *current_;
+
+  /// number of free bytes in the current memory block
+  size_t remaining_;
+
+  /// reference count (owner plus number of live allocations)
+  DCMTK_ARENA_COUNTER_TYPE refCount_;
+
+#ifdef DCMTK_ARENA_NEED_MUTEX
+  /// mutex protecting the reference count
+  OFMutex mutex_;
+#endif
+
+  /// private undefined copy constructor
+  DcmMemoryArena(const DcmMemoryArena &);
+
+  /// private undefined copy assignment operator
+  DcmMemoryArena &operator=(const DcmMemoryArena &);
+};
+
+
+/** helper class that makes a memory arena current for the calling thread
+ *  during its lifetime, i.e. all DICOM objects created in this thread are
+ *  allocated from the arena. The previously current arena (if any) is
+ *  restored by the destructor.
+ */
+class DCMTK_DCMDATA_EXPORT DcmMemoryArenaScope
+{
+public:
+
+  /** constructor
+   *  @param arena arena to be made current. If NULL, the current arena of
+   *    the calling thread is not changed.
+   */
+  DcmMemoryArenaScope(DcmMemoryArena *arena);
+
+  /// destructor, restores the previously current arena
+  ~DcmMemoryArenaScope();
+
+private:
+
+  /// flag indicating whether the current arena has been changed
+  OFBool active_;
+
+  /// arena that was current before
+  DcmMemoryArena *previous_;
+
+  /// private undefined copy constructor
+  DcmMemoryArenaScope(const DcmMemoryArenaScope &);
+
+  /// private undefined copy assignment operator
+  DcmMemoryArenaScope &operator=(const DcmMemoryArenaScope &);
+};
+
+
+/** base class of all DICOM objects that can be allocated from a memory arena
+ *  (DcmObject, DcmList and DcmListNode). The class specific operators new and
+ *  delete take the memory from the arena that is current for the calling
+ *  thread (see DcmMemoryArenaScope) or from the heap if there is none.
+ *  The placement and nothrow forms are provided as well, since the class
+ *  specific operators hide the global ones.
+ *  Since these operators add a small header and a lookup of the current arena
+ *  to each allocation, they are only defined if DCMTK has been configured with
+ *  arena allocation support (WITH_ARENA_ALLOCATION). Otherwise, the global
+ *  operators are used and DcmDataset::setArenaAllocation() has no effect.
+ */
+class DCMTK_DCMDATA_EXPORT DcmMemoryArenaObject
+{
+public:
+
+#ifdef WITH_ARENA_ALLOCATION
+
+  /** allocate memory for a new object
+   *  @param size number of bytes to be allocated
+   *  @return pointer to allocated memory
+   */
+  static void *operator new(size_t size)
+  {
+    return DcmMemoryArena::allocateObject(size);
+  }
+
+  /** free memory of an object that was allocated with operator new
+   *  @param ptr pointer to memory
+   */
+  static void operator delete(void *ptr)
+  {
+    DcmMemoryArena::deleteObject(ptr);
+  }
+
+  /** placement new, constructs an object in the given memory
+   *  @param size number of bytes required (not used)
+   *  @param ptr pointer to memory
+   *  @return ptr
+   */
+  static void *operator new(size_t /* size */, void *ptr)
+  {
+    return ptr;
+  }
+
+  /** placement delete, called if the constructor of a placement new throws
+   *  @param ptr pointer to memory (not used)
+   *  @param place pointer to memory (not used)
+   */
+  static void operator delete(void * /* ptr */, void * /* place */)
+  {
+  }
+
+#ifdef HAVE_STD__NOTHROW
+  /** allocate memory for a new object, returns NULL in case of error
+   *  @param size number of bytes to be allocated
+   *  @return pointer to allocated memory, NULL in case of error
+   */
+  static void *operator new(size_t size, const std::nothrow_t &)
+  {
+    return DcmMemoryArena::allocateObject(size, OFTrue /* nothrow */);
+  }
+
+  /** free memory of an object that was allocated with the nothrow form of
+   *  operator new. Called if the constructor throws.
+   *  @param ptr pointer to memory
+   */
+  static void operator delete(void *ptr, const std::nothrow_t &)
+  {
+    DcmMemoryArena::deleteObject(ptr);
+  }
+#endif
+
+#endif /* WITH_ARENA_ALLOCATION */
+
+protected:
+
+  /// protected constructor, only derived classes can be instantiated
+  DcmMemoryArenaObject() { }
+};
+
+#endif
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1997-2011, OFFIS e.V.
+ *  Copyright (C) 1997-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -101,6 +101,34 @@ public:
     const DcmCodecParameter * cp,
     const DcmStack& objStack) const = 0;
 
+  /** decompresses the given pixel sequence and stores the result in the given
+   *  uncompressedPixelData element, taking into account a representation parameter
+   *  for the uncompressed representation, which allows for passing options to a
+   *  single decompression (e.g. a reduced resolution). The default implementation
+   *  ignores this parameter and calls decode(). If a representation parameter is
+   *  given, the caller removes the compressed representations after a successful
+   *  decompression, since the result may differ from them.
+   *  @param fromRepParam current representation parameter of compressed data, may be NULL
+   *  @param pixSeq compressed pixel sequence
+   *  @param uncompressedPixelData uncompressed pixel data stored in this element
+   *  @param cp codec parameters for this codec
+   *  @param objStack stack pointing to the location of the pixel data
+   *    element in the current dataset.
+   *  @param toRepParam representation parameter for the uncompressed representation,
+   *    may be NULL
+   *  @return EC_Normal if successful, an error code otherwise.
+   */
+  virtual OFCondition decodeToRepresentation(
+    const DcmRepresentationParameter * fromRepParam,
+    DcmPixelSequence * pixSeq,
+    DcmPolymorphOBOW& uncompressedPixelData,
+    const DcmCodecParameter * cp,
+    const DcmStack& objStack,
+    const DcmRepresentationParameter * /* toRepParam */) const
+  {
+    return decode(fromRepParam, pixSeq, uncompressedPixelData, cp, objStack);
+  }
+
   /** decompresses a single frame from the given pixel sequence and
    *  stores the result in the given buffer.
    *  @param fromParam representation parameter of current compressed
@@ -336,8 +364,8 @@ public:
     const DcmCodecParameter *aCodecParameter);
 
   /** looks for a codec that is able to decode from the given transfer syntax
-   *  and calls the decode() method of the codec.  A read lock on the list of
-   *  codecs is acquired until this method returns.
+   *  and calls the decodeToRepresentation() method of the codec.  A read lock on
+   *  the list of codecs is acquired until this method returns.
    *  @param fromType transfer syntax to decode from
    *  @param fromParam representation parameter of current compressed
    *    representation, may be NULL.
@@ -345,6 +373,8 @@ public:
    *  @param uncompressedPixelData uncompressed pixel data stored in this element
    *  @param pixelStack stack pointing to the location of the pixel data
    *    element in the current dataset.
+   *  @param toParam representation parameter for the uncompressed representation,
+   *    may be NULL.
    *  @return EC_Normal if successful, an error code otherwise.
    */
   static OFCondition decode(
@@ -352,7 +382,8 @@ public:
     const DcmRepresentationParameter * fromParam,
     DcmPixelSequence * fromPixSeq,
     DcmPolymorphOBOW& uncompressedPixelData,
-    DcmStack & pixelStack);
+    DcmStack & pixelStack,
+    const DcmRepresentationParameter * toParam = NULL);
 
   /** looks for a codec that is able to decode from the given transfer syntax
    *  and calls the decodeFrame() method of the codec.  A read lock on the list of
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -128,6 +128,24 @@ class DCMTK_DCMDATA_EXPORT DcmDataset
      */
     virtual void updateOriginalXfer();
 
+    /** enable or disable the allocation from a memory arena for subsequent calls of
+     *  read() and loadFile(), also if called by DcmFileFormat. If enabled, all elements,
+     *  items and sequences created while parsing the dataset as well as their values
+     *  (except for large ones like pixel data) are allocated from a few large memory
+     *  blocks, which are freed in one go when the dataset and all objects read into it
+     *  have been deleted. This is much faster than allocating each object separately,
+     *  but the memory of objects that are deleted or replaced earlier is not reused,
+     *  so it is most useful for datasets that are read once and not modified much.
+     *  Each new read operation uses a new arena. The meta header of a DICOM file is
+     *  always allocated from the heap. See DcmMemoryArena for details.
+     *  This method has no effect unless DCMTK has been compiled with arena
+     *  allocation support (WITH_ARENA_ALLOCATION).
+     *  @param enable enable arena allocation if OFTrue, disable it otherwise (default)
+     *  @param blockSize size of the memory blocks of the arena (in bytes)
+     */
+    void setArenaAllocation(const OFBool enable,
+                            const size_t blockSize = DCM_DefaultArenaBlockSize);
+
     /** print all elements of the dataset to a stream
      *  @param out output stream
      *  @param flags optional flag used to customize the output (see DCMTypes::PF_xxx)
@@ -183,6 +201,30 @@ class DCMTK_DCMDATA_EXPORT DcmDataset
                              const E_GrpLenEncoding glenc = EGL_noChange,
                              const Uint32 maxReadLength = DCM_MaxReadLength);
 
+    /** This function reads the information of all attributes which
+     *  are captured in the input stream and captures this information
+     *  in this->elementList, up to the attribute specified by
+     *  stopParsingAtElement (see DcmItem::readUntilTag() for details).
+     *  Having read all information for this particular data set or command,
+     *  this function will also take care of group length (according to what
+     *  is specified in glenc) and padding elements (don't change anything).
+     *  @param inStream      The stream which contains the information.
+     *  @param xfer          The transfer syntax which was used to encode
+     *                       the information in inStream.
+     *  @param glenc         Encoding type for group length; specifies what
+     *                       will be done with group length tags.
+     *  @param maxReadLength Maximum read length for reading an attribute value.
+     *  @param stopParsingAtElement parsing of the input stream is stopped when
+     *                       this tag key or any following tag is encountered
+     *                       (DCM_UndefinedTagKey for reading all attributes).
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition readUntilTag(DcmInputStream &inStream,
+                                     const E_TransferSyntax xfer = EXS_Unknown,
+                                     const E_GrpLenEncoding glenc = EGL_noChange,
+                                     const Uint32 maxReadLength = DCM_MaxReadLength,
+                                     const DcmTagKey &stopParsingAtElement = DCM_UndefinedTagKey);
+
     /** write dataset to a stream
      *  @param outStream DICOM output stream
      *  @param oxfer output transfer syntax (EXS_Unknown means use original)
@@ -273,6 +315,31 @@ class DCMTK_DCMDATA_EXPORT DcmDataset
                                  const E_GrpLenEncoding groupLength = EGL_noChange,
                                  const Uint32 maxReadLength = DCM_MaxReadLength);
 
+    /** load object from a DICOM file, but stop parsing at the specified element.
+     *  This is useful if only the first attributes of a (large) file are needed,
+     *  e.g. for indexing purposes: parsing stops as soon as an attribute with a tag
+     *  greater than or equal to stopParsingAtElement is encountered on the main
+     *  dataset level, so the rest of the file (e.g. the pixel data) is not read.
+     *  This method only supports DICOM objects stored as a dataset, i.e. without meta header.
+     *  Use DcmFileFormat::loadFileUntilTag() to load files with meta header.
+     *  @param fileName name of the file to load (may contain wide chars if support enabled).
+     *    Since there are various constructors for the OFFilename class, a "char *", "OFString"
+     *    or "wchar_t *" can also be passed directly to this parameter.
+     *  @param readXfer transfer syntax used to read the data (auto detection if EXS_Unknown)
+     *  @param groupLength flag, specifying how to handle the group length tags
+     *  @param maxReadLength maximum number of bytes to be read for an element value.
+     *    Element values with a larger size are not loaded until their value is retrieved
+     *    (with getXXX()) or loadAllDataIntoMemory() is called.
+     *  @param stopParsingAtElement parsing of the DICOM file is stopped when this tag key
+     *    or any following tag is encountered (DCM_UndefinedTagKey for reading all attributes)
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition loadFileUntilTag(const OFFilename &fileName,
+                                         const E_TransferSyntax readXfer = EXS_Unknown,
+                                         const E_GrpLenEncoding groupLength = EGL_noChange,
+                                         const Uint32 maxReadLength = DCM_MaxReadLength,
+                                         const DcmTagKey &stopParsingAtElement = DCM_UndefinedTagKey);
+
     /** save object to a DICOM file.
      *  This method only supports DICOM objects stored as a dataset, i.e. without meta header.
      *  Use DcmFileFormat::saveFile() to save files with meta header.
@@ -301,7 +368,12 @@ class DCMTK_DCMDATA_EXPORT DcmDataset
      *  and create the representation if needed. This may cause compression or decompression
      *  to be applied to the pixel data in the dataset.
      *  @param repType desired transfer syntax
-     *  @param repParam desired representation parameter (e.g. quality factor for lossy compression)
+     *  @param repParam desired representation parameter (e.g. quality factor for lossy compression,
+     *    or options for the decompression such as a reduced resolution, see DJ_RPReducedResolution).
+     *    Options for the decompression cannot be applied to pixel data that has already been
+     *    decompressed (EC_CannotChangeRepresentation is returned), and they are ignored for pixel
+     *    data without compressed representation. After a decompression with such options, the
+     *    compressed representations are removed, since they may no longer match the dataset.
      *  @return EC_Normal upon success, an error code otherwise.
      */
     OFCondition chooseRepresentation(const E_TransferSyntax repType,
@@ -339,6 +411,10 @@ class DCMTK_DCMDATA_EXPORT DcmDataset
     E_TransferSyntax OriginalXfer;
     /// current transfer syntax of the dataset
     E_TransferSyntax CurrentXfer;
+    /// block size of the memory arena used for reading (0 = no arena allocation)
+    size_t ArenaBlockSize;
+    /// memory arena used for the last read operation (NULL if none)
+    DcmMemoryArena *Arena;
 };
 
 
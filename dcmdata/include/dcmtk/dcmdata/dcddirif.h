@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -26,6 +26,7 @@
 #include "dcmtk/config/osconfig.h"
 
 #include "dcmtk/dcmdata/dcdicdir.h"
+#include "dcmtk/ofstd/oflist.h"
 
 
 /*------------------------------------*
@@ -38,6 +39,14 @@
 #define DEFAULT_DESCRIPTOR_CHARSET "ISO_IR 100"
 
 
+/*------------------------*
+ *  forward declarations  *
+ *------------------------*/
+
+class DicomDirFileLoader;
+class DicomDirRecordIndex;
+
+
 /*----------------------*
  *  class declarations  *
  *----------------------*/
@@ -295,6 +304,26 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
     OFCondition addDicomFile(const OFFilename &filename,
                              const OFFilename &directory = OFFilename());
 
+    /** add specified DICOM files to the current DICOMDIR.
+     *  The result is the same as calling addDicomFile() for each file in the order of the
+     *  list.  However, if more than one thread is enabled (see setNumberOfThreads()), the
+     *  files are loaded and checked by a number of worker threads in advance, while the
+     *  directory records are still created by the calling thread in the order of the list.
+     *  Files that cannot be added are appended to 'badFiles'.  If the "abort on first
+     *  error" mode is enabled, processing stops with the first of these files.
+     *  @param filenames list of DICOM files to be added
+     *  @param directory directory where the DICOM files are stored (optional).
+     *    See addDicomFile() for details.
+     *  @param badFiles list to which the names of files that cannot be added are appended
+     *  @param goodFiles number of files that have been added successfully (return value)
+     *  @return EC_Normal upon success, an error code otherwise (e.g. if the "abort on
+     *    first error" mode is enabled and one of the files cannot be added)
+     */
+    OFCondition addDicomFiles(const OFList<OFFilename> &filenames,
+                              const OFFilename &directory,
+                              OFList<OFFilename> &badFiles,
+                              unsigned long &goodFiles);
+
     /** set the fileset descriptor file ID and character set.
      *  Prior to any internal modification both 'filename' and 'charset' are checked
      *  using the above checking routines.  Existence of 'filename' is not checked.
@@ -434,6 +463,23 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
         return ConsistencyCheck;
     }
 
+    /** get number of threads used to load and check DICOM files.
+     *  See setNumberOfThreads() for more details.
+     *  @return number of threads
+     */
+    unsigned int numberOfThreads() const
+    {
+        return NumberOfThreads;
+    }
+
+    /** set number of threads used by addDicomFiles() to load and check DICOM files.
+     *  This setting is only used if DCMTK is compiled with thread support.
+     *  Default: 1, load and check all files in the calling thread
+     *  @param numThreads number of threads (0 is treated like 1)
+     *  @return previously stored value
+     */
+    unsigned int setNumberOfThreads(const unsigned int numThreads);
+
     /** enable/disable the "abort on first error" mode.
      *  If the mode is enabled addDicomFile() reports an error message and
      *  returns with an error status code if something went wrong.
@@ -587,6 +633,16 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
                                       DcmFileFormat &fileformat,
                                       const OFBool checkFilename = OFTrue);
 
+    /** add DICOM file that has already been loaded and checked to the current DICOMDIR
+     *  @param filename name of the DICOM file to be added
+     *  @param directory directory where the DICOM file is stored (optional)
+     *  @param fileformat object in which the loaded data is stored
+     *  @return EC_Normal upon success, an error code otherwise
+     */
+    OFCondition addCheckedDicomFile(const OFFilename &filename,
+                                    const OFFilename &directory,
+                                    DcmFileFormat &fileformat);
+
     /** check SOP class and transfer syntax for compliance with current profile
      *  @param metainfo object where the DICOM file meta information is stored
      *  @param dataset object where the DICOM dataset is stored
@@ -1485,9 +1541,15 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
 
   private:
 
+    /// the worker threads call the loadAndCheckDicomFile() method
+    friend class DicomDirFileLoader;
+
     /// pointer to the current DICOMDIR object
     DcmDicomDir *DicomDir;
 
+    /// index of the directory records for faster searching and sorted insertion
+    DicomDirRecordIndex *RecordIndex;
+
     /// pointer to the optional image plugin (required for icon image support)
     DicomDirImagePlugin *ImagePlugin;
 
@@ -1531,6 +1593,9 @@ class DCMTK_DCMDATA_EXPORT DicomDirInterface
     /// filename of the default icon (if any)
     OFFilename DefaultIcon;
 
+    /// number of threads used to load and check DICOM files
+    unsigned int NumberOfThreads;
+
     /// flag indicating whether RLE decompression is supported
     OFBool RLESupport;
     /// flag indicating whether JPEG decompression is supported
@@ -211,7 +211,9 @@ private:
  *  read and write access from multiple threads in parallel.
  *  A read/write lock is used to protect threads from each other.
  *  This allows parallel read-only access by multiple threads, which is
- *  the most common case.
+ *  the most common case. Once all dictionaries have been loaded, the
+ *  dictionary can be frozen (see freeze()), which turns it into a
+ *  read-only object that is accessed without any locking.
  */
 class DCMTK_DCMDATA_EXPORT GlobalDcmDataDictionary
 {
@@ -230,16 +232,47 @@ public:
    */
   const DcmDataDictionary& rdlock();
 
-  /** acquires a write lock and returns a non-const reference
-   *  to the dictionary.
-   *  @return non-const reference to dictionary.
+  /** acquires a write lock and returns a non-const pointer
+   *  to the dictionary. A frozen dictionary (see freeze()) must not be
+   *  modified, so calling this method after freeze() fails, i.e. an error
+   *  is logged and no lock is acquired. Calling unlock() is harmless
+   *  in this case.
+   *  @return non-const pointer to dictionary, NULL if dictionary is frozen
    */
-  DcmDataDictionary& wrlock();
+  DcmDataDictionary *wrlock();
 
   /** unlocks the read or write lock which must have been acquired previously.
    */
   void unlock();
 
+  /** makes the dictionary read-only. This method creates the dictionary (if
+   *  not yet done) and then disables the read/write lock, i.e. all subsequent
+   *  calls of rdlock() and unlock() do not perform any locking. This avoids
+   *  the locking overhead for each tag lookup in multi-threaded applications.
+   *  The dictionary must not be modified after this method has been called
+   *  (see wrlock()) unless it is made writable again by unfreeze().
+   *  The flag that marks the dictionary as frozen is not protected by any
+   *  lock, so this method must be called while the calling thread is the only
+   *  thread using DCMTK, i.e. before any additional threads are started, e.g.
+   *  after loading all required private dictionaries in main(). It must not
+   *  be called with another lock on the dictionary being held.
+   */
+  void freeze();
+
+  /** makes a frozen dictionary writable again, i.e. re-enables the read/write
+   *  lock. Like freeze(), this method must be called while the calling thread
+   *  is the only thread using DCMTK, e.g. after all threads that have been
+   *  started after freeze() have terminated.
+   */
+  void unfreeze();
+
+  /** checks whether the dictionary has been made read-only by freeze().
+   *  Since the dictionary can only be frozen before additional threads are
+   *  started, this method can be called from any thread without locking.
+   *  @return OFTrue if dictionary is frozen, OFFalse otherwise
+   */
+  OFBool isFrozen() const;
+
   /** checks if a data dictionary has been loaded. This method acquires and
    *  releases a read lock. It must not be called with another lock on the
    *  dictionary being held by the calling thread.
@@ -250,7 +283,8 @@ public:
   /** erases the contents of the dictionary. This method acquires and
    *  releases a write lock. It must not be called with another lock on the
    *  dictionary being held by the calling thread.  This method is intended
-   *  as a help for debugging memory leaks.
+   *  as a help for debugging memory leaks. A frozen dictionary can only be
+   *  cleared when no other threads are active any more, e.g. at the end of main().
    */
   void clear();
 
@@ -272,6 +306,11 @@ private:
    */
   DcmDataDictionary *dataDict;
 
+  /** true if the dictionary is read-only and accessed without locking.
+   *  Only modified by freeze() before any additional threads are started.
+   */
+  OFBool frozen;
+
 #ifdef WITH_THREADS
   /** the read/write lock used to protect access from multiple threads
    */
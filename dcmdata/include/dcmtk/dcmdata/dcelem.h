@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -427,7 +427,11 @@ class DCMTK_DCMDATA_EXPORT DcmElement
      *  over the element value, especially the value must be deleted from the
      *  heap after use. The DICOM element remains a copy of the value if the
      *  copy parameter is OFTrue; otherwise the value is erased in the DICOM
-     *  element.
+     *  element. Values that have been allocated from a memory arena (see
+     *  DcmDataset::setArenaAllocation()) can only be detached with copy being
+     *  OFTrue. In this case, the DICOM element uses a copy on the heap and the
+     *  previous value must not be deleted by the caller; it remains valid as
+     *  long as the memory arena exists.
      *  @param copy if true, copy value field before detaching; if false, do not
      *    retain a copy.
      *  @return EC_Normal upon success, an error code otherwise
@@ -807,6 +811,15 @@ class DCMTK_DCMDATA_EXPORT DcmElement
      */
     virtual Uint8 *newValueField();
 
+    /** allocate a buffer for the element value. Small buffers are taken from
+     *  the memory arena that is current for the calling thread (see
+     *  DcmMemoryArenaScope), all others from the heap. Must only be called if
+     *  the element currently has no value, e.g.\ from newValueField().
+     *  @param size number of bytes to be allocated
+     *  @return pointer to the buffer, NULL if it could not be allocated
+     */
+    Uint8 *newValueBuffer(const size_t size);
+
     /** swaps the content of the value field (if loaded) from big-endian to
      *  little-endian or back
      *  @param valueWidth width (in bytes) of each element value
@@ -863,6 +876,12 @@ class DCMTK_DCMDATA_EXPORT DcmElement
 
     /// value of the element
     Uint8 *fValue;
+
+    /// memory arena from which the value has been allocated (NULL if from the heap)
+    DcmMemoryArena *fValueArena;
+
+    /// delete the value of the element (if any) and set fValue to NULL
+    void deleteValueField();
 };
 
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -150,5 +150,8 @@ extern DCMTK_DCMDATA_EXPORT const unsigned short EC_CODE_CannotConvertCharacterS
 /// error, cannot convert to XML
 extern const unsigned short EC_CODE_CannotConvertToXML;
 
+/// error, cannot write file in the background (see DcmPipelinedFileConsumer)
+extern DCMTK_DCMDATA_EXPORT const unsigned short EC_CODE_PipelinedFileWriteFailed;
+
 
 #endif /* !DCERROR_H */
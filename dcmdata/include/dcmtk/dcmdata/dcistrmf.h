@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2012, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -24,8 +24,89 @@
 #define DCISTRMF_H
 
 #include "dcmtk/config/osconfig.h"
+#include "dcmtk/ofstd/ofglobal.h"
 #include "dcmtk/dcmdata/dcistrma.h"
 
+/** global flag defining whether DcmFileProducer maps files into memory
+ *  instead of reading them through stdio. Memory mapping avoids the
+ *  intermediate buffer of the C library and makes skipping large
+ *  attribute values (e.g. deferred loading of pixel data) free of any I/O.
+ *  It is only available on systems providing mmap(), otherwise this flag
+ *  is ignored. Note that the file must not be truncated by another process
+ *  while it is mapped. Default is false, i.e. stdio is used.
+ */
+extern DCMTK_DCMDATA_EXPORT OFGlobal<OFBool> dcmUseMemoryMappedFiles;
+
+
+/** class that manages a read-only memory mapping of a file. The mapping is
+ *  shared by all input streams and stream factories created for the same
+ *  file, e.g. for deferred loading of attribute values, and removed when
+ *  the last reference is released.
+ */
+class DCMTK_DCMDATA_EXPORT DcmFileMapping
+{
+public:
+
+  /** create a memory mapping of the given file
+   *  @param file file to be mapped, must be open. The file may be closed
+   *    after this call, the mapping remains valid.
+   *  @param size size of the file in bytes
+   *  @return pointer to new mapping with a reference counter of 1,
+   *    NULL if the file could not be mapped or mmap() is not available
+   */
+  static DcmFileMapping *newInstance(OFFile &file, offile_off_t size);
+
+  /// return pointer to the mapped file content
+  const Uint8 *data() const { return data_; }
+
+  /// return size of the mapped file content in bytes
+  offile_off_t size() const { return size_; }
+
+  /// increase reference counter for this object
+  void increaseRefCount();
+
+  /** decreases reference counter for this object and removes
+   *  the mapping and this object if the reference counter becomes zero.
+   */
+  void decreaseRefCount();
+
+private:
+
+  /** private constructor.
+   *  Instances of this class are always created through newInstance().
+   *  @param data pointer to the mapped file content
+   *  @param size size of the mapped file content in bytes
+   */
+  DcmFileMapping(const Uint8 *data, offile_off_t size);
+
+  /** private destructor. Instances of this class
+   *  are always deleted through the reference counting methods
+   */
+  ~DcmFileMapping();
+
+  /// private undefined copy constructor
+  DcmFileMapping(const DcmFileMapping& arg);
+
+  /// private undefined copy assignment operator
+  DcmFileMapping& operator=(const DcmFileMapping& arg);
+
+  /// pointer to the mapped file content
+  const Uint8 *data_;
+
+  /// size of the mapped file content in bytes
+  offile_off_t size_;
+
+  /** number of references to the mapping.
+   *  Default initialized to 1 upon construction of this object
+   */
+  size_t refCount_;
+
+#ifdef WITH_THREADS
+  /// mutex for MT-safe reference counting
+  OFMutex mutex_;
+#endif
+};
+
 
 /** producer class that reads data from a plain file.
  */
@@ -36,8 +117,11 @@ public:
    *  @param filename name of file to be opened (may contain wide chars
    *    if support enabled)
    *  @param offset byte offset to skip from the start of file
+   *  @param mapping existing memory mapping of the file, which is used
+   *    instead of opening the file again. If NULL, the file is opened and
+   *    mapped into memory if dcmUseMemoryMappedFiles is enabled.
    */
-  DcmFileProducer(const OFFilename &filename, offile_off_t offset = 0);
+  DcmFileProducer(const OFFilename &filename, offile_off_t offset = 0, DcmFileMapping *mapping = NULL);
 
   /// destructor
   virtual ~DcmFileProducer();
@@ -87,6 +171,11 @@ public:
    */
   virtual void putback(offile_off_t num);
 
+  /** returns the memory mapping of the file
+   *  @return pointer to memory mapping, NULL if the file is read with stdio
+   */
+  DcmFileMapping *mapping() const { return mapping_; }
+
 private:
 
   /// private unimplemented copy constructor
@@ -103,6 +192,15 @@ private:
 
   /// number of bytes in file
   offile_off_t size_;
+
+  /// memory mapping of the file, NULL if the file is read with stdio
+  DcmFileMapping *mapping_;
+
+  /// pointer to the memory mapped file content, NULL if the file is read with stdio
+  const Uint8 *mappedData_;
+
+  /// current read position within the memory mapped file content
+  offile_off_t mappedPos_;
 };
 
 
@@ -116,13 +214,16 @@ public:
    *  @param filename name of file to be opened (may contain wide chars
    *    if support enabled)
    *  @param offset byte offset to skip from the start of file
+   *  @param mapping memory mapping of the file to be used by all streams
+   *    created by this factory, may be NULL. The reference counter of the
+   *    mapping is increased by this operation.
    */
-  DcmInputFileStreamFactory(const OFFilename &filename, offile_off_t offset);
+  DcmInputFileStreamFactory(const OFFilename &filename, offile_off_t offset, DcmFileMapping *mapping = NULL);
 
   /// copy constructor
   DcmInputFileStreamFactory(const DcmInputFileStreamFactory &arg);
 
-  /// destructor
+  /// destructor, decreases reference counter of the memory mapping (if any)
   virtual ~DcmInputFileStreamFactory();
 
   /** create a new input stream object
@@ -149,6 +250,9 @@ private:
   /// offset in file
   offile_off_t offset_;
 
+  /// memory mapping of the file, may be NULL
+  DcmFileMapping *mapping_;
+
 };
 
 
@@ -161,8 +265,9 @@ public:
    *  @param filename name of file to be opened (may contain wide chars
    *    if support enabled)
    *  @param offset byte offset to skip from the start of file
+   *  @param mapping existing memory mapping of the file, may be NULL
    */
-  DcmInputFileStream(const OFFilename &filename, offile_off_t offset = 0);
+  DcmInputFileStream(const OFFilename &filename, offile_off_t offset = 0, DcmFileMapping *mapping = NULL);
 
   /// destructor
   virtual ~DcmInputFileStream();
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2011, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -128,6 +128,17 @@ private:
    */   
   offile_off_t decompress(const void *buf, offile_off_t buflen);
 
+  /** reads and decompresses data from the producer directly into the given
+   *  block until complete or the producer suspends, bypassing the output
+   *  ring buffer. The last bytes are copied to the output ring buffer
+   *  afterwards so that they can be putback. Requires the output ring
+   *  buffer to be empty.
+   *  @param buf pointer to memory block
+   *  @param buflen length of memory block
+   *  @return number of bytes decompressed
+   */
+  offile_off_t decompressDirect(unsigned char *buf, offile_off_t buflen);
+
   /** reads and decompresses data from the producer
    *  until the producer suspends or the output ring buffer becomes full.
    */
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2011, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -35,9 +35,13 @@
 /// index indicating "end of list"
 const unsigned long DCM_EndOfListIndex = OFstatic_cast(unsigned long, -1L);
 
+/// minimum number of list entries for which DcmList::seekTag() uses a sorted index
+const unsigned long DCM_ListTagIndexThreshold = 16;
+
 /** helper class maintaining an entry in a DcmList double-linked list
  */
-class DCMTK_DCMDATA_EXPORT DcmListNode 
+class DCMTK_DCMDATA_EXPORT DcmListNode
+  : public DcmMemoryArenaObject
 {
 
 public:
@@ -95,7 +99,8 @@ typedef enum
  *  The remove operation does not delete the object pointed to, however,
  *  the destructor will delete all elements pointed to
  */
-class DCMTK_DCMDATA_EXPORT DcmList 
+class DCMTK_DCMDATA_EXPORT DcmList
+  : public DcmMemoryArenaObject
 {
 public:
     /// constructor
@@ -149,6 +154,33 @@ public:
      */
     DcmObject *seek_to(unsigned long absolute_position);
 
+    /** seek within list to the element with the given tag key
+     *  (i.e. set current element to this element).
+     *  For lists with at least DCM_ListTagIndexThreshold entries, a binary search
+     *  on an index of the list nodes is performed. This index is created on demand
+     *  and updated by insertions and removals as long as the list stays sorted. If
+     *  the elements turn out not to be stored in strictly ascending tag order (as
+     *  maintained by DcmItem), or for short lists, a linear search from the start
+     *  of the list is performed.
+     *  @param tag tag key of the element to be searched
+     *  @return pointer to new current object if found, NULL otherwise (in this
+     *    case, the current element is undefined)
+     */
+    DcmObject *seekTag(const DcmTagKey &tag);
+
+    /** seek within list to the last element with a tag key that is less than or
+     *  equal to the given tag key (i.e. set current element to this element).
+     *  This is the position after which an element with the given tag key would
+     *  be inserted. The same index as for seekTag() is used, i.e. this method
+     *  only succeeds for lists with at least DCM_ListTagIndexThreshold entries
+     *  that are sorted in strictly ascending tag order.
+     *  @param tag tag key to be searched
+     *  @return OFTrue if the index could be used, OFFalse otherwise (in this case,
+     *    the current element is unchanged). If all elements have a greater tag
+     *    key, OFTrue is returned and there is no current element.
+     */
+    OFBool seekTagPosition(const DcmTagKey &tag);
+
     /** Remove and delete all elements from list. Thus, the 
      *  elements' memory is also freed by this operation. The list
      *  is empty after calling this function.
@@ -176,6 +208,50 @@ private:
 
     /// number of elements in list
     unsigned long cardinality;
+
+    /** (re-)create the tag index of the list nodes, used by seekTag()
+     *  @return OFTrue if the list is sorted in strictly ascending tag order and
+     *    the index could be created, OFFalse otherwise
+     */
+    OFBool createTagIndex();
+
+    /** check whether the tag index can be used for the current list, i.e. whether
+     *  the list is long enough and sorted. Creates the index if required.
+     *  @return OFTrue if the tag index is valid and can be used, OFFalse otherwise
+     */
+    OFBool useTagIndex();
+
+    /** determine the position of the first entry of the tag index with a tag key
+     *  that is not less than the given tag key (binary search)
+     *  @param tag tag key to be searched
+     *  @param count number of entries of the tag index to be searched
+     *  @return position within the tag index, count if all tag keys are less
+     */
+    unsigned long lowerBoundInTagIndex(const DcmTagKey &tag,
+                                       const unsigned long count) const;
+
+    /** add a node that has just been linked into the list to the tag index.
+     *  If the list is no longer sorted, the index is marked as invalid.
+     *  @param node list node that has been inserted (cardinality already updated)
+     */
+    void addToTagIndex(DcmListNode *node);
+
+    /** remove a node that is about to be unlinked from the list from the tag index
+     *  @param node list node to be removed (cardinality not yet updated)
+     */
+    void removeFromTagIndex(DcmListNode *node);
+
+    /// array of list nodes in list order, valid only if tagIndexValid is true
+    DcmListNode **tagIndex;
+
+    /// number of entries allocated for tagIndex
+    unsigned long tagIndexSize;
+
+    /// true if tagIndex reflects the current state of the list
+    OFBool tagIndexValid;
+
+    /// true if the list is known not to be sorted in strictly ascending tag order
+    OFBool tagIndexUnsorted;
  
     /// private undefined copy constructor 
     DcmList &operator=(const DcmList &);
@@ -0,0 +1,239 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DcmOutputPipelinedFileStream and related classes,
+ *    implements streamed output to files with a separate writer thread.
+ *
+ */
+
+#ifndef DCOSTRMP_H
+#define DCOSTRMP_H
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dcostrma.h"
+
+
+class OFMutex;
+class OFSemaphore;
+class DcmPipelinedFileWriter;
+
+/** default number of buffers used by DcmPipelinedFileConsumer
+ */
+#define DCM_PipelinedFileDefaultNumberOfBuffers 4
+
+/** default size of each buffer used by DcmPipelinedFileConsumer (256 kBytes)
+ */
+#define DCM_PipelinedFileDefaultBufferSize 262144
+
+
+/** consumer class that stores data in a plain file. The data passed to
+ *  write() is copied into one of a fixed number of buffers, and full buffers
+ *  are written to the file by a separate writer thread. Therefore, the caller
+ *  (e.g. a network receiver) only blocks if all buffers are waiting to be
+ *  written, and the memory consumption is limited to the number of buffers
+ *  multiplied by the buffer size, independent of the amount of data written.
+ *  If DCMTK is compiled without thread support (or if the writer thread
+ *  cannot be started), the data is written synchronously to the file.
+ */
+class DCMTK_DCMDATA_EXPORT DcmPipelinedFileConsumer: public DcmConsumer
+{
+public:
+  /** constructor
+   *  @param filename name of file to be created (may contain wide chars
+   *    if support enabled)
+   *  @param numberOfBuffers number of buffers, minimum is 2
+   *  @param bufferSize size of each buffer in bytes, must be larger than 0
+   */
+  DcmPipelinedFileConsumer(const OFFilename &filename,
+                           Uint32 numberOfBuffers = DCM_PipelinedFileDefaultNumberOfBuffers,
+                           Uint32 bufferSize = DCM_PipelinedFileDefaultBufferSize);
+
+  /// destructor, closes the file if not yet done
+  virtual ~DcmPipelinedFileConsumer();
+
+  /** returns the status of the consumer. Unless the status is good,
+   *  the consumer will not permit any operation. Errors that occur in
+   *  the writer thread are reported with a delay, i.e. by one of the
+   *  next calls of this method.
+   *  @return status, true if good
+   */
+  virtual OFBool good() const;
+
+  /** returns the status of the consumer as an OFCondition object.
+   *  Unless the status is good, the consumer will not permit any operation.
+   *  @return status, EC_Normal if good
+   */
+  virtual OFCondition status() const;
+
+  /** returns true if the consumer is flushed, i.e. has no more data
+   *  pending in it's internal state that needs to be flushed before
+   *  the stream is closed. Buffers that have already been handed over
+   *  to the writer thread are not considered as pending.
+   *  @return true if consumer is flushed, false otherwise
+   */
+  virtual OFBool isFlushed() const;
+
+  /** returns the minimum number of bytes that can be written with the
+   *  next call to write().
+   *  @return minimum of space available in consumer
+   */
+  virtual offile_off_t avail() const;
+
+  /** copies the given block into the buffers. Blocks if all buffers
+   *  are waiting to be written by the writer thread.
+   *  @param buf pointer to memory block, must not be NULL
+   *  @param buflen length of memory block
+   *  @return number of bytes actually processed.
+   */
+  virtual offile_off_t write(const void *buf, offile_off_t buflen);
+
+  /** hands over the partially filled buffer to the writer thread and
+   *  waits until all buffers have been written to the file.
+   */
+  virtual void flush();
+
+  /** writes all pending data, stops the writer thread and closes the file.
+   *  After a call to this method, no more data can be written. The caller
+   *  should always check the return value of this method since errors that
+   *  occur while writing the last buffers can only be reported here.
+   *  @return status, EC_Normal if all data has been written successfully
+   */
+  OFCondition close();
+
+private:
+
+  /// private unimplemented copy constructor
+  DcmPipelinedFileConsumer(const DcmPipelinedFileConsumer&);
+
+  /// private unimplemented copy assignment operator
+  DcmPipelinedFileConsumer& operator=(const DcmPipelinedFileConsumer&);
+
+  /// the writer thread needs access to the buffers
+  friend class DcmPipelinedFileWriter;
+
+  /** hands over the current buffer to the writer thread.
+   *  Must only be called from the producer side.
+   */
+  void submitBuffer();
+
+  /** writes the given block to the file and updates the status.
+   *  @param buf pointer to memory block
+   *  @param buflen length of memory block
+   *  @return number of bytes written
+   */
+  offile_off_t writeToFile(const void *buf, offile_off_t buflen);
+
+  /** main loop of the writer thread: writes buffers to the file until
+   *  an empty buffer is received.
+   */
+  void writeQueuedBuffers();
+
+  /** sets the status of the consumer (thread-safe).
+   *  @param cond new status
+   */
+  void setStatus(const OFCondition& cond);
+
+  /// deletes the buffers and synchronization objects
+  void deleteBuffers();
+
+  /// the file we're actually writing to
+  OFFile file_;
+
+  /// status, protected by statusMutex_ if the writer thread is running
+  OFCondition status_;
+
+  /// mutex protecting status_, NULL in synchronous mode
+  OFMutex *statusMutex_;
+
+  /// number of buffers
+  Uint32 numberOfBuffers_;
+
+  /// size of each buffer in bytes
+  Uint32 bufferSize_;
+
+  /// array of buffers, NULL in synchronous mode
+  Uint8 **buffers_;
+
+  /// number of bytes stored in each buffer that has been handed over
+  Uint32 *fillLevels_;
+
+  /// number of free buffers
+  OFSemaphore *freeBuffers_;
+
+  /// number of buffers waiting to be written
+  OFSemaphore *filledBuffers_;
+
+  /// index of the buffer currently filled by the producer
+  Uint32 producerIndex_;
+
+  /// index of the next buffer to be written by the writer thread
+  Uint32 writerIndex_;
+
+  /// true if the producer has acquired the buffer at producerIndex_
+  OFBool haveBuffer_;
+
+  /// number of bytes stored in the buffer at producerIndex_
+  Uint32 currentFill_;
+
+  /// writer thread, NULL in synchronous mode
+  DcmPipelinedFileWriter *writer_;
+
+  /// true if close() has been called
+  OFBool closed_;
+};
+
+
+/** output stream that writes into a plain file using a separate writer thread.
+ *  See DcmPipelinedFileConsumer for details.
+ */
+class DCMTK_DCMDATA_EXPORT DcmOutputPipelinedFileStream: public DcmOutputStream
+{
+public:
+  /** constructor
+   *  @param filename name of file to be created (may contain wide chars
+   *    if support enabled)
+   *  @param numberOfBuffers number of buffers, minimum is 2
+   *  @param bufferSize size of each buffer in bytes, must be larger than 0
+   */
+  DcmOutputPipelinedFileStream(const OFFilename &filename,
+                               Uint32 numberOfBuffers = DCM_PipelinedFileDefaultNumberOfBuffers,
+                               Uint32 bufferSize = DCM_PipelinedFileDefaultBufferSize);
+
+  /// destructor
+  virtual ~DcmOutputPipelinedFileStream();
+
+  /** flushes the stream, writes all pending data and closes the file.
+   *  The caller should always check the return value of this method since
+   *  errors that occur while writing the last buffers can only be reported here.
+   *  @return status, EC_Normal if all data has been written successfully
+   */
+  OFCondition close();
+
+private:
+
+  /// private unimplemented copy constructor
+  DcmOutputPipelinedFileStream(const DcmOutputPipelinedFileStream&);
+
+  /// private unimplemented copy assignment operator
+  DcmOutputPipelinedFileStream& operator=(const DcmOutputPipelinedFileStream&);
+
+  /// the final consumer of the filter chain
+  DcmPipelinedFileConsumer consumer_;
+};
+
+
+#endif
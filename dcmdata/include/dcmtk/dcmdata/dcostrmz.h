@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2011, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -38,6 +38,18 @@ END_EXTERN_C
  */
 extern DCMTK_DCMDATA_EXPORT OFGlobal<int> dcmZlibCompressionLevel;
 
+/** global flag defining the number of threads used for zlib (deflate)
+ *  compression. If greater than 1, the stream is split into blocks of 128 KB
+ *  that are compressed in parallel, each with the preceding 32 KB of data as
+ *  a preset dictionary. The result is still a single deflated bitstream that
+ *  can be decompressed by any inflater, but it differs from the output of a
+ *  single zlib stream and is slightly larger. Default is 1, i.e. a single
+ *  zlib stream is used.
+ */
+extern DCMTK_DCMDATA_EXPORT OFGlobal<Uint32> dcmZlibCompressionThreads;
+
+class DcmZLibBlockCompressor;
+
 /** zlib compression filter for output streams
  */
 class DCMTK_DCMDATA_EXPORT DcmZLibOutputFilter: public DcmOutputFilter
@@ -74,6 +86,9 @@ public:
    *  to return a value > 0 if there is no I/O suspension since certain
    *  data such as tag and length are only written "en bloc", i.e. all
    *  or nothing.
+   *  Please note that in case of parallel compression (see dcmZlibCompressionThreads),
+   *  this method writes pending output to the consumer and compresses the current
+   *  batch of blocks if necessary, since the caller might never get any space otherwise.
    *  @return minimum of space available in consumer
    */
   virtual offile_off_t avail() const;
@@ -149,6 +164,9 @@ private:
   /// pointer to struct z_stream object containing the zlib status
   z_streamp zstream_;
 
+  /// parallel compression of blocks, NULL if a single zlib stream is used
+  DcmZLibBlockCompressor *blockCompressor_;
+
   /// status
   OFCondition status_;
 
@@ -0,0 +1,133 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: class DcmParallelFrameProcessor
+ *
+ */
+
+#ifndef DCPARFRM_H
+#define DCPARFRM_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+#include "dcmtk/ofstd/ofcond.h"      /* for OFCondition */
+#include "dcmtk/ofstd/ofthread.h"    /* for OFMutex */
+#include "dcmtk/dcmdata/dctypes.h"     /* for Uint32 */
+
+class DcmParallelFrameThread;
+
+/** abstract base class for codecs that process the frames of a multi-frame
+ *  image independently of each other, e.g.\ decompression of an encapsulated
+ *  pixel sequence that contains exactly one fragment per frame. Derived
+ *  classes implement processFrame(), which is called once for each frame.
+ *  If thread support is available and more than one thread is requested,
+ *  the frames are distributed over a number of worker threads which fetch
+ *  the next unprocessed frame until all frames are done. Otherwise all frames
+ *  are processed sequentially in the calling thread.
+ *  processFrame() must therefore not access any DICOM objects (e.g. call
+ *  DcmPixelItem::getUint8Array(), which might load the value from file) and
+ *  should only use data that was prepared by the calling thread beforehand.
+ */
+class DCMTK_DCMDATA_EXPORT DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param numberOfFrames number of frames to be processed
+   */
+  DcmParallelFrameProcessor(Uint32 numberOfFrames);
+
+  /// destructor
+  virtual ~DcmParallelFrameProcessor();
+
+  /** processes all frames by calling processFrame() for each of them.
+   *  Processing stops as soon as possible after the first error.
+   *  @param numberOfThreads maximum number of threads to be used. The actual
+   *    number of threads is limited to the number of frames. If 0 or 1, or
+   *    if the toolkit was compiled without thread support, all frames are
+   *    processed in the calling thread.
+   *  @return EC_Normal if all frames have been processed successfully,
+   *    the error returned for the frame with the lowest number otherwise
+   */
+  OFCondition processAllFrames(Uint32 numberOfThreads);
+
+  /** returns the number of frames to be processed
+   *  @return number of frames to be processed
+   */
+  Uint32 getNumberOfFrames() const
+  {
+    return numberOfFrames_;
+  }
+
+  /** returns the number of threads that processAllFrames() will actually use
+   *  for the given number of requested threads, i.e.\ the number of distinct
+   *  values that may be passed as the thread index to processFrame().
+   *  @param numberOfThreads maximum number of threads to be used
+   *  @return number of threads that will be used, at least 1
+   */
+  Uint32 getNumberOfThreadsUsed(Uint32 numberOfThreads) const;
+
+  /** processes a single frame. Called by processAllFrames() for each frame,
+   *  possibly concurrently from several threads. Implementations that need
+   *  separate working data for each thread (e.g. a decoder instance) can use
+   *  the thread index for this purpose; a thread index is never used by
+   *  two threads at the same time.
+   *  @param frameNo number of the frame to be processed, 0..numberOfFrames-1
+   *  @param threadNo index of the calling thread, 0..getNumberOfThreadsUsed()-1
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, Uint32 threadNo) = 0;
+
+private:
+
+  friend class DcmParallelFrameThread;
+
+  /** returns the next frame to be processed. Thread-safe.
+   *  @param frameNo number of the next frame returned in this parameter
+   *  @return OFTrue if a frame has been returned, OFFalse if all frames have
+   *    been assigned or processing has been aborted
+   */
+  OFBool nextFrame(Uint32& frameNo);
+
+  /** records the result of processing a frame. Thread-safe.
+   *  @param frameNo number of the frame that has been processed
+   *  @param result result of processFrame() for this frame
+   */
+  void frameDone(Uint32 frameNo, const OFCondition& result);
+
+  /// private undefined copy constructor
+  DcmParallelFrameProcessor(const DcmParallelFrameProcessor&);
+
+  /// private undefined copy assignment operator
+  DcmParallelFrameProcessor& operator=(const DcmParallelFrameProcessor&);
+
+  /// number of frames to be processed
+  Uint32 numberOfFrames_;
+
+  /// number of the next frame to be assigned to a worker thread
+  Uint32 nextFrame_;
+
+  /// number of the first frame for which an error has been recorded
+  Uint32 errorFrame_;
+
+  /// error recorded for errorFrame_, EC_Normal if no error occurred
+  OFCondition errorResult_;
+
+  /// mutex protecting the member variables above
+  OFMutex mutex_;
+};
+
+#endif
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2011, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -197,6 +197,18 @@ private:
     void clearRepresentationList(
         DcmRepresentationListIterator leaveInList);
 
+    /** check whether the unencapsulated representation is requested with a
+     *  representation parameter (i.e. options for the decompression, such as a
+     *  reduced resolution), although the pixel data has already been decompressed
+     *  from the original encapsulated representation without these options.
+     *  @param toType the requested transfer syntax
+     *  @param repParam the requested representation parameter, may be NULL
+     *  @return OFTrue if the request cannot be fulfilled, OFFalse otherwise
+     */
+    OFBool isDecompressedWithoutParameter(
+        const DcmXfer & toType,
+        const DcmRepresentationParameter * repParam) const;
+
     /** find a conforming representation in the list of
      *  encapsulated representations
      */
@@ -221,12 +233,14 @@ private:
         DcmRepresentationEntry * repEntry);
 
     /** decode representation to unencapsulated format
+     *  (toParam is the optional representation parameter for the unencapsulated format)
      */
     OFCondition decode(
         const DcmXfer & fromType,
         const DcmRepresentationParameter * fromParam,
         DcmPixelSequence * fromPixSeq,
-        DcmStack & pixelStack);
+        DcmStack & pixelStack,
+        const DcmRepresentationParameter * toParam = NULL);
 
     /** encode to encapsulated format
      */
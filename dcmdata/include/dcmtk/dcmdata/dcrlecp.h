@@ -44,13 +44,16 @@ public:
    *  @param pReverseDecompressionByteOrder flag indicating whether the byte order should
    *    be reversed upon decompression. Needed to correctly decode some incorrectly encoded
    *    images with more than one byte per sample.
+   *  @param pNumberOfThreads maximum number of threads used for processing the frames
+   *    of a multi-frame image in parallel, 0 or 1 for sequential processing
    */
   DcmRLECodecParameter(
     OFBool pCreateSOPInstanceUID = OFFalse,
     Uint32 pFragmentSize = 0,
     OFBool pCreateOffsetTable = OFTrue,
     OFBool pConvertToSC = OFFalse,
-    OFBool pReverseDecompressionByteOrder = OFFalse);
+    OFBool pReverseDecompressionByteOrder = OFFalse,
+    Uint32 pNumberOfThreads = 1);
 
   /// copy constructor
   DcmRLECodecParameter(const DcmRLECodecParameter& arg);
@@ -109,6 +112,14 @@ public:
     return reverseDecompressionByteOrder;
   }
 
+  /** returns maximum number of threads for multi-frame processing
+   *  @return maximum number of threads, 0 or 1 for sequential processing
+   */
+  Uint32 getNumberOfThreads() const
+  {
+    return numberOfThreads;
+  }
+
 
 private:
 
@@ -131,6 +142,9 @@ private:
    *  decompress certain incorrectly encoded RLE images
    */
   OFBool reverseDecompressionByteOrder;
+
+  /// maximum number of threads for multi-frame processing, 0 or 1 for sequential processing
+  Uint32 numberOfThreads;
 };
 
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2011, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -25,6 +25,9 @@
 #include "dcmtk/config/osconfig.h"
 #include "dcmtk/dcmdata/dcerror.h"
 
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
 /** this class implements an RLE decompressor conforming to the DICOM standard.
  *  The class is loosely based on an implementation by Phil Norman <forrey@eh.org>
  */
@@ -40,6 +43,8 @@ public:
   : fail_(0)
   , outputBufferSize_(outputBufferSize)
   , outputBuffer_(NULL)
+  , ownBuffer_(OFTrue)
+  , stride_(1)
   , offset_(0)
   , suspendInfo_(128)
   {
@@ -51,10 +56,32 @@ public:
     }
   }
 
+  /** constructor. The decompressed output is written to the given buffer,
+   *  which is not owned by this object. This allows for decompressing an
+   *  RLE segment directly into the interleaved pixel data of a frame.
+   *  @param outputBuffer pointer to the buffer to which the decompressed
+   *    output is written, must not be NULL
+   *  @param outputBufferSize number of bytes that may be written to the
+   *    output buffer, i.e. the number of decompressed bytes expected
+   *  @param stride distance (in bytes) between two consecutive decompressed
+   *    bytes in the output buffer, 1 for contiguous output
+   */
+  DcmRLEDecoder(void *outputBuffer, size_t outputBufferSize, size_t stride = 1)
+  : fail_(0)
+  , outputBufferSize_(outputBufferSize)
+  , outputBuffer_(OFstatic_cast(unsigned char *, outputBuffer))
+  , ownBuffer_(OFFalse)
+  , stride_(stride)
+  , offset_(0)
+  , suspendInfo_(128)
+  {
+    if ((outputBufferSize_ == 0) || (outputBuffer_ == NULL) || (stride_ == 0)) fail_ = 1;
+  }
+
   /// destructor
   ~DcmRLEDecoder()
   {
-    delete[] outputBuffer_;
+    if (ownBuffer_) delete[] outputBuffer_;
   }
 
   /** resets the decoder object to newly constructed state.
@@ -64,7 +91,7 @@ public:
   {
     offset_ = 0;
     suspendInfo_ = 128;
-    if (outputBuffer_) fail_ = 0;
+    if (outputBuffer_ && outputBufferSize_ && stride_) fail_ = 0;
   }
 
 
@@ -174,7 +201,9 @@ public:
     return offset_;
   }
 
-  /** returns pointer to the output buffer
+  /** returns pointer to the output buffer.
+   *  Please note that for a strided output buffer, the decompressed bytes
+   *  are not stored contiguously (see constructor).
    */
   inline void *getOutputBuffer() const
   {
@@ -210,7 +239,21 @@ private:
        nbytes = OFstatic_cast(unsigned char, outputBufferSize_ - offset_);
      }
 
-     while (nbytes--) outputBuffer_[offset_++] = ch;
+     if (stride_ == 1)
+     {
+       memset(outputBuffer_ + offset_, ch, nbytes);
+       offset_ += nbytes;
+     }
+     else
+     {
+       unsigned char *op = outputBuffer_ + offset_ * stride_;
+       offset_ += nbytes;
+       while (nbytes--)
+       {
+         *op = ch;
+         op += stride_;
+       }
+     }
   }
 
 
@@ -227,7 +270,21 @@ private:
        nbytes = OFstatic_cast(unsigned char, outputBufferSize_ - offset_);
      }
 
-     while (nbytes--) outputBuffer_[offset_++] = *cp++;
+     if (stride_ == 1)
+     {
+       memcpy(outputBuffer_ + offset_, cp, nbytes);
+       offset_ += nbytes;
+     }
+     else
+     {
+       unsigned char *op = outputBuffer_ + offset_ * stride_;
+       offset_ += nbytes;
+       while (nbytes--)
+       {
+         *op = *cp++;
+         op += stride_;
+       }
+     }
   }
 
   /* member variables */
@@ -248,6 +305,16 @@ private:
    */
   unsigned char *outputBuffer_;
 
+  /** true if the output buffer has been allocated by this object
+   *  and is deleted in the destructor
+   */
+  OFBool ownBuffer_;
+
+  /** distance (in bytes) between two consecutive decompressed bytes
+   *  in the output buffer
+   */
+  size_t stride_;
+
   /** contains the number of bytes already written to outputBuffer_.
    *  Value is always less or equal to outputBufferSize_.
    */
@@ -42,10 +42,13 @@ public:
    *  @param pReverseDecompressionByteOrder flag indicating whether the byte order should
    *    be reversed upon decompression. Needed to correctly decode some incorrectly encoded
    *    images with more than one byte per sample.
+   *  @param pNumberOfThreads maximum number of threads used for decompressing
+   *    the frames of a multi-frame image in parallel, 0 or 1 for sequential decompression
    */
   static void registerCodecs(
     OFBool pCreateSOPInstanceUID = OFFalse,
-    OFBool pReverseDecompressionByteOrder = OFFalse);
+    OFBool pReverseDecompressionByteOrder = OFFalse,
+    Uint32 pNumberOfThreads = 1);
 
   /** deregisters decoder.
    *  Attention: Must not be called while other threads might still use
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2011, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -175,9 +175,39 @@ public:
    */
   inline void add(const unsigned char *buf, size_t bufcount)
   {
-    if (buf)
+    if (buf && (! fail_))
     {
-      while (bufcount--) add(*buf++);
+      const unsigned char *end = buf + bufcount;
+      while (buf < end)
+      {
+        // determine the length of the run of identical bytes starting at buf,
+        // comparing a machine word at a time for long runs
+        const unsigned char ch = *buf;
+        const unsigned char *run = buf + 1;
+        if ((run < end) && (*run == ch))
+        {
+          const size_t pattern = OFstatic_cast(size_t, ch) * (OFstatic_cast(size_t, -1) / 255);
+          size_t word;
+          while (OFstatic_cast(size_t, end - run) >= sizeof(size_t))
+          {
+            memcpy(&word, run, sizeof(size_t));
+            if (word != pattern) break;
+            run += sizeof(size_t);
+          }
+          while ((run < end) && (*run == ch)) ++run;
+        }
+
+        // the first byte of the run may terminate the previous run,
+        // all further bytes just increase the repeat counter
+        if (OFstatic_cast(int, ch) == RLE_prev_)
+          RLE_pcount_ += OFstatic_cast(int, run - buf);
+        else
+        {
+          add(ch);
+          RLE_pcount_ += OFstatic_cast(int, run - buf - 1);
+        }
+        buf = run;
+      }
     }
   }
 
@@ -341,6 +371,7 @@ private:
   inline void move(size_t numberOfBytes)
   {
     size_t i=0;
+    size_t count;
     while (i < numberOfBytes)
     {
       if (offset_ == DcmRLEEncoder_BLOCKSIZE)
@@ -354,7 +385,12 @@ private:
           break;    // exit while loop
         }
       }
-      currentBlock_[offset_++] = RLE_buff_[i++];
+      // copy as many bytes as fit into the current block
+      count = numberOfBytes - i;
+      if (count > DcmRLEEncoder_BLOCKSIZE - offset_) count = DcmRLEEncoder_BLOCKSIZE - offset_;
+      memcpy(currentBlock_ + offset_, RLE_buff_ + i, count);
+      offset_ += count;
+      i += count;
     }
   }
 
@@ -0,0 +1,276 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: classes DcmMemoryArena and DcmMemoryArenaScope
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+#include "dcmtk/dcmdata/dcarena.h"
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"    /* for OFThreadSpecificData */
+#endif
+
+#define INCLUDE_CSTDLIB
+#define INCLUDE_NEW
+#include "dcmtk/ofstd/ofstdinc.h"
+
+#if !defined(DCMTK_ARENA_NEED_MUTEX) && !defined(HAVE_SYNC_ADD_AND_FETCH) && defined(HAVE_WINDOWS_H)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>                  /* for InterlockedIncrement() */
+#endif
+
+
+/** header stored in front of each object allocated by allocateObject() and
+ *  each memory block of an arena. The union makes sure that the memory
+ *  following the header is suitably aligned.
+ */
+union DcmArenaHeader
+{
+    /// arena from which an object has been allocated (NULL for the heap)
+    DcmMemoryArena *arena;
+    /// next memory block of an arena
+    DcmArenaHeader *next;
+    /// not used, only for alignment purposes
+    double align;
+};
+
+
+#ifdef WITH_THREADS
+/* current arena of each thread. Since the current arena is only ever set and
+ * read by the same thread, no further synchronization is needed.
+ */
+static OFThreadSpecificData CurrentArena;
+#else
+/* current arena */
+static DcmMemoryArena *CurrentArena = NULL;
+#endif
+
+
+/* increase the given counter in a thread-safe way */
+static void incrementCounter(DCMTK_ARENA_COUNTER_TYPE &counter
+#ifdef DCMTK_ARENA_NEED_MUTEX
+                             , OFMutex &mutex
+#endif
+                            )
+{
+#if defined(HAVE_SYNC_ADD_AND_FETCH) && defined(HAVE_SYNC_SUB_AND_FETCH)
+    __sync_add_and_fetch(&counter, 1);
+#elif defined(HAVE_INTERLOCKED_INCREMENT) && defined(HAVE_INTERLOCKED_DECREMENT)
+    InterlockedIncrement(&counter);
+#else
+    mutex.lock();
+    ++counter;
+    mutex.unlock();
+#endif
+}
+
+
+/* decrease the given counter in a thread-safe way, returns OFTrue if zero was reached */
+static OFBool decrementCounter(DCMTK_ARENA_COUNTER_TYPE &counter
+#ifdef DCMTK_ARENA_NEED_MUTEX
+                               , OFMutex &mutex
+#endif
+                              )
+{
+#if defined(HAVE_SYNC_ADD_AND_FETCH) && defined(HAVE_SYNC_SUB_AND_FETCH)
+    return !__sync_sub_and_fetch(&counter, 1);
+#elif defined(HAVE_INTERLOCKED_INCREMENT) && defined(HAVE_INTERLOCKED_DECREMENT)
+    return !InterlockedDecrement(&counter);
+#else
+    mutex.lock();
+    const OFBool result = !--counter;
+    mutex.unlock();
+    return result;
+#endif
+}
+
+
+#ifdef DCMTK_ARENA_NEED_MUTEX
+#define DCMTK_ARENA_MUTEX_ARG(m) , m
+#else
+#define DCMTK_ARENA_MUTEX_ARG(m)
+#endif
+
+
+/* ------------------------------------------------------------------------- */
+
+
+DcmMemoryArena::DcmMemoryArena(const size_t blockSize)
+  : blockSize_((blockSize < 1024) ? 1024 : blockSize)
+  , blocks_(NULL)
+  , current_(NULL)
+  , remaining_(0)
+  , refCount_(1)
+#ifdef DCMTK_ARENA_NEED_MUTEX
+  , mutex_()
+#endif
+{
+}
+
+
+DcmMemoryArena::~DcmMemoryArena()
+{
+    DcmArenaHeader *block = OFstatic_cast(DcmArenaHeader *, blocks_);
+    while (block != NULL)
+    {
+        DcmArenaHeader *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+
+unsigned char *DcmMemoryArena::newBlock(const size_t size)
+{
+    DcmArenaHeader *block = OFstatic_cast(DcmArenaHeader *, malloc(sizeof(DcmArenaHeader) + size));
+    if (block == NULL)
+        return NULL;
+    block->next = OFstatic_cast(DcmArenaHeader *, blocks_);
+    blocks_ = block;
+    return OFreinterpret_cast(unsigned char *, block + 1);
+}
+
+
+void *DcmMemoryArena::allocate(const size_t size)
+{
+    /* keep all allocations aligned */
+    const size_t alignedSize = (size + sizeof(DcmArenaHeader) - 1) / sizeof(DcmArenaHeader) * sizeof(DcmArenaHeader);
+    unsigned char *result = NULL;
+    if (alignedSize <= remaining_)
+    {
+        result = current_;
+        current_ += alignedSize;
+        remaining_ -= alignedSize;
+    }
+    else if (alignedSize > blockSize_ / 4)
+    {
+        /* large allocations get a block of their own, the current block remains in use */
+        result = newBlock(alignedSize);
+    } else {
+        /* the rest of the current block is wasted */
+        result = newBlock(blockSize_);
+        if (result != NULL)
+        {
+            current_ = result + alignedSize;
+            remaining_ = blockSize_ - alignedSize;
+        }
+    }
+    if (result != NULL)
+        addReference();
+    return result;
+}
+
+
+void DcmMemoryArena::addReference()
+{
+    incrementCounter(refCount_ DCMTK_ARENA_MUTEX_ARG(mutex_));
+}
+
+
+void DcmMemoryArena::release()
+{
+    if (decrementCounter(refCount_ DCMTK_ARENA_MUTEX_ARG(mutex_)))
+        delete this;
+}
+
+
+DcmMemoryArena *DcmMemoryArena::getCurrentArena()
+{
+#ifdef WITH_THREADS
+    void *value = NULL;
+    if (CurrentArena.get(value) != 0)
+        return NULL;
+    return OFstatic_cast(DcmMemoryArena *, value);
+#else
+    return CurrentArena;
+#endif
+}
+
+
+void DcmMemoryArena::setCurrentArena(DcmMemoryArena *arena)
+{
+#ifdef WITH_THREADS
+    CurrentArena.set(arena);
+#else
+    CurrentArena = arena;
+#endif
+}
+
+
+void *DcmMemoryArena::allocateObject(const size_t size,
+                                     const OFBool nothrow)
+{
+    DcmMemoryArena *arena = getCurrentArena();
+    DcmArenaHeader *header = NULL;
+    if (arena != NULL)
+        header = OFstatic_cast(DcmArenaHeader *, arena->allocate(sizeof(DcmArenaHeader) + size));
+    if (header == NULL)
+    {
+        arena = NULL;
+#ifdef HAVE_STD__NOTHROW
+        if (nothrow)
+            header = OFstatic_cast(DcmArenaHeader *, ::operator new(sizeof(DcmArenaHeader) + size, std::nothrow));
+        else
+#endif
+        /* throws an exception if the memory cannot be allocated */
+        header = OFstatic_cast(DcmArenaHeader *, ::operator new(sizeof(DcmArenaHeader) + size));
+        if (nothrow && (header == NULL))
+            return NULL;
+    }
+    header->arena = arena;
+    return header + 1;
+}
+
+
+void DcmMemoryArena::deleteObject(void *ptr)
+{
+    if (ptr != NULL)
+    {
+        DcmArenaHeader *header = OFstatic_cast(DcmArenaHeader *, ptr) - 1;
+        if (header->arena != NULL)
+            header->arena->release();
+        else
+            ::operator delete(header);
+    }
+}
+
+
+/* ------------------------------------------------------------------------- */
+
+
+DcmMemoryArenaScope::DcmMemoryArenaScope(DcmMemoryArena *arena)
+  : active_(arena != NULL)
+  , previous_(NULL)
+{
+    if (active_)
+    {
+        previous_ = DcmMemoryArena::getCurrentArena();
+        DcmMemoryArena::setCurrentArena(arena);
+    }
+}
+
+
+DcmMemoryArenaScope::~DcmMemoryArenaScope()
+{
+    if (active_)
+    {
+        DcmMemoryArena::setCurrentArena(previous_);
+    }
+}
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -547,22 +547,7 @@ Uint8 *DcmByteString::newValueField()
             return NULL;
         }
         /* allocate space for extra padding character (required for the DICOM representation of the string) */
-#ifdef HAVE_STD__NOTHROW
-        // we want to use a non-throwing new here if available.
-        // If the allocation fails, we report an EC_MemoryExhausted error
-        // back to the caller.
-        value = new (std::nothrow) Uint8[lengthField + 2];
-#else
-        /* make sure that the pointer is set to NULL in case of error */
-        try
-        {
-            value = new Uint8[lengthField + 2];
-        }
-        catch (STD_NAMESPACE bad_alloc const &)
-        {
-            value = NULL;
-        }
-#endif
+        value = newValueBuffer(lengthField + 2);
 
         /* terminate string after real length */
         if (value != NULL)
@@ -576,22 +561,7 @@ Uint8 *DcmByteString::newValueField()
         }
     } else {
         /* length is even, but we need an extra byte for the terminating 0 byte */
-#ifdef HAVE_STD__NOTHROW
-        // we want to use a non-throwing new here if available.
-        // If the allocation fails, we report an EC_MemoryExhausted error
-        // back to the caller.
-        value = new (std::nothrow) Uint8[lengthField + 1];
-#else
-        /* make sure that the pointer is set to NULL in case of error */
-        try
-        {
-            value = new Uint8[lengthField + 1];
-        }
-        catch (STD_NAMESPACE bad_alloc const &)
-        {
-            value = NULL;
-        }
-#endif
+        value = newValueBuffer(lengthField + 1);
     }
     /* make sure that the string is properly terminated by a 0 byte */
     if (value != NULL)
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1997-2010, OFFIS e.V.
+ *  Copyright (C) 1997-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -424,7 +424,8 @@ OFCondition DcmCodecList::decode(
   const DcmRepresentationParameter * fromParam,
   DcmPixelSequence * fromPixSeq,
   DcmPolymorphOBOW& uncompressedPixelData,
-  DcmStack & pixelStack)
+  DcmStack & pixelStack,
+  const DcmRepresentationParameter * toParam)
 {
 #ifdef WITH_THREADS
   if (! codecLock.initialized()) return EC_IllegalCall; // should never happen
@@ -444,7 +445,7 @@ OFCondition DcmCodecList::decode(
     {
       if ((*first)->codec->canChangeCoding(fromXfer, EXS_LittleEndianExplicit))
       {
-        result = (*first)->codec->decode(fromParam, fromPixSeq, uncompressedPixelData, (*first)->codecParameter, pixelStack);
+        result = (*first)->codec->decodeToRepresentation(fromParam, fromPixSeq, uncompressedPixelData, (*first)->codecParameter, pixelStack, toParam);
         first = last;
       } else ++first;
     }
@@ -50,7 +50,9 @@ DcmDataset::DcmDataset()
   : DcmItem(ItemTag, DCM_UndefinedLength),
     OriginalXfer(EXS_Unknown),
     // the default transfer syntax is explicit VR with local endianness
-    CurrentXfer((gLocalByteOrder == EBO_BigEndian) ? EXS_BigEndianExplicit : EXS_LittleEndianExplicit)
+    CurrentXfer((gLocalByteOrder == EBO_BigEndian) ? EXS_BigEndianExplicit : EXS_LittleEndianExplicit),
+    ArenaBlockSize(0),
+    Arena(NULL)
 {
 }
 
@@ -64,6 +66,7 @@ DcmDataset& DcmDataset::operator=(const DcmDataset& obj)
     // copy DcmDataset's member variables
     OriginalXfer = obj.OriginalXfer;
     CurrentXfer = obj.CurrentXfer;
+    ArenaBlockSize = obj.ArenaBlockSize;
   }
   return *this;
 }
@@ -72,7 +75,9 @@ DcmDataset& DcmDataset::operator=(const DcmDataset& obj)
 DcmDataset::DcmDataset(const DcmDataset &old)
   : DcmItem(old),
     OriginalXfer(old.OriginalXfer),
-    CurrentXfer(old.CurrentXfer)
+    CurrentXfer(old.CurrentXfer),
+    ArenaBlockSize(old.ArenaBlockSize),
+    Arena(NULL)
 {
 }
 
@@ -90,6 +95,9 @@ OFCondition DcmDataset::copyFrom(const DcmObject& rhs)
 
 DcmDataset::~DcmDataset()
 {
+    /* the arena is deleted as soon as all objects allocated from it are deleted */
+    if (Arena != NULL)
+        Arena->release();
 }
 
 
@@ -122,6 +130,24 @@ E_TransferSyntax DcmDataset::getCurrentXfer() const
 }
 
 
+void DcmDataset::setArenaAllocation(const OFBool enable,
+                                    const size_t blockSize)
+{
+#ifdef WITH_ARENA_ALLOCATION
+    ArenaBlockSize = enable ? blockSize : 0;
+#else
+    /* not supported, see DcmMemoryArenaObject */
+    (void) blockSize;
+    ArenaBlockSize = 0;
+#endif
+    if (!enable && (Arena != NULL))
+    {
+        Arena->release();
+        Arena = NULL;
+    }
+}
+
+
 void DcmDataset::updateOriginalXfer()
 {
     DcmStack resultStack;
@@ -340,6 +366,16 @@ OFCondition DcmDataset::read(DcmInputStream &inStream,
                              const E_TransferSyntax xfer,
                              const E_GrpLenEncoding glenc,
                              const Uint32 maxReadLength)
+{
+    return DcmDataset::readUntilTag(inStream, xfer, glenc, maxReadLength, DCM_UndefinedTagKey);
+}
+
+
+OFCondition DcmDataset::readUntilTag(DcmInputStream &inStream,
+                                     const E_TransferSyntax xfer,
+                                     const E_GrpLenEncoding glenc,
+                                     const Uint32 maxReadLength,
+                                     const DcmTagKey &stopParsingAtElement)
 {
     /* check if the stream variable reported an error */
     errorFlag = inStream.status();
@@ -354,6 +390,13 @@ OFCondition DcmDataset::read(DcmInputStream &inStream,
         /* if the transfer state is ERW_init, go ahead and check the transfer syntax which was passed */
         if (getTransferState() == ERW_init)
         {
+            /* each read operation uses a new memory arena (if enabled) */
+            if (ArenaBlockSize > 0)
+            {
+                if (Arena != NULL)
+                    Arena->release();
+                Arena = new DcmMemoryArena(ArenaBlockSize);
+            }
             if (dcmAutoDetectDatasetXfer.get())
             {
                 DCMDATA_DEBUG("DcmDataset::read() automatic detection of transfer syntax is enabled");
@@ -414,7 +457,11 @@ OFCondition DcmDataset::read(DcmInputStream &inStream,
         }
         /* pass processing the task to class DcmItem */
         if (errorFlag.good())
-            errorFlag = DcmItem::read(inStream, OriginalXfer, glenc, maxReadLength);
+        {
+            /* all objects created while parsing are allocated from the arena (if any) */
+            DcmMemoryArenaScope arenaScope(Arena);
+            errorFlag = DcmItem::readUntilTag(inStream, OriginalXfer, glenc, maxReadLength, stopParsingAtElement);
+        }
     }
 
     /* if the error flag shows ok or that the end of the stream was encountered, */
@@ -434,7 +481,7 @@ OFCondition DcmDataset::read(DcmInputStream &inStream,
     }
 
     /* dump information if required */
-    DCMDATA_TRACE("DcmDataset::read() returns error = " << errorFlag.text());
+    DCMDATA_TRACE("DcmDataset::readUntilTag() returns error = " << errorFlag.text());
 
     /* return result flag */
     return errorFlag;
@@ -603,6 +650,16 @@ OFCondition DcmDataset::loadFile(const OFFilename &fileName,
                                  const E_TransferSyntax readXfer,
                                  const E_GrpLenEncoding groupLength,
                                  const Uint32 maxReadLength)
+{
+    return loadFileUntilTag(fileName, readXfer, groupLength, maxReadLength, DCM_UndefinedTagKey);
+}
+
+
+OFCondition DcmDataset::loadFileUntilTag(const OFFilename &fileName,
+                                         const E_TransferSyntax readXfer,
+                                         const E_GrpLenEncoding groupLength,
+                                         const Uint32 maxReadLength,
+                                         const DcmTagKey &stopParsingAtElement)
 {
     OFCondition l_error = EC_InvalidFilename;
     /* check parameters first */
@@ -622,7 +679,7 @@ OFCondition DcmDataset::loadFile(const OFFilename &fileName,
             {
                 /* read data from file */
                 transferInit();
-                l_error = read(fileStream, readXfer, groupLength, maxReadLength);
+                l_error = readUntilTag(fileStream, readXfer, groupLength, maxReadLength, stopParsingAtElement);
                 transferEnd();
             }
         }
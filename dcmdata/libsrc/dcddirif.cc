@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -38,11 +38,13 @@
 #include "dcmtk/dcmdata/dcvrcs.h"     /* for class DcmCodeString */
 #include "dcmtk/dcmdata/dcvrda.h"     /* for class DcmDate */
 #include "dcmtk/dcmdata/dcvrtm.h"     /* for class DcmTime */
+#include "dcmtk/dcmdata/dcparfrm.h"   /* for class DcmParallelFrameProcessor */
 
 #include "dcmtk/ofstd/ofstd.h"
 #include "dcmtk/ofstd/ofstream.h"
 #include "dcmtk/ofstd/ofbmanip.h"     /* for class OFBitmanipTemplate */
 #include "dcmtk/ofstd/ofcast.h"
+#include "dcmtk/ofstd/ofvector.h"
 
 
 /*-------------------------*
@@ -72,6 +74,540 @@ static OFBool compareSQAttributes(DcmSequenceOfItems *seq1,
                                   OFString &reason);
 
 
+/*----------------------*
+ *  class declarations  *
+ *----------------------*/
+
+/** index of the directory records below a parent record.  Records that are identified
+ *  by a UID (study, series and instance records) can be found by a hash lookup instead
+ *  of comparing all child records of the parent with the current dataset.  In addition,
+ *  the values of the numeric attribute used for the sorted insertion of child records
+ *  (e.g. InstanceNumber) are stored for each parent, so the position of a new record
+ *  can be determined without retrieving the value from each child record.
+ *  The index is built on demand for each parent record.  Whenever the index cannot give
+ *  the same result as the search through the list of child records (e.g. if there are
+ *  several records with the same UID), the caller falls back to the latter.
+ */
+class DicomDirRecordIndex
+{
+
+  public:
+
+    DicomDirRecordIndex()
+      : Buckets(NULL),
+        NumberOfBuckets(0),
+        NumberOfEntries(0)
+    {
+    }
+
+    ~DicomDirRecordIndex()
+    {
+        clear();
+    }
+
+    /** remove all entries from the index
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < NumberOfBuckets; ++i)
+        {
+            Entry *entry = Buckets[i];
+            while (entry != NULL)
+            {
+                Entry *next = entry->Next;
+                delete entry;
+                entry = next;
+            }
+        }
+        delete[] Buckets;
+        Buckets = NULL;
+        NumberOfBuckets = 0;
+        NumberOfEntries = 0;
+    }
+
+    /** search for the record of the given type below the given parent that matches
+     *  the dataset, i.e. has the same UID
+     *  @param parent parent record
+     *  @param recordType type of the record to be searched for
+     *  @param dataset DICOM dataset of the current file
+     *  @param record pointer to the matching record (NULL if none) returned in this parameter
+     *  @return OFTrue if the index could be used, OFFalse if the list of child records
+     *    has to be searched instead
+     */
+    OFBool findRecord(DcmDirectoryRecord *parent,
+                      const E_DirRecType recordType,
+                      DcmItem *dataset,
+                      DcmDirectoryRecord *&record)
+    {
+        record = NULL;
+        DcmTagKey recordKey, datasetKey;
+        if (!getMatchingKeys(recordType, recordKey, datasetKey))
+            return OFFalse;
+        /* the entry with an empty UID stores the status of the parent record */
+        Entry *status = findEntry(parent, recordType, OFString());
+        if (status == NULL)
+            status = indexChildRecords(parent, recordType, recordKey);
+        if (status->Flag)
+            return OFFalse;
+        OFString uid;
+        /* empty values never match, see compare() */
+        if (dataset->findAndGetOFStringArray(datasetKey, uid).good() && !uid.empty())
+        {
+            Entry *entry = findEntry(parent, recordType, uid);
+            if (entry != NULL)
+            {
+                /* the first of several records with the same UID is found by the search */
+                if (entry->Flag)
+                    return OFFalse;
+                record = entry->Record;
+            }
+        }
+        return OFTrue;
+    }
+
+    /** add a record that has just been inserted below the given parent to the index
+     *  @param parent parent record
+     *  @param record new child record
+     */
+    void addRecord(DcmDirectoryRecord *parent,
+                   DcmDirectoryRecord *record)
+    {
+        DcmTagKey recordKey, datasetKey;
+        const E_DirRecType recordType = record->getRecordType();
+        /* only add the record if the parent has already been indexed */
+        if (getMatchingKeys(recordType, recordKey, datasetKey) && (findEntry(parent, recordType, OFString()) != NULL))
+            addChildRecord(parent, recordType, recordKey, record);
+    }
+
+    /** determine the position at which a new child record is to be inserted in order to
+     *  keep the child records sorted by the given numeric attribute, i.e. the position of
+     *  the first child record with a greater value
+     *  @param parent parent record
+     *  @param criterionKey tag of the numeric attribute (value representation IS)
+     *  @param number value of the attribute in the new child record
+     *  @param position index of the first child record with a greater value returned
+     *    in this parameter
+     *  @return OFTrue if such a child record exists, OFFalse if the new record is to be
+     *    appended to the list of child records
+     */
+    OFBool findSortedPosition(DcmDirectoryRecord *parent,
+                              const DcmTagKey &criterionKey,
+                              const Sint32 number,
+                              unsigned long &position)
+    {
+        Entry *entry = findEntry(parent, getCriterionID(criterionKey), OFString());
+        /* the list of values has to be determined again if records were added elsewhere */
+        if ((entry != NULL) && (entry->Numbers.size() != parent->cardSub()))
+        {
+            removeEntry(parent, getCriterionID(criterionKey));
+            entry = NULL;
+        }
+        if (entry == NULL)
+        {
+            entry = addEntry(parent, getCriterionID(criterionKey), OFString());
+            DcmDirectoryRecord *record = NULL;
+            NumberValue value;
+            while ((record = parent->nextSub(record)) != NULL)
+            {
+                value.Valid = record->findAndGetSint32(criterionKey, value.Number).good();
+                addNumber(entry, entry->Numbers.size(), value);
+            }
+        }
+        /* no need to search if there is no greater value at all */
+        if (entry->Flag && (entry->Number > number))
+        {
+            const size_t count = entry->Numbers.size();
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (entry->Numbers[i].Valid && (entry->Numbers[i].Number > number))
+                {
+                    position = OFstatic_cast(unsigned long, i);
+                    return OFTrue;
+                }
+            }
+        }
+        return OFFalse;
+    }
+
+    /** update the values of the given numeric attribute after a new child record has
+     *  been inserted by means of findSortedPosition()
+     *  @param parent parent record
+     *  @param criterionKey tag of the numeric attribute (value representation IS)
+     *  @param position index of the new child record
+     *  @param valid flag indicating whether the new child record has a valid value
+     *  @param number value of the attribute in the new child record
+     */
+    void addNumber(DcmDirectoryRecord *parent,
+                   const DcmTagKey &criterionKey,
+                   const unsigned long position,
+                   const OFBool valid,
+                   const Sint32 number)
+    {
+        Entry *entry = findEntry(parent, getCriterionID(criterionKey), OFString());
+        if (entry != NULL)
+        {
+            NumberValue value;
+            value.Number = number;
+            value.Valid = valid;
+            if ((entry->Numbers.size() + 1 == parent->cardSub()) && (position <= entry->Numbers.size()))
+                addNumber(entry, position, value);
+            else
+                removeEntry(parent, getCriterionID(criterionKey));
+        }
+    }
+
+    /** discard the values of the numeric attributes that have been determined for the
+     *  given parent record, e.g. because the value in a child record has changed
+     *  @param parent parent record
+     */
+    void invalidateNumbers(DcmDirectoryRecord *parent)
+    {
+        removeEntry(parent, getCriterionID(DCM_InstanceNumber));
+        removeEntry(parent, getCriterionID(DCM_SeriesNumber));
+        removeEntry(parent, getCriterionID(DCM_RETIRED_OverlayNumber));
+        removeEntry(parent, getCriterionID(DCM_RETIRED_CurveNumber));
+        removeEntry(parent, getCriterionID(DCM_RETIRED_LUTNumber));
+    }
+
+
+  private:
+
+    /** structure for the value of a numeric attribute in a child record
+     */
+    struct NumberValue
+    {
+        /// value of the numeric attribute
+        Sint32 Number;
+        /// flag indicating whether the child record has a valid value
+        OFBool Valid;
+    };
+
+    /** structure for an entry of the index.  There are three kinds of entries: a record
+     *  with a given UID (flag: there is more than one record with this UID), the status
+     *  of a parent record for a given record type (empty UID, flag: the index cannot be
+     *  used for this parent) and the values of a numeric attribute (empty UID, flag: the
+     *  maximum value is valid).  Record types and tags of numeric attributes
+     *  never overlap since all these tags have a group number greater than 0.
+     */
+    struct Entry
+    {
+        /// parent record
+        DcmDirectoryRecord *Parent;
+        /// record type or tag of the numeric attribute
+        Uint32 ID;
+        /// UID of the record (empty for status and numeric attribute entries)
+        OFString UID;
+        /// child record with the given UID
+        DcmDirectoryRecord *Record;
+        /// maximum value of the numeric attribute
+        Sint32 Number;
+        /// flag, see above
+        OFBool Flag;
+        /// values of the numeric attribute in the order of the child records
+        OFVector<NumberValue> Numbers;
+        /// next entry in the same bucket
+        Entry *Next;
+    };
+
+    /** get tags used to compare a record of the given type with a dataset.
+     *  The patient record is never indexed since the comparison is more complex.
+     *  @param recordType type of the record
+     *  @param recordKey tag of the UID in the directory record
+     *  @param datasetKey tag of the UID in the dataset
+     *  @return OFTrue if records of this type can be indexed, OFFalse otherwise
+     */
+    static OFBool getMatchingKeys(const E_DirRecType recordType,
+                                  DcmTagKey &recordKey,
+                                  DcmTagKey &datasetKey)
+    {
+        switch (recordType)
+        {
+            case ERT_Study:
+                recordKey = datasetKey = DCM_StudyInstanceUID;
+                return OFTrue;
+            case ERT_Series:
+                recordKey = datasetKey = DCM_SeriesInstanceUID;
+                return OFTrue;
+            /* same record types as in DicomDirInterface::recordMatchesDataset() */
+            case ERT_Image:
+            case ERT_Overlay:
+            case ERT_Curve:
+            case ERT_ModalityLut:
+            case ERT_VoiLut:
+            case ERT_SRDocument:
+            case ERT_Presentation:
+            case ERT_Waveform:
+            case ERT_RTDose:
+            case ERT_RTStructureSet:
+            case ERT_RTPlan:
+            case ERT_RTTreatRecord:
+            case ERT_StoredPrint:
+            case ERT_KeyObjectDoc:
+            case ERT_Registration:
+            case ERT_Fiducial:
+            case ERT_RawData:
+            case ERT_Spectroscopy:
+            case ERT_EncapDoc:
+            case ERT_ValueMap:
+            case ERT_HangingProtocol:
+            case ERT_Stereometric:
+            case ERT_Palette:
+            case ERT_Surface:
+            case ERT_Measurement:
+            case ERT_Implant:
+            case ERT_ImplantGroup:
+            case ERT_ImplantAssy:
+            case ERT_Plan:
+            case ERT_SurfaceScan:
+                recordKey = DCM_ReferencedSOPInstanceUIDInFile;
+                datasetKey = DCM_SOPInstanceUID;
+                return OFTrue;
+            default:
+                return OFFalse;
+        }
+    }
+
+    static Uint32 getCriterionID(const DcmTagKey &criterionKey)
+    {
+        return (OFstatic_cast(Uint32, criterionKey.getGroup()) << 16) | criterionKey.getElement();
+    }
+
+    static void addNumber(Entry *entry,
+                          const size_t position,
+                          const NumberValue &value)
+    {
+        entry->Numbers.insert(entry->Numbers.begin() + position, value);
+        if (value.Valid && (!entry->Flag || (value.Number > entry->Number)))
+        {
+            entry->Number = value.Number;
+            entry->Flag = OFTrue;
+        }
+    }
+
+    /** add all child records of the given type to the index
+     *  @return status entry for the parent record
+     */
+    Entry *indexChildRecords(DcmDirectoryRecord *parent,
+                             const E_DirRecType recordType,
+                             const DcmTagKey &recordKey)
+    {
+        Entry *status = addEntry(parent, recordType, OFString());
+        DcmDirectoryRecord *record = NULL;
+        while ((record = parent->nextSub(record)) != NULL)
+        {
+            if (record->getRecordType() == recordType)
+                addChildRecord(parent, recordType, recordKey, record);
+        }
+        return status;
+    }
+
+    void addChildRecord(DcmDirectoryRecord *parent,
+                        const E_DirRecType recordType,
+                        const DcmTagKey &recordKey,
+                        DcmDirectoryRecord *record)
+    {
+        OFString uid;
+        record->findAndGetOFStringArray(recordKey, uid);
+        if (!uid.empty())
+        {
+            Entry *entry = findEntry(parent, recordType, uid);
+            if (entry == NULL)
+                addEntry(parent, recordType, uid)->Record = record;
+            else
+                entry->Flag = OFTrue;
+        }
+        else if ((recordType == ERT_Study) && record->tagExistsWithValue(DCM_ReferencedFileID))
+        {
+            /* the Study Instance UID has to be read from the referenced file */
+            findEntry(parent, recordType, OFString())->Flag = OFTrue;
+        }
+    }
+
+    size_t hash(const DcmDirectoryRecord *parent,
+                const Uint32 id,
+                const OFString &uid) const
+    {
+        /* FNV-1a hash function */
+        size_t value = OFstatic_cast(size_t, 2166136261UL);
+        const char *str = uid.c_str();
+        while (*str != '\0')
+            value = (value ^ OFstatic_cast(unsigned char, *str++)) * 16777619UL;
+        value ^= OFreinterpret_cast(size_t, parent) / sizeof(void *) + id * 2654435761UL;
+        return value % NumberOfBuckets;
+    }
+
+    Entry *findEntry(DcmDirectoryRecord *parent,
+                     const Uint32 id,
+                     const OFString &uid) const
+    {
+        if (NumberOfBuckets > 0)
+        {
+            Entry *entry = Buckets[hash(parent, id, uid)];
+            while (entry != NULL)
+            {
+                if ((entry->Parent == parent) && (entry->ID == id) && (entry->UID == uid))
+                    return entry;
+                entry = entry->Next;
+            }
+        }
+        return NULL;
+    }
+
+    Entry *addEntry(DcmDirectoryRecord *parent,
+                    const Uint32 id,
+                    const OFString &uid)
+    {
+        /* keep the average number of entries per bucket small */
+        if (NumberOfEntries >= NumberOfBuckets)
+            resize((NumberOfBuckets > 0) ? 2 * NumberOfBuckets + 1 : 1021);
+        Entry *entry = new Entry;
+        entry->Parent = parent;
+        entry->ID = id;
+        entry->UID = uid;
+        entry->Record = NULL;
+        entry->Number = 0;
+        entry->Flag = OFFalse;
+        const size_t index = hash(parent, id, uid);
+        entry->Next = Buckets[index];
+        Buckets[index] = entry;
+        ++NumberOfEntries;
+        return entry;
+    }
+
+    void removeEntry(DcmDirectoryRecord *parent,
+                     const Uint32 id)
+    {
+        if (NumberOfBuckets > 0)
+        {
+            Entry **entry = &Buckets[hash(parent, id, OFString())];
+            while (*entry != NULL)
+            {
+                if (((*entry)->Parent == parent) && ((*entry)->ID == id) && (*entry)->UID.empty())
+                {
+                    Entry *next = (*entry)->Next;
+                    delete *entry;
+                    *entry = next;
+                    --NumberOfEntries;
+                    break;
+                }
+                entry = &(*entry)->Next;
+            }
+        }
+    }
+
+    void resize(const size_t numberOfBuckets)
+    {
+        Entry **oldBuckets = Buckets;
+        const size_t oldNumberOfBuckets = NumberOfBuckets;
+        Buckets = new Entry*[numberOfBuckets];
+        NumberOfBuckets = numberOfBuckets;
+        for (size_t i = 0; i < NumberOfBuckets; ++i)
+            Buckets[i] = NULL;
+        for (size_t j = 0; j < oldNumberOfBuckets; ++j)
+        {
+            Entry *entry = oldBuckets[j];
+            while (entry != NULL)
+            {
+                Entry *next = entry->Next;
+                const size_t index = hash(entry->Parent, entry->ID, entry->UID);
+                entry->Next = Buckets[index];
+                Buckets[index] = entry;
+                entry = next;
+            }
+        }
+        delete[] oldBuckets;
+    }
+
+    /// hash table
+    Entry **Buckets;
+    /// number of buckets of the hash table
+    size_t NumberOfBuckets;
+    /// number of entries in the hash table
+    size_t NumberOfEntries;
+
+ // --- declarations to avoid compiler warnings
+
+    DicomDirRecordIndex(const DicomDirRecordIndex &);
+    DicomDirRecordIndex &operator=(const DicomDirRecordIndex &);
+};
+
+
+/** helper class that loads and checks a number of DICOM files, possibly in parallel.
+ *  Each "frame" processed by the base class is one of the files.
+ */
+class DicomDirFileLoader
+  : public DcmParallelFrameProcessor
+{
+
+  public:
+
+    DicomDirFileLoader(DicomDirInterface &ddir,
+                       const OFFilename *filenames,
+                       const Uint32 numberOfFiles,
+                       const OFFilename &directory)
+      : DcmParallelFrameProcessor(numberOfFiles),
+        Interface(ddir),
+        Filenames(filenames),
+        Directory(directory),
+        FileFormats(new DcmFileFormat[numberOfFiles]),
+        Results(new OFCondition[numberOfFiles])
+    {
+    }
+
+    virtual ~DicomDirFileLoader()
+    {
+        delete[] FileFormats;
+        delete[] Results;
+    }
+
+    /** get the loaded data of the given file
+     *  @param fileNo index of the file
+     *  @return reference to loaded data
+     */
+    DcmFileFormat &getFileFormat(const Uint32 fileNo)
+    {
+        return FileFormats[fileNo];
+    }
+
+    /** get the result of loading and checking the given file
+     *  @param fileNo index of the file
+     *  @return status, EC_Normal if the file can be added to the DICOMDIR
+     */
+    const OFCondition &getResult(const Uint32 fileNo) const
+    {
+        return Results[fileNo];
+    }
+
+  protected:
+
+    virtual OFCondition processFrame(Uint32 frameNo,
+                                     Uint32 /* threadNo */)
+    {
+        /* errors are reported separately for each file, so processing never stops */
+        Results[frameNo] = Interface.loadAndCheckDicomFile(Filenames[frameNo], Directory, FileFormats[frameNo]);
+        return EC_Normal;
+    }
+
+  private:
+
+    /// interface whose settings are used to check the files
+    DicomDirInterface &Interface;
+    /// names of the DICOM files to be loaded
+    const OFFilename *Filenames;
+    /// directory where the DICOM files are stored
+    const OFFilename &Directory;
+    /// loaded data of each file
+    DcmFileFormat *FileFormats;
+    /// result of loading and checking each file
+    OFCondition *Results;
+
+ // --- declarations to avoid compiler warnings
+
+    DicomDirFileLoader(const DicomDirFileLoader &);
+    DicomDirFileLoader &operator=(const DicomDirFileLoader &);
+};
+
+
 /*--------------------------*
  *  local helper functions  *
  *--------------------------*/
@@ -862,34 +1398,47 @@ static void addBlendingSequence(DcmDirectoryRecord *record,
 // insert child record into the parent's list based on the numeric value of the criterionKey
 static OFCondition insertWithISCriterion(DcmDirectoryRecord *parent,
                                          DcmDirectoryRecord *child,
-                                         const DcmTagKey &criterionKey)
+                                         const DcmTagKey &criterionKey,
+                                         DicomDirRecordIndex *index)
 {
     OFCondition result = EC_IllegalParameter;
     /* check parameters first */
     if ((parent != NULL) && (child != NULL))
     {
         OFBool found = OFFalse;
+        unsigned long position = 0;
         Sint32 childNumber = 0;
-        Sint32 parentNumber = 0;
         /* retrieve numeric value */
-        result = child->findAndGetSint32(criterionKey, childNumber);
+        const OFBool hasNumber = child->findAndGetSint32(criterionKey, childNumber).good();
         /* if available search for proper position */
-        if (result.good())
+        if (hasNumber)
         {
-            DcmDirectoryRecord *record = NULL;
-            /* iterate over all records in the parent list */
-            while (!found && ((record = parent->nextSub(record)) != NULL))
-            {
-                /* check for proper position */
-                if (record->findAndGetSint32(criterionKey, parentNumber).good() && (parentNumber > childNumber))
-                    found = OFTrue;
+            if (index != NULL)
+                found = index->findSortedPosition(parent, criterionKey, childNumber, position);
+            else {
+                Sint32 parentNumber = 0;
+                DcmDirectoryRecord *record = NULL;
+                /* iterate over all records in the parent list */
+                while (!found && ((record = parent->nextSub(record)) != NULL))
+                {
+                    /* check for proper position */
+                    if (record->findAndGetSint32(criterionKey, parentNumber).good() && (parentNumber > childNumber))
+                        found = OFTrue;
+                    else
+                        ++position;
+                }
             }
         }
         /* insert child record at determined position */
         if (found)
-            result = parent->insertSubAtCurrentPos(child, OFTrue /*before*/);
+            result = parent->insertSub(child, position, OFTrue /*before*/);
         else /* or append at the end of the list */
+        {
+            position = parent->cardSub();
             result = parent->insertSub(child);
+        }
+        if (result.good() && (index != NULL))
+            index->addNumber(parent, criterionKey, position, hasNumber, childNumber);
     }
     return result;
 }
@@ -897,7 +1446,8 @@ static OFCondition insertWithISCriterion(DcmDirectoryRecord *parent,
 
 // insert child record sorted under the parent record
 static OFCondition insertSortedUnder(DcmDirectoryRecord *parent,
-                                     DcmDirectoryRecord *child)
+                                     DcmDirectoryRecord *child,
+                                     DicomDirRecordIndex *index)
 {
     OFCondition result = EC_IllegalParameter;
     /* check parameters first */
@@ -907,20 +1457,20 @@ static OFCondition insertSortedUnder(DcmDirectoryRecord *parent,
         {
             case ERT_Image:
                 /* try to insert based on Image/InstanceNumber */
-                result = insertWithISCriterion(parent, child, DCM_InstanceNumber);
+                result = insertWithISCriterion(parent, child, DCM_InstanceNumber, index);
                 break;
             case ERT_Overlay:
                 /* try to insert based on OverlayNumber */
-                result = insertWithISCriterion(parent, child, DCM_RETIRED_OverlayNumber);
+                result = insertWithISCriterion(parent, child, DCM_RETIRED_OverlayNumber, index);
                 break;
             case ERT_Curve:
                 /* try to insert based on CurveNumber */
-                result = insertWithISCriterion(parent, child, DCM_RETIRED_CurveNumber);
+                result = insertWithISCriterion(parent, child, DCM_RETIRED_CurveNumber, index);
                 break;
             case ERT_ModalityLut:
             case ERT_VoiLut:
                 /* try to insert based on LUTNumber */
-                result = insertWithISCriterion(parent, child, DCM_RETIRED_LUTNumber);
+                result = insertWithISCriterion(parent, child, DCM_RETIRED_LUTNumber, index);
                 break;
             case ERT_SRDocument:
             case ERT_Presentation:
@@ -941,11 +1491,11 @@ static OFCondition insertSortedUnder(DcmDirectoryRecord *parent,
             case ERT_Measurement:
             case ERT_SurfaceScan:
                 /* try to insert based on InstanceNumber */
-                result = insertWithISCriterion(parent, child, DCM_InstanceNumber);
+                result = insertWithISCriterion(parent, child, DCM_InstanceNumber, index);
                 break;
             case ERT_Series:
                 /* try to insert based on SeriesNumber */
-                result = insertWithISCriterion(parent, child, DCM_SeriesNumber);
+                result = insertWithISCriterion(parent, child, DCM_SeriesNumber, index);
                 break;
             case ERT_Stereometric:
             case ERT_Plan:
@@ -1049,6 +1599,7 @@ static OFBool isMultiframeStorageSOPClass(const OFString &sopClassUID)
 // constructor
 DicomDirInterface::DicomDirInterface()
   : DicomDir(NULL),
+    RecordIndex(new DicomDirRecordIndex()),
     ImagePlugin(NULL),
     ApplicationProfile(AP_Default),
     BackupMode(OFTrue),
@@ -1068,6 +1619,7 @@ DicomDirInterface::DicomDirInterface()
     IconSize(64),
     IconPrefix(),
     DefaultIcon(),
+    NumberOfThreads(1),
     RLESupport(OFFalse),
     JPEGSupport(OFFalse),
     JP2KSupport(OFFalse),
@@ -1093,6 +1645,7 @@ DicomDirInterface::~DicomDirInterface()
 {
     /* reset object to its initial state (free memory) */
     cleanup();
+    delete RecordIndex;
 }
 
 
@@ -1101,6 +1654,7 @@ void DicomDirInterface::cleanup()
 {
     /* free all allocated memory */
     delete DicomDir;
+    RecordIndex->clear();
     /* invalidate references */
     DicomDir = NULL;
 }
@@ -2851,6 +3405,9 @@ DcmDirectoryRecord *DicomDirInterface::findExistingRecord(DcmDirectoryRecord *pa
     DcmDirectoryRecord *record = NULL;
     if (parent != NULL)
     {
+        /* use the index if possible (records identified by a UID) */
+        if (RecordIndex->findRecord(parent, recordType, dataset, record))
+            return record;
         /* iterate over all records */
         while (!found && ((record = parent->nextSub(record)) != NULL))
         {
@@ -4412,14 +4969,18 @@ DcmDirectoryRecord *DicomDirInterface::addRecord(DcmDirectoryRecord *parent,
                 if (record != oldRecord)
                 {
                     /* insert it below parent record */
-                    OFCondition status = insertSortedUnder(parent, record);
+                    OFCondition status = insertSortedUnder(parent, record, RecordIndex);
                     if (status.bad())
                     {
                         printRecordErrorMessage(status, recordType, "insert");
                         /* free memory */
                         delete record;
                         record = NULL;
-                    }
+                    } else
+                        RecordIndex->addRecord(parent, record);
+                } else {
+                    /* numeric values used for sorting might have changed */
+                    RecordIndex->invalidateNumbers(parent);
                 }
             }
         } else {
@@ -4525,7 +5086,11 @@ void DicomDirInterface::inventMissingSeriesLevelAttributes(DcmDirectoryRecord *p
         while ((record = parent->nextSub(record)) != NULL)
         {
             if (!record->tagExistsWithValue(DCM_SeriesNumber))
+            {
                 setDefaultValue(record, DCM_SeriesNumber, AutoSeriesNumber++);
+                /* value is used for sorting */
+                RecordIndex->invalidateNumbers(parent);
+            }
             inventMissingInstanceLevelAttributes(record);
         }
     }
@@ -4537,6 +5102,8 @@ void DicomDirInterface::inventMissingInstanceLevelAttributes(DcmDirectoryRecord
 {
     if (parent != NULL)
     {
+        /* used to determine whether any value has been invented */
+        const unsigned long lastNumbers = AutoInstanceNumber + AutoOverlayNumber + AutoLutNumber + AutoCurveNumber;
         DcmDirectoryRecord *record = NULL;
         /* iterate over all child records */
         while ((record = parent->nextSub(record)) != NULL)
@@ -4587,6 +5154,9 @@ void DicomDirInterface::inventMissingInstanceLevelAttributes(DcmDirectoryRecord
                     break;
             }
         }
+        /* these values are used for sorting */
+        if (AutoInstanceNumber + AutoOverlayNumber + AutoLutNumber + AutoCurveNumber != lastNumbers)
+            RecordIndex->invalidateNumbers(parent);
     }
 }
 
@@ -4599,89 +5169,152 @@ OFCondition DicomDirInterface::addDicomFile(const OFFilename &filename,
     /* first, make sure that a DICOMDIR object exists */
     if (DicomDir != NULL)
     {
-        /* create fully qualified pathname of the DICOM file to be added */
-        OFFilename pathname;
-        OFStandard::combineDirAndFilename(pathname, directory, filename, OFTrue /*allowEmptyDirName*/);
         /* then check the file name, load the file and check the content */
         DcmFileFormat fileformat;
         result = loadAndCheckDicomFile(filename, directory, fileformat, OFTrue /*checkFilename*/);
         if (result.good())
+            result = addCheckedDicomFile(filename, directory, fileformat);
+    }
+    return result;
+}
+
+
+// add DICOM files to the current DICOMDIR object
+OFCondition DicomDirInterface::addDicomFiles(const OFList<OFFilename> &filenames,
+                                             const OFFilename &directory,
+                                             OFList<OFFilename> &badFiles,
+                                             unsigned long &goodFiles)
+{
+    OFCondition result = EC_IllegalParameter;
+    goodFiles = 0;
+    /* first, make sure that a DICOMDIR object exists */
+    if (DicomDir != NULL)
+    {
+        result = EC_Normal;
+        /* the files are processed in chunks in order to limit the memory usage */
+        const size_t chunkSize = (NumberOfThreads > 1) ? 16 * NumberOfThreads : 1;
+        OFFilename *chunk = new OFFilename[chunkSize];
+        OFListConstIterator(OFFilename) iter = filenames.begin();
+        OFListConstIterator(OFFilename) last = filenames.end();
+        while ((iter != last) && result.good())
         {
-            DCMDATA_INFO("adding file: " << pathname);
-            /* start creating the DICOMDIR directory structure */
-            DcmDirectoryRecord *rootRecord = &(DicomDir->getRootRecord());
-            DcmMetaInfo *metainfo = fileformat.getMetaInfo();
-            /* massage filename into DICOM format (DOS conventions for path separators, uppercase) */
-            OFString fileID;
-            hostToDicomFilename(OFSTRING_GUARD(filename.getCharPointer()), fileID);
-            /* what kind of object (SOP Class) is stored in the file */
-            OFString sopClass;
-            metainfo->findAndGetOFString(DCM_MediaStorageSOPClassUID, sopClass);
-            /* if hanging protocol, palette or implant file then attach it to the root record and stop */
-            if (compare(sopClass, UID_HangingProtocolStorage))
-            {
-                /* add a hanging protocol record below the root */
-                if (addRecord(rootRecord, ERT_HangingProtocol, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            }
-            else if (compare(sopClass, UID_ColorPaletteStorage))
-            {
-                /* add a palette record below the root */
-                if (addRecord(rootRecord, ERT_Palette, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            }
-            else if (compare(sopClass, UID_GenericImplantTemplateStorage))
-            {
-                /* add an implant record below the root */
-                if (addRecord(rootRecord, ERT_Implant, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            }
-            else if (compare(sopClass, UID_ImplantAssemblyTemplateStorage))
+            Uint32 count = 0;
+            while ((iter != last) && (count < chunkSize))
+                chunk[count++] = *(iter++);
+            /* load and check the files of the current chunk (in parallel) */
+            DicomDirFileLoader loader(*this, chunk, count, directory);
+            loader.processAllFrames(NumberOfThreads);
+            /* then add them to the DICOMDIR in the given order */
+            for (Uint32 i = 0; (i < count) && result.good(); ++i)
             {
-                /* add an implant group record below the root */
-                if (addRecord(rootRecord, ERT_ImplantGroup, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
+                result = loader.getResult(i);
+                if (result.good())
+                    result = addCheckedDicomFile(chunk[i], directory, loader.getFileFormat(i));
+                if (result.bad())
+                {
+                    badFiles.push_back(chunk[i]);
+                    if (!AbortMode)
+                    {
+                        /* ignore inconsistent file, just warn (already done above) */
+                        result = EC_Normal;
+                    }
+                } else
+                    ++goodFiles;
             }
-            else if (compare(sopClass, UID_ImplantTemplateGroupStorage))
+        }
+        delete[] chunk;
+    }
+    return result;
+}
+
+
+// add DICOM file that has already been loaded and checked to the current DICOMDIR object
+OFCondition DicomDirInterface::addCheckedDicomFile(const OFFilename &filename,
+                                                   const OFFilename &directory,
+                                                   DcmFileFormat &fileformat)
+{
+    OFCondition result = EC_IllegalParameter;
+    /* first, make sure that a DICOMDIR object exists */
+    if (DicomDir != NULL)
+    {
+        result = EC_Normal;
+        /* create fully qualified pathname of the DICOM file to be added */
+        OFFilename pathname;
+        OFStandard::combineDirAndFilename(pathname, directory, filename, OFTrue /*allowEmptyDirName*/);
+        DCMDATA_INFO("adding file: " << pathname);
+        /* start creating the DICOMDIR directory structure */
+        DcmDirectoryRecord *rootRecord = &(DicomDir->getRootRecord());
+        DcmMetaInfo *metainfo = fileformat.getMetaInfo();
+        /* massage filename into DICOM format (DOS conventions for path separators, uppercase) */
+        OFString fileID;
+        hostToDicomFilename(OFSTRING_GUARD(filename.getCharPointer()), fileID);
+        /* what kind of object (SOP Class) is stored in the file */
+        OFString sopClass;
+        metainfo->findAndGetOFString(DCM_MediaStorageSOPClassUID, sopClass);
+        /* if hanging protocol, palette or implant file then attach it to the root record and stop */
+        if (compare(sopClass, UID_HangingProtocolStorage))
+        {
+            /* add a hanging protocol record below the root */
+            if (addRecord(rootRecord, ERT_HangingProtocol, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_ColorPaletteStorage))
+        {
+            /* add a palette record below the root */
+            if (addRecord(rootRecord, ERT_Palette, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_GenericImplantTemplateStorage))
+        {
+            /* add an implant record below the root */
+            if (addRecord(rootRecord, ERT_Implant, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_ImplantAssemblyTemplateStorage))
+        {
+            /* add an implant group record below the root */
+            if (addRecord(rootRecord, ERT_ImplantGroup, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        }
+        else if (compare(sopClass, UID_ImplantTemplateGroupStorage))
+        {
+            /* add an implant assy record below the root */
+            if (addRecord(rootRecord, ERT_ImplantAssy, &fileformat, fileID, pathname) == NULL)
+                result = EC_CorruptedData;
+        } else {
+            /* add a patient record below the root */
+            DcmDirectoryRecord *patientRecord = addRecord(rootRecord, ERT_Patient, &fileformat, fileID, pathname);
+            if (patientRecord != NULL)
             {
-                /* add an implant assy record below the root */
-                if (addRecord(rootRecord, ERT_ImplantAssy, &fileformat, fileID, pathname) == NULL)
-                    result = EC_CorruptedData;
-            } else {
-                /* add a patient record below the root */
-                DcmDirectoryRecord *patientRecord = addRecord(rootRecord, ERT_Patient, &fileformat, fileID, pathname);
-                if (patientRecord != NULL)
+                /* if patient management file then attach it to patient record and stop */
+                if (compare(sopClass, UID_RETIRED_DetachedPatientManagementMetaSOPClass))
                 {
-                    /* if patient management file then attach it to patient record and stop */
-                    if (compare(sopClass, UID_RETIRED_DetachedPatientManagementMetaSOPClass))
+                    result = patientRecord->assignToSOPFile(fileID.c_str(), pathname);
+                    DCMDATA_ERROR(result.text() << ": cannot assign patient record to file: " << pathname);
+                } else {
+                    /* add a study record below the current patient record */
+                    DcmDirectoryRecord *studyRecord = addRecord(patientRecord, ERT_Study, &fileformat, fileID, pathname);;
+                    if (studyRecord != NULL)
                     {
-                        result = patientRecord->assignToSOPFile(fileID.c_str(), pathname);
-                        DCMDATA_ERROR(result.text() << ": cannot assign patient record to file: " << pathname);
-                    } else {
-                        /* add a study record below the current patient record */
-                        DcmDirectoryRecord *studyRecord = addRecord(patientRecord, ERT_Study, &fileformat, fileID, pathname);;
-                        if (studyRecord != NULL)
+                        /* add a series record below the current study record */
+                        DcmDirectoryRecord *seriesRecord = addRecord(studyRecord, ERT_Series, &fileformat, fileID, pathname);;
+                        if (seriesRecord != NULL)
                         {
-                            /* add a series record below the current study record */
-                            DcmDirectoryRecord *seriesRecord = addRecord(studyRecord, ERT_Series, &fileformat, fileID, pathname);;
-                            if (seriesRecord != NULL)
-                            {
-                                /* add one of the instance record below the current series record */
-                                if (addRecord(seriesRecord, sopClassToRecordType(sopClass), &fileformat, fileID, pathname) == NULL)
-                                    result = EC_CorruptedData;
-                            } else
+                            /* add one of the instance record below the current series record */
+                            if (addRecord(seriesRecord, sopClassToRecordType(sopClass), &fileformat, fileID, pathname) == NULL)
                                 result = EC_CorruptedData;
                         } else
                             result = EC_CorruptedData;
-                    }
-                } else
-                    result = EC_CorruptedData;
-                /* invent missing attributes on all levels or PatientID only */
-                if (InventMode)
-                    inventMissingAttributes(rootRecord);
-                else if (InventPatientIDMode)
-                    inventMissingAttributes(rootRecord, OFFalse /*recurse*/);
-            }
+                    } else
+                        result = EC_CorruptedData;
+                }
+            } else
+                result = EC_CorruptedData;
+            /* invent missing attributes on all levels or PatientID only */
+            if (InventMode)
+                inventMissingAttributes(rootRecord);
+            else if (InventPatientIDMode)
+                inventMissingAttributes(rootRecord, OFFalse /*recurse*/);
         }
     }
     return result;
@@ -4768,6 +5401,18 @@ OFCondition DicomDirInterface::setDefaultIcon(const OFFilename &filename)
 }
 
 
+// set the number of threads used to load and check DICOM files
+unsigned int DicomDirInterface::setNumberOfThreads(const unsigned int numThreads)
+{
+    /* save current value */
+    unsigned int oldValue = NumberOfThreads;
+    /* set new value */
+    NumberOfThreads = (numThreads > 0) ? numThreads : 1;
+    /* return old value */
+    return oldValue;
+}
+
+
 // enable/disable the abort mode, i.e. abort on first inconsistent file (otherwise warn)
 OFBool DicomDirInterface::enableAbortMode(const OFBool newMode)
 {
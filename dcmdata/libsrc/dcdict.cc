@@ -787,6 +787,7 @@ DcmDataDictionary::findEntry(const char *name) const
 
 GlobalDcmDataDictionary::GlobalDcmDataDictionary()
   : dataDict(NULL)
+  , frozen(OFFalse)
 #ifdef WITH_THREADS
   , dataDictLock()
 #endif
@@ -821,6 +822,9 @@ void GlobalDcmDataDictionary::createDataDict()
 
 const DcmDataDictionary& GlobalDcmDataDictionary::rdlock()
 {
+  /* a frozen dictionary exists and is never modified, no locking needed */
+  if (frozen)
+    return *dataDict;
 #ifdef WITH_THREADS
   dataDictLock.rdlock();
 #endif
@@ -838,8 +842,17 @@ const DcmDataDictionary& GlobalDcmDataDictionary::rdlock()
   return *dataDict;
 }
 
-DcmDataDictionary& GlobalDcmDataDictionary::wrlock()
+DcmDataDictionary *GlobalDcmDataDictionary::wrlock()
 {
+  /* modifying a frozen dictionary is not permitted (see freeze()), since other
+   * threads access it without locking. Returning the dictionary anyway would
+   * result in a data race that could not be detected by the caller.
+   */
+  if (frozen)
+  {
+    DCMDATA_ERROR("GlobalDcmDataDictionary: write access to frozen data dictionary not permitted");
+    return NULL;
+  }
 #ifdef WITH_THREADS
   dataDictLock.wrlock();
 #endif
@@ -854,16 +867,41 @@ DcmDataDictionary& GlobalDcmDataDictionary::wrlock()
     dataDictLock.wrlock();
 #endif
   }
-  return *dataDict;
+  return dataDict;
 }
 
 void GlobalDcmDataDictionary::unlock()
 {
 #ifdef WITH_THREADS
-  dataDictLock.unlock();
+  if (!frozen)
+    dataDictLock.unlock();
 #endif
 }
 
+void GlobalDcmDataDictionary::freeze()
+{
+  if (!frozen)
+  {
+    /* make sure the dictionary exists, no other thread may be running */
+    wrlock();
+    frozen = OFTrue;
+#ifdef WITH_THREADS
+    dataDictLock.unlock();
+#endif
+  }
+}
+
+void GlobalDcmDataDictionary::unfreeze()
+{
+  /* no other thread may be running, so no locking needed */
+  frozen = OFFalse;
+}
+
+OFBool GlobalDcmDataDictionary::isFrozen() const
+{
+  return frozen;
+}
+
 OFBool GlobalDcmDataDictionary::isDictionaryLoaded()
 {
   OFBool result = rdlock().isDictionaryLoaded();
@@ -873,6 +911,14 @@ OFBool GlobalDcmDataDictionary::isDictionaryLoaded()
 
 void GlobalDcmDataDictionary::clear()
 {
-  wrlock().clear();
-  unlock();
+  /* no other threads may be active any more, so no locking needed */
+  if (frozen)
+  {
+    if (dataDict) dataDict->clear();
+  }
+  else
+  {
+    wrlock()->clear();
+    unlock();
+  }
 }
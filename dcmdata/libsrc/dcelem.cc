@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -54,7 +54,8 @@ DcmElement::DcmElement(const DcmTag &tag,
   : DcmObject(tag, len),
     fByteOrder(gLocalByteOrder),
     fLoadValue(NULL),
-    fValue(NULL)
+    fValue(NULL),
+    fValueArena(NULL)
 {
 }
 
@@ -63,7 +64,8 @@ DcmElement::DcmElement(const DcmElement &elem)
   : DcmObject(elem),
     fByteOrder(elem.fByteOrder),
     fLoadValue(NULL),
-    fValue(NULL)
+    fValue(NULL),
+    fValueArena(NULL)
 {
     if (elem.fValue)
     {
@@ -135,16 +137,9 @@ DcmElement &DcmElement::operator=(const DcmElement &obj)
 {
   if (this != &obj)
   {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-    // if created with the nothrow version it must also be deleted with
-    // the nothrow version else memory error.
-    operator delete[] (fValue, std::nothrow);
-#else
-    delete[] fValue;
-#endif
+    deleteValueField();
     delete fLoadValue;
     fLoadValue = NULL;
-    fValue = NULL;
 
     DcmObject::operator=(obj);
     fByteOrder = obj.fByteOrder;
@@ -258,13 +253,7 @@ OFCondition DcmElement::copyFrom(const DcmObject& rhs)
 
 DcmElement::~DcmElement()
 {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-    // if created with the nothrow version it must also be deleted with
-    // the nothrow version else memory error.
-    operator delete[] (fValue, std::nothrow);
-#else
-    delete[] fValue;
-#endif
+    deleteValueField();
     delete fLoadValue;
 }
 
@@ -275,14 +264,7 @@ DcmElement::~DcmElement()
 OFCondition DcmElement::clear()
 {
     errorFlag = EC_Normal;
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-    // if created with the nothrow version it must also be deleted with
-    // the nothrow version else memory error.
-    operator delete[] (fValue, std::nothrow);
-#else
-    delete[] fValue;
-#endif
-    fValue = NULL;
+    deleteValueField();
     delete fLoadValue;
     fLoadValue = NULL;
     setLengthField(0);
@@ -344,7 +326,10 @@ OFBool DcmElement::canWriteXfer(const E_TransferSyntax newXfer,
 OFCondition DcmElement::detachValueField(OFBool copy)
 {
     OFCondition l_error = EC_Normal;
-    if (getLengthField() != 0)
+    /* a value allocated from a memory arena cannot be handed over to the caller */
+    if ((fValueArena != NULL) && !copy)
+        l_error = EC_IllegalCall;
+    else if (getLengthField() != 0)
     {
         if (copy)
         {
@@ -371,6 +356,12 @@ OFCondition DcmElement::detachValueField(OFBool copy)
                 {
                     memcpy(newValue, fValue, size_t(getLengthField()));
                     fValue = newValue;
+                    /* the copy is allocated from the heap, so the arena is no longer needed */
+                    if (fValueArena != NULL)
+                    {
+                        fValueArena->release();
+                        fValueArena = NULL;
+                    }
                 } else {
                     /* the copy could not be created, so return an error */
                     l_error = EC_MemoryExhausted;
@@ -710,22 +701,7 @@ Uint8 *DcmElement::newValueField()
               return NULL;
         }
         /* create an array of Length+1 bytes */
-#ifdef HAVE_STD__NOTHROW
-        // we want to use a non-throwing new here if available.
-        // If the allocation fails, we report an EC_MemoryExhausted error
-        // back to the caller.
-        value = new (std::nothrow) Uint8[lengthField + 1];    // protocol error: odd value length
-#else
-        /* make sure that the pointer is set to NULL in case of error */
-        try
-        {
-            value = new Uint8[lengthField + 1];    // protocol error: odd value length
-        }
-        catch (STD_NAMESPACE bad_alloc const &)
-        {
-            value = NULL;
-        }
-#endif
+        value = newValueBuffer(lengthField + 1);
         /* if creation was successful, set last byte to 0 (in order to initialize this byte) */
         /* (no value will be assigned to this byte later, since Length was odd) */
         if (value)
@@ -739,30 +715,69 @@ Uint8 *DcmElement::newValueField()
     }
     /* if this element's length is even, create a corresponding array of Length bytes */
     else
+        value = newValueBuffer(lengthField);
+    /* if creation was not successful set member error flag correspondingly */
+    if (!value)
+        errorFlag = EC_MemoryExhausted;
+    /* return byte array */
+    return value;
+}
+
+
+Uint8 *DcmElement::newValueBuffer(const size_t size)
+{
+    Uint8 *value = NULL;
+#ifdef WITH_ARENA_ALLOCATION
+    /* small values are allocated from the current memory arena (if any) */
+    DcmMemoryArena *arena = DcmMemoryArena::getCurrentArena();
+    if ((arena != NULL) && (size <= arena->getMaxValueSize()))
+    {
+        value = OFstatic_cast(Uint8 *, arena->allocate(size));
+        if (value)
+            fValueArena = arena;
+    }
+#endif
+    if (!value)
+    {
 #ifdef HAVE_STD__NOTHROW
         // we want to use a non-throwing new here if available.
-        // If the allocation fails, we report an EC_MemoryExhausted error
-        // back to the caller.
-        value = new (std::nothrow) Uint8[lengthField];
+        value = new (std::nothrow) Uint8[size];
 #else
         /* make sure that the pointer is set to NULL in case of error */
         try
         {
-            value = new Uint8[lengthField];
+            value = new Uint8[size];
         }
         catch (STD_NAMESPACE bad_alloc const &)
         {
             value = NULL;
         }
 #endif
-    /* if creation was not successful set member error flag correspondingly */
-    if (!value)
-        errorFlag = EC_MemoryExhausted;
-    /* return byte array */
+    }
     return value;
 }
 
 
+void DcmElement::deleteValueField()
+{
+    if (fValueArena != NULL)
+    {
+        /* the memory itself is freed together with the arena */
+        fValueArena->release();
+        fValueArena = NULL;
+    } else {
+#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
+        // if created with the nothrow version it must also be deleted with
+        // the nothrow version else memory error.
+        operator delete[] (fValue, std::nothrow);
+#else
+        delete[] fValue;
+#endif
+    }
+    fValue = NULL;
+}
+
+
 // ********************************
 
 
@@ -831,13 +846,7 @@ OFCondition DcmElement::changeValue(const void *value,
                     memcpy(newValue, fValue, size_t(getLengthField()));
                     // copy value passed as a parameter to the end
                     memcpy(&newValue[getLengthField()], OFstatic_cast(const Uint8 *, value), size_t(num));
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-                    // if created with the nothrow version it must also be deleted with
-                    // the nothrow version else memory error.
-                    operator delete[] (fValue, std::nothrow);
-#else
-                    delete[] fValue;
-#endif
+                    deleteValueField();
                     fValue = newValue;
                     setLengthField(getLengthField() + num);
                 } else
@@ -998,17 +1007,7 @@ OFCondition DcmElement::putValue(const void * newValue,
 {
     errorFlag = EC_Normal;
 
-    if (fValue)
-    {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-        // if created with the nothrow version it must also be deleted with
-        // the nothrow version else memory error.
-        operator delete[] (fValue, std::nothrow);
-#else
-        delete[] fValue;
-#endif
-    }
-    fValue = NULL;
+    deleteValueField();
 
     if (fLoadValue)
         delete fLoadValue;
@@ -1061,17 +1060,7 @@ OFCondition DcmElement::createUint16Array(const Uint32 /*numWords*/,
 OFCondition DcmElement::createEmptyValue(const Uint32 length)
 {
     errorFlag = EC_Normal;
-    if (fValue)
-    {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-        // if created with the nothrow version it must also be deleted with
-        // the nothrow version else memory error.
-        operator delete[] (fValue, std::nothrow);
-#else
-        delete[] fValue;
-#endif
-    }
-    fValue = NULL;
+    deleteValueField();
     if (fLoadValue)
         delete fLoadValue;
     fLoadValue = NULL;
@@ -1177,13 +1166,7 @@ OFCondition DcmElement::read(DcmInputStream &inStream,
                     }
                 }
                 /* if there is already a value for this element, delete this value */
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-                // if created with the nothrow version it must also be deleted with
-                // the nothrow version else memory error.
-                operator delete[] (fValue, std::nothrow);
-#else
-                delete[] fValue;
-#endif
+                deleteValueField();
                 /* set the transfer state to ERW_inWork */
                 setTransferState(ERW_inWork);
             }
@@ -1794,8 +1777,7 @@ void DcmElement::compact()
   {
     DCMDATA_DEBUG("DcmElement::compact() removed element value of " << getTag()
         << " with " << getTransferredBytes() << " bytes");
-    delete[] fValue;
-    fValue = NULL;
+    deleteValueField();
     setTransferredBytes(0);
   }
 }
@@ -1807,14 +1789,7 @@ OFCondition DcmElement::createValueFromTempFile(DcmInputStreamFactory *factory,
 {
     if (factory && !(length & 1))
     {
-#if defined(HAVE_STD__NOTHROW) && defined(HAVE_NOTHROW_DELETE)
-        // if created with the nothrow version it must also be deleted with
-        // the nothrow version else memory error.
-        operator delete[] (fValue, std::nothrow);
-#else
-        delete[] fValue;
-#endif
-        fValue = 0;
+        deleteValueField();
         delete fLoadValue;
         fLoadValue = factory;
         fByteOrder = byteOrder;
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2014, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -63,10 +63,12 @@ makeOFConditionConst(EC_SequDelimitationItemMissing,     OFM_dcmdata, 34, OF_err
 makeOFConditionConst(EC_ItemDelimitationItemMissing,     OFM_dcmdata, 38, OF_error, "Item Delimitation Item missing"                 );
 makeOFConditionConst(EC_PrematureSequDelimitationItem,   OFM_dcmdata, 39, OF_error, "Sequence Delimitation Item occurred before Item was completely read");
 makeOFConditionConst(EC_InvalidDICOMDIR,                 OFM_dcmdata, 40, OF_error, "Invalid DICOMDIR");
+// error code 41 is reserved for background file write error messages (see below)
 
 const unsigned short EC_CODE_CannotSelectCharacterSet  = 35;
 const unsigned short EC_CODE_CannotConvertCharacterSet = 36;
 const unsigned short EC_CODE_CannotConvertToXML        = 37;
+const unsigned short EC_CODE_PipelinedFileWriteFailed  = 41;
 
 const char *dcmErrorConditionToString(OFCondition cond)
 {
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2012, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -25,22 +25,113 @@
 #include "dcmtk/dcmdata/dcerror.h"
 
 #define INCLUDE_CSTDIO
+#define INCLUDE_CSTRING
 #define INCLUDE_CERRNO
 #include "dcmtk/ofstd/ofstdinc.h"
 
+#ifdef HAVE_SYS_MMAN_H
+BEGIN_EXTERN_C
+#include <sys/mman.h>
+END_EXTERN_C
+#endif
+
+
+OFGlobal<OFBool> dcmUseMemoryMappedFiles(OFFalse);
+
+
+DcmFileMapping *DcmFileMapping::newInstance(OFFile &file, offile_off_t size)
+{
+#ifdef HAVE_SYS_MMAN_H
+  // the file has to fit into the address space
+  if ((size > 0) && (OFstatic_cast(offile_off_t, OFstatic_cast(size_t, size)) == size))
+  {
+    void *data = mmap(NULL, OFstatic_cast(size_t, size), PROT_READ, MAP_PRIVATE, file.fileNo(), 0);
+    if (data != MAP_FAILED)
+    {
+#ifdef MADV_SEQUENTIAL
+      // the parser reads the file from start to end
+      (void) madvise(data, OFstatic_cast(size_t, size), MADV_SEQUENTIAL);
+#endif
+      return new DcmFileMapping(OFstatic_cast(const Uint8 *, data), size);
+    }
+  }
+#else
+  // avoid compiler warnings on unused variables
+  (void) file;
+  (void) size;
+#endif
+  return NULL;
+}
 
-DcmFileProducer::DcmFileProducer(const OFFilename &filename, offile_off_t offset)
+DcmFileMapping::DcmFileMapping(const Uint8 *data, offile_off_t size)
+#ifdef WITH_THREADS
+: data_(data), size_(size), refCount_(1), mutex_()
+#else
+: data_(data), size_(size), refCount_(1)
+#endif
+{
+}
+
+DcmFileMapping::~DcmFileMapping()
+{
+#ifdef HAVE_SYS_MMAN_H
+  munmap(OFconst_cast(Uint8 *, data_), OFstatic_cast(size_t, size_));
+#endif
+}
+
+void DcmFileMapping::increaseRefCount()
+{
+#ifdef WITH_THREADS
+  mutex_.lock();
+#endif
+  ++refCount_;
+#ifdef WITH_THREADS
+  mutex_.unlock();
+#endif
+}
+
+void DcmFileMapping::decreaseRefCount()
+{
+#ifdef WITH_THREADS
+  mutex_.lock();
+#endif
+  size_t result = --refCount_;
+#ifdef WITH_THREADS
+  mutex_.unlock();
+#endif
+  if (result == 0) delete this;
+}
+
+/* ======================================================================= */
+
+DcmFileProducer::DcmFileProducer(const OFFilename &filename, offile_off_t offset, DcmFileMapping *mapping)
 : DcmProducer()
 , file_()
 , status_(EC_Normal)
 , size_(0)
+, mapping_(mapping)
+, mappedData_(NULL)
+, mappedPos_(0)
 {
-  if (file_.fopen(filename, "rb"))
+  if (mapping_)
+  {
+    // use the existing mapping, i.e. do not open and map the file again
+    mapping_->increaseRefCount();
+  }
+  else if (file_.fopen(filename, "rb"))
   {
      // Get number of bytes in file
      file_.fseek(0L, SEEK_END);
      size_ =  file_.ftell();
-     if (0 != file_.fseek(offset, SEEK_SET))
+     // Try to map the file into memory (if enabled)
+     if (dcmUseMemoryMappedFiles.get())
+       mapping_ = DcmFileMapping::newInstance(file_, size_);
+     if (mapping_)
+     {
+       // the mapping remains valid after the file has been closed
+       file_.fclose();
+     }
+     else if (0 != file_.fseek(offset, SEEK_SET))
      {
        OFString s("(unknown error code)");
        file_.getLastErrorString(s);
@@ -53,10 +144,17 @@ DcmFileProducer::DcmFileProducer(const OFFilename &filename, offile_off_t offset
     file_.getLastErrorString(s);
     status_ = makeOFCondition(OFM_dcmdata, 18, OF_error, s.c_str());
   }
+  if (mapping_)
+  {
+    mappedData_ = mapping_->data();
+    size_ = mapping_->size();
+    mappedPos_ = (offset < size_) ? offset : size_;
+  }
 }
 
 DcmFileProducer::~DcmFileProducer()
 {
+  if (mapping_) mapping_->decreaseRefCount();
 }
 
 OFBool DcmFileProducer::good() const
@@ -71,6 +169,7 @@ OFCondition DcmFileProducer::status() const
 
 OFBool DcmFileProducer::eos()
 {
+  if (mappedData_) return (mappedPos_ >= size_);
   if (file_.open())
   {
     return (file_.eof() || (size_ == file_.ftell()));
@@ -80,13 +179,20 @@ OFBool DcmFileProducer::eos()
 
 offile_off_t DcmFileProducer::avail()
 {
+  if (mappedData_) return size_ - mappedPos_;
   if (file_.open()) return size_ - file_.ftell(); else return 0;
 }
 
 offile_off_t DcmFileProducer::read(void *buf, offile_off_t buflen)
 {
   offile_off_t result = 0;
-  if (status_.good() && file_.open() && buf && buflen)
+  if (status_.good() && mappedData_ && buf && buflen)
+  {
+    result = (size_ - mappedPos_ < buflen) ? (size_ - mappedPos_) : buflen;
+    memcpy(buf, mappedData_ + mappedPos_, OFstatic_cast(size_t, result));
+    mappedPos_ += result;
+  }
+  else if (status_.good() && file_.open() && buf && buflen)
   {
     result = file_.fread(buf, 1, OFstatic_cast(size_t, buflen));
   }
@@ -96,7 +202,12 @@ offile_off_t DcmFileProducer::read(void *buf, offile_off_t buflen)
 offile_off_t DcmFileProducer::skip(offile_off_t skiplen)
 {
   offile_off_t result = 0;
-  if (status_.good() && file_.open() && skiplen)
+  if (status_.good() && mappedData_ && skiplen)
+  {
+    result = (size_ - mappedPos_ < skiplen) ? (size_ - mappedPos_) : skiplen;
+    mappedPos_ += result;
+  }
+  else if (status_.good() && file_.open() && skiplen)
   {
     offile_off_t pos = file_.ftell();
     result = (size_ - pos < skiplen) ? (size_ - pos) : skiplen;
@@ -112,7 +223,12 @@ offile_off_t DcmFileProducer::skip(offile_off_t skiplen)
 
 void DcmFileProducer::putback(offile_off_t num)
 {
-  if (status_.good() && file_.open() && num)
+  if (status_.good() && mappedData_ && num)
+  {
+    if (num <= mappedPos_) mappedPos_ -= num;
+    else status_ = EC_PutbackFailed; // tried to putback before start of file
+  }
+  else if (status_.good() && file_.open() && num)
   {
     offile_off_t pos = file_.ftell();
     if (num <= pos)
@@ -131,34 +247,39 @@ void DcmFileProducer::putback(offile_off_t num)
 
 /* ======================================================================= */
 
-DcmInputFileStreamFactory::DcmInputFileStreamFactory(const OFFilename &filename, offile_off_t offset)
+DcmInputFileStreamFactory::DcmInputFileStreamFactory(const OFFilename &filename, offile_off_t offset, DcmFileMapping *mapping)
 : DcmInputStreamFactory()
 , filename_(filename)
 , offset_(offset)
+, mapping_(mapping)
 {
+  if (mapping_) mapping_->increaseRefCount();
 }
 
 DcmInputFileStreamFactory::DcmInputFileStreamFactory(const DcmInputFileStreamFactory& arg)
 : DcmInputStreamFactory(arg)
 , filename_(arg.filename_)
 , offset_(arg.offset_)
+, mapping_(arg.mapping_)
 {
+  if (mapping_) mapping_->increaseRefCount();
 }
 
 DcmInputFileStreamFactory::~DcmInputFileStreamFactory()
 {
+  if (mapping_) mapping_->decreaseRefCount();
 }
 
 DcmInputStream *DcmInputFileStreamFactory::create() const
 {
-  return new DcmInputFileStream(filename_, offset_);
+  return new DcmInputFileStream(filename_, offset_, mapping_);
 }
 
 /* ======================================================================= */
 
-DcmInputFileStream::DcmInputFileStream(const OFFilename &filename, offile_off_t offset)
+DcmInputFileStream::DcmInputFileStream(const OFFilename &filename, offile_off_t offset, DcmFileMapping *mapping)
 : DcmInputStream(&producer_) // safe because DcmInputStream only stores pointer
-, producer_(filename, offset)
+, producer_(filename, offset, mapping)
 , filename_(filename)
 {
 }
@@ -173,7 +294,8 @@ DcmInputStreamFactory *DcmInputFileStream::newFactory() const
   if (currentProducer() == &producer_)
   {
     // no filter installed, can create factory object
-    result = new DcmInputFileStreamFactory(filename_, tell());
+    // deferred loading uses the same memory mapping (if any)
+    result = new DcmInputFileStreamFactory(filename_, tell(), producer_.mapping());
   }
   return result;
 }
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2010, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -26,7 +26,7 @@
 #include "dcmtk/dcmdata/dcistrmz.h"
 #include "dcmtk/dcmdata/dcerror.h"
 
-#define DCMZLIBINPUTFILTER_BUFSIZE 4096
+#define DCMZLIBINPUTFILTER_BUFSIZE 65536
 #define DCMZLIBINPUTFILTER_PUTBACKSIZE 1024
 
 OFGlobal<OFBool> dcmZlibExpectRFC1950Encoding(OFFalse);
@@ -172,6 +172,15 @@ offile_off_t DcmZLibInputFilter::read(void *buf, offile_off_t buflen)
       }
     }
 
+    // decompress large blocks of data directly into the user provided memory
+    if ((outputBufCount_ == 0) && (buflen >= DCMZLIBINPUTFILTER_PUTBACKSIZE))
+    {
+      availBytes = decompressDirect(target, buflen);
+      target += availBytes;
+      result += availBytes;
+      buflen -= availBytes;
+    }
+
     // refill output buffer
     fillOutputBuffer();
   } while (buflen && outputBufCount_);
@@ -395,6 +404,54 @@ offile_off_t DcmZLibInputFilter::decompress(const void *buf, offile_off_t buflen
   return result;
 }
 
+offile_off_t DcmZLibInputFilter::decompressDirect(unsigned char *buf, offile_off_t buflen)
+{
+  offile_off_t inputBytes = 0;
+  offile_off_t outputBytes = 0;
+  offile_off_t result = 0;
+  do
+  {
+    inputBytes = fillInputBuffer();
+
+    // zlib cannot handle more than 4 GB at once
+    offile_off_t numBytes = buflen - result;
+    if (numBytes > 0x40000000) numBytes = 0x40000000;
+    outputBytes = decompress(buf + result, numBytes);
+    result += outputBytes;
+  }
+  while ((result < buflen) && (inputBytes || outputBytes));
+
+  // keep the last bytes in the output ring buffer, which is empty, for putback
+  offile_off_t numBytes = result;
+  if (numBytes >= DCMZLIBINPUTFILTER_PUTBACKSIZE)
+  {
+    numBytes = DCMZLIBINPUTFILTER_PUTBACKSIZE;
+    outputBufStart_ = 0;
+    outputBufPutback_ = 0;
+  }
+  if (numBytes > 0)
+  {
+    // append to the existing putback bytes, there is enough space in the ring buffer
+    offile_off_t offset = outputBufStart_ + outputBufPutback_;
+    if (offset >= DCMZLIBINPUTFILTER_BUFSIZE) offset -= DCMZLIBINPUTFILTER_BUFSIZE;
+    offile_off_t availBytes = numBytes;
+    if (offset + availBytes > DCMZLIBINPUTFILTER_BUFSIZE) availBytes = DCMZLIBINPUTFILTER_BUFSIZE - offset;
+    memcpy(outputBuf_ + offset, buf + result - numBytes, OFstatic_cast(size_t, availBytes));
+    if (availBytes < numBytes)
+      memcpy(outputBuf_, buf + result - numBytes + availBytes, OFstatic_cast(size_t, numBytes - availBytes));
+
+    // adjust pointers
+    outputBufPutback_ += numBytes;
+    if (outputBufPutback_ > DCMZLIBINPUTFILTER_PUTBACKSIZE)
+    {
+      outputBufStart_ += outputBufPutback_ - DCMZLIBINPUTFILTER_PUTBACKSIZE;
+      if (outputBufStart_ >= DCMZLIBINPUTFILTER_BUFSIZE) outputBufStart_ -= DCMZLIBINPUTFILTER_BUFSIZE;
+      outputBufPutback_ = DCMZLIBINPUTFILTER_PUTBACKSIZE;
+    }
+  }
+  return result;
+}
+
 void DcmZLibInputFilter::fillOutputBuffer()
 {
   offile_off_t inputBytes = 0;
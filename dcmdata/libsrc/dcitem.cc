@@ -1236,6 +1236,16 @@ OFCondition DcmItem::read(DcmInputStream & inStream,
                           const E_TransferSyntax xfer,
                           const E_GrpLenEncoding glenc,
                           const Uint32 maxReadLength)
+{
+    return DcmItem::readUntilTag(inStream, xfer, glenc, maxReadLength, DCM_UndefinedTagKey);
+}
+
+
+OFCondition DcmItem::readUntilTag(DcmInputStream & inStream,
+                                  const E_TransferSyntax xfer,
+                                  const E_GrpLenEncoding glenc,
+                                  const Uint32 maxReadLength,
+                                  const DcmTagKey &stopParsingAtElement)
 {
     /* check if this is an illegal call; if so set the error flag and do nothing, else go ahead */
     if (getTransferState() == ERW_notInitialized)
@@ -1306,6 +1316,15 @@ OFCondition DcmItem::read(DcmInputStream & inStream,
                     /* while loop will be terminated.) */
                     if (errorFlag.bad())
                         break;
+                    /* check whether parsing should stop before this element (on dataset level only); */
+                    /* the value of this element and all following elements are not read at all */
+                    if ((stopParsingAtElement != DCM_UndefinedTagKey) && (newTag >= stopParsingAtElement) && (ident() == EVR_dataset))
+                    {
+                        DCMDATA_DEBUG("DcmItem::readUntilTag() Element " << newTag.getTagName() << " " << newTag
+                            << " encountered, skipping rest of dataset");
+                        readStopElem = OFTrue;
+                        break;
+                    }
                     /* If we get to this point, we just started reading the first part */
                     /* of an element; hence, lastElementComplete is not longer true */
                     lastElementComplete = OFFalse;
@@ -1388,7 +1407,7 @@ OFCondition DcmItem::read(DcmInputStream & inStream,
         setTransferState(ERW_ready);
 
     /* dump information if required */
-    DCMDATA_TRACE("DcmItem::read() returns error = " << errorFlag.text());
+    DCMDATA_TRACE("DcmItem::readUntilTag() returns error = " << errorFlag.text());
 
     /* return result value */
     return errorFlag;
@@ -1642,6 +1661,11 @@ OFCondition DcmItem::insert(DcmElement *elem,
     {
         DcmElement *dE;
         E_ListPos seekmode = ELP_last;
+        /* if the new element is not to be appended, use the tag index of elementList */
+        /* (if available) to start at the position where the element is to be inserted */
+        dE = OFstatic_cast(DcmElement *, elementList->seek(ELP_last));
+        if ((dE != NULL) && !(elem->getTag() > dE->getTag()) && elementList->seekTagPosition(elem->getTag()))
+            seekmode = ELP_atpos;
         /* iterate through elementList (from the last element to the first) */
         do {
             /* get current element from elementList */
@@ -1903,20 +1927,12 @@ DcmElement *DcmItem::remove(DcmObject *elem)
 DcmElement *DcmItem::remove(const DcmTagKey &tag)
 {
     errorFlag = EC_TagNotFound;
-    DcmObject *dO = NULL;
-    if (!elementList->empty())
+    DcmObject *dO = elementList->seekTag(tag);
+    if (dO != NULL)
     {
-        elementList->seek(ELP_first);
-        do {
-            dO = elementList->get();
-            if (dO->getTag() == tag)
-            {
-                elementList->remove();     // removes element from list but does not delete it
-                dO->setParent(NULL);       // forget about the parent
-                errorFlag = EC_Normal;
-                break;
-            }
-        } while (elementList->seek(ELP_next));
+        elementList->remove();     // removes element from list but does not delete it
+        dO->setParent(NULL);       // forget about the parent
+        errorFlag = EC_Normal;
     }
 
     if (errorFlag == EC_TagNotFound)
@@ -1984,27 +2000,29 @@ OFCondition DcmItem::searchSubFromHere(const DcmTagKey &tag,
 {
     DcmObject *dO;
     OFCondition l_error = EC_TagNotFound;
-    if (!elementList->empty())
+    if (!searchIntoSub)
+    {
+        /* the element list is sorted by tag, so use the (indexed) tag lookup */
+        dO = elementList->seekTag(tag);
+        if (dO != NULL)
+        {
+            resultStack.push(dO);
+            l_error = EC_Normal;
+            DCMDATA_TRACE("DcmItem::searchSubFromHere() Element " << tag << " found");
+        }
+    }
+    else if (!elementList->empty())
     {
         elementList->seek(ELP_first);
         do {
             dO = elementList->get();
-            if (searchIntoSub)
-            {
-                resultStack.push(dO);
-                if (dO->getTag() == tag)
-                    l_error = EC_Normal;
-                else
-                    l_error = dO->search(tag, resultStack, ESM_fromStackTop, OFTrue);
-                if (l_error.bad())
-                    resultStack.pop();
-            } else {
-                if (dO->getTag() == tag)
-                {
-                    resultStack.push(dO);
-                    l_error = EC_Normal;
-                }
-            }
+            resultStack.push(dO);
+            if (dO->getTag() == tag)
+                l_error = EC_Normal;
+            else
+                l_error = dO->search(tag, resultStack, ESM_fromStackTop, OFTrue);
+            if (l_error.bad())
+                resultStack.pop();
         } while (l_error.bad() && elementList->seek(ELP_next));
         if (l_error==EC_Normal && dO->getTag()==tag)
         {
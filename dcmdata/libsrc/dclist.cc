@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2010, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -55,7 +55,11 @@ DcmList::DcmList()
   : firstNode(NULL),
     lastNode(NULL),
     currentNode(NULL),
-    cardinality(0)
+    cardinality(0),
+    tagIndex(NULL),
+    tagIndexSize(0),
+    tagIndexValid(OFFalse),
+    tagIndexUnsorted(OFFalse)
 {
 }
 
@@ -76,6 +80,7 @@ DcmList::~DcmList()
         } while ( firstNode != NULL );
         currentNode = firstNode = lastNode = NULL;
     }
+    delete[] tagIndex;
 }
 
 
@@ -96,6 +101,7 @@ DcmObject *DcmList::append( DcmObject *obj )
             currentNode = lastNode = node;
         }
         cardinality++;
+        addToTagIndex(currentNode);
     } // obj == NULL
     return obj;
 }
@@ -118,6 +124,7 @@ DcmObject *DcmList::prepend( DcmObject *obj )
             currentNode = firstNode = node;
         }
         cardinality++;
+        addToTagIndex(currentNode);
     } // obj == NULL
     return obj;
 }
@@ -134,6 +141,7 @@ DcmObject *DcmList::insert( DcmObject *obj, E_ListPos pos )
         {
             currentNode = firstNode = lastNode = new DcmListNode(obj);
             cardinality++;
+            addToTagIndex(currentNode);
         }
         else {
             if ( pos==ELP_last )
@@ -156,6 +164,7 @@ DcmObject *DcmList::insert( DcmObject *obj, E_ListPos pos )
                 currentNode->prevNode = node;
                 currentNode = node;
                 cardinality++;
+                addToTagIndex(node);
             }
             else //( pos==ELP_next || pos==ELP_atpos )
                                                 // insert after current node
@@ -170,6 +179,7 @@ DcmObject *DcmList::insert( DcmObject *obj, E_ListPos pos )
                 currentNode->nextNode = node;
                 currentNode = node;
                 cardinality++;
+                addToTagIndex(node);
             }
         }
     } // obj == NULL
@@ -191,6 +201,7 @@ DcmObject *DcmList::remove()
         return NULL;                               // current node is 0
     else
     {
+        removeFromTagIndex(currentNode);
         tempnode = currentNode;
 
         if ( currentNode->prevNode == NULL )
@@ -292,4 +303,170 @@ void DcmList::deleteAllElements()
     lastNode = NULL;
     currentNode = NULL;
     cardinality = 0;
+    tagIndexValid = tagIndexUnsorted = OFFalse;
+}
+
+
+// ********************************
+
+
+OFBool DcmList::createTagIndex()
+{
+    if ( tagIndexSize < cardinality )
+    {
+        delete[] tagIndex;
+        tagIndexSize = cardinality;
+        tagIndex = new DcmListNode *[tagIndexSize];
+    }
+    unsigned long i = 0;
+    for (DcmListNode *node = firstNode; node != NULL; node = node->nextNode)
+    {
+        // binary search requires strictly ascending tags
+        if ( i > 0 && !(tagIndex[i - 1]->value()->getTag() < node->value()->getTag()) )
+        {
+            tagIndexUnsorted = OFTrue;
+            return OFFalse;
+        }
+        tagIndex[i++] = node;
+    }
+    tagIndexValid = OFTrue;
+    return OFTrue;
+}
+
+
+// ********************************
+
+
+OFBool DcmList::useTagIndex()
+{
+    return cardinality >= DCM_ListTagIndexThreshold && !tagIndexUnsorted &&
+           (tagIndexValid || createTagIndex());
+}
+
+
+// ********************************
+
+
+unsigned long DcmList::lowerBoundInTagIndex(const DcmTagKey &tag,
+                                            const unsigned long count) const
+{
+    unsigned long lower = 0;
+    unsigned long upper = count;
+    while ( lower < upper )
+    {
+        const unsigned long middle = lower + (upper - lower) / 2;
+        if ( tagIndex[middle]->value()->getTag() < tag )
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    return lower;
+}
+
+
+// ********************************
+
+
+void DcmList::addToTagIndex(DcmListNode *node)
+{
+    if ( !tagIndexValid )
+    {
+        // the list may be sorted now, check again on the next lookup
+        tagIndexUnsorted = OFFalse;
+        return;
+    }
+    const DcmTagKey &tag = node->value()->getTag();
+    if ( (node->prevNode != NULL && !(node->prevNode->value()->getTag() < tag)) ||
+         (node->nextNode != NULL && !(tag < node->nextNode->value()->getTag())) )
+    {
+        // the list is no longer sorted in strictly ascending tag order
+        tagIndexValid = OFFalse;
+        tagIndexUnsorted = OFTrue;
+        return;
+    }
+    // the index does not contain the new node yet
+    const unsigned long count = cardinality - 1;
+    if ( tagIndexSize < cardinality )
+    {
+        const unsigned long newSize = (2 * tagIndexSize > cardinality) ? 2 * tagIndexSize : cardinality;
+        DcmListNode **newIndex = new DcmListNode *[newSize];
+        for (unsigned long i = 0; i < count; i++)
+            newIndex[i] = tagIndex[i];
+        delete[] tagIndex;
+        tagIndex = newIndex;
+        tagIndexSize = newSize;
+    }
+    // elements are usually appended, so avoid the binary search in this case
+    const unsigned long pos = (node->nextNode == NULL) ? count : lowerBoundInTagIndex(tag, count);
+    for (unsigned long i = count; i > pos; i--)
+        tagIndex[i] = tagIndex[i - 1];
+    tagIndex[pos] = node;
+}
+
+
+// ********************************
+
+
+void DcmList::removeFromTagIndex(DcmListNode *node)
+{
+    if ( !tagIndexValid )
+    {
+        // the list may be sorted now, check again on the next lookup
+        tagIndexUnsorted = OFFalse;
+        return;
+    }
+    const unsigned long pos = lowerBoundInTagIndex(node->value()->getTag(), cardinality);
+    if ( pos < cardinality && tagIndex[pos] == node )
+    {
+        for (unsigned long i = pos + 1; i < cardinality; i++)
+            tagIndex[i - 1] = tagIndex[i];
+    }
+    else
+    {
+        // should never happen, recreate the index on the next lookup
+        tagIndexValid = OFFalse;
+    }
+}
+
+
+// ********************************
+
+
+DcmObject *DcmList::seekTag(const DcmTagKey &tag)
+{
+    if ( useTagIndex() )
+    {
+        const unsigned long pos = lowerBoundInTagIndex(tag, cardinality);
+        if ( pos < cardinality && tagIndex[pos]->value()->getTag() == tag )
+        {
+            currentNode = tagIndex[pos];
+            return currentNode->value();
+        }
+        currentNode = NULL;
+        return NULL;
+    }
+    // short or unsorted list: linear search
+    for (currentNode = firstNode; currentNode != NULL; currentNode = currentNode->nextNode)
+    {
+        if ( currentNode->value()->getTag() == tag )
+            return currentNode->value();
+    }
+    return NULL;
+}
+
+
+// ********************************
+
+
+OFBool DcmList::seekTagPosition(const DcmTagKey &tag)
+{
+    if ( !useTagIndex() )
+        return OFFalse;
+    // the entry before the first one with a greater tag key
+    const unsigned long pos = lowerBoundInTagIndex(tag, cardinality);
+    if ( pos < cardinality && tagIndex[pos]->value()->getTag() == tag )
+        currentNode = tagIndex[pos];
+    else
+        currentNode = (pos > 0) ? tagIndex[pos - 1] : NULL;
+    return OFTrue;
 }
@@ -0,0 +1,346 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DcmOutputPipelinedFileStream and related classes,
+ *    implements streamed output to files with a separate writer thread.
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dcostrmp.h"
+#include "dcmtk/dcmdata/dcerror.h"
+#include "dcmtk/dcmdata/dctypes.h"
+#include "dcmtk/ofstd/ofthread.h"
+
+#define INCLUDE_CSTRING
+#define INCLUDE_CERRNO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+/* semaphores are not available on Mac OS X, see ofthread.h */
+#if defined(WITH_THREADS) && !defined(_DARWIN_C_SOURCE)
+#define DCOSTRMP_USE_WRITER_THREAD
+#endif
+
+/* write in chunks of at most 32 MByte, see DcmFileConsumer::write() */
+#define DCOSTRMP_MAX_CHUNK_SIZE 33554432
+
+
+/** helper thread that writes the buffers of a DcmPipelinedFileConsumer
+ */
+class DcmPipelinedFileWriter: public OFThread
+{
+public:
+  /** constructor
+   *  @param consumer the consumer whose buffers are written
+   */
+  DcmPipelinedFileWriter(DcmPipelinedFileConsumer& consumer)
+  : OFThread()
+  , consumer_(consumer)
+  {
+  }
+
+protected:
+
+  /// thread workload
+  virtual void run()
+  {
+    consumer_.writeQueuedBuffers();
+  }
+
+private:
+
+  /// private unimplemented copy constructor
+  DcmPipelinedFileWriter(const DcmPipelinedFileWriter&);
+
+  /// private unimplemented copy assignment operator
+  DcmPipelinedFileWriter& operator=(const DcmPipelinedFileWriter&);
+
+  /// the consumer whose buffers are written
+  DcmPipelinedFileConsumer& consumer_;
+};
+
+
+/* ======================================================================= */
+
+/* create an error condition from the current value of errno */
+static OFCondition makeFileErrorCondition()
+{
+  char buf[256];
+  const char *text = OFStandard::strerror(errno, buf, sizeof(buf));
+  if (text == NULL) text = "(unknown error code)";
+  return makeOFCondition(OFM_dcmdata, EC_CODE_PipelinedFileWriteFailed, OF_error, text);
+}
+
+
+DcmPipelinedFileConsumer::DcmPipelinedFileConsumer(const OFFilename &filename,
+                                                   Uint32 numberOfBuffers,
+                                                   Uint32 bufferSize)
+: DcmConsumer()
+, file_()
+, status_(EC_Normal)
+, statusMutex_(NULL)
+, numberOfBuffers_(numberOfBuffers < 2 ? 2 : numberOfBuffers)
+, bufferSize_(bufferSize == 0 ? DCM_PipelinedFileDefaultBufferSize : bufferSize)
+, buffers_(NULL)
+, fillLevels_(NULL)
+, freeBuffers_(NULL)
+, filledBuffers_(NULL)
+, producerIndex_(0)
+, writerIndex_(0)
+, haveBuffer_(OFFalse)
+, currentFill_(0)
+, writer_(NULL)
+, closed_(OFFalse)
+{
+  if (!file_.fopen(filename, "wb"))
+  {
+    status_ = makeFileErrorCondition();
+    return;
+  }
+#ifdef DCOSTRMP_USE_WRITER_THREAD
+  statusMutex_ = new OFMutex();
+  freeBuffers_ = new OFSemaphore(numberOfBuffers_);
+  filledBuffers_ = new OFSemaphore(0);
+  buffers_ = new Uint8 *[numberOfBuffers_];
+  fillLevels_ = new Uint32[numberOfBuffers_];
+  for (Uint32 i = 0; i < numberOfBuffers_; ++i)
+  {
+    buffers_[i] = new Uint8[bufferSize_];
+    fillLevels_[i] = 0;
+  }
+  writer_ = new DcmPipelinedFileWriter(*this);
+  if (writer_->start() != 0)
+  {
+    DCMDATA_WARN("DcmPipelinedFileConsumer: cannot start writer thread, writing synchronously");
+    delete writer_;
+    writer_ = NULL;
+    deleteBuffers();
+  }
+#endif
+}
+
+DcmPipelinedFileConsumer::~DcmPipelinedFileConsumer()
+{
+  close();
+}
+
+OFBool DcmPipelinedFileConsumer::good() const
+{
+  return status().good();
+}
+
+OFCondition DcmPipelinedFileConsumer::status() const
+{
+  if (statusMutex_ == NULL)
+    return status_;
+  statusMutex_->lock();
+  OFCondition result = status_;
+  statusMutex_->unlock();
+  return result;
+}
+
+void DcmPipelinedFileConsumer::setStatus(const OFCondition& cond)
+{
+  if (statusMutex_ == NULL)
+    status_ = cond;
+  else
+  {
+    statusMutex_->lock();
+    status_ = cond;
+    statusMutex_->unlock();
+  }
+}
+
+OFBool DcmPipelinedFileConsumer::isFlushed() const
+{
+  return !haveBuffer_ || (currentFill_ == 0);
+}
+
+offile_off_t DcmPipelinedFileConsumer::avail() const
+{
+  // since we cannot report "unlimited", let's claim that we can still write 2GB.
+  // Note that offile_off_t is a signed type.
+  return 2147483647L;
+}
+
+offile_off_t DcmPipelinedFileConsumer::write(const void *buf, offile_off_t buflen)
+{
+  if (closed_ || (buf == NULL) || (buflen <= 0) || !good())
+    return 0;
+  // synchronous mode
+  if (writer_ == NULL)
+    return writeToFile(buf, buflen);
+#ifdef DCOSTRMP_USE_WRITER_THREAD
+  const Uint8 *data = OFstatic_cast(const Uint8 *, buf);
+  offile_off_t remaining = buflen;
+  while (remaining > 0)
+  {
+    // wait until the writer thread has released a buffer
+    if (!haveBuffer_)
+    {
+      freeBuffers_->wait();
+      haveBuffer_ = OFTrue;
+      currentFill_ = 0;
+    }
+    Uint32 count = bufferSize_ - currentFill_;
+    if (OFstatic_cast(offile_off_t, count) > remaining)
+      count = OFstatic_cast(Uint32, remaining);
+    memcpy(buffers_[producerIndex_] + currentFill_, data, count);
+    currentFill_ += count;
+    data += count;
+    remaining -= count;
+    if (currentFill_ == bufferSize_)
+      submitBuffer();
+  }
+#endif
+  return buflen;
+}
+
+void DcmPipelinedFileConsumer::flush()
+{
+  if (writer_ == NULL)
+    return;
+#ifdef DCOSTRMP_USE_WRITER_THREAD
+  if (haveBuffer_ && (currentFill_ > 0))
+    submitBuffer();
+  // wait until the writer thread has released all buffers that we do not hold
+  const Uint32 count = haveBuffer_ ? numberOfBuffers_ - 1 : numberOfBuffers_;
+  Uint32 i;
+  for (i = 0; i < count; ++i)
+    freeBuffers_->wait();
+  for (i = 0; i < count; ++i)
+    freeBuffers_->post();
+#endif
+}
+
+OFCondition DcmPipelinedFileConsumer::close()
+{
+  if (closed_)
+    return status_;
+  closed_ = OFTrue;
+#ifdef DCOSTRMP_USE_WRITER_THREAD
+  if (writer_ != NULL)
+  {
+    if (haveBuffer_ && (currentFill_ > 0))
+      submitBuffer();
+    // an empty buffer tells the writer thread to terminate
+    if (!haveBuffer_)
+      freeBuffers_->wait();
+    currentFill_ = 0;
+    submitBuffer();
+    writer_->join();
+    delete writer_;
+    writer_ = NULL;
+    deleteBuffers();
+  }
+#endif
+  if (file_.open() && (file_.fclose() != 0) && status_.good())
+    status_ = makeFileErrorCondition();
+  return status_;
+}
+
+void DcmPipelinedFileConsumer::submitBuffer()
+{
+#ifdef DCOSTRMP_USE_WRITER_THREAD
+  fillLevels_[producerIndex_] = currentFill_;
+  producerIndex_ = (producerIndex_ + 1) % numberOfBuffers_;
+  haveBuffer_ = OFFalse;
+  currentFill_ = 0;
+  filledBuffers_->post();
+#endif
+}
+
+void DcmPipelinedFileConsumer::writeQueuedBuffers()
+{
+#ifdef DCOSTRMP_USE_WRITER_THREAD
+  while (OFTrue)
+  {
+    filledBuffers_->wait();
+    const Uint32 length = fillLevels_[writerIndex_];
+    if (length == 0)
+      break;
+    // after an error, the remaining buffers are only released
+    if (good())
+      writeToFile(buffers_[writerIndex_], length);
+    writerIndex_ = (writerIndex_ + 1) % numberOfBuffers_;
+    freeBuffers_->post();
+  }
+#endif
+}
+
+offile_off_t DcmPipelinedFileConsumer::writeToFile(const void *buf, offile_off_t buflen)
+{
+  offile_off_t result = 0;
+  const char *data = OFstatic_cast(const char *, buf);
+  while (buflen > 0)
+  {
+    const size_t count = (buflen > DCOSTRMP_MAX_CHUNK_SIZE) ? DCOSTRMP_MAX_CHUNK_SIZE : OFstatic_cast(size_t, buflen);
+    const size_t written = file_.fwrite(data, 1, count);
+    result += OFstatic_cast(offile_off_t, written);
+    if (written != count)
+    {
+      setStatus(makeFileErrorCondition());
+      break;
+    }
+    data += written;
+    buflen -= OFstatic_cast(offile_off_t, written);
+  }
+  return result;
+}
+
+void DcmPipelinedFileConsumer::deleteBuffers()
+{
+  if (buffers_ != NULL)
+  {
+    for (Uint32 i = 0; i < numberOfBuffers_; ++i)
+      delete[] buffers_[i];
+    delete[] buffers_;
+    buffers_ = NULL;
+  }
+  delete[] fillLevels_;
+  fillLevels_ = NULL;
+#ifdef DCOSTRMP_USE_WRITER_THREAD
+  delete freeBuffers_;
+  freeBuffers_ = NULL;
+  delete filledBuffers_;
+  filledBuffers_ = NULL;
+  delete statusMutex_;
+  statusMutex_ = NULL;
+#endif
+}
+
+/* ======================================================================= */
+
+DcmOutputPipelinedFileStream::DcmOutputPipelinedFileStream(const OFFilename &filename,
+                                                           Uint32 numberOfBuffers,
+                                                           Uint32 bufferSize)
+: DcmOutputStream(&consumer_) // safe because DcmOutputStream only stores pointer
+, consumer_(filename, numberOfBuffers, bufferSize)
+{
+}
+
+DcmOutputPipelinedFileStream::~DcmOutputPipelinedFileStream()
+{
+  // last attempt to write all data before file is closed
+  close();
+}
+
+OFCondition DcmOutputPipelinedFileStream::close()
+{
+  flush();
+  return consumer_.close();
+}
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2010, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -25,9 +25,21 @@
 
 #include "dcmtk/dcmdata/dcostrmz.h"
 #include "dcmtk/dcmdata/dcerror.h"
+#include "dcmtk/dcmdata/dcparfrm.h"   /* for DcmParallelFrameProcessor */
 
 #define DCMZLIBOUTPUTFILTER_BUFSIZE 4096
 
+/* size of the blocks that are compressed independently of each other */
+#define DCMZLIBOUTPUTFILTER_BLOCKSIZE 131072
+
+/* maximum size of the preset dictionary, i.e. the deflate window size */
+#define DCMZLIBOUTPUTFILTER_DICTSIZE 32768
+
+/* minimum free space in a batch, i.e. the largest tag and length header
+ * that the DcmObject write methods only write "en bloc" (DCM_TagInfoLength)
+ */
+#define DCMZLIBOUTPUTFILTER_MINAVAIL 12
+
 /* taken from zutil.h */
 #if MAX_MEM_LEVEL >= 8
 #define DEF_MEM_LEVEL 8
@@ -36,9 +48,16 @@
 #endif
 
 OFGlobal<int> dcmZlibCompressionLevel(Z_DEFAULT_COMPRESSION);
+OFGlobal<Uint32> dcmZlibCompressionThreads(1);
 
-// helper method to fix old-style casts warnings
+// helper methods to fix old-style casts warnings
 BEGIN_EXTERN_C
+static int OFdeflateInit2(z_stream* const stream, int level)
+{
+  /* windowBits is passed < 0 to suppress zlib header */
+  return deflateInit2(stream, level, Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+}
+
 static int OFdeflateInit(z_stream* const stream, int level)
 {
 #ifdef ZLIB_ENCODE_RFC1950_HEADER
@@ -49,16 +68,337 @@ static int OFdeflateInit(z_stream* const stream, int level)
    */
   return deflateInit(stream, level);
 #else
-  /* windowBits is passed < 0 to suppress zlib header */
-  return deflateInit2(stream, level, Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+  return OFdeflateInit2(stream, level);
 #endif
 }
 END_EXTERN_C
 
+
+/** helper class for the parallel compression of a deflated stream.
+ *  The input is collected in batches of one block per thread.  Each block
+ *  is compressed by a separate zlib stream, primed with the last 32 KB of
+ *  uncompressed data preceding the block as a preset dictionary, and ends
+ *  with a sync flush (or the end of the stream for the last block).  Since
+ *  the output of each block ends on a byte boundary, the compressed blocks
+ *  simply have to be concatenated, which results in a single valid deflated
+ *  bitstream (RFC 1951) that can be decompressed by any inflater.
+ */
+class DcmZLibBlockCompressor : public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param numberOfThreads number of threads, i.e. blocks per batch
+   *  @param level compression level
+   */
+  DcmZLibBlockCompressor(Uint32 numberOfThreads, int level)
+  : DcmParallelFrameProcessor(numberOfThreads)
+  , numberOfThreads_(numberOfThreads)
+  , status_(EC_Normal)
+  , streams_(new z_stream[numberOfThreads])
+  , initialized_(0)
+  , inputBuf_(new unsigned char[DCMZLIBOUTPUTFILTER_DICTSIZE + numberOfThreads * DCMZLIBOUTPUTFILTER_BLOCKSIZE])
+  , inputBufCount_(0)
+  , dictionaryLength_(0)
+  , finalize_(OFFalse)
+  , finished_(OFFalse)
+  , outputBuf_(new unsigned char *[numberOfThreads])
+  , outputBufSize_(new size_t[numberOfThreads])
+  , outputBufCount_(new size_t[numberOfThreads])
+  , outputBlock_(numberOfThreads)
+  , outputOffset_(0)
+  {
+    for (Uint32 i = 0; i < numberOfThreads_; ++i)
+    {
+      outputBuf_[i] = NULL;
+      outputBufSize_[i] = 0;
+      outputBufCount_[i] = 0;
+    }
+    while (status_.good() && (initialized_ < numberOfThreads_))
+    {
+      z_streamp zstream = &streams_[initialized_];
+      zstream->zalloc = Z_NULL;
+      zstream->zfree = Z_NULL;
+      zstream->opaque = Z_NULL;
+      /* the preset dictionary requires a raw deflate stream, i.e. RFC 1951 */
+      if (Z_OK == OFdeflateInit2(zstream, level))
+        ++initialized_;
+      else
+        status_ = makeZLibError(zstream);
+    }
+  }
+
+  /// destructor
+  virtual ~DcmZLibBlockCompressor()
+  {
+    for (Uint32 i = 0; i < initialized_; ++i)
+      deflateEnd(&streams_[i]);
+    for (Uint32 j = 0; j < numberOfThreads_; ++j)
+      delete[] outputBuf_[j];
+    delete[] streams_;
+    delete[] inputBuf_;
+    delete[] outputBuf_;
+    delete[] outputBufSize_;
+    delete[] outputBufCount_;
+  }
+
+  /** returns the status of the compressor
+   *  @return status, EC_Normal if good
+   */
+  OFCondition status() const
+  {
+    return status_;
+  }
+
+  /** writes pending output to the consumer, compresses the current batch if it
+   *  is (almost) complete, and returns the number of bytes that can be written with
+   *  the next call to write(). Since the DcmObject write methods only call write()
+   *  if there is enough space for a complete tag and length header, a batch with
+   *  less free space is closed early. Otherwise, the caller might never get any
+   *  space, e.g. in case of I/O suspension.
+   *  @param consumer consumer to which compressed output is written
+   *  @return number of free bytes in the current batch
+   */
+  offile_off_t makeSpaceAndGetAvail(DcmConsumer& consumer)
+  {
+    makeSpace(consumer);
+    if (status_.good() && !finished_) return numberOfThreads_ * DCMZLIBOUTPUTFILTER_BLOCKSIZE - inputBufCount_;
+    else return 0;
+  }
+
+  /** returns true if all data has been compressed and written to the consumer
+   *  @return true if flushed, false otherwise
+   */
+  OFBool isFlushed() const
+  {
+    return finished_ && (outputBlock_ == numberOfThreads_);
+  }
+
+  /** adds data to the current batch. A complete batch is compressed at once and
+   *  written to the consumer, unless the output of the previous batch is still pending.
+   *  @param consumer consumer to which compressed output is written
+   *  @param buf pointer to input data
+   *  @param buflen number of bytes in buf
+   *  @return number of bytes processed
+   */
+  offile_off_t write(DcmConsumer& consumer, const void *buf, offile_off_t buflen)
+  {
+    const offile_off_t batchSize = numberOfThreads_ * DCMZLIBOUTPUTFILTER_BLOCKSIZE;
+    const unsigned char *data = OFstatic_cast(const unsigned char *, buf);
+    offile_off_t result = 0;
+    makeSpace(consumer);
+    while (status_.good() && !finished_ && (result < buflen) && (inputBufCount_ < batchSize))
+    {
+      offile_off_t len = batchSize - inputBufCount_;
+      if (len > buflen - result) len = buflen - result;
+      memcpy(inputBuf_ + DCMZLIBOUTPUTFILTER_DICTSIZE + inputBufCount_, data + result, OFstatic_cast(size_t, len));
+      inputBufCount_ += len;
+      result += len;
+      makeSpace(consumer);
+    }
+    return result;
+  }
+
+  /** compresses the remaining data as the end of the stream and writes the output
+   *  to the consumer until complete or the consumer becomes full
+   *  @param consumer consumer to which compressed output is written
+   */
+  void flush(DcmConsumer& consumer)
+  {
+    flushOutput(consumer);
+    if (status_.good() && !finished_ && (outputBlock_ == numberOfThreads_))
+    {
+      compressBatch(OFTrue);
+      finished_ = OFTrue;
+      flushOutput(consumer);
+    }
+  }
+
+  /** compresses a single block of the current batch
+   *  @param frameNo index of the block
+   *  @param threadNo index of the calling thread, selects the zlib stream
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, Uint32 threadNo)
+  {
+    outputBufCount_[frameNo] = 0;
+    const offile_off_t start = OFstatic_cast(offile_off_t, frameNo) * DCMZLIBOUTPUTFILTER_BLOCKSIZE;
+    // the last batch may contain less blocks, but the stream has to be finished in any case
+    if ((start >= inputBufCount_) && !(finalize_ && (frameNo == 0)))
+      return EC_Normal;
+    offile_off_t length = inputBufCount_ - start;
+    if (length > DCMZLIBOUTPUTFILTER_BLOCKSIZE) length = DCMZLIBOUTPUTFILTER_BLOCKSIZE;
+    const OFBool lastBlock = finalize_ && (start + length == inputBufCount_);
+    unsigned char *blockData = inputBuf_ + DCMZLIBOUTPUTFILTER_DICTSIZE + start;
+
+    z_streamp zstream = &streams_[threadNo];
+    if (deflateReset(zstream) != Z_OK)
+      return makeZLibError(zstream);
+    // prime the stream with the data preceding the block
+    offile_off_t dictLength = start + dictionaryLength_;
+    if (dictLength > DCMZLIBOUTPUTFILTER_DICTSIZE) dictLength = DCMZLIBOUTPUTFILTER_DICTSIZE;
+    if ((dictLength > 0) && (deflateSetDictionary(zstream, blockData - dictLength, OFstatic_cast(uInt, dictLength)) != Z_OK))
+      return makeZLibError(zstream);
+
+    // make sure that the output buffer is large enough for the usual case
+    const size_t bound = OFstatic_cast(size_t, deflateBound(zstream, OFstatic_cast(uLong, length))) + 16;
+    if (outputBufSize_[frameNo] < bound)
+    {
+      delete[] outputBuf_[frameNo];
+      outputBuf_[frameNo] = new unsigned char[bound];
+      outputBufSize_[frameNo] = bound;
+    }
+    zstream->next_in = blockData;
+    zstream->avail_in = OFstatic_cast(uInt, length);
+    const int flush = lastBlock ? Z_FINISH : Z_SYNC_FLUSH;
+    while (OFTrue)
+    {
+      zstream->next_out = outputBuf_[frameNo] + outputBufCount_[frameNo];
+      zstream->avail_out = OFstatic_cast(uInt, outputBufSize_[frameNo] - outputBufCount_[frameNo]);
+      const int zstatus = deflate(zstream, flush);
+      outputBufCount_[frameNo] = outputBufSize_[frameNo] - zstream->avail_out;
+      if ((zstatus != Z_OK) && (zstatus != Z_STREAM_END) && (zstatus != Z_BUF_ERROR))
+        return makeZLibError(zstream);
+      // the flush is complete if there is space left in the output buffer
+      if (lastBlock ? (zstatus == Z_STREAM_END) : ((zstream->avail_in == 0) && (zstream->avail_out > 0)))
+        break;
+      // output buffer is full, enlarge it
+      unsigned char *newBuf = new unsigned char[2 * outputBufSize_[frameNo]];
+      memcpy(newBuf, outputBuf_[frameNo], outputBufCount_[frameNo]);
+      delete[] outputBuf_[frameNo];
+      outputBuf_[frameNo] = newBuf;
+      outputBufSize_[frameNo] *= 2;
+    }
+    return EC_Normal;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmZLibBlockCompressor(const DcmZLibBlockCompressor&);
+
+  /// private undefined copy assignment operator
+  DcmZLibBlockCompressor& operator=(const DcmZLibBlockCompressor&);
+
+  /** creates an error condition from the message of the given zlib stream
+   *  @param zstream zlib stream
+   *  @return error condition
+   */
+  static OFCondition makeZLibError(z_streamp zstream)
+  {
+    OFString etext = "ZLib Error: ";
+    if (zstream->msg) etext += zstream->msg;
+    return makeOFCondition(OFM_dcmdata, 16, OF_error, etext.c_str());
+  }
+
+  /** writes pending output to the consumer and compresses the current batch if
+   *  the output of the previous batch has been written and the free space left in
+   *  the current batch is too small for a tag and length header. Such a batch is
+   *  closed early, its last block simply ends with a sync flush like any other.
+   *  @param consumer consumer to which compressed output is written
+   */
+  void makeSpace(DcmConsumer& consumer)
+  {
+    flushOutput(consumer);
+    if (status_.good() && !finished_ && (outputBlock_ == numberOfThreads_) &&
+        (inputBufCount_ > numberOfThreads_ * DCMZLIBOUTPUTFILTER_BLOCKSIZE - DCMZLIBOUTPUTFILTER_MINAVAIL))
+    {
+      compressBatch(OFFalse);
+      flushOutput(consumer);
+    }
+  }
+
+  /** compresses all blocks of the current batch (in parallel) and keeps the end
+   *  of the batch as the preset dictionary for the next one
+   *  @param finalize true if the current batch is the end of the input stream
+   */
+  void compressBatch(OFBool finalize)
+  {
+    finalize_ = finalize;
+    status_ = processAllFrames(numberOfThreads_);
+    if (status_.good())
+    {
+      // move the last bytes of uncompressed data in front of the next batch
+      offile_off_t dictLength = inputBufCount_ + dictionaryLength_;
+      if (dictLength > DCMZLIBOUTPUTFILTER_DICTSIZE) dictLength = DCMZLIBOUTPUTFILTER_DICTSIZE;
+      memmove(inputBuf_ + DCMZLIBOUTPUTFILTER_DICTSIZE - dictLength,
+        inputBuf_ + DCMZLIBOUTPUTFILTER_DICTSIZE + inputBufCount_ - dictLength, OFstatic_cast(size_t, dictLength));
+      dictionaryLength_ = dictLength;
+      inputBufCount_ = 0;
+      outputBlock_ = 0;
+      outputOffset_ = 0;
+    }
+  }
+
+  /** writes the compressed blocks of the last batch to the consumer
+   *  until complete or the consumer becomes full
+   *  @param consumer consumer to which compressed output is written
+   */
+  void flushOutput(DcmConsumer& consumer)
+  {
+    while (status_.good() && (outputBlock_ < numberOfThreads_))
+    {
+      const offile_off_t numBytes = OFstatic_cast(offile_off_t, outputBufCount_[outputBlock_]) - outputOffset_;
+      if (numBytes > 0)
+      {
+        const offile_off_t written = consumer.write(outputBuf_[outputBlock_] + outputOffset_, numBytes);
+        outputOffset_ += written;
+        if (written < numBytes) break; // consumer suspension
+      }
+      ++outputBlock_;
+      outputOffset_ = 0;
+    }
+  }
+
+  /// number of threads, i.e. number of blocks per batch
+  Uint32 numberOfThreads_;
+
+  /// status
+  OFCondition status_;
+
+  /// zlib streams, one per thread
+  z_stream *streams_;
+
+  /// number of successfully initialized zlib streams
+  Uint32 initialized_;
+
+  /// input buffer, starting with the preset dictionary followed by the current batch
+  unsigned char *inputBuf_;
+
+  /// number of bytes in the current batch
+  offile_off_t inputBufCount_;
+
+  /// number of bytes of the preset dictionary in front of the current batch
+  offile_off_t dictionaryLength_;
+
+  /// true if the current batch is being compressed as the end of the stream
+  OFBool finalize_;
+
+  /// true if the end of the stream has been compressed
+  OFBool finished_;
+
+  /// output buffers, one per block
+  unsigned char **outputBuf_;
+
+  /// size of each output buffer
+  size_t *outputBufSize_;
+
+  /// number of compressed bytes in each output buffer
+  size_t *outputBufCount_;
+
+  /// index of the block that is currently written to the consumer
+  Uint32 outputBlock_;
+
+  /// number of bytes of the current block already written to the consumer
+  offile_off_t outputOffset_;
+};
+
+
 DcmZLibOutputFilter::DcmZLibOutputFilter()
 : DcmOutputFilter()
 , current_(NULL)
 , zstream_(new z_stream)
+, blockCompressor_(NULL)
 , status_(EC_MemoryExhausted)
 , flushed_(OFFalse)
 , inputBuf_(new unsigned char[DCMZLIBOUTPUTFILTER_BUFSIZE])
@@ -68,6 +408,16 @@ DcmZLibOutputFilter::DcmZLibOutputFilter()
 , outputBufStart_(0)
 , outputBufCount_(0)
 {
+#ifndef ZLIB_ENCODE_RFC1950_HEADER
+  const Uint32 numberOfThreads = dcmZlibCompressionThreads.get();
+  if (numberOfThreads > 1)
+  {
+    /* compress blocks of data in parallel instead of using a single zlib stream */
+    blockCompressor_ = new DcmZLibBlockCompressor(numberOfThreads, dcmZlibCompressionLevel.get());
+    status_ = blockCompressor_->status();
+  }
+  else
+#endif
   if (zstream_ && inputBuf_ && outputBuf_)
   {
     zstream_->zalloc = Z_NULL;
@@ -88,9 +438,11 @@ DcmZLibOutputFilter::~DcmZLibOutputFilter()
 {
   if (zstream_)
   {
-    deflateEnd(zstream_); // discards any unprocessed input and does not flush any pending output
+    // discards any unprocessed input and does not flush any pending output
+    if (blockCompressor_ == NULL) deflateEnd(zstream_);
     delete zstream_;
   }
+  delete blockCompressor_;
   delete[] inputBuf_;
   delete[] outputBuf_;
 }
@@ -98,23 +450,28 @@ DcmZLibOutputFilter::~DcmZLibOutputFilter()
 
 OFBool DcmZLibOutputFilter::good() const
 {
-  return status_.good();
+  return status().good();
 }
 
 OFCondition DcmZLibOutputFilter::status() const
 {
+  if (blockCompressor_) return blockCompressor_->status();
   return status_;
 }
 
 OFBool DcmZLibOutputFilter::isFlushed() const
 {
-  if (status_.bad() || (current_ == NULL)) return OFTrue;
+  if (status().bad() || (current_ == NULL)) return OFTrue;
+  if (blockCompressor_) return blockCompressor_->isFlushed() && current_->isFlushed();
   return (inputBufCount_ == 0) && (outputBufCount_ == 0) && flushed_ && current_->isFlushed();
 }
 
 
 offile_off_t DcmZLibOutputFilter::avail() const
 {
+  // the block compressor is not part of the logical state of this filter
+  if (blockCompressor_) return current_ ? blockCompressor_->makeSpaceAndGetAvail(*current_) : 0;
+
   // compute number of bytes available in input buffer
   if (status_.good() ) return DCMZLIBOUTPUTFILTER_BUFSIZE - inputBufCount_;
     else return 0;
@@ -281,7 +638,8 @@ offile_off_t DcmZLibOutputFilter::compress(const void *buf, offile_off_t buflen,
 
 offile_off_t DcmZLibOutputFilter::write(const void *buf, offile_off_t buflen)
 {
-  if (status_.bad() || (current_ == NULL)) return 0;
+  if (status().bad() || (current_ == NULL)) return 0;
+  if (blockCompressor_) return blockCompressor_->write(*current_, buf, buflen);
 
   // flush output buffer if necessary
   if (outputBufCount_ == DCMZLIBOUTPUTFILTER_BUFSIZE) flushOutputBuffer();
@@ -316,7 +674,11 @@ offile_off_t DcmZLibOutputFilter::write(const void *buf, offile_off_t buflen)
 
 void DcmZLibOutputFilter::flush()
 {
-  if (status_.good() && current_)
+  if (blockCompressor_)
+  {
+    if (current_) blockCompressor_->flush(*current_);
+  }
+  else if (status_.good() && current_)
   {
     // flush output buffer first
     if (outputBufCount_ == DCMZLIBOUTPUTFILTER_BUFSIZE) flushOutputBuffer();
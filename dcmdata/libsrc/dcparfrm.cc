@@ -0,0 +1,173 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: class DcmParallelFrameProcessor
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+#include "dcmtk/dcmdata/dcparfrm.h"
+#include "dcmtk/dcmdata/dcerror.h"     /* for EC_Normal */
+#include "dcmtk/dcmdata/dctypes.h"     /* for DCMDATA_WARN() */
+
+
+/** worker thread fetching and processing frames of a DcmParallelFrameProcessor
+ */
+class DcmParallelFrameThread : public OFThread
+{
+public:
+
+  /** constructor
+   *  @param processor frame processor, not deleted by this object
+   *  @param threadNo index of this thread
+   */
+  DcmParallelFrameThread(DcmParallelFrameProcessor& processor, Uint32 threadNo)
+  : OFThread()
+  , processor_(processor)
+  , threadNo_(threadNo)
+  {
+  }
+
+  /// destructor
+  virtual ~DcmParallelFrameThread()
+  {
+  }
+
+  /** processes frames until all frames have been assigned
+   *  or processing has been aborted
+   */
+  virtual void run()
+  {
+    Uint32 frameNo = 0;
+    while (processor_.nextFrame(frameNo))
+      processor_.frameDone(frameNo, processor_.processFrame(frameNo, threadNo_));
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmParallelFrameThread(const DcmParallelFrameThread&);
+
+  /// private undefined copy assignment operator
+  DcmParallelFrameThread& operator=(const DcmParallelFrameThread&);
+
+  /// frame processor
+  DcmParallelFrameProcessor& processor_;
+
+  /// index of this thread
+  Uint32 threadNo_;
+};
+
+
+DcmParallelFrameProcessor::DcmParallelFrameProcessor(Uint32 numberOfFrames)
+: numberOfFrames_(numberOfFrames)
+, nextFrame_(0)
+, errorFrame_(numberOfFrames)
+, errorResult_(EC_Normal)
+, mutex_()
+{
+}
+
+
+DcmParallelFrameProcessor::~DcmParallelFrameProcessor()
+{
+}
+
+
+Uint32 DcmParallelFrameProcessor::getNumberOfThreadsUsed(Uint32 numberOfThreads) const
+{
+#ifdef WITH_THREADS
+  if (numberOfThreads > numberOfFrames_) numberOfThreads = numberOfFrames_;
+  return (numberOfThreads > 1) ? numberOfThreads : 1;
+#else
+  (void) numberOfThreads;
+  return 1;
+#endif
+}
+
+
+OFBool DcmParallelFrameProcessor::nextFrame(Uint32& frameNo)
+{
+  OFBool result = OFFalse;
+  mutex_.lock();
+  // do not start any new frame after an error has occurred
+  if (errorResult_.good() && (nextFrame_ < numberOfFrames_))
+  {
+    frameNo = nextFrame_++;
+    result = OFTrue;
+  }
+  mutex_.unlock();
+  return result;
+}
+
+
+void DcmParallelFrameProcessor::frameDone(Uint32 frameNo, const OFCondition& result)
+{
+  if (result.bad())
+  {
+    mutex_.lock();
+    if (frameNo < errorFrame_)
+    {
+      errorFrame_ = frameNo;
+      errorResult_ = result;
+    }
+    mutex_.unlock();
+  }
+}
+
+
+OFCondition DcmParallelFrameProcessor::processAllFrames(Uint32 numberOfThreads)
+{
+  nextFrame_ = 0;
+  errorFrame_ = numberOfFrames_;
+  errorResult_ = EC_Normal;
+
+  const Uint32 threadCount = getNumberOfThreadsUsed(numberOfThreads);
+  if (threadCount > 1)
+  {
+    DcmParallelFrameThread **threads = new DcmParallelFrameThread *[threadCount];
+    Uint32 started = 0;
+    Uint32 i;
+    for (i = 0; i < threadCount; ++i)
+    {
+      threads[i] = new DcmParallelFrameThread(*this, i);
+      if (threads[i]->start() != 0)
+      {
+        // could not create thread, the ones already running (if any) will do the work
+        DCMDATA_WARN("DcmParallelFrameProcessor: cannot create worker thread, using " << started << " thread(s) only");
+        delete threads[i];
+        break;
+      }
+      ++started;
+    }
+    for (i = 0; i < started; ++i)
+    {
+      threads[i]->join();
+      delete threads[i];
+    }
+    delete[] threads;
+    // no thread could be started at all, fall back to sequential processing below
+    if (started > 0) return errorResult_;
+  }
+
+  // process all frames in the calling thread
+  Uint32 frameNo = 0;
+  while (nextFrame(frameNo))
+    frameDone(frameNo, processFrame(frameNo, 0));
+  return errorResult_;
+}
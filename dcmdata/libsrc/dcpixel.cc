@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1997-2010, OFFIS e.V.
+ *  Copyright (C) 1997-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -222,7 +222,13 @@ DcmPixelData::canChooseRepresentation(
 
     const DcmRepresentationEntry findEntry(repType, repParam, NULL);
     DcmRepresentationListIterator resultIt(repListEnd);
-    if ((!toType.isEncapsulated() && existUnencapsulated) ||
+    if (isDecompressedWithoutParameter(toType, repParam))
+    {
+        // the pixel data has already been decompressed, without the requested
+        // options for the decompression (e.g. a reduced resolution)
+        result = OFFalse;
+    }
+    else if ((!toType.isEncapsulated() && existUnencapsulated) ||
         (toType.isEncapsulated() && writeUnencapsulated(repType) && existUnencapsulated) ||
         (toType.isEncapsulated() && findRepresentationEntry(findEntry, resultIt) == EC_Normal))
     {
@@ -281,7 +287,13 @@ DcmPixelData::chooseRepresentation(
 
     const DcmRepresentationEntry findEntry(repType, repParam, NULL);
     DcmRepresentationListIterator result(repListEnd);
-    if ((!toType.isEncapsulated() && existUnencapsulated) ||
+    if (isDecompressedWithoutParameter(toType, repParam))
+    {
+        // the pixel data has already been decompressed, without the requested
+        // options for the decompression (e.g. a reduced resolution)
+        l_error = EC_CannotChangeRepresentation;
+    }
+    else if ((!toType.isEncapsulated() && existUnencapsulated) ||
         (toType.isEncapsulated() && findRepresentationEntry(findEntry, result) == EC_Normal))
     {
         // representation found
@@ -299,7 +311,7 @@ DcmPixelData::chooseRepresentation(
                              (*original)->pixSeq, toType, repParam, pixelStack);
         else
             l_error = decode((*original)->repType, (*original)->repParam,
-                             (*original)->pixSeq, pixelStack);
+                             (*original)->pixSeq, pixelStack, repParam);
     }
     if (l_error.bad() && toType.isEncapsulated() && existUnencapsulated && writeUnencapsulated(repType))
         // Encoding failed so this will be written out unencapsulated
@@ -308,6 +320,15 @@ DcmPixelData::chooseRepresentation(
 }
 
 
+OFBool
+DcmPixelData::isDecompressedWithoutParameter(
+    const DcmXfer & toType,
+    const DcmRepresentationParameter * repParam) const
+{
+    return !toType.isEncapsulated() && existUnencapsulated && (repParam != NULL) && (original != repListEnd);
+}
+
+
 void
 DcmPixelData::clearRepresentationList(
     DcmRepresentationListIterator leaveInList)
@@ -339,16 +360,23 @@ DcmPixelData::decode(
     const DcmXfer & fromType,
     const DcmRepresentationParameter * fromParam,
     DcmPixelSequence * fromPixSeq,
-    DcmStack & pixelStack)
+    DcmStack & pixelStack,
+    const DcmRepresentationParameter * toParam)
 {
-    if (existUnencapsulated) return EC_Normal;
-    OFCondition l_error = DcmCodecList::decode(fromType, fromParam, fromPixSeq, *this, pixelStack);
+    if (existUnencapsulated)
+        return (toParam == NULL) ? EC_Normal : EC_CannotChangeRepresentation;
+    OFCondition l_error = DcmCodecList::decode(fromType, fromParam, fromPixSeq, *this, pixelStack, toParam);
     if (l_error.good())
     {
         existUnencapsulated = OFTrue;
         current = repListEnd;
         setVR(EVR_OW);
         recalcVR();
+        // the options for the decompression (e.g. a reduced resolution) may have
+        // created pixel data that no longer matches the compressed representations,
+        // i.e. the decompressed pixel data becomes the original representation
+        if (toParam != NULL)
+            removeAllButCurrentRepresentations();
     }
     else
     {
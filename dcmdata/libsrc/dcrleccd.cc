@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2010, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -32,6 +32,244 @@
 #include "dcmtk/dcmdata/dcvrpobw.h"  /* for class DcmPolymorphOBOW */
 #include "dcmtk/dcmdata/dcswap.h"    /* for swapIfNecessary() */
 #include "dcmtk/dcmdata/dcuid.h"     /* for dcmGenerateUniqueIdentifer()*/
+#include "dcmtk/dcmdata/dcparfrm.h"  /* for class DcmParallelFrameProcessor */
+
+
+/** helper class decompressing the frames of an RLE image, possibly in
+ *  parallel. Requires that each frame is contained in exactly one pixel item,
+ *  as mandated by the DICOM standard for the RLE transfer syntax. Each RLE
+ *  segment is decompressed directly into the uncompressed frame, i.e.\ without
+ *  an intermediate buffer. If there are fewer frames than threads, the segments
+ *  of a frame (one per byte of each sample, up to 15) are distributed over the
+ *  threads, so that single-frame images also benefit from multiple threads.
+ */
+class DcmRLEFrameDecoder : public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param numberOfFrames number of frames to be decompressed
+   *  @param numberOfThreads maximum number of threads to be used
+   *  @param imageData pointer to the buffer for the uncompressed frames
+   *  @param frameSize size of an uncompressed frame in bytes
+   *  @param samplesPerPixel samples per pixel of the image
+   *  @param bytesAllocated bytes allocated per sample
+   *  @param columns number of columns of the image
+   *  @param rows number of rows of the image
+   *  @param planarConfiguration planar configuration of the image
+   *  @param reverseByteOrder assume LSB to MSB order of RLE segments
+   */
+  DcmRLEFrameDecoder(Uint32 numberOfFrames, Uint32 numberOfThreads,
+    Uint8 *imageData, size_t frameSize, Uint16 samplesPerPixel, Uint16 bytesAllocated,
+    Uint16 columns, Uint16 rows, Uint16 planarConfiguration, OFBool reverseByteOrder)
+  : DcmParallelFrameProcessor(numberOfFrames * unitsPerFrame(numberOfFrames, numberOfThreads, samplesPerPixel, bytesAllocated))
+  , numberOfThreads_(getNumberOfThreadsUsed(numberOfThreads))
+  , numberOfFrames_(numberOfFrames)
+  , unitsPerFrame_(unitsPerFrame(numberOfFrames, numberOfThreads, samplesPerPixel, bytesAllocated))
+  , fragmentData_(new Uint8 *[numberOfFrames])
+  , fragmentLength_(new Uint32[numberOfFrames])
+  , imageData_(imageData)
+  , frameSize_(frameSize)
+  , bytesPerStripe_(OFstatic_cast(size_t, columns) * rows)
+  , samplesPerPixel_(samplesPerPixel)
+  , bytesAllocated_(bytesAllocated)
+  , planarConfiguration_(planarConfiguration)
+  , reverseByteOrder_(reverseByteOrder)
+  {
+  }
+
+  /// destructor
+  virtual ~DcmRLEFrameDecoder()
+  {
+    delete[] fragmentData_;
+    delete[] fragmentLength_;
+  }
+
+  /** accesses the compressed data of all frames and decompresses them.
+   *  @param pixSeq pixel sequence containing one pixel item per frame
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition decode(DcmPixelSequence *pixSeq)
+  {
+    OFCondition result = EC_Normal;
+    DcmPixelItem *pixItem = NULL;
+    // access all pixel items in this thread since this might load data from file
+    for (Uint32 frame = 0; (frame < numberOfFrames_) && result.good(); ++frame)
+    {
+      result = pixSeq->getItem(pixItem, frame + 1); // ignore offset table
+      if (result.good())
+      {
+        fragmentLength_[frame] = pixItem->getLength();
+        result = pixItem->getUint8Array(fragmentData_[frame]);
+      }
+    }
+    if (result.good())
+    {
+      DCMDATA_DEBUG("RLE decoder processes " << numberOfFrames_ << " frame(s) in " << getNumberOfFrames()
+        << " unit(s) of work using up to " << numberOfThreads_ << " thread(s)");
+      result = processAllFrames(numberOfThreads_);
+    }
+    return result;
+  }
+
+  /** decompresses a single frame or a single RLE segment of a frame,
+   *  depending on the number of units of work per frame.
+   *  @param unitNo number of the unit of work to be processed
+   *  @param threadNo index of the calling thread (not used)
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 unitNo, Uint32 /* threadNo */)
+  {
+    const Uint32 frameNo = unitNo / unitsPerFrame_;
+    Uint8 *rleData = fragmentData_[frameNo];
+    const Uint32 fragmentLength = fragmentLength_[frameNo];
+    Uint32 rleHeader[16];
+
+    // we require that the RLE header is completely contained in the fragment
+    if ((rleData == NULL) || (fragmentLength < 64)) return EC_CannotChangeRepresentation;
+
+    // copy RLE header to buffer and adjust byte order
+    memcpy(rleHeader, rleData, 64);
+    swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, rleHeader, 16*OFstatic_cast(Uint32, sizeof(Uint32)), sizeof(Uint32));
+
+    // check that number of stripes in RLE header matches our expectation
+    const Uint32 numberOfStripes = rleHeader[0];
+    if ((numberOfStripes < 1) || (numberOfStripes > 15) ||
+        (numberOfStripes != OFstatic_cast(Uint32, bytesAllocated_) * samplesPerPixel_))
+      return EC_CannotChangeRepresentation;
+
+    OFCondition result = EC_Normal;
+    if (unitsPerFrame_ == 1)
+    {
+      for (Uint32 i = 0; (i < numberOfStripes) && result.good(); ++i)
+        result = decodeStripe(frameNo, i, numberOfStripes, rleHeader);
+    }
+    else
+      result = decodeStripe(frameNo, unitNo % unitsPerFrame_, numberOfStripes, rleHeader);
+    return result;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmRLEFrameDecoder(const DcmRLEFrameDecoder&);
+
+  /// private undefined copy assignment operator
+  DcmRLEFrameDecoder& operator=(const DcmRLEFrameDecoder&);
+
+  /** determines the number of units of work per frame. The frames are
+   *  processed as a whole if there are at least as many frames as threads,
+   *  since the threads would otherwise write to the same cache lines of
+   *  an interleaved (color or multi-byte) frame.
+   *  @param numberOfFrames number of frames to be decompressed
+   *  @param numberOfThreads maximum number of threads to be used
+   *  @param samplesPerPixel samples per pixel of the image
+   *  @param bytesAllocated bytes allocated per sample
+   *  @return number of units of work per frame, i.e.\ 1 or the number of RLE segments
+   */
+  static Uint32 unitsPerFrame(Uint32 numberOfFrames, Uint32 numberOfThreads,
+    Uint16 samplesPerPixel, Uint16 bytesAllocated)
+  {
+    const Uint32 numberOfStripes = OFstatic_cast(Uint32, samplesPerPixel) * bytesAllocated;
+    if ((numberOfThreads <= numberOfFrames) || (numberOfStripes < 1) || (numberOfStripes > 15)) return 1;
+    return numberOfStripes;
+  }
+
+  /** decompresses a single RLE segment directly into the uncompressed frame.
+   *  @param frameNo number of the frame
+   *  @param stripeNo number of the RLE segment within the frame
+   *  @param numberOfStripes number of RLE segments of the frame
+   *  @param rleHeader RLE header of the frame in local byte order
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition decodeStripe(Uint32 frameNo, Uint32 stripeNo, Uint32 numberOfStripes, const Uint32 *rleHeader)
+  {
+    Uint8 *rleData = fragmentData_[frameNo];
+    const Uint32 fragmentLength = fragmentLength_[frameNo];
+
+    // determine start and end of the RLE stripe within the fragment
+    const Uint32 stripeStart = rleHeader[stripeNo+1];
+    const Uint32 stripeEnd = (stripeNo+1 == numberOfStripes) ? fragmentLength : rleHeader[stripeNo+2];
+    if ((stripeStart > stripeEnd) || (stripeEnd > fragmentLength)) return EC_CannotChangeRepresentation;
+
+    // determine position of the first byte and distance between bytes of this stripe in the frame
+    const Uint32 sample = stripeNo / bytesAllocated_;
+    const Uint32 byte = stripeNo % bytesAllocated_;
+    size_t sampleOffset;
+    size_t offsetBetweenSamples;
+    if (planarConfiguration_ == 0)
+    {
+      sampleOffset = sample * bytesAllocated_;
+      offsetBetweenSamples = samplesPerPixel_ * bytesAllocated_;
+    }
+    else
+    {
+      sampleOffset = sample * bytesAllocated_ * bytesPerStripe_;
+      offsetBetweenSamples = bytesAllocated_;
+    }
+    Uint8 *pixelPointer = imageData_ + frameNo * frameSize_ + sampleOffset;
+    if (reverseByteOrder_)
+    {
+      // assume incorrect LSB to MSB order of RLE segments as produced by some tools
+      pixelPointer += byte;
+    }
+    else
+    {
+      pixelPointer += bytesAllocated_ - byte - 1;
+    }
+
+    // decompress the stripe directly into the output image array
+    DcmRLEDecoder rledecoder(pixelPointer, bytesPerStripe_, offsetBetweenSamples);
+    if (rledecoder.fail()) return EC_CannotChangeRepresentation;
+    (void) rledecoder.decompress(rleData + stripeStart, OFstatic_cast(size_t, stripeEnd - stripeStart));
+
+    // special handling for zero pad byte at the end of the RLE stream
+    // which results in an EC_StreamNotifyClient return code
+    // or trailing garbage data which results in EC_CorruptedData
+    if (rledecoder.size() != bytesPerStripe_)
+    {
+      DCMDATA_ERROR("RLE decoder is finished but has produced insufficient data for this stripe");
+      return EC_CannotChangeRepresentation;
+    }
+    return EC_Normal;
+  }
+
+  /// number of threads actually used
+  Uint32 numberOfThreads_;
+
+  /// number of frames to be decompressed
+  Uint32 numberOfFrames_;
+
+  /// number of units of work per frame, 1 or the number of RLE segments
+  Uint32 unitsPerFrame_;
+
+  /// compressed data of each frame
+  Uint8 **fragmentData_;
+
+  /// length of compressed data of each frame
+  Uint32 *fragmentLength_;
+
+  /// buffer for the uncompressed frames
+  Uint8 *imageData_;
+
+  /// size of an uncompressed frame in bytes
+  size_t frameSize_;
+
+  /// number of bytes per RLE stripe, i.e. number of pixels per frame
+  size_t bytesPerStripe_;
+
+  /// samples per pixel
+  Uint16 samplesPerPixel_;
+
+  /// bytes allocated per sample
+  Uint16 bytesAllocated_;
+
+  /// planar configuration
+  Uint16 planarConfiguration_;
+
+  /// assume LSB to MSB order of RLE segments
+  OFBool reverseByteOrder_;
+};
 
 
 DcmRLECodecDecoder::DcmRLECodecDecoder()
@@ -139,6 +377,22 @@ OFCondition DcmRLECodecDecoder::decode(
         {
           Uint8 *imageData8 = OFreinterpret_cast(Uint8 *, imageData16);
 
+          // frames (and the stripes of a frame) can be decompressed directly into the image
+          // and in parallel if each frame is contained in exactly one pixel item, which is
+          // what the DICOM standard requires for RLE compressed images
+          if (pixSeq->card() == OFstatic_cast(unsigned long, imageFrames) + 1)
+          {
+            DcmRLEFrameDecoder frameDecoder(OFstatic_cast(Uint32, imageFrames), djcp->getNumberOfThreads(),
+              imageData8, frameSize, imageSamplesPerPixel, imageBytesAllocated, imageColumns, imageRows,
+              imagePlanarConfiguration, enableReverseByteOrder);
+            if (frameDecoder.decode(pixSeq).good()) currentFrame = imageFrames;
+            else
+            {
+              // try again with the more tolerant (sequential) decoder below
+              DCMDATA_DEBUG("RLE decoder cannot decompress frames directly, falling back to sequential decompression");
+            }
+          }
+
           while ((currentFrame < imageFrames) && result.good())
           {
             DCMDATA_DEBUG("RLE decoder processes frame " << currentFrame);
@@ -459,9 +713,7 @@ OFCondition DcmRLECodecDecoder::decodeFrame(
     Uint32 frameSize = imageBytesAllocated * imageRows * imageColumns * imageSamplesPerPixel;
 
     if (frameSize > bufSize) return EC_IllegalCall;
-
-    DcmRLEDecoder rledecoder(bytesPerStripe);
-    if (rledecoder.fail()) return EC_MemoryExhausted;  // RLE decoder failed to initialize
+    if (bytesPerStripe == 0) return EC_CannotChangeRepresentation;
 
     DCMDATA_DEBUG("RLE decoder processes frame " << frameNo);
 
@@ -488,6 +740,9 @@ OFCondition DcmRLECodecDecoder::decodeFrame(
     if (result.bad())
        return result;
 
+    // we require that the RLE header is completely contained in the fragment
+    if ((rleData == NULL) || (fragmentLength < 64)) return EC_CannotChangeRepresentation;
+
     // copy RLE header to buffer and adjust byte order
     memcpy(rleHeader, rleData, 64);
     swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, rleHeader, OFstatic_cast(Uint32, 16*sizeof(Uint32)), sizeof(Uint32));
@@ -505,8 +760,7 @@ OFCondition DcmRLECodecDecoder::decodeFrame(
     OFBool lastStripe = OFFalse;
     Uint32 inputBytes = 0;
 
-    // pointers for buffer copy operations
-    Uint8 *outputBuffer = NULL;
+    // pointer for buffer copy operations
     Uint8 *pixelPointer = NULL;
     Uint16 *imageData16 = OFreinterpret_cast(Uint16 *, buffer);
     Uint8 *imageData8 = OFreinterpret_cast(Uint8 *, buffer);
@@ -526,11 +780,9 @@ OFCondition DcmRLECodecDecoder::decodeFrame(
     // for each stripe in stripe set
     for (i = 0; i < numberOfStripes; ++i)
     {
-        // reset RLE codec
-        rledecoder.clear();
-
         // adjust start point for RLE stripe
         byteOffset = rleHeader[i+1];
+        if (byteOffset > fragmentLength) return EC_CannotChangeRepresentation;
 
         // byteOffset now points to the first byte of the new RLE stripe
         // check if the current stripe is the last one for this frame
@@ -550,48 +802,17 @@ OFCondition DcmRLECodecDecoder::decodeFrame(
             // not the last stripe. We can use the offset table to determine
             // the number of bytes to feed to the RLE codec.
             inputBytes = rleHeader[i+2];
-            if (inputBytes < rleHeader[i+1]) return EC_CannotChangeRepresentation;
+            if ((inputBytes < rleHeader[i+1]) || (inputBytes > fragmentLength)) return EC_CannotChangeRepresentation;
 
             inputBytes -= rleHeader[i+1]; // number of bytes to feed to codec
 
             bytesToDecode = OFstatic_cast(size_t, inputBytes);
         }
 
-        // last fragment for this RLE stripe
-        result = rledecoder.decompress(rleData + byteOffset, bytesToDecode);
-
-        // special handling for zero pad byte at the end of the RLE stream
-        // which results in an EC_StreamNotifyClient return code
-        // or trailing garbage data which results in EC_CorruptedData
-        if (rledecoder.size() == bytesPerStripe) result = EC_Normal;
-
-        byteOffset += inputBytes;
-
-        // copy the decoded stuff over to the buffer here...
-        // make sure the RLE decoder has produced the right amount of data
-        if (lastStripe && (rledecoder.size() < bytesPerStripe))
-        {
-            // stream ended premature? report a warning and continue
-            if (result == EC_StreamNotifyClient)
-            {
-                DCMDATA_WARN("RLE decoder is finished but has produced insufficient data for this stripe, filling remaining pixels");
-                result = EC_Normal;
-            }
-        }
-        else if (rledecoder.size() != bytesPerStripe)
-        {
-            DCMDATA_ERROR("RLE decoder is finished but has produced insufficient data for this stripe");
-            return EC_CannotChangeRepresentation;
-        }
-
-        // distribute decompressed bytes into output image array
         // which sample and byte are we currently decompressing?
         sample = i / imageBytesAllocated;
         byte = i % imageBytesAllocated;
 
-        // raw buffer containing bytesPerStripe bytes of uncompressed data
-        outputBuffer = OFstatic_cast(Uint8 *, rledecoder.getOutputBuffer());
-
         // compute byte offsets
         if (imagePlanarConfiguration == 0)
         {
@@ -615,19 +836,44 @@ OFCondition DcmRLECodecDecoder::decodeFrame(
             pixelPointer = imageData8 + sampleOffset + imageBytesAllocated - byte - 1;
         }
 
-        // copy the pixel data that was decoded
+        // decompress the stripe directly into the output image array
+        DcmRLEDecoder rledecoder(pixelPointer, bytesPerStripe, offsetBetweenSamples);
+        result = rledecoder.decompress(rleData + byteOffset, bytesToDecode);
+
+        // special handling for zero pad byte at the end of the RLE stream
+        // which results in an EC_StreamNotifyClient return code
+        // or trailing garbage data which results in EC_CorruptedData
+        if (rledecoder.size() == bytesPerStripe) result = EC_Normal;
+
+        byteOffset += inputBytes;
+
+        // make sure the RLE decoder has produced the right amount of data
         const size_t decoderSize = rledecoder.size();
-        for (pixel = 0; pixel < decoderSize; ++pixel)
+        if (lastStripe && (decoderSize < bytesPerStripe))
         {
-            *pixelPointer = *outputBuffer++;
-            pixelPointer += offsetBetweenSamples;
+            // stream ended premature? report a warning and continue
+            if (result == EC_StreamNotifyClient)
+            {
+                DCMDATA_WARN("RLE decoder is finished but has produced insufficient data for this stripe, filling remaining pixels");
+                result = EC_Normal;
+            }
         }
-        // and fill the remainder of the image with copies of the last decoded pixel
-        const Uint8 lastPixelValue = *(outputBuffer - 1);
-        for (pixel = OFstatic_cast(Uint32, decoderSize); pixel < bytesPerStripe; ++pixel)
+        else if (decoderSize != bytesPerStripe)
         {
-            *pixelPointer = lastPixelValue;
-            pixelPointer += offsetBetweenSamples;
+            DCMDATA_ERROR("RLE decoder is finished but has produced insufficient data for this stripe");
+            return EC_CannotChangeRepresentation;
+        }
+
+        // fill the remainder of the image with copies of the last decoded pixel (if any)
+        if (decoderSize < bytesPerStripe)
+        {
+            pixelPointer += decoderSize * offsetBetweenSamples;
+            const Uint8 lastPixelValue = (decoderSize > 0) ? *(pixelPointer - offsetBetweenSamples) : 0;
+            for (pixel = OFstatic_cast(Uint32, decoderSize); pixel < bytesPerStripe; ++pixel)
+            {
+                *pixelPointer = lastPixelValue;
+                pixelPointer += offsetBetweenSamples;
+            }
         }
     }
 
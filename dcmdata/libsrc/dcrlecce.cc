@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -29,14 +29,167 @@
 #include "dcmtk/dcmdata/dcpxitem.h"  /* for class DcmPixelItem */
 #include "dcmtk/dcmdata/dcswap.h"    /* for swapIfNecessary */
 #include "dcmtk/dcmdata/dcitem.h"
+#include "dcmtk/dcmdata/dcparfrm.h"  /* for class DcmParallelFrameProcessor */
 #include "dcmtk/ofstd/ofstd.h"
 
 #define INCLUDE_CSTDIO
 #include "dcmtk/ofstd/ofstdinc.h"
 
 
-typedef OFList<DcmRLEEncoder *> DcmRLEEncoderList;
-typedef OFListIterator(DcmRLEEncoder *) DcmRLEEncoderListIterator;
+/** helper class compressing a number of consecutive frames of an image,
+ *  possibly in parallel. Each RLE segment (one per byte of each sample,
+ *  up to 15 per frame) is compressed independently of the others, so the
+ *  segments of all frames are distributed over the threads.
+ */
+class DcmRLEFrameEncoder : public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param firstFrame number of the first frame to be compressed
+   *  @param numberOfFrames number of frames to be compressed
+   *  @param pixelData pointer to the uncompressed pixel data of all frames (little endian)
+   *  @param frameSize size of an uncompressed frame in bytes
+   *  @param samplesPerPixel samples per pixel of the image
+   *  @param bytesAllocated bytes allocated per sample
+   *  @param columns number of columns of the image
+   *  @param rows number of rows of the image
+   *  @param planarConfiguration planar configuration of the image
+   */
+  DcmRLEFrameEncoder(Uint32 firstFrame, Uint32 numberOfFrames,
+    const Uint8 *pixelData, size_t frameSize, Uint16 samplesPerPixel, Uint16 bytesAllocated,
+    Uint16 columns, Uint16 rows, Uint16 planarConfiguration)
+  : DcmParallelFrameProcessor(numberOfFrames * samplesPerPixel * bytesAllocated)
+  , numberOfStripes_(OFstatic_cast(Uint32, samplesPerPixel) * bytesAllocated)
+  , encoders_(new DcmRLEEncoder *[numberOfFrames * samplesPerPixel * bytesAllocated])
+  , pixelData_(pixelData + firstFrame * frameSize)
+  , frameSize_(frameSize)
+  , samplesPerPixel_(samplesPerPixel)
+  , bytesAllocated_(bytesAllocated)
+  , columns_(columns)
+  , rows_(rows)
+  , planarConfiguration_(planarConfiguration)
+  {
+    for (Uint32 i = 0; i < getNumberOfFrames(); ++i)
+      encoders_[i] = NULL;
+  }
+
+  /// destructor
+  virtual ~DcmRLEFrameEncoder()
+  {
+    for (Uint32 i = 0; i < getNumberOfFrames(); ++i)
+      delete encoders_[i];
+    delete[] encoders_;
+  }
+
+  /** returns the RLE encoder of the given stripe. Only valid after
+   *  processAllFrames() has been called successfully.
+   *  @param frameNo number of the frame relative to the first frame
+   *  @param stripeNo number of the RLE segment within the frame
+   *  @return RLE encoder containing the compressed stripe
+   */
+  const DcmRLEEncoder *getEncoder(Uint32 frameNo, Uint32 stripeNo) const
+  {
+    return encoders_[frameNo * numberOfStripes_ + stripeNo];
+  }
+
+  /** compresses a single RLE segment of a frame.
+   *  @param unitNo number of the RLE segment counted over all frames
+   *  @param threadNo index of the calling thread (not used)
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 unitNo, Uint32 /* threadNo */)
+  {
+    const Uint32 frameNo = unitNo / numberOfStripes_;
+    const Uint32 stripeNo = unitNo % numberOfStripes_;
+
+    // which sample and byte are we currently compressing?
+    const Uint32 sample = stripeNo / bytesAllocated_;
+    const Uint32 byte = stripeNo % bytesAllocated_;
+
+    // compute byte offset for first sample in frame and between samples
+    size_t sampleOffset;
+    size_t offsetBetweenSamples;
+    if (planarConfiguration_ == 0)
+    {
+      sampleOffset = sample * bytesAllocated_;
+      offsetBetweenSamples = samplesPerPixel_ * bytesAllocated_;
+    }
+    else
+    {
+      sampleOffset = sample * bytesAllocated_ * OFstatic_cast(size_t, columns_) * rows_;
+      offsetBetweenSamples = bytesAllocated_;
+    }
+    const Uint8 *pixelPointer = pixelData_ + frameNo * frameSize_ + sampleOffset + bytesAllocated_ - byte - 1;
+
+    // initialize new RLE codec for this stripe
+    DcmRLEEncoder *rleEncoder = new DcmRLEEncoder(1 /* DICOM padding required */);
+    encoders_[unitNo] = rleEncoder;
+    if (rleEncoder->fail()) return EC_MemoryExhausted;
+
+    // contiguous bytes are passed directly, others are gathered row by row
+    Uint8 *rowBuffer = (offsetBetweenSamples > 1) ? new Uint8[columns_] : NULL;
+    for (Uint16 row = 0; row < rows_; ++row)
+    {
+      if (rowBuffer)
+      {
+        for (Uint16 column = 0; column < columns_; ++column)
+        {
+          rowBuffer[column] = *pixelPointer;
+          pixelPointer += offsetBetweenSamples;
+        }
+        rleEncoder->add(rowBuffer, columns_);
+      }
+      else
+      {
+        rleEncoder->add(pixelPointer, columns_);
+        pixelPointer += columns_;
+      }
+
+      // enforce DICOM rule that "Each row of the image shall be encoded
+      // separately and not cross a row boundary."
+      // (see DICOM part 5 section G.3.1)
+      rleEncoder->flush();
+    }
+    delete[] rowBuffer;
+    return (rleEncoder->fail()) ? EC_MemoryExhausted : EC_Normal;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmRLEFrameEncoder(const DcmRLEFrameEncoder&);
+
+  /// private undefined copy assignment operator
+  DcmRLEFrameEncoder& operator=(const DcmRLEFrameEncoder&);
+
+  /// number of RLE segments per frame
+  Uint32 numberOfStripes_;
+
+  /// one RLE encoder per RLE segment of each frame
+  DcmRLEEncoder **encoders_;
+
+  /// uncompressed data of the first frame to be compressed
+  const Uint8 *pixelData_;
+
+  /// size of an uncompressed frame in bytes
+  size_t frameSize_;
+
+  /// samples per pixel
+  Uint16 samplesPerPixel_;
+
+  /// bytes allocated per sample
+  Uint16 bytesAllocated_;
+
+  /// number of columns
+  Uint16 columns_;
+
+  /// number of rows
+  Uint16 rows_;
+
+  /// planar configuration
+  Uint16 planarConfiguration_;
+};
 
 
 // =======================================================================
@@ -124,11 +277,7 @@ OFCondition DcmRLECodecEncoder::encode(
   (void)localStack.pop();             // pop pixel data element from stack
   DcmObject *dataset = localStack.pop(); // this is the item in which the pixel data is located
   Uint8 *pixelData8 = OFreinterpret_cast(Uint8 *, OFconst_cast(Uint16 *, pixelData));
-  Uint8 *pixelPointer = NULL;
   DcmOffsetList offsetList;
-  DcmRLEEncoderList rleEncoderList;
-  DcmRLEEncoderListIterator first = rleEncoderList.begin();
-  DcmRLEEncoderListIterator last = rleEncoderList.end();
   Uint32 rleHeader[16];
   Uint32 i;
   OFBool byteSwapped = OFFalse;  // true if we have byte-swapped the original pixel data
@@ -205,17 +354,9 @@ OFCondition DcmRLECodecEncoder::encode(
     // create RLE stripe sets
     if (result.good())
     {
-      const Uint32 bytesPerStripe = columns * rows;
-      const Uint32 frameSize = columns * rows * samplesPerPixel * bytesAllocated;
-      Uint32 frameOffset = 0;
-      Uint32 sampleOffset = 0;
-      Uint32 offsetBetweenSamples = 0;
-      Uint32 sample = 0;
-      Uint32 byte = 0;
-      register Uint32 pixel = 0;
-      register Uint32 columnCounter = 0;
-
-      DcmRLEEncoder *rleEncoder = NULL;
+      const size_t frameSize = OFstatic_cast(size_t, columns) * rows * samplesPerPixel * bytesAllocated;
+      const Uint32 frames = OFstatic_cast(Uint32, numberOfFrames);
+      Uint32 framesPerBlock = djcp->getNumberOfThreads();
       Uint32 rleSize = 0;
       Uint8 *rleData = NULL;
       Uint8 *rleData2 = NULL;
@@ -224,74 +365,32 @@ OFCondition DcmRLECodecEncoder::encode(
       if (djcp->getFragmentSize() > 0)
          DCMDATA_WARN("DcmRLECodecEncoder: limiting the fragment size may result in non-standard conformant encoding");
 
-      // compute byte offset between samples
-      if (planarConfiguration == 0)
-         offsetBetweenSamples = samplesPerPixel * bytesAllocated;
-         else offsetBetweenSamples = bytesAllocated;
+      // compress as many frames at a time as threads are used, so that the
+      // compressed stripes of only a few frames have to be kept in memory
+      if (framesPerBlock < 1) framesPerBlock = 1;
+      DCMDATA_DEBUG("RLE encoder processes " << frames << " frame(s) with " << numberOfStripes
+        << " stripe(s) each using up to " << djcp->getNumberOfThreads() << " thread(s)");
 
       // loop through all frames of the image
-      for (Uint32 currentFrame = 0; ((currentFrame < OFstatic_cast(Uint32, numberOfFrames)) && result.good()); currentFrame++)
+      for (Uint32 firstFrame = 0; (firstFrame < frames) && result.good(); firstFrame += framesPerBlock)
       {
-        // offset to start of frame, in bytes
-        frameOffset = frameSize * currentFrame;
-
-        // loop through all samples of one frame
-        for (sample = 0; sample < samplesPerPixel; sample++)
-        {
-          // compute byte offset for first sample in frame
-          if (planarConfiguration == 0)
-             sampleOffset = sample * bytesAllocated;
-             else sampleOffset = sample * bytesAllocated * columns * rows;
+        const Uint32 blockFrames = (frames - firstFrame < framesPerBlock) ? frames - firstFrame : framesPerBlock;
+        DcmRLEFrameEncoder frameEncoder(firstFrame, blockFrames, pixelData8, frameSize,
+          samplesPerPixel, bytesAllocated, columns, rows, planarConfiguration);
+        result = frameEncoder.processAllFrames(djcp->getNumberOfThreads());
 
-          // loop through the bytes of one sample
-          for (byte = 0; byte < bytesAllocated; byte++)
-          {
-            pixelPointer = pixelData8 + frameOffset + sampleOffset + bytesAllocated - byte - 1;
-
-            // initialize new RLE codec for this stripe
-            rleEncoder = new DcmRLEEncoder(1 /* DICOM padding required */);
-            if (rleEncoder)
-            {
-              rleEncoderList.push_back(rleEncoder);
-              columnCounter = columns;
-
-              // loop through all pixels of the frame
-              for (pixel = 0; pixel < bytesPerStripe; ++pixel)
-              {
-                rleEncoder->add(*pixelPointer);
-
-                // enforce DICOM rule that "Each row of the image shall be encoded
-                // separately and not cross a row boundary."
-                // (see DICOM part 5 section G.3.1)
-                if (--columnCounter == 0)
-                {
-                  rleEncoder->flush();
-                  columnCounter = columns;
-                }
-                pixelPointer += offsetBetweenSamples;
-              }
-
-              rleEncoder->flush();
-              if (rleEncoder->fail()) result = EC_MemoryExhausted;
-            } else result = EC_MemoryExhausted;
-          }
-        }
-
-        // store frame and erase RLE codec list
-        if (result.good() && (rleEncoderList.size() > 0) && (rleEncoderList.size() < 16))
+        // store frames in the order of their frame numbers
+        for (Uint32 currentFrame = 0; (currentFrame < blockFrames) && result.good(); currentFrame++)
         {
           // compute size of compressed frame including RLE header
           // and populate RLE header
           for (i=0; i<16; i++) rleHeader[i] = 0;
-          rleHeader[0] = OFstatic_cast(Uint32, rleEncoderList.size());
+          rleHeader[0] = numberOfStripes;
           rleSize = 64;
-          i = 1;
-          first = rleEncoderList.begin();
-          while (first != last)
+          for (i=0; i<numberOfStripes; i++)
           {
-            rleHeader[i++] = rleSize;
-            rleSize += OFstatic_cast(Uint32, (*first)->size());
-            ++first;
+            rleHeader[i+1] = rleSize;
+            rleSize += OFstatic_cast(Uint32, frameEncoder.getEncoder(currentFrame, i)->size());
           }
 
           // allocate buffer for compressed frame
@@ -305,13 +404,11 @@ OFCondition DcmRLECodecEncoder::encode(
 
             // store RLE stripe sets in compressed frame buffer
             rleData2 = rleData + 64;
-            first = rleEncoderList.begin();
-            while (first != last)
+            for (i=0; i<numberOfStripes; i++)
             {
-              (*first)->write(rleData2);
-              rleData2 += (*first)->size();
-              delete *first;
-              first = rleEncoderList.erase(first);
+              const DcmRLEEncoder *rleEncoder = frameEncoder.getEncoder(currentFrame, i);
+              rleEncoder->write(rleData2);
+              rleData2 += rleEncoder->size();
             }
 
             // store compressed frame, breaking into segments if necessary
@@ -322,20 +419,7 @@ OFCondition DcmRLECodecEncoder::encode(
             delete[] rleData;
           } else result = EC_MemoryExhausted;
         }
-        else
-        {
-          // erase RLE codec list
-          first = rleEncoderList.begin();
-          while (first != last)
-          {
-            delete *first;
-            first = rleEncoderList.erase(first);
-          }
-          if (result.good()) result = EC_CannotChangeRepresentation;
-        }
-
       }
-
     }
 
     // store pixel sequence if everything went well.
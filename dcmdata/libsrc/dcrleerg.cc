@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2010, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -35,7 +35,8 @@ void DcmRLEEncoderRegistration::registerCodecs(
     OFBool pCreateSOPInstanceUID,
     Uint32 pFragmentSize,
     OFBool pCreateOffsetTable,
-    OFBool pConvertToSC)
+    OFBool pConvertToSC,
+    Uint32 pNumberOfThreads)
 {
   if (! registered)
   {
@@ -43,7 +44,9 @@ void DcmRLEEncoderRegistration::registerCodecs(
       pCreateSOPInstanceUID,
       pFragmentSize,
       pCreateOffsetTable,
-      pConvertToSC);
+      pConvertToSC,
+      OFFalse /* pReverseDecompressionByteOrder */,
+      pNumberOfThreads);
 
     if (cp)
     {
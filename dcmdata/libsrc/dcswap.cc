@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2012, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -22,6 +22,74 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 #include "dcmtk/dcmdata/dcswap.h"
 
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+#ifndef OF_NO_UINT64
+
+/* bit masks selecting every other byte, 16-bit word and 32-bit word of a 64-bit number */
+#define DCMTK_SWAP_MASK8  ((OFstatic_cast(Uint64, 0x00ff00ffUL) << 32) | OFstatic_cast(Uint64, 0x00ff00ffUL))
+#define DCMTK_SWAP_MASK16 ((OFstatic_cast(Uint64, 0x0000ffffUL) << 32) | OFstatic_cast(Uint64, 0x0000ffffUL))
+#define DCMTK_SWAP_MASK32 OFstatic_cast(Uint64, 0xffffffffUL)
+
+static size_t swapBlocks(Uint8 *base, const Uint32 byteLength, const size_t valWidth)
+    /*
+     * This function swaps all values of the given width (2, 4 or 8 bytes) that are
+     * contained in the complete 8-byte blocks of the given array. Each block is swapped
+     * with a few shift and mask operations on a 64-bit number instead of byte by byte,
+     * which also allows the compiler to vectorize the loop. memcpy() is used to access
+     * the blocks, so the array does not need to be aligned.
+     *
+     * Parameters:
+     *   base         - [in] Array that contains the actual bytes which have to be swapped.
+     *   byteLength   - [in] Length of the above array.
+     *   valWidth     - [in] Specifies how many bytes shall be treated together as one element.
+     *
+     * Return value: number of bytes that have been processed (multiple of 8).
+     */
+{
+    const size_t blocks = byteLength / 8;
+    Uint64 block;
+    size_t i;
+    if (valWidth == 2)
+    {
+        for (i = 0; i < blocks; ++i)
+        {
+            memcpy(&block, base + 8 * i, 8);
+            block = ((block & DCMTK_SWAP_MASK8) << 8) | ((block >> 8) & DCMTK_SWAP_MASK8);
+            memcpy(base + 8 * i, &block, 8);
+        }
+    }
+    else if (valWidth == 4)
+    {
+        for (i = 0; i < blocks; ++i)
+        {
+            memcpy(&block, base + 8 * i, 8);
+            block = ((block & DCMTK_SWAP_MASK8) << 8) | ((block >> 8) & DCMTK_SWAP_MASK8);
+            block = ((block & DCMTK_SWAP_MASK16) << 16) | ((block >> 16) & DCMTK_SWAP_MASK16);
+            memcpy(base + 8 * i, &block, 8);
+        }
+    }
+    else if (valWidth == 8)
+    {
+        for (i = 0; i < blocks; ++i)
+        {
+            memcpy(&block, base + 8 * i, 8);
+            block = ((block & DCMTK_SWAP_MASK8) << 8) | ((block >> 8) & DCMTK_SWAP_MASK8);
+            block = ((block & DCMTK_SWAP_MASK16) << 16) | ((block >> 16) & DCMTK_SWAP_MASK16);
+            block = ((block & DCMTK_SWAP_MASK32) << 32) | ((block >> 32) & DCMTK_SWAP_MASK32);
+            memcpy(base + 8 * i, &block, 8);
+        }
+    }
+    else
+        return 0;
+    return blocks * 8;
+}
+
+#endif
+
+
 OFCondition swapIfNecessary(const E_ByteOrder newByteOrder,
                             const E_ByteOrder oldByteOrder,
                             void * value, const Uint32 byteLength,
@@ -82,12 +150,21 @@ void swapBytes(void * value, const Uint32 byteLength,
     /* use register (if available) to increase speed */
     register Uint8 save;
 
+    Uint8 *data = OFstatic_cast(Uint8 *, value);
+    Uint32 length = byteLength;
+#ifndef OF_NO_UINT64
+    /* swap most of the data in blocks of 8 bytes, the remaining bytes are swapped below */
+    const size_t done = swapBlocks(data, byteLength, valWidth);
+    data += done;
+    length -= OFstatic_cast(Uint32, done);
+#endif
+
     /* in case valWidth equals 2, swap correspondingly */
     if (valWidth == 2)
     {
-        register Uint8 *first = &OFstatic_cast(Uint8*, value)[0];
-        register Uint8 *second = &OFstatic_cast(Uint8*, value)[1];
-        register Uint32 times = byteLength / 2;
+        register Uint8 *first = &data[0];
+        register Uint8 *second = &data[1];
+        register Uint32 times = length / 2;
         while(times--)
         {
             save = *first;
@@ -106,8 +183,8 @@ void swapBytes(void * value, const Uint32 byteLength,
         register Uint8 *start;
         register Uint8 *end;
 
-        Uint32 times = OFstatic_cast(Uint32, byteLength / valWidth);
-        Uint8  *base = OFstatic_cast(Uint8 *, value);
+        Uint32 times = OFstatic_cast(Uint32, length / valWidth);
+        Uint8  *base = data;
 
         while (times--)
         {
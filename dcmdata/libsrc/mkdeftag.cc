@@ -140,7 +140,7 @@ int main(int argc, char* argv[])
 
     prepareCmdLineArgs(argc, argv, "mkdeftag");
 
-    DcmDataDictionary& globalDataDict = dcmDataDict.wrlock();
+    DcmDataDictionary& globalDataDict = *dcmDataDict.wrlock();
 
     /* clear out global data dictionary */
     globalDataDict.clear();
@@ -126,7 +126,7 @@ main(int argc, char* argv[])
 
     prepareCmdLineArgs(argc, argv, "mkdictbi");
 
-    DcmDataDictionary& globalDataDict = dcmDataDict.wrlock();
+    DcmDataDictionary& globalDataDict = *dcmDataDict.wrlock();
 
     /* clear out any preloaded dictionary */
     globalDataDict.clear();
@@ -0,0 +1,203 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the allocation of datasets from a memory arena
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+#include "dcmtk/dcmdata/dcuid.h"
+
+#define INCLUDE_CSTDIO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+// temporary file which will be used
+static const char *temporaryFile = "arena.tmp";
+
+#define NUMBER_OF_ITEMS 500
+
+
+/* create a DICOM file with a large sequence, some long string values and pixel data */
+static OFBool createFile()
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.0.2");
+    dataset->putAndInsertString(DCM_PatientName, "Doe^John");
+    OFString text(20000, 'x');
+    dataset->putAndInsertOFStringArray(DCM_TextValue, text);
+    for (unsigned long i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        DcmItem *item = NULL;
+        if (dataset->findOrCreateSequenceItem(DCM_ReferencedImageSequence, item, -2 /*append*/).good())
+        {
+            char buffer[64];
+            sprintf(buffer, "1.2.276.0.7230010.3.1.4.0.0.1.%lu", i);
+            item->putAndInsertString(DCM_ReferencedSOPClassUID, UID_SecondaryCaptureImageStorage);
+            item->putAndInsertString(DCM_ReferencedSOPInstanceUID, buffer);
+            item->putAndInsertUint16(DCM_ReferencedFrameNumber, OFstatic_cast(Uint16, i));
+        }
+    }
+    Uint8 pixels[256];
+    for (unsigned long i = 0; i < sizeof(pixels); ++i)
+        pixels[i] = OFstatic_cast(Uint8, i);
+    dataset->putAndInsertUint8Array(DCM_PixelData, pixels, sizeof(pixels));
+    return fileformat.saveFile(temporaryFile, EXS_LittleEndianExplicit).good();
+}
+
+
+/* compare the DICOM file loaded with and without arena allocation */
+static OFBool compareFiles(DcmFileFormat &fileformat1,
+                           DcmFileFormat &fileformat2)
+{
+    OFOStringStream oss1, oss2;
+    // make sure that large values are printed in both cases
+    fileformat1.loadAllDataIntoMemory();
+    fileformat2.loadAllDataIntoMemory();
+    fileformat1.print(oss1);
+    fileformat2.print(oss2);
+    oss1 << OFStringStream_ends;
+    oss2 << OFStringStream_ends;
+    OFSTRINGSTREAM_GETOFSTRING(oss1, str1)
+    OFSTRINGSTREAM_GETOFSTRING(oss2, str2)
+    return !str1.empty() && (str1 == str2);
+}
+
+
+OFTEST(dcmdata_arenaAllocation)
+{
+    OFCHECK(createFile());
+    DcmFileFormat reference;
+    OFCHECK(reference.loadFile(temporaryFile).good());
+
+    DcmElement *element = NULL;
+    DcmItem *item = NULL;
+    {
+        DcmFileFormat fileformat;
+        fileformat.getDataset()->setArenaAllocation(OFTrue, 4096);
+        OFCHECK(fileformat.loadFile(temporaryFile).good());
+        OFCHECK(compareFiles(reference, fileformat));
+        // the same object can be loaded again (using a new arena)
+        OFCHECK(fileformat.loadFile(temporaryFile).good());
+        OFCHECK(compareFiles(reference, fileformat));
+        DcmDataset *dataset = fileformat.getDataset();
+        // replace and add some values
+        OFCHECK(dataset->putAndInsertString(DCM_PatientName, "Doe^Jane").good());
+        OFCHECK(dataset->putAndInsertString(DCM_PatientID, "12345").good());
+        OFCHECK(reference.getDataset()->putAndInsertString(DCM_PatientName, "Doe^Jane").good());
+        OFCHECK(reference.getDataset()->putAndInsertString(DCM_PatientID, "12345").good());
+        OFCHECK(compareFiles(reference, fileformat));
+        // values allocated from the arena can only be detached as a copy
+        char *original = NULL;
+        OFCHECK(dataset->findAndGetElement(DCM_SOPClassUID, element).good());
+        if ((element != NULL) && element->getString(original).good() && (original != NULL))
+        {
+            OFCHECK(element->detachValueField(OFTrue).good());
+            char *copied = NULL;
+            OFCHECK(element->getString(copied).good());
+            OFCHECK(copied != original);
+            OFCHECK_EQUAL(OFString(original), UID_SecondaryCaptureImageStorage);
+#ifdef WITH_ARENA_ALLOCATION
+            // the copy is allocated from the heap, i.e. it can be handed over to the caller
+            OFCHECK(element->detachValueField(OFFalse).good());
+            delete[] OFreinterpret_cast(Uint8 *, copied);
+#else
+            delete[] OFreinterpret_cast(Uint8 *, original);
+#endif
+        }
+#ifdef WITH_ARENA_ALLOCATION
+        OFCHECK(dataset->findAndGetElement(DCM_SOPInstanceUID, element).good());
+        if (element != NULL)
+            OFCHECK(element->detachValueField(OFFalse) == EC_IllegalCall);
+#endif
+        // remove an element and an item, which have to outlive the dataset
+        element = dataset->remove(DCM_SOPInstanceUID);
+        DcmSequenceOfItems *sequence = NULL;
+        OFCHECK(dataset->findAndGetSequence(DCM_ReferencedImageSequence, sequence).good());
+        if (sequence != NULL)
+            item = sequence->remove(OFstatic_cast(unsigned long, 0));
+        // a copy of the dataset is allocated from the heap
+        DcmDataset copy(*dataset);
+        OFCHECK(copy.putAndInsertString(DCM_PatientID, "67890").good());
+    }
+    OFCHECK(element != NULL);
+    OFCHECK(item != NULL);
+    if (element != NULL)
+    {
+        OFString value;
+        OFCHECK(element->getOFString(value, 0).good());
+        OFCHECK_EQUAL(value, "1.2.276.0.7230010.3.1.4.0.0.0.2");
+        delete element;
+    }
+    if (item != NULL)
+    {
+        OFString value;
+        OFCHECK(item->findAndGetOFString(DCM_ReferencedSOPInstanceUID, value).good());
+        OFCHECK_EQUAL(value, "1.2.276.0.7230010.3.1.4.0.0.1.0");
+        delete item;
+    }
+    remove(temporaryFile);
+}
+
+
+OFTEST(dcmdata_arenaOperatorNew)
+{
+    // the placement and nothrow forms of operator new are still available
+    DcmItem *item = NULL;
+#ifdef HAVE_STD__NOTHROW
+    item = new (std::nothrow) DcmItem();
+    OFCHECK(item != NULL);
+    if (item != NULL)
+    {
+        OFCHECK(item->putAndInsertString(DCM_PatientName, "Doe^John").good());
+        delete item;
+    }
+#endif
+    DcmMemoryArena *arena = new DcmMemoryArena(4096);
+    void *buffer = arena->allocate(sizeof(DcmItem));
+    OFCHECK(buffer != NULL);
+    if (buffer != NULL)
+    {
+        item = new (buffer) DcmItem();
+        OFCHECK(item->putAndInsertString(DCM_PatientName, "Doe^John").good());
+        item->~DcmItem();
+        arena->release();
+    }
+    arena->release();
+#ifdef WITH_ARENA_ALLOCATION
+    // objects that are created within a scope are allocated from the arena
+    arena = new DcmMemoryArena(4096);
+    {
+        DcmMemoryArenaScope scope(arena);
+        OFCHECK(DcmMemoryArena::getCurrentArena() == arena);
+        item = new DcmItem();
+    }
+    OFCHECK(DcmMemoryArena::getCurrentArena() == NULL);
+    arena->release();
+    // the item still holds a reference to the arena
+    OFCHECK(item->putAndInsertString(DCM_PatientName, "Doe^John").good());
+    delete item;
+#endif
+}
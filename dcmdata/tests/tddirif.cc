@@ -0,0 +1,378 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the creation of a DICOMDIR from many files
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/ofstd/ofmap.h"
+#include "dcmtk/dcmdata/dcddirif.h"
+#include "dcmtk/dcmdata/dcdicdir.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+
+#define INCLUDE_CSTDIO
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+// DICOMDIR files which will be created (one per thread setting)
+static const char *temporaryDicomDir1 = "dicomdir1.tmp";
+static const char *temporaryDicomDir2 = "dicomdir2.tmp";
+
+// number of patients, studies per patient, series per study and instances per series
+#define NUMBER_OF_PATIENTS 3
+#define NUMBER_OF_STUDIES 2
+#define NUMBER_OF_SERIES 3
+#define NUMBER_OF_INSTANCES 9
+
+// root of the UIDs used for the test files
+#define UID_ROOT "1.2.276.0.7230010.3.1.4.0.0.24"
+
+
+/* identifying attributes of a test file */
+struct TestFile
+{
+    /// name of the file
+    OFString Filename;
+    /// Study and Series Instance UID, identifying the series record
+    OFString SeriesKey;
+    /// SOP Instance UID
+    OFString SOPInstanceUID;
+    /// Instance Number (negative if absent)
+    long InstanceNumber;
+};
+
+
+/* create a DICOM file with the given identifying attributes */
+static void createFile(TestFile &file,
+                       const char *filename,
+                       const unsigned long patient,
+                       const unsigned long study,
+                       const unsigned long series,
+                       const long instanceNumber,
+                       const char *sopInstanceUID,
+                       const char *seriesInstanceUID)
+{
+    char buf[128];
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID);
+    sprintf(buf, "Patient^%lu", patient);
+    dataset->putAndInsertString(DCM_PatientName, buf);
+    sprintf(buf, "PAT%lu", patient);
+    dataset->putAndInsertString(DCM_PatientID, buf);
+    dataset->putAndInsertString(DCM_StudyDate, "20150101");
+    dataset->putAndInsertString(DCM_StudyTime, "120000");
+    sprintf(buf, "%s.%lu.%lu", UID_ROOT, patient, study);
+    dataset->putAndInsertString(DCM_StudyInstanceUID, buf);
+    file.SeriesKey = OFString(buf) + "/" + seriesInstanceUID;
+    sprintf(buf, "%lu", study + 1);
+    dataset->putAndInsertString(DCM_StudyID, buf);
+    dataset->putAndInsertString(DCM_Modality, "OT");
+    dataset->putAndInsertString(DCM_SeriesInstanceUID, seriesInstanceUID);
+    sprintf(buf, "%lu", series + 1);
+    dataset->putAndInsertString(DCM_SeriesNumber, buf);
+    if (instanceNumber >= 0)
+    {
+        sprintf(buf, "%ld", instanceNumber);
+        dataset->putAndInsertString(DCM_InstanceNumber, buf);
+    }
+    OFCHECK(fileformat.saveFile(filename, EXS_LittleEndianExplicit).good());
+    file.Filename = filename;
+    file.SOPInstanceUID = sopInstanceUID;
+    file.InstanceNumber = instanceNumber;
+}
+
+
+/* get the Instance Number of the given instance, several instances share the same number */
+static long getInstanceNumber(const unsigned long instance)
+{
+    return OFstatic_cast(long, (instance * 5) % 7);
+}
+
+
+/* create the test files and return them in a shuffled order */
+static void createFiles(OFVector<TestFile> &files)
+{
+    char buf[128];
+    char sopInstanceUID[128];
+    char seriesInstanceUID[128];
+    TestFile file;
+    files.clear();
+    unsigned long count = 0;
+    for (unsigned long patient = 0; patient < NUMBER_OF_PATIENTS; ++patient)
+    {
+        for (unsigned long study = 0; study < NUMBER_OF_STUDIES; ++study)
+        {
+            for (unsigned long series = 0; series < NUMBER_OF_SERIES; ++series)
+            {
+                // the last series of the second study has the same UID as the one of the first study
+                if ((study == 1) && (series == NUMBER_OF_SERIES - 1))
+                    sprintf(seriesInstanceUID, "%s.%lu.0.%lu", UID_ROOT, patient, series);
+                else
+                    sprintf(seriesInstanceUID, "%s.%lu.%lu.%lu", UID_ROOT, patient, study, series);
+                for (unsigned long instance = 0; instance < NUMBER_OF_INSTANCES; ++instance)
+                {
+                    sprintf(buf, "DDIR%04lu", ++count);
+                    sprintf(sopInstanceUID, "%s.%lu.%lu.%lu.%lu", UID_ROOT, patient, study, series, instance);
+                    // some instances have no Instance Number
+                    createFile(file, buf, patient, study, series, ((count % 7) != 0) ? getInstanceNumber(instance) : -1,
+                        sopInstanceUID, seriesInstanceUID);
+                    files.push_back(file);
+                }
+                // a second file with the UID of an instance of this series
+                sprintf(buf, "DDIR%04lu", ++count);
+                createFile(file, buf, patient, study, series, getInstanceNumber(1), sopInstanceUID, seriesInstanceUID);
+                files.push_back(file);
+                // and an instance with the UID of an instance of another series
+                if (series > 0)
+                {
+                    sprintf(buf, "DDIR%04lu", ++count);
+                    sprintf(sopInstanceUID, "%s.%lu.%lu.%lu.%lu", UID_ROOT, patient, study, series - 1, 2UL);
+                    createFile(file, buf, patient, study, series, getInstanceNumber(NUMBER_OF_INSTANCES),
+                        sopInstanceUID, seriesInstanceUID);
+                    files.push_back(file);
+                }
+            }
+        }
+    }
+    // shuffle the files (always in the same way)
+    Uint32 seed = 4711;
+    for (size_t i = files.size() - 1; i > 0; --i)
+    {
+        seed = seed * 1103515245 + 12345;
+        const size_t j = OFstatic_cast(size_t, (seed >> 8) % (i + 1));
+        file = files[i];
+        files[i] = files[j];
+        files[j] = file;
+    }
+}
+
+
+/* determine the expected order of the image records in each series, i.e. the
+ * referenced files separated by spaces, without using a DICOMDIR. A new record is
+ * inserted before the first record with a greater Instance Number. In invent mode,
+ * a record without Instance Number is appended and then gets the next invented number.
+ */
+static void getExpectedRecordOrder(const OFVector<TestFile> &files,
+                                   const OFBool inventMode,
+                                   OFMap<OFString, OFString> &recordOrder)
+{
+    // records of each series: index of the file and Instance Number
+    OFMap<OFString, OFVector<size_t> > records;
+    OFMap<OFString, OFVector<long> > numbers;
+    long inventedNumber = 1;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const TestFile &file = files[i];
+        // without invent mode, files without Instance Number are rejected
+        if (!inventMode && (file.InstanceNumber < 0))
+            continue;
+        OFVector<size_t> &seriesRecords = records[file.SeriesKey];
+        OFVector<long> &seriesNumbers = numbers[file.SeriesKey];
+        // there is already a record for this SOP instance in this series
+        size_t pos = 0;
+        while ((pos < seriesRecords.size()) && (files[seriesRecords[pos]].SOPInstanceUID != file.SOPInstanceUID))
+            ++pos;
+        if (pos < seriesRecords.size())
+            continue;
+        long number = file.InstanceNumber;
+        if (number < 0)
+            number = inventedNumber++;
+        else
+        {
+            pos = 0;
+            while ((pos < seriesNumbers.size()) && (seriesNumbers[pos] <= number))
+                ++pos;
+        }
+        seriesRecords.insert(seriesRecords.begin() + pos, i);
+        seriesNumbers.insert(seriesNumbers.begin() + pos, number);
+    }
+    recordOrder.clear();
+    for (OFMap<OFString, OFVector<size_t> >::iterator iter = records.begin(); iter != records.end(); ++iter)
+    {
+        OFString &order = recordOrder[iter->first];
+        for (size_t j = 0; j < iter->second.size(); ++j)
+            order += " " + files[iter->second[j]].Filename;
+    }
+}
+
+
+/* get the order of the image records in each series of the given DICOMDIR */
+static void getRecordOrder(const char *dicomdirName,
+                           OFMap<OFString, OFString> &recordOrder)
+{
+    recordOrder.clear();
+    DcmDicomDir dicomdir(dicomdirName);
+    OFCHECK(dicomdir.error().good());
+    OFString studyUID, seriesUID, fileID;
+    DcmDirectoryRecord *patient = NULL;
+    while ((patient = dicomdir.getRootRecord().nextSub(patient)) != NULL)
+    {
+        DcmDirectoryRecord *study = NULL;
+        while ((study = patient->nextSub(study)) != NULL)
+        {
+            study->findAndGetOFStringArray(DCM_StudyInstanceUID, studyUID);
+            DcmDirectoryRecord *series = NULL;
+            while ((series = study->nextSub(series)) != NULL)
+            {
+                series->findAndGetOFStringArray(DCM_SeriesInstanceUID, seriesUID);
+                OFString &order = recordOrder[studyUID + "/" + seriesUID];
+                DcmDirectoryRecord *image = NULL;
+                while ((image = series->nextSub(image)) != NULL)
+                {
+                    image->findAndGetOFStringArray(DCM_ReferencedFileID, fileID);
+                    order += " " + fileID;
+                }
+            }
+        }
+    }
+}
+
+
+/* compare the record order of a DICOMDIR with the expected one */
+static OFBool compareRecordOrder(const OFMap<OFString, OFString> &recordOrder,
+                                 const OFMap<OFString, OFString> &expectedOrder)
+{
+    if (recordOrder.size() != expectedOrder.size())
+        return OFFalse;
+    for (OFMap<OFString, OFString>::const_iterator iter = expectedOrder.begin(); iter != expectedOrder.end(); ++iter)
+    {
+        OFMap<OFString, OFString>::const_iterator record = recordOrder.find(iter->first);
+        if ((record == recordOrder.end()) || (record->second != iter->second))
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+
+/* create a DICOMDIR from the given files and return its dataset as a string */
+static OFString createDicomDir(const char *dicomdirName,
+                               const OFList<OFFilename> &filenames,
+                               const unsigned int threads,
+                               const OFBool inventMode,
+                               OFList<OFFilename> &badFiles,
+                               unsigned long &goodFiles,
+                               OFMap<OFString, OFString> &recordOrder)
+{
+    DicomDirInterface ddir;
+    ddir.disableBackupMode();
+    ddir.enableInventMode(inventMode);
+    ddir.setNumberOfThreads(threads);
+    badFiles.clear();
+    goodFiles = 0;
+    OFCHECK(ddir.createNewDicomDir(DicomDirInterface::AP_GeneralPurpose, dicomdirName).good());
+    OFCHECK(ddir.addDicomFiles(filenames, OFFilename(), badFiles, goodFiles).good());
+    OFCHECK(ddir.writeDicomDir().good());
+
+    // the dataset contains the complete record tree, the meta header has a new UID each time
+    DcmFileFormat fileformat;
+    OFCHECK(fileformat.loadFile(dicomdirName).good());
+    OFOStringStream oss;
+    fileformat.getDataset()->print(oss);
+    oss << OFStringStream_ends;
+    OFSTRINGSTREAM_GETOFSTRING(oss, result)
+    getRecordOrder(dicomdirName, recordOrder);
+    OFStandard::deleteFile(dicomdirName);
+    return result;
+}
+
+
+/* count the directory records of the given type in the printed DICOMDIR */
+static unsigned long countRecords(const OFString &dicomdir,
+                                  const OFString &recordType)
+{
+    const OFString value = "[" + recordType;
+    unsigned long result = 0;
+    size_t pos = dicomdir.find(value);
+    while (pos != OFString_npos)
+    {
+        ++result;
+        pos = dicomdir.find(value, pos + 1);
+    }
+    return result;
+}
+
+
+/* compare two lists of filenames */
+static OFBool compareFilenames(const OFList<OFFilename> &list1,
+                               const OFList<OFFilename> &list2)
+{
+    if (list1.size() != list2.size())
+        return OFFalse;
+    OFListConstIterator(OFFilename) iter1 = list1.begin();
+    OFListConstIterator(OFFilename) iter2 = list2.begin();
+    while (iter1 != list1.end())
+    {
+        if (strcmp((iter1++)->getCharPointer(), (iter2++)->getCharPointer()) != 0)
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+
+OFTEST(dcmdata_dicomDirThreads)
+{
+    OFVector<TestFile> files;
+    createFiles(files);
+    OFList<OFFilename> filenames;
+    for (size_t i = 0; i < files.size(); ++i)
+        filenames.push_back(OFFilename(files[i].Filename));
+
+    // without invent mode, the files without Instance Number are rejected
+    OFString dicomdir[2];
+    unsigned long goodFiles[2];
+    for (int invent = 0; invent < 2; ++invent)
+    {
+        OFList<OFFilename> badFiles1, badFiles2;
+        unsigned long goodFiles2 = 0;
+        OFMap<OFString, OFString> recordOrder1, recordOrder2, expectedOrder;
+        dicomdir[invent] = createDicomDir(temporaryDicomDir1, filenames, 1, invent != 0, badFiles1, goodFiles[invent], recordOrder1);
+        const OFString dicomdir2 = createDicomDir(temporaryDicomDir2, filenames, 4, invent != 0, badFiles2, goodFiles2, recordOrder2);
+        OFCHECK(!dicomdir[invent].empty());
+        OFCHECK(dicomdir[invent] == dicomdir2);
+        // the image records are sorted as if the files were added without any index
+        getExpectedRecordOrder(files, invent != 0, expectedOrder);
+        OFCHECK(compareRecordOrder(recordOrder1, expectedOrder));
+        OFCHECK(compareRecordOrder(recordOrder2, expectedOrder));
+        OFCHECK_EQUAL(goodFiles[invent], goodFiles2);
+        OFCHECK_EQUAL(goodFiles[invent] + badFiles1.size(), filenames.size());
+        OFCHECK(compareFilenames(badFiles1, badFiles2));
+    }
+    OFCHECK(goodFiles[0] < goodFiles[1]);
+    OFCHECK_EQUAL(goodFiles[1], filenames.size());
+
+    // the files with the UID of another instance of the same series do not create a new record
+    OFCHECK_EQUAL(countRecords(dicomdir[1], "PATIENT"), NUMBER_OF_PATIENTS);
+    OFCHECK_EQUAL(countRecords(dicomdir[1], "STUDY"), NUMBER_OF_PATIENTS * NUMBER_OF_STUDIES);
+    OFCHECK_EQUAL(countRecords(dicomdir[1], "SERIES"), NUMBER_OF_PATIENTS * NUMBER_OF_STUDIES * NUMBER_OF_SERIES);
+    OFCHECK_EQUAL(countRecords(dicomdir[1], "IMAGE"), NUMBER_OF_PATIENTS * NUMBER_OF_STUDIES *
+        (NUMBER_OF_SERIES * NUMBER_OF_INSTANCES + NUMBER_OF_SERIES - 1));
+
+    OFListIterator(OFFilename) iter = filenames.begin();
+    while (iter != filenames.end())
+        OFStandard::deleteFile(*(iter++));
+}
@@ -34,6 +34,40 @@ OFTEST(dcmdata_readingDataDictionary)
     OFCHECK(dcmDataDict.isDictionaryLoaded());
 }
 
+OFTEST(dcmdata_freezingDataDictionary)
+{
+    // Use a separate instance, since the global dictionary must not be frozen
+    // for the other tests (which might modify it)
+    GlobalDcmDataDictionary globalDict;
+    OFCHECK(!globalDict.isFrozen());
+    // After freezing, the dictionary must still be usable (without locking)
+    globalDict.freeze();
+    OFCHECK(globalDict.isFrozen());
+    OFCHECK(globalDict.isDictionaryLoaded());
+    const DcmDictEntry *entry = globalDict.rdlock().findEntry(DcmTagKey(0x0010, 0x0010), NULL);
+    OFCHECK(entry != NULL);
+    if (entry != NULL)
+        OFCHECK_EQUAL(entry->getEVR(), EVR_PN);
+    globalDict.unlock();
+    // Freezing twice is harmless
+    globalDict.freeze();
+    OFCHECK(globalDict.isFrozen());
+    // Modifying a frozen dictionary is not permitted
+    OFCHECK(globalDict.wrlock() == NULL);
+    globalDict.unlock();
+    // After unfreezing, the dictionary can be modified again
+    globalDict.unfreeze();
+    OFCHECK(!globalDict.isFrozen());
+    DcmDataDictionary *dict = globalDict.wrlock();
+    OFCHECK(dict != NULL);
+    globalDict.unlock();
+    globalDict.freeze();
+    // Clearing is still possible when no other threads are active
+    globalDict.clear();
+    OFCHECK(!globalDict.isDictionaryLoaded());
+    OFCHECK(!dcmDataDict.isFrozen());
+}
+
 OFTEST(dcmdata_usingDataDictionary)
 {
     // This dictionary will only contain the skeleton entries
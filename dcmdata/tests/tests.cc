@@ -24,6 +24,7 @@
 #include "dcmtk/ofstd/oftest.h"
 
 OFTEST_REGISTER(dcmdata_partialElementAccess);
+OFTEST_REGISTER(dcmdata_partialElementAccess_mmap);
 OFTEST_REGISTER(dcmdata_i2d_bmp);
 OFTEST_REGISTER(dcmdata_checkStringValue);
 OFTEST_REGISTER(dcmdata_determineVM);
@@ -81,6 +82,24 @@ OFTEST_REGISTER(dcmdata_elementLength_EVR_xs);
 OFTEST_REGISTER(dcmdata_elementLength_pixelItem);
 OFTEST_REGISTER(dcmdata_elementLength_pixelSequence);
 OFTEST_REGISTER(dcmdata_elementParent);
+OFTEST_REGISTER(dcmdata_itemTagLookup);
+OFTEST_REGISTER(dcmdata_itemInsertAndLookup);
+OFTEST_REGISTER(dcmdata_parallelFrameProcessor);
+OFTEST_REGISTER(dcmdata_parallelRLEDecoding);
+OFTEST_REGISTER(dcmdata_pipelinedFileStream);
+OFTEST_REGISTER(dcmdata_pipelinedFileStream_error);
+OFTEST_REGISTER(dcmdata_arenaAllocation);
+OFTEST_REGISTER(dcmdata_arenaOperatorNew);
+OFTEST_REGISTER(dcmdata_swapBytes);
+OFTEST_REGISTER(dcmdata_zlibParallelDeflate);
+OFTEST_REGISTER(dcmdata_zlibParallelDeflateSmallItems);
+OFTEST_REGISTER(dcmdata_readUntilTag_stopAtTag);
+OFTEST_REGISTER(dcmdata_readUntilTag_tagAbsent);
+OFTEST_REGISTER(dcmdata_readUntilTag_tagInSequence);
+OFTEST_REGISTER(dcmdata_dicomDirThreads);
+OFTEST_REGISTER(dcmdata_rleEncoderBytewise);
+OFTEST_REGISTER(dcmdata_rleEncoderKnownOutput);
+OFTEST_REGISTER(dcmdata_rleRoundTrip);
 OFTEST_REGISTER(dcmdata_parser_missingDelimitationItems);
 OFTEST_REGISTER(dcmdata_parser_missingSequenceDelimitationItem_1);
 OFTEST_REGISTER(dcmdata_parser_missingSequenceDelimitationItem_2);
@@ -95,6 +114,7 @@ OFTEST_REGISTER(dcmdata_parser_wrongExplicitVRinDataset_dictVR_defaultLen);
 OFTEST_REGISTER(dcmdata_parser_wrongExplicitVRinDataset_preferDataDict);
 OFTEST_REGISTER(dcmdata_parser_undefinedLengthUNSequence);
 OFTEST_REGISTER(dcmdata_readingDataDictionary);
+OFTEST_REGISTER(dcmdata_freezingDataDictionary);
 OFTEST_REGISTER(dcmdata_usingDataDictionary);
 OFTEST_REGISTER(dcmdata_specificCharacterSet_1);
 OFTEST_REGISTER(dcmdata_specificCharacterSet_2);
@@ -0,0 +1,124 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for element lookup in DcmItem
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcitem.h"
+#include "dcmtk/dcmdata/dcvrus.h"
+
+
+/* number of elements, large enough to make DcmList::seekTag() use its index */
+#define NUM_ELEMENTS 100
+
+/* create private tag with explicit VR (no private creator required) */
+static DcmTag usTag(const unsigned long elem)
+{
+    return DcmTag(0x0009, OFstatic_cast(Uint16, elem), EVR_US);
+}
+
+OFTEST(dcmdata_itemTagLookup)
+{
+    DcmItem item;
+    DcmElement *elem = NULL;
+    Uint16 value = 0;
+    unsigned long i;
+
+    // insert elements in descending order, DcmItem keeps them sorted
+    for (i = NUM_ELEMENTS; i > 0; i--)
+        OFCHECK(item.putAndInsertUint16(usTag(2 * i), OFstatic_cast(Uint16, i)).good());
+    OFCHECK_EQUAL(item.card(), NUM_ELEMENTS);
+
+    // lookup of existing and non-existing elements
+    for (i = 1; i <= NUM_ELEMENTS; i++)
+    {
+        OFCHECK(item.findAndGetUint16(usTag(2 * i), value).good());
+        OFCHECK_EQUAL(value, i);
+        OFCHECK(!item.tagExists(usTag(2 * i + 1)));
+    }
+    OFCHECK(!item.tagExists(DcmTagKey(0x0008, 0x0002)));
+    OFCHECK(!item.tagExists(DcmTagKey(0x000a, 0x0002)));
+
+    // remove every other element and check that lookups still succeed
+    for (i = 1; i <= NUM_ELEMENTS; i += 2)
+    {
+        elem = item.remove(usTag(2 * i));
+        OFCHECK(elem != NULL);
+        delete elem;
+    }
+    OFCHECK_EQUAL(item.card(), NUM_ELEMENTS / 2);
+    for (i = 1; i <= NUM_ELEMENTS; i++)
+        OFCHECK_EQUAL(item.tagExists(usTag(2 * i)), (i % 2) == 0);
+
+    // insert an element between existing ones and look it up again
+    OFCHECK(item.putAndInsertUint16(usTag(0x0005), 42).good());
+    OFCHECK(item.findAndGetUint16(DcmTagKey(0x0009, 0x0005), value).good());
+    OFCHECK_EQUAL(value, 42);
+
+    // replace an existing element
+    OFCHECK(item.putAndInsertUint16(usTag(0x0004), 4711).good());
+    OFCHECK(item.findAndGetUint16(DcmTagKey(0x0009, 0x0004), value).good());
+    OFCHECK_EQUAL(value, 4711);
+    OFCHECK_EQUAL(item.card(), NUM_ELEMENTS / 2 + 1);
+}
+
+
+OFTEST(dcmdata_itemInsertAndLookup)
+{
+    DcmItem item;
+    Uint16 value = 0;
+    unsigned long i;
+
+    // insert elements in a scrambled order with lookups in between, so that
+    // the tag index of the element list is used and updated by every insertion
+    for (i = 0; i < NUM_ELEMENTS; i++)
+    {
+        const unsigned long elem = (i * 37) % NUM_ELEMENTS + 1;
+        OFCHECK(item.putAndInsertUint16(usTag(2 * elem), OFstatic_cast(Uint16, elem)).good());
+        OFCHECK(item.findAndGetUint16(usTag(2 * elem), value).good());
+        OFCHECK_EQUAL(value, elem);
+        OFCHECK(!item.tagExists(usTag(2 * elem + 1)));
+    }
+    OFCHECK_EQUAL(item.card(), NUM_ELEMENTS);
+
+    // inserting an existing element again fails unless it is replaced
+    DcmElement *doubled = new DcmUnsignedShort(usTag(2));
+    OFCHECK(item.insert(doubled, OFFalse /*replaceOld*/) == EC_DoubledTag);
+    delete doubled;
+    OFCHECK(item.putAndInsertUint16(usTag(2), 4711).good());
+    OFCHECK(item.findAndGetUint16(usTag(2), value).good());
+    OFCHECK_EQUAL(value, 4711);
+
+    // remove and insert elements alternately, then check that the elements are still sorted
+    for (i = 1; i <= NUM_ELEMENTS; i += 3)
+    {
+        DcmElement *elem = item.remove(usTag(2 * i));
+        OFCHECK(elem != NULL);
+        delete elem;
+        OFCHECK(!item.tagExists(usTag(2 * i)));
+        OFCHECK(item.putAndInsertUint16(usTag(2 * i + 1), OFstatic_cast(Uint16, i)).good());
+        OFCHECK(item.tagExists(usTag(2 * i + 1)));
+    }
+    OFCHECK_EQUAL(item.card(), NUM_ELEMENTS);
+    for (i = 1; i < item.card(); i++)
+        OFCHECK(item.getElement(i - 1)->getTag() < item.getElement(i)->getTag());
+}
@@ -0,0 +1,99 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class DcmOutputPipelinedFileStream
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/dcmdata/dcostrmp.h"
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+// temporary file which will be used
+static const char *temporaryFile = "ostrmp.tmp";
+
+#define TOTAL_SIZE 100000
+
+OFTEST(dcmdata_pipelinedFileStream)
+{
+    // pseudo-random bytes, so that data written at a wrong position or twice is detected
+    Uint8 *data = new Uint8[TOTAL_SIZE];
+    Uint32 seed = 4711;
+    for (unsigned long i = 0; i < TOTAL_SIZE; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = OFstatic_cast(Uint8, seed >> 16);
+    }
+
+    {
+        // use small buffers in order to make sure that the writer thread has to catch up
+        DcmOutputPipelinedFileStream stream(temporaryFile, 3, 1000);
+        OFCHECK(stream.good());
+        unsigned long pos = 0;
+        unsigned long chunk = 1;
+        while (pos < TOTAL_SIZE)
+        {
+            unsigned long count = (chunk * 37) % 5003 + 1;
+            if (count > TOTAL_SIZE - pos)
+                count = TOTAL_SIZE - pos;
+            OFCHECK_EQUAL(stream.write(data + pos, count), OFstatic_cast(offile_off_t, count));
+            pos += count;
+            // flush in the middle of the data
+            if (++chunk == 20)
+            {
+                stream.flush();
+                OFCHECK(stream.isFlushed());
+            }
+        }
+        OFCHECK_EQUAL(stream.tell(), OFstatic_cast(offile_off_t, TOTAL_SIZE));
+        OFCHECK(stream.close().good());
+        // no more data can be written after the stream has been closed
+        OFCHECK_EQUAL(stream.write(data, 10), 0);
+    }
+
+    // read the file and compare with the original data
+    OFFile file;
+    OFCHECK(file.fopen(temporaryFile, "rb"));
+    if (file.open())
+    {
+        Uint8 *buffer = new Uint8[TOTAL_SIZE + 1];
+        OFCHECK_EQUAL(file.fread(buffer, 1, TOTAL_SIZE + 1), OFstatic_cast(size_t, TOTAL_SIZE));
+        OFCHECK(memcmp(buffer, data, TOTAL_SIZE) == 0);
+        file.fclose();
+        delete[] buffer;
+    }
+    OFStandard::deleteFile(temporaryFile);
+    delete[] data;
+}
+
+OFTEST(dcmdata_pipelinedFileStream_error)
+{
+    // the file cannot be created
+    DcmOutputPipelinedFileStream stream("non-existing-directory/ostrmp.tmp");
+    OFCHECK(!stream.good());
+    Uint8 data[16] = { 0 };
+    OFCHECK_EQUAL(stream.write(data, sizeof(data)), 0);
+    OFCHECK(stream.close().bad());
+}
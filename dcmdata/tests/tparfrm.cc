@@ -0,0 +1,171 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for parallel processing of multi-frame images
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dctk.h"
+#include "dcmtk/dcmdata/dcparfrm.h"
+#include "dcmtk/dcmdata/dcrledrg.h"
+#include "dcmtk/dcmdata/dcrleerg.h"
+
+
+#define NUM_FRAMES 23
+#define ROWS 16
+#define COLUMNS 17
+
+/* frame processor that counts the processed frames and fails for one frame */
+class TestFrameProcessor : public DcmParallelFrameProcessor
+{
+public:
+    TestFrameProcessor(Uint32 numberOfFrames, Uint32 failingFrame)
+    : DcmParallelFrameProcessor(numberOfFrames)
+    , failingFrame_(failingFrame)
+    , mutex_()
+    {
+        for (Uint32 i = 0; i < NUM_FRAMES; ++i)
+            processed_[i] = 0;
+    }
+
+    virtual OFCondition processFrame(Uint32 frameNo, Uint32 /* threadNo */)
+    {
+        mutex_.lock();
+        ++processed_[frameNo];
+        mutex_.unlock();
+        return (frameNo == failingFrame_) ? EC_CorruptedData : EC_Normal;
+    }
+
+    int processed_[NUM_FRAMES];
+
+private:
+    Uint32 failingFrame_;
+    OFMutex mutex_;
+};
+
+/* get the value of the given sample. The high byte is the frame number, i.e. each
+ * frame differs and its high byte segment consists of replicate runs only. The low
+ * byte varies with the position and results in literal runs.
+ */
+static Uint16 getSampleValue(const unsigned long i)
+{
+    const unsigned long frame = i / (ROWS * COLUMNS * 3);
+    return OFstatic_cast(Uint16, (frame << 8) | ((i * 5) % 251));
+}
+
+/* create multi-frame RGB image with 16 bits per sample */
+static void createImage(DcmDataset& dset)
+{
+    const unsigned long numValues = NUM_FRAMES * ROWS * COLUMNS * 3;
+    Uint16 *pixelData = new Uint16[numValues];
+    for (unsigned long i = 0; i < numValues; ++i)
+        pixelData[i] = getSampleValue(i);
+    dset.putAndInsertString(DCM_SOPClassUID, UID_MultiframeTrueColorSecondaryCaptureImageStorage);
+    dset.putAndInsertString(DCM_SOPInstanceUID, "1.2.3.4.5.6.7.8.9");
+    dset.putAndInsertString(DCM_PhotometricInterpretation, "RGB");
+    dset.putAndInsertString(DCM_NumberOfFrames, "23");
+    dset.putAndInsertUint16(DCM_SamplesPerPixel, 3);
+    dset.putAndInsertUint16(DCM_PlanarConfiguration, 0);
+    dset.putAndInsertUint16(DCM_Rows, ROWS);
+    dset.putAndInsertUint16(DCM_Columns, COLUMNS);
+    dset.putAndInsertUint16(DCM_BitsAllocated, 16);
+    dset.putAndInsertUint16(DCM_BitsStored, 16);
+    dset.putAndInsertUint16(DCM_HighBit, 15);
+    dset.putAndInsertUint16(DCM_PixelRepresentation, 0);
+    dset.putAndInsertUint16Array(DCM_PixelData, pixelData, numValues);
+    delete[] pixelData;
+}
+
+/* decompress the given RLE image using the given number of threads */
+static void decompressImage(DcmDataset& dset, Uint32 numberOfThreads)
+{
+    DcmRLEDecoderRegistration::registerCodecs(OFFalse, OFFalse, numberOfThreads);
+    OFCHECK(dset.chooseRepresentation(EXS_LittleEndianExplicit, NULL).good());
+    OFCHECK(dset.canWriteXfer(EXS_LittleEndianExplicit));
+    DcmRLEDecoderRegistration::cleanup();
+}
+
+OFTEST(dcmdata_parallelFrameProcessor)
+{
+    Uint32 i;
+    // all frames are processed exactly once
+    TestFrameProcessor processor(NUM_FRAMES, NUM_FRAMES);
+    OFCHECK(processor.processAllFrames(4).good());
+    for (i = 0; i < NUM_FRAMES; ++i)
+        OFCHECK_EQUAL(processor.processed_[i], 1);
+    // same in the calling thread only
+    TestFrameProcessor sequential(NUM_FRAMES, NUM_FRAMES);
+    OFCHECK_EQUAL(sequential.getNumberOfThreadsUsed(0), 1);
+    OFCHECK_EQUAL(sequential.getNumberOfThreadsUsed(1), 1);
+    OFCHECK(sequential.processAllFrames(1).good());
+    for (i = 0; i < NUM_FRAMES; ++i)
+        OFCHECK_EQUAL(sequential.processed_[i], 1);
+    // an error is reported and no frame is processed twice
+    TestFrameProcessor failing(NUM_FRAMES, 5);
+    OFCHECK(failing.processAllFrames(4) == EC_CorruptedData);
+    for (i = 0; i < NUM_FRAMES; ++i)
+        OFCHECK(failing.processed_[i] <= 1);
+    OFCHECK_EQUAL(failing.processed_[5], 1);
+    // never more threads than frames
+    TestFrameProcessor small(2, 2);
+    OFCHECK(small.getNumberOfThreadsUsed(8) <= 2);
+}
+
+OFTEST(dcmdata_parallelRLEDecoding)
+{
+    DcmDataset original;
+    createImage(original);
+
+    // compress image, each frame is stored in a single pixel item
+    DcmRLEEncoderRegistration::registerCodecs();
+    OFCHECK(original.chooseRepresentation(EXS_RLELossless, NULL).good());
+    OFCHECK(original.canWriteXfer(EXS_RLELossless));
+    DcmRLEEncoderRegistration::cleanup();
+    // make sure that the uncompressed pixel data is not simply reused
+    original.removeAllButCurrentRepresentations();
+
+    // decompress copies of the compressed image sequentially and in parallel
+    DcmDataset sequential(original);
+    DcmDataset parallel(original);
+    decompressImage(sequential, 1);
+    decompressImage(parallel, 4);
+
+    const Uint16 *sequentialData = NULL;
+    const Uint16 *parallelData = NULL;
+    unsigned long sequentialCount = 0;
+    unsigned long parallelCount = 0;
+    OFCHECK(sequential.findAndGetUint16Array(DCM_PixelData, sequentialData, &sequentialCount).good());
+    OFCHECK(parallel.findAndGetUint16Array(DCM_PixelData, parallelData, &parallelCount).good());
+    OFCHECK_EQUAL(sequentialCount, OFstatic_cast(unsigned long, NUM_FRAMES * ROWS * COLUMNS * 3));
+    OFCHECK_EQUAL(parallelCount, sequentialCount);
+    if ((sequentialData != NULL) && (parallelData != NULL) && (parallelCount == sequentialCount))
+    {
+        // compare with the original pixel data
+        unsigned long mismatches = 0;
+        for (unsigned long i = 0; i < sequentialCount; ++i)
+        {
+            const Uint16 expected = getSampleValue(i);
+            if ((sequentialData[i] != expected) || (parallelData[i] != expected))
+                ++mismatches;
+        }
+        OFCHECK_EQUAL(mismatches, 0);
+    }
+}
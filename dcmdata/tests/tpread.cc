@@ -35,6 +35,7 @@
 #include "dcmtk/dcmdata/dcuid.h"       /* for dcmtk version name */
 #include "dcmtk/dcmdata/dcostrmz.h"    /* for dcmZlibCompressionLevel */
 #include "dcmtk/dcmdata/dcistrmz.h"    /* for dcmZlibExpectRFC1950Encoding */
+#include "dcmtk/dcmdata/dcistrmf.h"    /* for dcmUseMemoryMappedFiles */
 #include "dcmtk/dcmdata/dcfcache.h"
 
 #ifdef WITH_ZLIB
@@ -313,7 +314,7 @@ static OFCondition randomRead(DcmDataset *dset, unsigned char *buffer)
   return cond;
 }
 
-OFTEST(dcmdata_partialElementAccess)
+static void testPartialElementAccess(const OFString& prefix)
 {
   // TODO TODO TODO TODO???
 #ifdef HAVE_GUSI_H
@@ -345,12 +346,12 @@ OFTEST(dcmdata_partialElementAccess)
 
     OFLOG_DEBUG(tstpreadLogger, "Writing test files");
 
-    cond = dfile.saveFile("test_be.dcm", EXS_BigEndianExplicit);
+    cond = dfile.saveFile((prefix + "_be.dcm").c_str(), EXS_BigEndianExplicit);
     if (cond.bad()) { OFCHECK_FAIL(cond.text()); }
-    cond = dfile.saveFile("test_le.dcm", EXS_LittleEndianExplicit);
+    cond = dfile.saveFile((prefix + "_le.dcm").c_str(), EXS_LittleEndianExplicit);
     if (cond.bad()) { OFCHECK_FAIL(cond.text()); }
 #ifdef WITH_ZLIB
-    cond = dfile.saveFile("test_df.dcm", EXS_DeflatedLittleEndianExplicit);
+    cond = dfile.saveFile((prefix + "_df.dcm").c_str(), EXS_DeflatedLittleEndianExplicit);
     if (cond.bad()) { OFCHECK_FAIL(cond.text()); }
 #endif
 
@@ -360,14 +361,14 @@ OFTEST(dcmdata_partialElementAccess)
     DcmFileFormat dfile_le;
     DcmFileFormat dfile_df;
 
-    cond = dfile_be.loadFile("test_be.dcm");
+    cond = dfile_be.loadFile((prefix + "_be.dcm").c_str());
     if (cond.bad()) { OFCHECK_FAIL(cond.text()); }
 
-    cond = dfile_le.loadFile("test_le.dcm");
+    cond = dfile_le.loadFile((prefix + "_le.dcm").c_str());
     if (cond.bad()) { OFCHECK_FAIL(cond.text()); }
 
 #ifdef WITH_ZLIB
-    cond = dfile_df.loadFile("test_df.dcm");
+    cond = dfile_df.loadFile((prefix + "_df.dcm").c_str());
     if (cond.bad()) { OFCHECK_FAIL(cond.text()); }
 #endif
 
@@ -413,10 +414,25 @@ OFTEST(dcmdata_partialElementAccess)
     if (cond.bad()) { OFCHECK_FAIL(cond.text()); }
 #endif
 
-    unlink("test_be.dcm");
-    unlink("test_le.dcm");
+    unlink((prefix + "_be.dcm").c_str());
+    unlink((prefix + "_le.dcm").c_str());
 #ifdef WITH_ZLIB
-    unlink("test_df.dcm");
+    unlink((prefix + "_df.dcm").c_str());
 #endif
     delete[] buffer;
 }
+
+OFTEST(dcmdata_partialElementAccess)
+{
+    dcmUseMemoryMappedFiles.set(OFFalse);
+    testPartialElementAccess("test");
+}
+
+OFTEST(dcmdata_partialElementAccess_mmap)
+{
+    // same test, but read all files through memory mapping (if available)
+    // use different file names since the tests might run in parallel
+    dcmUseMemoryMappedFiles.set(OFTrue);
+    testPartialElementAccess("test_mmap");
+    dcmUseMemoryMappedFiles.set(OFFalse);
+}
@@ -0,0 +1,187 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for stopping the parser at a given tag
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcmetinf.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmdata/dcistrmb.h"
+#include "dcmtk/dcmdata/dcostrmb.h"
+#include "dcmtk/ofstd/ofvector.h"
+
+#define INCLUDE_CSTDIO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+// temporary files which will be used (one per test, since tests may run in parallel)
+static const char *temporaryFile1 = "readtag1.tmp";
+static const char *temporaryFile2 = "readtag2.tmp";
+
+#define NUMBER_OF_ITEMS 3
+
+
+/* create a dataset with a sequence, some attributes following it and pixel data */
+static void createDataset(DcmDataset &dataset)
+{
+    dataset.putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.0.5");
+    for (unsigned long i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        DcmItem *item = NULL;
+        if (dataset.findOrCreateSequenceItem(DCM_ReferencedImageSequence, item, -2 /* append */).good())
+        {
+            item->putAndInsertString(DCM_ReferencedSOPClassUID, UID_SecondaryCaptureImageStorage);
+            item->putAndInsertString(DCM_ReferencedSOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.1.5");
+            // an attribute with a tag larger than the one parsing stops at
+            item->putAndInsertString(DCM_PatientID, "item");
+        }
+    }
+    dataset.putAndInsertString(DCM_PatientName, "Doe^John");
+    dataset.putAndInsertString(DCM_PatientID, "12345");
+    Uint8 pixels[256];
+    for (unsigned long i = 0; i < sizeof(pixels); ++i)
+        pixels[i] = OFstatic_cast(Uint8, i);
+    dataset.putAndInsertUint8Array(DCM_PixelData, pixels, sizeof(pixels));
+}
+
+
+/* check which attributes of the dataset created by createDataset() have been read */
+static void checkDataset(DcmDataset &dataset,
+                         const OFBool patientName,
+                         const OFBool patientID,
+                         const OFBool pixelData)
+{
+    OFCHECK(dataset.tagExists(DCM_SOPClassUID));
+    OFCHECK(dataset.tagExists(DCM_SOPInstanceUID));
+    OFCHECK_EQUAL(dataset.tagExists(DCM_PatientName), patientName);
+    OFCHECK_EQUAL(dataset.tagExists(DCM_PatientID), patientID);
+    OFCHECK_EQUAL(dataset.tagExists(DCM_PixelData), pixelData);
+}
+
+
+OFTEST(dcmdata_readUntilTag_stopAtTag)
+{
+    DcmFileFormat fileformat;
+    createDataset(*fileformat.getDataset());
+    OFCHECK(fileformat.saveFile(temporaryFile1, EXS_LittleEndianExplicit).good());
+
+    // parsing stops before the patient's name, the meta header is read completely
+    DcmFileFormat result;
+    OFCHECK(result.loadFileUntilTag(temporaryFile1, EXS_Unknown, EGL_noChange, DCM_MaxReadLength,
+        ERM_autoDetect, DCM_PatientName).good());
+    checkDataset(*result.getDataset(), OFFalse, OFFalse, OFFalse);
+    OFCHECK(result.getMetaInfo()->tagExists(DCM_MediaStorageSOPInstanceUID));
+    OFCHECK(result.getMetaInfo()->tagExists(DCM_TransferSyntaxUID));
+
+    // stop at the pixel data
+    OFCHECK(result.loadFileUntilTag(temporaryFile1, EXS_Unknown, EGL_noChange, DCM_MaxReadLength,
+        ERM_autoDetect, DCM_PixelData).good());
+    checkDataset(*result.getDataset(), OFTrue, OFTrue, OFFalse);
+
+    // no tag given, i.e. read everything
+    OFCHECK(result.loadFileUntilTag(temporaryFile1).good());
+    checkDataset(*result.getDataset(), OFTrue, OFTrue, OFTrue);
+
+    // the same for a file without meta header
+    OFCHECK(fileformat.saveFile(temporaryFile1, EXS_LittleEndianImplicit, EET_UndefinedLength,
+        EGL_recalcGL, EPD_noChange, 0, 0, EWM_dataset).good());
+    DcmDataset dataset;
+    OFCHECK(dataset.loadFileUntilTag(temporaryFile1, EXS_LittleEndianImplicit, EGL_noChange,
+        DCM_MaxReadLength, DCM_PatientID).good());
+    checkDataset(dataset, OFTrue, OFFalse, OFFalse);
+    remove(temporaryFile1);
+}
+
+
+OFTEST(dcmdata_readUntilTag_tagAbsent)
+{
+    DcmFileFormat fileformat;
+    createDataset(*fileformat.getDataset());
+    OFCHECK(fileformat.saveFile(temporaryFile2, EXS_LittleEndianExplicit).good());
+
+    // Patient's Birth Date is not contained, parsing stops at the next larger tag
+    DcmFileFormat result;
+    OFCHECK(result.loadFileUntilTag(temporaryFile2, EXS_Unknown, EGL_noChange, DCM_MaxReadLength,
+        ERM_autoDetect, DCM_PatientBirthDate).good());
+    checkDataset(*result.getDataset(), OFTrue, OFTrue, OFFalse);
+
+    // a tag that is larger than any tag in the dataset
+    OFCHECK(result.loadFileUntilTag(temporaryFile2, EXS_Unknown, EGL_noChange, DCM_MaxReadLength,
+        ERM_autoDetect, DcmTagKey(0xfffa, 0xfffa)).good());
+    checkDataset(*result.getDataset(), OFTrue, OFTrue, OFTrue);
+
+    // a tag that is smaller than any tag in the dataset, i.e. the dataset is empty
+    OFCHECK(result.loadFileUntilTag(temporaryFile2, EXS_Unknown, EGL_noChange, DCM_MaxReadLength,
+        ERM_autoDetect, DCM_SpecificCharacterSet).good());
+    OFCHECK(result.getDataset()->isEmpty());
+    OFCHECK(result.getMetaInfo()->tagExists(DCM_MediaStorageSOPInstanceUID));
+    remove(temporaryFile2);
+}
+
+
+OFTEST(dcmdata_readUntilTag_tagInSequence)
+{
+    DcmDataset dataset;
+    createDataset(dataset);
+
+    // write the dataset to a memory buffer
+    OFVector<Uint8> buffer(65536);
+    DcmOutputBufferStream outStream(&buffer[0], buffer.size());
+    dataset.transferInit();
+    OFCHECK(dataset.write(outStream, EXS_LittleEndianExplicit, EET_UndefinedLength, NULL).good());
+    dataset.transferEnd();
+    outStream.flush();
+    void *data = NULL;
+    offile_off_t length = 0;
+    outStream.flushBuffer(data, length);
+
+    // the Referenced SOP Instance UID in the items does not stop parsing,
+    // only the next attribute on the main dataset level with a larger tag
+    DcmInputBufferStream inStream;
+    inStream.setBuffer(data, length);
+    inStream.setEos();
+    DcmDataset result;
+    result.transferInit();
+    OFCHECK(result.readUntilTag(inStream, EXS_LittleEndianExplicit, EGL_noChange,
+        DCM_MaxReadLength, DCM_ReferencedSOPInstanceUID).good());
+    result.transferEnd();
+    checkDataset(result, OFFalse, OFFalse, OFFalse);
+
+    // the sequence is read completely, including the attributes in the items
+    // whose tags are larger than the given one
+    DcmSequenceOfItems *sequence = NULL;
+    OFCHECK(result.findAndGetSequence(DCM_ReferencedImageSequence, sequence).good());
+    OFCHECK(sequence != NULL);
+    if (sequence != NULL)
+    {
+        OFCHECK_EQUAL(sequence->card(), NUMBER_OF_ITEMS);
+        for (unsigned long i = 0; i < sequence->card(); ++i)
+        {
+            DcmItem *item = sequence->getItem(i);
+            OFCHECK(item->tagExists(DCM_ReferencedSOPInstanceUID));
+            OFCHECK(item->tagExists(DCM_PatientID));
+        }
+    }
+}
@@ -0,0 +1,268 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the RLE encoder and decoder
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofcrc32.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcrleenc.h"
+#include "dcmtk/dcmdata/dcrledec.h"
+#include "dcmtk/dcmdata/dcerror.h"
+
+
+/* create a byte stream with literal runs and replicate runs of various lengths.
+ * The lengths are chosen around the limits of the PackBits scheme (128 bytes),
+ * the size of the internal literal buffer and the block size of the encoder.
+ */
+static void createData(OFVector<unsigned char> &data)
+{
+    const size_t runLengths[] = { 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 127, 128, 129, 130, 131,
+                                  255, 256, 257, 258, 1000, DcmRLEEncoder_BLOCKSIZE + 3 };
+    const size_t numberOfRuns = sizeof(runLengths) / sizeof(runLengths[0]);
+    // compute the total size first, OFVector::push_back() is slow for large vectors
+    size_t count = 0;
+    size_t i, j;
+    for (i = 0; i < numberOfRuns; ++i)
+        count += 2 * runLengths[i] + runLengths[numberOfRuns - 1 - i] + 1;
+    data.resize(count);
+    Uint32 seed = 4711;
+    size_t pos = 0;
+    for (i = 0; i < numberOfRuns; ++i)
+    {
+        // a literal run (pseudo-random bytes from a small alphabet, i.e. with short repetitions)
+        for (j = 0; j < runLengths[numberOfRuns - 1 - i]; ++j)
+        {
+            seed = seed * 1103515245 + 12345;
+            data[pos++] = OFstatic_cast(unsigned char, (seed >> 16) % 5);
+        }
+        // a replicate run that continues the last byte of the literal run
+        const unsigned char value = data[pos - 1];
+        for (j = 0; j < runLengths[i]; ++j)
+            data[pos++] = value;
+        // a replicate run with another value, followed by a single byte
+        for (j = 0; j < runLengths[i]; ++j)
+            data[pos++] = OFstatic_cast(unsigned char, 0x80 + i);
+        data[pos++] = OFstatic_cast(unsigned char, 0xff - i);
+    }
+}
+
+
+/* encode the given data with the given encoder, passing chunks of the given size */
+static void encodeData(DcmRLEEncoder &encoder,
+                       const OFVector<unsigned char> &data,
+                       const size_t chunkSize)
+{
+    size_t pos = 0;
+    while (pos < data.size())
+    {
+        const size_t count = (data.size() - pos < chunkSize) ? data.size() - pos : chunkSize;
+        encoder.add(&data[pos], count);
+        pos += count;
+    }
+    encoder.flush();
+}
+
+
+/* encode the given data byte by byte, as the previous implementation of add(buf, count) did */
+static void encodeDataBytewise(DcmRLEEncoder &encoder,
+                               const OFVector<unsigned char> &data)
+{
+    for (size_t i = 0; i < data.size(); ++i)
+        encoder.add(data[i]);
+    encoder.flush();
+}
+
+
+/* return the output of the given encoder */
+static void getOutput(const DcmRLEEncoder &encoder,
+                      OFVector<unsigned char> &output)
+{
+    output.resize(encoder.size());
+    if (!output.empty())
+        encoder.write(&output[0]);
+}
+
+
+/* compare two lists of bytes */
+static OFBool compareData(const OFVector<unsigned char> &data1,
+                          const OFVector<unsigned char> &data2)
+{
+    if (data1.size() != data2.size())
+        return OFFalse;
+    return data1.empty() || (memcmp(&data1[0], &data2[0], data1.size()) == 0);
+}
+
+
+/* encode the given bytes and compare the result with the expected output */
+static void checkKnownOutput(const unsigned char *data,
+                             const size_t count,
+                             const unsigned char *expected,
+                             const size_t expectedCount)
+{
+    OFVector<unsigned char> input(count);
+    for (size_t i = 0; i < count; ++i)
+        input[i] = data[i];
+    OFVector<unsigned char> output;
+    DcmRLEEncoder encoder(1);
+    encodeData(encoder, input, count);
+    getOutput(encoder, output);
+    OFCHECK_EQUAL(output.size(), expectedCount);
+    if (output.size() == expectedCount)
+        OFCHECK(memcmp(&output[0], expected, expectedCount) == 0);
+}
+
+
+OFTEST(dcmdata_rleEncoderBytewise)
+{
+    OFVector<unsigned char> data;
+    createData(data);
+
+    // reference output, size and CRC are the values of the previous implementation
+    DcmRLEEncoder reference(1);
+    encodeDataBytewise(reference, data);
+    OFCHECK(!reference.fail());
+    OFVector<unsigned char> expected;
+    getOutput(reference, expected);
+    OFCRC32 crc;
+    crc.addBlock(&expected[0], OFstatic_cast(unsigned long, expected.size()));
+    OFCHECK_EQUAL(expected.size(), 19652);
+    OFCHECK_EQUAL(crc.getCRC32(), 0x01a0dcb4);
+
+    // the runs may span several calls of add(), e.g. if rows are passed
+    const size_t chunkSizes[] = { 1, 2, 3, 7, 8, 9, 129, 512, 4099, data.size() };
+    OFVector<unsigned char> output;
+    for (size_t i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++i)
+    {
+        DcmRLEEncoder encoder(1);
+        encodeData(encoder, data, chunkSizes[i]);
+        OFCHECK(!encoder.fail());
+        getOutput(encoder, output);
+        OFCHECK(compareData(output, expected));
+    }
+
+    // mixing both methods of adding bytes
+    DcmRLEEncoder mixed(1);
+    for (size_t j = 0; j < data.size(); )
+    {
+        if (j % 3 == 0)
+            mixed.add(data[j++]);
+        else
+        {
+            const size_t count = (data.size() - j < 200) ? data.size() - j : 200;
+            mixed.add(&data[j], count);
+            j += count;
+        }
+    }
+    mixed.flush();
+    getOutput(mixed, output);
+    OFCHECK(compareData(output, expected));
+}
+
+
+OFTEST(dcmdata_rleEncoderKnownOutput)
+{
+    // a replicate run followed by a literal run, padded to an even number of bytes
+    const unsigned char data1[] = { 1, 1, 1, 1, 2, 3 };
+    const unsigned char expected1[] = { 0xfd, 1, 0x01, 2, 3, 0 };
+    checkKnownOutput(data1, sizeof(data1), expected1, sizeof(expected1));
+
+    // two identical bytes are stored as part of a literal run
+    const unsigned char data2[] = { 7, 7, 8 };
+    const unsigned char expected2[] = { 0x02, 7, 7, 8 };
+    checkKnownOutput(data2, sizeof(data2), expected2, sizeof(expected2));
+
+    // replicate runs are limited to 128 bytes
+    unsigned char data3[130];
+    memset(data3, 0x55, sizeof(data3));
+    const unsigned char expected3[] = { 0x81, 0x55, 0xff, 0x55 };
+    checkKnownOutput(data3, sizeof(data3), expected3, sizeof(expected3));
+
+    // literal runs are limited to 128 bytes as well
+    unsigned char data4[130];
+    unsigned char expected4[134];
+    expected4[0] = 0x7f;
+    expected4[129] = 0x01;
+    for (size_t i = 0; i < sizeof(data4); ++i)
+    {
+        data4[i] = OFstatic_cast(unsigned char, i);
+        expected4[(i < 128) ? i + 1 : i + 2] = OFstatic_cast(unsigned char, i);
+    }
+    expected4[132] = 0;
+    checkKnownOutput(data4, sizeof(data4), expected4, 132);
+
+    // a literal run is flushed before a replicate run
+    const unsigned char data5[] = { 9, 4, 4, 4, 4, 4 };
+    const unsigned char expected5[] = { 0x00, 9, 0xfc, 4 };
+    checkKnownOutput(data5, sizeof(data5), expected5, sizeof(expected5));
+}
+
+
+OFTEST(dcmdata_rleRoundTrip)
+{
+    OFVector<unsigned char> data;
+    createData(data);
+    DcmRLEEncoder encoder(1);
+    encodeData(encoder, data, 777);
+    OFVector<unsigned char> compressed;
+    getOutput(encoder, compressed);
+
+    // decompress in chunks of different sizes, i.e. with suspended runs
+    const size_t chunkSizes[] = { 1, 2, 3, 129, 1000, compressed.size() };
+    for (size_t i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++i)
+    {
+        DcmRLEDecoder decoder(data.size());
+        size_t pos = 0;
+        while (pos < compressed.size())
+        {
+            const size_t count = (compressed.size() - pos < chunkSizes[i]) ? compressed.size() - pos : chunkSizes[i];
+            OFCondition result = decoder.decompress(&compressed[pos], count);
+            OFCHECK(result.good() || (result == EC_StreamNotifyClient));
+            pos += count;
+        }
+        OFCHECK(!decoder.fail());
+        OFCHECK_EQUAL(decoder.size(), data.size());
+        if (decoder.size() == data.size())
+            OFCHECK(memcmp(decoder.getOutputBuffer(), &data[0], data.size()) == 0);
+    }
+
+    // decompress into an interleaved buffer (every third byte)
+    OFVector<unsigned char> interleaved(3 * data.size());
+    DcmRLEDecoder strided(&interleaved[1], data.size(), 3);
+    OFCondition result = strided.decompress(&compressed[0], compressed.size());
+    // the pad byte at the end of the compressed data looks like the start of a literal run
+    OFCHECK(result.good() || (result == EC_StreamNotifyClient));
+    OFCHECK(!strided.fail());
+    OFCHECK_EQUAL(strided.size(), data.size());
+    size_t errors = 0;
+    for (size_t j = 0; j < data.size(); ++j)
+    {
+        if (interleaved[3 * j + 1] != data[j])
+            ++errors;
+    }
+    OFCHECK_EQUAL(errors, 0);
+
+    // the output buffer is too small
+    DcmRLEDecoder tooSmall(data.size() - 1);
+    OFCHECK(tooSmall.decompress(&compressed[0], compressed.size()) == EC_CorruptedData);
+    OFCHECK(tooSmall.fail());
+}
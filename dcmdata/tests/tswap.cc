@@ -0,0 +1,84 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the byte order functions
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcswap.h"
+
+
+#define BUFFER_SIZE 64
+
+
+/* swap the given number of bytes starting at the given offset and compare
+ * the result with a byte-wise swap of the same data
+ */
+static OFBool checkSwap(const size_t offset, const Uint32 length, const size_t valWidth)
+{
+    Uint8 buffer[BUFFER_SIZE];
+    Uint8 expected[BUFFER_SIZE];
+    for (size_t i = 0; i < BUFFER_SIZE; ++i)
+        buffer[i] = expected[i] = OFstatic_cast(Uint8, i + 1);
+    /* only complete values are swapped, a trailing partial value remains unchanged */
+    for (size_t start = offset; start + valWidth <= offset + length; start += valWidth)
+    {
+        for (size_t i = 0; i < valWidth; ++i)
+            expected[start + i] = OFstatic_cast(Uint8, start + valWidth - i);
+    }
+    swapBytes(buffer + offset, length, valWidth);
+    for (size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        if (buffer[i] != expected[i])
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+
+OFTEST(dcmdata_swapBytes)
+{
+    /* check all value widths with aligned and unaligned data of various lengths */
+    const size_t widths[] = { 2, 4, 8 };
+    for (size_t w = 0; w < 3; ++w)
+    {
+        for (size_t offset = 0; offset < 8; ++offset)
+        {
+            for (Uint32 length = 0; length <= 48; ++length)
+                OFCHECK(checkSwap(offset, length, widths[w]));
+        }
+    }
+    /* values of width 1 are never swapped */
+    OFCHECK(checkSwap(0, 16, 1));
+
+    /* swapIfNecessary() only swaps if the byte orders differ */
+    Uint16 words[4] = { 0x0102, 0x0304, 0x0506, 0x0708 };
+    OFCHECK(swapIfNecessary(EBO_LittleEndian, EBO_LittleEndian, words, sizeof(words), sizeof(Uint16)).good());
+    OFCHECK_EQUAL(words[0], 0x0102);
+    OFCHECK(swapIfNecessary(EBO_BigEndian, EBO_LittleEndian, words, sizeof(words), sizeof(Uint16)).good());
+    OFCHECK_EQUAL(words[0], 0x0201);
+    OFCHECK_EQUAL(words[3], 0x0807);
+    OFCHECK(swapIfNecessary(EBO_unknown, EBO_LittleEndian, words, sizeof(words), sizeof(Uint16)).bad());
+    Uint32 dwords[2] = { 0x01020304, 0x05060708 };
+    OFCHECK(swapIfNecessary(EBO_BigEndian, EBO_LittleEndian, dwords, sizeof(dwords), sizeof(Uint32)).good());
+    OFCHECK_EQUAL(dwords[0], 0x04030201);
+    OFCHECK_EQUAL(dwords[1], 0x08070605);
+}
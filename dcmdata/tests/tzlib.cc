@@ -0,0 +1,249 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmdata
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the parallel compression of deflated streams
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmdata/dcostrmb.h"
+#include "dcmtk/dcmdata/dcistrmb.h"
+#include "dcmtk/dcmdata/dcostrmz.h"   /* for dcmZlibCompressionThreads */
+#include "dcmtk/ofstd/ofvector.h"
+
+#define INCLUDE_CSTDIO
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+#ifdef WITH_ZLIB
+
+// temporary files which will be used
+static const char *temporaryFile1 = "zlib1.tmp";
+static const char *temporaryFile2 = "zlib2.tmp";
+
+// size of the pixel data, more than a few blocks of 128 KB
+#define PIXEL_DATA_SIZE 1000000
+
+// size of the buffer used for simulating network transmission
+#define NETWORK_BUFFER_SIZE 16384
+
+// number of sequence items, enough for a few blocks of 128 KB
+#define NUMBER_OF_ITEMS 40000
+
+
+/* create a dataset with compressible, but not too repetitive pixel data */
+static void createDataset(DcmDataset &dataset,
+                          const unsigned long pixelDataSize)
+{
+    dataset.putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.0.3");
+    dataset.putAndInsertString(DCM_PatientName, "Doe^John");
+    Uint8 *pixels = new Uint8[pixelDataSize];
+    for (unsigned long i = 0; i < pixelDataSize; ++i)
+        pixels[i] = OFstatic_cast(Uint8, (i * i) >> 11);
+    dataset.putAndInsertUint8Array(DCM_PixelData, pixels, pixelDataSize);
+    delete[] pixels;
+}
+
+
+/* create a dataset with many small sequence items, i.e. many short writes */
+static void createSequenceDataset(DcmDataset &dataset)
+{
+    char buf[64];
+    dataset.putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.0.4");
+    for (unsigned long i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        DcmItem *item = NULL;
+        if (dataset.findOrCreateSequenceItem(DCM_ReferencedImageSequence, item, -2 /* append */).good())
+        {
+            // vary the length of the items so that the batches end at different positions
+            sprintf(buf, "1.2.276.0.7230010.3.1.4.%lu", i * i);
+            item->putAndInsertString(DCM_ReferencedSOPInstanceUID, buf);
+            if (i % 3 == 0)
+                item->putAndInsertUint16(DCM_ReferencedFrameNumber, OFstatic_cast(Uint16, i));
+        }
+    }
+}
+
+
+/* compare two datasets by means of their printed content */
+static OFBool compareContent(DcmDataset &dataset1,
+                             DcmDataset &dataset2)
+{
+    OFOStringStream oss1, oss2;
+    dataset1.print(oss1);
+    dataset2.print(oss2);
+    oss1 << OFStringStream_ends;
+    oss2 << OFStringStream_ends;
+    OFSTRINGSTREAM_GETOFSTRING(oss1, str1)
+    OFSTRINGSTREAM_GETOFSTRING(oss2, str2)
+    return !str1.empty() && (str1 == str2);
+}
+
+
+/* compare two datasets by means of their printed content and pixel data */
+static OFBool compareDatasets(DcmDataset &dataset1,
+                              DcmDataset &dataset2)
+{
+    const Uint8 *pixels1 = NULL;
+    const Uint8 *pixels2 = NULL;
+    unsigned long count1 = 0;
+    unsigned long count2 = 0;
+    if (!compareContent(dataset1, dataset2) ||
+        dataset1.findAndGetUint8Array(DCM_PixelData, pixels1, &count1).bad() ||
+        dataset2.findAndGetUint8Array(DCM_PixelData, pixels2, &count2).bad())
+    {
+        return OFFalse;
+    }
+    return (count1 == count2) && (memcmp(pixels1, pixels2, count1) == 0);
+}
+
+
+/* compare the content of two files */
+static OFBool filesDiffer(const char *filename1,
+                          const char *filename2)
+{
+    OFBool result = OFFalse;
+    FILE *file1 = fopen(filename1, "rb");
+    FILE *file2 = fopen(filename2, "rb");
+    if ((file1 != NULL) && (file2 != NULL))
+    {
+        int c1, c2;
+        do
+        {
+            c1 = fgetc(file1);
+            c2 = fgetc(file2);
+        } while ((c1 == c2) && (c1 != EOF));
+        result = (c1 != c2);
+    }
+    if (file1 != NULL) fclose(file1);
+    if (file2 != NULL) fclose(file2);
+    return result;
+}
+
+
+/* write the dataset in small pieces like the network code does, and read it again */
+static OFBool writeAndReadBuffer(DcmDataset &dataset,
+                                 DcmDataset &result)
+{
+    OFVector<Uint8> stream;
+    Uint8 buffer[NETWORK_BUFFER_SIZE];
+    DcmOutputBufferStream outStream(buffer, sizeof(buffer));
+    OFCondition cond = EC_Normal;
+    OFBool written = OFFalse;
+    OFBool last = OFFalse;
+    dataset.transferInit();
+    while (!last)
+    {
+        if (!written)
+        {
+            cond = dataset.write(outStream, EXS_DeflatedLittleEndianExplicit, EET_ExplicitLength, NULL);
+            if (cond.good())
+                written = OFTrue;
+            else if (cond != EC_StreamNotifyClient)
+                break;
+        }
+        if (written)
+            outStream.flush();
+        void *data = NULL;
+        offile_off_t length = 0;
+        outStream.flushBuffer(data, length);
+        last = written && outStream.isFlushed();
+        for (offile_off_t i = 0; i < length; ++i)
+            stream.push_back(OFstatic_cast(Uint8 *, data)[i]);
+    }
+    dataset.transferEnd();
+    if (!written || stream.empty())
+        return OFFalse;
+
+    DcmInputBufferStream inStream;
+    inStream.setBuffer(&stream[0], stream.size());
+    inStream.setEos();
+    result.clear();
+    result.transferInit();
+    cond = result.read(inStream, EXS_DeflatedLittleEndianExplicit);
+    result.transferEnd();
+    return cond.good();
+}
+
+#endif
+
+
+OFTEST(dcmdata_zlibParallelDeflate)
+{
+#ifdef WITH_ZLIB
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    createDataset(*dataset, PIXEL_DATA_SIZE);
+
+    // write the file with a single zlib stream and with parallel compression
+    const Uint32 oldThreads = dcmZlibCompressionThreads.get();
+    OFCHECK(fileformat.saveFile(temporaryFile1, EXS_DeflatedLittleEndianExplicit).good());
+    dcmZlibCompressionThreads.set(4);
+    OFCHECK(fileformat.saveFile(temporaryFile2, EXS_DeflatedLittleEndianExplicit).good());
+    // the compressed streams are different, but both have to result in the same dataset
+    OFCHECK(filesDiffer(temporaryFile1, temporaryFile2));
+    DcmFileFormat fileformat1, fileformat2;
+    OFCHECK(fileformat1.loadFile(temporaryFile1).good());
+    OFCHECK(fileformat2.loadFile(temporaryFile2).good());
+    OFCHECK(compareDatasets(*dataset, *fileformat1.getDataset()));
+    OFCHECK(compareDatasets(*dataset, *fileformat2.getDataset()));
+
+    // the consumer accepts only a small amount of data at a time
+    DcmDataset result;
+    OFCHECK(writeAndReadBuffer(*dataset, result));
+    OFCHECK(compareDatasets(*dataset, result));
+
+    // a dataset that is smaller than a single block
+    DcmDataset smallDataset;
+    createDataset(smallDataset, 1000);
+    OFCHECK(writeAndReadBuffer(smallDataset, result));
+    OFCHECK(compareDatasets(smallDataset, result));
+
+    dcmZlibCompressionThreads.set(oldThreads);
+    remove(temporaryFile1);
+    remove(temporaryFile2);
+#endif
+}
+
+
+OFTEST(dcmdata_zlibParallelDeflateSmallItems)
+{
+#ifdef WITH_ZLIB
+    DcmDataset dataset;
+    createSequenceDataset(dataset);
+
+    // many tag and length headers, some of them close to the end of a batch
+    const Uint32 oldThreads = dcmZlibCompressionThreads.get();
+    for (Uint32 threads = 2; threads <= 4; ++threads)
+    {
+        dcmZlibCompressionThreads.set(threads);
+        DcmDataset result;
+        OFCHECK(writeAndReadBuffer(dataset, result));
+        OFCHECK(compareContent(dataset, result));
+    }
+    dcmZlibCompressionThreads.set(oldThreads);
+#endif
+}
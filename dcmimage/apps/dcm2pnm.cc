@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2014, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -47,6 +47,7 @@
 
 #ifdef BUILD_DCM2PNM_AS_DCMJ2PNM
 #include "dcmtk/dcmjpeg/djdecode.h"      /* for dcmjpeg decoders */
+#include "dcmtk/dcmjpeg/djrpres.h"       /* for class DJ_RPReducedResolution */
 #include "dcmtk/dcmjpeg/dipijpeg.h"      /* for dcmimage JPEG plugin */
 #endif
 
@@ -149,6 +150,7 @@ int main(int argc, char *argv[])
                         /* 1 = X-factor, 2 = Y-factor, 3=X-size, 4=Y-size */
     OFCmdFloat          opt_scale_factor = 1.0;
     OFCmdUnsignedInt    opt_scale_size = 1;
+    OFCmdUnsignedInt    opt_threads = 1;                  /* default: single-threaded scaling */
     int                 opt_windowType = 0;               /* default: no windowing */
                         /* 1=Wi, 2=Wl, 3=Wm, 4=Wh, 5=Ww, 6=Wn, 7=Wr */
     OFCmdUnsignedInt    opt_windowParameter = 0;
@@ -188,6 +190,7 @@ int main(int argc, char *argv[])
     OFCmdUnsignedInt    opt_quality = 90;                 /* default: 90% JPEG quality */
     E_SubSampling       opt_sampling = ESS_422;           /* default: 4:2:2 sub-sampling */
     E_DecompressionColorSpaceConversion opt_decompCSconversion = EDC_photometricInterpretation;
+    OFBool              opt_reducedResolution = OFFalse;  /* default: decompress with full resolution */
 #endif
 
     int                 opt_Overlay[16];
@@ -257,7 +260,7 @@ int main(int argc, char *argv[])
       cmd.addOption("--recognize-aspect",   "+a",      "recognize pixel aspect ratio (default)");
       cmd.addOption("--ignore-aspect",      "-a",      "ignore pixel aspect ratio when scaling");
       cmd.addOption("--interpolate",        "+i",   1, "[n]umber of algorithm: integer",
-                                                       "use interpolation when scaling (1..4, def: 1)");
+                                                       "use interpolation when scaling (1..5, def: 1)");
       cmd.addOption("--no-interpolation",   "-i",      "no interpolation when scaling");
       cmd.addOption("--no-scaling",         "-S",      "no scaling, ignore pixel aspect ratio (default)");
       cmd.addOption("--scale-x-factor",     "+Sxf", 1, "[f]actor: float",
@@ -268,6 +271,13 @@ int main(int argc, char *argv[])
                                                        "scale x axis to n pixels, auto-compute y axis");
       cmd.addOption("--scale-y-size",       "+Syv", 1, "[n]umber: integer",
                                                        "scale y axis to n pixels, auto-compute x axis");
+#ifdef BUILD_DCM2PNM_AS_DCMJ2PNM
+      cmd.addOption("--reduced-resolution", "+Sr",     "decompress lossy JPEG with reduced resolution\nwhen scaling to a smaller size (+Sxv, +Syv)");
+#endif
+#ifdef WITH_THREADS
+      cmd.addOption("--threads",            "+mt",  1, "[n]umber: integer (1..64, default: 1)",
+                                                       "use n threads for scaling (if supported)");
+#endif
 #ifdef BUILD_DCM2PNM_AS_DCMJ2PNM
      cmd.addSubGroup("color space conversion (compressed images only):");
       cmd.addOption("--conv-photometric",   "+cp",     "convert if YCbCr photometric interpr. (default)");
@@ -571,7 +581,7 @@ int main(int argc, char *argv[])
 
         cmd.beginOptionBlock();
         if (cmd.findOption("--interpolate"))
-            app.checkValue(cmd.getValueAndCheckMinMax(opt_useInterpolation, 1, 4));
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_useInterpolation, 1, 5));
         if (cmd.findOption("--no-interpolation"))
             opt_useInterpolation = 0;
         cmd.endOptionBlock();
@@ -600,6 +610,17 @@ int main(int argc, char *argv[])
             app.checkValue(cmd.getValueAndCheckMin(opt_scale_size, 1));
         }
         cmd.endOptionBlock();
+#ifdef BUILD_DCM2PNM_AS_DCMJ2PNM
+        if (cmd.findOption("--reduced-resolution"))
+        {
+            app.checkDependence("--reduced-resolution", "--scale-x-size or --scale-y-size", (opt_scaleType == 3) || (opt_scaleType == 4));
+            opt_reducedResolution = OFTrue;
+        }
+#endif
+#ifdef WITH_THREADS
+        if (cmd.findOption("--threads"))
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 64));
+#endif
 
         /* image processing options: color space conversion */
 
@@ -924,6 +945,34 @@ int main(int argc, char *argv[])
     DcmDataset *dataset = dfile->getDataset();
     E_TransferSyntax xfer = dataset->getOriginalXfer();
 
+#ifdef BUILD_DCM2PNM_AS_DCMJ2PNM
+    Uint16 reducedResolutionSize = 0;
+    if (opt_reducedResolution && !opt_useClip)
+    {
+        /* the scaled width/height has to be reached without magnifying the decompressed image */
+        Uint16 rows = 0;
+        Uint16 columns = 0;
+        if (dataset->findAndGetUint16(DCM_Rows, rows).good() && dataset->findAndGetUint16(DCM_Columns, columns).good() &&
+            (rows > 0) && (columns > 0))
+        {
+            const unsigned long maxSize = (rows > columns) ? rows : columns;
+            const unsigned long size = (opt_scaleType == 3) ? columns : rows;
+            const unsigned long minSize = (opt_scale_size * maxSize + size - 1) / size;
+            if (minSize < maxSize)
+                reducedResolutionSize = OFstatic_cast(Uint16, minSize);
+        }
+    }
+    if ((reducedResolutionSize > 0) && DcmXfer(xfer).isEncapsulated())
+    {
+        // decompress the complete pixel data with reduced resolution before creating the image
+        DJ_RPReducedResolution rp_reduced(reducedResolutionSize);
+        if (dataset->chooseRepresentation(EXS_LittleEndianExplicit, &rp_reduced).good())
+            opt_compatibilityMode |= CIF_DecompressCompletePixelData;
+        else
+            OFLOG_WARN(dcm2pnmLogger, "cannot decompress pixel data with reduced resolution, using full resolution");
+    }
+#endif
+
     Sint32 frameCount;
     if (dataset->findAndGetSint32(DCM_NumberOfFrames, frameCount).bad())
         frameCount = 1;
@@ -938,7 +987,8 @@ int main(int argc, char *argv[])
         opt_compatibilityMode |= CIF_UsePartialAccessToPixelData;
     }
 
-    DicomImage *di = new DicomImage(dfile, xfer, opt_compatibilityMode, opt_frame - 1, opt_frameCount);
+    DicomImage *di = new DicomImage(dfile, xfer, opt_compatibilityMode, opt_frame - 1, opt_frameCount,
+        OFstatic_cast(Uint32, opt_threads));
     if (di == NULL)
     {
         OFLOG_FATAL(dcm2pnmLogger, "Out of memory");
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2001-2014, OFFIS e.V.
+ *  Copyright (C) 2001-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -94,6 +94,8 @@ int main(int argc, char *argv[])
     OFBool              opt_entries_word = OFFalse;
     OFBool              opt_palette_fs = OFFalse;
     OFCmdUnsignedInt    opt_palette_col = 256;
+    OFCmdUnsignedInt    opt_kmeans = 0;                   /* default: no k-means refinement */
+    OFCmdUnsignedInt    opt_threads = 1;                  /* default: single-threaded mapping */
 
     DcmLargestDimensionType opt_largeType = DcmLargestDimensionType_default;
     DcmRepresentativeColorType opt_repType = DcmRepresentativeColorType_default;
@@ -172,6 +174,12 @@ int main(int argc, char *argv[])
       cmd.addOption("--floyd-steinberg",     "+pf",    "use Floyd-Steinberg error diffusion");
       cmd.addOption("--colors",              "+pc", 1, "number of colors: 2..65536 (default 256)",
                                                        "number of colors to quantize to");
+      cmd.addOption("--kmeans",              "+pk", 1, "[n]umber: integer (default: 0)",
+                                                       "refine color palette by n iterations of\nk-means clustering");
+#ifdef WITH_THREADS
+      cmd.addOption("--threads",             "+mt", 1, "[n]umber: integer (1..64, default: 1)",
+                                                       "use n threads for color mapping");
+#endif
 
      cmd.addSubGroup("SOP Class UID:");
       cmd.addOption("--class-default",       "+cd",    "keep SOP Class UID (default)");
@@ -302,6 +310,11 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--lut-entries-word")) opt_entries_word = OFTrue;
       if (cmd.findOption("--floyd-steinberg")) opt_palette_fs = OFTrue;
       if (cmd.findOption("--colors")) cmd.getValueAndCheckMinMax(opt_palette_col, 2, 65536);
+      if (cmd.findOption("--kmeans")) app.checkValue(cmd.getValueAndCheckMinMax(opt_kmeans, 0, 1000));
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+          app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 64));
+#endif
 
       cmd.beginOptionBlock();
       if (cmd.findOption("--mc-dimension-rgb")) opt_largeType = DcmLargestDimensionType_default;
@@ -438,7 +451,7 @@ int main(int argc, char *argv[])
     OFLOG_INFO(dcmquantLogger, "preparing pixel data.");
 
     // create DicomImage object
-    DicomImage di(dataset, opt_oxfer, opt_compatibilityMode, opt_frame - 1, opt_frameCount);
+    DicomImage di(dataset, opt_oxfer, opt_compatibilityMode, opt_frame - 1, opt_frameCount, OFstatic_cast(Uint32, opt_threads));
     if (di.getStatus() != EIS_Normal)
     {
         OFLOG_FATAL(dcmquantLogger, DicomImage::getString(di.getStatus()));
@@ -456,7 +469,8 @@ int main(int argc, char *argv[])
     // create palette color image
     error = DcmQuant::createPaletteColorImage(
       di, *dataset, opt_palette_ow, opt_entries_word, opt_palette_fs, opt_palette_col,
-      derivationDescription, opt_largeType, opt_repType);
+      derivationDescription, opt_largeType, opt_repType, OFstatic_cast(Uint32, opt_kmeans),
+      OFstatic_cast(Uint32, opt_threads));
 
     // update image type
     if (error.good()) error = DcmCodec::updateImageType(dataset);
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -102,6 +102,7 @@ int main(int argc, char *argv[])
                                                        /* 1 = X-factor, 2 = Y-factor, 3=X-size, 4=Y-size */
     OFCmdFloat opt_scale_factor = 1.0;
     OFCmdUnsignedInt opt_scale_size = 1;
+    OFCmdUnsignedInt opt_threads = 1;                  /* default: single-threaded scaling */
 
     OFBool           opt_useClip = OFFalse;            /* default: don't clip */
     OFCmdSignedInt   opt_left = 0, opt_top = 0;        /* clip region (origin) */
@@ -147,7 +148,7 @@ int main(int argc, char *argv[])
       cmd.addOption("--recognize-aspect",    "+a",      "recognize pixel aspect ratio (default)");
       cmd.addOption("--ignore-aspect",       "-a",      "ignore pixel aspect ratio when scaling");
       cmd.addOption("--interpolate",         "+i",   1, "[n]umber of algorithm: integer",
-                                                        "use interpolation when scaling (1..4, def: 1)");
+                                                        "use interpolation when scaling (1..5, def: 1)");
       cmd.addOption("--no-interpolation",    "-i",      "no interpolation when scaling");
       cmd.addOption("--no-scaling",          "-S",      "no scaling, ignore pixel aspect ratio (default)");
       cmd.addOption("--scale-x-factor",      "+Sxf", 1, "[f]actor: float",
@@ -158,6 +159,10 @@ int main(int argc, char *argv[])
                                                         "scale x axis to n pixels, auto-compute y axis");
       cmd.addOption("--scale-y-size",        "+Syv", 1, "[n]umber: integer",
                                                         "scale y axis to n pixels, auto-compute x axis");
+#ifdef WITH_THREADS
+      cmd.addOption("--threads",             "+mt",  1, "[n]umber: integer (1..64, default: 1)",
+                                                        "use n threads for scaling (if supported)");
+#endif
      cmd.addSubGroup("other transformations:");
       cmd.addOption("--clip-region",         "+C",   4, "[l]eft [t]op [w]idth [h]eight: integer",
                                                         "clip rectangular image region (l, t, w, h)");
@@ -283,7 +288,7 @@ int main(int argc, char *argv[])
 
       cmd.beginOptionBlock();
       if (cmd.findOption("--interpolate"))
-          app.checkValue(cmd.getValueAndCheckMinMax(opt_useInterpolation, 1, 4));
+          app.checkValue(cmd.getValueAndCheckMinMax(opt_useInterpolation, 1, 5));
       if (cmd.findOption("--no-interpolation"))
           opt_useInterpolation = 0;
       cmd.endOptionBlock();
@@ -312,6 +317,10 @@ int main(int argc, char *argv[])
           app.checkValue(cmd.getValueAndCheckMin(opt_scale_size, 1));
       }
       cmd.endOptionBlock();
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+          app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 64));
+#endif
 
       /* image processing options: other transformations */
 
@@ -459,7 +468,7 @@ int main(int argc, char *argv[])
 
     const unsigned long flags = (opt_scaleType > 0) ? CIF_MayDetachPixelData : 0;
     // create DicomImage object
-    DicomImage *di = new DicomImage(dataset, opt_oxfer, flags);
+    DicomImage *di = new DicomImage(dataset, opt_oxfer, flags, 0, 0, OFstatic_cast(Uint32, opt_threads));
     if (di == NULL)
     {
         OFLOG_FATAL(dcmscaleLogger, "memory exhausted");
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2014, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -28,6 +28,8 @@
 
 #include "dcmtk/dcmimage/dicopx.h"
 #include "dcmtk/dcmimgle/dipxrept.h"
+#include "dcmtk/dcmimgle/didocu.h"
+#include "dcmtk/dcmdata/dcparfrm.h"
 
 
 /********************************************************************/
@@ -87,6 +89,14 @@ inline Uint32 removeSign(const Sint32 value, const Uint32 mask)
 }
 
 
+/*---------------------*
+ *  macro definitions  *
+ *---------------------*/
+
+// number of pixels (or pixel pairs) converted at a time by the color conversion classes
+#define CONVERT_BAND_SIZE 16384
+
+
 /*---------------------*
  *  class declaration  *
  *---------------------*/
@@ -598,4 +608,215 @@ class DiColorPixelTemplate
 };
 
 
+/** Abstract template class to convert the input pixel data (three samples per pixel) to the
+ *  intermediate representation, i.e. three separate color planes. The pixels are split into
+ *  bands of CONVERT_BAND_SIZE pixels, which are processed by multiple threads if requested.
+ *  Both color-by-pixel and color-by-plane input is supported.
+ */
+template<class T1, class T2>
+class DiColorConvertTemplate
+  : public DcmParallelFrameProcessor
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  pixel      pointer to input pixel data
+     *  @param  data       array of pointers to the three output planes
+     *  @param  count      number of pixels to be converted
+     *  @param  planeSize  number of pixels in a plane (only used for color-by-plane)
+     *  @param  planar     flag indicating whether input data is stored color-by-plane
+     */
+    DiColorConvertTemplate(const T1 *pixel,
+                           T2 *data[3],
+                           const unsigned long count,
+                           const unsigned long planeSize,
+                           const int planar)
+      : DcmParallelFrameProcessor(OFstatic_cast(Uint32, (count + CONVERT_BAND_SIZE - 1) / CONVERT_BAND_SIZE)),
+        Pixel(pixel),
+        Count(count),
+        PlaneSize(planeSize),
+        Planar(planar)
+    {
+        Data[0] = data[0];
+        Data[1] = data[1];
+        Data[2] = data[2];
+    }
+
+    /** destructor
+     */
+    virtual ~DiColorConvertTemplate()
+    {
+    }
+
+    /** convert all pixels
+     *
+     ** @param  threads  maximum number of threads to be used
+     */
+    void convertData(const Uint32 threads)
+    {
+        processAllFrames(threads);
+    }
+
+
+ protected:
+
+    /** convert a band of CONVERT_BAND_SIZE pixels.
+     *  Called by processAllFrames(), possibly by multiple threads at the same time.
+     *
+     ** @param  frameNo   index of the band to be converted
+     *  @param  threadNo  index of the calling thread (not used)
+     *
+     ** @return always EC_Normal
+     */
+    virtual OFCondition processFrame(Uint32 frameNo,
+                                     Uint32 /* threadNo */)
+    {
+        const unsigned long first = OFstatic_cast(unsigned long, frameNo) * CONVERT_BAND_SIZE;
+        process(first, (first + CONVERT_BAND_SIZE < Count) ? first + CONVERT_BAND_SIZE : Count);
+        return EC_Normal;
+    }
+
+    /** convert the given range of pixels.
+     *  The range is split into parts that do not cross the frame boundaries (color-by-plane).
+     *
+     ** @param  first  index of the first pixel to be converted
+     *  @param  last   index of the pixel behind the last one to be converted
+     */
+    virtual void process(const unsigned long first,
+                         const unsigned long last)
+    {
+        if (Planar && (PlaneSize > 0))
+        {
+            register unsigned long i = first;
+            while (i < last)
+            {
+                const unsigned long start = (i / PlaneSize) * PlaneSize;
+                /* the last frame might be incomplete */
+                const unsigned long size = (Count - start < PlaneSize) ? Count - start : PlaneSize;
+                const unsigned long end = (start + size < last) ? start + size : last;
+                const T1 *p = Pixel + 3 * start + (i - start);
+                convertRange(p, p + size, p + 2 * size, 1, i, end);
+                i = end;
+            }
+        } else {
+            const T1 *p = Pixel + 3 * first;
+            convertRange(p, p + 1, p + 2, 3, first, last);
+        }
+    }
+
+    /** convert the given range of pixels (abstract)
+     *
+     ** @param  p0      pointer to the first sample of the first color component
+     *  @param  p1      pointer to the first sample of the second color component
+     *  @param  p2      pointer to the first sample of the third color component
+     *  @param  stride  distance between two samples of the same color component
+     *  @param  first   index of the first pixel to be converted (output planes)
+     *  @param  last    index of the pixel behind the last one to be converted
+     */
+    virtual void convertRange(const T1 *p0,
+                              const T1 *p1,
+                              const T1 *p2,
+                              const unsigned long stride,
+                              const unsigned long first,
+                              const unsigned long last) = 0;
+
+    /// pointer to input pixel data
+    const T1 *Pixel;
+    /// pointers to the three output planes
+    T2 *Data[3];
+    /// number of pixels to be converted
+    const unsigned long Count;
+    /// number of pixels in a plane
+    const unsigned long PlaneSize;
+    /// flag indicating whether input data is stored color-by-plane
+    const int Planar;
+
+ private:
+
+ // --- declarations to avoid compiler warnings
+
+    DiColorConvertTemplate(const DiColorConvertTemplate<T1, T2> &);
+    DiColorConvertTemplate<T1, T2> &operator=(const DiColorConvertTemplate<T1, T2> &);
+};
+
+
+/** Template class to separate the color planes of the input pixel data without changing
+ *  the color model (apart from removing the sign of the samples)
+ */
+template<class T1, class T2>
+class DiColorSeparateTemplate
+  : public DiColorConvertTemplate<T1, T2>
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  pixel      pointer to input pixel data
+     *  @param  data       array of pointers to the three output planes
+     *  @param  count      number of pixels to be converted
+     *  @param  planeSize  number of pixels in a plane (only used for color-by-plane)
+     *  @param  planar     flag indicating whether input data is stored color-by-plane
+     *  @param  offset     offset used to remove the sign of the samples
+     */
+    DiColorSeparateTemplate(const T1 *pixel,
+                            T2 *data[3],
+                            const unsigned long count,
+                            const unsigned long planeSize,
+                            const int planar,
+                            const T1 offset)
+      : DiColorConvertTemplate<T1, T2>(pixel, data, count, planeSize, planar),
+        Offset(offset)
+    {
+    }
+
+    /** destructor
+     */
+    virtual ~DiColorSeparateTemplate()
+    {
+    }
+
+
+ protected:
+
+    /** copy the given range of pixels to the output planes
+     *
+     ** @param  p0      pointer to the first sample of the first color component
+     *  @param  p1      pointer to the first sample of the second color component
+     *  @param  p2      pointer to the first sample of the third color component
+     *  @param  stride  distance between two samples of the same color component
+     *  @param  first   index of the first pixel to be converted (output planes)
+     *  @param  last    index of the pixel behind the last one to be converted
+     */
+    virtual void convertRange(const T1 *p0,
+                              const T1 *p1,
+                              const T1 *p2,
+                              const unsigned long stride,
+                              const unsigned long first,
+                              const unsigned long last)
+    {
+        register T2 *q0 = this->Data[0] + first;
+        register T2 *q1 = this->Data[1] + first;
+        register T2 *q2 = this->Data[2] + first;
+        for (register unsigned long i = last - first; i != 0; --i)
+        {
+            *(q0++) = removeSign(*p0, Offset);
+            *(q1++) = removeSign(*p1, Offset);
+            *(q2++) = removeSign(*p2, Offset);
+            p0 += stride;
+            p1 += stride;
+            p2 += stride;
+        }
+    }
+
+
+ private:
+
+    /// offset used to remove the sign of the samples
+    const T1 Offset;
+};
+
+
 #endif
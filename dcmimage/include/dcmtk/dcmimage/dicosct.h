@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2011, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -57,6 +57,8 @@ class DiColorScaleTemplate
      *  @param  frames       number of frames
      *  @param  bits         number of bits per plane/pixel
      *  @param  interpolate  use of interpolation when scaling
+     *  @param  fstart       first frame of the source image to be scaled
+     *  @param  threads      maximum number of threads used for scaling
      */
     DiColorScaleTemplate(const DiColorPixel *pixel,
                          const Uint16 columns,
@@ -69,15 +71,30 @@ class DiColorScaleTemplate
                          const Uint16 dest_rows,
                          const Uint32 frames,
                          const int bits,
-                         const int interpolate)
+                         const int interpolate,
+                         const unsigned long fstart = 0,
+                         const Uint32 threads = 1)
       : DiColorPixelTemplate<T>(pixel, OFstatic_cast(unsigned long, dest_cols) * OFstatic_cast(unsigned long, dest_rows) * frames),
-        DiScaleTemplate<T>(3, columns, rows, left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, frames, bits)
+        DiScaleTemplate<T>(3, columns, rows, left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, frames, bits, threads)
    {
         if ((pixel != NULL) && (pixel->getCount() > 0))
         {
-            if (pixel->getCount() == OFstatic_cast(unsigned long, columns) * OFstatic_cast(unsigned long, rows) * frames)
-                scale(OFstatic_cast(const T **, OFconst_cast(void *, pixel->getData())), interpolate);
-            else {
+            const unsigned long fsize = OFstatic_cast(unsigned long, columns) * OFstatic_cast(unsigned long, rows);
+            if (pixel->getCount() >= fsize * (fstart + frames))
+            {
+                const T **data = OFstatic_cast(const T **, OFconst_cast(void *, pixel->getData()));
+                if (data != NULL)
+                {
+                    /* skip the frames in front of the first frame to be scaled */
+                    const T *src[3] = {data[0], data[1], data[2]};
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        if (src[j] != NULL)
+                            src[j] += fstart * fsize;
+                    }
+                    scale(src, interpolate);
+                }
+            } else {
                 DCMIMAGE_WARN("could not scale image ... corrupted data");
             }
         }
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2011, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -34,6 +34,155 @@
  *  class declaration  *
  *---------------------*/
 
+/** Template class to expand Palette color pixel data (helper class for DiPalettePixelTemplate).
+ *  The three palettes are combined into lookup tables covering the range of all palettes,
+ *  i.e. the clipping to the first and last entry is only performed once per pixel. The pixels
+ *  are processed in bands by multiple threads if requested.
+ */
+template<class T1, class T2, class T3>
+class DiPaletteConvertTemplate
+  : public DcmParallelFrameProcessor
+{
+
+ public:
+
+    /** constructor, create the lookup tables
+     *
+     ** @param  pixel    pointer to input pixel data
+     *  @param  data     array of pointers to the three output planes
+     *  @param  count    number of pixels to be converted
+     *  @param  palette  pointer to RGB color palette
+     */
+    DiPaletteConvertTemplate(const T1 *pixel,
+                             T3 *data[3],
+                             const unsigned long count,
+                             DiLookupTable *palette[3])
+      : DcmParallelFrameProcessor(OFstatic_cast(Uint32, (count + CONVERT_BAND_SIZE - 1) / CONVERT_BAND_SIZE)),
+        Pixel(pixel),
+        Count(count),
+        FirstEntry(0),
+        LastEntry(0)
+    {
+        register int j;
+        const T2 dummy = 0;
+        FirstEntry = palette[0]->getFirstEntry(dummy);
+        LastEntry = palette[0]->getLastEntry(dummy);
+        for (j = 1; j < 3; ++j)
+        {
+            if (palette[j]->getFirstEntry(dummy) < FirstEntry)
+                FirstEntry = palette[j]->getFirstEntry(dummy);
+            if (palette[j]->getLastEntry(dummy) > LastEntry)
+                LastEntry = palette[j]->getLastEntry(dummy);
+        }
+        const unsigned long size = OFstatic_cast(unsigned long, LastEntry - FirstEntry) + 1;
+        register unsigned long i;
+        register T2 value;
+        for (j = 0; j < 3; ++j)
+        {
+            Data[j] = data[j];
+            Table[j] = new T3[size];
+            for (i = 0; i < size; ++i)
+            {
+                value = OFstatic_cast(T2, FirstEntry + i);
+                if (value <= palette[j]->getFirstEntry(value))
+                    Table[j][i] = OFstatic_cast(T3, palette[j]->getFirstValue());
+                else if (value >= palette[j]->getLastEntry(value))
+                    Table[j][i] = OFstatic_cast(T3, palette[j]->getLastValue());
+                else
+                    Table[j][i] = OFstatic_cast(T3, palette[j]->getValue(value));
+            }
+        }
+    }
+
+    /** destructor
+     */
+    virtual ~DiPaletteConvertTemplate()
+    {
+        delete[] Table[0];
+        delete[] Table[1];
+        delete[] Table[2];
+    }
+
+    /** convert all pixels
+     *
+     ** @param  threads  maximum number of threads to be used
+     */
+    void convertData(const Uint32 threads)
+    {
+        processAllFrames(threads);
+    }
+
+
+ protected:
+
+    /** convert a band of CONVERT_BAND_SIZE pixels.
+     *  Called by processAllFrames(), possibly by multiple threads at the same time.
+     *
+     ** @param  frameNo   index of the band to be converted
+     *  @param  threadNo  index of the calling thread (not used)
+     *
+     ** @return always EC_Normal
+     */
+    virtual OFCondition processFrame(Uint32 frameNo,
+                                     Uint32 /* threadNo */)
+    {
+        const unsigned long first = OFstatic_cast(unsigned long, frameNo) * CONVERT_BAND_SIZE;
+        process(first, (first + CONVERT_BAND_SIZE < Count) ? first + CONVERT_BAND_SIZE : Count);
+        return EC_Normal;
+    }
+
+    /** convert the given range of pixels
+     *
+     ** @param  first  index of the first pixel to be converted
+     *  @param  last   index of the pixel behind the last one to be converted
+     */
+    virtual void process(const unsigned long first,
+                         const unsigned long last)
+    {
+        register const T1 *p = Pixel + first;
+        register T3 *r = Data[0] + first;
+        register T3 *g = Data[1] + first;
+        register T3 *b = Data[2] + first;
+        register T2 value;
+        register unsigned long pos;
+        for (register unsigned long i = last - first; i != 0; --i)
+        {
+            value = OFstatic_cast(T2, *(p++));
+            if (value <= FirstEntry)
+                pos = 0;
+            else if (value >= LastEntry)
+                pos = OFstatic_cast(unsigned long, LastEntry - FirstEntry);
+            else
+                pos = OFstatic_cast(unsigned long, value - FirstEntry);
+            *(r++) = Table[0][pos];
+            *(g++) = Table[1][pos];
+            *(b++) = Table[2][pos];
+        }
+    }
+
+
+ private:
+
+    /// pointer to input pixel data
+    const T1 *Pixel;
+    /// pointers to the three output planes
+    T3 *Data[3];
+    /// number of pixels to be converted
+    const unsigned long Count;
+    /// smallest first entry of the three palettes
+    T2 FirstEntry;
+    /// largest last entry of the three palettes
+    T2 LastEntry;
+    /// lookup tables for the three color components (FirstEntry..LastEntry)
+    T3 *Table[3];
+
+ // --- declarations to avoid compiler warnings
+
+    DiPaletteConvertTemplate(const DiPaletteConvertTemplate<T1, T2, T3> &);
+    DiPaletteConvertTemplate<T1, T2, T3> &operator=(const DiPaletteConvertTemplate<T1, T2, T3> &);
+};
+
+
 /** Template class to handle Palette color pixel data
  */
 template<class T1, class T2, class T3>
@@ -64,7 +213,7 @@ class DiPalettePixelTemplate
                 DCMIMAGE_ERROR("invalid value for 'PlanarConfiguration' (" << this->PlanarConfiguration << ")");
             }
             else
-                convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), palette);
+                convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), palette, docu->getNumberOfThreads());
         }
     }
 
@@ -81,32 +230,20 @@ class DiPalettePixelTemplate
      *
      ** @param  pixel    pointer to input pixel data
      *  @param  palette  pointer to RGB color palette
+     *  @param  threads  maximum number of threads used for the conversion
      */
     void convert(const T1 *pixel,
-                 DiLookupTable *palette[3])
-    {                                                                // can be optimized if necessary !
+                 DiLookupTable *palette[3],
+                 const Uint32 threads)
+    {
         if (this->Init(pixel))
         {
-            register const T1 *p = pixel;
-            register T2 value = 0;
-            register unsigned long i;
-            register int j;
             // use the number of input pixels derived from the length of the 'PixelData'
             // attribute), but not more than the size of the intermediate buffer
             const unsigned long count = (this->InputCount < this->Count) ? this->InputCount : this->Count;
-            for (i = 0; i < count; ++i)
-            {
-                value = OFstatic_cast(T2, *(p++));
-                for (j = 0; j < 3; ++j)
-                {
-                    if (value <= palette[j]->getFirstEntry(value))
-                        this->Data[j][i] = OFstatic_cast(T3, palette[j]->getFirstValue());
-                    else if (value >= palette[j]->getLastEntry(value))
-                        this->Data[j][i] = OFstatic_cast(T3, palette[j]->getLastValue());
-                    else
-                        this->Data[j][i] = OFstatic_cast(T3, palette[j]->getValue(value));
-                }
-            }
+            /* expand pixels (in parallel threads if enabled) */
+            DiPaletteConvertTemplate<T1, T2, T3> task(pixel, this->Data, count, palette);
+            task.convertData(threads);
         }
     }
 };
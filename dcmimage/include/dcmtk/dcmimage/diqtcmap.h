@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -75,9 +75,41 @@ public:
     T1& fs,
     T2 *tp)
   {
-    unsigned long cols = sourceImage.getWidth();
-    unsigned long rows = sourceImage.getHeight();
     const int bits = sizeof(DcmQuantComponent)*8;
+    const void *data = sourceImage.getOutputData(bits, frameNumber, 0);
+    if (data)
+    {
+      create(OFstatic_cast(const DcmQuantComponent *, data), sourceImage.getWidth(), sourceImage.getHeight(),
+        maxval, cht, colormap, fs, tp);
+    }
+  }
+
+  /** converts a number of rows of a color image into a palette color image.
+   *  @param cp pointer to the color pixel data (interleaved RGB, i.e. color-by-pixel,
+   *    with sizeof(DcmQuantComponent)*8 bits per sample) of the first row
+   *  @param cols number of columns
+   *  @param rows number of rows to be converted
+   *  @param maxval maximum pixel value to which all color samples
+   *    were down-sampled during computation of the histogram on which
+   *    the color LUT is based.
+   *  @param cht color hash table, may already contain colors from previous calls.
+   *  @param colormap color LUT to which the color image is mapped.
+   *  @param fs error diffusion object, e.g. an instance of class DcmQuantIdent
+   *    or class DcmQuantFloydSteinberg, depending on the template instantiation.
+   *  @param tp pointer to an array to which the palette color image data
+   *    is written.  The array must be large enough to store cols times rows
+   *    values of type T2.
+   */
+  static void create(
+    const DcmQuantComponent *cp,
+    unsigned long cols,
+    unsigned long rows,
+    unsigned long maxval,
+    DcmQuantColorHashTable& cht,
+    DcmQuantColorTable& colormap,
+    T1& fs,
+    T2 *tp)
+  {
     DcmQuantPixel px;
     long limitcol;
     long col; // must be signed!
@@ -90,40 +122,35 @@ public:
     DcmQuantScaleTable scaletable;
     scaletable.createTable(OFstatic_cast(DcmQuantComponent, -1), maxval);
 
-    const void *data = sourceImage.getOutputData(bits, frameNumber, 0);
-    if (data)
+    for (unsigned long row = 0; row < rows; ++row)
     {
-      const DcmQuantComponent *cp = OFstatic_cast(const DcmQuantComponent *, data);
-      for (unsigned long row = 0; row < rows; ++row)
+      fs.startRow(col, limitcol);
+      do
       {
-        fs.startRow(col, limitcol);
-        do
-        {
-            currentpixel = cp + col + col + col;
-            cr = *currentpixel++;
-            cg = *currentpixel++;
-            cb = *currentpixel;
-            px.scale(cr, cg, cb, scaletable);
+          currentpixel = cp + col + col + col;
+          cr = *currentpixel++;
+          cg = *currentpixel++;
+          cb = *currentpixel;
+          px.scale(cr, cg, cb, scaletable);
 
-            fs.adjust(px, col, maxval_l);
+          fs.adjust(px, col, maxval_l);
 
-            // Check hash table to see if we have already matched this color.
-            ind = cht.lookup(px);
-            if (ind < 0)
-            {
-              ind = colormap.computeIndex(px);
-              cht.add(px, ind);
-            }
+          // Check hash table to see if we have already matched this color.
+          ind = cht.lookup(px);
+          if (ind < 0)
+          {
+            ind = colormap.computeIndex(px);
+            cht.add(px, ind);
+          }
 
-            fs.propagate(px, colormap.getPixel(ind), col);
-            tp[col] = OFstatic_cast(T2, ind);
-            fs.nextCol(col);
-        } while ( col != limitcol );
-        fs.finishRow();
-        cp += (cols * 3); // advance source pointer by one row
-        tp += cols;  // advance target pointer by one row
-      } // for all rows
-    } // if (data)
+          fs.propagate(px, colormap.getPixel(ind), col);
+          tp[col] = OFstatic_cast(T2, ind);
+          fs.nextCol(col);
+      } while ( col != limitcol );
+      fs.finishRow();
+      cp += (cols * 3); // advance source pointer by one row
+      tp += cols;  // advance target pointer by one row
+    } // for all rows
   }
 };
 
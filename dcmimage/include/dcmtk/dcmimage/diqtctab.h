@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -156,34 +156,31 @@ public:
     DcmLargestDimensionType largeType,
     DcmRepresentativeColorType repType);
 
+  /** refines the colors of a color LUT computed by medianCut() using
+   *  the k-means algorithm (Lloyd's algorithm).  In each iteration, every
+   *  color of the image histogram is assigned to its closest match in the
+   *  color LUT, and each LUT entry is replaced by the weighted average of
+   *  the colors assigned to it.  Since the mean squared error of the mapping
+   *  never increases, the result is at least as good as the median cut LUT.
+   *  The iteration stops early if the color LUT does not change any more.
+   *  @param histogram image color histogram (same maxval as this color LUT)
+   *  @param iterations maximum number of iterations
+   *  @return EC_Normal if successful, an error code otherwise.
+   */
+  OFCondition refine(
+    const DcmQuantColorTable& histogram,
+    unsigned long iterations);
+
   /** determines for a given color the closest match in the color LUT.
+   *  The LUT entries are searched in the order of the component with the
+   *  largest range, starting with the entry closest to the given color in
+   *  this component.  The search stops as soon as the distance in this
+   *  component alone exceeds the smallest euclidean distance found so far.
+   *  If there are several closest matches, the smallest index is returned.
    *  @param px color to look up in LUT
    *  @return index of closest match in LUT, -1 if look-up table empty
    */
-  inline int computeIndex(const DcmQuantPixel& px) const
-  {
-    int result = -1;
-    register int r2, g2, b2;
-    register long newdist;
-    register int r1 = OFstatic_cast(int, px.getRed());
-    register int g1 = OFstatic_cast(int, px.getGreen());
-    register int b1 = OFstatic_cast(int, px.getBlue());
-    register long dist = 2000000000;
-    for (unsigned long i = 0; i < numColors; ++i)
-    {
-        r2 = r1 - OFstatic_cast(int, array[i]->getRed());
-        g2 = g1 - OFstatic_cast(int, array[i]->getGreen());
-        b2 = b1 - OFstatic_cast(int, array[i]->getBlue());
-        newdist = r2*r2 + g2*g2 + b2*b2;
-        if (newdist < dist)
-        {
-            result = OFstatic_cast(int, i);
-            dist = newdist;
-            if (dist < array[i]->getValue()) i=numColors; // break out of for loop
-        }
-    }
-    return result;
-  }
+  int computeIndex(const DcmQuantPixel& px) const;
 
   /** writes the current color table into a DICOM object, encoded as
    *  Red/Green/Blue Palette Color Lookup Table and Data.
@@ -202,13 +199,21 @@ public:
 
 private:
 
-  /** after a call to medianCut(), this method computes for each entry in
-   *  the color map the minimum of the euclidean distances to any other
-   *  of the entries.  Any color which has an euclidean distance of less
-   *  than half of this distance is necessarily mapped to this entry.
-   *  This data is used by computeIndex()
+  /** after a call to medianCut() or refine(), this method creates the
+   *  search index used by computeIndex(), i.e. it sorts the entries of the
+   *  color map by the color component with the largest range.
+   */
+  void createSearchIndex();
+
+  /** returns the given color component of a pixel
+   *  @param px pixel
+   *  @param component color component (0 = red, 1 = green, 2 = blue)
+   *  @return value of color component
    */
-  void computeClusters();
+  static inline int getComponent(const DcmQuantPixel& px, int component)
+  {
+    return (component == 0) ? px.getRed() : (component == 1) ? px.getGreen() : px.getBlue();
+  }
 
   /// private undefined copy constructor
   DcmQuantColorTable(const DcmQuantColorTable& src);
@@ -227,6 +232,15 @@ private:
    */
   unsigned long maxval;
 
+  /// color component by which the search index is sorted (0 = red, 1 = green, 2 = blue)
+  int searchComponent;
+
+  /// indices of the color table entries, sorted by the search component
+  unsigned long *searchIndex;
+
+  /// values of the search component, in the order of searchIndex
+  int *searchKey;
+
 };
 
 #endif
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2011, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -58,6 +58,16 @@ public:
    *    in the Median Cut algorithm
    *  @param repType algorithm for choosing a representative color for each
    *    box in the Median Cut algorithm
+   *  @param kmeansIterations maximum number of iterations of the k-means
+   *    algorithm used to refine the color palette computed by the Median Cut
+   *    algorithm (0 = no refinement).  The refinement reduces the quantization
+   *    error but takes additional time.
+   *  @param numberOfThreads maximum number of threads used for mapping the
+   *    image to the color palette (only if DCMTK is compiled with thread
+   *    support).  With Floyd-Steinberg error diffusion and more than one
+   *    thread, the frames are processed in parallel and the error diffusion
+   *    starts anew for each frame.  Otherwise, the error is carried over from
+   *    one frame to the next.
    *  @return EC_Normal if successful, an error code otherwise.
    */
   static OFCondition createPaletteColorImage(
@@ -69,7 +79,9 @@ public:
     Uint32 numberOfColors,
     OFString& description,
     DcmLargestDimensionType largeType = DcmLargestDimensionType_default,
-    DcmRepresentativeColorType repType = DcmRepresentativeColorType_default);
+    DcmRepresentativeColorType repType = DcmRepresentativeColorType_default,
+    Uint32 kmeansIterations = 0,
+    Uint32 numberOfThreads = 1);
 
   /** create Derivation Description. If a derivation description
    *  already exists, the old text is appended to the new text.
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2011, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -58,7 +58,7 @@ class DiRGBPixelTemplate
       : DiColorPixelTemplate<T2>(docu, pixel, 3, status)
     {
         if ((pixel != NULL) && (this->Count > 0) && (status == EIS_Normal))
-            convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), planeSize, bits);
+            convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), planeSize, bits, docu->getNumberOfThreads());
     }
 
     /** destructor
@@ -75,10 +75,12 @@ class DiRGBPixelTemplate
      ** @param  pixel      pointer to input pixel data
      *  @param  planeSize  number of pixels in a plane
      *  @param  bits       number of bits per sample
+     *  @param  threads    maximum number of threads used for the conversion
      */
     void convert(const T1 *pixel,
                  const unsigned long planeSize,
-                 const int bits)
+                 const int bits,
+                 const Uint32 threads)
     {
         if (this->Init(pixel))
         {
@@ -86,46 +88,9 @@ class DiRGBPixelTemplate
             // attribute), but not more than the size of the intermediate buffer
             const unsigned long count = (this->InputCount < this->Count) ? this->InputCount : this->Count;
             const T1 offset = OFstatic_cast(T1, DicomImageClass::maxval(bits - 1));
-            register const T1 *p = pixel;
-            if (this->PlanarConfiguration)
-            {
-/*
-                register T2 *q;
-                // number of pixels to be skipped (only applicable if 'PixelData' contains more
-                // pixels than expected)
-                const unsigned long skip = (this->InputCount > this->Count) ? (this->InputCount - this->Count) : 0;
-                for (int j = 0; j < 3; ++j)
-                {
-                    q = this->Data[j];
-                    for (i = count; i != 0; --i)
-                        *(q++) = removeSign(*(p++), offset);
-                    // skip to beginning of next plane
-                    p += skip;
-                }
-*/
-                register unsigned long l;
-                register unsigned long i = 0;
-                while (i < count)
-                {
-                    /* store current pixel index */
-                    const unsigned long iStart = i;
-                    /* for all planes ... */
-                    for (int j = 0; j < 3; ++j)
-                    {
-                        /* convert a single plane */
-                        for (l = planeSize, i = iStart; (l != 0) && (i < count); --l, ++i)
-                            this->Data[j][i] = removeSign(*(p++), offset);
-                    }
-                }
-            }
-            else
-            {
-                register int j;
-                register unsigned long i;
-                for (i = 0; i < count; ++i)                             /* for all pixel ... */
-                    for (j = 0; j < 3; ++j)
-                        this->Data[j][i] = removeSign(*(p++), offset);  /* ... copy planes */
-            }
+            /* copy planes (in parallel threads if enabled) */
+            DiColorSeparateTemplate<T1, T2> task(pixel, this->Data, count, planeSize, this->PlanarConfiguration, offset);
+            task.convertData(threads);
         }
     }
 };
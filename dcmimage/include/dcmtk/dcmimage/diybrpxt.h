@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2014, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -33,6 +33,204 @@
  *  class declaration  *
  *---------------------*/
 
+/** Template class to convert YCbCr pixel data to RGB (helper class for DiYBRPixelTemplate).
+ *  For up to 12 bits per sample, the color transformation is computed with fixed-point
+ *  lookup tables (16 fractional bits) and a clipping table. Since all coefficients are
+ *  multiples of 0.0001, the rounding of the table entries never changes the result, i.e.
+ *  the tables give the exact result of the formula. Otherwise, floating-point arithmetic
+ *  is used, which may be one too low in rare cases where the exact result is an integer.
+ */
+template<class T1, class T2>
+class DiYBRConvertTemplate
+  : public DiColorConvertTemplate<T1, T2>
+{
+
+ public:
+
+    /** constructor, create the lookup tables (if applicable)
+     *
+     ** @param  pixel      pointer to input pixel data
+     *  @param  data       array of pointers to the three output planes
+     *  @param  count      number of pixels to be converted
+     *  @param  planeSize  number of pixels in a plane (only used for color-by-plane)
+     *  @param  planar     flag indicating whether input data is stored color-by-plane
+     *  @param  bits       number of bits per sample
+     */
+    DiYBRConvertTemplate(const T1 *pixel,
+                         T2 *data[3],
+                         const unsigned long count,
+                         const unsigned long planeSize,
+                         const int planar,
+                         const int bits)
+      : DiColorConvertTemplate<T1, T2>(pixel, data, count, planeSize, planar),
+        Offset(OFstatic_cast(T1, DicomImageClass::maxval(bits - 1))),
+        MaxValue(OFstatic_cast(T2, DicomImageClass::maxval(bits))),
+        RCrTable(NULL),
+        GCbTable(NULL),
+        GCrTable(NULL),
+        BCbTable(NULL),
+        ClipTable(NULL)
+    {
+        if (bits <= 12)
+        {
+            const unsigned long size = OFstatic_cast(unsigned long, MaxValue) + 1;
+            const double maxvalue = OFstatic_cast(double, MaxValue);
+            RCrTable = new Sint32[size];
+            GCbTable = new Sint32[size];
+            GCrTable = new Sint32[size];
+            BCbTable = new Sint32[size];
+            register unsigned long l;
+            for (l = 0; l < size; ++l)
+            {
+                const double value = OFstatic_cast(double, l);
+                RCrTable[l] = fixedValue(1.4020 * value - 0.7010 * maxvalue);
+                GCbTable[l] = fixedValue(0.3441 * value);
+                GCrTable[l] = fixedValue(0.7141 * value - 0.5291 * maxvalue);
+                BCbTable[l] = fixedValue(1.7720 * value - 0.8859 * maxvalue);
+            }
+            /* the results of the transformation are in the range -size..2*size-1 */
+            ClipTable = new T2[3 * size];
+            for (l = 0; l < 3 * size; ++l)
+                ClipTable[l] = (l < size) ? 0 : (l >= 2 * size) ? MaxValue : OFstatic_cast(T2, l - size);
+        }
+    }
+
+    /** destructor
+     */
+    virtual ~DiYBRConvertTemplate()
+    {
+        delete[] RCrTable;
+        delete[] GCbTable;
+        delete[] GCrTable;
+        delete[] BCbTable;
+        delete[] ClipTable;
+    }
+
+
+ protected:
+
+    /** convert the given range of pixels to RGB
+     *
+     ** @param  p0      pointer to the first Y sample
+     *  @param  p1      pointer to the first Cb sample
+     *  @param  p2      pointer to the first Cr sample
+     *  @param  stride  distance between two samples of the same color component
+     *  @param  first   index of the first pixel to be converted (output planes)
+     *  @param  last    index of the pixel behind the last one to be converted
+     */
+    virtual void convertRange(const T1 *p0,
+                              const T1 *p1,
+                              const T1 *p2,
+                              const unsigned long stride,
+                              const unsigned long first,
+                              const unsigned long last)
+    {
+        register T2 *r = this->Data[0] + first;
+        register T2 *g = this->Data[1] + first;
+        register T2 *b = this->Data[2] + first;
+        register unsigned long i;
+        if (ClipTable != NULL)
+        {
+            /* add an offset of 'MaxValue + 1' to the fixed-point values to avoid negative numbers */
+            const Sint32 bias = OFstatic_cast(Sint32, (OFstatic_cast(unsigned long, MaxValue) + 1) << 16);
+            /* the mask makes sure that invalid sample values do not exceed the tables */
+            const Uint32 mask = OFstatic_cast(Uint32, MaxValue);
+            register Sint32 y;
+            register Uint32 cb;
+            register Uint32 cr;
+            for (i = last - first; i != 0; --i)
+            {
+                y = (OFstatic_cast(Sint32, OFstatic_cast(Uint32, removeSign(*p0, Offset)) & mask) << 16) + bias;
+                cb = OFstatic_cast(Uint32, removeSign(*p1, Offset)) & mask;
+                cr = OFstatic_cast(Uint32, removeSign(*p2, Offset)) & mask;
+                convertFixed(*(r++), *(g++), *(b++), y, cb, cr);
+                p0 += stride;
+                p1 += stride;
+                p2 += stride;
+            }
+        } else {
+            for (i = last - first; i != 0; --i)
+            {
+                convertValue(*(r++), *(g++), *(b++), removeSign(*p0, Offset), removeSign(*p1, Offset),
+                    removeSign(*p2, Offset), MaxValue);
+                p0 += stride;
+                p1 += stride;
+                p2 += stride;
+            }
+        }
+    }
+
+    /** convert a single YCbCr value to RGB using the lookup tables
+     *
+     ** @param  red    reference to red output value
+     *  @param  green  reference to green output value
+     *  @param  blue   reference to blue output value
+     *  @param  y      Y value (fixed-point number, incl. offset of 'MaxValue + 1')
+     *  @param  cb     Cb value (0..MaxValue)
+     *  @param  cr     Cr value (0..MaxValue)
+     */
+    inline void convertFixed(T2 &red,
+                             T2 &green,
+                             T2 &blue,
+                             const Sint32 y,
+                             const Uint32 cb,
+                             const Uint32 cr) const
+    {
+        red   = ClipTable[(y + RCrTable[cr]) >> 16];
+        green = ClipTable[(y - GCbTable[cb] - GCrTable[cr]) >> 16];
+        blue  = ClipTable[(y + BCbTable[cb]) >> 16];
+    }
+
+    /** convert a single YCbCr value to RGB
+     */
+    static inline void convertValue(T2 &red,
+                                    T2 &green,
+                                    T2 &blue,
+                                    const T2 y,
+                                    const T2 cb,
+                                    const T2 cr,
+                                    const T2 maxvalue)
+    {
+        double dr = OFstatic_cast(double, y) + 1.4020 * OFstatic_cast(double, cr) - 0.7010 * OFstatic_cast(double, maxvalue);
+        double dg = OFstatic_cast(double, y) - 0.3441 * OFstatic_cast(double, cb) - 0.7141 * OFstatic_cast(double, cr) + 0.5291 * OFstatic_cast(double, maxvalue);
+        double db = OFstatic_cast(double, y) + 1.7720 * OFstatic_cast(double, cb) - 0.8859 * OFstatic_cast(double, maxvalue);
+        red   = (dr < 0.0) ? 0 : (dr > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dr);
+        green = (dg < 0.0) ? 0 : (dg > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dg);
+        blue  = (db < 0.0) ? 0 : (db > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, db);
+    }
+
+    /** convert given value to a fixed-point number with 16 fractional bits
+     */
+    static inline Sint32 fixedValue(const double value)
+    {
+        return OFstatic_cast(Sint32, (value < 0) ? value * 65536.0 - 0.5 : value * 65536.0 + 0.5);
+    }
+
+    /// offset used to remove the sign of the samples
+    const T1 Offset;
+    /// maximum output value
+    const T2 MaxValue;
+
+    /// lookup table for the red component (Cr)
+    Sint32 *RCrTable;
+    /// lookup table for the green component (Cb)
+    Sint32 *GCbTable;
+    /// lookup table for the green component (Cr)
+    Sint32 *GCrTable;
+    /// lookup table for the blue component (Cb)
+    Sint32 *BCbTable;
+    /// table used to clip the results to the valid range
+    T2 *ClipTable;
+
+ private:
+
+ // --- declarations to avoid compiler warnings
+
+    DiYBRConvertTemplate(const DiYBRConvertTemplate<T1, T2> &);
+    DiYBRConvertTemplate<T1, T2> &operator=(const DiYBRConvertTemplate<T1, T2> &);
+};
+
+
 /** Template class to handle YCbCr pixel data
  */
 template<class T1, class T2>
@@ -60,7 +258,7 @@ class DiYBRPixelTemplate
       : DiColorPixelTemplate<T2>(docu, pixel, 3, status)
     {
         if ((pixel != NULL) && (this->Count > 0) && (status == EIS_Normal))
-            convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), planeSize, bits, rgb);
+            convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), planeSize, bits, rgb, docu->getNumberOfThreads());
     }
 
     /** destructor
@@ -78,206 +276,31 @@ class DiYBRPixelTemplate
      *  @param  planeSize  number of pixels in a plane
      *  @param  bits       number of bits per sample
      *  @param  rgb        flag, convert color model to RGB only if true
+     *  @param  threads    maximum number of threads used for the conversion
      */
     void convert(const T1 *pixel,
                  const unsigned long planeSize,
                  const int bits,
-                 const OFBool rgb)
+                 const OFBool rgb,
+                 const Uint32 threads)
     {
         if (this->Init(pixel))
         {
-            const T1 offset = OFstatic_cast(T1, DicomImageClass::maxval(bits - 1));
             // use the number of input pixels derived from the length of the 'PixelData'
             // attribute), but not more than the size of the intermediate buffer
             const unsigned long count = (this->InputCount < this->Count) ? this->InputCount : this->Count;
+            /* convert pixels (in parallel threads if enabled) */
             if (rgb)    /* convert to RGB model */
             {
-                register T2 *r = this->Data[0];
-                register T2 *g = this->Data[1];
-                register T2 *b = this->Data[2];
-                const T2 maxvalue = OFstatic_cast(T2, DicomImageClass::maxval(bits));
-                DiPixelRepresentationTemplate<T1> rep;
-                if (bits == 8 && !rep.isSigned())          // only for unsigned 8 bit
-                {
-                    Sint16 rcr_tab[256];
-                    Sint16 gcb_tab[256];
-                    Sint16 gcr_tab[256];
-                    Sint16 bcb_tab[256];
-                    const double r_const = 0.7010 * OFstatic_cast(double, maxvalue);
-                    const double g_const = 0.5291 * OFstatic_cast(double, maxvalue);
-                    const double b_const = 0.8859 * OFstatic_cast(double, maxvalue);
-                    register unsigned long l;
-                    for (l = 0; l < 256; ++l)
-                    {
-                        rcr_tab[l] = OFstatic_cast(Sint16, 1.4020 * OFstatic_cast(double, l) - r_const);
-                        gcb_tab[l] = OFstatic_cast(Sint16, 0.3441 * OFstatic_cast(double, l));
-                        gcr_tab[l] = OFstatic_cast(Sint16, 0.7141 * OFstatic_cast(double, l) - g_const);
-                        bcb_tab[l] = OFstatic_cast(Sint16, 1.7720 * OFstatic_cast(double, l) - b_const);
-                    }
-                    register Sint32 sr;
-                    register Sint32 sg;
-                    register Sint32 sb;
-                    if (this->PlanarConfiguration)
-                    {
-/*
-                        register const T1 *y = pixel;
-                        register const T1 *cb = y + this->InputCount;
-                        register const T1 *cr = cb + this->InputCount;
-                        for (i = count; i != 0; --i, ++y, ++cb, ++cr)
-                        {
-                            sr = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, rcr_tab[*cr]);
-                            sg = OFstatic_cast(Sint32, *y) - OFstatic_cast(Sint32, gcb_tab[*cb]) - OFstatic_cast(Sint32, gcr_tab[*cr]);
-                            sb = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, bcb_tab[*cb]);
-                            *(r++) = (sr < 0) ? 0 : (sr > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sr);
-                            *(g++) = (sg < 0) ? 0 : (sg > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sg);
-                            *(b++) = (sb < 0) ? 0 : (sb > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sb);
-                        }
-*/
-                        register const T1 *y = pixel;
-                        register const T1 *cb = y + planeSize;
-                        register const T1 *cr = cb + planeSize;
-                        register unsigned long i = count;
-                        while (i != 0)
-                        {
-                            /* convert a single frame */
-                            for (l = planeSize; (l != 0) && (i != 0); --l, --i, ++y, ++cb, ++cr)
-                            {
-                                sr = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, rcr_tab[OFstatic_cast(Uint32, *cr)]);
-                                sg = OFstatic_cast(Sint32, *y) - OFstatic_cast(Sint32, gcb_tab[OFstatic_cast(Uint32, *cb)]) - OFstatic_cast(Sint32, gcr_tab[OFstatic_cast(Uint32, *cr)]);
-                                sb = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, bcb_tab[OFstatic_cast(Uint32, *cb)]);
-                                *(r++) = (sr < 0) ? 0 : (sr > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sr);
-                                *(g++) = (sg < 0) ? 0 : (sg > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sg);
-                                *(b++) = (sb < 0) ? 0 : (sb > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sb);
-                            }
-                            /* jump to next frame start (skip 2 planes) */
-                            y += 2 * planeSize;
-                            cb += 2 * planeSize;
-                            cr += 2 * planeSize;
-                        }
-                    }
-                    else
-                    {
-                        register const T1 *p = pixel;
-                        register T1 y;
-                        register T1 cb;
-                        register T1 cr;
-                        register unsigned long i;
-                        for (i = count; i != 0; --i)
-                        {
-                            y  = *(p++);
-                            cb = *(p++);
-                            cr = *(p++);
-                            sr = OFstatic_cast(Sint32, y) + OFstatic_cast(Sint32, rcr_tab[OFstatic_cast(Uint32, cr)]);
-                            sg = OFstatic_cast(Sint32, y) - OFstatic_cast(Sint32, gcb_tab[OFstatic_cast(Uint32, cb)]) - OFstatic_cast(Sint32, gcr_tab[OFstatic_cast(Uint32, cr)]);
-                            sb = OFstatic_cast(Sint32, y) + OFstatic_cast(Sint32, bcb_tab[OFstatic_cast(Uint32, cb)]);
-                            *(r++) = (sr < 0) ? 0 : (sr > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sr);
-                            *(g++) = (sg < 0) ? 0 : (sg > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sg);
-                            *(b++) = (sb < 0) ? 0 : (sb > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sb);
-                        }
-                    }
-                }
-                else
-                {
-                    if (this->PlanarConfiguration)
-                    {
-/*
-                        register const T1 *y = pixel;
-                        register const T1 *cb = y + this->InputCount;
-                        register const T1 *cr = cb + this->InputCount;
-                        for (i = count; i != 0; --i)
-                            convertValue(*(r++), *(g++), *(b++), removeSign(*(y++), offset), removeSign(*(cb++), offset),
-                                removeSign(*(cr++), offset), maxvalue);
-*/
-                        register unsigned long l;
-                        register unsigned long i = count;
-                        register const T1 *y = pixel;
-                        register const T1 *cb = y + planeSize;
-                        register const T1 *cr = cb + planeSize;
-                        while (i != 0)
-                        {
-                            /* convert a single frame */
-                            for (l = planeSize; (l != 0) && (i != 0); --l, --i)
-                            {
-                                convertValue(*(r++), *(g++), *(b++), removeSign(*(y++), offset), removeSign(*(cb++), offset),
-                                    removeSign(*(cr++), offset), maxvalue);
-                            }
-                            /* jump to next frame start (skip 2 planes) */
-                            y += 2 * planeSize;
-                            cb += 2 * planeSize;
-                            cr += 2 * planeSize;
-                        }
-                    }
-                    else
-                    {
-                        register const T1 *p = pixel;
-                        register T2 y;
-                        register T2 cb;
-                        register T2 cr;
-                        register unsigned long i;
-                        for (i = count; i != 0; --i)
-                        {
-                            y = removeSign(*(p++), offset);
-                            cb = removeSign(*(p++), offset);
-                            cr = removeSign(*(p++), offset);
-                            convertValue(*(r++), *(g++), *(b++), y, cb, cr, maxvalue);
-                        }
-                    }
-                }
+                DiYBRConvertTemplate<T1, T2> task(pixel, this->Data, count, planeSize, this->PlanarConfiguration, bits);
+                task.convertData(threads);
             } else {    /* retain YCbCr model */
-                register const T1 *p = pixel;
-                if (this->PlanarConfiguration)
-                {
-/*
-                    register T2 *q;
-                    // number of pixels to be skipped (only applicable if 'PixelData' contains more
-                    // pixels than expected)
-                    const unsigned long skip = (this->InputCount > this->Count) ? (this->InputCount - this->Count) : 0;
-                    for (int j = 0; j < 3; ++j)
-                    {
-                        q = this->Data[j];
-                        for (i = count; i != 0; --i)
-                            *(q++) = removeSign(*(p++), offset);
-                        // skip to beginning of next plane
-                        p += skip;
-                    }
-*/
-                    register unsigned long l;
-                    register unsigned long i = 0;
-                    while (i < count)
-                    {
-                        /* store current pixel index */
-                        const unsigned long iStart = i;
-                        for (int j = 0; j < 3; ++j)
-                        {
-                            /* convert a single plane */
-                            for (l = planeSize, i = iStart; (l != 0) && (i < count); --l, ++i)
-                                this->Data[j][i] = removeSign(*(p++), offset);
-                        }
-                    }
-                }
-                else
-                {
-                    register int j;
-                    register unsigned long i;
-                    for (i = 0; i < count; ++i)                             /* for all pixel ... */
-                        for (j = 0; j < 3; ++j)
-                            this->Data[j][i] = removeSign(*(p++), offset);  /* ... copy planes */
-                }
+                const T1 offset = OFstatic_cast(T1, DicomImageClass::maxval(bits - 1));
+                DiColorSeparateTemplate<T1, T2> task(pixel, this->Data, count, planeSize, this->PlanarConfiguration, offset);
+                task.convertData(threads);
             }
         }
     }
-
-    /** convert a single YCbCr value to RGB
-     */
-    inline void convertValue(T2 &red, T2 &green, T2 &blue, const T2 y, const T2 cb, const T2 cr, const T2 maxvalue)
-    {
-        double dr = OFstatic_cast(double, y) + 1.4020 * OFstatic_cast(double, cr) - 0.7010 * OFstatic_cast(double, maxvalue);
-        double dg = OFstatic_cast(double, y) - 0.3441 * OFstatic_cast(double, cb) - 0.7141 * OFstatic_cast(double, cr) + 0.5291 * OFstatic_cast(double, maxvalue);
-        double db = OFstatic_cast(double, y) + 1.7720 * OFstatic_cast(double, cb) - 0.8859 * OFstatic_cast(double, maxvalue);
-        red   = (dr < 0.0) ? 0 : (dr > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dr);
-        green = (dg < 0.0) ? 0 : (dg > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dg);
-        blue  = (db < 0.0) ? 0 : (db > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, db);
-    }
 };
 
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2011, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -25,7 +25,7 @@
 
 #include "dcmtk/config/osconfig.h"
 
-#include "dcmtk/dcmimage/dicopxt.h"
+#include "dcmtk/dcmimage/diybrpxt.h"
 #include "dcmtk/dcmimgle/diinpx.h"  /* gcc 3.4 needs this */
 
 
@@ -33,6 +33,120 @@
  *  class declaration  *
  *---------------------*/
 
+/** Template class to convert YCbCr Full 4:2:2 pixel data (helper class for DiYBR422PixelTemplate).
+ *  The pairs of pixels sharing the same chrominance values are processed in bands by multiple
+ *  threads if requested.
+ */
+template<class T1, class T2>
+class DiYBR422ConvertTemplate
+  : public DiYBRConvertTemplate<T1, T2>
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  pixel  pointer to input pixel data
+     *  @param  data   array of pointers to the three output planes
+     *  @param  pairs  number of pixel pairs to be converted
+     *  @param  bits   number of bits per sample
+     *  @param  rgb    flag, convert color model to RGB only if true
+     */
+    DiYBR422ConvertTemplate(const T1 *pixel,
+                            T2 *data[3],
+                            const unsigned long pairs,
+                            const int bits,
+                            const OFBool rgb)
+      : DiYBRConvertTemplate<T1, T2>(pixel, data, pairs, 0 /*planeSize*/, 0 /*planar*/, bits),
+        RGB(rgb)
+    {
+    }
+
+    /** destructor
+     */
+    virtual ~DiYBR422ConvertTemplate()
+    {
+    }
+
+
+ protected:
+
+    /** convert the given range of pixel pairs
+     *
+     ** @param  first  index of the first pixel pair to be converted
+     *  @param  last   index of the pixel pair behind the last one to be converted
+     */
+    virtual void process(const unsigned long first,
+                         const unsigned long last)
+    {
+        register const T1 *p = this->Pixel + 4 * first;
+        register T2 *r = this->Data[0] + 2 * first;
+        register T2 *g = this->Data[1] + 2 * first;
+        register T2 *b = this->Data[2] + 2 * first;
+        register unsigned long i;
+        if (!RGB)   /* retain YCbCr model: YCbCr_422_full -> YCbCr_full */
+        {
+            register T2 y1;
+            register T2 y2;
+            register T2 cb;
+            register T2 cr;
+            for (i = last - first; i != 0; --i)
+            {
+                y1 = removeSign(*(p++), this->Offset);
+                y2 = removeSign(*(p++), this->Offset);
+                cb = removeSign(*(p++), this->Offset);
+                cr = removeSign(*(p++), this->Offset);
+                *(r++) = y1;
+                *(g++) = cb;
+                *(b++) = cr;
+                *(r++) = y2;
+                *(g++) = cb;
+                *(b++) = cr;
+            }
+        }
+        else if (this->ClipTable != NULL)
+        {
+            /* see DiYBRConvertTemplate::convertRange() */
+            const Sint32 bias = OFstatic_cast(Sint32, (OFstatic_cast(unsigned long, this->MaxValue) + 1) << 16);
+            const Uint32 mask = OFstatic_cast(Uint32, this->MaxValue);
+            register Sint32 y1;
+            register Sint32 y2;
+            register Uint32 cb;
+            register Uint32 cr;
+            for (i = last - first; i != 0; --i)
+            {
+                y1 = (OFstatic_cast(Sint32, OFstatic_cast(Uint32, removeSign(*(p++), this->Offset)) & mask) << 16) + bias;
+                y2 = (OFstatic_cast(Sint32, OFstatic_cast(Uint32, removeSign(*(p++), this->Offset)) & mask) << 16) + bias;
+                cb = OFstatic_cast(Uint32, removeSign(*(p++), this->Offset)) & mask;
+                cr = OFstatic_cast(Uint32, removeSign(*(p++), this->Offset)) & mask;
+                this->convertFixed(*(r++), *(g++), *(b++), y1, cb, cr);
+                this->convertFixed(*(r++), *(g++), *(b++), y2, cb, cr);
+            }
+        } else {
+            register T2 y1;
+            register T2 y2;
+            register T2 cb;
+            register T2 cr;
+            for (i = last - first; i != 0; --i)
+            {
+                y1 = removeSign(*(p++), this->Offset);
+                y2 = removeSign(*(p++), this->Offset);
+                cb = removeSign(*(p++), this->Offset);
+                cr = removeSign(*(p++), this->Offset);
+                this->convertValue(*(r++), *(g++), *(b++), y1, cb, cr, this->MaxValue);
+                this->convertValue(*(r++), *(g++), *(b++), y2, cb, cr, this->MaxValue);
+            }
+        }
+    }
+
+
+ private:
+
+    /// flag, convert color model to RGB only if true
+    const OFBool RGB;
+};
+
+
 /** Template class to handle YCbCr Full 4:2:2 pixel data
  */
 template<class T1, class T2>
@@ -65,7 +179,7 @@ class DiYBR422PixelTemplate
                 DCMIMAGE_ERROR("invalid value for 'PlanarConfiguration' (" << this->PlanarConfiguration << ")");
             }
             else
-                convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), bits, rgb);
+                convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), bits, rgb, docu->getNumberOfThreads());
         }
     }
 
@@ -83,73 +197,23 @@ class DiYBR422PixelTemplate
      ** @param  pixel      pointer to input pixel data
      *  @param  bits       number of bits per sample
      *  @param  rgb        flag, convert color model to RGB only if true
+     *  @param  threads    maximum number of threads used for the conversion
      */
     void convert(const T1 *pixel,
                  const int bits,
-                 const OFBool rgb)
+                 const OFBool rgb,
+                 const Uint32 threads)
     {
         if (this->Init(pixel))
         {
-            const T1 offset = OFstatic_cast(T1, DicomImageClass::maxval(bits - 1));
-            register unsigned long i;
-            register const T1 *p = pixel;
-            register T2 *r = this->Data[0];
-            register T2 *g = this->Data[1];
-            register T2 *b = this->Data[2];
-            register T2 y1;
-            register T2 y2;
-            register T2 cb;
-            register T2 cr;
             // use the number of input pixels derived from the length of the 'PixelData'
             // attribute), but not more than the size of the intermediate buffer
             const unsigned long count = (this->InputCount < this->Count) ? this->InputCount : this->Count;
-            if (rgb)    /* convert to RGB model */
-            {
-                const T2 maxvalue = OFstatic_cast(T2, DicomImageClass::maxval(bits));
-                for (i = count / 2; i != 0; --i)
-                {
-                    y1 = removeSign(*(p++), offset);
-                    y2 = removeSign(*(p++), offset);
-                    cb = removeSign(*(p++), offset);
-                    cr = removeSign(*(p++), offset);
-                    convertValue(*(r++), *(g++), *(b++), y1, cb, cr, maxvalue);
-                    convertValue(*(r++), *(g++), *(b++), y2, cb, cr, maxvalue);
-                }
-            } else {    /* retain YCbCr model: YCbCr_422_full -> YCbCr_full */
-                for (i = count / 2; i != 0; --i)
-                {
-                    y1 = removeSign(*(p++), offset);
-                    y2 = removeSign(*(p++), offset);
-                    cb = removeSign(*(p++), offset);
-                    cr = removeSign(*(p++), offset);
-                    *(r++) = y1;
-                    *(g++) = cb;
-                    *(b++) = cr;
-                    *(r++) = y2;
-                    *(g++) = cb;
-                    *(b++) = cr;
-                }
-            }
+            /* convert pixel pairs (in parallel threads if enabled) */
+            DiYBR422ConvertTemplate<T1, T2> task(pixel, this->Data, count / 2, bits, rgb);
+            task.convertData(threads);
         }
     }
-
-    /** convert a single YCbCr value to RGB
-     */
-    inline void convertValue(T2 &red,
-                             T2 &green,
-                             T2 &blue,
-                             const T2 y,
-                             const T2 cb,
-                             const T2 cr,
-                             const T2 maxvalue)
-    {
-        double dr = OFstatic_cast(double, y) + 1.4020 * OFstatic_cast(double, cr) - 0.7010 * OFstatic_cast(double, maxvalue);
-        double dg = OFstatic_cast(double, y) - 0.3441 * OFstatic_cast(double, cb) - 0.7141 * OFstatic_cast(double, cr) + 0.5291 * OFstatic_cast(double, maxvalue);
-        double db = OFstatic_cast(double, y) + 1.7720 * OFstatic_cast(double, cb) - 0.8859 * OFstatic_cast(double, maxvalue);
-        red   = (dr < 0.0) ? 0 : (dr > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dr);
-        green = (dg < 0.0) ? 0 : (dg > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dg);
-        blue  = (db < 0.0) ? 0 : (db > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, db);
-    }
 };
 
 
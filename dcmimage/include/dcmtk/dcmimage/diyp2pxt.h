@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2011, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -33,6 +33,139 @@
  *  class declaration  *
  *---------------------*/
 
+/** Template class to convert YCbCr Partial 4:2:2 pixel data to RGB (helper class for
+ *  DiYBRPart422PixelTemplate). The pairs of pixels sharing the same chrominance values are
+ *  processed in bands by multiple threads if requested.
+ */
+template<class T1, class T2>
+class DiYBRPart422ConvertTemplate
+  : public DcmParallelFrameProcessor
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  pixel  pointer to input pixel data
+     *  @param  data   array of pointers to the three output planes
+     *  @param  pairs  number of pixel pairs to be converted
+     *  @param  bits   number of bits per sample
+     */
+    DiYBRPart422ConvertTemplate(const T1 *pixel,
+                                T2 *data[3],
+                                const unsigned long pairs,
+                                const int bits)
+      : DcmParallelFrameProcessor(OFstatic_cast(Uint32, (pairs + CONVERT_BAND_SIZE - 1) / CONVERT_BAND_SIZE)),
+        Pixel(pixel),
+        Pairs(pairs),
+        Offset(OFstatic_cast(T1, DicomImageClass::maxval(bits - 1))),
+        MaxValue(OFstatic_cast(T2, DicomImageClass::maxval(bits)))
+    {
+        Data[0] = data[0];
+        Data[1] = data[1];
+        Data[2] = data[2];
+    }
+
+    /** destructor
+     */
+    virtual ~DiYBRPart422ConvertTemplate()
+    {
+    }
+
+    /** convert all pixel pairs
+     *
+     ** @param  threads  maximum number of threads to be used
+     */
+    void convertData(const Uint32 threads)
+    {
+        processAllFrames(threads);
+    }
+
+
+ protected:
+
+    /** convert a band of CONVERT_BAND_SIZE pixel pairs.
+     *  Called by processAllFrames(), possibly by multiple threads at the same time.
+     *
+     ** @param  frameNo   index of the band to be converted
+     *  @param  threadNo  index of the calling thread (not used)
+     *
+     ** @return always EC_Normal
+     */
+    virtual OFCondition processFrame(Uint32 frameNo,
+                                     Uint32 /* threadNo */)
+    {
+        const unsigned long first = OFstatic_cast(unsigned long, frameNo) * CONVERT_BAND_SIZE;
+        process(first, (first + CONVERT_BAND_SIZE < Pairs) ? first + CONVERT_BAND_SIZE : Pairs);
+        return EC_Normal;
+    }
+
+    /** convert the given range of pixel pairs
+     *
+     ** @param  first  index of the first pixel pair to be converted
+     *  @param  last   index of the pixel pair behind the last one to be converted
+     */
+    virtual void process(const unsigned long first,
+                         const unsigned long last)
+    {
+        register const T1 *p = Pixel + 4 * first;
+        register T2 *r = Data[0] + 2 * first;
+        register T2 *g = Data[1] + 2 * first;
+        register T2 *b = Data[2] + 2 * first;
+        register T2 y1;
+        register T2 y2;
+        register T2 cb;
+        register T2 cr;
+        for (register unsigned long i = last - first; i != 0; --i)
+        {
+            y1 = removeSign(*(p++), Offset);
+            y2 = removeSign(*(p++), Offset);
+            cb = removeSign(*(p++), Offset);
+            cr = removeSign(*(p++), Offset);
+            convertValue(*(r++), *(g++), *(b++), y1, cb, cr, MaxValue);
+            convertValue(*(r++), *(g++), *(b++), y2, cb, cr, MaxValue);
+        }
+    }
+
+
+ private:
+
+    /** convert a single YCbCr value to RGB
+     */
+    static inline void convertValue(T2 &red,
+                                    T2 &green,
+                                    T2 &blue,
+                                    const T2 y,
+                                    const T2 cb,
+                                    const T2 cr,
+                                    const T2 maxvalue)
+    {
+        double dr = 1.1631 * OFstatic_cast(double, y) + 1.5969 * OFstatic_cast(double, cr) - 0.8713 * OFstatic_cast(double, maxvalue);
+        double dg = 1.1631 * OFstatic_cast(double, y) - 0.3913 * OFstatic_cast(double, cb) - 0.8121 * OFstatic_cast(double, cr) + 0.5290 * OFstatic_cast(double, maxvalue);
+        double db = 1.1631 * OFstatic_cast(double, y) + 2.0177 * OFstatic_cast(double, cb) - 1.0820 * OFstatic_cast(double, maxvalue);
+        red   = (dr < 0.0) ? 0 : (dr > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dr);
+        green = (dg < 0.0) ? 0 : (dg > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dg);
+        blue  = (db < 0.0) ? 0 : (db > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, db);
+    }
+
+    /// pointer to input pixel data
+    const T1 *Pixel;
+    /// pointers to the three output planes
+    T2 *Data[3];
+    /// number of pixel pairs to be converted
+    const unsigned long Pairs;
+    /// offset used to remove the sign of the samples
+    const T1 Offset;
+    /// maximum output value
+    const T2 MaxValue;
+
+ // --- declarations to avoid compiler warnings
+
+    DiYBRPart422ConvertTemplate(const DiYBRPart422ConvertTemplate<T1, T2> &);
+    DiYBRPart422ConvertTemplate<T1, T2> &operator=(const DiYBRPart422ConvertTemplate<T1, T2> &);
+};
+
+
 /** Template class to handle YCbCr Partial 4:2:2 pixel data
  */
 template<class T1, class T2>
@@ -63,7 +196,7 @@ class DiYBRPart422PixelTemplate
                 DCMIMAGE_ERROR("invalid value for 'PlanarConfiguration' (" << this->PlanarConfiguration << ")");
             }
             else
-                convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), bits);
+                convert(OFstatic_cast(const T1 *, pixel->getData()) + pixel->getPixelStart(), bits, docu->getNumberOfThreads());
         }
     }
 
@@ -80,56 +213,22 @@ class DiYBRPart422PixelTemplate
      *
      ** @param  pixel      pointer to input pixel data
      *  @param  bits       number of bits per sample
+     *  @param  threads    maximum number of threads used for the conversion
      */
     void convert(const T1 *pixel,
-                 const int bits)
+                 const int bits,
+                 const Uint32 threads)
     {
         if (this->Init(pixel))
         {
-            register T2 *r = this->Data[0];
-            register T2 *g = this->Data[1];
-            register T2 *b = this->Data[2];
-            register unsigned long i;
-            const T2 maxvalue = OFstatic_cast(T2, DicomImageClass::maxval(bits));
-            const T1 offset = OFstatic_cast(T1, DicomImageClass::maxval(bits - 1));
             // use the number of input pixels derived from the length of the 'PixelData'
             // attribute), but not more than the size of the intermediate buffer
             const unsigned long count = (this->InputCount < this->Count) ? this->InputCount : this->Count;
-
-            register const T1 *p = pixel;
-            register T2 y1;
-            register T2 y2;
-            register T2 cb;
-            register T2 cr;
-            for (i = count / 2; i != 0; --i)
-            {
-                y1 = removeSign(*(p++), offset);
-                y2 = removeSign(*(p++), offset);
-                cb = removeSign(*(p++), offset);
-                cr = removeSign(*(p++), offset);
-                convertValue(*(r++), *(g++), *(b++), y1, cb, cr, maxvalue);
-                convertValue(*(r++), *(g++), *(b++), y2, cb, cr, maxvalue);
-            }
+            /* convert pixel pairs (in parallel threads if enabled) */
+            DiYBRPart422ConvertTemplate<T1, T2> task(pixel, this->Data, count / 2, bits);
+            task.convertData(threads);
         }
     }
-
-    /** convert a single YCbCr value to RGB
-     */
-    inline void convertValue(T2 &red,
-                             T2 &green,
-                             T2 &blue,
-                             const T2 y,
-                             const T2 cb,
-                             const T2 cr,
-                             const T2 maxvalue)
-    {
-        double dr = 1.1631 * OFstatic_cast(double, y) + 1.5969 * OFstatic_cast(double, cr) - 0.8713 * OFstatic_cast(double, maxvalue);
-        double dg = 1.1631 * OFstatic_cast(double, y) - 0.3913 * OFstatic_cast(double, cb) - 0.8121 * OFstatic_cast(double, cr) + 0.5290 * OFstatic_cast(double, maxvalue);
-        double db = 1.1631 * OFstatic_cast(double, y) + 2.0177 * OFstatic_cast(double, cb) - 1.0820 * OFstatic_cast(double, maxvalue);
-        red   = (dr < 0.0) ? 0 : (dr > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dr);
-        green = (dg < 0.0) ? 0 : (dg > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dg);
-        blue  = (db < 0.0) ? 0 : (db > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, db);
-    }
 };
 
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2011, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -28,6 +28,7 @@
 
 #include "dcmtk/dcmimage/dicoimg.h"
 #include "dcmtk/dcmimgle/dimo2img.h"
+#include "dcmtk/dcmimgle/didocu.h"
 #include "dcmtk/dcmimage/dicopxt.h"
 #include "dcmtk/dcmimage/dicocpt.h"
 #include "dcmtk/dcmimage/dicosct.h"
@@ -100,8 +101,10 @@ DiColorImage::DiColorImage(const DiColorImage *image,
                            const Uint16 dest_cols,
                            const Uint16 dest_rows,
                            const int interpolate,
-                           const int aspect)
-  : DiImage(image, dest_cols, dest_rows, aspect),
+                           const int aspect,
+                           const unsigned long fstart,
+                           const unsigned long fcount)
+  : DiImage(image, dest_cols, dest_rows, aspect, fstart, fcount),
     RGBColorModel(image->RGBColorModel),
     InterData(NULL),
     OutputData(NULL)
@@ -112,15 +115,18 @@ DiColorImage::DiColorImage(const DiColorImage *image,
         {
             case EPR_Uint8:
                 InterData = new DiColorScaleTemplate<Uint8>(image->InterData, image->Columns, image->Rows, left_pos, top_pos,
-                    src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames, image->BitsPerSample, interpolate);
+                    src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames, image->BitsPerSample, interpolate, fstart,
+                    Document->getNumberOfThreads());
                 break;
             case EPR_Uint16:
                 InterData = new DiColorScaleTemplate<Uint16>(image->InterData, image->Columns, image->Rows, left_pos, top_pos,
-                    src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames, image->BitsPerSample, interpolate);
+                    src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames, image->BitsPerSample, interpolate, fstart,
+                    Document->getNumberOfThreads());
                 break;
             case EPR_Uint32:
                 InterData = new DiColorScaleTemplate<Uint32>(image->InterData, image->Columns, image->Rows, left_pos, top_pos,
-                    src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames, image->BitsPerSample, interpolate);
+                    src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames, image->BitsPerSample, interpolate, fstart,
+                    Document->getNumberOfThreads());
                 break;
             default:
                 DCMIMAGE_WARN("invalid value for inter-representation");
@@ -362,10 +368,12 @@ DiImage *DiColorImage::createScale(const signed long left_pos,
                                    const unsigned long dest_rows,
                                    const int interpolate,
                                    const int aspect,
-                                   const Uint16 /*pvalue*/) const
+                                   const Uint16 /*pvalue*/,
+                                   const unsigned long fstart,
+                                   const unsigned long fcount) const
 {
     DiImage *image = new DiColorImage(this, left_pos, top_pos, OFstatic_cast(Uint16, src_cols), OFstatic_cast(Uint16, src_rows),
-        OFstatic_cast(Uint16, dest_cols), OFstatic_cast(Uint16, dest_rows), interpolate, aspect);
+        OFstatic_cast(Uint16, dest_cols), OFstatic_cast(Uint16, dest_rows), interpolate, aspect, fstart, fcount);
     return image;
 }
 
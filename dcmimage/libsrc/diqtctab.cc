@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2014, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -65,6 +65,9 @@ DcmQuantColorTable::DcmQuantColorTable()
 : array(NULL)
 , numColors(0)
 , maxval(0)
+, searchComponent(0)
+, searchIndex(NULL)
+, searchKey(NULL)
 {
 }
 
@@ -83,6 +86,10 @@ void DcmQuantColorTable::clear()
     delete[] array;
     array = NULL;
   }
+  delete[] searchIndex;
+  searchIndex = NULL;
+  delete[] searchKey;
+  searchKey = NULL;
   numColors = 0;
   maxval = 0;
 }
@@ -325,48 +332,190 @@ OFCondition DcmQuantColorTable::medianCut(
       }
   }
 
-  // All done, now compute clusters
-  computeClusters();
+  // All done, now create the index for the color look-up
+  createSearchIndex();
   return EC_Normal;
 }
 
 
-void DcmQuantColorTable::computeClusters()
+OFCondition DcmQuantColorTable::refine(
+  const DcmQuantColorTable& histogram,
+  unsigned long iterations)
 {
+  if ((array == NULL) || (numColors == 0)) return EC_IllegalCall;
+
   unsigned long i;
-  unsigned long j;
-  unsigned long k=0;
-  int cluster;
-  int newdist;
-  int r1, g1, b1;
-  int r2, g2, b2;
+  double *sumRed = new double[numColors];
+  double *sumGreen = new double[numColors];
+  double *sumBlue = new double[numColors];
+  double *weight = new double[numColors];
+  OFBool changed = OFTrue;
+  for (unsigned long iter = 0; (iter < iterations) && changed; ++iter)
+  {
+    for (i = 0; i < numColors; ++i)
+      sumRed[i] = sumGreen[i] = sumBlue[i] = weight[i] = 0.0;
+
+    // assign each color of the histogram to the closest entry of the color map
+    for (i = 0; i < histogram.numColors; ++i)
+    {
+      const DcmQuantHistogramItem& item = *(histogram.array[i]);
+      const int ind = computeIndex(item);
+      const double count = OFstatic_cast(double, item.getValue());
+      sumRed[ind] += count * item.getRed();
+      sumGreen[ind] += count * item.getGreen();
+      sumBlue[ind] += count * item.getBlue();
+      weight[ind] += count;
+    }
+
+    // move each entry to the center of the colors assigned to it.
+    // Entries without any colors assigned are left unchanged.
+    changed = OFFalse;
+    for (i = 0; i < numColors; ++i)
+    {
+      if (weight[i] > 0.0)
+      {
+        DcmQuantComponent r = OFstatic_cast(DcmQuantComponent, sumRed[i] / weight[i] + 0.5);
+        DcmQuantComponent g = OFstatic_cast(DcmQuantComponent, sumGreen[i] / weight[i] + 0.5);
+        DcmQuantComponent b = OFstatic_cast(DcmQuantComponent, sumBlue[i] / weight[i] + 0.5);
+        if ((r != array[i]->getRed()) || (g != array[i]->getGreen()) || (b != array[i]->getBlue()))
+        {
+          array[i]->assign(r, g, b);
+          changed = OFTrue;
+        }
+      }
+    }
+    if (changed) createSearchIndex();
+  }
+  delete[] sumRed;
+  delete[] sumGreen;
+  delete[] sumBlue;
+  delete[] weight;
+  return EC_Normal;
+}
 
-  // initialize clusters
-  for (i = 0; i < numColors; ++i) array[i]->setValue(2000000000);
 
-  for (i = 0; i < numColors-1; ++i)
+void DcmQuantColorTable::createSearchIndex()
+{
+  delete[] searchIndex;
+  searchIndex = NULL;
+  delete[] searchKey;
+  searchKey = NULL;
+  if ((array == NULL) || (numColors == 0)) return;
+
+  unsigned long i;
+  int c;
+
+  // determine the color component with the largest range
+  int minValue[3];
+  int maxValue[3];
+  for (c = 0; c < 3; ++c) minValue[c] = maxValue[c] = getComponent(*array[0], c);
+  for (i = 1; i < numColors; ++i)
+  {
+    for (c = 0; c < 3; ++c)
+    {
+      const int v = getComponent(*array[i], c);
+      if (v < minValue[c]) minValue[c] = v;
+      if (v > maxValue[c]) maxValue[c] = v;
+    }
+  }
+  searchComponent = 0;
+  for (c = 1; c < 3; ++c)
   {
-    cluster = array[i]->getValue();
-    r1 = OFstatic_cast(int, array[i]->getRed());
-    g1 = OFstatic_cast(int, array[i]->getGreen());
-    b1 = OFstatic_cast(int, array[i]->getBlue());
+    if (maxValue[c] - minValue[c] > maxValue[searchComponent] - minValue[searchComponent]) searchComponent = c;
+  }
+
+  // sort the entries by this component (counting sort, keeps the order of equal values)
+  const unsigned long range = OFstatic_cast(unsigned long, maxValue[searchComponent]) + 1;
+  unsigned long *start = new unsigned long[range + 1];
+  for (i = 0; i <= range; ++i) start[i] = 0;
+  for (i = 0; i < numColors; ++i) ++start[getComponent(*array[i], searchComponent) + 1];
+  for (i = 1; i <= range; ++i) start[i] += start[i - 1];
+  searchIndex = new unsigned long[numColors];
+  searchKey = new int[numColors];
+  for (i = 0; i < numColors; ++i)
+  {
+    const int key = getComponent(*array[i], searchComponent);
+    const unsigned long pos = start[key]++;
+    searchIndex[pos] = i;
+    searchKey[pos] = key;
+  }
+  delete[] start;
+}
+
 
-    for (j = i+1; j < numColors; ++j)
+int DcmQuantColorTable::computeIndex(const DcmQuantPixel& px) const
+{
+  if ((searchIndex == NULL) || (numColors == 0)) return -1;
+
+  const int r1 = OFstatic_cast(int, px.getRed());
+  const int g1 = OFstatic_cast(int, px.getGreen());
+  const int b1 = OFstatic_cast(int, px.getBlue());
+  const int key = getComponent(px, searchComponent);
+
+  // binary search for the first entry with a key not less than the given one
+  unsigned long lower = 0;
+  unsigned long upper = numColors;
+  while (lower < upper)
+  {
+    const unsigned long middle = (lower + upper) / 2;
+    if (searchKey[middle] < key) lower = middle + 1; else upper = middle;
+  }
+
+  // search in both directions until the distance in the search component
+  // alone is larger than the smallest distance found so far
+  unsigned long result = numColors;
+  long dist = 2000000000;
+  unsigned long up = lower;
+  unsigned long down = lower;
+  register long d;
+  register long newdist;
+  register const DcmQuantHistogramItem *item;
+  while ((up < numColors) || (down > 0))
+  {
+    if (up < numColors)
+    {
+      d = searchKey[up] - key;
+      if (d * d > dist) up = numColors;
+      else
+      {
+        item = array[searchIndex[up]];
+        d = r1 - OFstatic_cast(int, item->getRed());
+        newdist = d * d;
+        d = g1 - OFstatic_cast(int, item->getGreen());
+        newdist += d * d;
+        d = b1 - OFstatic_cast(int, item->getBlue());
+        newdist += d * d;
+        if ((newdist < dist) || ((newdist == dist) && (searchIndex[up] < result)))
+        {
+          dist = newdist;
+          result = searchIndex[up];
+        }
+        ++up;
+      }
+    }
+    if (down > 0)
     {
-      // compute euclidean distance between i and j
-      r2 = r1 - OFstatic_cast(int, array[j]->getRed());
-      g2 = g1 - OFstatic_cast(int, array[j]->getGreen());
-      b2 = b1 - OFstatic_cast(int, array[j]->getBlue());
-      newdist = (r2*r2 + g2*g2 + b2*b2)/2;
-      if (newdist < cluster)
+      d = key - searchKey[down - 1];
+      if (d * d > dist) down = 0;
+      else
       {
-        cluster = newdist;
-        k = j;
+        --down;
+        item = array[searchIndex[down]];
+        d = r1 - OFstatic_cast(int, item->getRed());
+        newdist = d * d;
+        d = g1 - OFstatic_cast(int, item->getGreen());
+        newdist += d * d;
+        d = b1 - OFstatic_cast(int, item->getBlue());
+        newdist += d * d;
+        if ((newdist < dist) || ((newdist == dist) && (searchIndex[down] < result)))
+        {
+          dist = newdist;
+          result = searchIndex[down];
+        }
       }
     }
-    array[i]->setValue(cluster);
-    array[k]->setValue(cluster);
   }
+  return OFstatic_cast(int, result);
 }
 
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2002-2010, OFFIS e.V.
+ *  Copyright (C) 2002-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -29,6 +29,7 @@
 #include "dcmtk/dcmimage/diqthash.h"  /* for DcmQuantColorHashTable */
 #include "dcmtk/dcmimage/diqtctab.h"  /* for DcmQuantColorTable */
 #include "dcmtk/dcmimage/diqtfs.h"    /* for DcmQuantFloydSteinberg */
+#include "dcmtk/dcmdata/dcparfrm.h"   /* for DcmParallelFrameProcessor */
 #include "dcmtk/dcmimage/dilogger.h"  /* for logging macros */
 #include "dcmtk/dcmdata/dcswap.h"     /* for swapIfNecessary() */
 #include "dcmtk/dcmdata/dcitem.h"     /* for DcmItem */
@@ -39,6 +40,236 @@
 #include "dcmtk/dcmdata/dcuid.h"      /* for dcmGenerateUniqueIdentifier() */
 
 
+/// number of rows mapped at a time without error diffusion
+#define DCMQUANT_BAND_ROWS 16
+
+
+/** helper class that maps the rendered frames of a color image to the color palette.
+ *  Without error diffusion, the rows of all frames are mapped in bands of
+ *  DCMQUANT_BAND_ROWS rows.  Floyd-Steinberg error diffusion processes the rows of a
+ *  frame sequentially, so in this case each frame is processed as a whole.  The bands
+ *  or frames are distributed to the worker threads (if any).  Each thread uses its own
+ *  color hash table, which is kept for the next frames.
+ */
+template <class T>
+class DcmQuantColorMappingTask: public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param frames number of frames to be mapped
+   *  @param cols number of columns
+   *  @param rows number of rows
+   *  @param maxval maximum pixel value used for the computation of the color LUT
+   *  @param hashTables array of color hash tables, one for each thread.  Entries
+   *    that are NULL are created on demand, and deleted by the caller.
+   *  @param colormap color LUT to which the color image is mapped
+   *  @param floydSteinberg use Floyd-Steinberg error diffusion if true
+   *  @param fs error diffusion object that is used for all frames, i.e. the
+   *    error is carried over from one frame to the next.  Only allowed if the
+   *    frames are processed by a single thread.  If NULL, the error diffusion
+   *    starts anew for each frame.
+   *  @param data rendered pixel data of the frames (color-by-pixel)
+   *  @param tp pointer to an array to which the palette color image data is written
+   */
+  DcmQuantColorMappingTask(
+    unsigned long frames,
+    unsigned long cols,
+    unsigned long rows,
+    unsigned long maxval,
+    DcmQuantColorHashTable **hashTables,
+    DcmQuantColorTable& colormap,
+    OFBool floydSteinberg,
+    DcmQuantFloydSteinberg *fs,
+    const DcmQuantComponent *data,
+    T *tp)
+  : DcmParallelFrameProcessor(OFstatic_cast(Uint32, floydSteinberg ? frames : (frames * rows + DCMQUANT_BAND_ROWS - 1) / DCMQUANT_BAND_ROWS))
+  , columns(cols)
+  , rows_(rows)
+  , totalRows(frames * rows)
+  , maxval_(maxval)
+  , hashTables_(hashTables)
+  , colorMap(colormap)
+  , useFloydSteinberg(floydSteinberg)
+  , errorDiffusion(fs)
+  , source(data)
+  , target(tp)
+  {
+  }
+
+  /// destructor
+  virtual ~DcmQuantColorMappingTask()
+  {
+  }
+
+  /** maps a frame (with error diffusion) or a band of rows (without)
+   *  @param frameNo index of the frame or band
+   *  @param threadNo index of the calling thread
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, Uint32 threadNo)
+  {
+    // a thread index is never used by two threads at the same time
+    if (hashTables_[threadNo] == NULL) hashTables_[threadNo] = new DcmQuantColorHashTable();
+    DcmQuantColorHashTable& cht = *hashTables_[threadNo];
+    if (useFloydSteinberg)
+    {
+      const unsigned long fsize = columns * rows_;
+      if (errorDiffusion != NULL)
+      {
+        DcmQuantColorMapping<DcmQuantFloydSteinberg, T>::create(source + frameNo * fsize * 3, columns, rows_, maxval_, cht, colorMap, *errorDiffusion, target + frameNo * fsize);
+      }
+      else
+      {
+        // error diffusion starts anew for each frame
+        DcmQuantFloydSteinberg fs;
+        OFCondition result = fs.initialize(columns);
+        if (result.bad()) return result;
+        DcmQuantColorMapping<DcmQuantFloydSteinberg, T>::create(source + frameNo * fsize * 3, columns, rows_, maxval_, cht, colorMap, fs, target + frameNo * fsize);
+      }
+    }
+    else
+    {
+      const unsigned long first = OFstatic_cast(unsigned long, frameNo) * DCMQUANT_BAND_ROWS;
+      const unsigned long count = (first + DCMQUANT_BAND_ROWS < totalRows) ? DCMQUANT_BAND_ROWS : totalRows - first;
+      DcmQuantIdent id(columns);
+      DcmQuantColorMapping<DcmQuantIdent, T>::create(source + first * columns * 3, columns, count, maxval_, cht, colorMap, id, target + first * columns);
+    }
+    return EC_Normal;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmQuantColorMappingTask(const DcmQuantColorMappingTask<T>& src);
+
+  /// private undefined copy assignment operator
+  DcmQuantColorMappingTask<T>& operator=(const DcmQuantColorMappingTask<T>& src);
+
+  /// number of columns
+  unsigned long columns;
+
+  /// number of rows
+  unsigned long rows_;
+
+  /// number of rows of all frames
+  unsigned long totalRows;
+
+  /// maximum pixel value used for the computation of the color LUT
+  unsigned long maxval_;
+
+  /// color hash tables, one for each thread
+  DcmQuantColorHashTable **hashTables_;
+
+  /// color LUT to which the color image is mapped
+  DcmQuantColorTable& colorMap;
+
+  /// use Floyd-Steinberg error diffusion if true
+  OFBool useFloydSteinberg;
+
+  /// error diffusion object used for all frames, NULL if each frame starts anew
+  DcmQuantFloydSteinberg *errorDiffusion;
+
+  /// rendered pixel data of the frames to be mapped
+  const DcmQuantComponent *source;
+
+  /// palette color image data of the frames to be mapped
+  T *target;
+
+};
+
+
+/** maps all frames of the given color image to the color palette
+ *  @param sourceImage color image
+ *  @param maxval maximum pixel value used for the computation of the color LUT
+ *  @param colormap color LUT to which the color image is mapped
+ *  @param floydSteinberg use Floyd-Steinberg error diffusion if true
+ *  @param numberOfThreads maximum number of threads used for the mapping
+ *  @param tp pointer to an array to which the palette color image data is written
+ *  @return EC_Normal if successful, an error code otherwise.
+ */
+template <class T>
+static OFCondition mapColorImage(
+    DicomImage& sourceImage,
+    unsigned long maxval,
+    DcmQuantColorTable& colormap,
+    OFBool floydSteinberg,
+    Uint32 numberOfThreads,
+    T *tp)
+{
+    const int bits = sizeof(DcmQuantComponent)*8;
+    const unsigned long cols = sourceImage.getWidth();
+    const unsigned long rows = sourceImage.getHeight();
+    const unsigned long frames = sourceImage.getFrameCount();
+    const unsigned long fsize = cols * rows;
+#ifdef WITH_THREADS
+    const Uint32 threads = (numberOfThreads > 1) ? numberOfThreads : 1;
+#else
+    (void) numberOfThreads;
+    const Uint32 threads = 1;
+#endif
+
+    // one color hash table for each thread, created on demand
+    DcmQuantColorHashTable **hashTables = new DcmQuantColorHashTable *[threads];
+    Uint32 i;
+    for (i = 0; i < threads; ++i) hashTables[i] = NULL;
+
+    OFCondition result = EC_Normal;
+    DcmQuantFloydSteinberg fs;
+    DcmQuantFloydSteinberg *errorDiffusion = NULL;
+    DcmQuantComponent *buffer = NULL;
+    // with error diffusion, a number of frames is rendered in advance and mapped in
+    // parallel.  A single thread carries the error over from one frame to the next.
+    unsigned long batch = 1;
+    if (floydSteinberg)
+    {
+        if (threads > 1)
+        {
+            batch = (threads < frames) ? threads : frames;
+            if (batch < 1) batch = 1;
+        }
+        else
+        {
+            result = fs.initialize(cols);
+            errorDiffusion = &fs;
+        }
+    }
+    if (batch > 1)
+    {
+        buffer = new DcmQuantComponent[batch * fsize * 3];
+        if (buffer == NULL) result = EC_MemoryExhausted;
+    }
+
+    for (unsigned long ff = 0; (ff < frames) && result.good(); ff += batch)
+    {
+        const unsigned long count = (frames - ff < batch) ? frames - ff : batch;
+        const DcmQuantComponent *data = buffer;
+        if (buffer != NULL)
+        {
+            for (unsigned long j = 0; (j < count) && result.good(); ++j)
+            {
+                if (!sourceImage.getOutputData(buffer + j * fsize * 3, fsize * 3 * sizeof(DcmQuantComponent), bits, ff + j, 0))
+                    result = EC_IllegalCall;
+            }
+        }
+        else
+        {
+            data = OFstatic_cast(const DcmQuantComponent *, sourceImage.getOutputData(bits, ff, 0));
+            if (data == NULL) result = EC_IllegalCall;
+        }
+        if (result.good())
+        {
+            DcmQuantColorMappingTask<T> task(count, cols, rows, maxval, hashTables, colormap, floydSteinberg, errorDiffusion, data, tp + ff * fsize);
+            result = task.processAllFrames(threads);
+        }
+    }
+    delete[] buffer;
+    for (i = 0; i < threads; ++i) delete hashTables[i];
+    delete[] hashTables;
+    return result;
+}
+
+
 OFCondition DcmQuant::createPaletteColorImage(
     DicomImage& sourceImage,
     DcmItem& target,
@@ -48,7 +279,9 @@ OFCondition DcmQuant::createPaletteColorImage(
     Uint32 numberOfColors,
     OFString& description,
     DcmLargestDimensionType largeType,
-    DcmRepresentativeColorType repType)
+    DcmRepresentativeColorType repType,
+    Uint32 kmeansIterations,
+    Uint32 numberOfThreads)
 {
     // make sure we're operating on a color image
     if (sourceImage.isMonochrome()) return EC_IllegalCall;
@@ -78,21 +311,20 @@ OFCondition DcmQuant::createPaletteColorImage(
     DcmQuantColorTable colormap;
     result = colormap.medianCut(chv, cols * rows * frames, maxval, numberOfColors, largeType, repType);
     if (result.bad()) return result;
+
+    // optionally improve the colormap by k-means clustering
+    if (kmeansIterations > 0)
+    {
+      DCMIMAGE_DEBUG("refining color map using k-means clustering (max. " << kmeansIterations << " iterations)");
+      result = colormap.refine(chv, kmeansIterations);
+      if (result.bad()) return result;
+    }
     chv.clear(); // frees most memory used by chv.
 
     // map the colors in the image to their closest match in the
     // new colormap, and write 'em out.
-    DcmQuantColorHashTable cht;
     DCMIMAGE_DEBUG("mapping image data to color table");
 
-    DcmQuantFloydSteinberg fs;
-    if (floydSteinberg)
-    {
-      result = fs.initialize(cols);
-      if (result.bad()) return result;
-    }
-    DcmQuantIdent id(cols);
-
     register OFBool isByteData = (numberOfColors <= 256);
 
     // compute size requirement for palette color pixel data in bytes
@@ -113,24 +345,13 @@ OFCondition DcmQuant::createPaletteColorImage(
          result = target.insert(pixelData, OFTrue);
          if (result.good())
          {
-            for (unsigned long ff=0; ff<frames; ff++)
-            {
-              if (isByteData)
-              {
-                if (floydSteinberg)
-                  DcmQuantColorMapping<DcmQuantFloydSteinberg,Uint8>::create(sourceImage, ff, maxval, cht, colormap, fs, imageData8  + cols*rows*ff);
-                  else DcmQuantColorMapping<DcmQuantIdent,    Uint8>::create(sourceImage, ff, maxval, cht, colormap, id, imageData8  + cols*rows*ff);
-              }
-              else
-              {
-                if (floydSteinberg)
-                  DcmQuantColorMapping<DcmQuantFloydSteinberg,Uint16>::create(sourceImage, ff, maxval, cht, colormap, fs, imageData16 + cols*rows*ff);
-                  else DcmQuantColorMapping<DcmQuantIdent,    Uint16>::create(sourceImage, ff, maxval, cht, colormap, id, imageData16 + cols*rows*ff);
-             }
-            } // for all frames
+            if (isByteData)
+              result = mapColorImage(sourceImage, maxval, colormap, floydSteinberg, numberOfThreads, imageData8);
+            else
+              result = mapColorImage(sourceImage, maxval, colormap, floydSteinberg, numberOfThreads, imageData16);
 
             // image creation is complete, finally adjust byte order if necessary
-            if (isByteData)
+            if (result.good() && isByteData)
             {
               result = swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, imageData16, totalSize, sizeof(Uint16));
             }
@@ -0,0 +1,32 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimage
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: main test program
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oftest.h"
+
+OFTEST_REGISTER(dcmimage_quantComputeIndex);
+OFTEST_REGISTER(dcmimage_quantRefine);
+OFTEST_REGISTER(dcmimage_quantRefineKnownResult);
+OFTEST_REGISTER(dcmimage_ybrFullToRGB_8bit);
+OFTEST_REGISTER(dcmimage_ybrFullToRGB_12bit);
+OFTEST_REGISTER(dcmimage_ybrFull422ToRGB);
+OFTEST_MAIN("dcmimage")
@@ -0,0 +1,248 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimage
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the color table of the color quantization
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimage/diregist.h"   /* include to support color images */
+#include "dcmtk/dcmimage/diqtctab.h"
+#include "dcmtk/dcmimage/diqthitm.h"
+#include "dcmtk/dcmimage/diqtpix.h"
+#include "dcmtk/ofstd/ofvector.h"
+
+
+/* create an RGB image with the given colors (three values per pixel) */
+static DicomImage *createImage(DcmDataset &dataset,
+                               const Uint8 *colors,
+                               const Uint16 columns,
+                               const Uint16 rows)
+{
+    dataset.putAndInsertString(DCM_PhotometricInterpretation, "RGB");
+    dataset.putAndInsertUint16(DCM_SamplesPerPixel, 3);
+    dataset.putAndInsertUint16(DCM_PlanarConfiguration, 0);
+    dataset.putAndInsertUint16(DCM_Rows, rows);
+    dataset.putAndInsertUint16(DCM_Columns, columns);
+    dataset.putAndInsertUint16(DCM_BitsAllocated, 8);
+    dataset.putAndInsertUint16(DCM_BitsStored, 8);
+    dataset.putAndInsertUint16(DCM_HighBit, 7);
+    dataset.putAndInsertUint16(DCM_PixelRepresentation, 0);
+    dataset.putAndInsertUint8Array(DCM_PixelData, colors, 3 * OFstatic_cast(unsigned long, columns) * rows);
+    return new DicomImage(&dataset, EXS_LittleEndianExplicit);
+}
+
+
+/* create an image with pseudo-random colors and compute its histogram */
+static OFBool createHistogram(DcmQuantColorTable &histogram,
+                              unsigned long &pixels)
+{
+    const Uint16 columns = 64;
+    const Uint16 rows = 64;
+    pixels = OFstatic_cast(unsigned long, columns) * rows;
+    Uint8 *colors = new Uint8[3 * pixels];
+    Uint32 seed = 4711;
+    for (unsigned long i = 0; i < 3 * pixels; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        colors[i] = OFstatic_cast(Uint8, seed >> 24);
+    }
+    DcmDataset dataset;
+    DicomImage *image = createImage(dataset, colors, columns, rows);
+    delete[] colors;
+    const OFBool result = (image->getStatus() == EIS_Normal) &&
+        histogram.computeHistogram(*image, 32767).good();
+    delete image;
+    return result;
+}
+
+
+/* find the nearest color of the table by comparing all entries, the smallest index wins in case of a tie */
+static int findNearestColor(const DcmQuantColorTable &table,
+                            const DcmQuantPixel &px)
+{
+    int result = -1;
+    long dist = 0;
+    for (unsigned long i = 0; i < table.getColors(); ++i)
+    {
+        const long dr = OFstatic_cast(long, px.getRed()) - table.getRed(i);
+        const long dg = OFstatic_cast(long, px.getGreen()) - table.getGreen(i);
+        const long db = OFstatic_cast(long, px.getBlue()) - table.getBlue(i);
+        const long newdist = dr * dr + dg * dg + db * db;
+        if ((result < 0) || (newdist < dist))
+        {
+            result = OFstatic_cast(int, i);
+            dist = newdist;
+        }
+    }
+    return result;
+}
+
+
+/* check computeIndex() against the exhaustive search for the colors of the histogram and a grid of colors */
+static void checkNearestColors(const DcmQuantColorTable &table,
+                               const DcmQuantColorTable &histogram)
+{
+    unsigned long errors = 0;
+    unsigned long i;
+    for (i = 0; i < histogram.getColors(); ++i)
+    {
+        if (table.computeIndex(histogram.getPixel(i)) != findNearestColor(table, histogram.getPixel(i)))
+            ++errors;
+    }
+    DcmQuantPixel px;
+    for (int r = 0; r < 256; r += 5)
+    {
+        for (int g = 0; g < 256; g += 5)
+        {
+            for (int b = 0; b < 256; b += 5)
+            {
+                px.assign(OFstatic_cast(DcmQuantComponent, r), OFstatic_cast(DcmQuantComponent, g),
+                    OFstatic_cast(DcmQuantComponent, b));
+                if (table.computeIndex(px) != findNearestColor(table, px))
+                    ++errors;
+            }
+        }
+    }
+    OFCHECK_EQUAL(errors, 0);
+}
+
+
+/* compute the sum of the squared distances of the colors of the histogram to their nearest entry of the table */
+static double computeError(const DcmQuantColorTable &table,
+                           const DcmQuantColorTable &histogram)
+{
+    double result = 0;
+    for (unsigned long i = 0; i < histogram.getColors(); ++i)
+    {
+        const DcmQuantHistogramItem &item = OFstatic_cast(const DcmQuantHistogramItem &, histogram.getPixel(i));
+        const int idx = findNearestColor(table, item);
+        const double dr = OFstatic_cast(double, item.getRed()) - table.getRed(idx);
+        const double dg = OFstatic_cast(double, item.getGreen()) - table.getGreen(idx);
+        const double db = OFstatic_cast(double, item.getBlue()) - table.getBlue(idx);
+        result += item.getValue() * (dr * dr + dg * dg + db * db);
+    }
+    return result;
+}
+
+
+OFTEST(dcmimage_quantComputeIndex)
+{
+    DcmQuantColorTable histogram;
+    unsigned long pixels = 0;
+    OFCHECK(createHistogram(histogram, pixels));
+    OFCHECK_EQUAL(histogram.getMaxVal(), 255);
+
+    // different numbers of colors, the sorted search must always find the same entry as the exhaustive one
+    const unsigned long numberOfColors[] = { 1, 2, 37, 256 };
+    for (size_t i = 0; i < sizeof(numberOfColors) / sizeof(numberOfColors[0]); ++i)
+    {
+        DcmQuantColorTable table;
+        OFCHECK(table.medianCut(histogram, pixels, histogram.getMaxVal(), numberOfColors[i],
+            DcmLargestDimensionType_default, DcmRepresentativeColorType_default).good());
+        OFCHECK_EQUAL(table.getColors(), numberOfColors[i]);
+        checkNearestColors(table, histogram);
+        OFCHECK(table.refine(histogram, 5).good());
+        checkNearestColors(table, histogram);
+    }
+
+    // a table with few entries and many colors at the same distance to two of them,
+    // the smallest index has to be returned in this case
+    Uint8 colors[] = { 0, 0, 0,  100, 50, 50,  100, 50, 50,  200, 50, 50,  0, 0, 0,  200, 50, 50 };
+    DcmDataset dataset;
+    DicomImage *image = createImage(dataset, colors, 6, 1);
+    DcmQuantColorTable duplicates;
+    OFCHECK(duplicates.computeHistogram(*image, 32767).good());
+    delete image;
+    DcmQuantColorTable table;
+    OFCHECK(table.medianCut(duplicates, 6, duplicates.getMaxVal(), 3,
+        DcmLargestDimensionType_default, DcmRepresentativeColorType_default).good());
+    OFCHECK(table.refine(duplicates, 1).good());
+    checkNearestColors(table, duplicates);
+}
+
+
+OFTEST(dcmimage_quantRefine)
+{
+    DcmQuantColorTable histogram;
+    unsigned long pixels = 0;
+    OFCHECK(createHistogram(histogram, pixels));
+
+    DcmQuantColorTable table;
+    OFCHECK(table.medianCut(histogram, pixels, histogram.getMaxVal(), 37,
+        DcmLargestDimensionType_default, DcmRepresentativeColorType_default).good());
+
+    // no iterations, the color table remains unchanged
+    OFVector<DcmQuantPixel> original;
+    unsigned long i;
+    for (i = 0; i < table.getColors(); ++i)
+        original.push_back(table.getPixel(i));
+    OFCHECK(table.refine(histogram, 0).good());
+    OFCHECK_EQUAL(table.getColors(), original.size());
+    for (i = 0; i < table.getColors(); ++i)
+        OFCHECK(table.getPixel(i) == original[i]);
+
+    // each iteration must not increase the quantization error
+    double error = computeError(table, histogram);
+    const double initialError = error;
+    for (i = 0; i < 10; ++i)
+    {
+        OFCHECK(table.refine(histogram, 1).good());
+        const double newError = computeError(table, histogram);
+        OFCHECK(newError <= error);
+        error = newError;
+    }
+    OFCHECK(error < initialError);
+}
+
+
+OFTEST(dcmimage_quantRefineKnownResult)
+{
+    // two clusters of colors, the weighted mean of the first one is rounded
+    Uint8 colors[] = { 10, 10, 10,  10, 10, 10,  10, 10, 10,  20, 10, 10,
+                       200, 100, 50,  200, 100, 50,  210, 110, 50,  210, 110, 50 };
+    DcmDataset dataset;
+    DicomImage *image = createImage(dataset, colors, 4, 2);
+    OFCHECK(image->getStatus() == EIS_Normal);
+    DcmQuantColorTable histogram;
+    OFCHECK(histogram.computeHistogram(*image, 32767).good());
+    delete image;
+    OFCHECK_EQUAL(histogram.getColors(), 4);
+
+    DcmQuantColorTable table;
+    OFCHECK(table.medianCut(histogram, 8, histogram.getMaxVal(), 2,
+        DcmLargestDimensionType_default, DcmRepresentativeColorType_default).good());
+    OFCHECK(table.refine(histogram, 10).good());
+    OFCHECK_EQUAL(table.getColors(), 2);
+    if (table.getColors() == 2)
+    {
+        // the order of the entries depends on the median cut
+        const unsigned long dark = (table.getRed(0) < table.getRed(1)) ? 0 : 1;
+        OFCHECK_EQUAL(table.getRed(dark), 13);
+        OFCHECK_EQUAL(table.getGreen(dark), 10);
+        OFCHECK_EQUAL(table.getBlue(dark), 10);
+        OFCHECK_EQUAL(table.getRed(1 - dark), 205);
+        OFCHECK_EQUAL(table.getGreen(1 - dark), 105);
+        OFCHECK_EQUAL(table.getBlue(1 - dark), 50);
+    }
+}
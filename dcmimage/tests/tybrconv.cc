@@ -0,0 +1,319 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimage
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the conversion of YCbCr pixel data to RGB
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimage/diregist.h"   /* include to support color images */
+
+#define INCLUDE_CSTDIO
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/* The YCbCr to RGB conversion uses fixed-point lookup tables for up to 12 bits
+ * per sample. The following tests check for full and full 4:2:2 input that the
+ * result is the exact result of the conversion formula. Since all coefficients
+ * are multiples of 0.0001, the formula can be computed with integer numbers.
+ * Compared with the floating-point implementation that has been used before
+ * (except for unsigned 8 bit data), the results may only differ if the exact
+ * value is an integer, which the floating-point computation sometimes misses.
+ */
+
+/* convert a single YCbCr value with the floating-point formula used before */
+static void convertFloat(const unsigned long y,
+                         const unsigned long cb,
+                         const unsigned long cr,
+                         const unsigned long maxvalue,
+                         unsigned long rgb[3])
+{
+    const double max = OFstatic_cast(double, maxvalue);
+    const double dr = OFstatic_cast(double, y) + 1.4020 * OFstatic_cast(double, cr) - 0.7010 * max;
+    const double dg = OFstatic_cast(double, y) - 0.3441 * OFstatic_cast(double, cb) - 0.7141 * OFstatic_cast(double, cr) + 0.5291 * max;
+    const double db = OFstatic_cast(double, y) + 1.7720 * OFstatic_cast(double, cb) - 0.8859 * max;
+    rgb[0] = (dr < 0.0) ? 0 : (dr > max) ? maxvalue : OFstatic_cast(unsigned long, dr);
+    rgb[1] = (dg < 0.0) ? 0 : (dg > max) ? maxvalue : OFstatic_cast(unsigned long, dg);
+    rgb[2] = (db < 0.0) ? 0 : (db > max) ? maxvalue : OFstatic_cast(unsigned long, db);
+}
+
+
+/* convert a single YCbCr value with the same formula in units of 0.0001 */
+static void convertExact(const long y,
+                         const long cb,
+                         const long cr,
+                         const long maxvalue,
+                         long value[3],
+                         unsigned long rgb[3])
+{
+    value[0] = 10000 * y + 14020 * cr - 7010 * maxvalue;
+    value[1] = 10000 * y - 3441 * cb - 7141 * cr + 5291 * maxvalue;
+    value[2] = 10000 * y + 17720 * cb - 8859 * maxvalue;
+    for (int c = 0; c < 3; ++c)
+        rgb[c] = (value[c] < 0) ? 0 : (value[c] > 10000 * maxvalue) ? maxvalue : value[c] / 10000;
+}
+
+
+/* description of the YCbCr input (the sample values are always unsigned, i.e. without sign) */
+struct YBRInput
+{
+    const char *photometricInterpretation;
+    Uint16 bitsStored;
+    Uint16 pixelRepresentation;
+    Uint16 planarConfiguration;
+    Uint16 columns;
+    Uint16 rows;
+    Uint16 frames;
+    // samples in the order Y, Cb, Cr for each pixel
+    OFVector<Uint16> samples;
+
+    Uint16 bitsAllocated() const
+    {
+        return (bitsStored > 8) ? 16 : 8;
+    }
+};
+
+
+/* create a dataset from the given input */
+static void createDataset(DcmDataset &dataset,
+                          const YBRInput &input)
+{
+    const unsigned long pixels = OFstatic_cast(unsigned long, input.columns) * input.rows;
+    const OFBool ybr422 = (strcmp(input.photometricInterpretation, "YBR_FULL_422") == 0);
+    const unsigned long offset = (input.pixelRepresentation == 1) ? (1UL << (input.bitsStored - 1)) : 0;
+    const unsigned long mask = (input.bitsAllocated() > 8) ? 0xffff : 0xff;
+    // 4:2:2 data contains two samples per pixel, all other data three
+    OFVector<Uint16> values((ybr422 ? 2 : 3) * pixels * input.frames);
+    Uint16 *q = &values[0];
+    unsigned long i;
+    for (unsigned long f = 0; f < input.frames; ++f)
+    {
+        const Uint16 *frame = &input.samples[3 * pixels * f];
+        if (ybr422)
+        {
+            // Y1 Y2 Cb Cr, the chroma values of the second pixel are ignored
+            for (i = 0; i < pixels; i += 2)
+            {
+                *(q++) = OFstatic_cast(Uint16, (frame[3 * i] - offset) & mask);
+                *(q++) = OFstatic_cast(Uint16, (frame[3 * i + 3] - offset) & mask);
+                *(q++) = OFstatic_cast(Uint16, (frame[3 * i + 1] - offset) & mask);
+                *(q++) = OFstatic_cast(Uint16, (frame[3 * i + 2] - offset) & mask);
+            }
+        }
+        else if (input.planarConfiguration == 1)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                for (i = 0; i < pixels; ++i)
+                    *(q++) = OFstatic_cast(Uint16, (frame[3 * i + c] - offset) & mask);
+            }
+        } else {
+            for (i = 0; i < 3 * pixels; ++i)
+                *(q++) = OFstatic_cast(Uint16, (frame[i] - offset) & mask);
+        }
+    }
+    dataset.putAndInsertString(DCM_PhotometricInterpretation, input.photometricInterpretation);
+    dataset.putAndInsertUint16(DCM_SamplesPerPixel, 3);
+    dataset.putAndInsertUint16(DCM_PlanarConfiguration, ybr422 ? 0 : input.planarConfiguration);
+    dataset.putAndInsertUint16(DCM_Rows, input.rows);
+    dataset.putAndInsertUint16(DCM_Columns, input.columns);
+    if (input.frames > 1)
+    {
+        char buf[16];
+        sprintf(buf, "%u", input.frames);
+        dataset.putAndInsertString(DCM_NumberOfFrames, buf);
+    }
+    dataset.putAndInsertUint16(DCM_BitsAllocated, input.bitsAllocated());
+    dataset.putAndInsertUint16(DCM_BitsStored, input.bitsStored);
+    dataset.putAndInsertUint16(DCM_HighBit, input.bitsStored - 1);
+    dataset.putAndInsertUint16(DCM_PixelRepresentation, input.pixelRepresentation);
+    if (input.bitsAllocated() > 8)
+        dataset.putAndInsertUint16Array(DCM_PixelData, &values[0], values.size());
+    else {
+        OFVector<Uint8> bytes(values.size());
+        for (i = 0; i < values.size(); ++i)
+            bytes[i] = OFstatic_cast(Uint8, values[i]);
+        dataset.putAndInsertUint8Array(DCM_PixelData, &bytes[0], bytes.size());
+    }
+}
+
+
+/* compare the intermediate RGB data with the exact result and the result of the floating-point formula */
+template<class T>
+static void compareData(const T * const *data,
+                        const YBRInput &input,
+                        unsigned long &errors,
+                        unsigned long &differences)
+{
+    const OFBool ybr422 = (strcmp(input.photometricInterpretation, "YBR_FULL_422") == 0);
+    const unsigned long maxvalue = (1UL << input.bitsStored) - 1;
+    const unsigned long count = OFstatic_cast(unsigned long, input.columns) * input.rows * input.frames;
+    long value[3];
+    unsigned long exact[3];
+    unsigned long rgb[3];
+    errors = 0;
+    differences = 0;
+    for (unsigned long i = 0; i < count; ++i)
+    {
+        // both pixels of a pair use the chroma values of the first one
+        const Uint16 *chroma = &input.samples[3 * ((ybr422) ? (i & ~1UL) : i)];
+        convertExact(input.samples[3 * i], chroma[1], chroma[2], maxvalue, value, exact);
+        convertFloat(input.samples[3 * i], chroma[1], chroma[2], maxvalue, rgb);
+        for (int c = 0; c < 3; ++c)
+        {
+            if (data[c][i] != exact[c])
+                ++errors;
+            else if ((data[c][i] != rgb[c]) && ((value[c] % 10000 != 0) || (data[c][i] != rgb[c] + 1)))
+                ++differences;
+        }
+    }
+}
+
+
+/* convert the given input with the given number of threads and check the result */
+static void checkConversion(const YBRInput &input,
+                            const Uint32 threads)
+{
+    DcmDataset dataset;
+    createDataset(dataset, input);
+    DicomImage image(&dataset, EXS_LittleEndianExplicit, 0, 0, 0, threads);
+    OFCHECK(image.getStatus() == EIS_Normal);
+    const DiPixel *pixel = image.getInterData();
+    OFCHECK(pixel != NULL);
+    if (pixel != NULL)
+    {
+        OFCHECK_EQUAL(pixel->getCount(), OFstatic_cast(unsigned long, input.columns) * input.rows * input.frames);
+        unsigned long errors = 0;
+        unsigned long differences = 0;
+        if (input.bitsStored > 8)
+        {
+            OFCHECK(pixel->getRepresentation() == EPR_Uint16);
+            compareData(OFstatic_cast(const Uint16 * const *, pixel->getData()), input, errors, differences);
+        } else {
+            OFCHECK(pixel->getRepresentation() == EPR_Uint8);
+            compareData(OFstatic_cast(const Uint8 * const *, pixel->getData()), input, errors, differences);
+        }
+        OFCHECK_EQUAL(errors, 0);
+        // other differences to the floating-point formula
+        OFCHECK_EQUAL(differences, 0);
+    }
+}
+
+
+/* create input with pseudo-random sample values, including the minimum and maximum values */
+static void createRandomInput(YBRInput &input)
+{
+    const unsigned long maxvalue = (1UL << input.bitsStored) - 1;
+    const unsigned long count = 3 * OFstatic_cast(unsigned long, input.columns) * input.rows * input.frames;
+    input.samples.resize(count);
+    Uint32 seed = 4711;
+    for (unsigned long i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        input.samples[i] = OFstatic_cast(Uint16, (seed >> 8) % (maxvalue + 1));
+    }
+    // all combinations of minimum and maximum values (the chroma values of both pixels are equal)
+    for (unsigned long j = 0; j < 8; ++j)
+    {
+        for (unsigned long k = 0; k < 2; ++k)
+        {
+            input.samples[6 * j + 3 * k] = OFstatic_cast(Uint16, (j & 1) ? maxvalue : 0);
+            input.samples[6 * j + 3 * k + 1] = OFstatic_cast(Uint16, (j & 2) ? maxvalue : 0);
+            input.samples[6 * j + 3 * k + 2] = OFstatic_cast(Uint16, (j & 4) ? maxvalue : 0);
+        }
+    }
+}
+
+
+OFTEST(dcmimage_ybrFullToRGB_8bit)
+{
+    // all combinations of Cb and Cr for every fifth value of Y, one frame per value of Y
+    YBRInput input;
+    input.photometricInterpretation = "YBR_FULL";
+    input.bitsStored = 8;
+    input.columns = 256;
+    input.rows = 256;
+    input.frames = 52;
+    input.samples.resize(3 * 256 * 256 * 52);
+    Uint16 *p = &input.samples[0];
+    for (Uint16 y = 0; y < 256; y += 5)
+    {
+        for (Uint16 cr = 0; cr < 256; ++cr)
+        {
+            for (Uint16 cb = 0; cb < 256; ++cb)
+            {
+                *(p++) = y;
+                *(p++) = cb;
+                *(p++) = cr;
+            }
+        }
+    }
+    for (input.pixelRepresentation = 0; input.pixelRepresentation <= 1; ++input.pixelRepresentation)
+    {
+        input.planarConfiguration = 0;
+        checkConversion(input, 1);
+        input.planarConfiguration = 1;
+        checkConversion(input, 4);
+    }
+}
+
+
+OFTEST(dcmimage_ybrFullToRGB_12bit)
+{
+    YBRInput input;
+    input.photometricInterpretation = "YBR_FULL";
+    input.bitsStored = 12;
+    input.columns = 512;
+    input.rows = 512;
+    input.frames = 3;
+    createRandomInput(input);
+    for (input.pixelRepresentation = 0; input.pixelRepresentation <= 1; ++input.pixelRepresentation)
+    {
+        input.planarConfiguration = 0;
+        checkConversion(input, 1);
+        input.planarConfiguration = 1;
+        checkConversion(input, 4);
+    }
+}
+
+
+OFTEST(dcmimage_ybrFull422ToRGB)
+{
+    YBRInput input;
+    input.photometricInterpretation = "YBR_FULL_422";
+    input.planarConfiguration = 0;
+    input.columns = 256;
+    input.rows = 256;
+    input.frames = 2;
+    for (input.bitsStored = 8; input.bitsStored <= 12; input.bitsStored += 4)
+    {
+        createRandomInput(input);
+        for (input.pixelRepresentation = 0; input.pixelRepresentation <= 1; ++input.pixelRepresentation)
+        {
+            checkConversion(input, 1);
+            checkConversion(input, 4);
+        }
+    }
+}
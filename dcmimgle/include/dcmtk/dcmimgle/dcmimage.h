@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2014, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -70,11 +70,14 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  fstart    first frame to be processed (optional, 0 = 1st frame), all subsequent use
      *                    of parameters labeled 'frame' in this class refers to this start frame.
      *  @param  fcount    number of frames (optional, 0 = all frames)
+     *  @param  threads   maximum number of threads used for processing the pixel data, e.g. color
+     *                    conversion or scaling (optional, only if DCMTK is compiled with thread support)
      */
     DicomImage(const char *filename,
                const unsigned long flags = 0,
                const unsigned long fstart = 0,
-               const unsigned long fcount = 0);
+               const unsigned long fcount = 0,
+               const Uint32 threads = 1);
 
 #ifndef STARVIEW
     /** constructor, use a given DcmObject
@@ -89,12 +92,15 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  fstart  first frame to be processed (optional, 0 = 1st frame), all subsequent use
      *                  of parameters labeled 'frame' in this class refers to this start frame.
      *  @param  fcount  number of frames (optional, 0 = all frames)
+     *  @param  threads maximum number of threads used for processing the pixel data, e.g. color
+     *                  conversion or scaling (optional, only if DCMTK is compiled with thread support)
      */
     DicomImage(DcmObject *object,
                const E_TransferSyntax xfer,
                const unsigned long flags = 0,
                const unsigned long fstart = 0,
-               const unsigned long fcount = 0);
+               const unsigned long fcount = 0,
+               const Uint32 threads = 1);
 
     /** constructor, use a given DcmObject with specified rescale/slope.
      *  NB: This constructor ignores the Photometric Interpretation stored in the DICOM dataset
@@ -112,6 +118,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  fstart     first frame to be processed (optional, 0 = 1st frame), all subsequent use
      *                     of parameters labeled 'frame' in this class refers to this start frame.
      *  @param  fcount     number of frames (optional, 0 = all frames)
+     *  @param  threads    maximum number of threads used for processing the pixel data, e.g. color
+     *                     conversion or scaling (optional, only if DCMTK is compiled with thread support)
      */
     DicomImage(DcmObject *object,
                const E_TransferSyntax xfer,
@@ -119,7 +127,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
                const double intercept,
                const unsigned long flags = 0,
                const unsigned long fstart = 0,
-               const unsigned long fcount = 0);
+               const unsigned long fcount = 0,
+               const Uint32 threads = 1);
 
     /** constructor, use a given DcmObject with specified modality LUT.
      *  NB: This constructor ignores the Photometric Interpretation stored in the DICOM dataset
@@ -138,6 +147,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  fstart       first frame to be processed (optional, 0 = 1st frame), all subsequent use
      *                       of parameters labeled 'frame' in this class refers to this start frame.
      *  @param  fcount       number of frames (optional, 0 = all frames)
+     *  @param  threads      maximum number of threads used for processing the pixel data, e.g. color
+     *                       conversion or scaling (optional, only if DCMTK is compiled with thread support)
      */
     DicomImage(DcmObject *object,
                E_TransferSyntax xfer,
@@ -146,7 +157,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
                const DcmLongString *explanation = NULL,
                const unsigned long flags = 0,
                const unsigned long fstart = 0,
-               const unsigned long fcount = 0);
+               const unsigned long fcount = 0,
+               const Uint32 threads = 1);
 #endif
 
     /** destructor
@@ -451,6 +463,52 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
             Image->getOutputData(buffer, size, frame, Image->getBits(bits), planar) : 0;
     }
 
+    /** render specified (clipping) area of a frame and output to given memory buffer.
+     *  The area is scaled to the given size, i.e. only the pixels of the area are processed
+     *  and the VOI/PLUT transformation is only applied to the pixels of the scaled area. This
+     *  is much more efficient than rendering the whole frame, e.g. for tiled or zoomed display
+     *  of large images. Parts of the area outside the image are filled with 'pvalue'.
+     *  Otherwise, the same restrictions as for getOutputData() apply.
+     *
+     ** @param  buffer        pointer to memory buffer (must already be allocated). The required
+     *                        size is 'scale_width' * 'scale_height' * number of samples per pixel
+     *                        * number of bytes per sample (e.g. 2 if 'bits' is greater than 8).
+     *  @param  size          size of memory buffer (will be checked whether it is sufficient)
+     *  @param  left_pos      x coordinate of top left corner of area to be rendered
+     *                        (referring to image origin, negative values create a border around the image)
+     *  @param  top_pos       y coordinate of top left corner of area to be rendered
+     *  @param  clip_width    width of area to be rendered (> 0)
+     *  @param  clip_height   height of area to be rendered (> 0)
+     *  @param  scale_width   width of rendered area (in pixels, 0 = no scaling)
+     *  @param  scale_height  height of rendered area (in pixels, 0 = no scaling)
+     *  @param  bits          number of bits per sample used to render the pixel data
+     *                        (image depth, 1..MAX_BITS, 0 means 'bits stored' in the image)
+     *  @param  frame         number of frame to be rendered (0..n-1)
+     *  @param  interpolate   specifies whether scaling algorithm should use interpolation (if necessary).
+     *                        default: no interpolation (0), preferred interpolation algorithm (if applicable):
+     *                          1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
+     *                          4 = bicubic magnification, 5 = area averaging reduction
+     *  @param  planar        0 = color-by-pixel (R1G1B1...R2G2B2...R3G3B3...),
+     *                        1 = color-by-plane (R1R2R3...G1G2G3...B1B2B3...)
+     *                        (only applicable to multi-planar/color images, otherwise ignored)
+     *  @param  pvalue        P-value used for the border outside the image (0..65535)
+     *
+     ** @return status code (true if successful)
+     */
+    int getRegionOutputData(void *buffer,
+                            const unsigned long size,
+                            const signed long left_pos,
+                            const signed long top_pos,
+                            const unsigned long clip_width,
+                            const unsigned long clip_height,
+                            unsigned long scale_width = 0,
+                            unsigned long scale_height = 0,
+                            const int bits = 0,
+                            const unsigned long frame = 0,
+                            const int interpolate = 0,
+                            const int planar = 0,
+                            const Uint16 pvalue = 0) const;
+
     /** render pixel data and return pointer to given plane (internal memory buffer).
      *  apply VOI/PLUT transformation and (visible) overlay planes
      *  internal memory buffer will be delete for the next getBitmap/Output operation.
@@ -1371,7 +1429,7 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate  specifies whether scaling algorithm should use interpolation (if necessary).
      *                       default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                         1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                         4 = bicubic magnification
+     *                         4 = bicubic magnification, 5 = area averaging reduction
      *  @param  aspect       specifies whether pixel aspect ratio should be taken into consideration
      *                       (if true, width OR height should be 0, i.e. this component will be calculated
      *                        automatically)
@@ -1391,7 +1449,7 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate  specifies whether scaling algorithm should use interpolation (if necessary).
      *                       default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                         1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                         4 = bicubic magnification
+     *                         4 = bicubic magnification, 5 = area averaging reduction
      *  @param  aspect       specifies whether pixel aspect ratio should be taken into consideration
      *                       (if true, width OR height should be 0, i.e. this component will be calculated
      *                        automatically)
@@ -1405,7 +1463,6 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
 
     /** create scaled copy of specified (clipping) area of the current image object.
      *  memory is not handled internally - must be deleted from calling program.
-     *  NB: Clipping and interpolated scaling at the same moment is not yet fully implemented!
      *
      ** @param  left_pos      x coordinate of top left corner of area to be scaled
      *                        (referring to image origin, negative values create a border around the image)
@@ -1417,7 +1474,7 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate   specifies whether scaling algorithm should use interpolation (if necessary).
      *                        default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                          1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                          4 = bicubic magnification
+     *                          4 = bicubic magnification, 5 = area averaging reduction
      *  @param  aspect        specifies whether pixel aspect ratio should be taken into consideration
      *                        (if true, width OR height should be 0, i.e. this component will be calculated
      *                         automatically)
@@ -1437,7 +1494,6 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
 
     /** create scaled copy of specified (clipping) area of the current image object.
      *  memory is not handled internally - must be deleted from calling program.
-     *  NB: Clipping and interpolated scaling at the same moment is not yet fully implemented!
      *
      ** @param  left_pos     x coordinate of top left corner of area to be scaled
      *                       (referring to image origin, negative values create a border around the image)
@@ -1449,7 +1505,7 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate  specifies whether scaling algorithm should use interpolation (if necessary).
      *                       default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                         1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                         4 = bicubic magnification
+     *                         4 = bicubic magnification, 5 = area averaging reduction
      *  @param  aspect       specifies whether pixel aspect ratio should be taken into consideration
      *                       (if true, width OR height should be 0, i.e. this component will be calculated
      *                        automatically)
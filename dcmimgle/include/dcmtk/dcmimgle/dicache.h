@@ -0,0 +1,294 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomFrameCache (Header)
+ *
+ */
+
+
+#ifndef DICACHE_H
+#define DICACHE_H
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofstring.h"
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"
+#endif
+
+#include "dcmtk/dcmimgle/diutils.h"
+
+
+/*------------------------*
+ *  forward declarations  *
+ *------------------------*/
+
+class DcmFileFormat;
+class DicomImage;
+class DiFramePrefetchThread;
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Class providing random access to the frames of a multi-frame image with bounded memory usage.
+ *  The frames of the given DICOM file are loaded on demand, i.e. only the pixel data of the
+ *  requested frame is read from the file (see CIF_UsePartialAccessToPixelData), decompressed
+ *  and transformed to the intermediate representation. The resulting single-frame images are
+ *  kept in a cache, and the least recently used frames are deleted as soon as the total size
+ *  exceeds the given limit. Optionally, the frames following the requested one are loaded by
+ *  a background thread (only if DCMTK is compiled with thread support), e.g. for cine display.
+ *  Since each frame is represented by a separate DicomImage object, the VOI/PLUT settings have
+ *  to be specified for each frame returned by getFrame().
+ */
+class DCMTK_DCMIMGLE_EXPORT DicomFrameCache
+{
+
+ public:
+
+    /** constructor. Open the given DICOM file and determine the number of frames.
+     *  The pixel data is not loaded until the first frame is requested.
+     *
+     ** @param  filename  name of the DICOM file
+     *  @param  flags     configuration flags (see diutils.h, CIF_UsePartialAccessToPixelData
+     *                    is always set, CIF_MayDetachPixelData and CIF_TakeOverExternalDataset
+     *                    are ignored)
+     *  @param  maxSize   maximum size of all cached frames in bytes (default: 64 MB)
+     *  @param  prefetch  number of frames to be loaded in advance (default: 0 = none)
+     */
+    DicomFrameCache(const char *filename,
+                    const unsigned long flags = 0,
+                    const unsigned long maxSize = 64 * 1024 * 1024,
+                    const unsigned long prefetch = 0);
+
+    /** destructor.
+     *  Waits for the background thread (if any) and deletes all cached frames.
+     */
+    virtual ~DicomFrameCache();
+
+    /** get status of the frame cache
+     *
+     ** @return status code (EIS_Normal if the file could be opened)
+     */
+    inline EI_Status getStatus() const
+    {
+        return Status;
+    }
+
+    /** get number of frames in the DICOM file
+     *
+     ** @return number of frames (0 if an error occurred)
+     */
+    inline unsigned long getNumberOfFrames() const
+    {
+        return NumberOfFrames;
+    }
+
+    /** get image object for the specified frame.
+     *  The frame is loaded from the file unless it is already in the cache. Afterwards, the
+     *  loading of the following frames is started in the background (if enabled).
+     *  Please note that the returned object is owned by the cache and may be deleted on any
+     *  subsequent call of this method, i.e. it should not be used any longer after that.
+     *
+     ** @param  frame  number of the frame (0..n-1)
+     *
+     ** @return pointer to single-frame image object (NULL if an error occurred)
+     */
+    DicomImage *getFrame(const unsigned long frame);
+
+    /** set maximum size of all cached frames.
+     *  The frame returned last by getFrame() is never removed from the cache, even if its
+     *  size exceeds the limit.
+     *
+     ** @param  maxSize  maximum size in bytes
+     */
+    void setMaxSize(const unsigned long maxSize);
+
+    /** set number of frames to be loaded in advance by a background thread.
+     *  The frames following the one requested last are loaded (continuing with the first
+     *  frame after the last one, e.g. for cine loops). The prefetching is only enabled if
+     *  DCMTK is compiled with thread support.
+     *
+     ** @param  prefetch  number of frames (0 = disable prefetching)
+     */
+    void setPrefetchCount(const unsigned long prefetch);
+
+    /** get current size of all cached frames
+     *
+     ** @return size in bytes
+     */
+    unsigned long getCacheSize();
+
+    /** get number of frames currently in the cache
+     *
+     ** @return number of frames
+     */
+    unsigned long getNumberOfCachedFrames();
+
+    /** check whether the specified frame is currently in the cache
+     *
+     ** @param  frame  number of the frame (0..n-1)
+     *
+     ** @return true if the frame is in the cache, false otherwise
+     */
+    OFBool isFrameCached(const unsigned long frame);
+
+    /** wait until the background thread (if any) has finished the loading of all frames
+     *  that have been requested for prefetching so far
+     */
+    void waitForPrefetch();
+
+
+ protected:
+
+    /** structure for a cached frame
+     */
+    struct Entry
+    {
+        /// number of the frame
+        unsigned long Frame;
+        /// image object containing this frame only
+        DicomImage *Image;
+        /// approximate size of the image object in bytes
+        unsigned long Size;
+    };
+
+    /** load the specified frame from the given DICOM file
+     *
+     ** @param  fileformat  DICOM file to be used (pixel data is read on demand)
+     *  @param  frame       number of the frame (0..n-1)
+     *
+     ** @return new entry for the given frame (NULL if an error occurred)
+     */
+    Entry *loadFrame(DcmFileFormat *fileformat,
+                     const unsigned long frame) const;
+
+    /** add given entry to the cache (as the most recently used one).
+     *  If the frame is already in the cache, the given entry is deleted. Then, the least
+     *  recently used frames are removed until the size limit is met. Needs to be called
+     *  with locked mutex.
+     *
+     ** @param  entry  entry to be added
+     *
+     ** @return entry of the frame in the cache
+     */
+    Entry *addEntry(Entry *entry);
+
+    /** get the cache entry for the given frame.
+     *  Needs to be called with locked mutex.
+     *
+     ** @param  frame  number of the frame (0..n-1)
+     *
+     ** @return pointer to entry (NULL if not found)
+     */
+    Entry *findEntry(const unsigned long frame);
+
+    /** remove least recently used frames until the size limit is met.
+     *  Needs to be called with locked mutex.
+     */
+    void removeEntries();
+
+    /** delete given entry (incl. image object)
+     *
+     ** @param  entry  entry to be deleted
+     */
+    static void deleteEntry(Entry *entry);
+
+    /** check whether the given frame is one of the frames to be loaded in advance.
+     *  Needs to be called with locked mutex.
+     *
+     ** @param  frame  number of the frame (0..n-1)
+     *
+     ** @return true if the frame is to be loaded in advance, false otherwise
+     */
+    OFBool isPrefetchFrame(const unsigned long frame) const;
+
+    /** determine next frame to be loaded by the background thread (if any).
+     *  Prefetching stops if the cache is full and the least recently used frame is the
+     *  current one or one of the frames loaded in advance. Needs to be called with locked
+     *  mutex.
+     *
+     ** @param  frame  reference to variable storing the frame number
+     *
+     ** @return true if a frame has to be loaded, false otherwise
+     */
+    OFBool getNextPrefetchFrame(unsigned long &frame);
+
+    /** load the frames requested for prefetching (called by the background thread)
+     */
+    void prefetchFrames();
+
+    /** start the background thread (if enabled and not already running).
+     *  Needs to be called with locked mutex.
+     */
+    void startPrefetch();
+
+
+ private:
+
+    /// the background thread calls the prefetchFrames() method
+    friend class DiFramePrefetchThread;
+
+    /// status of the frame cache
+    EI_Status Status;
+    /// name of the DICOM file
+    OFString Filename;
+    /// configuration flags used for the frames
+    unsigned long Flags;
+    /// number of frames in the DICOM file
+    unsigned long NumberOfFrames;
+
+    /// maximum size of all cached frames (in bytes)
+    unsigned long MaxSize;
+    /// current size of all cached frames (in bytes)
+    unsigned long CacheSize;
+    /// number of frames to be loaded in advance
+    unsigned long PrefetchCount;
+
+    /// list of cached frames (most recently used first)
+    OFList<Entry *> Entries;
+    /// number of the frame returned last by getFrame() (never removed from the cache)
+    unsigned long CurrentFrame;
+
+    /// DICOM file used for loading frames in the calling thread
+    DcmFileFormat *FileFormat;
+    /// DICOM file used for loading frames in the background thread
+    DcmFileFormat *PrefetchFileFormat;
+
+    /// size of the frame loaded last (in bytes, used to estimate the size of the next frame)
+    unsigned long FrameSize;
+
+#ifdef WITH_THREADS
+    /// mutex protecting the cache and the prefetch status
+    OFMutex Mutex;
+    /// background thread (NULL if not running)
+    DiFramePrefetchThread *PrefetchThread;
+    /// flag indicating whether the background thread is still running
+    OFBool PrefetchRunning;
+#endif
+
+ // --- declarations to avoid compiler warnings
+
+    DicomFrameCache(const DicomFrameCache &);
+    DicomFrameCache &operator=(const DicomFrameCache &);
+};
+
+
+#endif
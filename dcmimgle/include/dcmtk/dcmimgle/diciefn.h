@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2014, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -132,6 +132,12 @@ class DCMTK_DCMIMGLE_EXPORT DiCIELABFunction
      */
     DiDisplayLUT *getDisplayLUT(unsigned long count);
 
+    /** get type of the display function
+     *
+     ** @return type of the display function ("CIELAB")
+     */
+    virtual const char *getFunctionType() const;
+
 
  private:
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2014, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -50,7 +50,10 @@ class DiDisplayLUT;
  *---------------------*/
 
 /** Class to handle hardcopy and softcopy device characteristics file
- *  and manage display LUTs (for calibration)
+ *  and manage display LUTs (for calibration).
+ *  The display LUTs are stored in a process-wide cache, i.e. display function objects of the
+ *  same type with identical characteristic curve and parameters (e.g. ambient light) share
+ *  the same LUT, which is computed only once. Access to the cache is thread-safe.
  */
 class DCMTK_DCMIMGLE_EXPORT DiDisplayFunction
 {
@@ -215,7 +218,9 @@ class DCMTK_DCMIMGLE_EXPORT DiDisplayFunction
      */
     Uint16 getDDLforValue(const double value) const;
 
-    /** create look-up table with specified number of entries
+    /** create look-up table with specified number of entries.
+     *  The LUT is taken from the process-wide cache if it has already been computed for an
+     *  equivalent display function (see getFunctionType()).
      *
      ** @param  bits   depth of input values
      *  @param  count  number of LUT entries (default: 0 = computed automatically)
@@ -373,6 +378,20 @@ class DCMTK_DCMIMGLE_EXPORT DiDisplayFunction
                                  const double ambient,
                                  const double illum);
 
+    /** set maximum number of LUTs that are kept in the process-wide cache although they are
+     *  currently not used by any display function object (default: 16).
+     *  LUTs that are still used are never removed from the cache.
+     *
+     ** @param  count  maximum number of unused LUTs (0 = delete LUTs as soon as possible)
+     */
+    static void setLookupTableCacheSize(const unsigned long count);
+
+    /** get number of LUTs currently stored in the process-wide cache
+     *
+     ** @return number of cached LUTs (used and unused ones)
+     */
+    static unsigned long getNumberOfCachedLookupTables();
+
 
  protected:
 
@@ -384,6 +403,41 @@ class DCMTK_DCMIMGLE_EXPORT DiDisplayFunction
      */
     virtual DiDisplayLUT *getDisplayLUT(unsigned long count) = 0;
 
+    /** get type of the display function.
+     *  The type is used to identify equivalent display functions, i.e. a derived class that
+     *  computes its LUTs in a different way also has to return a different type. The LUTs of
+     *  display functions without a type are not shared with other display function objects.
+     *
+     ** @return type of the display function (default: NULL = none)
+     */
+    virtual const char *getFunctionType() const;
+
+    /** check whether the given LUT has been computed with the current parameters
+     *
+     ** @param  lut    pointer to the LUT to be checked
+     *  @param  count  number of LUT entries
+     *
+     ** @return true if the LUT is still valid, false otherwise
+     */
+    OFBool isCurrentLookupTable(const DiDisplayLUT *lut,
+                                const unsigned long count) const;
+
+    /** get LUT with the current parameters from the process-wide cache.
+     *  Needs to be called with locked cache.
+     *
+     ** @param  count  number of LUT entries
+     *
+     ** @return pointer to cached LUT (NULL if not found)
+     */
+    DiDisplayLUT *findLookupTable(const unsigned long count) const;
+
+    /** add given LUT (computed with the current parameters) to the process-wide cache.
+     *  Needs to be called with locked cache.
+     *
+     ** @param  lut  pointer to the LUT to be added
+     */
+    void addLookupTable(DiDisplayLUT *lut) const;
+
     /** read the given device characteristics file
      *
      ** @param  filename  name of the characteristics file
@@ -471,7 +525,7 @@ class DCMTK_DCMIMGLE_EXPORT DiDisplayFunction
     /// constant defining maximum value for number of bits for LUT input (here: 16)
     static const int MaxBits;
 
-    /// array with pointer to the different lookup tables (here: 8-16 bits)
+    /// array with pointer to the different lookup tables (here: 8-16 bits, owned by the cache)
     DiDisplayLUT *LookupTable[MAX_NUMBER_OF_TABLES];
 
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2014, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -68,11 +68,14 @@ class DCMTK_DCMIMGLE_EXPORT DiDocument
      *  @param  flags     configuration flags (only stored for later use)
      *  @param  fstart    first frame to be processed (only stored for later use)
      *  @param  fcount    number of frames (only stored for later use)
+     *  @param  threads   maximum number of threads used for processing the pixel data
+     *                    (only stored for later use)
      */
     DiDocument(const char *filename,
                const unsigned long flags = 0,
                const unsigned long fstart = 0,
-               const unsigned long fcount = 0);
+               const unsigned long fcount = 0,
+               const Uint32 threads = 1);
 
     /** constructor, use a given DcmObject
      *
@@ -82,12 +85,15 @@ class DCMTK_DCMIMGLE_EXPORT DiDocument
      *  @param  flags   configuration flags (only stored for later use)
      *  @param  fstart  first frame to be processed (only stored for later use)
      *  @param  fcount  number of frames (only stored for later use)
+     *  @param  threads maximum number of threads used for processing the pixel data
+     *                  (only stored for later use)
      */
     DiDocument(DcmObject *object,
                const E_TransferSyntax xfer,
                const unsigned long flags = 0,
                const unsigned long fstart = 0,
-               const unsigned long fcount = 0);
+               const unsigned long fcount = 0,
+               const Uint32 threads = 1);
 
     /** destructor
      */
@@ -147,6 +153,16 @@ class DCMTK_DCMIMGLE_EXPORT DiDocument
         return Flags;
     }
 
+    /** get maximum number of threads used for processing the pixel data,
+     *  e.g. for color conversion or scaling (if DCMTK is compiled with thread support)
+     *
+     ** @return maximum number of threads (at least 1)
+     */
+    inline Uint32 getNumberOfThreads() const
+    {
+        return NumberOfThreads;
+    }
+
     /** get transfer syntax of the DICOM dataset
      *
      ** @return transfer syntax
@@ -411,6 +427,9 @@ class DCMTK_DCMIMGLE_EXPORT DiDocument
     /// configuration flags
     unsigned long Flags;
 
+    /// maximum number of threads used for processing the pixel data
+    Uint32 NumberOfThreads;
+
     /// photometric interpretation (color model)
     OFString PhotometricInterpretation;
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2014, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -184,6 +184,12 @@ class DCMTK_DCMIMGLE_EXPORT DiGSDFunction
      */
     DiDisplayLUT *getDisplayLUT(unsigned long count);
 
+    /** get type of the display function
+     *
+     ** @return type of the display function ("GSDF")
+     */
+    virtual const char *getFunctionType() const;
+
     /** calculate GSDF (array of 1023 luminance/OD values)
      *
      ** @return status, true if successful, false otherwise
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2014, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -357,11 +357,13 @@ class DCMTK_DCMIMGLE_EXPORT DiImage
      *  @param  interpolate   specifies whether scaling algorithm should use interpolation (if necessary).
      *                        default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                          1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                          4 = bicubic magnification
+     *                          4 = bicubic magnification, 5 = area averaging reduction
      *  @param  aspect        specifies whether pixel aspect ratio should be taken into consideration
      *                        (if true, width OR height should be 0, i.e. this component will be calculated
      *                         automatically)
      *  @param  pvalue        P-value used for the border outside the image (0..65535)
+     *  @param  fstart        first frame to be scaled
+     *  @param  fcount        number of frames to be scaled (0 = all frames starting with 'fstart')
      *
      ** @return pointer to new DiImage object (NULL if an error occurred)
      */
@@ -373,7 +375,9 @@ class DCMTK_DCMIMGLE_EXPORT DiImage
                                  const unsigned long scale_height,
                                  const int interpolate,
                                  const int aspect,
-                                 const Uint16 pvalue) const = 0;
+                                 const Uint16 pvalue,
+                                 const unsigned long fstart,
+                                 const unsigned long fcount) const = 0;
 
     /** flip current image horizontally and/or vertically (abstract)
      *
@@ -556,11 +560,15 @@ class DCMTK_DCMIMGLE_EXPORT DiImage
      *  @param  width   number of columns of the new image
      *  @param  height  number of rows of the new image
      *  @param  aspect  flag indicating whether pixel aspect ratio should be used or not
+     *  @param  fstart  first frame of the reference image to be processed
+     *  @param  fcount  number of frames (0 = all frames starting with 'fstart')
      */
     DiImage(const DiImage *image,
             const Uint16 width,
             const Uint16 height,
-            const int aspect = 0);
+            const int aspect = 0,
+            const unsigned long fstart = 0,
+            const unsigned long fcount = 0);
 
     /** constructor, rotate
      *
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2012, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -846,11 +846,13 @@ class DCMTK_DCMIMGLE_EXPORT DiMonoImage
      *  @param  interpolate   specifies whether scaling algorithm should use interpolation (if necessary).
      *                        default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                          1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                          4 = bicubic magnification
+     *                          4 = bicubic magnification, 5 = area averaging reduction
      *  @param  aspect        specifies whether pixel aspect ratio should be taken into consideration
      *                        (if true, width OR height should be 0, i.e. this component will be calculated
      *                         automatically)
      *  @param  pvalue        P-value used for the border outside the image (0..65535)
+     *  @param  fstart        first frame to be scaled
+     *  @param  fcount        number of frames to be scaled (0 = all frames starting with 'fstart')
      */
     DiMonoImage(const DiMonoImage *image,
                 const signed long left_pos,
@@ -861,7 +863,9 @@ class DCMTK_DCMIMGLE_EXPORT DiMonoImage
                 const Uint16 dest_rows,
                 const int interpolate,
                 const int aspect,
-                const Uint16 pvalue);
+                const Uint16 pvalue,
+                const unsigned long fstart = 0,
+                const unsigned long fcount = 0);
 
     /** constructor, flip
      *
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2013, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -283,7 +283,10 @@ class DiMonoOutputPixelTemplate
                                    const unsigned long ocnt)
     {
         int result = 0;
-        if ((sizeof(T1) <= 2) && (Count > 3 * ocnt))                          // optimization criteria
+        // the LUT entries are computed sequentially, i.e. without the unpredictable branches of the
+        // per-pixel computation, and applying the LUT is much cheaper than computing each pixel value.
+        // Therefore, the LUT already pays off if it has less entries than there are pixels to be processed.
+        if ((ocnt > 0) && (Count > ocnt))                                     // optimization criteria
         {                                                                     // use LUT for optimization
             lut = new T3[ocnt];
             if (lut != NULL)
@@ -295,6 +298,30 @@ class DiMonoOutputPixelTemplate
         return result;
     }
 
+    /** apply an optimization LUT to the intermediate pixel data and store the result in the output data
+     *
+     ** @param  lut0   pointer to the LUT entry for the pixel value 0 (might be outside the LUT)
+     *  @param  pixel  pointer to the first intermediate pixel to be processed
+     */
+    inline void applyOptimizationLUT(const T3 *lut0,
+                                     const T1 *pixel)
+    {
+        register const T1 *p = pixel;
+        register T3 *q = Data;
+        register unsigned long i;
+        for (i = Count >> 2; i != 0; --i)                                     // process four pixels at a time
+        {
+            q[0] = lut0[p[0]];
+            q[1] = lut0[p[1]];
+            q[2] = lut0[p[2]];
+            q[3] = lut0[p[3]];
+            p += 4;
+            q += 4;
+        }
+        for (i = Count & 3; i != 0; --i)                                      // remaining pixels
+            *(q++) = *(lut0 + (*(p++)));
+    }
+
 #ifdef PASTEL_COLOR_OUTPUT
     void color(void *buffer,                               // create true color pastel image
                const DiMonoPixel *inter,
@@ -438,9 +465,7 @@ class DiMonoOutputPixelTemplate
                                 }
                             }
                             const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());  // points to 'zero' entry
-                            q = Data;
-                            for (i = Count; i != 0; --i)                                  // apply LUT
-                                *(q++) = *(lut0 + (*(p++)));
+                            applyOptimizationLUT(lut0, p);
                         }
                         if (lut == NULL)                                                  // use "normal" transformation
                         {
@@ -538,9 +563,7 @@ class DiMonoOutputPixelTemplate
                                 }
                             }
                             const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());   // points to 'zero' entry
-                            q = Data;
-                            for (i = Count; i != 0; --i)                                  // apply LUT
-                                *(q++) = *(lut0 + (*(p++)));
+                            applyOptimizationLUT(lut0, p);
                         }
                         if (lut == NULL)                                                  // use "normal" transformation
                         {
@@ -665,9 +688,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());  // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(lut0, p);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -721,9 +742,7 @@ class DiMonoOutputPixelTemplate
                                 *(q++) = OFstatic_cast(T3, OFstatic_cast(double, low) + OFstatic_cast(double, i) * gradient);
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());  // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(lut0, p);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -733,7 +752,7 @@ class DiMonoOutputPixelTemplate
                             if (low > high)                                           // inverse
                             {
                                 for (i = Count; i != 0; --i)
-                                    *(q++) = OFstatic_cast(T3, dlut->getValue(OFstatic_cast(Uint16, absmax - (OFstatic_cast(double, *(p++)) - absmin))));
+                                    *(q++) = OFstatic_cast(T3, dlut->getValue(OFstatic_cast(Uint16, absmax - OFstatic_cast(double, *(p++)))));
                             } else {                                                  // normal
                                 for (i = Count; i != 0; --i)
                                     *(q++) = OFstatic_cast(T3, dlut->getValue(OFstatic_cast(Uint16, OFstatic_cast(double, *(p++)) - absmin)));
@@ -823,9 +842,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(lut0, p);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -877,9 +894,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(lut0, p);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -996,9 +1011,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(lut0, p);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -1071,9 +1084,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(lut0, p);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2011, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -60,6 +60,8 @@ class DiMonoScaleTemplate
      *  @param  bits         number of bits per plane/pixel
      *  @param  interpolate  use of interpolation when scaling
      *  @param  pvalue       value possibly used for regions outside the image boundaries
+     *  @param  fstart       first frame of the source image to be scaled
+     *  @param  threads      maximum number of threads used for scaling
      */
     DiMonoScaleTemplate(const DiMonoPixel *pixel,
                         const Uint16 columns,
@@ -73,15 +75,18 @@ class DiMonoScaleTemplate
                         const Uint32 frames,
                         const int bits,
                         const int interpolate,
-                        const Uint16 pvalue)
+                        const Uint16 pvalue,
+                        const unsigned long fstart = 0,
+                        const Uint32 threads = 1)
       : DiMonoPixelTemplate<T>(pixel, OFstatic_cast(unsigned long, dest_cols) * OFstatic_cast(unsigned long, dest_rows) * frames),
-        DiScaleTemplate<T>(1, columns, rows, left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, frames, bits)
+        DiScaleTemplate<T>(1, columns, rows, left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, frames, bits, threads)
     {
         if ((pixel != NULL) && (pixel->getCount() > 0))
         {
-            if (pixel->getCount() == OFstatic_cast(unsigned long, columns) * OFstatic_cast(unsigned long, rows) * frames)
+            const unsigned long fsize = OFstatic_cast(unsigned long, columns) * OFstatic_cast(unsigned long, rows);
+            if (pixel->getCount() >= fsize * (fstart + frames))
             {
-                scale(OFstatic_cast(const T *, pixel->getData()), pixel->getBits(), interpolate, pvalue);
+                scale(OFstatic_cast(const T *, pixel->getData()) + fstart * fsize, pixel->getBits(), interpolate, pvalue);
                 this->determineMinMax();
             } else {
                 DCMIMGLE_WARN("could not scale image ... corrupted data");
@@ -29,6 +29,7 @@
 
 #include "dcmtk/dcmimgle/ditranst.h"
 #include "dcmtk/dcmimgle/dipxrept.h"
+#include "dcmtk/dcmdata/dcparfrm.h"
 
 
 /*---------------------*
@@ -38,6 +39,9 @@
 #define SCALE_FACTOR 4096
 #define HALFSCALE_FACTOR 2048
 
+// number of destination rows computed at a time by area averaging
+#define AREA_BAND_ROWS 16
+
 
 /*--------------------*
  *  helper functions  *
@@ -73,6 +77,42 @@ static inline void setScaleValues(Uint16 data[],
     }
 }
 
+// help function to compute the weights for area averaging (one dimension, reduction only).
+// the weight of a source pixel is the part of it covered by the destination pixel, i.e. the
+// weights are not normalized. 'weights' has to provide space for 'src' + 'dest' entries.
+static inline void setAreaWeights(Uint16 start[],
+                                  Uint16 count[],
+                                  double weights[],
+                                  const Uint16 src,
+                                  const Uint16 dest)
+{
+    const double factor = OFstatic_cast(double, src) / OFstatic_cast(double, dest);
+    register Uint16 i;
+    register double w;
+    double b, e;
+    for (Uint16 d = 0; d < dest; ++d)
+    {
+        b = factor * OFstatic_cast(double, d);
+        e = factor * (OFstatic_cast(double, d) + 1.0);
+        if (e > src)                    // can happen due to rounding, see reducePixel()
+            e = src;
+        start[d] = OFstatic_cast(Uint16, b);
+        count[d] = 0;
+        for (i = start[d]; (i < src) && (OFstatic_cast(double, i) < e); ++i)
+        {
+            w = ((OFstatic_cast(double, i) + 1.0 < e) ? OFstatic_cast(double, i) + 1.0 : e) -
+                ((OFstatic_cast(double, i) > b) ? OFstatic_cast(double, i) : b);
+            if ((w <= 0) && (count[d] == 0))
+                ++start[d];             // skip leading pixels that are not covered at all
+            else if (w > 0)
+            {
+                *(weights++) = w;
+                ++count[d];
+            }
+        }
+    }
+}
+
 // cubic value interpolation using Catmull-Rom formula.
 // the interpolated pixel lies between the second and the third original pixels
 static inline double cubicValue(const double v1,
@@ -88,6 +128,251 @@ static inline double cubicValue(const double v1,
 }
 
 
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Template class to reduce images by area averaging (helper class for DiScaleTemplate).
+ *  The filter is separable, i.e. each source row is reduced horizontally first, and the
+ *  resulting rows are then combined vertically. The rows of the destination image (of all
+ *  frames and planes) are computed in bands of AREA_BAND_ROWS rows, which are processed by
+ *  multiple threads if requested.
+ */
+template<class T>
+class DiScaleAreaTemplate
+  : public DcmParallelFrameProcessor
+{
+
+ public:
+
+    /** constructor, compute the weights
+     *
+     ** @param  src      array of pointers to source image pixels (one for each plane)
+     *  @param  dest     array of pointers to destination image pixels (one for each plane)
+     *  @param  planes   number of planes
+     *  @param  frames   number of frames
+     *  @param  columns  width of source image
+     *  @param  rows     height of source image
+     *  @param  left     left coordinate of clipping area (inside the image)
+     *  @param  top      top coordinate of clipping area (inside the image)
+     *  @param  src_x    width of clipping area
+     *  @param  src_y    height of clipping area
+     *  @param  dest_x   width of destination image (<= src_x)
+     *  @param  dest_y   height of destination image (<= src_y)
+     */
+    DiScaleAreaTemplate(const T *src[],
+                        T *dest[],
+                        const int planes,
+                        const Uint32 frames,
+                        const Uint16 columns,
+                        const Uint16 rows,
+                        const unsigned long left,
+                        const unsigned long top,
+                        const Uint16 src_x,
+                        const Uint16 src_y,
+                        const Uint16 dest_x,
+                        const Uint16 dest_y)
+      : DcmParallelFrameProcessor(OFstatic_cast(Uint32, (OFstatic_cast(unsigned long, planes) * frames * dest_y + AREA_BAND_ROWS - 1) / AREA_BAND_ROWS)),
+        Src(src),
+        Dest(dest),
+        Planes(planes),
+        Frames(frames),
+        Columns(columns),
+        Rows(rows),
+        Left(left),
+        Top(top),
+        Src_Y(src_y),
+        Dest_X(dest_x),
+        Dest_Y(dest_y),
+        Area((OFstatic_cast(double, src_x) / OFstatic_cast(double, dest_x)) * (OFstatic_cast(double, src_y) / OFstatic_cast(double, dest_y))),
+        XStart(new Uint16[dest_x]),
+        XCount(new Uint16[dest_x]),
+        XWeights(new double[OFstatic_cast(unsigned long, src_x) + dest_x]),
+        YStart(new Uint16[dest_y]),
+        YCount(new Uint16[dest_y]),
+        YOffset(new unsigned long[dest_y]),
+        YWeights(new double[OFstatic_cast(unsigned long, src_y) + dest_y])
+    {
+        setAreaWeights(XStart, XCount, XWeights, src_x, dest_x);
+        setAreaWeights(YStart, YCount, YWeights, src_y, dest_y);
+        unsigned long offset = 0;
+        for (Uint16 y = 0; y < dest_y; ++y)
+        {
+            YOffset[y] = offset;
+            offset += YCount[y];
+        }
+    }
+
+    /** destructor
+     */
+    virtual ~DiScaleAreaTemplate()
+    {
+        delete[] XStart;
+        delete[] XCount;
+        delete[] XWeights;
+        delete[] YStart;
+        delete[] YCount;
+        delete[] YOffset;
+        delete[] YWeights;
+    }
+
+    /** reduce the source image
+     *
+     ** @param  threads  maximum number of threads to be used
+     */
+    void scaleData(const Uint32 threads)
+    {
+        processAllFrames(threads);
+    }
+
+
+ protected:
+
+    /** compute a band of destination rows.
+     *  Called by processAllFrames(), possibly by multiple threads at the same time.
+     *
+     ** @param  frameNo   index of the band to be computed
+     *  @param  threadNo  index of the calling thread (not used)
+     *
+     ** @return always EC_Normal
+     */
+    virtual OFCondition processFrame(Uint32 frameNo,
+                                     Uint32 /* threadNo */)
+    {
+        const unsigned long count = OFstatic_cast(unsigned long, Planes) * Frames * Dest_Y;
+        const unsigned long first = OFstatic_cast(unsigned long, frameNo) * AREA_BAND_ROWS;
+        process(first, (first + AREA_BAND_ROWS < count) ? first + AREA_BAND_ROWS : count);
+        return EC_Normal;
+    }
+
+    /** compute the given range of destination rows (of all frames and planes)
+     *
+     ** @param  first  index of the first row to be computed
+     *  @param  last   index of the row behind the last one to be computed
+     */
+    void process(const unsigned long first,
+                 const unsigned long last)
+    {
+        const unsigned long f_size = OFstatic_cast(unsigned long, Rows) * OFstatic_cast(unsigned long, Columns);
+        const unsigned long p_rows = OFstatic_cast(unsigned long, Frames) * Dest_Y;
+        double *line = new double[Dest_X];               // horizontally reduced source row
+        double *sum = new double[Dest_X];                // weighted sum of source rows
+        unsigned long lastRow = 0;                       // source row stored in 'line' (plus 1)
+        register const T *p;
+        register const double *w;
+        register double value;
+        register Uint16 x;
+        register Uint16 k;
+        for (unsigned long r = first; r < last; ++r)
+        {
+            const int plane = OFstatic_cast(int, r / p_rows);
+            const unsigned long frame = (r % p_rows) / Dest_Y;
+            const Uint16 y = OFstatic_cast(Uint16, r % Dest_Y);
+            const T *sp = Src[plane] + frame * f_size + Top * OFstatic_cast(unsigned long, Columns) + Left;
+            const double *yw = YWeights + YOffset[y];
+            for (Uint16 yi = 0; yi < YCount[y]; ++yi)
+            {
+                const Uint16 row = YStart[y] + yi;
+                const unsigned long thisRow = (OFstatic_cast(unsigned long, plane) * Frames + frame) * Src_Y + row + 1;
+                if (thisRow != lastRow)                  // reduce source row horizontally
+                {
+                    p = sp + OFstatic_cast(unsigned long, row) * OFstatic_cast(unsigned long, Columns);
+                    w = XWeights;
+                    for (x = 0; x < Dest_X; ++x)
+                    {
+                        const T *q = p + XStart[x];
+                        k = XCount[x];
+                        // only the first and the last pixel are partially covered
+                        value = OFstatic_cast(double, *(q++)) * *(w++);
+                        if (k > 1)
+                        {
+                            double value2 = 0;
+                            for (k -= 2; k > 1; k -= 2, q += 2)
+                            {
+                                value += OFstatic_cast(double, q[0]);
+                                value2 += OFstatic_cast(double, q[1]);
+                            }
+                            if (k > 0)
+                                value += OFstatic_cast(double, *(q++));
+                            w += XCount[x] - 2;
+                            value += value2 + OFstatic_cast(double, *q) * *(w++);
+                        }
+                        line[x] = value;
+                    }
+                    lastRow = thisRow;
+                }
+                // combine reduced rows vertically
+                const double factor = yw[yi];
+                if (yi == 0)
+                {
+                    for (x = 0; x < Dest_X; ++x)
+                        sum[x] = line[x] * factor;
+                } else {
+                    for (x = 0; x < Dest_X; ++x)
+                        sum[x] += line[x] * factor;
+                }
+            }
+            T *q = Dest[plane] + (r % p_rows) * Dest_X;   // rows of the current plane only
+            for (x = 0; x < Dest_X; ++x)
+            {
+                value = sum[x] / Area;                   // division results in correct rounding for integer factors
+                *(q++) = OFstatic_cast(T, (value < 0) ? value - 0.5 : value + 0.5);
+            }
+        }
+        delete[] line;
+        delete[] sum;
+    }
+
+
+ private:
+
+    /// array of pointers to source image pixels
+    const T **Src;
+    /// array of pointers to destination image pixels
+    T **Dest;
+    /// number of planes
+    const int Planes;
+    /// number of frames
+    const Uint32 Frames;
+    /// width of source image
+    const Uint16 Columns;
+    /// height of source image
+    const Uint16 Rows;
+    /// left coordinate of clipping area
+    const unsigned long Left;
+    /// top coordinate of clipping area
+    const unsigned long Top;
+    /// height of clipping area
+    const Uint16 Src_Y;
+    /// width of destination image
+    const Uint16 Dest_X;
+    /// height of destination image
+    const Uint16 Dest_Y;
+    /// area of the source image covered by a destination pixel
+    const double Area;
+
+    /// index of the first source column for each destination column
+    Uint16 *XStart;
+    /// number of source columns for each destination column
+    Uint16 *XCount;
+    /// weights of the source columns (for all destination columns)
+    double *XWeights;
+    /// index of the first source row for each destination row
+    Uint16 *YStart;
+    /// number of source rows for each destination row
+    Uint16 *YCount;
+    /// index of the first weight in 'YWeights' for each destination row
+    unsigned long *YOffset;
+    /// weights of the source rows (for all destination rows)
+    double *YWeights;
+
+ // --- declarations to avoid compiler warnings
+
+    DiScaleAreaTemplate(const DiScaleAreaTemplate<T> &);
+    DiScaleAreaTemplate<T> &operator=(const DiScaleAreaTemplate<T> &);
+};
+
+
 /*---------------------*
  *  class declaration  *
  *---------------------*/
@@ -115,6 +400,7 @@ class DiScaleTemplate
      *  @param  dest_rows  height of destination image
      *  @param  frames     number of frames
      *  @param  bits       number of bits per plane/pixel
+     *  @param  threads    maximum number of threads used for scaling (if supported by the algorithm)
      */
     DiScaleTemplate(const int planes,
                     const Uint16 columns,           /* resolution of source image */
@@ -126,12 +412,14 @@ class DiScaleTemplate
                     const Uint16 dest_cols,         /* extension of destination image */
                     const Uint16 dest_rows,
                     const Uint32 frames,            /* number of frames */
-                    const int bits = 0)
+                    const int bits = 0,
+                    const Uint32 threads = 1)
       : DiTransTemplate<T>(planes, src_cols, src_rows, dest_cols, dest_rows, frames, bits),
         Left(left_pos),
         Top(top_pos),
         Columns(columns),
-        Rows(rows)
+        Rows(rows),
+        Threads(threads)
     {
     }
 
@@ -144,6 +432,7 @@ class DiScaleTemplate
      *  @param  dest_rows  height of destination image
      *  @param  frames     number of frames
      *  @param  bits       number of bits per plane/pixel
+     *  @param  threads    maximum number of threads used for scaling (if supported by the algorithm)
      */
     DiScaleTemplate(const int planes,
                     const Uint16 src_cols,          /* resolution of source image */
@@ -151,12 +440,14 @@ class DiScaleTemplate
                     const Uint16 dest_cols,         /* resolution of destination image */
                     const Uint16 dest_rows,
                     const Uint32 frames,            /* number of frames */
-                    const int bits = 0)
+                    const int bits = 0,
+                    const Uint32 threads = 1)
       : DiTransTemplate<T>(planes, src_cols, src_rows, dest_cols, dest_rows, frames, bits),
         Left(0),
         Top(0),
         Columns(src_cols),
-        Rows(src_rows)
+        Rows(src_rows),
+        Threads(threads)
     {
     }
 
@@ -181,7 +472,8 @@ class DiScaleTemplate
      ** @param  src          array of pointers to source image pixels
      *  @param  dest         array of pointers to destination image pixels
      *  @param  interpolate  preferred interpolation algorithm (0 = no interpolation, 1 = pbmplus algorithm,
-     *                         2 = c't algorithm, 3 = bilinear magnification, 4 = bicubic magnification)
+     *                         2 = c't algorithm, 3 = bilinear magnification, 4 = bicubic magnification,
+     *                         5 = area averaging reduction)
      *  @param  value        value to be set outside the image boundaries (used for clipping, default: 0)
      */
     void scaleData(const T *src[],
@@ -211,8 +503,15 @@ class DiScaleTemplate
                 else
                     clipBorderPixel(src, dest, value);                                // clipping (with border)
             }
+            else if ((Left < 0) || (OFstatic_cast(unsigned long, Left + this->Src_X) > Columns) ||
+                     (Top < 0) || (OFstatic_cast(unsigned long, Top + this->Src_Y) > Rows))
+                scaleBorderPixel(src, dest, interpolate, value);                      // scaling (with border)
             else if ((interpolate == 1) && (this->Bits <= MAX_INTERPOLATION_BITS))
                 interpolatePixel(src, dest);                                          // interpolation (pbmplus)
+            else if ((interpolate == 5) && (this->Src_X >= this->Dest_X) && (this->Src_Y >= this->Dest_Y) &&
+                     (Left >= 0) && (OFstatic_cast(Uint16, Left + this->Src_X) <= Columns) &&
+                     (Top >= 0) && (OFstatic_cast(Uint16, Top + this->Src_Y) <= Rows))
+                areaAveragePixel(src, dest);                                          // area averaging reduction
             else if ((interpolate == 4) && (this->Dest_X >= this->Src_X) && (this->Dest_Y >= this->Src_Y) &&
                      (this->Src_X >= 3) && (this->Src_Y >= 3))
                 bicubicPixel(src, dest);                                              // bicubic magnification
@@ -244,6 +543,8 @@ class DiScaleTemplate
     const Uint16 Columns;
     /// height of source image
     const Uint16 Rows;
+    /// maximum number of threads used for scaling
+    const Uint32 Threads;
 
 
  private:
@@ -357,6 +658,74 @@ class DiScaleTemplate
         }
     }
 
+    /** scale specified area that is partly outside the image boundaries.
+     *  The part of the area inside the image is scaled by one of the other algorithms
+     *  (depending on the value of 'interpolate') and copied to the corresponding part of
+     *  the destination image. All other destination pixels are set to the border value.
+     *
+     ** @param  src          array of pointers to source image pixels
+     *  @param  dest         array of pointers to destination image pixels
+     *  @param  interpolate  preferred interpolation algorithm (see scaleData())
+     *  @param  value        value to be set outside the image boundaries
+     */
+    void scaleBorderPixel(const T *src[],
+                          T *dest[],
+                          const int interpolate,
+                          const T value)
+    {
+        DCMIMGLE_DEBUG("using scale image to specified area and add border algorithm");
+        const double x_factor = OFstatic_cast(double, this->Dest_X) / OFstatic_cast(double, this->Src_X);
+        const double y_factor = OFstatic_cast(double, this->Dest_Y) / OFstatic_cast(double, this->Src_Y);
+        /* part of the clipping area inside the image (source coordinates) */
+        const signed long s_left = (Left > 0) ? Left : 0;
+        const signed long s_top = (Top > 0) ? Top : 0;
+        const signed long s_right = (Left + OFstatic_cast(signed long, this->Src_X) < OFstatic_cast(signed long, Columns)) ?
+                                    Left + OFstatic_cast(signed long, this->Src_X) : OFstatic_cast(signed long, Columns);
+        const signed long s_bottom = (Top + OFstatic_cast(signed long, this->Src_Y) < OFstatic_cast(signed long, Rows)) ?
+                                     Top + OFstatic_cast(signed long, this->Src_Y) : OFstatic_cast(signed long, Rows);
+        /* corresponding part of the destination image (rounded to full pixels) */
+        const Uint16 d_left = OFstatic_cast(Uint16, OFstatic_cast(double, s_left - Left) * x_factor + 0.5);
+        const Uint16 d_top = OFstatic_cast(Uint16, OFstatic_cast(double, s_top - Top) * y_factor + 0.5);
+        const Uint16 d_right = OFstatic_cast(Uint16, OFstatic_cast(double, s_right - Left) * x_factor + 0.5);
+        const Uint16 d_bottom = OFstatic_cast(Uint16, OFstatic_cast(double, s_bottom - Top) * y_factor + 0.5);
+        this->fillPixel(dest, value);
+        if ((d_right > d_left) && (d_bottom > d_top))
+        {
+            const Uint16 x_count = d_right - d_left;
+            const Uint16 y_count = d_bottom - d_top;
+            const unsigned long count = OFstatic_cast(unsigned long, x_count) * OFstatic_cast(unsigned long, y_count) * this->Frames;
+            /* scale the part inside the image to a temporary buffer */
+            T *temp[3] = {NULL, NULL, NULL};
+            int j;
+            for (j = 0; j < this->Planes; ++j)
+                temp[j] = new T[count];
+            DiScaleTemplate<T> scale(this->Planes, Columns, Rows, s_left, s_top, OFstatic_cast(Uint16, s_right - s_left),
+                                     OFstatic_cast(Uint16, s_bottom - s_top), x_count, y_count, this->Frames, this->Bits, Threads);
+            scale.scaleData(src, temp, interpolate, value);
+            /* and copy it to the destination image */
+            const unsigned long d_start = OFstatic_cast(unsigned long, d_top) * OFstatic_cast(unsigned long, this->Dest_X) + d_left;
+            const unsigned long f_size = OFstatic_cast(unsigned long, this->Dest_X) * OFstatic_cast(unsigned long, this->Dest_Y);
+            register Uint16 y;
+            register const T *p;
+            register T *q;
+            for (j = 0; j < this->Planes; ++j)
+            {
+                p = temp[j];
+                for (unsigned long f = 0; f < this->Frames; ++f)
+                {
+                    q = dest[j] + f * f_size + d_start;
+                    for (y = y_count; y != 0; --y)
+                    {
+                        OFBitmanipTemplate<T>::copyMem(p, q, x_count);
+                        p += x_count;
+                        q += this->Dest_X;
+                    }
+                }
+                delete[] temp[j];
+            }
+        }
+    }
+
     /** enlarge image by an integer factor.
      *  Pixels are replicated independently in both directions.
      *
@@ -923,6 +1292,23 @@ class DiScaleTemplate
         }
     }
 
+    /** reduce image by area averaging (only inside image boundaries).
+     *  Each destination pixel is the mean value of the source pixels covered by it. The
+     *  computation is separable and can be performed by multiple threads (see DiScaleAreaTemplate).
+     *
+     ** @param  src   array of pointers to source image pixels
+     *  @param  dest  array of pointers to destination image pixels
+     */
+    void areaAveragePixel(const T *src[],
+                          T *dest[])
+    {
+        DCMIMGLE_DEBUG("using reduce pixel scaling algorithm with area averaging");
+        DiScaleAreaTemplate<T> scale(src, dest, this->Planes, this->Frames, Columns, Rows,
+                                     OFstatic_cast(unsigned long, Left), OFstatic_cast(unsigned long, Top),
+                                     this->Src_X, this->Src_Y, this->Dest_X, this->Dest_Y);
+        scale.scaleData(Threads);
+    }
+
    /** bilinear interpolation method (only for magnification)
     *
     ** @param  src   array of pointers to source image pixels
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2010, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -61,7 +61,8 @@ DiRegisterBase *DiRegisterBase::Pointer = NULL;
 DicomImage::DicomImage(const char *filename,
                        const unsigned long flags,
                        const unsigned long fstart,
-                       const unsigned long fcount)
+                       const unsigned long fcount,
+                       const Uint32 threads)
   : ImageStatus(EIS_Normal),
     PhotometricInterpretation(EPI_Unknown),
     Document(NULL),
@@ -69,7 +70,7 @@ DicomImage::DicomImage(const char *filename,
 {
     if (checkDataDictionary())                  // valid 'dicom.dic' found ?
     {
-        Document = new DiDocument(filename, flags | CIF_MayDetachPixelData, fstart, fcount);
+        Document = new DiDocument(filename, flags | CIF_MayDetachPixelData, fstart, fcount, threads);
         Init();
     }
 }
@@ -81,7 +82,8 @@ DicomImage::DicomImage(DcmObject *object,
                        const E_TransferSyntax xfer,
                        const unsigned long flags,
                        const unsigned long fstart,
-                       const unsigned long fcount)
+                       const unsigned long fcount,
+                       const Uint32 threads)
   : ImageStatus(EIS_Normal),
     PhotometricInterpretation(EPI_Unknown),
     Document(NULL),
@@ -89,7 +91,7 @@ DicomImage::DicomImage(DcmObject *object,
 {
     if (checkDataDictionary())                  // valid 'dicom.dic' found ?
     {
-        Document = new DiDocument(object, xfer, flags, fstart, fcount);
+        Document = new DiDocument(object, xfer, flags, fstart, fcount, threads);
         Init();
     }
 }
@@ -103,7 +105,8 @@ DicomImage::DicomImage(DcmObject *object,
                        const double intercept,
                        const unsigned long flags,
                        const unsigned long fstart,
-                       const unsigned long fcount)
+                       const unsigned long fcount,
+                       const Uint32 threads)
   : ImageStatus(EIS_Normal),
     PhotometricInterpretation(EPI_Unknown),
     Document(NULL),
@@ -111,7 +114,7 @@ DicomImage::DicomImage(DcmObject *object,
 {
     if (checkDataDictionary())                  // valid 'dicom.dic' found ?
     {
-        Document = new DiDocument(object, xfer, flags, fstart, fcount);
+        Document = new DiDocument(object, xfer, flags, fstart, fcount, threads);
         if ((Document != NULL) && (Document->good()))
         {
             PhotometricInterpretation = EPI_Monochrome2;            // default for presentation states
@@ -130,7 +133,8 @@ DicomImage::DicomImage(DcmObject *object,
                        const DcmLongString *explanation,
                        const unsigned long flags,
                        const unsigned long fstart,
-                       const unsigned long fcount)
+                       const unsigned long fcount,
+                       const Uint32 threads)
   : ImageStatus(EIS_Normal),
     PhotometricInterpretation(EPI_Unknown),
     Document(NULL),
@@ -138,7 +142,7 @@ DicomImage::DicomImage(DcmObject *object,
 {
     if (checkDataDictionary())                  // valid 'dicom.dic' found ?
     {
-        Document = new DiDocument(object, xfer, flags, fstart, fcount);
+        Document = new DiDocument(object, xfer, flags, fstart, fcount, threads);
         if ((Document != NULL) && (Document->good()))
         {
             PhotometricInterpretation = EPI_Monochrome2;            // default for presentation states
@@ -434,16 +438,10 @@ DicomImage *DicomImage::createScaledImage(const signed long left_pos,
 
         /* need to limit clipping region ... !? */
 
-        if (((left_pos < 0) || (OFstatic_cast(unsigned long, left_pos + clip_width) > gw) ||
-            (top_pos < 0) || (OFstatic_cast(unsigned long, top_pos + clip_height) > gh)) &&
-            ((clip_width != scale_width) || (clip_height != scale_height)))
-        {
-            DCMIMGLE_ERROR("combined clipping & scaling outside image boundaries not yet supported");
-        }
-        else if ((scale_width > 0) && (scale_height > 0))
+        if ((scale_width > 0) && (scale_height > 0))
         {
             DiImage *image = Image->createScale(left_pos, top_pos, clip_width, clip_height, scale_width, scale_height,
-                interpolate, aspect, pvalue);
+                interpolate, aspect, pvalue, 0 /*fstart*/, 0 /*all frames*/);
             if (image != NULL)
             {
                 DicomImage *dicom = new DicomImage(this, image);
@@ -496,6 +494,50 @@ DicomImage *DicomImage::createClippedImage(const signed long left_pos,
 }
 
 
+// --- render clipped and scaled area of 'frame' to given memory 'buffer' (only the pixels of this area are processed)
+
+int DicomImage::getRegionOutputData(void *buffer,
+                                    const unsigned long size,
+                                    const signed long left_pos,
+                                    const signed long top_pos,
+                                    const unsigned long clip_width,
+                                    const unsigned long clip_height,
+                                    unsigned long scale_width,
+                                    unsigned long scale_height,
+                                    const int bits,
+                                    const unsigned long frame,
+                                    const int interpolate,
+                                    const int planar,
+                                    const Uint16 pvalue) const
+{
+    int result = 0;
+    if ((Image != NULL) && (buffer != NULL) && (frame < getFrameCount()) && (clip_width > 0) && (clip_height > 0))
+    {
+        if ((scale_width == 0) || (scale_height == 0))
+        {
+            scale_width = clip_width;                                // no scaling
+            scale_height = clip_height;
+        }
+        const unsigned long maxvalue = DicomImageClass::maxval(bitsof(Uint16));
+        if ((clip_width > maxvalue) || (clip_height > maxvalue) || (scale_width > maxvalue) || (scale_height > maxvalue))
+        {
+            DCMIMGLE_ERROR("cannot render region of image ... area too large");
+        } else {
+            /* create a temporary image that only contains the (scaled) area of the given frame */
+            DiImage *image = Image->createScale(left_pos, top_pos, clip_width, clip_height, scale_width, scale_height,
+                interpolate, 0 /*aspect*/, pvalue, frame, 1 /*fcount*/);
+            if (image != NULL)
+            {
+                if (image->getStatus() == EIS_Normal)
+                    result = image->getOutputData(buffer, size, 0 /*frame*/, Image->getBits(bits), planar);
+                delete image;
+            }
+        }
+    }
+    return result;
+}
+
+
 // --- flip image (horizontal: x > 1 and/or vertical y > 1)
 
 int DicomImage::flipImage(int horz,
@@ -0,0 +1,452 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomFrameCache (Source)
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+
+#include "dcmtk/dcmimgle/dicache.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+#ifdef WITH_THREADS
+
+/** background thread that loads the frames following the one requested last
+ */
+class DiFramePrefetchThread
+  : public OFThread
+{
+
+ public:
+
+    DiFramePrefetchThread(DicomFrameCache &cache)
+      : OFThread(),
+        Cache(cache)
+    {
+    }
+
+ protected:
+
+    virtual void run()
+    {
+        Cache.prefetchFrames();
+    }
+
+ private:
+
+    /// frame cache to be filled
+    DicomFrameCache &Cache;
+
+ // --- declarations to avoid compiler warnings
+
+    DiFramePrefetchThread(const DiFramePrefetchThread &);
+    DiFramePrefetchThread &operator=(const DiFramePrefetchThread &);
+};
+
+#endif
+
+
+/*----------------*
+ *  constructors  *
+ *----------------*/
+
+DicomFrameCache::DicomFrameCache(const char *filename,
+                                 const unsigned long flags,
+                                 const unsigned long maxSize,
+                                 const unsigned long prefetch)
+  : Status(EIS_Normal),
+    Filename(),
+    Flags((flags | CIF_UsePartialAccessToPixelData) & ~(CIF_MayDetachPixelData | CIF_TakeOverExternalDataset)),
+    NumberOfFrames(0),
+    MaxSize(maxSize),
+    CacheSize(0),
+    PrefetchCount(prefetch),
+    Entries(),
+    CurrentFrame(0),
+    FileFormat(NULL),
+    PrefetchFileFormat(NULL),
+    FrameSize(0)
+#ifdef WITH_THREADS
+  , Mutex(),
+    PrefetchThread(NULL),
+    PrefetchRunning(OFFalse)
+#endif
+{
+    if (filename != NULL)
+    {
+        Filename = filename;
+        /* the pixel data is not loaded into memory (if larger than 4 KB) but read on demand */
+        FileFormat = new DcmFileFormat();
+        if (FileFormat->loadFile(filename).good())
+        {
+            Sint32 frames = 1;
+            if (FileFormat->getDataset()->findAndGetSint32(DCM_NumberOfFrames, frames).bad() || (frames < 1))
+                frames = 1;
+            NumberOfFrames = OFstatic_cast(unsigned long, frames);
+        } else {
+            DCMIMGLE_ERROR("can't read file '" << filename << "'");
+            Status = EIS_InvalidDocument;
+        }
+    } else
+        Status = EIS_InvalidDocument;
+}
+
+
+/*--------------*
+ *  destructor  *
+ *--------------*/
+
+DicomFrameCache::~DicomFrameCache()
+{
+#ifdef WITH_THREADS
+    /* stop the background thread after the current frame */
+    Mutex.lock();
+    PrefetchCount = 0;
+    Mutex.unlock();
+#endif
+    waitForPrefetch();
+    OFListIterator(Entry *) iter = Entries.begin();
+    while (iter != Entries.end())
+    {
+        deleteEntry(*iter);
+        ++iter;
+    }
+    delete FileFormat;
+    delete PrefetchFileFormat;
+}
+
+
+/********************************************************************/
+
+
+DicomImage *DicomFrameCache::getFrame(const unsigned long frame)
+{
+    DicomImage *image = NULL;
+    if ((Status == EIS_Normal) && (frame < NumberOfFrames))
+    {
+#ifdef WITH_THREADS
+        Mutex.lock();
+#endif
+        Entry *entry = findEntry(frame);
+        if (entry != NULL)
+        {
+            DCMIMGLE_TRACE("found frame " << frame << " in cache");
+            /* make it the most recently used frame */
+            Entries.remove(entry);
+            Entries.push_front(entry);
+        } else {
+#ifdef WITH_THREADS
+            Mutex.unlock();
+#endif
+            /* frame might also be loaded by the background thread, but do not wait for it */
+            entry = loadFrame(FileFormat, frame);
+#ifdef WITH_THREADS
+            Mutex.lock();
+#endif
+            if (entry != NULL)
+                entry = addEntry(entry);
+        }
+        if (entry != NULL)
+        {
+            CurrentFrame = frame;
+            image = entry->Image;
+            removeEntries();
+            startPrefetch();
+        }
+#ifdef WITH_THREADS
+        Mutex.unlock();
+#endif
+    }
+    return image;
+}
+
+
+void DicomFrameCache::setMaxSize(const unsigned long maxSize)
+{
+#ifdef WITH_THREADS
+    Mutex.lock();
+#endif
+    MaxSize = maxSize;
+    removeEntries();
+#ifdef WITH_THREADS
+    Mutex.unlock();
+#endif
+}
+
+
+void DicomFrameCache::setPrefetchCount(const unsigned long prefetch)
+{
+#ifdef WITH_THREADS
+    Mutex.lock();
+#endif
+    PrefetchCount = prefetch;
+#ifdef WITH_THREADS
+    Mutex.unlock();
+#endif
+}
+
+
+unsigned long DicomFrameCache::getCacheSize()
+{
+#ifdef WITH_THREADS
+    Mutex.lock();
+#endif
+    const unsigned long result = CacheSize;
+#ifdef WITH_THREADS
+    Mutex.unlock();
+#endif
+    return result;
+}
+
+
+unsigned long DicomFrameCache::getNumberOfCachedFrames()
+{
+#ifdef WITH_THREADS
+    Mutex.lock();
+#endif
+    const unsigned long result = OFstatic_cast(unsigned long, Entries.size());
+#ifdef WITH_THREADS
+    Mutex.unlock();
+#endif
+    return result;
+}
+
+
+OFBool DicomFrameCache::isFrameCached(const unsigned long frame)
+{
+#ifdef WITH_THREADS
+    Mutex.lock();
+#endif
+    const OFBool result = (findEntry(frame) != NULL);
+#ifdef WITH_THREADS
+    Mutex.unlock();
+#endif
+    return result;
+}
+
+
+void DicomFrameCache::waitForPrefetch()
+{
+#ifdef WITH_THREADS
+    Mutex.lock();
+    DiFramePrefetchThread *thread = PrefetchThread;
+    PrefetchThread = NULL;
+    Mutex.unlock();
+    if (thread != NULL)
+    {
+        thread->join();
+        delete thread;
+    }
+#endif
+}
+
+
+DicomFrameCache::Entry *DicomFrameCache::loadFrame(DcmFileFormat *fileformat,
+                                                   const unsigned long frame) const
+{
+    Entry *entry = NULL;
+    DCMIMGLE_DEBUG("loading frame " << frame << " from file '" << Filename << "'");
+    DicomImage *image = new DicomImage(fileformat, EXS_Unknown, Flags, frame, 1 /*fcount*/);
+    if (image->getStatus() == EIS_Normal)
+    {
+        entry = new Entry;
+        entry->Frame = frame;
+        entry->Image = image;
+        entry->Size = image->getOutputDataSize();
+        const DiPixel *pixel = image->getInterData();
+        if (pixel != NULL)
+        {
+            entry->Size += pixel->getCount() * pixel->getPlanes() *
+                ((DicomImageClass::getRepresentationBits(pixel->getRepresentation()) + 7) / 8);
+        }
+    } else {
+        DCMIMGLE_ERROR("can't load frame " << frame << " from file '" << Filename << "': "
+            << DicomImage::getString(image->getStatus()));
+        delete image;
+    }
+    return entry;
+}
+
+
+DicomFrameCache::Entry *DicomFrameCache::addEntry(Entry *entry)
+{
+    Entry *result = findEntry(entry->Frame);
+    if (result != NULL)
+    {
+        /* frame has been loaded twice, keep the existing entry */
+        deleteEntry(entry);
+    } else {
+        Entries.push_front(entry);
+        CacheSize += entry->Size;
+        FrameSize = entry->Size;
+        result = entry;
+    }
+    return result;
+}
+
+
+DicomFrameCache::Entry *DicomFrameCache::findEntry(const unsigned long frame)
+{
+    OFListIterator(Entry *) iter = Entries.begin();
+    while (iter != Entries.end())
+    {
+        if ((*iter)->Frame == frame)
+            return *iter;
+        ++iter;
+    }
+    return NULL;
+}
+
+
+void DicomFrameCache::removeEntries()
+{
+    OFListIterator(Entry *) iter = Entries.end();
+    while ((CacheSize > MaxSize) && (iter != Entries.begin()))
+    {
+        --iter;
+        /* never remove the frame returned last */
+        if ((*iter)->Frame != CurrentFrame)
+        {
+            DCMIMGLE_TRACE("removing frame " << (*iter)->Frame << " from cache");
+            CacheSize -= (*iter)->Size;
+            deleteEntry(*iter);
+            iter = Entries.erase(iter);
+        }
+    }
+}
+
+
+void DicomFrameCache::deleteEntry(Entry *entry)
+{
+    if (entry != NULL)
+    {
+        delete entry->Image;
+        delete entry;
+    }
+}
+
+
+OFBool DicomFrameCache::isPrefetchFrame(const unsigned long frame) const
+{
+    /* distance to the current frame (with wrap-around) */
+    const unsigned long distance = (frame + NumberOfFrames - CurrentFrame) % NumberOfFrames;
+    return (distance > 0) && (distance <= PrefetchCount);
+}
+
+
+OFBool DicomFrameCache::getNextPrefetchFrame(unsigned long &frame)
+{
+    const unsigned long count = (PrefetchCount < NumberOfFrames) ? PrefetchCount : NumberOfFrames - 1;
+    for (unsigned long i = 1; i <= count; ++i)
+    {
+        frame = (CurrentFrame + i) % NumberOfFrames;
+        if (findEntry(frame) == NULL)
+        {
+            if (CacheSize + FrameSize > MaxSize)
+            {
+                /* determine the frame that would be removed from the cache (never the current one) */
+                OFBool replace = OFFalse;
+                OFListIterator(Entry *) iter = Entries.end();
+                while (iter != Entries.begin())
+                {
+                    --iter;
+                    if ((*iter)->Frame != CurrentFrame)
+                    {
+                        /* do not replace frames that have been loaded in advance */
+                        replace = !isPrefetchFrame((*iter)->Frame);
+                        break;
+                    }
+                }
+                if (!replace)
+                    return OFFalse;
+            }
+            return OFTrue;
+        }
+    }
+    return OFFalse;
+}
+
+
+void DicomFrameCache::prefetchFrames()
+{
+#ifdef WITH_THREADS
+    unsigned long frame = 0;
+    Mutex.lock();
+    while (getNextPrefetchFrame(frame))
+    {
+        Mutex.unlock();
+        /* the background thread uses its own copy of the DICOM file */
+        if (PrefetchFileFormat == NULL)
+        {
+            PrefetchFileFormat = new DcmFileFormat();
+            if (PrefetchFileFormat->loadFile(Filename.c_str()).bad())
+            {
+                DCMIMGLE_ERROR("can't read file '" << Filename << "'");
+                delete PrefetchFileFormat;
+                PrefetchFileFormat = NULL;
+                Mutex.lock();
+                break;
+            }
+        }
+        Entry *entry = loadFrame(PrefetchFileFormat, frame);
+        Mutex.lock();
+        if (entry == NULL)
+            break;
+        addEntry(entry);
+        removeEntries();
+    }
+    PrefetchRunning = OFFalse;
+    Mutex.unlock();
+#endif
+}
+
+
+void DicomFrameCache::startPrefetch()
+{
+#ifdef WITH_THREADS
+    unsigned long frame = 0;
+    /* a running thread continues with the frames following the current one */
+    if (!PrefetchRunning && getNextPrefetchFrame(frame))
+    {
+        if (PrefetchThread != NULL)
+        {
+            /* previous thread has already finished */
+            PrefetchThread->join();
+            delete PrefetchThread;
+        }
+        PrefetchThread = new DiFramePrefetchThread(*this);
+        PrefetchRunning = OFTrue;
+        if (PrefetchThread->start() != 0)
+        {
+            DCMIMGLE_WARN("cannot start thread, frames are not loaded in advance");
+            delete PrefetchThread;
+            PrefetchThread = NULL;
+            PrefetchRunning = OFFalse;
+        }
+    }
+#endif
+}
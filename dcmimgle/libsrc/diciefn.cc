@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2014, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -130,6 +130,12 @@ DiDisplayLUT *DiCIELABFunction::getDisplayLUT(unsigned long count)
 }
 
 
+const char *DiCIELABFunction::getFunctionType() const
+{
+    return "CIELAB";
+}
+
+
 int DiCIELABFunction::writeCurveData(const char *filename,
                                      const OFBool mode)
 {
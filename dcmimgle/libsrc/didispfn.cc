@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1999-2010, OFFIS e.V.
+ *  Copyright (C) 1999-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -23,17 +23,234 @@
 #include "dcmtk/config/osconfig.h"
 
 #include "dcmtk/ofstd/ofbmanip.h"
+#include "dcmtk/ofstd/oflist.h"
 #include "dcmtk/dcmimgle/didispfn.h"
 #include "dcmtk/dcmimgle/displint.h"
 #include "dcmtk/dcmimgle/dicrvfit.h"
 #include "dcmtk/dcmimgle/didislut.h"
 #include "dcmtk/ofstd/ofstream.h"
 
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"
+#endif
+
 #define INCLUDE_CCTYPE
 #define INCLUDE_CMATH
+#define INCLUDE_CSTRING
 #include "dcmtk/ofstd/ofstdinc.h"
 
 
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** entry of the process-wide display LUT cache.
+ *  Stores the LUT together with all parameters that have been used to compute it.
+ */
+struct DiDisplayLUTCacheEntry
+{
+    /// type of the display function (NULL = LUT is not shared)
+    const char *FunctionType;
+    /// output device type
+    DiDisplayFunction::E_DeviceType DeviceType;
+    /// maximum DDL value
+    Uint16 MaxDDLValue;
+    /// order of the polynomial curve fitting algorithm
+    signed int Order;
+    /// number of DDL and luminance/OD values
+    unsigned long ValueCount;
+    /// copy of the DDL values (NULL if LUT is not shared)
+    Uint16 *DDLValue;
+    /// copy of the luminance/OD values (NULL if LUT is not shared)
+    double *LODValue;
+    /// (reflected) ambient light value
+    double AmbientLight;
+    /// illumination value
+    double Illumination;
+    /// minimum optical density
+    double MinDensity;
+    /// maximum optical density
+    double MaxDensity;
+    /// number of LUT entries
+    unsigned long Count;
+    /// cached display LUT
+    DiDisplayLUT *LUT;
+    /// number of display function objects using this LUT
+    unsigned long RefCount;
+};
+
+
+/** process-wide cache of display LUTs.
+ *  The cache object itself is never destroyed, since display function objects might
+ *  still be destroyed after the static objects of this module.  If the list of entries
+ *  has been deleted (see cleanup()), LUTs are no longer shared.
+ */
+class DiDisplayLUTCache
+{
+
+ public:
+
+    DiDisplayLUTCache()
+      : Entries(new OFList<DiDisplayLUTCacheEntry *>()),
+        MaxUnused(16)
+#ifdef WITH_THREADS
+      , Mutex()
+#endif
+    {
+    }
+
+    /** delete all LUTs that are currently not used (at program exit).
+     *  The list itself is only deleted if empty, since display function objects might
+     *  still be destroyed afterwards.
+     */
+    void cleanup()
+    {
+        lock();
+        if (Entries != NULL)
+        {
+            const unsigned long maxUnused = MaxUnused;
+            MaxUnused = 0;
+            removeUnused();
+            MaxUnused = maxUnused;
+            if (Entries->empty())
+            {
+                delete Entries;
+                Entries = NULL;
+            }
+        }
+        unlock();
+    }
+
+    inline void lock()
+    {
+#ifdef WITH_THREADS
+        Mutex.lock();
+#endif
+    }
+
+    inline void unlock()
+    {
+#ifdef WITH_THREADS
+        Mutex.unlock();
+#endif
+    }
+
+    /** find entry for the given LUT. Needs to be called with locked cache and an
+     *  existing list of entries.
+     */
+    OFListIterator(DiDisplayLUTCacheEntry *) findEntry(const DiDisplayLUT *lut)
+    {
+        OFListIterator(DiDisplayLUTCacheEntry *) iter = Entries->begin();
+        while ((iter != Entries->end()) && ((*iter)->LUT != lut))
+            ++iter;
+        return iter;
+    }
+
+    /** decrease reference counter of the given LUT and delete unused LUTs if required.
+     *  Needs to be called with locked cache.
+     */
+    void release(DiDisplayLUT *lut)
+    {
+        if (Entries == NULL)
+            delete lut;
+        else if (lut != NULL)
+        {
+            OFListIterator(DiDisplayLUTCacheEntry *) iter = findEntry(lut);
+            if (iter != Entries->end())
+            {
+                if ((*iter)->RefCount > 0)
+                    --(*iter)->RefCount;
+                /* LUTs that are not shared are deleted immediately */
+                if (((*iter)->RefCount == 0) && ((*iter)->FunctionType == NULL))
+                {
+                    deleteEntry(*iter);
+                    Entries->erase(iter);
+                }
+                removeUnused();
+            } else
+                delete lut;
+        }
+    }
+
+    /** remove least recently used LUTs that are not used any longer until the limit is met.
+     *  Needs to be called with locked cache.
+     */
+    void removeUnused()
+    {
+        if (Entries == NULL)
+            return;
+        unsigned long unused = 0;
+        OFListIterator(DiDisplayLUTCacheEntry *) iter = Entries->begin();
+        while (iter != Entries->end())
+        {
+            /* keep the most recently used ones */
+            if (((*iter)->RefCount == 0) && (++unused > MaxUnused))
+            {
+                deleteEntry(*iter);
+                iter = Entries->erase(iter);
+            } else
+                ++iter;
+        }
+    }
+
+    static void deleteEntry(DiDisplayLUTCacheEntry *entry)
+    {
+        delete[] entry->DDLValue;
+        delete[] entry->LODValue;
+        delete entry->LUT;
+        delete entry;
+    }
+
+    /// list of cached LUTs (most recently used first)
+    OFList<DiDisplayLUTCacheEntry *> *Entries;
+    /// maximum number of unused LUTs
+    unsigned long MaxUnused;
+
+#ifdef WITH_THREADS
+    /// mutex protecting the cache
+    OFMutex Mutex;
+#endif
+};
+
+
+/*--------------------*
+ *  static variables  *
+ *--------------------*/
+
+/** get the process-wide cache of display LUTs.
+ *  The cache is created on first use and intentionally never deleted.
+ */
+static DiDisplayLUTCache &getLUTCache()
+{
+    static DiDisplayLUTCache *cache = new DiDisplayLUTCache();
+    return *cache;
+}
+
+
+/** helper class that creates the LUT cache during static initialization (i.e. before any
+ *  thread is started) and deletes the unused LUTs at program exit
+ */
+class DiDisplayLUTCacheCleanup
+{
+
+ public:
+
+    DiDisplayLUTCacheCleanup()
+    {
+        getLUTCache();
+    }
+
+    ~DiDisplayLUTCacheCleanup()
+    {
+        getLUTCache().cleanup();
+    }
+};
+
+
+/// deletes the unused LUTs at program exit
+static DiDisplayLUTCacheCleanup LUTCacheCleanup;
+
+
 /*----------------------------*
  *  constant initializations  *
  *----------------------------*/
@@ -197,9 +414,12 @@ DiDisplayFunction::~DiDisplayFunction()
 {
     delete[] DDLValue;
     delete[] LODValue;
+    DiDisplayLUTCache &cache = getLUTCache();
+    cache.lock();
     register int i;
     for (i = 0; i < MAX_NUMBER_OF_TABLES; ++i)
-        delete LookupTable[i];
+        cache.release(LookupTable[i]);
+    cache.unlock();
 }
 
 
@@ -248,17 +468,45 @@ const DiDisplayLUT *DiDisplayFunction::getLookupTable(const int bits,
         /* automatically compute number of entries */
         if (count == 0)
             count = DicomImageClass::maxval(bits, 0);
+        DiDisplayLUTCache &cache = getLUTCache();
+        cache.lock();
         /* check whether existing LUT is still valid */
-        if ((LookupTable[idx] != NULL) && ((count != LookupTable[idx]->getCount()) ||
-            (AmbientLight != LookupTable[idx]->getAmbientLightValue()) ||
-            (Illumination != LookupTable[idx]->getIlluminationValue())))
+        if ((LookupTable[idx] != NULL) && !isCurrentLookupTable(LookupTable[idx], count))
         {
-            delete LookupTable[idx];
+            cache.release(LookupTable[idx]);
             LookupTable[idx] = NULL;
         }
-        if (LookupTable[idx] == NULL)                             // first calculation of this LUT
-            LookupTable[idx] = getDisplayLUT(count);
-        return LookupTable[idx];
+        /* check whether LUT has already been computed for an equivalent display function */
+        if (LookupTable[idx] == NULL)
+            LookupTable[idx] = findLookupTable(count);
+        DiDisplayLUT *lut = LookupTable[idx];
+        cache.unlock();
+        if (lut == NULL)
+        {
+            /* first calculation of this LUT (without locking the cache) */
+            lut = getDisplayLUT(count);
+            if (lut != NULL)
+            {
+                cache.lock();
+                if (LookupTable[idx] == NULL)
+                {
+                    /* LUT might have been added by another thread in the meantime */
+                    DiDisplayLUT *cachedLUT = findLookupTable(count);
+                    if (cachedLUT != NULL)
+                    {
+                        delete lut;
+                        lut = cachedLUT;
+                    } else
+                        addLookupTable(lut);
+                    LookupTable[idx] = lut;
+                } else {
+                    delete lut;
+                    lut = LookupTable[idx];
+                }
+                cache.unlock();
+            }
+        }
+        return lut;
     }
     return NULL;
 }
@@ -266,16 +514,19 @@ const DiDisplayLUT *DiDisplayFunction::getLookupTable(const int bits,
 
 int DiDisplayFunction::deleteLookupTable(const int bits)
 {
+    int result = 0;
+    DiDisplayLUTCache &cache = getLUTCache();
+    cache.lock();
     if (bits == 0)
     {
         /* delete all LUTs */
         register int i;
         for (i = 0; i < MAX_NUMBER_OF_TABLES; ++i)
         {
-            delete LookupTable[i];
+            cache.release(LookupTable[i]);
             LookupTable[i] = NULL;
         }
-        return 1;
+        result = 1;
     }
     else if ((bits >= MinBits) && (bits <= MaxBits))
     {
@@ -283,13 +534,14 @@ int DiDisplayFunction::deleteLookupTable(const int bits)
         const int idx = bits - MinBits;
         if (LookupTable[idx] != NULL)
         {
-            delete LookupTable[idx];
+            cache.release(LookupTable[idx]);
             LookupTable[idx] = NULL;
-            return 1;
-        }
-        return 2;
+            result = 1;
+        } else
+            result = 2;
     }
-    return 0;
+    cache.unlock();
+    return result;
 }
 
 
@@ -677,3 +929,114 @@ double DiDisplayFunction::convertODtoLum(const double value,
     return (value >= 0) && (ambient >= 0) && (illum >= 0) ?
         ambient + illum * pow(OFstatic_cast(double, 10), -value) : -1 /*invalid*/;
 }
+
+
+void DiDisplayFunction::setLookupTableCacheSize(const unsigned long count)
+{
+    DiDisplayLUTCache &cache = getLUTCache();
+    cache.lock();
+    cache.MaxUnused = count;
+    cache.removeUnused();
+    cache.unlock();
+}
+
+
+unsigned long DiDisplayFunction::getNumberOfCachedLookupTables()
+{
+    DiDisplayLUTCache &cache = getLUTCache();
+    cache.lock();
+    const unsigned long result = (cache.Entries != NULL) ? OFstatic_cast(unsigned long, cache.Entries->size()) : 0;
+    cache.unlock();
+    return result;
+}
+
+
+/********************************************************************/
+
+
+const char *DiDisplayFunction::getFunctionType() const
+{
+    return NULL;
+}
+
+
+OFBool DiDisplayFunction::isCurrentLookupTable(const DiDisplayLUT *lut,
+                                               const unsigned long count) const
+{
+    DiDisplayLUTCache &cache = getLUTCache();
+    if (cache.Entries == NULL)
+        return OFFalse;
+    OFListIterator(DiDisplayLUTCacheEntry *) iter = cache.findEntry(lut);
+    if (iter != cache.Entries->end())
+    {
+        const DiDisplayLUTCacheEntry *entry = *iter;
+        return (entry->Count == count) && (entry->AmbientLight == AmbientLight) &&
+               (entry->Illumination == Illumination) && (entry->MinDensity == MinDensity) &&
+               (entry->MaxDensity == MaxDensity);
+    }
+    return OFFalse;
+}
+
+
+DiDisplayLUT *DiDisplayFunction::findLookupTable(const unsigned long count) const
+{
+    const char *type = getFunctionType();
+    OFList<DiDisplayLUTCacheEntry *> *entries = getLUTCache().Entries;
+    if ((type != NULL) && (entries != NULL))
+    {
+        OFListIterator(DiDisplayLUTCacheEntry *) iter = entries->begin();
+        while (iter != entries->end())
+        {
+            DiDisplayLUTCacheEntry *entry = *iter;
+            /* compare all parameters that have been used to compute the LUT */
+            if ((entry->FunctionType != NULL) && (strcmp(entry->FunctionType, type) == 0) &&
+                (entry->DeviceType == DeviceType) && (entry->MaxDDLValue == MaxDDLValue) &&
+                (entry->Order == Order) && (entry->ValueCount == ValueCount) && (entry->Count == count) &&
+                (entry->AmbientLight == AmbientLight) && (entry->Illumination == Illumination) &&
+                (entry->MinDensity == MinDensity) && (entry->MaxDensity == MaxDensity) &&
+                (memcmp(entry->DDLValue, DDLValue, ValueCount * sizeof(Uint16)) == 0) &&
+                (memcmp(entry->LODValue, LODValue, ValueCount * sizeof(double)) == 0))
+            {
+                /* make it the most recently used LUT */
+                entries->erase(iter);
+                entries->push_front(entry);
+                ++entry->RefCount;
+                return entry->LUT;
+            }
+            ++iter;
+        }
+    }
+    return NULL;
+}
+
+
+void DiDisplayFunction::addLookupTable(DiDisplayLUT *lut) const
+{
+    /* the LUT is not shared if the cache has already been cleaned up (at program exit) */
+    if (getLUTCache().Entries == NULL)
+        return;
+    DiDisplayLUTCacheEntry *entry = new DiDisplayLUTCacheEntry;
+    entry->FunctionType = getFunctionType();
+    entry->DeviceType = DeviceType;
+    entry->MaxDDLValue = MaxDDLValue;
+    entry->Order = Order;
+    entry->ValueCount = ValueCount;
+    entry->DDLValue = NULL;
+    entry->LODValue = NULL;
+    entry->AmbientLight = AmbientLight;
+    entry->Illumination = Illumination;
+    entry->MinDensity = MinDensity;
+    entry->MaxDensity = MaxDensity;
+    entry->Count = lut->getCount();
+    entry->LUT = lut;
+    entry->RefCount = 1;
+    /* the characteristic curve is only needed to identify equivalent display functions */
+    if (entry->FunctionType != NULL)
+    {
+        entry->DDLValue = new Uint16[ValueCount];
+        entry->LODValue = new double[ValueCount];
+        OFBitmanipTemplate<Uint16>::copyMem(DDLValue, entry->DDLValue, ValueCount);
+        OFBitmanipTemplate<double>::copyMem(LODValue, entry->LODValue, ValueCount);
+    }
+    getLUTCache().Entries->push_front(entry);
+}
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2011, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -36,7 +36,8 @@
 DiDocument::DiDocument(const char *filename,
                        const unsigned long flags,
                        const unsigned long fstart,
-                       const unsigned long fcount)
+                       const unsigned long fcount,
+                       const Uint32 threads)
   : Object(NULL),
     FileFormat(new DcmFileFormat()),
     PixelData(NULL),
@@ -44,6 +45,7 @@ DiDocument::DiDocument(const char *filename,
     FrameStart(fstart),
     FrameCount(fcount),
     Flags(flags),
+    NumberOfThreads((threads > 0) ? threads : 1),
     PhotometricInterpretation()
 {
     if (FileFormat)
@@ -69,7 +71,8 @@ DiDocument::DiDocument(DcmObject *object,
                        const E_TransferSyntax xfer,
                        const unsigned long flags,
                        const unsigned long fstart,
-                       const unsigned long fcount)
+                       const unsigned long fcount,
+                       const Uint32 threads)
   : Object(NULL),
     FileFormat(NULL),
     PixelData(NULL),
@@ -77,6 +80,7 @@ DiDocument::DiDocument(DcmObject *object,
     FrameStart(fstart),
     FrameCount(fcount),
     Flags(flags),
+    NumberOfThreads((threads > 0) ? threads : 1),
     PhotometricInterpretation()
 {
     if (object != NULL)
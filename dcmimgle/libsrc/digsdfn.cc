@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1999-2014, OFFIS e.V.
+ *  Copyright (C) 1999-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -167,6 +167,12 @@ DiDisplayLUT *DiGSDFunction::getDisplayLUT(unsigned long count)
 }
 
 
+const char *DiGSDFunction::getFunctionType() const
+{
+    return "GSDF";
+}
+
+
 int DiGSDFunction::writeCurveData(const char *filename,
                                   const OFBool mode)
 {
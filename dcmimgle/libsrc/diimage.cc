@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2014, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -265,11 +265,13 @@ DiImage::DiImage(const DiImage *image,
 DiImage::DiImage(const DiImage *image,
                  const Uint16 columns,
                  const Uint16 rows,
-                 const int aspect)
+                 const int aspect,
+                 const unsigned long fstart,
+                 const unsigned long fcount)
   : ImageStatus(image->ImageStatus),
     Document(image->Document),
-    FirstFrame(image->FirstFrame),
-    NumberOfFrames(image->NumberOfFrames),
+    FirstFrame(image->FirstFrame + fstart),
+    NumberOfFrames((fcount > 0) ? fcount : image->NumberOfFrames - fstart),
     TotalNumberOfFrames(image->TotalNumberOfFrames),
     RepresentativeFrame(image->RepresentativeFrame),
     FrameTime(image->FrameTime),
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2010, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -91,8 +91,11 @@ DiMono2Image::DiMono2Image(const DiMonoImage *image,
                            const Uint16 dest_rows,
                            const int interpolate,
                            const int aspect,
-                           const Uint16 pvalue)
-  : DiMonoImage(image, left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, interpolate, aspect, pvalue)
+                           const Uint16 pvalue,
+                           const unsigned long fstart,
+                           const unsigned long fcount)
+  : DiMonoImage(image, left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, interpolate, aspect, pvalue,
+                fstart, fcount)
 {
 }
 
@@ -168,11 +171,13 @@ DiImage *DiMono2Image::createScale(const signed long left_pos,
                                    const unsigned long dest_rows,
                                    const int interpolate,
                                    const int aspect,
-                                   const Uint16 pvalue) const
+                                   const Uint16 pvalue,
+                                   const unsigned long fstart,
+                                   const unsigned long fcount) const
 {
     DiImage *image = new DiMono2Image(this, left_pos, top_pos, OFstatic_cast(Uint16, src_cols),
         OFstatic_cast(Uint16, src_rows), OFstatic_cast(Uint16, dest_cols), OFstatic_cast(Uint16, dest_rows),
-        interpolate, aspect, pvalue);
+        interpolate, aspect, pvalue, fstart, fcount);
     return image;
 }
 
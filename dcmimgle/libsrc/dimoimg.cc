@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2013, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -317,8 +317,10 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
                          const Uint16 dest_rows,
                          const int interpolate,
                          const int aspect,
-                         const Uint16 pvalue)
-  : DiImage(image, dest_cols, dest_rows, aspect),
+                         const Uint16 pvalue,
+                         const unsigned long fstart,
+                         const unsigned long fcount)
+  : DiImage(image, dest_cols, dest_rows, aspect, fstart, fcount),
     WindowCenter(image->WindowCenter),
     WindowWidth(image->WindowWidth),
     WindowCount(image->WindowCount),
@@ -348,32 +350,32 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
             case EPR_Uint8:
                 InterData = new DiMonoScaleTemplate<Uint8>(image->InterData, image->Columns, image->Rows,
                     left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames,
-                    bits, interpolate, pvalue);
+                    bits, interpolate, pvalue, fstart, Document->getNumberOfThreads());
                 break;
             case EPR_Sint8:
                 InterData = new DiMonoScaleTemplate<Sint8>(image->InterData, image->Columns, image->Rows,
                     left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames,
-                    bits, interpolate, pvalue);
+                    bits, interpolate, pvalue, fstart, Document->getNumberOfThreads());
                 break;
             case EPR_Uint16:
                 InterData = new DiMonoScaleTemplate<Uint16>(image->InterData, image->Columns, image->Rows,
                     left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames,
-                    bits, interpolate, pvalue);
+                    bits, interpolate, pvalue, fstart, Document->getNumberOfThreads());
                 break;
             case EPR_Sint16:
                 InterData = new DiMonoScaleTemplate<Sint16>(image->InterData, image->Columns, image->Rows,
                     left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames,
-                    bits, interpolate, pvalue);
+                    bits, interpolate, pvalue, fstart, Document->getNumberOfThreads());
                 break;
             case EPR_Uint32:
                 InterData = new DiMonoScaleTemplate<Uint32>(image->InterData, image->Columns, image->Rows,
                     left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames,
-                    bits, interpolate, pvalue);
+                    bits, interpolate, pvalue, fstart, Document->getNumberOfThreads());
                 break;
             case EPR_Sint32:
                 InterData = new DiMonoScaleTemplate<Sint32>(image->InterData, image->Columns, image->Rows,
                     left_pos, top_pos, src_cols, src_rows, dest_cols, dest_rows, NumberOfFrames,
-                    bits, interpolate, pvalue);
+                    bits, interpolate, pvalue, fstart, Document->getNumberOfThreads());
                 break;
         }
     }
@@ -0,0 +1,67 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test images shared by the test programs
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "ditdata.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+
+#define INCLUDE_CSTDIO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+Uint16 getTestSample(Uint32 &seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return OFstatic_cast(Uint16, (seed >> 16) & 0x0fff);
+}
+
+
+DcmDataset *createMonochromeDataset(const Uint16 columns,
+                                    const Uint16 rows,
+                                    const Uint16 pixelRepresentation,
+                                    const unsigned long frames)
+{
+    const unsigned long count = OFstatic_cast(unsigned long, columns) * rows * frames;
+    DcmDataset *dataset = new DcmDataset();
+    if (frames > 1)
+    {
+        char buffer[32];
+        sprintf(buffer, "%lu", frames);
+        dataset->putAndInsertString(DCM_NumberOfFrames, buffer);
+    }
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertUint16(DCM_Rows, rows);
+    dataset->putAndInsertUint16(DCM_Columns, columns);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset->putAndInsertUint16(DCM_BitsStored, 12);
+    dataset->putAndInsertUint16(DCM_HighBit, 11);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, pixelRepresentation);
+    Uint16 *pixels = new Uint16[count];
+    Uint32 seed = 4711;
+    for (unsigned long i = 0; i < count; ++i)
+        pixels[i] = getTestSample(seed);
+    dataset->putAndInsertUint16Array(DCM_PixelData, pixels, count);
+    delete[] pixels;
+    return dataset;
+}
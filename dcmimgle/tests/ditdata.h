@@ -0,0 +1,52 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test images shared by the test programs
+ *
+ */
+
+
+#ifndef DITDATA_H
+#define DITDATA_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmdata/dcdatset.h"
+
+
+/** get the next value of a sequence of pseudo-random 12 bit samples. Unlike a
+ *  regular pattern, neighbouring samples, rows and frames all differ, so that
+ *  reading a sample from a wrong position changes the result of a test.
+ *  @param seed state of the sequence, updated by this function
+ *  @return sample value in the range 0..4095
+ */
+Uint16 getTestSample(Uint32 &seed);
+
+/** create a dataset with a 16 bit monochrome image (12 bits stored) that consists
+ *  of pseudo-random samples (see getTestSample())
+ *  @param columns number of columns
+ *  @param rows number of rows
+ *  @param pixelRepresentation pixel representation (0 = unsigned, 1 = signed)
+ *  @param frames number of frames
+ *  @return new dataset, to be deleted by the caller
+ */
+DcmDataset *createMonochromeDataset(const Uint16 columns,
+                                    const Uint16 rows,
+                                    const Uint16 pixelRepresentation,
+                                    const unsigned long frames = 1);
+
+#endif
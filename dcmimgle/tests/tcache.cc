@@ -0,0 +1,169 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the frame cache
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimgle/dicache.h"
+
+#define INCLUDE_CSTDIO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+static const Uint16 testColumns = 64;
+static const Uint16 testRows = 48;
+static const unsigned long testFrames = 10;
+
+
+/* get the expected value of the given pixel */
+static Uint16 getValue(const unsigned long frame,
+                       const unsigned long pos)
+{
+    return OFstatic_cast(Uint16, (frame * 1000 + pos * 7) % 4096);
+}
+
+
+/* create a DICOM file with a multi-frame 16 bit monochrome image */
+static OFBool createFile(const char *filename)
+{
+    const unsigned long fsize = OFstatic_cast(unsigned long, testColumns) * testRows;
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_MultiframeGrayscaleWordSecondaryCaptureImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.0.1");
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertString(DCM_NumberOfFrames, "10");
+    dataset->putAndInsertUint16(DCM_Rows, testRows);
+    dataset->putAndInsertUint16(DCM_Columns, testColumns);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset->putAndInsertUint16(DCM_BitsStored, 12);
+    dataset->putAndInsertUint16(DCM_HighBit, 11);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+    Uint16 *pixels = new Uint16[fsize * testFrames];
+    for (unsigned long f = 0; f < testFrames; ++f)
+    {
+        for (unsigned long i = 0; i < fsize; ++i)
+            pixels[f * fsize + i] = getValue(f, i);
+    }
+    dataset->putAndInsertUint16Array(DCM_PixelData, pixels, fsize * testFrames);
+    delete[] pixels;
+    return fileformat.saveFile(filename, EXS_LittleEndianExplicit).good();
+}
+
+
+/* check whether the given image contains the expected pixel data of the frame */
+static OFBool checkFrame(DicomImage *image,
+                         const unsigned long frame)
+{
+    if ((image == NULL) || (image->getFrameCount() != 1) || (image->getFirstFrame() != frame))
+        return OFFalse;
+    const DiPixel *inter = image->getInterData();
+    if ((inter == NULL) || (inter->getRepresentation() != EPR_Uint16) || (inter->getCount() != OFstatic_cast(unsigned long, testColumns) * testRows))
+        return OFFalse;
+    const Uint16 *data = OFstatic_cast(const Uint16 *, inter->getData());
+    for (unsigned long i = 0; i < inter->getCount(); ++i)
+    {
+        if (data[i] != getValue(frame, i))
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+
+OFTEST(dcmimgle_frameCache)
+{
+    const char *filename = "tcache_lru.dcm";
+    OFCHECK(createFile(filename));
+    {
+        DicomFrameCache cache(filename);
+        OFCHECK_EQUAL(cache.getStatus(), EIS_Normal);
+        OFCHECK_EQUAL(cache.getNumberOfFrames(), testFrames);
+        OFCHECK(checkFrame(cache.getFrame(0), 0));
+        // limit the cache to three frames
+        const unsigned long frameSize = cache.getCacheSize();
+        OFCHECK(frameSize > 0);
+        cache.setMaxSize(3 * frameSize);
+        OFCHECK(checkFrame(cache.getFrame(1), 1));
+        OFCHECK(checkFrame(cache.getFrame(2), 2));
+        OFCHECK(checkFrame(cache.getFrame(0), 0));
+        OFCHECK(checkFrame(cache.getFrame(3), 3));
+        // frame 1 is the least recently used one
+        OFCHECK_EQUAL(cache.getNumberOfCachedFrames(), 3UL);
+        OFCHECK(cache.isFrameCached(0));
+        OFCHECK(!cache.isFrameCached(1));
+        OFCHECK(cache.isFrameCached(2));
+        OFCHECK(cache.isFrameCached(3));
+        // random access to all frames
+        for (unsigned long i = 0; i < 2 * testFrames; ++i)
+        {
+            const unsigned long frame = (i * 7) % testFrames;
+            OFCHECK(checkFrame(cache.getFrame(frame), frame));
+            OFCHECK(cache.getCacheSize() <= 3 * frameSize);
+        }
+        OFCHECK(cache.getFrame(testFrames) == NULL);
+        // the frame returned last is never removed
+        cache.setMaxSize(0);
+        OFCHECK_EQUAL(cache.getNumberOfCachedFrames(), 1UL);
+    }
+    DicomFrameCache invalid("tcache_nonexistent.dcm");
+    OFCHECK(invalid.getStatus() != EIS_Normal);
+    OFCHECK(invalid.getFrame(0) == NULL);
+    remove(filename);
+}
+
+
+OFTEST(dcmimgle_frameCachePrefetch)
+{
+    const char *filename = "tcache_prefetch.dcm";
+    OFCHECK(createFile(filename));
+    {
+        DicomFrameCache cache(filename, 0, 64 * 1024 * 1024, 4 /*prefetch*/);
+        OFCHECK_EQUAL(cache.getStatus(), EIS_Normal);
+        OFCHECK(checkFrame(cache.getFrame(8), 8));
+        cache.waitForPrefetch();
+#ifdef WITH_THREADS
+        // the following frames (with wrap-around) are loaded in the background
+        OFCHECK_EQUAL(cache.getNumberOfCachedFrames(), 5UL);
+        OFCHECK(cache.isFrameCached(9));
+        OFCHECK(cache.isFrameCached(0));
+        OFCHECK(cache.isFrameCached(2));
+        OFCHECK(!cache.isFrameCached(3));
+#endif
+        // the frames loaded in advance do not replace each other
+        const unsigned long frameSize = cache.getCacheSize() / cache.getNumberOfCachedFrames();
+        cache.setMaxSize(3 * frameSize);
+        for (unsigned long i = 0; i < 3 * testFrames; ++i)
+        {
+            const unsigned long frame = i % testFrames;
+            OFCHECK(checkFrame(cache.getFrame(frame), frame));
+        }
+        cache.waitForPrefetch();
+        OFCHECK(cache.getNumberOfCachedFrames() <= 3);
+        OFCHECK(cache.getCacheSize() <= 3 * frameSize);
+    }
+    remove(filename);
+}
@@ -0,0 +1,39 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: main test program
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oftest.h"
+
+OFTEST_REGISTER(dcmimgle_renderWindow);
+OFTEST_REGISTER(dcmimgle_renderSigmoid);
+OFTEST_REGISTER(dcmimgle_renderNoWindow);
+OFTEST_REGISTER(dcmimgle_renderVoiLut);
+OFTEST_REGISTER(dcmimgle_displayLUTCache);
+OFTEST_REGISTER(dcmimgle_scaleAreaAverage);
+OFTEST_REGISTER(dcmimgle_scaleAreaAverageThreads);
+OFTEST_REGISTER(dcmimgle_scaleAreaAverageFrames);
+OFTEST_REGISTER(dcmimgle_scaleAreaAverageColor);
+OFTEST_REGISTER(dcmimgle_renderRegion);
+OFTEST_REGISTER(dcmimgle_renderRegionBorder);
+OFTEST_REGISTER(dcmimgle_frameCache);
+OFTEST_REGISTER(dcmimgle_frameCachePrefetch);
+OFTEST_MAIN("dcmimgle")
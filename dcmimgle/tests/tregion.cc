@@ -0,0 +1,115 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the rendering of image regions
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "ditdata.h"
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/* check whether the rendered region is identical to the corresponding part of the rendered frame */
+static OFBool compareRegion(DicomImage &image,
+                            const unsigned long frame,
+                            const signed long left,
+                            const signed long top,
+                            const unsigned long width,
+                            const unsigned long height)
+{
+    const Uint8 *data = OFstatic_cast(const Uint8 *, image.getOutputData(8, frame));
+    Uint8 *region = new Uint8[width * height];
+    OFBool result = (data != NULL) && image.getRegionOutputData(region, width * height, left, top, width, height, 0, 0, 8, frame);
+    for (unsigned long y = 0; (y < height) && result; ++y)
+        result = (memcmp(region + y * width, data + (top + y) * image.getWidth() + left, width) == 0);
+    delete[] region;
+    return result;
+}
+
+
+OFTEST(dcmimgle_renderRegion)
+{
+    DicomImage image(createMonochromeDataset(320, 240, 0, 3 /*frames*/), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset);
+    OFCHECK_EQUAL(image.getStatus(), EIS_Normal);
+    OFCHECK_EQUAL(image.getFrameCount(), 3UL);
+    image.setWindow(1500, 2000);
+    // the region has to be identical to the corresponding part of the whole frame
+    OFCHECK(compareRegion(image, 0, 0, 0, 320, 240));
+    OFCHECK(compareRegion(image, 0, 17, 33, 64, 64));
+    OFCHECK(compareRegion(image, 1, 256, 176, 64, 64));
+    OFCHECK(compareRegion(image, 2, 100, 0, 1, 240));
+    image.setNoVoiTransformation();
+    OFCHECK(compareRegion(image, 2, 5, 7, 100, 50));
+    // invalid parameters
+    Uint8 buffer[16];
+    OFCHECK(!image.getRegionOutputData(buffer, sizeof(buffer), 0, 0, 4, 4, 0, 0, 8, 3 /*frame*/));
+    OFCHECK(!image.getRegionOutputData(buffer, sizeof(buffer), 0, 0, 0, 4));
+    OFCHECK(!image.getRegionOutputData(buffer, sizeof(buffer), 0, 0, 8, 8));
+}
+
+
+OFTEST(dcmimgle_renderRegionBorder)
+{
+    DicomImage image(createMonochromeDataset(32, 24, 0, 2 /*frames*/), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset);
+    OFCHECK_EQUAL(image.getStatus(), EIS_Normal);
+    image.setWindow(2048, 4096);
+    const Uint8 *data = OFstatic_cast(const Uint8 *, image.getOutputData(8, 1));
+    OFCHECK(data != NULL);
+    // magnify an area that exceeds the image on each side by a factor of 2 (replication)
+    const unsigned long width = 2 * 40;
+    const unsigned long height = 2 * 30;
+    Uint8 *region = new Uint8[width * height];
+    OFCHECK(image.getRegionOutputData(region, width * height, -4, -3, 40, 30, width, height, 8, 1 /*frame*/));
+    if (data != NULL)
+    {
+        OFBool inside = OFTrue;
+        OFBool border = OFTrue;
+        for (unsigned long y = 0; y < height; ++y)
+        {
+            for (unsigned long x = 0; x < width; ++x)
+            {
+                const signed long sx = OFstatic_cast(signed long, x / 2) - 4;
+                const signed long sy = OFstatic_cast(signed long, y / 2) - 3;
+                if ((sx >= 0) && (sx < 32) && (sy >= 0) && (sy < 24))
+                    inside &= (region[y * width + x] == data[sy * 32 + sx]);
+                else
+                    border &= (region[y * width + x] == region[0]);
+            }
+        }
+        OFCHECK(inside);
+        OFCHECK(border);
+    }
+    // the same area reduced by area averaging has to be consistent with the scaled image
+    const unsigned long count = 20 * 15;
+    OFCHECK(image.getRegionOutputData(region, count, -4, -3, 40, 30, 20, 15, 8, 0 /*frame*/, 5 /*interpolate*/));
+    DicomImage *scaled = image.createScaledImage(-4L, -3L, 40UL, 30UL, 20UL, 15UL, 5 /*interpolate*/);
+    OFCHECK(scaled != NULL);
+    if (scaled != NULL)
+    {
+        const Uint8 *scaledData = OFstatic_cast(const Uint8 *, scaled->getOutputData(8, 0));
+        OFCHECK((scaledData != NULL) && (memcmp(region, scaledData, count) == 0));
+        delete scaled;
+    }
+    delete[] region;
+}
@@ -0,0 +1,302 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the rendering of monochrome images
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcvrus.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimgle/digsdfn.h"
+#include "dcmtk/dcmimgle/diciefn.h"
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/* The monochrome output is either computed for each pixel or by means of an
+ * optimization LUT, depending on the number of pixels compared to the number
+ * of possible pixel values. The following tests render images that contain all
+ * possible pixel values once (computed for each pixel) and twice (computed by
+ * means of the LUT), and check that both results are identical.
+ */
+
+/* description of the stored pixel data */
+struct PixelFormat
+{
+    Uint16 bitsStored;
+    Uint16 pixelRepresentation;
+    const char *rescaleIntercept;
+    Uint16 columns;
+};
+
+static const PixelFormat pixelFormats[] =
+{
+    {  8, 0, NULL,    16 },    // Uint8 intermediate data
+    { 12, 0, NULL,    64 },    // Uint16 intermediate data
+    { 12, 1, NULL,    64 },    // Sint16 intermediate data
+    { 16, 0, NULL,   256 },    // Uint16 intermediate data
+    { 16, 1, NULL,   256 },    // Sint16 intermediate data
+    { 16, 0, "-1024", 256 }    // Sint32 intermediate data
+};
+
+/* kinds of VOI transformation */
+enum VoiMode
+{
+    VM_Window,
+    VM_Sigmoid,
+    VM_NoWindow,
+    VM_VoiLut
+};
+
+
+/* create a dataset with 'copies' times all possible pixel values */
+static DcmDataset *createDataset(const PixelFormat &format,
+                                 const unsigned long copies)
+{
+    const unsigned long values = 1UL << format.bitsStored;
+    const unsigned long count = values * copies;
+    DcmDataset *dataset = new DcmDataset();
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertUint16(DCM_Rows, OFstatic_cast(Uint16, count / format.columns));
+    dataset->putAndInsertUint16(DCM_Columns, format.columns);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, (format.bitsStored > 8) ? 16 : 8);
+    dataset->putAndInsertUint16(DCM_BitsStored, format.bitsStored);
+    dataset->putAndInsertUint16(DCM_HighBit, format.bitsStored - 1);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, format.pixelRepresentation);
+    if (format.rescaleIntercept != NULL)
+    {
+        dataset->putAndInsertString(DCM_RescaleIntercept, format.rescaleIntercept);
+        dataset->putAndInsertString(DCM_RescaleSlope, "1");
+    }
+    if (format.bitsStored > 8)
+    {
+        Uint16 *pixels = new Uint16[count];
+        for (unsigned long i = 0; i < count; ++i)
+            pixels[i] = OFstatic_cast(Uint16, (i * 7) % values);   // all values, but not in sequential order
+        dataset->putAndInsertUint16Array(DCM_PixelData, pixels, count);
+        delete[] pixels;
+    } else {
+        Uint8 *pixels = new Uint8[count];
+        for (unsigned long i = 0; i < count; ++i)
+            pixels[i] = OFstatic_cast(Uint8, (i * 7) % values);
+        dataset->putAndInsertUint8Array(DCM_PixelData, pixels, count);
+        delete[] pixels;
+    }
+    return dataset;
+}
+
+
+/* render the given image and return a copy of the output data */
+static Uint8 *renderImage(DicomImage &image,
+                          const PixelFormat &format,
+                          const VoiMode mode,
+                          const int bits,
+                          const OFBool inverse,
+                          const DcmUnsignedShort *lutData,
+                          const DcmUnsignedShort *lutDescriptor,
+                          unsigned long &size)
+{
+    const double range = OFstatic_cast(double, 1UL << format.bitsStored);
+    const double offset = (format.pixelRepresentation == 1) ? -range / 2 : 0;
+    switch (mode)
+    {
+        case VM_Window:
+            image.setVoiLutFunction(EFV_Linear);
+            image.setWindow(offset + range / 3, range / 2);
+            break;
+        case VM_Sigmoid:
+            image.setVoiLutFunction(EFV_Sigmoid);
+            image.setWindow(offset + range / 3, range / 2);
+            break;
+        case VM_NoWindow:
+            image.setNoVoiTransformation();
+            break;
+        case VM_VoiLut:
+            image.setVoiLut(*lutData, *lutDescriptor);
+            break;
+    }
+    image.setPolarity(inverse ? EPP_Reverse : EPP_Normal);
+    size = image.getOutputDataSize(bits);
+    const void *data = image.getOutputData(bits);
+    if ((data == NULL) || (size == 0))
+        return NULL;
+    Uint8 *result = new Uint8[size];
+    memcpy(result, data, size);
+    return result;
+}
+
+
+static void checkRendering(const VoiMode mode)
+{
+    // presentation LUT and VOI LUT with a non-linear shape
+    const Uint16 lutEntries = 1024;
+    Uint16 lut[lutEntries];
+    for (Uint16 i = 0; i < lutEntries; ++i)
+        lut[i] = OFstatic_cast(Uint16, (OFstatic_cast(unsigned long, i) * i) / 16);   // 0..65535
+    DcmUnsignedShort plutData(DCM_LUTData);
+    DcmUnsignedShort plutDescriptor(DCM_LUTDescriptor);
+    plutData.putUint16Array(lut, lutEntries);
+    plutDescriptor.putUint16(lutEntries, 0);
+    plutDescriptor.putUint16(0, 1);
+    plutDescriptor.putUint16(16, 2);
+    // display function (GSDF)
+    DiGSDFunction display(0.5, 400.0, 256);
+    OFCHECK(display.isValid());
+
+    const size_t formats = sizeof(pixelFormats) / sizeof(pixelFormats[0]);
+    for (size_t f = 0; f < formats; ++f)
+    {
+        const PixelFormat &format = pixelFormats[f];
+        // VOI LUT covering the middle part of the possible pixel values
+        DcmUnsignedShort vlutData(DCM_LUTData);
+        DcmUnsignedShort vlutDescriptor(DCM_LUTDescriptor);
+        vlutData.putUint16Array(lut, lutEntries);
+        vlutDescriptor.putUint16(lutEntries, 0);
+        const long firstMapped = (format.pixelRepresentation == 1) ? -(1L << (format.bitsStored - 2)) : (1L << (format.bitsStored - 2));
+        vlutDescriptor.putUint16(OFstatic_cast(Uint16, firstMapped), 1);
+        vlutDescriptor.putUint16(16, 2);
+
+        // the images take over the datasets
+        DicomImage singleImage(createDataset(format, 1), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset);
+        DicomImage twiceImage(createDataset(format, 2), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset);
+        OFCHECK_EQUAL(singleImage.getStatus(), EIS_Normal);
+        OFCHECK_EQUAL(twiceImage.getStatus(), EIS_Normal);
+        for (int bits = 8; bits <= 16; bits += 8)
+        {
+            for (int variant = 0; variant < 8; ++variant)
+            {
+                const OFBool inverse = (variant & 1) != 0;
+                const OFBool usePLut = (variant & 2) != 0;
+                const OFBool useDisplay = (variant & 4) != 0;
+                // the display function is defined for 8 bit output only
+                if (useDisplay && (bits != 8))
+                    continue;
+                if (usePLut)
+                {
+                    singleImage.setPresentationLut(plutData, plutDescriptor);
+                    twiceImage.setPresentationLut(plutData, plutDescriptor);
+                } else {
+                    singleImage.setPresentationLutShape(ESP_Default);
+                    twiceImage.setPresentationLutShape(ESP_Default);
+                }
+                if (useDisplay)
+                {
+                    singleImage.setDisplayFunction(&display);
+                    twiceImage.setDisplayFunction(&display);
+                } else {
+                    singleImage.setNoDisplayFunction();
+                    twiceImage.setNoDisplayFunction();
+                }
+                unsigned long singleSize = 0;
+                unsigned long twiceSize = 0;
+                Uint8 *singleData = renderImage(singleImage, format, mode, bits, inverse, &vlutData, &vlutDescriptor, singleSize);
+                Uint8 *twiceData = renderImage(twiceImage, format, mode, bits, inverse, &vlutData, &vlutDescriptor, twiceSize);
+                OFCHECK(singleData != NULL);
+                OFCHECK(twiceData != NULL);
+                if ((singleData != NULL) && (twiceData != NULL))
+                {
+                    OFCHECK_EQUAL(2 * singleSize, twiceSize);
+                    // both halves of the second image are expected to match the first image
+                    if (2 * singleSize == twiceSize)
+                    {
+                        if ((memcmp(singleData, twiceData, singleSize) != 0) || (memcmp(singleData, twiceData + singleSize, singleSize) != 0))
+                        {
+                            OFOStringStream oss;
+                            oss << "output differs for " << format.bitsStored << " bits stored"
+                                << ((format.pixelRepresentation == 1) ? " (signed)" : " (unsigned)")
+                                << ((format.rescaleIntercept != NULL) ? " with rescale" : "")
+                                << ", " << bits << " bits output, variant " << variant << OFStringStream_ends;
+                            OFSTRINGSTREAM_GETOFSTRING(oss, message)
+                            OFCHECK_FAIL(message);
+                        }
+                    }
+                }
+                delete[] singleData;
+                delete[] twiceData;
+            }
+        }
+    }
+}
+
+
+OFTEST(dcmimgle_renderWindow)
+{
+    checkRendering(VM_Window);
+}
+
+OFTEST(dcmimgle_renderSigmoid)
+{
+    checkRendering(VM_Sigmoid);
+}
+
+OFTEST(dcmimgle_renderNoWindow)
+{
+    checkRendering(VM_NoWindow);
+}
+
+OFTEST(dcmimgle_renderVoiLut)
+{
+    checkRendering(VM_VoiLut);
+}
+
+
+OFTEST(dcmimgle_displayLUTCache)
+{
+    // remove LUTs of previous tests that are not used any longer
+    DiDisplayFunction::setLookupTableCacheSize(0);
+    OFCHECK_EQUAL(DiDisplayFunction::getNumberOfCachedLookupTables(), 0UL);
+    DiDisplayFunction::setLookupTableCacheSize(16);
+    {
+        DiGSDFunction display1(0.5, 400.0, 256);
+        DiGSDFunction display2(0.5, 400.0, 256);
+        DiGSDFunction display3(0.5, 300.0, 256);
+        DiCIELABFunction display4(0.5, 400.0, 256);
+        const DiDisplayLUT *lut = display1.getLookupTable(12);
+        OFCHECK(lut != NULL);
+        // equivalent display functions share the same LUT
+        OFCHECK(display2.getLookupTable(12) == lut);
+        OFCHECK(display3.getLookupTable(12) != lut);
+        OFCHECK(display4.getLookupTable(12) != lut);
+        OFCHECK(display1.getLookupTable(8) != lut);
+        OFCHECK_EQUAL(DiDisplayFunction::getNumberOfCachedLookupTables(), 4UL);
+        // a different ambient light value requires a new LUT
+        display2.setAmbientLightValue(2.0);
+        const DiDisplayLUT *lut2 = display2.getLookupTable(12);
+        OFCHECK((lut2 != NULL) && (lut2 != lut));
+        OFCHECK(display1.getLookupTable(12) == lut);
+        // deleting the LUT of one display function does not affect the other one
+        OFCHECK_EQUAL(display2.deleteLookupTable(12), 1);
+        OFCHECK(display1.getLookupTable(12) == lut);
+        OFCHECK_EQUAL(DiDisplayFunction::getNumberOfCachedLookupTables(), 5UL);
+    }
+    // unused LUTs are kept in the cache until the limit is exceeded
+    OFCHECK_EQUAL(DiDisplayFunction::getNumberOfCachedLookupTables(), 5UL);
+    DiGSDFunction display(0.5, 400.0, 256);
+    OFCHECK(display.getLookupTable(12) != NULL);
+    OFCHECK_EQUAL(DiDisplayFunction::getNumberOfCachedLookupTables(), 5UL);
+    DiDisplayFunction::setLookupTableCacheSize(0);
+    OFCHECK_EQUAL(DiDisplayFunction::getNumberOfCachedLookupTables(), 1UL);
+    DiDisplayFunction::setLookupTableCacheSize(16);
+}
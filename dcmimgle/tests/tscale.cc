@@ -0,0 +1,263 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the scaling of monochrome images
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimgle/discalet.h"
+#include "ditdata.h"
+
+#define INCLUDE_CSTDLIB
+#define INCLUDE_CMATH
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/* get the intermediate pixel value at the given position (as a signed number) */
+static long getPixel(const DicomImage &image,
+                     const unsigned long x,
+                     const unsigned long y,
+                     const unsigned long frame = 0)
+{
+    const DiPixel *inter = image.getInterData();
+    const unsigned long pos = (frame * image.getHeight() + y) * image.getWidth() + x;
+    switch (inter->getRepresentation())
+    {
+        case EPR_Uint16:
+            return OFstatic_cast(const Uint16 *, inter->getData())[pos];
+        case EPR_Sint16:
+            return OFstatic_cast(const Sint16 *, inter->getData())[pos];
+        default:
+            return 0;
+    }
+}
+
+
+/* compute the mean value of the given source block with correct rounding */
+static long getMean(const DicomImage &image,
+                    const unsigned long left,
+                    const unsigned long top,
+                    const unsigned long width,
+                    const unsigned long height,
+                    const unsigned long frame = 0)
+{
+    long sum = 0;
+    for (unsigned long y = top; y < top + height; ++y)
+    {
+        for (unsigned long x = left; x < left + width; ++x)
+            sum += getPixel(image, x, y, frame);
+    }
+    const double mean = OFstatic_cast(double, sum) / (width * height);
+    return OFstatic_cast(long, (mean < 0) ? mean - 0.5 : mean + 0.5);
+}
+
+
+/* compute the mean value of the given source area, weighted by the covered part of each pixel */
+static double getAreaMean(const DicomImage &image,
+                          const double left,
+                          const double right,
+                          const double top,
+                          const double bottom)
+{
+    double sum = 0;
+    for (unsigned long y = OFstatic_cast(unsigned long, top); y < bottom; ++y)
+    {
+        const double h = ((y + 1 < bottom) ? y + 1 : bottom) - ((y > top) ? y : top);
+        for (unsigned long x = OFstatic_cast(unsigned long, left); x < right; ++x)
+        {
+            const double w = ((x + 1 < right) ? x + 1 : right) - ((x > left) ? x : left);
+            sum += getPixel(image, x, y) * w * h;
+        }
+    }
+    return sum / ((right - left) * (bottom - top));
+}
+
+
+static void checkAreaAverage(const Uint16 pixelRepresentation)
+{
+    DicomImage image(createMonochromeDataset(300, 200, pixelRepresentation), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset);
+    OFCHECK_EQUAL(image.getStatus(), EIS_Normal);
+
+    // integer factor: each pixel is the mean value of a 3x2 block
+    DicomImage *scaled = image.createScaledImage(100UL, 100UL, 5 /*area averaging*/);
+    OFCHECK(scaled != NULL);
+    if (scaled != NULL)
+    {
+        OFCHECK_EQUAL(scaled->getWidth(), 100UL);
+        OFCHECK_EQUAL(scaled->getHeight(), 100UL);
+        OFBool identical = OFTrue;
+        for (unsigned long y = 0; (y < 100) && identical; ++y)
+        {
+            for (unsigned long x = 0; (x < 100) && identical; ++x)
+                identical = (getPixel(*scaled, x, y) == getMean(image, x * 3, y * 2, 3, 2));
+        }
+        OFCHECK(identical);
+        delete scaled;
+    }
+
+    // arbitrary factor: the result should not differ from the c't algorithm by more than 1
+    DicomImage *scaled1 = image.createScaledImage(77UL, 61UL, 5 /*area averaging*/);
+    DicomImage *scaled2 = image.createScaledImage(77UL, 61UL, 2 /*c't algorithm*/);
+    OFCHECK(scaled1 != NULL);
+    OFCHECK(scaled2 != NULL);
+    if ((scaled1 != NULL) && (scaled2 != NULL))
+    {
+        long maxDiff = 0;
+        for (unsigned long y = 0; y < 61; ++y)
+        {
+            for (unsigned long x = 0; x < 77; ++x)
+            {
+                const long diff = labs(getPixel(*scaled1, x, y) - getPixel(*scaled2, x, y));
+                if (diff > maxDiff)
+                    maxDiff = diff;
+            }
+        }
+        OFCHECK(maxDiff <= 1);
+    }
+    delete scaled1;
+    delete scaled2;
+}
+
+
+OFTEST(dcmimgle_scaleAreaAverage)
+{
+    checkAreaAverage(0 /*unsigned*/);
+    checkAreaAverage(1 /*signed*/);
+}
+
+
+OFTEST(dcmimgle_scaleAreaAverageThreads)
+{
+    DicomImage image(createMonochromeDataset(509, 311, 0), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset, 0UL, 0UL, 1 /*thread*/);
+    DicomImage imageThreads(createMonochromeDataset(509, 311, 0), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset, 0UL, 0UL, 5 /*threads*/);
+    OFCHECK_EQUAL(image.getStatus(), EIS_Normal);
+    OFCHECK_EQUAL(imageThreads.getStatus(), EIS_Normal);
+    // the result has to be identical for any number of threads
+    DicomImage *scaled1 = image.createScaledImage(1L, 1L, 250UL, 300UL, 113UL, 97UL, 5 /*area averaging*/);
+    DicomImage *scaled2 = imageThreads.createScaledImage(1L, 1L, 250UL, 300UL, 113UL, 97UL, 5 /*area averaging*/);
+    OFCHECK(scaled1 != NULL);
+    OFCHECK(scaled2 != NULL);
+    if ((scaled1 != NULL) && (scaled2 != NULL))
+    {
+        OFBool identical = OFTrue;
+        for (unsigned long y = 0; (y < 97) && identical; ++y)
+        {
+            for (unsigned long x = 0; (x < 113) && identical; ++x)
+                identical = (getPixel(*scaled1, x, y) == getPixel(*scaled2, x, y));
+        }
+        OFCHECK(identical);
+        // each pixel covers a block of about 2.2 x 3.1 pixels of the clipping area
+        const double x_factor = 250.0 / 113.0;
+        const double y_factor = 300.0 / 97.0;
+        OFBool correct = OFTrue;
+        for (unsigned long y = 0; (y < 97) && correct; ++y)
+        {
+            for (unsigned long x = 0; (x < 113) && correct; ++x)
+            {
+                const double mean = getAreaMean(image, 1 + x * x_factor, 1 + (x + 1) * x_factor,
+                                                1 + y * y_factor, 1 + (y + 1) * y_factor);
+                correct = (fabs(OFstatic_cast(double, getPixel(*scaled1, x, y)) - mean) <= 0.5 + 1e-6);
+            }
+        }
+        OFCHECK(correct);
+    }
+    delete scaled1;
+    delete scaled2;
+}
+
+
+OFTEST(dcmimgle_scaleAreaAverageFrames)
+{
+    DicomImage image(createMonochromeDataset(120, 90, 0, 3 /*frames*/), EXS_LittleEndianExplicit, CIF_TakeOverExternalDataset, 0, 3);
+    OFCHECK_EQUAL(image.getStatus(), EIS_Normal);
+    OFCHECK_EQUAL(image.getFrameCount(), 3UL);
+    // each pixel of each frame is the mean value of a 4x3 block of the same frame
+    DicomImage *scaled = image.createScaledImage(30UL, 30UL, 5 /*area averaging*/);
+    OFCHECK(scaled != NULL);
+    if (scaled != NULL)
+    {
+        OFCHECK_EQUAL(scaled->getFrameCount(), 3UL);
+        OFBool identical = OFTrue;
+        for (unsigned long f = 0; (f < 3) && identical; ++f)
+        {
+            for (unsigned long y = 0; (y < 30) && identical; ++y)
+            {
+                for (unsigned long x = 0; (x < 30) && identical; ++x)
+                    identical = (getPixel(*scaled, x, y, f) == getMean(image, x * 4, y * 3, 4, 3, f));
+            }
+        }
+        OFCHECK(identical);
+        delete scaled;
+    }
+}
+
+
+OFTEST(dcmimgle_scaleAreaAverageColor)
+{
+    // three planes and two frames, as used for color images (see DiColorScaleTemplate)
+    const Uint16 columns = 60;
+    const Uint16 rows = 40;
+    const Uint32 frames = 2;
+    const unsigned long srcCount = OFstatic_cast(unsigned long, columns) * rows * frames;
+    const unsigned long destCount = 20UL * 10UL * frames;
+    Uint16 *src[3];
+    Uint16 *dest[3];
+    int plane;
+    Uint32 seed = 4711;
+    for (plane = 0; plane < 3; ++plane)
+    {
+        src[plane] = new Uint16[srcCount];
+        for (unsigned long i = 0; i < srcCount; ++i)
+            src[plane][i] = getTestSample(seed);
+        dest[plane] = new Uint16[destCount];
+    }
+    DiScaleTemplate<Uint16> scale(3, columns, rows, 0, 0, columns, rows, 20, 10, frames);
+    scale.scaleData(OFconst_cast(const Uint16 **, src), dest, 5 /*area averaging*/);
+    // each pixel is the mean value of a 3x4 block of the same plane and frame
+    OFBool identical = OFTrue;
+    for (plane = 0; (plane < 3) && identical; ++plane)
+    {
+        for (unsigned long f = 0; (f < frames) && identical; ++f)
+        {
+            for (unsigned long y = 0; (y < 10) && identical; ++y)
+            {
+                for (unsigned long x = 0; (x < 20) && identical; ++x)
+                {
+                    unsigned long sum = 0;
+                    for (unsigned long sy = y * 4; sy < y * 4 + 4; ++sy)
+                    {
+                        for (unsigned long sx = x * 3; sx < x * 3 + 3; ++sx)
+                            sum += src[plane][(f * rows + sy) * columns + sx];
+                    }
+                    const Uint16 mean = OFstatic_cast(Uint16, (sum + 6) / 12);
+                    identical = (dest[plane][(f * 10 + y) * 20 + x] == mean);
+                }
+            }
+        }
+    }
+    OFCHECK(identical);
+    for (plane = 0; plane < 3; ++plane)
+    {
+        delete[] src[plane];
+        delete[] dest[plane];
+    }
+}
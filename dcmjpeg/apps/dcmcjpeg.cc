@@ -103,6 +103,7 @@ int main(int argc, char *argv[])
   OFBool           opt_usePixelValues = OFTrue;
   OFBool           opt_useModalityRescale = OFFalse;
   OFBool           opt_trueLossless = OFTrue;
+  OFCmdUnsignedInt opt_threads = 1;
   OFBool           lossless = OFTrue;  /* see opt_oxfer */
 
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "Encode DICOM file to JPEG transfer syntax", rcsid);
@@ -188,6 +189,9 @@ int main(int argc, char *argv[])
       cmd.addOption("--nonstd-422-full",     "+n2",    "4:2:2 subsampling with YBR_FULL");
       cmd.addOption("--nonstd-411-full",     "+n1",    "4:1:1 subsampling with YBR_FULL");
       cmd.addOption("--nonstd-411",          "+np",    "4:1:1 subsampling with YBR_FULL_422");
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",             "+mt", 1, "[n]umber: integer (default: 1)",
+                                                       "use n threads for compressing the frames\nof multi-frame images");
 
   cmd.addGroup("encapsulated pixel data encoding options:");
     cmd.addSubGroup("pixel data fragmentation:");
@@ -557,6 +561,9 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--uid-never")) opt_uidcreation = EUC_never;
       cmd.endOptionBlock();
 
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMin(opt_threads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--enable-new-vr")) dcmEnableGenerationOfNewVRs();
       if (cmd.findOption("--disable-new-vr")) dcmDisableGenerationOfNewVRs();
@@ -618,7 +625,8 @@ int main(int argc, char *argv[])
       opt_useModalityRescale,
       opt_acceptWrongPaletteTags,
       opt_acrNemaCompatibility,
-      opt_trueLossless);
+      opt_trueLossless,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2001-2014, OFFIS e.V.
+ *  Copyright (C) 2001-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -35,6 +35,7 @@
 #include "dcmtk/ofstd/ofconapp.h"
 #include "dcmtk/dcmdata/dcuid.h"       /* for dcmtk version name */
 #include "dcmtk/dcmjpeg/djdecode.h"    /* for dcmjpeg decoders */
+#include "dcmtk/dcmjpeg/djrpres.h"     /* for class DJ_RPReducedResolution */
 #include "dcmtk/dcmjpeg/dipijpeg.h"    /* for dcmimage JPEG plugin */
 
 #ifdef WITH_ZLIB
@@ -80,6 +81,8 @@ int main(int argc, char *argv[])
   E_UIDCreation opt_uidcreation = EUC_default;
   E_PlanarConfiguration opt_planarconfig = EPC_default;
   OFBool opt_predictor6WorkaroundEnable = OFFalse;
+  OFCmdUnsignedInt opt_threads = 1;
+  OFCmdUnsignedInt opt_reducedResolutionSize = 0;
 
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "Decode JPEG-compressed DICOM file", rcsid);
   OFCommandLine cmd;
@@ -121,6 +124,14 @@ int main(int argc, char *argv[])
     cmd.addSubGroup("workaround options for incorrect JPEG encodings:");
       cmd.addOption("--workaround-pred6",    "+w6",    "enable workaround for JPEG lossless images\nwith overflow in predictor 6");
 
+    cmd.addSubGroup("image size:");
+      cmd.addOption("--reduced-resolution",  "+rr", 1, "[s]ize: integer",
+                                                       "decompress lossy JPEG with reduced resolution\n(1/2, 1/4 or 1/8), at least s pixels wide or high");
+
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",             "+mt", 1, "[n]umber: integer (default: 1)",
+                                                       "use n threads for decompressing the frames\nof multi-frame images");
+
   cmd.addGroup("output options:");
     cmd.addSubGroup("output file format:");
       cmd.addOption("--write-file",          "+F",     "write file format (default)");
@@ -195,6 +206,12 @@ int main(int argc, char *argv[])
 
       if (cmd.findOption("--workaround-pred6")) opt_predictor6WorkaroundEnable = OFTrue;
 
+      if (cmd.findOption("--reduced-resolution"))
+        app.checkValue(cmd.getValueAndCheckMinMax(opt_reducedResolutionSize, 1, 65535));
+
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMin(opt_threads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--read-file"))
       {
@@ -272,7 +289,8 @@ int main(int argc, char *argv[])
       opt_decompCSconversion,
       opt_uidcreation,
       opt_planarconfig,
-      opt_predictor6WorkaroundEnable);
+      opt_predictor6WorkaroundEnable,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
@@ -308,7 +326,9 @@ int main(int argc, char *argv[])
     DcmXfer opt_oxferSyn(opt_oxfer);
     DcmXfer original_xfer(dataset->getOriginalXfer());
 
-    error = dataset->chooseRepresentation(opt_oxfer, NULL);
+    // the minimum size for a reduced resolution is passed with the decompressed representation
+    DJ_RPReducedResolution rp_reduced(OFstatic_cast(Uint16, opt_reducedResolutionSize));
+    error = dataset->chooseRepresentation(opt_oxfer, (opt_reducedResolutionSize > 0) ? &rp_reduced : NULL);
     if (error.bad())
     {
         OFLOG_FATAL(dcmdjpegLogger, error.text() << ": decompressing file: " <<  opt_ifname);
@@ -328,7 +348,7 @@ int main(int argc, char *argv[])
     OFLOG_INFO(dcmdjpegLogger, "creating output file " << opt_ofname);
 
     // update file meta information with new SOP Instance UID
-    if ((opt_uidcreation == EUC_always) && (opt_writeMode == EWM_fileformat))
+    if (((opt_uidcreation == EUC_always) || (opt_reducedResolutionSize > 0)) && (opt_writeMode == EWM_fileformat))
         opt_writeMode = EWM_updateMeta;
 
     fileformat.loadAllDataIntoMemory();
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2001-2011, OFFIS e.V.
+ *  Copyright (C) 2001-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -70,6 +70,29 @@ public:
     const DcmCodecParameter * cp,
     const DcmStack& objStack) const;
 
+  /** decompresses the given pixel sequence and stores the result in the given
+   *  uncompressedPixelData element. A lossy JPEG image is decompressed with reduced
+   *  resolution if toRepParam is an instance of class DJ_RPReducedResolution. In this
+   *  case, Rows, Columns, the pixel spacing attributes (also in the functional groups)
+   *  and the overlay planes are updated, and a new SOP Instance UID is assigned.
+   *  @param fromRepParam current representation parameter of compressed data, may be NULL
+   *  @param pixSeq compressed pixel sequence
+   *  @param uncompressedPixelData uncompressed pixel data stored in this element
+   *  @param cp codec parameters for this codec
+   *  @param objStack stack pointing to the location of the pixel data
+   *    element in the current dataset.
+   *  @param toRepParam representation parameter for the uncompressed representation,
+   *    may be NULL
+   *  @return EC_Normal if successful, an error code otherwise.
+   */
+  virtual OFCondition decodeToRepresentation(
+    const DcmRepresentationParameter * fromRepParam,
+    DcmPixelSequence * pixSeq,
+    DcmPolymorphOBOW& uncompressedPixelData,
+    const DcmCodecParameter * cp,
+    const DcmStack& objStack,
+    const DcmRepresentationParameter * toRepParam) const;
+
   /** decompresses a single frame from the given pixel sequence and
    *  stores the result in the given buffer.
    *  @param fromParam representation parameter of current compressed
@@ -203,6 +226,18 @@ private:
     Uint8 bitsPerSample,
     OFBool isYBR) const = 0;
 
+  /** determines the scaling factor for the decompression with reduced resolution.
+   *  Only lossy JPEG images are decompressed with reduced resolution.
+   *  @param toRepParam representation parameter passed to decodeToRepresentation(), may be NULL
+   *  @param rows number of rows of the image
+   *  @param columns number of columns of the image
+   *  @return denominator of the scaling factor, i.e. 1 (full resolution), 2, 4 or 8
+   */
+  Uint16 determineScaleDenominator(
+    const DcmRepresentationParameter *toRepParam,
+    Uint16 rows,
+    Uint16 columns) const;
+
   // static private helper methods
 
   /** scans the given block of JPEG data for a Start of Frame marker
@@ -261,6 +296,54 @@ private:
   static OFBool requiresPlanarConfiguration(
     const char *sopClassUID,
     EP_Interpretation photometricInterpretation);
+
+  /** updates the attributes that refer to the size of the image after it has been
+   *  decompressed with reduced resolution, i.e. the pixel spacing attributes (also in
+   *  the Pixel Measures of the functional groups) and the overlay planes.
+   *  @param dataset dataset to be modified
+   *  @param denominator the image has been scaled by 1/denominator
+   *  @param rowFactor ratio of the original to the reduced number of rows
+   *  @param columnFactor ratio of the original to the reduced number of columns
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  static OFCondition updateSpatialAttributes(
+    DcmItem *dataset,
+    Uint16 denominator,
+    double rowFactor,
+    double columnFactor);
+
+  /** rescales each of Pixel Spacing, Imager Pixel Spacing and Nominal Scanned
+   *  Pixel Spacing that is present in the given item
+   *  @param item item to be modified
+   *  @param rowFactor ratio of the original to the reduced number of rows
+   *  @param columnFactor ratio of the original to the reduced number of columns
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  static OFCondition updatePixelSpacing(
+    DcmItem *item,
+    double rowFactor,
+    double columnFactor);
+
+  /** reduces the resolution of an overlay plane (if present) in the same way as the
+   *  image, i.e. Overlay Rows, Overlay Columns, Overlay Origin and Overlay Data
+   *  @param dataset dataset to be modified
+   *  @param group group number of the overlay plane (0x6000-0x601e)
+   *  @param denominator the image has been scaled by 1/denominator
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  static OFCondition reduceOverlayPlane(
+    DcmItem *dataset,
+    Uint16 group,
+    Uint16 denominator);
+
+  /** converts an overlay origin (row or column, starting from 1) to the reduced resolution
+   *  @param origin row or column of the overlay origin, might be less than 1
+   *  @param denominator the image has been scaled by 1/denominator
+   *  @return row or column of the reduced overlay origin
+   */
+  static int divideOrigin(
+    int origin,
+    Uint16 denominator);
 };
 
 #endif
@@ -298,6 +298,44 @@ private:
     const DcmCodecParameter *cp,
     DcmStack & objStack) const;
 
+  /** compresses all frames of an image in parallel, using one encoder instance
+   *  per thread, and appends them to the given pixel sequence in frame order.
+   *  The frames are either rendered by the given DicomImage object (which is done
+   *  in the calling thread, in batches of one frame per thread) or taken directly
+   *  from the given raw pixel data.
+   *  @param toRepParam representation parameter passed to encode()
+   *  @param cp codec parameter passed to encode()
+   *  @param bitsPerSample bits per sample passed to createEncoderInstance()
+   *  @param dimage image from which the frames are rendered, NULL if the frames
+   *    are taken from pixelData
+   *  @param pixelData raw pixel data of all frames, ignored if dimage is not NULL
+   *  @param frameSize size of a raw frame in bytes, ignored if dimage is not NULL
+   *  @param frameCount number of frames to be compressed
+   *  @param columns columns of each frame
+   *  @param rows rows of each frame
+   *  @param interpr photometric interpretation of each frame
+   *  @param samplesPerPixel samples per pixel of each frame
+   *  @param pixelSequence pixel sequence to which the compressed frames are appended
+   *  @param offsetList list of frame offsets, updated for each frame
+   *  @param compressedSize size of all compressed frames is added to this parameter
+   *  @return EC_Normal if successful, an error code otherwise.
+   */
+  OFCondition encodeFramesInParallel(
+    const DcmRepresentationParameter * toRepParam,
+    const DJCodecParameter *cp,
+    Uint8 bitsPerSample,
+    DicomImage *dimage,
+    const Uint8 *pixelData,
+    size_t frameSize,
+    size_t frameCount,
+    Uint16 columns,
+    Uint16 rows,
+    EP_Interpretation interpr,
+    Uint16 samplesPerPixel,
+    DcmPixelSequence *pixelSequence,
+    OFList<Uint32>& offsetList,
+    size_t& compressedSize) const;
+
   /** create Lossy Image Compression and Lossy Image Compression Ratio.
    *  @param dataset dataset to be modified
    *  @param ratio image compression ratio > 1. This is not the "quality factor"
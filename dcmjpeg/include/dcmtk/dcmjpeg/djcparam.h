@@ -64,6 +64,8 @@ public:
    *  @param pAcrNemaCompatibility accept old ACR-NEMA images without photometric interpretation
    *    (only "pseudo" lossless encoder)
    *  @param pTrueLosslessMode Enables true lossless compression (replaces old "pseudo lossless" encoder)
+   *  @param pNumberOfThreads maximum number of threads used for processing the frames of a
+   *    multi-frame image in parallel, 0 or 1 for sequential processing
    */
   DJCodecParameter(
     E_CompressionColorSpaceConversion pCompressionCSConversion,
@@ -91,7 +93,25 @@ public:
     OFBool pUseModalityRescale = OFFalse,
     OFBool pAcceptWrongPaletteTags = OFFalse,
     OFBool pAcrNemaCompatibility = OFFalse,
-    OFBool pTrueLosslessMode = OFTrue);
+    OFBool pTrueLosslessMode = OFTrue,
+    Uint32 pNumberOfThreads = 1);
+
+  /** constructor, for use with decoders. Initializes all encoder options to defaults.
+   *  @param pDecompressionCSConversion color conversion mode for decompression
+   *  @param pCreateSOPInstanceUID mode for SOP Instance UID creation
+   *  @param pPlanarConfiguration flag describing how planar configuration of
+   *    decompressed color images should be handled
+   *  @param predictor6WorkaroundEnable enable workaround for buggy lossless compressed images with
+   *    overflow in predictor 6 for images with 16 bits/pixel
+   *  @param pNumberOfThreads maximum number of threads used for decompressing the frames of a
+   *    multi-frame image in parallel, 0 or 1 for sequential decompression
+   */
+  DJCodecParameter(
+    E_DecompressionColorSpaceConversion pDecompressionCSConversion,
+    E_UIDCreation pCreateSOPInstanceUID = EUC_default,
+    E_PlanarConfiguration pPlanarConfiguration = EPC_default,
+    OFBool predictor6WorkaroundEnable = OFFalse,
+    Uint32 pNumberOfThreads = 1);
 
   /// copy constructor
   DJCodecParameter(const DJCodecParameter& arg);
@@ -301,6 +321,14 @@ public:
     return predictor6WorkaroundEnabled_;
   }
 
+  /** returns maximum number of threads for multi-frame processing
+   *  @return maximum number of threads, 0 or 1 for sequential processing
+   */
+  Uint32 getNumberOfThreads() const
+  {
+    return numberOfThreads_;
+  }
+
 private:
 
   /// private undefined copy assignment operator
@@ -397,6 +425,9 @@ private:
   /// flag indicating that the workaround for buggy JPEG lossless images with incorrect predictor 6 is enabled
   OFBool predictor6WorkaroundEnabled_;
 
+  /// maximum number of threads for multi-frame processing, 0 or 1 for sequential processing
+  Uint32 numberOfThreads_;
+
 };
 
 
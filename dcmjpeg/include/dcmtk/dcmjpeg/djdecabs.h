@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1997-2011, OFFIS e.V.
+ *  Copyright (C) 1997-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -80,6 +80,17 @@ public:
    */
   virtual EP_Interpretation getDecompressedColorModel() const = 0;
 
+  /** sets the scaling factor for the decompression with reduced resolution,
+   *  which is only supported for lossy JPEG processes. Needs to be called before
+   *  the first call of decode(). The default implementation supports full resolution only.
+   *  @param denominator the image is scaled by 1/denominator, i.e. 1 (default), 2, 4 or 8
+   *  @return OFTrue if the scaling factor is supported, OFFalse otherwise
+   */
+  virtual OFBool setScaleDenominator(Uint16 denominator)
+  {
+    return (denominator == 1);
+  }
+
 };
 
 #endif
@@ -48,12 +48,15 @@ public:
    *    of color images should be encoded upon decompression.
    *  @param predictor6WorkaroundEnable enable workaround for buggy lossless compressed images with
    *           overflow in predictor 6 for images with 16 bits/pixel
+   *  @param pNumberOfThreads maximum number of threads used for decompressing the frames
+   *    of a multi-frame image in parallel, 0 or 1 for sequential decompression
    */
   static void registerCodecs(
     E_DecompressionColorSpaceConversion pDecompressionCSConversion = EDC_photometricInterpretation,
     E_UIDCreation pCreateSOPInstanceUID = EUC_default,
     E_PlanarConfiguration pPlanarConfiguration = EPC_default,
-    OFBool predictor6WorkaroundEnable = OFFalse);
+    OFBool predictor6WorkaroundEnable = OFFalse,
+    Uint32 pNumberOfThreads = 1);
 
   /** deregisters decoders.
    *  Attention: Must not be called while other threads might still use
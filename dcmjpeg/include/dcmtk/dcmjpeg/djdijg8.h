@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1997-2014, OFFIS e.V.
+ *  Copyright (C) 1997-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -88,6 +88,14 @@ public:
     return decompressedColorModel;
   }
 
+  /** sets the scaling factor for the decompression with reduced resolution.
+   *  Only applies to lossy JPEG processes, lossless JPEG is always decompressed
+   *  with full resolution.
+   *  @param denominator the image is scaled by 1/denominator, i.e. 1 (default), 2, 4 or 8
+   *  @return OFTrue if the scaling factor is supported, OFFalse otherwise
+   */
+  virtual OFBool setScaleDenominator(Uint16 denominator);
+
   /** callback function used to report warning messages and the like.
    *  Should not be called by user code directly.
    *  @param msg_level -1 for warnings, 0 and above for trace messages
@@ -123,6 +131,9 @@ private:
   /// color model after decompression
   EP_Interpretation decompressedColorModel;
 
+  /// the image is scaled by 1/scaleDenominator during decompression (lossy JPEG only)
+  Uint16 scaleDenominator;
+
 };
 
 #endif
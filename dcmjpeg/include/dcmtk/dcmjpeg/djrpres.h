@@ -0,0 +1,86 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmjpeg
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: representation parameter for decompression with reduced resolution
+ *
+ */
+
+#ifndef DJRPRES_H
+#define DJRPRES_H
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dcpixel.h" /* for class DcmRepresentationParameter */
+#include "dcmtk/dcmjpeg/djdefine.h"
+
+/** representation parameter for the decompression of lossy JPEG images with
+ *  reduced resolution. It is passed to DcmDataset::chooseRepresentation() together
+ *  with an uncompressed transfer syntax. The JPEG decoder then uses the lowest
+ *  resolution (1/2, 1/4 or 1/8 of the original size) where the larger of width
+ *  and height is not smaller than the given minimum size, e.g. for the creation
+ *  of thumbnails. Lossless JPEG images are always decompressed with full resolution.
+ */
+class DCMTK_DCMJPEG_EXPORT DJ_RPReducedResolution: public DcmRepresentationParameter
+{
+public:
+
+  /** constructor
+   *  @param aMinimumSize minimum size (larger of width and height) of the
+   *    decompressed image, 0 for full resolution
+   */
+  DJ_RPReducedResolution(Uint16 aMinimumSize = 0);
+
+  /// copy constructor
+  DJ_RPReducedResolution(const DJ_RPReducedResolution& arg);
+
+  /// destructor
+  virtual ~DJ_RPReducedResolution();
+
+  /** this methods creates a copy of type DcmRepresentationParameter *
+   *  it must be overweritten in every subclass.
+   *  @return copy of this object
+   */
+  virtual DcmRepresentationParameter *clone() const;
+
+  /** returns the class name as string.
+   *  can be used in operator== as poor man's RTTI replacement.
+   */
+  virtual const char *className() const;
+
+  /** compares an object to another DcmRepresentationParameter.
+   *  Implementation must make sure that classes are comparable.
+   *  @param arg representation parameter to compare with
+   *  @return true if equal, false otherwise.
+   */
+  virtual OFBool operator==(const DcmRepresentationParameter &arg) const;
+
+  /** returns the minimum size of the decompressed image
+   *  @return minimum size (larger of width and height), 0 for full resolution
+   */
+  Uint16 getMinimumSize() const
+  {
+    return minimumSize;
+  }
+
+private:
+
+  /// minimum size (larger of width and height) of the decompressed image
+  Uint16 minimumSize;
+
+};
+
+
+#endif
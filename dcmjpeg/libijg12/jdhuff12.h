@@ -44,6 +44,15 @@ typedef struct {
    */
   int look_nbits[1<<HUFF_LOOKAHEAD]; /* # bits, or 0 if too long */
   UINT8 look_sym[1<<HUFF_LOOKAHEAD]; /* symbol, or unused */
+
+  /* DCMTK: Lookahead tables for decoding a Huffman code together with the
+   * additional bits that follow it, i.e. the DC/AC coefficient or lossless
+   * difference.  If both fit into HUFF_LOOKAHEAD bits, we can obtain their
+   * total length and the extended value directly from these tables.  Not
+   * used for AC codes without additional bits (EOB and ZRL).
+   */
+  UINT8 look_fast_nbits[1<<HUFF_LOOKAHEAD]; /* # bits, or 0 if not usable */
+  INT16 look_fast_val[1<<HUFF_LOOKAHEAD]; /* extended value, or unused */
 } d_derived_tbl;
 
 /* Expand a Huffman table definition into the derived format */
@@ -70,16 +79,25 @@ EXTERN(void) jpeg_make_d_derived_tbl
  * necessary.
  */
 
-typedef IJG_INT32 bit_buf_type;	/* type of bit-extraction buffer */
-#define BIT_BUF_SIZE  32	/* size of buffer in bits */
-
 /* If long is > 32 bits on your machine, and shifting/masking longs is
  * reasonably fast, making bit_buf_type be long and setting BIT_BUF_SIZE
  * appropriately should be a win.  Unfortunately we can't define the size
  * with something like  #define BIT_BUF_SIZE (sizeof(bit_buf_type)*8)
  * because not all machines measure sizeof in 8-bit bytes.
+ * DCMTK: we use the size of long determined by the configuration (see
+ * osconfig.h), which halves the number of calls of jpeg_fill_bit_buffer
+ * on 64-bit platforms.  This matters most for lossless images with more
+ * than 8 bits per sample.
  */
 
+#if defined(SIZEOF_LONG) && (SIZEOF_LONG >= 8)
+typedef unsigned long bit_buf_type;	/* type of bit-extraction buffer */
+#define BIT_BUF_SIZE  64	/* size of buffer in bits */
+#else
+typedef IJG_INT32 bit_buf_type;	/* type of bit-extraction buffer */
+#define BIT_BUF_SIZE  32	/* size of buffer in bits */
+#endif
+
 typedef struct {		/* Bitreading state saved across MCUs */
   bit_buf_type get_buffer;	/* current bit-extraction buffer */
   int bits_left;		/* # of unused bits in it */
@@ -196,6 +214,18 @@ slowlabel: \
   } \
 }
 
+/* DCMTK: Ensure there are HUFF_LOOKAHEAD bits in get_buffer (if possible)
+ * before using the look_fast_nbits/look_fast_val tables.  If the data
+ * segment ends, there may be fewer bits; in this case, the caller has to
+ * use HUFF_DECODE, which handles this the hard way.
+ */
+
+#define HUFF_FILL_LOOKAHEAD(state,failaction) \
+	{ if (bits_left < HUFF_LOOKAHEAD) {  \
+	    if (! jpeg_fill_bit_buffer(&(state),get_buffer,bits_left,0))  \
+	      { failaction; }  \
+	    get_buffer = (state).get_buffer; bits_left = (state).bits_left; } }
+
 /* Out-of-line case for Huffman code fetching */
 EXTERN(int) jpeg_huff_decode
 	JPP((bitread_working_state * state, register bit_buf_type get_buffer,
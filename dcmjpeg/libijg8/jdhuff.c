@@ -141,6 +141,28 @@ jpeg_make_d_derived_tbl (j_decompress_ptr cinfo, boolean isDC, int tblno,
     ERREXIT(cinfo, JERR_BAD_HUFF_TABLE);
     }
   }
+
+  /* DCMTK: Compute the lookahead tables for decoding a Huffman code together
+   * with the additional bits that follow it.  For DC and lossless tables,
+   * the symbol is the number of additional bits (the special lossless case
+   * 16 is excluded); for AC tables, it is the lower nibble of the symbol.
+   */
+
+  for (lookbits = 0; lookbits < (1<<HUFF_LOOKAHEAD); lookbits++) {
+    l = dtbl->look_nbits[lookbits];
+    si = isDC ? dtbl->look_sym[lookbits] : (dtbl->look_sym[lookbits] & 15);
+    dtbl->look_fast_nbits[lookbits] = 0;
+    dtbl->look_fast_val[lookbits] = 0;
+    if (l > 0 && (si > 0 || isDC) && si < 16 && l + si <= HUFF_LOOKAHEAD) {
+      /* Fetch the additional bits and extend them to a signed value */
+      code = (unsigned int) (lookbits >> (HUFF_LOOKAHEAD - l - si)) & ((1U << si) - 1);
+      dtbl->look_fast_nbits[lookbits] = (UINT8) (l + si);
+      if (si > 0 && code < (1U << (si - 1)))
+        dtbl->look_fast_val[lookbits] = (INT16) ((int) code - (1 << si) + 1);
+      else
+        dtbl->look_fast_val[lookbits] = (INT16) code;
+    }
+  }
 }
 
 
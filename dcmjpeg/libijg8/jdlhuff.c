@@ -229,6 +229,50 @@ decode_mcus (j_decompress_ptr cinfo, JDIFFIMAGE diff_buf,
     /* Load up working state */
     BITREAD_LOAD_STATE(cinfo,entropy->bitstate);
 
+    /* DCMTK: fast path for MCUs consisting of a single sample, i.e. for
+     * non-interleaved scans such as monochrome images.  The table and the
+     * output pointer are kept in local variables, which the compiler cannot
+     * do for the general loop below.  Most codes are decoded together with
+     * the additional bits using the look_fast_nbits/look_fast_val tables.
+     */
+    if (cinfo->data_units_in_MCU == 1) {
+      d_derived_tbl * dctbl = entropy->cur_tbls[0];
+      JDIFFROW outptr = entropy->output_ptr[entropy->output_ptr_index[0]];
+      register int s, r, fast_nb, fast_look;
+
+      for (mcu_num = 0; mcu_num < nMCU; mcu_num++) {
+
+    /* Section H.2.2: decode the sample difference, in one step if the code
+     * and the additional bits fit into the lookahead
+     */
+    HUFF_FILL_LOOKAHEAD(br_state, return mcu_num);
+    if (bits_left >= HUFF_LOOKAHEAD &&
+        (fast_nb = dctbl->look_fast_nbits[fast_look = PEEK_BITS(HUFF_LOOKAHEAD)]) != 0) {
+      DROP_BITS(fast_nb);
+      s = dctbl->look_fast_val[fast_look];
+    } else {
+      HUFF_DECODE(s, br_state, dctbl, return mcu_num, label0);
+      if (s) {
+        if (s == 16)  /* special case: always output 32768 */
+          s = 32768;
+        else {    /* normal case: fetch subsequent bits */
+          CHECK_BIT_BUFFER(br_state, s, return mcu_num);
+          r = GET_BITS(s);
+          s = HUFF_EXTEND(r, s);
+        }
+      }
+    }
+
+    /* Output the sample difference */
+    *outptr++ = (JDIFF) s;
+
+    /* Completed MCU, so update state */
+    BITREAD_SAVE_STATE(cinfo,entropy->bitstate);
+      }
+
+      return nMCU;
+    }
+
     /* Outer loop handles the number of MCU requested */
 
     for (mcu_num = 0; mcu_num < nMCU; mcu_num++) {
@@ -251,16 +251,26 @@ decode_mcu (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
       JBLOCKROW block = MCU_data[blkn];
       d_derived_tbl * dctbl = entropy->dc_cur_tbls[blkn];
       d_derived_tbl * actbl = entropy->ac_cur_tbls[blkn];
-      register int s, k, r;
+      register int s, k, r, fast_nb, fast_look;
 
       /* Decode a single block's worth of coefficients */
 
-      /* Section F.2.2.1: decode the DC coefficient difference */
-      HUFF_DECODE(s, br_state, dctbl, return FALSE, label1);
-      if (s) {
-    CHECK_BIT_BUFFER(br_state, s, return FALSE);
-    r = GET_BITS(s);
-    s = HUFF_EXTEND(r, s);
+      /* Section F.2.2.1: decode the DC coefficient difference.
+       * DCMTK: the code and the additional bits are decoded in one step
+       * if both fit into the lookahead (same for the AC coefficients).
+       */
+      HUFF_FILL_LOOKAHEAD(br_state, return FALSE);
+      if (bits_left >= HUFF_LOOKAHEAD &&
+          (fast_nb = dctbl->look_fast_nbits[fast_look = PEEK_BITS(HUFF_LOOKAHEAD)]) != 0) {
+    DROP_BITS(fast_nb);
+    s = dctbl->look_fast_val[fast_look];
+      } else {
+    HUFF_DECODE(s, br_state, dctbl, return FALSE, label1);
+    if (s) {
+      CHECK_BIT_BUFFER(br_state, s, return FALSE);
+      r = GET_BITS(s);
+      s = HUFF_EXTEND(r, s);
+    }
       }
 
       if (entropy->dc_needed[blkn]) {
@@ -277,6 +287,15 @@ decode_mcu (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
     /* Section F.2.2.2: decode the AC coefficients */
     /* Since zeroes are skipped, output area must be cleared beforehand */
     for (k = 1; k < DCTSIZE2; k++) {
+      HUFF_FILL_LOOKAHEAD(br_state, return FALSE);
+      if (bits_left >= HUFF_LOOKAHEAD &&
+          (fast_nb = actbl->look_fast_nbits[fast_look = PEEK_BITS(HUFF_LOOKAHEAD)]) != 0) {
+        DROP_BITS(fast_nb);
+        k += actbl->look_sym[fast_look] >> 4;
+        (*block)[jpeg_natural_order[k]] = (JCOEF) actbl->look_fast_val[fast_look];
+        continue;
+      }
+
       HUFF_DECODE(s, br_state, actbl, return FALSE, label2);
       
       r = s >> 4;
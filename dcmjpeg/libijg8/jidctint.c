@@ -161,12 +161,39 @@ jpeg_idct_islow (j_decompress_ptr cinfo, jpeg_component_info * compptr,
   int workspace[DCTSIZE2];	/* buffers data between passes */
   SHIFT_TEMPS
 
+  inptr = coef_block;
+  quantptr = (ISLOW_MULT_TYPE *) compptr->dct_table;
+
+  /* DCMTK: Blocks in which all AC terms are zero are very common, e.g. in
+   * the background of medical images.  In that case all output samples are
+   * equal to the descaled DC coefficient, which is exactly what the column
+   * and row passes below compute, so we can skip them altogether.
+   */
+  z1 = 0;
+  for (ctr = 1; ctr < DCTSIZE2; ctr++)
+    z1 |= inptr[ctr];
+  if (z1 == 0) {
+    JSAMPLE dcval = range_limit[(int) DESCALE((IJG_INT32)
+      (DEQUANTIZE(inptr[0], quantptr[0]) << PASS1_BITS), PASS1_BITS+3) & RANGE_MASK];
+
+    for (ctr = 0; ctr < DCTSIZE; ctr++) {
+      outptr = output_buf[ctr] + output_col;
+      outptr[0] = dcval;
+      outptr[1] = dcval;
+      outptr[2] = dcval;
+      outptr[3] = dcval;
+      outptr[4] = dcval;
+      outptr[5] = dcval;
+      outptr[6] = dcval;
+      outptr[7] = dcval;
+    }
+    return;
+  }
+
   /* Pass 1: process columns from input, store into work array. */
   /* Note results are scaled up by sqrt(8) compared to a true IDCT; */
   /* furthermore, we scale the results by 2**PASS1_BITS. */
 
-  inptr = coef_block;
-  quantptr = (ISLOW_MULT_TYPE *) compptr->dct_table;
   wsptr = workspace;
   for (ctr = DCTSIZE; ctr > 0; ctr--) {
     /* Due to quantization, we will usually find that many of the input
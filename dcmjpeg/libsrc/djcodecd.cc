@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2001-2014, OFFIS e.V.
+ *  Copyright (C) 2001-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -30,10 +30,165 @@
 #include "dcmtk/dcmdata/dcvrpobw.h"  /* for class DcmPolymorphOBOW */
 #include "dcmtk/dcmdata/dcswap.h"    /* for swapIfNecessary() */
 #include "dcmtk/dcmdata/dcuid.h"     /* for dcmGenerateUniqueIdentifer()*/
+#include "dcmtk/dcmdata/dcparfrm.h"  /* for class DcmParallelFrameProcessor */
+#include "dcmtk/dcmdata/dcxfer.h"    /* for class DcmXfer */
 
 // dcmjpeg includes
 #include "dcmtk/dcmjpeg/djcparam.h"  /* for class DJCodecParameter */
 #include "dcmtk/dcmjpeg/djdecabs.h"  /* for class DJDecoder */
+#include "dcmtk/dcmjpeg/djrpres.h"   /* for class DJ_RPReducedResolution */
+
+// ofstd includes
+#include "dcmtk/ofstd/ofstd.h"       /* for OFStandard::ftoa() */
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+/** helper class decompressing a range of frames of a multi-frame JPEG image
+ *  in parallel. Requires that each frame is contained in exactly one pixel item.
+ */
+class DJCodecFrameDecoder : public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param firstFrame number of the first frame to be decompressed
+   *  @param numberOfFrames number of frames to be decompressed
+   *  @param numberOfThreads maximum number of threads to be used
+   *  @param imageData pointer to the buffer for the uncompressed first frame
+   *  @param frameSize size of an uncompressed frame in bytes
+   *  @param isSigned OFTrue, if uncompressed pixel data is signed, OFFalse otherwise
+   */
+  DJCodecFrameDecoder(Uint32 firstFrame, Uint32 numberOfFrames, Uint32 numberOfThreads,
+    Uint8 *imageData, size_t frameSize, OFBool isSigned)
+  : DcmParallelFrameProcessor(numberOfFrames)
+  , firstFrame_(firstFrame)
+  , numberOfThreads_(getNumberOfThreadsUsed(numberOfThreads))
+  , numberOfDecoders_(0)
+  , decoders_(new DJDecoder *[numberOfThreads_])
+  , fragmentData_(new Uint8 *[numberOfFrames])
+  , fragmentLength_(new Uint32[numberOfFrames])
+  , imageData_(imageData)
+  , frameSize_(frameSize)
+  , isSigned_(isSigned)
+  {
+  }
+
+  /// destructor, deletes all decoder instances
+  virtual ~DJCodecFrameDecoder()
+  {
+    for (Uint32 i = 0; i < numberOfDecoders_; ++i)
+      delete decoders_[i];
+    delete[] decoders_;
+    delete[] fragmentData_;
+    delete[] fragmentLength_;
+  }
+
+  /** returns the number of decoder instances needed, one per thread
+   *  @return number of decoder instances needed
+   */
+  Uint32 getNumberOfDecoders() const
+  {
+    return numberOfThreads_;
+  }
+
+  /** adds a decoder instance, which is deleted by this object
+   *  @param decoder decoder instance, must not be NULL
+   */
+  void addDecoder(DJDecoder *decoder)
+  {
+    if (numberOfDecoders_ < numberOfThreads_) decoders_[numberOfDecoders_++] = decoder;
+    else delete decoder;
+  }
+
+  /** accesses the compressed data of all frames and decompresses them.
+   *  @param pixSeq pixel sequence containing one pixel item per frame
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition decode(DcmPixelSequence *pixSeq)
+  {
+    OFCondition result = EC_Normal;
+    DcmPixelItem *pixItem = NULL;
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    if (numberOfDecoders_ < numberOfThreads_) result = EC_IllegalCall;
+    // access all pixel items in this thread since this might load data from file
+    for (Uint32 frame = 0; (frame < numberOfFrames) && result.good(); ++frame)
+    {
+      result = pixSeq->getItem(pixItem, firstFrame_ + frame + 1); // ignore offset table
+      if (result.good())
+      {
+        fragmentLength_[frame] = pixItem->getLength();
+        result = pixItem->getUint8Array(fragmentData_[frame]);
+        if (result.good() && (fragmentData_[frame] == NULL)) result = EC_CorruptedData;
+      }
+    }
+    if (result.good())
+    {
+      DCMJPEG_DEBUG("JPEG decoder processes " << numberOfFrames << " frames using up to " << numberOfThreads_ << " thread(s)");
+      result = processAllFrames(numberOfThreads_);
+    }
+    return result;
+  }
+
+  /** decompresses a single frame.
+   *  @param frameNo number of the frame to be decompressed, relative to the first frame
+   *  @param threadNo index of the calling thread
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, Uint32 threadNo)
+  {
+    DJDecoder *jpeg = decoders_[threadNo];
+    OFCondition result = jpeg->init();
+    if (result.good())
+    {
+      result = jpeg->decode(fragmentData_[frameNo], fragmentLength_[frameNo],
+        imageData_ + frameNo * frameSize_, OFstatic_cast(Uint32, frameSize_), isSigned_);
+      // the JPEG stream of the frame must be complete
+      if (result == EJ_Suspension)
+      {
+        DCMJPEG_ERROR("JPEG data of frame " << (firstFrame_ + frameNo) << " is incomplete");
+        result = EC_CorruptedData;
+      }
+    }
+    return result;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DJCodecFrameDecoder(const DJCodecFrameDecoder&);
+
+  /// private undefined copy assignment operator
+  DJCodecFrameDecoder& operator=(const DJCodecFrameDecoder&);
+
+  /// number of the first frame to be decompressed
+  Uint32 firstFrame_;
+
+  /// number of threads actually used
+  Uint32 numberOfThreads_;
+
+  /// number of decoder instances added so far
+  Uint32 numberOfDecoders_;
+
+  /// one decoder instance per thread
+  DJDecoder **decoders_;
+
+  /// compressed data of each frame
+  Uint8 **fragmentData_;
+
+  /// length of compressed data of each frame
+  Uint32 *fragmentLength_;
+
+  /// buffer for the uncompressed frames, starting with the first frame
+  Uint8 *imageData_;
+
+  /// size of an uncompressed frame in bytes
+  size_t frameSize_;
+
+  /// OFTrue, if uncompressed pixel data is signed
+  OFBool isSigned_;
+};
 
 
 DJCodecDecoder::DJCodecDecoder()
@@ -66,6 +221,18 @@ OFCondition DJCodecDecoder::decode(
     DcmPolymorphOBOW& uncompressedPixelData,
     const DcmCodecParameter * cp,
     const DcmStack& objStack) const
+{
+  return decodeToRepresentation(fromRepParam, pixSeq, uncompressedPixelData, cp, objStack, NULL);
+}
+
+
+OFCondition DJCodecDecoder::decodeToRepresentation(
+    const DcmRepresentationParameter * fromRepParam,
+    DcmPixelSequence * pixSeq,
+    DcmPolymorphOBOW& uncompressedPixelData,
+    const DcmCodecParameter * cp,
+    const DcmStack& objStack,
+    const DcmRepresentationParameter * toRepParam) const
 {
   OFCondition result = EC_Normal;
   // assume we can cast the codec parameter to what we need
@@ -91,6 +258,7 @@ OFCondition DJCodecDecoder::decode(
     OFBool isSigned = OFFalse;
     Uint16 pixelRep = 0; // needed to decline color conversion of signed pixel data to RGB
     OFBool numberOfFramesPresent = OFFalse;
+    Uint16 scaleDenominator = 1; // decompression with reduced resolution if greater than 1
 
     if (result.good()) result = OFreinterpret_cast(DcmItem*, dataset)->findAndGetUint16(DCM_SamplesPerPixel, imageSamplesPerPixel);
     if (result.good()) result = OFreinterpret_cast(DcmItem*, dataset)->findAndGetUint16(DCM_Rows, imageRows);
@@ -143,6 +311,18 @@ OFCondition DJCodecDecoder::decode(
               if (jpeg == NULL) result = EC_MemoryExhausted;
               else
               {
+                // lossy JPEG images might be decompressed with reduced resolution (scaled IDCT)
+                const Uint16 fullImageRows = imageRows;
+                const Uint16 fullImageColumns = imageColumns;
+                scaleDenominator = determineScaleDenominator(toRepParam, imageRows, imageColumns);
+                if ((scaleDenominator > 1) && jpeg->setScaleDenominator(scaleDenominator))
+                {
+                  imageRows = OFstatic_cast(Uint16, (imageRows + scaleDenominator - 1) / scaleDenominator);
+                  imageColumns = OFstatic_cast(Uint16, (imageColumns + scaleDenominator - 1) / scaleDenominator);
+                  DCMJPEG_DEBUG("JPEG decoder uses reduced resolution 1/" << scaleDenominator << ": "
+                    << imageColumns << " x " << imageRows << " pixels");
+                } else
+                  scaleDenominator = 1;
                 size_t frameSize = ((precision > 8) ? sizeof(Uint16) : sizeof(Uint8)) * imageRows * imageColumns * imageSamplesPerPixel;
                 size_t totalSize = frameSize * imageFrames;
                 if (totalSize & 1) totalSize++; // align on 16-bit word boundary
@@ -166,6 +346,42 @@ OFCondition DJCodecDecoder::decode(
 
                   while ((currentFrame < imageFrames)&&(result.good()))
                   {
+                    // once the color model is known from the first frame, the remaining frames
+                    // can be decompressed in parallel if each frame is contained in one pixel item
+                    if (createPlanarConfigurationInitialized && (djcp->getNumberOfThreads() > 1) &&
+                        (currentItem == OFstatic_cast(size_t, currentFrame) + 1) &&
+                        (pixSeq->card() == OFstatic_cast(unsigned long, imageFrames) + 1))
+                    {
+                      DJCodecFrameDecoder frameDecoder(OFstatic_cast(Uint32, currentFrame),
+                        OFstatic_cast(Uint32, imageFrames - currentFrame), djcp->getNumberOfThreads(),
+                        imageData8, frameSize, isSigned);
+                      for (Uint32 i = 0; (i < frameDecoder.getNumberOfDecoders()) && result.good(); ++i)
+                      {
+                        DJDecoder *decoder = createDecoderInstance(fromRepParam, djcp, precision, isYBR);
+                        if (decoder == NULL) result = EC_MemoryExhausted;
+                        else
+                        {
+                          decoder->setScaleDenominator(scaleDenominator);
+                          frameDecoder.addDecoder(decoder);
+                        }
+                      }
+                      if (result.good()) result = frameDecoder.decode(pixSeq);
+
+                      // convert planar configuration if necessary
+                      while ((currentFrame < imageFrames) && result.good())
+                      {
+                        if ((imageSamplesPerPixel == 3) && createPlanarConfiguration)
+                        {
+                          if (precision > 8)
+                            result = createPlanarConfigurationWord(OFreinterpret_cast(Uint16*, imageData8), imageColumns, imageRows);
+                            else result = createPlanarConfigurationByte(imageData8, imageColumns, imageRows);
+                        }
+                        currentFrame++;
+                        imageData8 += frameSize;
+                      }
+                      break;
+                    }
+
                     result = jpeg->init();
                     if (result.good())
                     {
@@ -303,6 +519,15 @@ OFCondition DJCodecDecoder::decode(
                     result = OFreinterpret_cast(DcmItem*, dataset)->putAndInsertUint16(DCM_HighBit, OFstatic_cast(Uint16, precision-1));
                   }
 
+                  // Rows, Columns, pixel spacing and overlays have changed in case of reduced resolution
+                  if (result.good() && (scaleDenominator > 1))
+                  {
+                    result = OFreinterpret_cast(DcmItem*, dataset)->putAndInsertUint16(DCM_Rows, imageRows);
+                    if (result.good()) result = OFreinterpret_cast(DcmItem*, dataset)->putAndInsertUint16(DCM_Columns, imageColumns);
+                    if (result.good()) result = updateSpatialAttributes(OFreinterpret_cast(DcmItem*, dataset), scaleDenominator,
+                      OFstatic_cast(double, fullImageRows) / imageRows, OFstatic_cast(double, fullImageColumns) / imageColumns);
+                  }
+
                   // Number of Frames might have changed in case the previous value was wrong
                   if (result.good() && (numberOfFramesPresent || (imageFrames > 1)))
                   {
@@ -328,8 +553,13 @@ OFCondition DJCodecDecoder::decode(
     if (dataset->ident() == EVR_dataset)
     {
         // create new SOP instance UID if codec parameters require so
-        if (result.good() && (djcp->getUIDCreation() == EUC_always))
+        // or if the image has been decompressed with reduced resolution
+        if (result.good() && ((djcp->getUIDCreation() == EUC_always) || (scaleDenominator > 1)))
           result = DcmCodec::newInstance(OFreinterpret_cast(DcmItem*, dataset), NULL, NULL, NULL);
+
+        // an image with reduced resolution is a derived image
+        if (result.good() && (scaleDenominator > 1))
+          result = DcmCodec::updateImageType(OFreinterpret_cast(DcmItem*, dataset));
     }
 
   }
@@ -591,6 +821,171 @@ OFCondition DJCodecDecoder::determineDecompressedColorModel(
 }
 
 
+Uint16 DJCodecDecoder::determineScaleDenominator(
+  const DcmRepresentationParameter *toRepParam,
+  Uint16 rows,
+  Uint16 columns) const
+{
+  Uint16 denominator = 1;
+  Uint16 minSize = 0;
+  // the minimum size is passed with the representation parameter of the decompressed image
+  if ((toRepParam != NULL) && (toRepParam->className() != NULL) &&
+      (strcmp(toRepParam->className(), "DJ_RPReducedResolution") == 0))
+  {
+    minSize = OFstatic_cast(const DJ_RPReducedResolution *, toRepParam)->getMinimumSize();
+  }
+  if ((minSize > 0) && DcmXfer(supportedTransferSyntax()).isLossy())
+  {
+    const Uint16 maxSize = (rows > columns) ? rows : columns;
+    // use the lowest resolution (1/2, 1/4 or 1/8) that still meets the minimum size
+    while ((denominator < 8) && ((maxSize + 2 * denominator - 1) / (2 * denominator) >= minSize))
+      denominator *= 2;
+  }
+  return denominator;
+}
+
+
+OFCondition DJCodecDecoder::updateSpatialAttributes(
+  DcmItem *dataset,
+  Uint16 denominator,
+  double rowFactor,
+  double columnFactor)
+{
+  // pixel spacing of the image itself
+  OFCondition result = updatePixelSpacing(dataset, rowFactor, columnFactor);
+
+  // pixel spacing in the Pixel Measures of the shared and per-frame functional groups
+  const DcmTagKey groupTags[2] = { DCM_SharedFunctionalGroupsSequence, DCM_PerFrameFunctionalGroupsSequence };
+  for (size_t i = 0; result.good() && (i < 2); ++i)
+  {
+    DcmSequenceOfItems *groupSeq = NULL;
+    if (dataset->findAndGetSequence(groupTags[i], groupSeq).good() && (groupSeq != NULL))
+    {
+      for (unsigned long j = 0; result.good() && (j < groupSeq->card()); ++j)
+      {
+        DcmItem *measuresItem = NULL;
+        if (groupSeq->getItem(j)->findAndGetSequenceItem(DCM_PixelMeasuresSequence, measuresItem).good() && (measuresItem != NULL))
+          result = updatePixelSpacing(measuresItem, rowFactor, columnFactor);
+      }
+    }
+  }
+
+  // overlay planes have the same size as the image
+  for (Uint16 group = 0x6000; result.good() && (group <= 0x601e); group = OFstatic_cast(Uint16, group + 2))
+    result = reduceOverlayPlane(dataset, group, denominator);
+  return result;
+}
+
+
+OFCondition DJCodecDecoder::updatePixelSpacing(
+  DcmItem *item,
+  double rowFactor,
+  double columnFactor)
+{
+  OFCondition result = EC_Normal;
+  // rescale each pixel spacing attribute present in the item
+  const DcmTagKey spacingTags[3] = { DCM_PixelSpacing, DCM_ImagerPixelSpacing, DCM_NominalScannedPixelSpacing };
+  for (size_t i = 0; result.good() && (i < 3); ++i)
+  {
+    Float64 rowSpacing = 0;
+    Float64 columnSpacing = 0;
+    if (item->findAndGetFloat64(spacingTags[i], rowSpacing, 0).good())
+    {
+      if (item->findAndGetFloat64(spacingTags[i], columnSpacing, 1).bad())
+        columnSpacing = rowSpacing;
+      char buffer[64];
+      OFStandard::ftoa(buffer, 16, rowSpacing * rowFactor, OFStandard::ftoa_format_f);
+      strcat(buffer, "\\");
+      OFStandard::ftoa(strchr(buffer, 0), 16, columnSpacing * columnFactor, OFStandard::ftoa_format_f);
+      result = item->putAndInsertString(spacingTags[i], buffer);
+    }
+  }
+  return result;
+}
+
+
+OFCondition DJCodecDecoder::reduceOverlayPlane(
+  DcmItem *dataset,
+  Uint16 group,
+  Uint16 denominator)
+{
+  OFCondition result = EC_Normal;
+  Uint16 rows = 0;
+  Uint16 columns = 0;
+  if (dataset->findAndGetUint16(DcmTagKey(group, DCM_OverlayRows.getElement()), rows).good() &&
+      dataset->findAndGetUint16(DcmTagKey(group, DCM_OverlayColumns.getElement()), columns).good() &&
+      (rows > 0) && (columns > 0))
+  {
+    const Uint16 newRows = OFstatic_cast(Uint16, (rows + denominator - 1) / denominator);
+    const Uint16 newColumns = OFstatic_cast(Uint16, (columns + denominator - 1) / denominator);
+    Sint32 frames = 1;
+    if (dataset->findAndGetSint32(DcmTagKey(group, DCM_NumberOfFramesInOverlay.getElement()), frames).bad() || (frames < 1))
+      frames = 1;
+
+    // reduce the overlay data (if not embedded in the pixel data), a pixel is set if any pixel of the block is set
+    DcmElement *overlayData = NULL;
+    Uint8 *bits = NULL;
+    if (dataset->findAndGetElement(DcmTagKey(group, DCM_OverlayData.getElement()), overlayData).good() &&
+        overlayData->getUint8Array(bits).good() && (bits != NULL))
+    {
+      const unsigned long frameSize = OFstatic_cast(unsigned long, rows) * columns;
+      const unsigned long newFrameSize = OFstatic_cast(unsigned long, newRows) * newColumns;
+      if (OFstatic_cast(unsigned long, overlayData->getLength()) * 8 < frameSize * frames)
+      {
+        DCMJPEG_WARN("overlay data in group 0x" << STD_NAMESPACE hex << group << STD_NAMESPACE dec
+          << " too short, cannot reduce resolution");
+        return EC_Normal;
+      }
+      const unsigned long newLength = (newFrameSize * frames + 15) / 16 * 2; // OB/OW are padded to an even length
+      Uint8 *newBits = new Uint8[newLength];
+      if (newBits == NULL) return EC_MemoryExhausted;
+      memset(newBits, 0, newLength);
+      for (unsigned long f = 0; f < OFstatic_cast(unsigned long, frames); ++f)
+      {
+        for (unsigned long y = 0; y < rows; ++y)
+        {
+          for (unsigned long x = 0; x < columns; ++x)
+          {
+            const unsigned long pos = f * frameSize + y * columns + x;
+            if (bits[pos >> 3] & (1 << (pos & 7)))
+            {
+              const unsigned long newPos = f * newFrameSize + (y / denominator) * newColumns + x / denominator;
+              newBits[newPos >> 3] = OFstatic_cast(Uint8, newBits[newPos >> 3] | (1 << (newPos & 7)));
+            }
+          }
+        }
+      }
+      result = overlayData->putUint8Array(newBits, newLength);
+      delete[] newBits;
+    }
+
+    // the origin refers to the image pixels, starting with 1
+    Sint16 originRow = 1;
+    Sint16 originColumn = 1;
+    const DcmTagKey originTag(group, DCM_OverlayOrigin.getElement());
+    if (result.good() && dataset->findAndGetSint16(originTag, originRow, 0).good() &&
+        dataset->findAndGetSint16(originTag, originColumn, 1).good())
+    {
+      Sint16 origin[2];
+      origin[0] = OFstatic_cast(Sint16, divideOrigin(originRow, denominator));
+      origin[1] = OFstatic_cast(Sint16, divideOrigin(originColumn, denominator));
+      result = dataset->putAndInsertSint16Array(originTag, origin, 2);
+    }
+    if (result.good()) result = dataset->putAndInsertUint16(DcmTagKey(group, DCM_OverlayRows.getElement()), newRows);
+    if (result.good()) result = dataset->putAndInsertUint16(DcmTagKey(group, DCM_OverlayColumns.getElement()), newColumns);
+  }
+  return result;
+}
+
+
+int DJCodecDecoder::divideOrigin(int origin, Uint16 denominator)
+{
+  // pixel positions start with 1, the origin might also be located left of or above the image
+  const int pos = origin - 1;
+  return ((pos >= 0) ? (pos / denominator) : -((denominator - 1 - pos) / denominator)) + 1;
+}
+
+
 Uint16 DJCodecDecoder::readUint16(const Uint8 *data)
 {
   return OFstatic_cast(Uint16, (OFstatic_cast(Uint16, *data) << 8) | OFstatic_cast(Uint16, *(data+1)));
@@ -39,6 +39,7 @@
 #include "dcmtk/dcmdata/dcvrst.h"     /* for class DcmShortText */
 #include "dcmtk/dcmdata/dcvrus.h"     /* for class DcmUnsignedShort */
 #include "dcmtk/dcmdata/dcswap.h"     /* for swapIfNecessary */
+#include "dcmtk/dcmdata/dcparfrm.h"   /* for class DcmParallelFrameProcessor */
 
 // dcmjpeg includes
 #include "dcmtk/dcmjpeg/djcparam.h"   /* for class DJCodecParameter */
@@ -51,6 +52,127 @@
 #include "dcmtk/ofstd/ofstdinc.h"
 
 
+/** helper class compressing a number of uncompressed frames in parallel.
+ *  The compressed frames are kept until they are appended to the pixel
+ *  sequence in frame order by storeFrames().
+ */
+class DJCodecFrameEncoder : public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param numberOfFrames number of frames to be compressed
+   *  @param encoders one encoder instance per thread, not deleted by this object
+   *  @param frames pointers to the uncompressed frames, not deleted by this object
+   *  @param columns columns of each frame
+   *  @param rows rows of each frame
+   *  @param interpr photometric interpretation of each frame
+   *  @param samplesPerPixel samples per pixel of each frame
+   */
+  DJCodecFrameEncoder(Uint32 numberOfFrames, DJEncoder **encoders, const Uint8 **frames,
+    Uint16 columns, Uint16 rows, EP_Interpretation interpr, Uint16 samplesPerPixel)
+  : DcmParallelFrameProcessor(numberOfFrames)
+  , encoders_(encoders)
+  , frames_(frames)
+  , jpegData_(new Uint8 *[numberOfFrames])
+  , jpegLen_(new Uint32[numberOfFrames])
+  , columns_(columns)
+  , rows_(rows)
+  , interpr_(interpr)
+  , samplesPerPixel_(samplesPerPixel)
+  {
+    for (Uint32 i = 0; i < numberOfFrames; ++i)
+    {
+      jpegData_[i] = NULL;
+      jpegLen_[i] = 0;
+    }
+  }
+
+  /// destructor, deletes all compressed frames not yet stored
+  virtual ~DJCodecFrameEncoder()
+  {
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    for (Uint32 i = 0; i < numberOfFrames; ++i)
+      delete[] jpegData_[i];
+    delete[] jpegData_;
+    delete[] jpegLen_;
+  }
+
+  /** compresses a single frame.
+   *  @param frameNo number of the frame to be compressed
+   *  @param threadNo index of the calling thread
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, Uint32 threadNo)
+  {
+    OFCondition result;
+    DJEncoder *jpeg = encoders_[threadNo];
+    Uint8 *frame = OFconst_cast(Uint8 *, frames_[frameNo]);
+    if (jpeg->bytesPerSample() == 1)
+    {
+      result = jpeg->encode(columns_, rows_, interpr_, samplesPerPixel_, frame, jpegData_[frameNo], jpegLen_[frameNo]);
+    } else {
+      result = jpeg->encode(columns_, rows_, interpr_, samplesPerPixel_, OFreinterpret_cast(Uint16 *, frame), jpegData_[frameNo], jpegLen_[frameNo]);
+    }
+    if (result.good() && (jpegLen_[frameNo] == 0)) result = EC_CannotChangeRepresentation;
+    return result;
+  }
+
+  /** appends all compressed frames to the given pixel sequence in frame order
+   *  @param pixelSequence pixel sequence to which the compressed frames are appended
+   *  @param offsetList list of frame offsets, updated for each frame
+   *  @param fragmentSize maximum fragment size (in kbytes), 0 for unlimited
+   *  @param compressedSize size of all compressed frames is added to this parameter
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition storeFrames(DcmPixelSequence *pixelSequence, DcmOffsetList& offsetList, Uint32 fragmentSize, size_t& compressedSize)
+  {
+    OFCondition result = EC_Normal;
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    for (Uint32 i = 0; (i < numberOfFrames) && result.good(); ++i)
+    {
+      result = pixelSequence->storeCompressedFrame(offsetList, jpegData_[i], jpegLen_[i], fragmentSize);
+      compressedSize += jpegLen_[i];
+      delete[] jpegData_[i];
+      jpegData_[i] = NULL;
+    }
+    return result;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DJCodecFrameEncoder(const DJCodecFrameEncoder&);
+
+  /// private undefined copy assignment operator
+  DJCodecFrameEncoder& operator=(const DJCodecFrameEncoder&);
+
+  /// one encoder instance per thread
+  DJEncoder **encoders_;
+
+  /// uncompressed frames
+  const Uint8 **frames_;
+
+  /// compressed frames
+  Uint8 **jpegData_;
+
+  /// length of each compressed frame
+  Uint32 *jpegLen_;
+
+  /// columns of each frame
+  Uint16 columns_;
+
+  /// rows of each frame
+  Uint16 rows_;
+
+  /// photometric interpretation of each frame
+  EP_Interpretation interpr_;
+
+  /// samples per pixel of each frame
+  Uint16 samplesPerPixel_;
+};
+
+
 DJCodecEncoder::DJCodecEncoder()
 : DcmCodec()
 {
@@ -346,30 +468,38 @@ OFCondition DJCodecEncoder::encodeColorImage(
 
       // compute original image size in bytes, ignoring any padding bits.
       uncompressedSize = OFstatic_cast(double, columns * rows * dimage->getDepth() * frameCount * samplesPerPixel) / 8.0;
-      for (size_t i=0; (i<frameCount) && (result.good()); i++)
+      if ((cp->getNumberOfThreads() > 1) && (frameCount > 1))
       {
-        frame = dimage->getOutputData(bitsPerSample, i, 0);
-        if (frame == NULL) result = EC_MemoryExhausted;
-        else
+        result = encodeFramesInParallel(toRepParam, cp, OFstatic_cast(Uint8, compressedBits), dimage, NULL, 0,
+          frameCount, columns, rows, interpr, samplesPerPixel, pixelSequence, offsetList, compressedSize);
+      }
+      else
+      {
+        for (size_t i=0; (i<frameCount) && (result.good()); i++)
         {
-          // compress frame
-          jpegData = NULL;
-          if (bytesPerSample == 1)
+          frame = dimage->getOutputData(bitsPerSample, i, 0);
+          if (frame == NULL) result = EC_MemoryExhausted;
+          else
           {
-            result = jpeg->encode(columns, rows, interpr, samplesPerPixel, OFreinterpret_cast(Uint8*, OFconst_cast(void*, frame)), jpegData, jpegLen);
-          } else {
-            result = jpeg->encode(columns, rows, interpr, samplesPerPixel, OFreinterpret_cast(Uint16*, OFconst_cast(void*, frame)), jpegData, jpegLen);
-          }
+            // compress frame
+            jpegData = NULL;
+            if (bytesPerSample == 1)
+            {
+              result = jpeg->encode(columns, rows, interpr, samplesPerPixel, OFreinterpret_cast(Uint8*, OFconst_cast(void*, frame)), jpegData, jpegLen);
+            } else {
+              result = jpeg->encode(columns, rows, interpr, samplesPerPixel, OFreinterpret_cast(Uint16*, OFconst_cast(void*, frame)), jpegData, jpegLen);
+            }
 
-          // store frame
-          if (result.good())
-          {
-            result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, cp->getFragmentSize());
-          }
+            // store frame
+            if (result.good())
+            {
+              result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, cp->getFragmentSize());
+            }
 
-          // delete block of JPEG data
-          delete[] jpegData;
-          compressedSize += jpegLen;
+            // delete block of JPEG data
+            delete[] jpegData;
+            compressedSize += jpegLen;
+          }
         }
       }
       delete jpeg;
@@ -601,31 +731,40 @@ OFCondition DJCodecEncoder::encodeTrueLossless(
     DJEncoder *jpeg = createEncoderInstance(toRepParam, djcp, OFstatic_cast(Uint8, bitsAllocated));
     if (jpeg)
     {
-      // main loop for compression: compress each frame
-      for (unsigned int i=0; i<frameCount && result.good(); i++)
+      if ((djcp->getNumberOfThreads() > 1) && (frameCount > 1))
       {
-        if (bitsAllocated == 8)
-        {
-          jpeg->encode(columns, rows, interpr, samplesPerPixel, OFconst_cast(Uint8*, framePointer), jpegData, jpegLen);
-        }
-        else if (bitsAllocated == 16)
-        {
-          jpeg->encode(columns, rows, interpr, samplesPerPixel, OFreinterpret_cast(Uint16*, OFconst_cast(Uint8*, framePointer)), jpegData, jpegLen);
-        }
-        // update variables
-        compressedSize+=jpegLen;
-        framePointer+=frameSize;
-        if (jpegLen == 0)
-        {
-          DCMJPEG_ERROR("True lossless encoder: Error encoding frame");
-          result = EC_CannotChangeRepresentation;
-        }
-        else
+        result = encodeFramesInParallel(toRepParam, djcp, OFstatic_cast(Uint8, bitsAllocated), NULL, framePointer, frameSize,
+          frameCount, columns, rows, interpr, samplesPerPixel, pixelSequence, offsetList, compressedSize);
+        if (result.bad()) DCMJPEG_ERROR("True lossless encoder: Error encoding frame");
+      }
+      else
+      {
+        // main loop for compression: compress each frame
+        for (unsigned int i=0; i<frameCount && result.good(); i++)
         {
-          result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, djcp->getFragmentSize());
+          if (bitsAllocated == 8)
+          {
+            jpeg->encode(columns, rows, interpr, samplesPerPixel, OFconst_cast(Uint8*, framePointer), jpegData, jpegLen);
+          }
+          else if (bitsAllocated == 16)
+          {
+            jpeg->encode(columns, rows, interpr, samplesPerPixel, OFreinterpret_cast(Uint16*, OFconst_cast(Uint8*, framePointer)), jpegData, jpegLen);
+          }
+          // update variables
+          compressedSize+=jpegLen;
+          framePointer+=frameSize;
+          if (jpegLen == 0)
+          {
+            DCMJPEG_ERROR("True lossless encoder: Error encoding frame");
+            result = EC_CannotChangeRepresentation;
+          }
+          else
+          {
+            result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, djcp->getFragmentSize());
+          }
+          // free memory
+          delete[] jpegData;
         }
-        // free memory
-        delete[] jpegData;
       }
     }
     else
@@ -700,6 +839,84 @@ OFCondition DJCodecEncoder::encodeTrueLossless(
 }
 
 
+OFCondition DJCodecEncoder::encodeFramesInParallel(
+  const DcmRepresentationParameter * toRepParam,
+  const DJCodecParameter *cp,
+  Uint8 bitsPerSample,
+  DicomImage *dimage,
+  const Uint8 *pixelData,
+  size_t frameSize,
+  size_t frameCount,
+  Uint16 columns,
+  Uint16 rows,
+  EP_Interpretation interpr,
+  Uint16 samplesPerPixel,
+  DcmPixelSequence *pixelSequence,
+  DcmOffsetList& offsetList,
+  size_t& compressedSize) const
+{
+  OFCondition result = EC_Normal;
+  Uint32 numberOfThreads = cp->getNumberOfThreads();
+  if (numberOfThreads > frameCount) numberOfThreads = OFstatic_cast(Uint32, frameCount);
+  if (numberOfThreads < 1) numberOfThreads = 1;
+  DCMJPEG_DEBUG("JPEG encoder processes " << frameCount << " frames using up to " << numberOfThreads << " thread(s)");
+
+  // create one encoder instance per thread
+  DJEncoder **encoders = new DJEncoder *[numberOfThreads];
+  Uint32 i;
+  for (i = 0; i < numberOfThreads; ++i)
+  {
+    encoders[i] = createEncoderInstance(toRepParam, cp, bitsPerSample);
+    if (encoders[i] == NULL) result = EC_MemoryExhausted;
+  }
+
+  // rendering is not thread-safe and is done in this thread. In order to limit
+  // the memory needed, rendered frames are compressed in batches of one frame per thread.
+  const size_t batchSize = (dimage) ? numberOfThreads : frameCount;
+  const Uint8 **frames = new const Uint8 *[batchSize];
+  Uint8 **buffers = NULL;
+  unsigned long bufferSize = 0;
+  int outputBits = 0;
+  if (dimage && result.good())
+  {
+    outputBits = encoders[0]->bitsPerSample();
+    bufferSize = dimage->getOutputDataSize(outputBits);
+    buffers = new Uint8 *[batchSize];
+    for (i = 0; i < batchSize; ++i) buffers[i] = new Uint8[bufferSize];
+  }
+
+  for (size_t first = 0; (first < frameCount) && result.good(); first += batchSize)
+  {
+    const Uint32 batchFrames = OFstatic_cast(Uint32, (frameCount - first < batchSize) ? frameCount - first : batchSize);
+    for (i = 0; (i < batchFrames) && result.good(); ++i)
+    {
+      if (dimage)
+      {
+        if (dimage->getOutputData(buffers[i], bufferSize, outputBits, first + i, 0)) frames[i] = buffers[i];
+        else result = EC_MemoryExhausted;
+      }
+      else frames[i] = pixelData + (first + i) * frameSize;
+    }
+    if (result.good())
+    {
+      DJCodecFrameEncoder frameEncoder(batchFrames, encoders, frames, columns, rows, interpr, samplesPerPixel);
+      result = frameEncoder.processAllFrames(numberOfThreads);
+      if (result.good()) result = frameEncoder.storeFrames(pixelSequence, offsetList, cp->getFragmentSize(), compressedSize);
+    }
+  }
+
+  if (buffers)
+  {
+    for (i = 0; i < batchSize; ++i) delete[] buffers[i];
+    delete[] buffers;
+  }
+  delete[] frames;
+  for (i = 0; i < numberOfThreads; ++i) delete encoders[i];
+  delete[] encoders;
+  return result;
+}
+
+
 void DJCodecEncoder::appendCompressionRatio(
   OFString& arg,
   double ratio)
@@ -1139,30 +1356,38 @@ OFCondition DJCodecEncoder::encodeMonochromeImage(
       Uint16 samplesPerPixel = 0;
       if ((dataset->findAndGetUint16(DCM_SamplesPerPixel, samplesPerPixel)).bad()) samplesPerPixel = 1;
       uncompressedSize = OFstatic_cast(double, columns * rows * pixelDepth * frameCount * samplesPerPixel) / 8.0;
-      for (size_t i=0; (i<frameCount) && (result.good()); i++)
+      if ((cp->getNumberOfThreads() > 1) && (frameCount > 1))
       {
-        frame = dimage.getOutputData(bitsPerSample, i, 0);
-        if (frame == NULL) result = EC_MemoryExhausted;
-        else
+        result = encodeFramesInParallel(toRepParam, cp, OFstatic_cast(Uint8, compressedBits), &dimage, NULL, 0,
+          frameCount, columns, rows, EPI_Monochrome2, 1, pixelSequence, offsetList, compressedSize);
+      }
+      else
+      {
+        for (size_t i=0; (i<frameCount) && (result.good()); i++)
         {
-          // compress frame
-          jpegData = NULL;
-          if (bytesPerSample == 1)
+          frame = dimage.getOutputData(bitsPerSample, i, 0);
+          if (frame == NULL) result = EC_MemoryExhausted;
+          else
           {
-            result = jpeg->encode(columns, rows, EPI_Monochrome2, 1, OFreinterpret_cast(Uint8*, OFconst_cast(void*, frame)), jpegData, jpegLen);
-          } else {
-            result = jpeg->encode(columns, rows, EPI_Monochrome2, 1, OFreinterpret_cast(Uint16*, OFconst_cast(void*, frame)), jpegData, jpegLen);
-          }
+            // compress frame
+            jpegData = NULL;
+            if (bytesPerSample == 1)
+            {
+              result = jpeg->encode(columns, rows, EPI_Monochrome2, 1, OFreinterpret_cast(Uint8*, OFconst_cast(void*, frame)), jpegData, jpegLen);
+            } else {
+              result = jpeg->encode(columns, rows, EPI_Monochrome2, 1, OFreinterpret_cast(Uint16*, OFconst_cast(void*, frame)), jpegData, jpegLen);
+            }
 
-          // store frame
-          if (result.good())
-          {
-            result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, cp->getFragmentSize());
-          }
+            // store frame
+            if (result.good())
+            {
+              result = pixelSequence->storeCompressedFrame(offsetList, jpegData, jpegLen, cp->getFragmentSize());
+            }
 
-          // delete block of JPEG data
-          delete[] jpegData;
-          compressedSize += jpegLen;
+            // delete block of JPEG data
+            delete[] jpegData;
+            compressedSize += jpegLen;
+          }
         }
       }
       delete jpeg;
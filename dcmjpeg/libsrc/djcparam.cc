@@ -48,7 +48,8 @@ DJCodecParameter::DJCodecParameter(
     OFBool pUseModalityRescale,
     OFBool pAcceptWrongPaletteTags,
     OFBool pAcrNemaCompatibility,
-    OFBool pTrueLosslessMode)
+    OFBool pTrueLosslessMode,
+    Uint32 pNumberOfThreads)
 : DcmCodecParameter()
 , compressionCSConversion(pCompressionCSConversion)
 , decompressionCSConversion(pDecompressionCSConversion)
@@ -76,6 +77,45 @@ DJCodecParameter::DJCodecParameter(
 , acrNemaCompatibility(pAcrNemaCompatibility)
 , trueLosslessMode(pTrueLosslessMode)
 , predictor6WorkaroundEnabled_(predictor6WorkaroundEnable)
+, numberOfThreads_(pNumberOfThreads)
+{
+}
+
+
+DJCodecParameter::DJCodecParameter(
+    E_DecompressionColorSpaceConversion pDecompressionCSConversion,
+    E_UIDCreation pCreateSOPInstanceUID,
+    E_PlanarConfiguration pPlanarConfiguration,
+    OFBool predictor6WorkaroundEnable,
+    Uint32 pNumberOfThreads)
+: DcmCodecParameter()
+, compressionCSConversion(ECC_lossyYCbCr)
+, decompressionCSConversion(pDecompressionCSConversion)
+, planarConfiguration(pPlanarConfiguration)
+, optimizeHuffman(OFFalse)
+, smoothingFactor(0)
+, forcedBitDepth(0)
+, fragmentSize(0)
+, createOffsetTable(OFTrue)
+, sampleFactors(ESS_444)
+, writeYBR422(OFFalse)
+, convertToSC(OFFalse)
+, uidCreation(pCreateSOPInstanceUID)
+, windowType(0)
+, windowParameter(0)
+, voiCenter(0.0)
+, voiWidth(0.0)
+, roiLeft(0)
+, roiTop(0)
+, roiWidth(0)
+, roiHeight(0)
+, usePixelValues(OFTrue)
+, useModalityRescale(OFFalse)
+, acceptWrongPaletteTags(OFFalse)
+, acrNemaCompatibility(OFFalse)
+, trueLosslessMode(OFTrue)
+, predictor6WorkaroundEnabled_(predictor6WorkaroundEnable)
+, numberOfThreads_(pNumberOfThreads)
 {
 }
 
@@ -108,6 +148,7 @@ DJCodecParameter::DJCodecParameter(const DJCodecParameter& arg)
 , acrNemaCompatibility(arg.acrNemaCompatibility)
 , trueLosslessMode(arg.trueLosslessMode)
 , predictor6WorkaroundEnabled_(arg.predictor6WorkaroundEnabled_)
+, numberOfThreads_(arg.numberOfThreads_)
 {
 }
 
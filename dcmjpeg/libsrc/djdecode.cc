@@ -45,16 +45,17 @@ void DJDecoderRegistration::registerCodecs(
     E_DecompressionColorSpaceConversion pDecompressionCSConversion,
     E_UIDCreation pCreateSOPInstanceUID,
     E_PlanarConfiguration pPlanarConfiguration,
-    OFBool predictor6WorkaroundEnable)
+    OFBool predictor6WorkaroundEnable,
+    Uint32 pNumberOfThreads)
 {
   if (! registered)
   {
     cp = new DJCodecParameter(
-      ECC_lossyYCbCr, // ignored, compression only
-      pDecompressionCSConversion, 
-      pCreateSOPInstanceUID, 
+      pDecompressionCSConversion,
+      pCreateSOPInstanceUID,
       pPlanarConfiguration,
-      predictor6WorkaroundEnable);
+      predictor6WorkaroundEnable,
+      pNumberOfThreads);
     if (cp)
     {
       // baseline JPEG
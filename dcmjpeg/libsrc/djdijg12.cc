@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2001-2014, OFFIS e.V.
+ *  Copyright (C) 2001-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -194,6 +194,7 @@ DJDecompressIJG12Bit::DJDecompressIJG12Bit(const DJCodecParameter& cp, OFBool is
 , jsampBuffer(NULL)
 , dicomPhotometricInterpretationIsYCbCr(isYBR)
 , decompressedColorModel(EPI_Unknown)
+, scaleDenominator(1)
 {
 }
 
@@ -314,6 +315,13 @@ OFCondition DJDecompressIJG12Bit::decode(
       return EJ_Suspension;
     }
 
+    // use scaled inverse DCT for decompression with reduced resolution (lossy JPEG only)
+    if ((scaleDenominator > 1) && (cinfo->process != JPROC_LOSSLESS))
+    {
+      cinfo->scale_num = 1;
+      cinfo->scale_denom = scaleDenominator;
+    }
+
     // check if color space conversion is enabled
     OFBool colorSpaceConversion = OFFalse;
     // check whether to use the IJG library guess for the JPEG color space
@@ -449,6 +457,16 @@ OFCondition DJDecompressIJG12Bit::decode(
   return EC_Normal;
 }
 
+OFBool DJDecompressIJG12Bit::setScaleDenominator(Uint16 denominator)
+{
+  if ((denominator == 1) || (denominator == 2) || (denominator == 4) || (denominator == 8))
+  {
+    scaleDenominator = denominator;
+    return OFTrue;
+  }
+  return OFFalse;
+}
+
 void DJDecompressIJG12Bit::emitMessage(int msg_level) const
 {
   // This is how we map the message levels:
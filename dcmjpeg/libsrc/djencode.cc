@@ -64,7 +64,8 @@ void DJEncoderRegistration::registerCodecs(
     OFBool pUseModalityRescale,
     OFBool pAcceptWrongPaletteTags,
     OFBool pAcrNemaCompatibility,
-    OFBool pRealLossless)
+    OFBool pRealLossless,
+    Uint32 pNumberOfThreads)
 {
   if (! registered)
   {
@@ -94,7 +95,8 @@ void DJEncoderRegistration::registerCodecs(
       pUseModalityRescale,
       pAcceptWrongPaletteTags,
       pAcrNemaCompatibility,
-      pRealLossless);
+      pRealLossless,
+      pNumberOfThreads);
     if (cp)
     {
       // baseline JPEG
@@ -0,0 +1,65 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmjpeg
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: representation parameter for decompression with reduced resolution
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmjpeg/djrpres.h"
+
+
+DJ_RPReducedResolution::DJ_RPReducedResolution(Uint16 aMinimumSize)
+: DcmRepresentationParameter()
+, minimumSize(aMinimumSize)
+{
+}
+
+DJ_RPReducedResolution::DJ_RPReducedResolution(const DJ_RPReducedResolution& arg)
+: DcmRepresentationParameter(arg)
+, minimumSize(arg.minimumSize)
+{
+}
+
+DJ_RPReducedResolution::~DJ_RPReducedResolution()
+{
+}
+
+DcmRepresentationParameter *DJ_RPReducedResolution::clone() const
+{
+  return new DJ_RPReducedResolution(*this);
+}
+
+const char *DJ_RPReducedResolution::className() const
+{
+  return "DJ_RPReducedResolution";
+}
+
+OFBool DJ_RPReducedResolution::operator==(const DcmRepresentationParameter &arg) const
+{
+  const char *argname = arg.className();
+  if (argname)
+  {
+    OFString argstring(argname);
+    if (argstring == className())
+    {
+      const DJ_RPReducedResolution& argrr = OFstatic_cast(const DJ_RPReducedResolution&, arg);
+      if (minimumSize == argrr.minimumSize) return OFTrue;
+    }
+  }
+  return OFFalse;
+}
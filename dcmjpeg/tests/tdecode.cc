@@ -0,0 +1,259 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmjpeg
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the Huffman decoding and inverse DCT of the IJG libraries
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofcrc32.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmjpeg/djencode.h"
+#include "dcmtk/dcmjpeg/djdecode.h"
+#include "dcmtk/dcmjpeg/djrploss.h"
+#include "dcmtk/dcmjpeg/djrplol.h"
+#include "dcmtk/dcmimage/diregist.h"   /* include to support color images */
+
+
+/* The decoded pixel data of lossless images has to be identical to the original
+ * data. For lossy images, the CRC of the decoded pixel data is compared with the
+ * value that the IJG libraries returned before the Huffman decoding and the
+ * inverse DCT have been optimized. The encoder has not been changed.
+ */
+
+// size of the test images
+#define IMAGE_ROWS 128
+#define IMAGE_COLUMNS 160
+
+
+/* compute the value of a sample with the given number of bits. The image contains
+ * a uniform area (i.e. blocks without AC coefficients), a gradient, sharp edges
+ * and noise (i.e. long Huffman codes and many additional bits).
+ */
+static Uint16 sampleValue(const unsigned long x,
+                          const unsigned long y,
+                          const int sample,
+                          const int bits,
+                          Uint32 &seed)
+{
+    const unsigned long maxValue = (1UL << bits) - 1;
+    seed = seed * 1103515245 + 12345;
+    unsigned long value;
+    if (y < IMAGE_ROWS / 2)
+    {
+        if (x < IMAGE_COLUMNS / 2)
+            value = maxValue / (sample + 3);
+        else
+            value = (x * 3 + y * 2 + sample * 40) * maxValue / (IMAGE_COLUMNS * 3 + IMAGE_ROWS * 2 + 80);
+    } else {
+        if (x < IMAGE_COLUMNS / 2)
+            value = (((x / 5) + (y / 3) + sample) & 1) ? maxValue - maxValue / 7 : maxValue / 9;
+        else
+            value = (seed >> 8) & maxValue;
+    }
+    return OFstatic_cast(Uint16, value);
+}
+
+
+/* create an image with the given number of bits and samples per pixel */
+static void createImage(DcmDataset &dataset,
+                        OFVector<Uint16> &samples,
+                        const int bits,
+                        const int samplesPerPixel)
+{
+    const unsigned long count = IMAGE_ROWS * IMAGE_COLUMNS * samplesPerPixel;
+    samples.resize(count);
+    Uint32 seed = 4711;
+    unsigned long i = 0;
+    for (unsigned long y = 0; y < IMAGE_ROWS; ++y)
+    {
+        for (unsigned long x = 0; x < IMAGE_COLUMNS; ++x)
+        {
+            for (int s = 0; s < samplesPerPixel; ++s)
+                samples[i++] = sampleValue(x, y, s, bits, seed);
+        }
+    }
+    dataset.clear();
+    dataset.putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.0.19");
+    dataset.putAndInsertUint16(DCM_SamplesPerPixel, OFstatic_cast(Uint16, samplesPerPixel));
+    dataset.putAndInsertString(DCM_PhotometricInterpretation, (samplesPerPixel == 3) ? "RGB" : "MONOCHROME2");
+    if (samplesPerPixel == 3)
+        dataset.putAndInsertUint16(DCM_PlanarConfiguration, 0);
+    dataset.putAndInsertUint16(DCM_Rows, IMAGE_ROWS);
+    dataset.putAndInsertUint16(DCM_Columns, IMAGE_COLUMNS);
+    dataset.putAndInsertUint16(DCM_BitsAllocated, (bits > 8) ? 16 : 8);
+    dataset.putAndInsertUint16(DCM_BitsStored, OFstatic_cast(Uint16, bits));
+    dataset.putAndInsertUint16(DCM_HighBit, OFstatic_cast(Uint16, bits - 1));
+    dataset.putAndInsertUint16(DCM_PixelRepresentation, 0);
+    if (bits > 8)
+        dataset.putAndInsertUint16Array(DCM_PixelData, &samples[0], count);
+    else {
+        OFVector<Uint8> bytes(count);
+        for (i = 0; i < count; ++i)
+            bytes[i] = OFstatic_cast(Uint8, samples[i]);
+        dataset.putAndInsertUint8Array(DCM_PixelData, &bytes[0], count);
+    }
+}
+
+
+/* compress the image and decompress it again, return the decoded samples */
+static OFBool compressAndDecompress(DcmDataset &dataset,
+                                    const E_TransferSyntax xfer,
+                                    const DcmRepresentationParameter *rp,
+                                    const int bits,
+                                    OFVector<Uint16> &samples)
+{
+    // remove the uncompressed pixel data, so that it has to be decoded
+    if (dataset.chooseRepresentation(xfer, rp).bad())
+        return OFFalse;
+    dataset.removeAllButCurrentRepresentations();
+    if (dataset.chooseRepresentation(EXS_LittleEndianExplicit, NULL).bad())
+        return OFFalse;
+    unsigned long count = 0;
+    samples.clear();
+    if (bits > 8)
+    {
+        const Uint16 *data = NULL;
+        if (dataset.findAndGetUint16Array(DCM_PixelData, data, &count).bad())
+            return OFFalse;
+        samples.resize(count);
+        for (unsigned long i = 0; i < count; ++i)
+            samples[i] = data[i];
+    } else {
+        const Uint8 *data = NULL;
+        if (dataset.findAndGetUint8Array(DCM_PixelData, data, &count).bad())
+            return OFFalse;
+        samples.resize(count);
+        for (unsigned long i = 0; i < count; ++i)
+            samples[i] = data[i];
+    }
+    return OFTrue;
+}
+
+
+/* compare two lists of samples */
+static OFBool compareSamples(const OFVector<Uint16> &samples1,
+                             const OFVector<Uint16> &samples2)
+{
+    if (samples1.size() != samples2.size())
+        return OFFalse;
+    for (size_t i = 0; i < samples1.size(); ++i)
+    {
+        if (samples1[i] != samples2[i])
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+
+/* compute the CRC of the samples (independent of the byte order) */
+static unsigned int computeCRC(const OFVector<Uint16> &samples,
+                               const int bits)
+{
+    OFCRC32 crc;
+    Uint8 bytes[2];
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        bytes[0] = OFstatic_cast(Uint8, samples[i] & 0xff);
+        bytes[1] = OFstatic_cast(Uint8, samples[i] >> 8);
+        crc.addBlock(bytes, (bits > 8) ? 2 : 1);
+    }
+    return crc.getCRC32();
+}
+
+
+OFTEST(dcmjpeg_decodeLossless)
+{
+    DJEncoderRegistration::registerCodecs();
+    DJDecoderRegistration::registerCodecs();
+
+    DcmDataset dataset;
+    OFVector<Uint16> original;
+    OFVector<Uint16> decoded;
+    // all predictors for monochrome images (single-sample MCUs)
+    const int bits[] = { 8, 12, 16 };
+    for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); ++i)
+    {
+        for (int predictor = 1; predictor <= 7; ++predictor)
+        {
+            DJ_RPLossless rp(predictor);
+            createImage(dataset, original, bits[i], 1);
+            OFCHECK(compressAndDecompress(dataset, EXS_JPEGProcess14, &rp, bits[i], decoded));
+            OFCHECK(compareSamples(decoded, original));
+        }
+    }
+    // color images (three samples per MCU)
+    DJ_RPLossless rp;
+    createImage(dataset, original, 8, 3);
+    OFCHECK(compressAndDecompress(dataset, EXS_JPEGProcess14SV1, &rp, 8, decoded));
+    OFCHECK(compareSamples(decoded, original));
+
+    DJDecoderRegistration::cleanup();
+    DJEncoderRegistration::cleanup();
+}
+
+
+OFTEST(dcmjpeg_decodeLossy)
+{
+    DJEncoderRegistration::registerCodecs();
+    DJDecoderRegistration::registerCodecs();
+
+    // description of the lossy test cases and the CRC of the decoded pixel data
+    struct LossyTestCase
+    {
+        E_TransferSyntax xfer;
+        int bits;
+        int samplesPerPixel;
+        int quality;
+        unsigned int crc;
+    };
+    const LossyTestCase testCases[] =
+    {
+        { EXS_JPEGProcess1,     8, 1, 90, 0x58f1ec8a },
+        { EXS_JPEGProcess1,     8, 1, 50, 0xf220f04c },
+        { EXS_JPEGProcess1,     8, 3, 90, 0x04d64b94 },
+        { EXS_JPEGProcess2_4,  12, 1, 90, 0x54bef733 },
+        { EXS_JPEGProcess2_4,  12, 3, 75, 0xab65d4f2 },
+        // progressive and spectral selection decode to the same values as the sequential process
+        { EXS_JPEGProcess6_8,   8, 1, 90, 0x58f1ec8a },
+        { EXS_JPEGProcess10_12, 8, 1, 90, 0x58f1ec8a },
+        { EXS_JPEGProcess10_12, 8, 3, 90, 0x04d64b94 },
+        { EXS_JPEGProcess10_12, 12, 1, 90, 0x54bef733 }
+    };
+    DcmDataset dataset;
+    OFVector<Uint16> original;
+    OFVector<Uint16> decoded;
+    for (size_t i = 0; i < sizeof(testCases) / sizeof(testCases[0]); ++i)
+    {
+        const LossyTestCase &test = testCases[i];
+        DJ_RPLossy rp(test.quality);
+        createImage(dataset, original, test.bits, test.samplesPerPixel);
+        OFCHECK(compressAndDecompress(dataset, test.xfer, &rp, test.bits, decoded));
+        OFCHECK_EQUAL(decoded.size(), original.size());
+        OFCHECK_EQUAL(computeCRC(decoded, test.bits), test.crc);
+    }
+
+    DJDecoderRegistration::cleanup();
+    DJEncoderRegistration::cleanup();
+}
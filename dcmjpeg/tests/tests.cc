@@ -0,0 +1,33 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmjpeg
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: main test program
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oftest.h"
+
+OFTEST_REGISTER(dcmjpeg_reducedResolution);
+OFTEST_REGISTER(dcmjpeg_reducedResolutionLossless);
+OFTEST_REGISTER(dcmjpeg_reducedResolutionRepresentations);
+OFTEST_REGISTER(dcmjpeg_decodeLossless);
+OFTEST_REGISTER(dcmjpeg_decodeLossy);
+OFTEST_REGISTER(dcmjpeg_parallelCompression);
+OFTEST_REGISTER(dcmjpeg_parallelDecompression);
+OFTEST_MAIN("dcmjpeg")
@@ -0,0 +1,307 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmjpeg
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the decompression with reduced resolution
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmjpeg/djencode.h"
+#include "dcmtk/dcmjpeg/djdecode.h"
+#include "dcmtk/dcmjpeg/djrploss.h"
+#include "dcmtk/dcmjpeg/djrplol.h"
+#include "dcmtk/dcmjpeg/djrpres.h"
+
+#define INCLUDE_CSTDIO
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+// temporary files which will be used (one per test, since tests may run in parallel)
+static const char *temporaryFile1 = "reduce1.tmp";
+static const char *temporaryFile2 = "reduce2.tmp";
+static const char *temporaryFile3 = "reduce3.tmp";
+
+// size of the test image
+#define IMAGE_ROWS 48
+#define IMAGE_COLUMNS 64
+
+// position of the single pixel set in the overlay plane
+#define OVERLAY_ROW 21
+#define OVERLAY_COLUMN 13
+
+// SOP Instance UID of the test image
+#define SOP_INSTANCE_UID "1.2.276.0.7230010.3.1.4.0.0.0.5"
+
+
+/* create a monochrome image with pixel spacing attributes and an overlay plane,
+ * compress it with the given transfer syntax and read it from the given file again
+ */
+static OFBool createCompressedImage(DcmFileFormat &fileformat,
+                                    const E_TransferSyntax xfer,
+                                    const DcmRepresentationParameter *rp,
+                                    const char *temporaryFile)
+{
+    DcmDataset *dataset = fileformat.getDataset();
+    dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage);
+    dataset->putAndInsertString(DCM_SOPInstanceUID, SOP_INSTANCE_UID);
+    dataset->putAndInsertString(DCM_ImageType, "ORIGINAL\\PRIMARY");
+    dataset->putAndInsertString(DCM_PixelSpacing, "0.5\\0.25");
+    dataset->putAndInsertString(DCM_ImagerPixelSpacing, "0.6\\0.3");
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_Rows, IMAGE_ROWS);
+    dataset->putAndInsertUint16(DCM_Columns, IMAGE_COLUMNS);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 8);
+    dataset->putAndInsertUint16(DCM_BitsStored, 8);
+    dataset->putAndInsertUint16(DCM_HighBit, 7);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+    Uint8 pixels[IMAGE_ROWS * IMAGE_COLUMNS];
+    for (unsigned long i = 0; i < IMAGE_ROWS * IMAGE_COLUMNS; ++i)
+        pixels[i] = OFstatic_cast(Uint8, (i % IMAGE_COLUMNS) * 2 + (i / IMAGE_COLUMNS));
+    dataset->putAndInsertUint8Array(DCM_PixelData, pixels, IMAGE_ROWS * IMAGE_COLUMNS);
+
+    // the pixel measures of an enhanced image
+    DcmItem *item = NULL;
+    if (dataset->findOrCreateSequenceItem(DCM_SharedFunctionalGroupsSequence, item).good())
+    {
+        DcmItem *measures = NULL;
+        if (item->findOrCreateSequenceItem(DCM_PixelMeasuresSequence, measures).good())
+            measures->putAndInsertString(DCM_PixelSpacing, "0.5\\0.25");
+    }
+
+    // an overlay plane with a single pixel set
+    Uint8 overlay[IMAGE_ROWS * IMAGE_COLUMNS / 8];
+    memset(overlay, 0, sizeof(overlay));
+    const unsigned long pos = OVERLAY_ROW * IMAGE_COLUMNS + OVERLAY_COLUMN;
+    overlay[pos >> 3] = OFstatic_cast(Uint8, 1 << (pos & 7));
+    const Sint16 origin[2] = { 1, 1 };
+    dataset->putAndInsertUint16(DCM_OverlayRows, IMAGE_ROWS);
+    dataset->putAndInsertUint16(DCM_OverlayColumns, IMAGE_COLUMNS);
+    dataset->putAndInsertString(DCM_OverlayType, "G");
+    dataset->putAndInsertSint16Array(DCM_OverlayOrigin, origin, 2);
+    dataset->putAndInsertUint16(DCM_OverlayBitsAllocated, 1);
+    dataset->putAndInsertUint16(DCM_OverlayBitPosition, 0);
+    dataset->putAndInsertUint8Array(DCM_OverlayData, overlay, sizeof(overlay));
+
+    // the compressed pixel data has to be the original representation
+    if (dataset->chooseRepresentation(xfer, rp).bad() ||
+        fileformat.saveFile(temporaryFile, xfer).bad())
+    {
+        return OFFalse;
+    }
+    fileformat.clear();
+    return fileformat.loadFile(temporaryFile).good();
+}
+
+
+/* check whether the pixel at the given position of the first overlay plane is set */
+static OFBool isOverlayPixelSet(DcmDataset &dataset,
+                                const Uint16 row,
+                                const Uint16 column)
+{
+    Uint16 columns = 0;
+    DcmElement *elem = NULL;
+    Uint8 *bits = NULL;
+    if (dataset.findAndGetUint16(DCM_OverlayColumns, columns).bad() ||
+        dataset.findAndGetElement(DCM_OverlayData, elem).bad() ||
+        elem->getUint8Array(bits).bad() || (bits == NULL))
+    {
+        return OFFalse;
+    }
+    const unsigned long pos = OFstatic_cast(unsigned long, row) * columns + column;
+    return (pos / 8 < elem->getLength()) && ((bits[pos >> 3] & (1 << (pos & 7))) != 0);
+}
+
+
+/* count the pixels set in the first overlay plane */
+static unsigned long countOverlayPixels(DcmDataset &dataset)
+{
+    unsigned long count = 0;
+    DcmElement *elem = NULL;
+    Uint8 *bits = NULL;
+    if (dataset.findAndGetElement(DCM_OverlayData, elem).good() &&
+        elem->getUint8Array(bits).good() && (bits != NULL))
+    {
+        for (unsigned long i = 0; i < elem->getLength() * 8; ++i)
+        {
+            if (bits[i >> 3] & (1 << (i & 7)))
+                ++count;
+        }
+    }
+    return count;
+}
+
+
+/* get a value of a string attribute in the given item */
+static OFString getString(DcmItem &item,
+                          const DcmTagKey &tag,
+                          const unsigned long pos = 0)
+{
+    OFString value;
+    item.findAndGetOFString(tag, value, pos);
+    return value;
+}
+
+
+OFTEST(dcmjpeg_reducedResolution)
+{
+    DJEncoderRegistration::registerCodecs();
+    DJDecoderRegistration::registerCodecs();
+
+    // full resolution without the representation parameter
+    DcmFileFormat fileformat;
+    DJ_RPLossy rp_lossy(90);
+    OFCHECK(createCompressedImage(fileformat, EXS_JPEGProcess1, &rp_lossy, temporaryFile1));
+    DcmDataset *dataset = fileformat.getDataset();
+    // lossy compression already created a new SOP Instance UID
+    OFString sopInstanceUID = getString(*dataset, DCM_SOPInstanceUID);
+    OFCHECK(dataset->chooseRepresentation(EXS_LittleEndianExplicit, NULL).good());
+    Uint16 rows = 0;
+    Uint16 columns = 0;
+    OFCHECK(dataset->findAndGetUint16(DCM_Rows, rows).good());
+    OFCHECK(dataset->findAndGetUint16(DCM_Columns, columns).good());
+    OFCHECK_EQUAL(rows, IMAGE_ROWS);
+    OFCHECK_EQUAL(columns, IMAGE_COLUMNS);
+    OFCHECK_EQUAL(getString(*dataset, DCM_PixelSpacing, 1), "0.25");
+    OFCHECK_EQUAL(getString(*dataset, DCM_SOPInstanceUID), sopInstanceUID);
+
+    // half resolution, i.e. the lowest one that is still at least 32 pixels wide or high
+    DcmFileFormat reducedFileformat;
+    DJ_RPReducedResolution rp_reduced(32);
+    OFCHECK(createCompressedImage(reducedFileformat, EXS_JPEGProcess1, &rp_lossy, temporaryFile1));
+    dataset = reducedFileformat.getDataset();
+    sopInstanceUID = getString(*dataset, DCM_SOPInstanceUID);
+    OFCHECK(dataset->chooseRepresentation(EXS_LittleEndianExplicit, &rp_reduced).good());
+    OFCHECK(dataset->findAndGetUint16(DCM_Rows, rows).good());
+    OFCHECK(dataset->findAndGetUint16(DCM_Columns, columns).good());
+    OFCHECK_EQUAL(rows, IMAGE_ROWS / 2);
+    OFCHECK_EQUAL(columns, IMAGE_COLUMNS / 2);
+    DcmElement *pixelData = NULL;
+    OFCHECK(dataset->findAndGetElement(DCM_PixelData, pixelData).good());
+    if (pixelData != NULL)
+        OFCHECK_EQUAL(pixelData->getLength(), OFstatic_cast(Uint32, rows) * columns);
+    // each pixel spacing attribute is rescaled in place
+    OFCHECK_EQUAL(getString(*dataset, DCM_PixelSpacing, 0), "1.000000");
+    OFCHECK_EQUAL(getString(*dataset, DCM_PixelSpacing, 1), "0.500000");
+    OFCHECK_EQUAL(getString(*dataset, DCM_ImagerPixelSpacing, 0), "1.200000");
+    OFCHECK_EQUAL(getString(*dataset, DCM_ImagerPixelSpacing, 1), "0.600000");
+    OFCHECK(!dataset->tagExists(DCM_NominalScannedPixelSpacing));
+    DcmItem *measures = NULL;
+    OFCHECK(dataset->findAndGetSequenceItem(DCM_SharedFunctionalGroupsSequence, measures).good());
+    if (measures != NULL)
+    {
+        OFCHECK(measures->findAndGetSequenceItem(DCM_PixelMeasuresSequence, measures).good());
+        if (measures != NULL)
+            OFCHECK_EQUAL(getString(*measures, DCM_PixelSpacing, 1), "0.500000");
+    }
+    // the overlay plane is reduced in the same way
+    OFCHECK(dataset->findAndGetUint16(DCM_OverlayRows, rows).good());
+    OFCHECK(dataset->findAndGetUint16(DCM_OverlayColumns, columns).good());
+    OFCHECK_EQUAL(rows, IMAGE_ROWS / 2);
+    OFCHECK_EQUAL(columns, IMAGE_COLUMNS / 2);
+    OFCHECK(isOverlayPixelSet(*dataset, OVERLAY_ROW / 2, OVERLAY_COLUMN / 2));
+    OFCHECK_EQUAL(countOverlayPixels(*dataset), 1);
+    // the result is a new, derived image
+    OFCHECK_EQUAL(getString(*dataset, DCM_ImageType), "DERIVED");
+    OFCHECK(getString(*dataset, DCM_SOPInstanceUID) != sopInstanceUID);
+
+    DJDecoderRegistration::cleanup();
+    DJEncoderRegistration::cleanup();
+    remove(temporaryFile1);
+}
+
+
+OFTEST(dcmjpeg_reducedResolutionLossless)
+{
+    DJEncoderRegistration::registerCodecs();
+    DJDecoderRegistration::registerCodecs();
+
+    // lossless JPEG is always decompressed with full resolution
+    DcmFileFormat fileformat;
+    DJ_RPLossless rp_lossless;
+    DJ_RPReducedResolution rp_reduced(8);
+    OFCHECK(createCompressedImage(fileformat, EXS_JPEGProcess14SV1, &rp_lossless, temporaryFile2));
+    DcmDataset *dataset = fileformat.getDataset();
+    OFCHECK(dataset->chooseRepresentation(EXS_LittleEndianExplicit, &rp_reduced).good());
+    Uint16 rows = 0;
+    Uint16 columns = 0;
+    OFCHECK(dataset->findAndGetUint16(DCM_Rows, rows).good());
+    OFCHECK(dataset->findAndGetUint16(DCM_Columns, columns).good());
+    OFCHECK_EQUAL(rows, IMAGE_ROWS);
+    OFCHECK_EQUAL(columns, IMAGE_COLUMNS);
+    OFCHECK_EQUAL(getString(*dataset, DCM_PixelSpacing, 1), "0.25");
+    OFCHECK(isOverlayPixelSet(*dataset, OVERLAY_ROW, OVERLAY_COLUMN));
+    OFCHECK_EQUAL(getString(*dataset, DCM_SOPInstanceUID), SOP_INSTANCE_UID);
+
+    DJDecoderRegistration::cleanup();
+    DJEncoderRegistration::cleanup();
+    remove(temporaryFile2);
+}
+
+
+OFTEST(dcmjpeg_reducedResolutionRepresentations)
+{
+    DJEncoderRegistration::registerCodecs();
+    DJDecoderRegistration::registerCodecs();
+
+    // the full resolution JPEG data is removed after a reduced resolution decompression
+    DcmFileFormat fileformat;
+    DJ_RPLossy rp_lossy(90);
+    DJ_RPReducedResolution rp_reduced(32);
+    OFCHECK(createCompressedImage(fileformat, EXS_JPEGProcess1, &rp_lossy, temporaryFile3));
+    DcmDataset *dataset = fileformat.getDataset();
+    OFCHECK(dataset->chooseRepresentation(EXS_LittleEndianExplicit, &rp_reduced).good());
+    OFCHECK(!dataset->hasRepresentation(EXS_JPEGProcess1, NULL));
+    OFCHECK(!dataset->canWriteXfer(EXS_JPEGProcess1));
+    // choosing the JPEG transfer syntax again compresses the reduced image
+    OFCHECK(dataset->chooseRepresentation(EXS_JPEGProcess1, NULL).good());
+    dataset->removeAllButCurrentRepresentations();
+    OFCHECK(dataset->chooseRepresentation(EXS_LittleEndianExplicit, NULL).good());
+    Uint16 rows = 0;
+    Uint16 columns = 0;
+    OFCHECK(dataset->findAndGetUint16(DCM_Rows, rows).good());
+    OFCHECK(dataset->findAndGetUint16(DCM_Columns, columns).good());
+    OFCHECK_EQUAL(rows, IMAGE_ROWS / 2);
+    OFCHECK_EQUAL(columns, IMAGE_COLUMNS / 2);
+    DcmElement *pixelData = NULL;
+    OFCHECK(dataset->findAndGetElement(DCM_PixelData, pixelData).good());
+    if (pixelData != NULL)
+        OFCHECK_EQUAL(pixelData->getLength(), OFstatic_cast(Uint32, rows) * columns);
+
+    // a reduced resolution cannot be applied to pixel data that is already decompressed
+    DcmFileFormat decompressedFileformat;
+    OFCHECK(createCompressedImage(decompressedFileformat, EXS_JPEGProcess1, &rp_lossy, temporaryFile3));
+    dataset = decompressedFileformat.getDataset();
+    OFCHECK(dataset->chooseRepresentation(EXS_LittleEndianExplicit, NULL).good());
+    OFCHECK(dataset->chooseRepresentation(EXS_LittleEndianExplicit, &rp_reduced) == EC_CannotChangeRepresentation);
+    OFCHECK(dataset->findAndGetUint16(DCM_Rows, rows).good());
+    OFCHECK_EQUAL(rows, IMAGE_ROWS);
+    // the full resolution JPEG data is still available
+    OFCHECK(dataset->hasRepresentation(EXS_JPEGProcess1, NULL));
+    OFCHECK(dataset->canWriteXfer(EXS_JPEGProcess1));
+
+    DJDecoderRegistration::cleanup();
+    DJEncoderRegistration::cleanup();
+    remove(temporaryFile3);
+}
@@ -94,6 +94,7 @@ int main(int argc, char *argv[])
   OFCmdUnsignedInt opt_nearlossless_deviation = 2;
   OFBool opt_prefer_cooked = OFFalse;
   DJLSCodecParameter::interleaveMode opt_interleaveMode = DJLSCodecParameter::interleaveLine;
+  OFCmdUnsignedInt opt_threads = 1;
 
   // encapsulated pixel data encoding options
   OFCmdUnsignedInt opt_fragmentSize = 0; // 0=unlimited
@@ -169,6 +170,10 @@ LICENSE_FILE_DECLARE_COMMAND_LINE_OPTIONS
       cmd.addOption("--interleave-none",        "+in",    "force uninterleaved JPEG-LS images");
       cmd.addOption("--interleave-default",     "+iv",    "use the fastest possible interleave mode");
 
+    cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",                "+mt", 1, "[n]umber: integer (default: 1)",
+                                                          "use n threads for compressing the frames\nof multi-frame images");
+
   cmd.addGroup("encapsulated pixel data encoding options:");
     cmd.addSubGroup("pixel data fragmentation:");
       cmd.addOption("--fragment-per-frame",     "+ff",    "encode each frame as one fragment (default)");
@@ -347,6 +352,10 @@ LICENSE_FILE_EVALUATE_COMMAND_LINE_OPTIONS
       }
       cmd.endOptionBlock();
 
+      // multi-threading options
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMin(opt_threads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+
       // encapsulated pixel data encoding options
       // pixel data fragmentation options
       cmd.beginOptionBlock();
@@ -417,7 +426,7 @@ LICENSE_FILE_EVALUATE_COMMAND_LINE_OPTIONS
       OFstatic_cast(Uint16, opt_t1), OFstatic_cast(Uint16, opt_t2), OFstatic_cast(Uint16, opt_t3),
       OFstatic_cast(Uint16, opt_reset), OFstatic_cast(Uint16, opt_limit),
       opt_prefer_cooked, opt_fragmentSize, opt_createOffsetTable,
-      opt_uidcreation, opt_secondarycapture, opt_interleaveMode);
+      opt_uidcreation, opt_secondarycapture, opt_interleaveMode, OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
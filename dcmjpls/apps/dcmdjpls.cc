@@ -86,6 +86,7 @@ int main(int argc, char *argv[])
   JLS_UIDCreation opt_uidcreation = EJLSUC_default;
   JLS_PlanarConfiguration opt_planarconfig = EJLSPC_restore;
   OFBool opt_ignoreOffsetTable = OFFalse;
+  OFCmdUnsignedInt opt_threads = 1;
 
 #ifdef USE_LICENSE_FILE
 LICENSE_FILE_DECLARATIONS
@@ -125,6 +126,8 @@ LICENSE_FILE_DECLARE_COMMAND_LINE_OPTIONS
       cmd.addOption("--uid-always",             "+ua",    "always assign new UID");
     cmd.addSubGroup("other processing options:");
       cmd.addOption("--ignore-offsettable",     "+io",    "ignore offset table when decompressing");
+      cmd.addOption("--threads",                "+mt", 1, "[n]umber: integer (default: 1)",
+                                                          "use n threads for decompressing the frames\nof multi-frame images");
 
   cmd.addGroup("output options:");
     cmd.addSubGroup("output file format:");
@@ -196,6 +199,9 @@ LICENSE_FILE_EVALUATE_COMMAND_LINE_OPTIONS
 
       if (cmd.findOption("--ignore-offsettable")) opt_ignoreOffsetTable = OFTrue;
 
+      if (cmd.findOption("--threads"))
+        app.checkValue(cmd.getValueAndCheckMin(opt_threads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--read-file"))
       {
@@ -265,7 +271,8 @@ LICENSE_FILE_EVALUATE_COMMAND_LINE_OPTIONS
     OFLOG_DEBUG(dcmdjplsLogger, rcsid << OFendl);
 
     // register global decompression codecs
-    DJLSDecoderRegistration::registerCodecs(opt_uidcreation, opt_planarconfig, opt_ignoreOffsetTable);
+    DJLSDecoderRegistration::registerCodecs(opt_uidcreation, opt_planarconfig, opt_ignoreOffsetTable,
+      OFstatic_cast(Uint32, opt_threads));
 
     /* make sure data dictionary is loaded */
     if (!dcmDataDict.isDictionaryLoaded())
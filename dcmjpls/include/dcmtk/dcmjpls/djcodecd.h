@@ -29,6 +29,7 @@
 
 /* forward declaration */
 class DJLSCodecParameter;
+class DJLSFrameDecoder;
 
 /** abstract codec class for JPEG-LS decoders.
  *  This abstract class contains most of the application logic
@@ -177,6 +178,9 @@ public:
 
 private:
 
+  /// helper class for parallel decompression needs access to decodeFrameData()
+  friend class DJLSFrameDecoder;
+
   // static private helper methods
 
   /** decompresses a single frame from the given pixel sequence and
@@ -218,6 +222,69 @@ private:
     Uint16 imageSamplesPerPixel,
     Uint16 bytesPerSample);
 
+  /** determines the planar configuration of the decompressed image
+   *  depending on the codec parameters and the given dataset.
+   *  @param cp codec parameters for this codec
+   *  @param dataset pointer to dataset in which pixel data element is contained
+   *  @param imageSamplesPerPixel number of samples per pixel
+   *  @return planar configuration of the decompressed image, 0 or 1
+   */
+  static Uint16 determineDecompressedPlanarConfiguration(
+    const DJLSCodecParameter *cp,
+    DcmItem *dataset,
+    Uint16 imageSamplesPerPixel);
+
+  /** accesses the compressed JPEG-LS bitstream of a single frame.
+   *  If the frame is contained in a single fragment, the data of the pixel item
+   *  is returned directly, otherwise all fragments of the frame are copied into
+   *  a newly allocated buffer.
+   *  @param fromPixSeq compressed pixel sequence
+   *  @param cp codec parameters for this codec
+   *  @param frameNo number of frame, starting with 0 for the first frame
+   *  @param currentItem index of the first fragment of the frame, updated
+   *    to contain the index of the first fragment of the next frame
+   *  @param imageFrames number of frames in this image
+   *  @param jlsData pointer to the compressed bitstream returned in this parameter
+   *  @param compressedSize size of the compressed bitstream returned in this parameter
+   *  @param deleteData OFTrue returned in this parameter if jlsData has been
+   *    allocated by this method and must be deleted by the caller using delete[]
+   *  @return EC_Normal if successful, an error code otherwise.
+   */
+  static OFCondition readFrameData(
+    DcmPixelSequence * fromPixSeq,
+    const DJLSCodecParameter *cp,
+    Uint32 frameNo,
+    Uint32& currentItem,
+    Sint32 imageFrames,
+    Uint8 *& jlsData,
+    size_t& compressedSize,
+    OFBool& deleteData);
+
+  /** decompresses the JPEG-LS bitstream of a single frame and stores the
+   *  result in the given buffer. Does not access any DICOM objects and can
+   *  therefore be called from multiple threads at the same time.
+   *  @param jlsData compressed JPEG-LS bitstream
+   *  @param compressedSize size of the compressed bitstream in bytes
+   *  @param buffer pointer to buffer where frame is to be stored
+   *  @param bufSize size of buffer in bytes
+   *  @param imageColumns number of columns for each frame
+   *  @param imageRows number of rows for each frame
+   *  @param imageSamplesPerPixel number of samples per pixel
+   *  @param bytesPerSample number of bytes per sample
+   *  @param imagePlanarConfiguration planar configuration of the decompressed image
+   *  @return EC_Normal if successful, an error code otherwise.
+   */
+  static OFCondition decodeFrameData(
+    Uint8 *jlsData,
+    size_t compressedSize,
+    void *buffer,
+    Uint32 bufSize,
+    Uint16 imageColumns,
+    Uint16 imageRows,
+    Uint16 imageSamplesPerPixel,
+    Uint16 bytesPerSample,
+    Uint16 imagePlanarConfiguration);
+
   /** determines if a given image requires color-by-plane planar configuration
    *  depending on SOP Class UID (DICOM IOD) and photometric interpretation.
    *  All SOP classes defined in the 2003 edition of the DICOM standard or earlier
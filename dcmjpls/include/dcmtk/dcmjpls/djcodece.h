@@ -30,6 +30,7 @@
 
 class DJLSRepresentationParameter;
 class DJLSCodecParameter;
+class DJLSFrameEncoder;
 class DicomImage;
 
 /** abstract codec class for JPEG-LS encoders.
@@ -179,6 +180,9 @@ public:
 
 private:
 
+  /// helper class for parallel compression needs access to the frame compression methods
+  friend class DJLSFrameEncoder;
+
   /** returns the transfer syntax that this particular codec
    *  is able to encode
    *  @return supported transfer syntax
@@ -270,8 +274,8 @@ private:
    *  @param samplesPerPixel image samples per pixel
    *  @param planarConfiguration image planar configuration
    *  @param photometricInterpretation photometric interpretation of the DICOM dataset
-   *  @param pixelSequence object in which the compressed frame is stored
-   *  @param offsetList list of frame offsets updated in this parameter
+   *  @param compressedData compressed frame returned in this parameter upon success,
+   *    must be deleted by the caller using delete[]
    *  @param compressedSize size of compressed frame returned in this parameter
    *  @param djcp parameters for the codec
    *  @return EC_Normal if successful, an error code otherwise
@@ -284,16 +288,17 @@ private:
     Uint16 samplesPerPixel,
     Uint16 planarConfiguration,
     const OFString& photometricInterpretation,
-    DcmPixelSequence *pixelSequence,
-    DcmOffsetList &offsetList,
+    Uint8 *&compressedData,
     unsigned long &compressedSize,
     const DJLSCodecParameter *djcp) const;
 
-  /** perform the lossless cooked compression of a single frame
-   *  @param pixelSequence object in which the compressed frame is stored
+  /** perform the lossless cooked compression of a single frame.
+   *  Only reads the intermediate pixel data of the given DicomImage instance,
+   *  so several frames of the same image may be compressed concurrently.
    *  @param dimage DicomImage instance used to process frame
    *  @param photometricInterpretation photometric interpretation of the DICOM dataset
-   *  @param offsetList list of frame offsets updated in this parameter
+   *  @param compressedData compressed frame returned in this parameter upon success,
+   *    must be deleted by the caller using delete[]
    *  @param compressedSize size of compressed frame returned in this parameter
    *  @param djcp parameters for the codec
    *  @param frame frame index
@@ -301,10 +306,9 @@ private:
    *  @return EC_Normal if successful, an error code otherwise
    */
   OFCondition compressCookedFrame(
-    DcmPixelSequence *pixelSequence,
     DicomImage *dimage,
     const OFString& photometricInterpretation,
-    DcmOffsetList &offsetList,
+    Uint8 *&compressedData,
     unsigned long &compressedSize,
     const DJLSCodecParameter *djcp,
     Uint32 frame,
@@ -62,6 +62,8 @@ public:
    *  @param planarConfiguration       flag describing how planar configuration of decompressed color images should be handled
    *  @param ignoreOffsetTable         flag indicating whether to ignore the offset table when decompressing multiframe images
    *  @param jplsInterleaveMode        flag describing which interleave the JPEG-LS datastream should use
+   *  @param numberOfThreads           maximum number of threads used for processing the frames of a multi-frame image
+   *                                   in parallel, 0 or 1 for sequential processing
    */
    DJLSCodecParameter(
      OFBool jpls_optionsEnabled,
@@ -77,17 +79,21 @@ public:
      OFBool convertToSC = OFFalse,
      JLS_PlanarConfiguration planarConfiguration = EJLSPC_restore,
      OFBool ignoreOffsetTable = OFFalse,
-     interleaveMode jplsInterleaveMode = interleaveLine);
+     interleaveMode jplsInterleaveMode = interleaveLine,
+     Uint32 numberOfThreads = 1);
 
   /** constructor, for use with decoders. Initializes all encoder options to defaults.
    *  @param uidCreation               mode for SOP Instance UID creation (used both for encoding and decoding)
    *  @param planarConfiguration       flag describing how planar configuration of decompressed color images should be handled
    *  @param ignoreOffsetTable         flag indicating whether to ignore the offset table when decompressing multiframe images
+   *  @param numberOfThreads           maximum number of threads used for decompressing the frames of a multi-frame image
+   *                                   in parallel, 0 or 1 for sequential decompression
    */
   DJLSCodecParameter(
     JLS_UIDCreation uidCreation = EJLSUC_default,
     JLS_PlanarConfiguration planarConfiguration = EJLSPC_restore,
-    OFBool ignoreOffsetTable = OFFalse);
+    OFBool ignoreOffsetTable = OFFalse,
+    Uint32 numberOfThreads = 1);
 
   /// copy constructor
   DJLSCodecParameter(const DJLSCodecParameter& arg);
@@ -219,6 +225,14 @@ public:
     return jplsInterleaveMode_;
   }
 
+  /** returns the maximum number of threads for multi-frame processing
+   *  @return maximum number of threads, 0 or 1 for sequential processing
+   */
+  Uint32 getNumberOfThreads() const
+  {
+    return numberOfThreads_;
+  }
+
 private:
 
   /// private undefined copy assignment operator
@@ -272,6 +286,12 @@ private:
   /// flag indicating if temporary files should be kept, false if they should be deleted after use
   OFBool ignoreOffsetTable_;
 
+  // *******************************************************************
+  // **** Parameters describing both encoding and decoding process ****
+
+  /// maximum number of threads for multi-frame processing, 0 or 1 for sequential processing
+  Uint32 numberOfThreads_;
+
 };
 
 
@@ -33,12 +33,144 @@
 #include "dcmtk/dcmdata/dcvrpobw.h"  /* for class DcmPolymorphOBOW */
 #include "dcmtk/dcmdata/dcswap.h"    /* for swapIfNecessary() */
 #include "dcmtk/dcmdata/dcuid.h"     /* for dcmGenerateUniqueIdentifer()*/
+#include "dcmtk/dcmdata/dcparfrm.h"  /* for class DcmParallelFrameProcessor */
 #include "dcmtk/dcmjpls/djcparam.h"  /* for class DJLSCodecParameter */
 #include "djerror.h"                 /* for private class DJLSError */
 
 // JPEG-LS library (CharLS) includes
 #include "intrface.h"
 
+
+/** helper class decompressing the frames of a multi-frame JPEG-LS image in parallel.
+ *  The compressed data of all frames is accessed in the calling thread first.
+ */
+class DJLSFrameDecoder : public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor
+   *  @param numberOfFrames number of frames to be decompressed
+   *  @param imageData pointer to the buffer for the uncompressed frames
+   *  @param frameSize size of an uncompressed frame in bytes
+   *  @param imageColumns number of columns for each frame
+   *  @param imageRows number of rows for each frame
+   *  @param imageSamplesPerPixel number of samples per pixel
+   *  @param bytesPerSample number of bytes per sample
+   *  @param imagePlanarConfiguration planar configuration of the decompressed image
+   */
+  DJLSFrameDecoder(Uint32 numberOfFrames, Uint8 *imageData, Uint32 frameSize,
+    Uint16 imageColumns, Uint16 imageRows, Uint16 imageSamplesPerPixel,
+    Uint16 bytesPerSample, Uint16 imagePlanarConfiguration)
+  : DcmParallelFrameProcessor(numberOfFrames)
+  , frameData_(new Uint8 *[numberOfFrames])
+  , frameDataSize_(new size_t[numberOfFrames])
+  , deleteFrameData_(new OFBool[numberOfFrames])
+  , imageData_(imageData)
+  , frameSize_(frameSize)
+  , imageColumns_(imageColumns)
+  , imageRows_(imageRows)
+  , imageSamplesPerPixel_(imageSamplesPerPixel)
+  , bytesPerSample_(bytesPerSample)
+  , imagePlanarConfiguration_(imagePlanarConfiguration)
+  {
+    for (Uint32 i = 0; i < numberOfFrames; ++i)
+    {
+      frameData_[i] = NULL;
+      deleteFrameData_[i] = OFFalse;
+    }
+  }
+
+  /// destructor
+  virtual ~DJLSFrameDecoder()
+  {
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    for (Uint32 i = 0; i < numberOfFrames; ++i)
+    {
+      if (deleteFrameData_[i]) delete[] frameData_[i];
+    }
+    delete[] frameData_;
+    delete[] frameDataSize_;
+    delete[] deleteFrameData_;
+  }
+
+  /** accesses the compressed data of all frames and decompresses them.
+   *  @param pixSeq compressed pixel sequence
+   *  @param cp codec parameters for this codec
+   *  @param imageFrames number of frames in this image
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition decode(DcmPixelSequence *pixSeq, const DJLSCodecParameter *cp, Sint32 imageFrames)
+  {
+    OFCondition result = EC_Normal;
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    Uint32 currentItem = 1; // item 0 contains the offset table
+    // access all fragments in this thread since this might load data from file
+    for (Uint32 frame = 0; (frame < numberOfFrames) && result.good(); ++frame)
+    {
+      result = DJLSDecoderBase::readFrameData(pixSeq, cp, frame, currentItem, imageFrames,
+        frameData_[frame], frameDataSize_[frame], deleteFrameData_[frame]);
+    }
+    if (result.good())
+    {
+      DCMJPLS_DEBUG("JPEG-LS decoder processes " << numberOfFrames << " frames using up to "
+        << getNumberOfThreadsUsed(cp->getNumberOfThreads()) << " thread(s)");
+      result = processAllFrames(cp->getNumberOfThreads());
+    }
+    return result;
+  }
+
+  /** decompresses a single frame.
+   *  @param frameNo number of the frame to be decompressed
+   *  @param threadNo index of the calling thread, not used
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, Uint32 /* threadNo */)
+  {
+    return DJLSDecoderBase::decodeFrameData(frameData_[frameNo], frameDataSize_[frameNo],
+      imageData_ + frameNo * frameSize_, frameSize_, imageColumns_, imageRows_,
+      imageSamplesPerPixel_, bytesPerSample_, imagePlanarConfiguration_);
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DJLSFrameDecoder(const DJLSFrameDecoder&);
+
+  /// private undefined copy assignment operator
+  DJLSFrameDecoder& operator=(const DJLSFrameDecoder&);
+
+  /// compressed data of each frame
+  Uint8 **frameData_;
+
+  /// size of the compressed data of each frame
+  size_t *frameDataSize_;
+
+  /// flags indicating whether the compressed data of a frame has to be deleted
+  OFBool *deleteFrameData_;
+
+  /// buffer for the uncompressed frames
+  Uint8 *imageData_;
+
+  /// size of an uncompressed frame in bytes
+  Uint32 frameSize_;
+
+  /// number of columns for each frame
+  Uint16 imageColumns_;
+
+  /// number of rows for each frame
+  Uint16 imageRows_;
+
+  /// number of samples per pixel
+  Uint16 imageSamplesPerPixel_;
+
+  /// number of bytes per sample
+  Uint16 bytesPerSample_;
+
+  /// planar configuration of the decompressed image
+  Uint16 imagePlanarConfiguration_;
+};
+
+
 E_TransferSyntax DJLSLosslessDecoder::supportedTransferSyntax() const
 {
   return EXS_JPEGLSLossless;
@@ -158,6 +290,16 @@ OFCondition DJLSDecoderBase::decode(
   Uint32 currentItem = 1; // item 0 contains the offset table
   OFBool done = OFFalse;
 
+  // decompress the frames in parallel if requested
+  if ((djcp->getNumberOfThreads() > 1) && (imageFrames > 1))
+  {
+    DJLSFrameDecoder frameDecoder(OFstatic_cast(Uint32, imageFrames), pixeldata8, frameSize,
+      imageColumns, imageRows, imageSamplesPerPixel, bytesPerSample,
+      determineDecompressedPlanarConfiguration(djcp, dataset, imageSamplesPerPixel));
+    result = frameDecoder.decode(pixSeq, djcp, imageFrames);
+    done = OFTrue;
+  }
+
   while (result.good() && !done)
   {
       DCMJPLS_DEBUG("JPEG-LS decoder processes frame " << (currentFrame+1));
@@ -289,28 +431,41 @@ OFCondition DJLSDecoderBase::decodeFrame(
     Uint16 imageSamplesPerPixel,
     Uint16 bytesPerSample)
 {
-  DcmPixelItem *pixItem = NULL;
-  Uint8 * jlsData = NULL;
-  Uint8 * jlsFragmentData = NULL;
-  Uint32 fragmentLength = 0;
+  Uint8 *jlsData = NULL;
   size_t compressedSize = 0;
-  Uint32 fragmentsForThisFrame = 0;
-  OFCondition result = EC_Normal;
-  OFBool ignoreOffsetTable = cp->ignoreOffsetTable();
-
-  // compute the number of JPEG-LS fragments we need in order to decode the next frame
-  fragmentsForThisFrame = computeNumberOfFragments(imageFrames, frameNo, currentItem, ignoreOffsetTable, fromPixSeq);
-  if (fragmentsForThisFrame == 0) result = EC_JLSCannotComputeNumberOfFragments;
+  OFBool deleteData = OFFalse;
 
   // determine planar configuration for uncompressed data
-  OFString imageSopClass;
-  OFString imagePhotometricInterpretation;
-  dataset->findAndGetOFString(DCM_SOPClassUID, imageSopClass);
-  dataset->findAndGetOFString(DCM_PhotometricInterpretation, imagePhotometricInterpretation);
+  Uint16 imagePlanarConfiguration = determineDecompressedPlanarConfiguration(cp, dataset, imageSamplesPerPixel);
+
+  // get the compressed data
+  OFCondition result = readFrameData(fromPixSeq, cp, frameNo, currentItem, imageFrames, jlsData, compressedSize, deleteData);
+
+  if (result.good())
+  {
+    result = decodeFrameData(jlsData, compressedSize, buffer, bufSize, imageColumns, imageRows,
+      imageSamplesPerPixel, bytesPerSample, imagePlanarConfiguration);
+  }
+  if (deleteData) delete[] jlsData;
+
+  return result;
+}
+
+
+Uint16 DJLSDecoderBase::determineDecompressedPlanarConfiguration(
+    const DJLSCodecParameter *cp,
+    DcmItem *dataset,
+    Uint16 imageSamplesPerPixel)
+{
   Uint16 imagePlanarConfiguration = 0; // 0 is color-by-pixel, 1 is color-by-plane
 
   if (imageSamplesPerPixel > 1)
   {
+    OFString imageSopClass;
+    OFString imagePhotometricInterpretation;
+    dataset->findAndGetOFString(DCM_SOPClassUID, imageSopClass);
+    dataset->findAndGetOFString(DCM_PhotometricInterpretation, imagePhotometricInterpretation);
+
     switch (cp->getPlanarConfiguration())
     {
       case EJLSPC_restore:
@@ -332,6 +487,47 @@ OFCondition DJLSDecoderBase::decodeFrame(
         break;
     }
   }
+  return imagePlanarConfiguration;
+}
+
+
+OFCondition DJLSDecoderBase::readFrameData(
+    DcmPixelSequence * fromPixSeq,
+    const DJLSCodecParameter *cp,
+    Uint32 frameNo,
+    Uint32& currentItem,
+    Sint32 imageFrames,
+    Uint8 *& jlsData,
+    size_t& compressedSize,
+    OFBool& deleteData)
+{
+  DcmPixelItem *pixItem = NULL;
+  Uint8 * jlsFragmentData = NULL;
+  Uint32 fragmentLength = 0;
+  Uint32 fragmentsForThisFrame = 0;
+  OFCondition result = EC_Normal;
+  OFBool ignoreOffsetTable = cp->ignoreOffsetTable();
+
+  jlsData = NULL;
+  compressedSize = 0;
+  deleteData = OFFalse;
+
+  // compute the number of JPEG-LS fragments we need in order to decode the next frame
+  fragmentsForThisFrame = computeNumberOfFragments(imageFrames, frameNo, currentItem, ignoreOffsetTable, fromPixSeq);
+  if (fragmentsForThisFrame == 0) result = EC_JLSCannotComputeNumberOfFragments;
+
+  // a frame contained in a single fragment can be decoded directly from the pixel item
+  if (result.good() && (fragmentsForThisFrame == 1))
+  {
+    result = fromPixSeq->getItem(pixItem, currentItem++);
+    if (result.good() && pixItem)
+    {
+      compressedSize = pixItem->getLength();
+      result = pixItem->getUint8Array(jlsData);
+      if (result.good() && (jlsData == NULL)) result = EC_JLSInvalidCompressedData;
+    }
+    return result;
+  }
 
   // get the size of all the fragments
   if (result.good())
@@ -357,6 +553,7 @@ OFCondition DJLSDecoderBase::decodeFrame(
   {
     Uint32 offset = 0;
     jlsData = new Uint8[compressedSize];
+    deleteData = OFTrue;
 
     while (result.good() && fragmentsForThisFrame--)
     {
@@ -374,66 +571,73 @@ OFCondition DJLSDecoderBase::decodeFrame(
     } /* while */
   }
 
+  return result;
+}
+
+
+OFCondition DJLSDecoderBase::decodeFrameData(
+    Uint8 *jlsData,
+    size_t compressedSize,
+    void *buffer,
+    Uint32 bufSize,
+    Uint16 imageColumns,
+    Uint16 imageRows,
+    Uint16 imageSamplesPerPixel,
+    Uint16 bytesPerSample,
+    Uint16 imagePlanarConfiguration)
+{
+  JlsParameters params;
+  JLS_ERROR err;
+
+  err = JpegLsReadHeader(jlsData, compressedSize, &params);
+  OFCondition result = DJLSError::convert(err);
+
   if (result.good())
   {
-    JlsParameters params;
-    JLS_ERROR err;
+    if (params.width != imageColumns) result = EC_JLSImageDataMismatch;
+    else if (params.height != imageRows) result = EC_JLSImageDataMismatch;
+    else if (params.components != imageSamplesPerPixel) result = EC_JLSImageDataMismatch;
+    else if ((bytesPerSample == 1) && (params.bitspersample > 8)) result = EC_JLSImageDataMismatch;
+    else if ((bytesPerSample == 2) && (params.bitspersample <= 8)) result = EC_JLSImageDataMismatch;
+  }
 
-    err = JpegLsReadHeader(jlsData, compressedSize, &params);
+  if (result.good())
+  {
+    err = JpegLsDecode(buffer, bufSize, jlsData, compressedSize, &params);
     result = DJLSError::convert(err);
 
-    if (result.good())
+    if (result.good() && imageSamplesPerPixel == 3)
     {
-      if (params.width != imageColumns) result = EC_JLSImageDataMismatch;
-      else if (params.height != imageRows) result = EC_JLSImageDataMismatch;
-      else if (params.components != imageSamplesPerPixel) result = EC_JLSImageDataMismatch;
-      else if ((bytesPerSample == 1) && (params.bitspersample > 8)) result = EC_JLSImageDataMismatch;
-      else if ((bytesPerSample == 2) && (params.bitspersample <= 8)) result = EC_JLSImageDataMismatch;
+      if (imagePlanarConfiguration == 1 && params.ilv != ILV_NONE)
+      {
+        // The dataset says this should be planarConfiguration == 1, but
+        // it isn't -> convert it.
+        DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"1\"");
+        if (bytesPerSample == 1)
+          result = createPlanarConfiguration1Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
+        else
+          result = createPlanarConfiguration1Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
+      }
+      else if (imagePlanarConfiguration == 0 && params.ilv != ILV_SAMPLE && params.ilv != ILV_LINE)
+      {
+        // The dataset says this should be planarConfiguration == 0, but
+        // it isn't -> convert it.
+        DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"0\"");
+        if (bytesPerSample == 1)
+          result = createPlanarConfiguration0Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
+        else
+          result = createPlanarConfiguration0Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
+      }
     }
 
-    if (!result.good())
-    {
-      delete[] jlsData;
-    }
-    else
+    if (result.good())
     {
-      err = JpegLsDecode(buffer, bufSize, jlsData, compressedSize, &params);
-      result = DJLSError::convert(err);
-      delete[] jlsData;
-
-      if (result.good() && imageSamplesPerPixel == 3)
-      {
-        if (imagePlanarConfiguration == 1 && params.ilv != ILV_NONE)
-        {
-          // The dataset says this should be planarConfiguration == 1, but
-          // it isn't -> convert it.
-          DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"1\"");
-          if (bytesPerSample == 1)
-            result = createPlanarConfiguration1Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
-          else
-            result = createPlanarConfiguration1Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
-        }
-        else if (imagePlanarConfiguration == 0 && params.ilv != ILV_SAMPLE && params.ilv != ILV_LINE)
+        // decompression is complete, finally adjust byte order if necessary
+        if (bytesPerSample == 1) // we're writing bytes into words
         {
-          // The dataset says this should be planarConfiguration == 0, but
-          // it isn't -> convert it.
-          DCMJPLS_WARN("different planar configuration in JPEG stream, converting to \"0\"");
-          if (bytesPerSample == 1)
-            result = createPlanarConfiguration0Byte(OFreinterpret_cast(Uint8*, buffer), imageColumns, imageRows);
-          else
-            result = createPlanarConfiguration0Word(OFreinterpret_cast(Uint16*, buffer), imageColumns, imageRows);
+            result = swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, buffer,
+                    bufSize, sizeof(Uint16));
         }
-      }
-
-      if (result.good())
-      {
-          // decompression is complete, finally adjust byte order if necessary
-          if (bytesPerSample == 1) // we're writing bytes into words
-          {
-              result = swapIfNecessary(gLocalByteOrder, EBO_LittleEndian, buffer,
-                      bufSize, sizeof(Uint16));
-          }
-      }
     }
   }
 
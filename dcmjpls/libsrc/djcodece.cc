@@ -45,6 +45,7 @@
 #include "dcmtk/dcmdata/dcvrst.h"    /* for class DcmShortText */
 #include "dcmtk/dcmdata/dcvrus.h"    /* for class DcmUnsignedShort */
 #include "dcmtk/dcmdata/dcswap.h"    /* for swapIfNecessary */
+#include "dcmtk/dcmdata/dcparfrm.h"  /* for class DcmParallelFrameProcessor */
 
 // dcmjpls includes
 #include "dcmtk/dcmjpls/djcparam.h"  /* for class DJLSCodecParameter */
@@ -70,6 +71,208 @@ BEGIN_EXTERN_C
 END_EXTERN_C
 
 
+/** helper class compressing the frames of a multi-frame image in parallel,
+ *  either from raw pixel data or from the intermediate pixel data of a
+ *  DicomImage instance. The compressed frames are appended to the pixel
+ *  sequence in frame order after all frames have been compressed.
+ */
+class DJLSFrameEncoder : public DcmParallelFrameProcessor
+{
+public:
+
+  /** constructor for raw compression
+   *  @param encoder encoder performing the compression of each frame
+   *  @param djcp parameters for the codec
+   *  @param numberOfFrames number of frames to be compressed
+   *  @param pixelData pointer to the raw pixel data of the first frame
+   *  @param frameSize size of a raw frame in bytes
+   *  @param bitsAllocated number of bits allocated per pixel
+   *  @param columns frame width
+   *  @param rows frame height
+   *  @param samplesPerPixel image samples per pixel
+   *  @param planarConfiguration image planar configuration
+   *  @param photometricInterpretation photometric interpretation of the DICOM dataset
+   */
+  DJLSFrameEncoder(const DJLSEncoderBase& encoder, const DJLSCodecParameter *djcp,
+    Uint32 numberOfFrames, const Uint8 *pixelData, unsigned long frameSize,
+    Uint16 bitsAllocated, Uint16 columns, Uint16 rows, Uint16 samplesPerPixel,
+    Uint16 planarConfiguration, const OFString& photometricInterpretation)
+  : DcmParallelFrameProcessor(numberOfFrames)
+  , encoder_(encoder)
+  , djcp_(djcp)
+  , compressedData_(new Uint8 *[numberOfFrames])
+  , compressedSize_(new unsigned long[numberOfFrames])
+  , pixelData_(pixelData)
+  , frameSize_(frameSize)
+  , bitsAllocated_(bitsAllocated)
+  , columns_(columns)
+  , rows_(rows)
+  , samplesPerPixel_(samplesPerPixel)
+  , planarConfiguration_(planarConfiguration)
+  , dimage_(NULL)
+  , nearLosslessDeviation_(0)
+  , photometricInterpretation_(photometricInterpretation)
+  {
+    init();
+  }
+
+  /** constructor for cooked compression
+   *  @param encoder encoder performing the compression of each frame
+   *  @param djcp parameters for the codec
+   *  @param numberOfFrames number of frames to be compressed
+   *  @param dimage DicomImage instance containing all frames
+   *  @param photometricInterpretation photometric interpretation of the DICOM dataset
+   *  @param nearLosslessDeviation maximum deviation for near-lossless encoding
+   */
+  DJLSFrameEncoder(const DJLSEncoderBase& encoder, const DJLSCodecParameter *djcp,
+    Uint32 numberOfFrames, DicomImage *dimage, const OFString& photometricInterpretation,
+    Uint16 nearLosslessDeviation)
+  : DcmParallelFrameProcessor(numberOfFrames)
+  , encoder_(encoder)
+  , djcp_(djcp)
+  , compressedData_(new Uint8 *[numberOfFrames])
+  , compressedSize_(new unsigned long[numberOfFrames])
+  , pixelData_(NULL)
+  , frameSize_(0)
+  , bitsAllocated_(0)
+  , columns_(0)
+  , rows_(0)
+  , samplesPerPixel_(0)
+  , planarConfiguration_(0)
+  , dimage_(dimage)
+  , nearLosslessDeviation_(nearLosslessDeviation)
+  , photometricInterpretation_(photometricInterpretation)
+  {
+    init();
+  }
+
+  /// destructor, deletes all compressed frames not yet stored
+  virtual ~DJLSFrameEncoder()
+  {
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    for (Uint32 i = 0; i < numberOfFrames; ++i)
+      delete[] compressedData_[i];
+    delete[] compressedData_;
+    delete[] compressedSize_;
+  }
+
+  /** compresses all frames and appends them to the given pixel sequence in frame order
+   *  @param pixelSequence object in which the compressed frames are stored
+   *  @param offsetList list of frame offsets updated in this parameter
+   *  @param compressedSize size of all compressed frames is added to this parameter
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition encode(DcmPixelSequence *pixelSequence, DcmOffsetList &offsetList, unsigned long &compressedSize)
+  {
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    DCMJPLS_DEBUG("JPEG-LS encoder processes " << numberOfFrames << " frames using up to "
+      << getNumberOfThreadsUsed(djcp_->getNumberOfThreads()) << " thread(s)");
+    OFCondition result = processAllFrames(djcp_->getNumberOfThreads());
+    for (Uint32 i = 0; (i < numberOfFrames) && result.good(); ++i)
+    {
+      result = pixelSequence->storeCompressedFrame(offsetList, compressedData_[i], compressedSize_[i], djcp_->getFragmentSize());
+      compressedSize += compressedSize_[i];
+      delete[] compressedData_[i];
+      compressedData_[i] = NULL;
+    }
+    return result;
+  }
+
+  /** compresses a single frame.
+   *  @param frameNo number of the frame to be compressed
+   *  @param threadNo index of the calling thread (unused)
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  virtual OFCondition processFrame(Uint32 frameNo, Uint32 /* threadNo */)
+  {
+    OFCondition result;
+    Uint8 *buffer = NULL;
+    unsigned long size = 0;
+    if (dimage_)
+    {
+      result = encoder_.compressCookedFrame(dimage_, photometricInterpretation_, buffer, size,
+        djcp_, frameNo, nearLosslessDeviation_);
+    }
+    else
+    {
+      result = encoder_.compressRawFrame(pixelData_ + frameNo * frameSize_, bitsAllocated_, columns_, rows_,
+        samplesPerPixel_, planarConfiguration_, photometricInterpretation_, buffer, size, djcp_);
+    }
+    if (result.good())
+    {
+      // the compression buffer is much larger than the compressed frame,
+      // keep only the compressed data until the frame is stored
+      compressedData_[frameNo] = new Uint8[size];
+      memcpy(compressedData_[frameNo], buffer, size);
+      compressedSize_[frameNo] = size;
+      delete[] buffer;
+    }
+    return result;
+  }
+
+private:
+
+  /// initializes the arrays of compressed frames
+  void init()
+  {
+    const Uint32 numberOfFrames = getNumberOfFrames();
+    for (Uint32 i = 0; i < numberOfFrames; ++i)
+    {
+      compressedData_[i] = NULL;
+      compressedSize_[i] = 0;
+    }
+  }
+
+  /// private undefined copy constructor
+  DJLSFrameEncoder(const DJLSFrameEncoder&);
+
+  /// private undefined copy assignment operator
+  DJLSFrameEncoder& operator=(const DJLSFrameEncoder&);
+
+  /// encoder performing the compression of each frame
+  const DJLSEncoderBase& encoder_;
+
+  /// parameters for the codec
+  const DJLSCodecParameter *djcp_;
+
+  /// compressed frames
+  Uint8 **compressedData_;
+
+  /// size of each compressed frame
+  unsigned long *compressedSize_;
+
+  /// raw pixel data of the first frame, NULL for cooked compression
+  const Uint8 *pixelData_;
+
+  /// size of a raw frame in bytes
+  unsigned long frameSize_;
+
+  /// number of bits allocated per pixel (raw compression only)
+  Uint16 bitsAllocated_;
+
+  /// frame width (raw compression only)
+  Uint16 columns_;
+
+  /// frame height (raw compression only)
+  Uint16 rows_;
+
+  /// image samples per pixel (raw compression only)
+  Uint16 samplesPerPixel_;
+
+  /// image planar configuration (raw compression only)
+  Uint16 planarConfiguration_;
+
+  /// DicomImage instance containing all frames, NULL for raw compression
+  DicomImage *dimage_;
+
+  /// maximum deviation for near-lossless encoding (cooked compression only)
+  Uint16 nearLosslessDeviation_;
+
+  /// photometric interpretation of the DICOM dataset
+  OFString photometricInterpretation_;
+};
+
+
 E_TransferSyntax DJLSLosslessEncoder::supportedTransferSyntax() const
 {
   return EXS_JPEGLSLossless;
@@ -507,16 +710,34 @@ OFCondition DJLSEncoderBase::losslessRawEncode(
     // compute original image size in bytes, ignoring any padding bits.
     uncompressedSize = columns * rows * samplesPerPixel * bitsStored * frameCount / 8.0;
 
-    for (unsigned long i=0; (i<frameCount) && (result.good()); ++i)
+    if ((djcp->getNumberOfThreads() > 1) && (frameCount > 1))
     {
-      // compress frame
-      DCMJPLS_DEBUG("JPEG-LS encoder processes frame " << (i+1) << " of " << frameCount);
-      result = compressRawFrame(framePointer, bitsAllocated, columns, rows,
-          samplesPerPixel, planarConfiguration, photometricInterpretation,
-          pixelSequence, offsetList, compressedFrameSize, djcp);
-
-      compressedSize += compressedFrameSize;
-      framePointer += frameSize;
+      // compress all frames in parallel
+      DJLSFrameEncoder frameEncoder(*this, djcp, frameCount, framePointer, frameSize, bitsAllocated,
+          columns, rows, samplesPerPixel, planarConfiguration, photometricInterpretation);
+      result = frameEncoder.encode(pixelSequence, offsetList, compressedSize);
+    }
+    else
+    {
+      for (unsigned long i=0; (i<frameCount) && (result.good()); ++i)
+      {
+        // compress frame
+        DCMJPLS_DEBUG("JPEG-LS encoder processes frame " << (i+1) << " of " << frameCount);
+        Uint8 *compressedData = NULL;
+        result = compressRawFrame(framePointer, bitsAllocated, columns, rows,
+            samplesPerPixel, planarConfiguration, photometricInterpretation,
+            compressedData, compressedFrameSize, djcp);
+
+        // store frame
+        if (result.good())
+        {
+          result = pixelSequence->storeCompressedFrame(offsetList, compressedData, compressedFrameSize, djcp->getFragmentSize());
+          delete[] compressedData;
+        }
+
+        compressedSize += compressedFrameSize;
+        framePointer += frameSize;
+      }
     }
   }
 
@@ -553,15 +774,13 @@ OFCondition DJLSEncoderBase::compressRawFrame(
   Uint16 samplesPerPixel,
   Uint16 planarConfiguration,
   const OFString& /* photometricInterpretation */,
-  DcmPixelSequence *pixelSequence,
-  DcmOffsetList &offsetList,
+  Uint8 *&compressedData,
   unsigned long &compressedSize,
   const DJLSCodecParameter *djcp) const
 {
   OFCondition result = EC_Normal;
   Uint16 bytesAllocated = bitsAllocated / 8;
   Uint32 frameSize = width*height*bytesAllocated*samplesPerPixel;
-  Uint32 fragmentSize = djcp->getFragmentSize();
   OFBool opt_use_custom_options = djcp->getUseCustomOptions();
   JlsParameters jls_params;
   Uint8 *frameBuffer = NULL;
@@ -673,11 +892,10 @@ OFCondition DJLSEncoderBase::compressRawFrame(
     if (result.good())
     {
       // 'size' now contains the size of the compressed data in buffer
+      compressedData = buffer;
       compressedSize = size;
-      result = pixelSequence->storeCompressedFrame(offsetList, buffer, size, fragmentSize);
     }
-
-    delete[] buffer;
+    else delete[] buffer;
   }
 
   if (frameBuffer)
@@ -793,14 +1011,31 @@ OFCondition DJLSEncoderBase::losslessCookedEncode(
     uncompressedSize = dimage->getWidth() * dimage->getHeight() *
       bitsPerSample * frameCount * samplesPerPixel / 8.0;
 
-    for (unsigned long i=0; (i<frameCount) && (result.good()); ++i)
+    if ((djcp->getNumberOfThreads() > 1) && (frameCount > 1))
+    {
+      // compress all frames in parallel
+      DJLSFrameEncoder frameEncoder(*this, djcp, frameCount, dimage, photometricInterpretation, nearLosslessDeviation);
+      result = frameEncoder.encode(pixelSequence, offsetList, compressedSize);
+    }
+    else
     {
-      // compress frame
-      DCMJPLS_DEBUG("JPEG-LS encoder processes frame " << (i+1) << " of " << frameCount);
-      result = compressCookedFrame(pixelSequence, dimage,
-          photometricInterpretation, offsetList, compressedFrameSize, djcp, i, nearLosslessDeviation);
+      for (unsigned long i=0; (i<frameCount) && (result.good()); ++i)
+      {
+        // compress frame
+        DCMJPLS_DEBUG("JPEG-LS encoder processes frame " << (i+1) << " of " << frameCount);
+        Uint8 *compressedData = NULL;
+        result = compressCookedFrame(dimage, photometricInterpretation,
+            compressedData, compressedFrameSize, djcp, i, nearLosslessDeviation);
+
+        // store frame
+        if (result.good())
+        {
+          result = pixelSequence->storeCompressedFrame(offsetList, compressedData, compressedFrameSize, djcp->getFragmentSize());
+          delete[] compressedData;
+        }
 
-      compressedSize += compressedFrameSize;
+        compressedSize += compressedFrameSize;
+      }
     }
   }
 
@@ -837,10 +1072,9 @@ OFCondition DJLSEncoderBase::losslessCookedEncode(
 
 
 OFCondition DJLSEncoderBase::compressCookedFrame(
-  DcmPixelSequence *pixelSequence,
   DicomImage *dimage,
   const OFString& /* photometricInterpretation */,
-  DcmOffsetList &offsetList,
+  Uint8 *&compressedData,
   unsigned long &compressedSize,
   const DJLSCodecParameter *djcp,
   Uint32 frame,
@@ -854,7 +1088,6 @@ OFCondition DJLSEncoderBase::compressCookedFrame(
   int depth = dimage->getDepth();
   if ((depth < 1) || (depth > 16)) return EC_JLSUnsupportedBitDepth;
 
-  Uint32 fragmentSize = djcp->getFragmentSize();
   OFBool opt_use_custom_options = djcp->getUseCustomOptions();
 
   const DiPixel *dinter = dimage->getInterData();
@@ -1070,12 +1303,12 @@ OFCondition DJLSEncoderBase::compressCookedFrame(
   if (result.good())
   {
     // 'compressed_buffer_size' now contains the size of the compressed data in buffer
+    compressedData = compressed_buffer;
     compressedSize = compressed_buffer_size;
-    result = pixelSequence->storeCompressedFrame(offsetList, compressed_buffer, compressed_buffer_size, fragmentSize);
   }
+  else delete[] compressed_buffer;
 
   delete[] buffer;
-  delete[] compressed_buffer;
   if (frameBuffer)
     delete[] frameBuffer;
 
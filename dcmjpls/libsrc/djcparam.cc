@@ -37,7 +37,8 @@ DJLSCodecParameter::DJLSCodecParameter(
      OFBool convertToSC,
      JLS_PlanarConfiguration planarConfiguration,
      OFBool ignoreOffsetTble,
-     interleaveMode jplsInterleaveMode)
+     interleaveMode jplsInterleaveMode,
+     Uint32 numberOfThreads)
 : DcmCodecParameter()
 , jpls_optionsEnabled_(jpls_optionsEnabled)
 , jpls_t1_(jpls_t1)
@@ -53,6 +54,7 @@ DJLSCodecParameter::DJLSCodecParameter(
 , jplsInterleaveMode_(jplsInterleaveMode)
 , planarConfiguration_(planarConfiguration)
 , ignoreOffsetTable_(ignoreOffsetTble)
+, numberOfThreads_(numberOfThreads)
 {
 }
 
@@ -60,7 +62,8 @@ DJLSCodecParameter::DJLSCodecParameter(
 DJLSCodecParameter::DJLSCodecParameter(
     JLS_UIDCreation uidCreation,
     JLS_PlanarConfiguration planarConfiguration,
-    OFBool ignoreOffsetTble)
+    OFBool ignoreOffsetTble,
+    Uint32 numberOfThreads)
 : DcmCodecParameter()
 , jpls_optionsEnabled_(OFFalse)
 , jpls_t1_(3)
@@ -76,6 +79,7 @@ DJLSCodecParameter::DJLSCodecParameter(
 , jplsInterleaveMode_(interleaveDefault)
 , planarConfiguration_(planarConfiguration)
 , ignoreOffsetTable_(ignoreOffsetTble)
+, numberOfThreads_(numberOfThreads)
 {
 }
 
@@ -96,6 +100,7 @@ DJLSCodecParameter::DJLSCodecParameter(const DJLSCodecParameter& arg)
 , jplsInterleaveMode_(arg.jplsInterleaveMode_)
 , planarConfiguration_(arg.planarConfiguration_)
 , ignoreOffsetTable_(arg.ignoreOffsetTable_)
+, numberOfThreads_(arg.numberOfThreads_)
 {
 }
 
@@ -34,11 +34,12 @@ DJLSNearLosslessDecoder *DJLSDecoderRegistration::nearlosslessdecoder_ = NULL;
 void DJLSDecoderRegistration::registerCodecs(
     JLS_UIDCreation uidcreation,
     JLS_PlanarConfiguration planarconfig,
-    OFBool ignoreOffsetTable)
+    OFBool ignoreOffsetTable,
+    Uint32 numberOfThreads)
 {
   if (! registered_)
   {
-    cp_ = new DJLSCodecParameter(uidcreation, planarconfig, ignoreOffsetTable);
+    cp_ = new DJLSCodecParameter(uidcreation, planarconfig, ignoreOffsetTable, numberOfThreads);
     if (cp_)
     {
       losslessdecoder_ = new DJLSLosslessDecoder();
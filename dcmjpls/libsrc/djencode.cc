@@ -44,13 +44,14 @@ void DJLSEncoderRegistration::registerCodecs(
     OFBool createOffsetTable,
     JLS_UIDCreation uidCreation,
     OFBool convertToSC,
-    DJLSCodecParameter::interleaveMode jplsInterleaveMode)
+    DJLSCodecParameter::interleaveMode jplsInterleaveMode,
+    Uint32 numberOfThreads)
 {
   if (! registered_)
   {
     cp_ = new DJLSCodecParameter(jpls_optionsEnabled, jpls_t1, jpls_t2, jpls_t3, jpls_reset,
       jpls_limit, preferCookedEncoding, fragmentSize, createOffsetTable, uidCreation, 
-      convertToSC, EJLSPC_restore, OFFalse, jplsInterleaveMode);
+      convertToSC, EJLSPC_restore, OFFalse, jplsInterleaveMode, numberOfThreads);
 
     if (cp_)
     {
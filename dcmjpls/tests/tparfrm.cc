@@ -0,0 +1,187 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmjpls
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the parallel compression of multi-frame images
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmdata/dcpixel.h"
+#include "dcmtk/dcmdata/dcpixseq.h"
+#include "dcmtk/dcmdata/dcpxitem.h"
+#include "dcmtk/dcmjpls/djencode.h"
+#include "dcmtk/dcmjpls/djrparam.h"
+#include "dcmtk/dcmimage/diregist.h"   /* include to support color images */
+
+#define INCLUDE_CSTRING
+#include "dcmtk/ofstd/ofstdinc.h"
+
+
+// size of the test images
+#define IMAGE_ROWS 96
+#define IMAGE_COLUMNS 128
+// number of frames, not a multiple of the number of threads
+#define NUMBER_OF_FRAMES 7
+// number of threads used for parallel compression
+#define NUMBER_OF_THREADS 4
+
+
+/* create a multi-frame image. Each frame contains a gradient that depends on the
+ * frame number and some noise, so that it is compressed into several fragments
+ * and no two frames are compressed to the same data.
+ */
+static void createImage(DcmDataset &dataset,
+                        const int samplesPerPixel)
+{
+    const unsigned long frameSize = IMAGE_ROWS * IMAGE_COLUMNS * samplesPerPixel;
+    OFVector<Uint8> pixels(frameSize * NUMBER_OF_FRAMES);
+    Uint32 seed = 4711;
+    unsigned long i = 0;
+    for (unsigned long frame = 0; frame < NUMBER_OF_FRAMES; ++frame)
+    {
+        for (unsigned long y = 0; y < IMAGE_ROWS; ++y)
+        {
+            for (unsigned long x = 0; x < IMAGE_COLUMNS; ++x)
+            {
+                for (int s = 0; s < samplesPerPixel; ++s)
+                {
+                    seed = seed * 1103515245 + 12345;
+                    pixels[i++] = OFstatic_cast(Uint8, x + y * frame + s * 50 + ((seed >> 16) & 0x0f));
+                }
+            }
+        }
+    }
+    dataset.clear();
+    dataset.putAndInsertString(DCM_SOPClassUID, (samplesPerPixel == 3) ?
+        UID_MultiframeTrueColorSecondaryCaptureImageStorage : UID_MultiframeGrayscaleByteSecondaryCaptureImageStorage);
+    dataset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.0.0.6");
+    dataset.putAndInsertUint16(DCM_SamplesPerPixel, OFstatic_cast(Uint16, samplesPerPixel));
+    dataset.putAndInsertString(DCM_PhotometricInterpretation, (samplesPerPixel == 3) ? "RGB" : "MONOCHROME2");
+    if (samplesPerPixel == 3)
+        dataset.putAndInsertUint16(DCM_PlanarConfiguration, 0);
+    dataset.putAndInsertString(DCM_NumberOfFrames, "7");
+    dataset.putAndInsertUint16(DCM_Rows, IMAGE_ROWS);
+    dataset.putAndInsertUint16(DCM_Columns, IMAGE_COLUMNS);
+    dataset.putAndInsertUint16(DCM_BitsAllocated, 8);
+    dataset.putAndInsertUint16(DCM_BitsStored, 8);
+    dataset.putAndInsertUint16(DCM_HighBit, 7);
+    dataset.putAndInsertUint16(DCM_PixelRepresentation, 0);
+    dataset.putAndInsertUint8Array(DCM_PixelData, &pixels[0], frameSize * NUMBER_OF_FRAMES);
+}
+
+
+/* compress the image with the given number of threads and return its pixel sequence */
+static OFBool compressImage(DcmDataset &dataset,
+                            const E_TransferSyntax xfer,
+                            const DcmRepresentationParameter *rp,
+                            const int samplesPerPixel,
+                            const OFBool preferCookedEncoding,
+                            const Uint32 numberOfThreads,
+                            DcmPixelSequence *&sequence)
+{
+    createImage(dataset, samplesPerPixel);
+    // fragments of 1 kbyte, with a basic offset table
+    DJLSEncoderRegistration::registerCodecs(OFFalse, 3, 7, 21, 64, 0, preferCookedEncoding,
+        1 /* fragment size */, OFTrue /* offset table */, EJLSUC_never, OFFalse,
+        DJLSCodecParameter::interleaveDefault, numberOfThreads);
+    OFCondition result = dataset.chooseRepresentation(xfer, rp);
+    DJLSEncoderRegistration::cleanup();
+    DcmElement *element = NULL;
+    sequence = NULL;
+    return result.good() &&
+        dataset.findAndGetElement(DCM_PixelData, element).good() &&
+        OFstatic_cast(DcmPixelData *, element)->getEncapsulatedRepresentation(xfer, rp, sequence).good() &&
+        (sequence != NULL);
+}
+
+
+/* compare the fragments (including the basic offset table) of two pixel sequences */
+static OFBool compareFragments(DcmPixelSequence &sequence1,
+                               DcmPixelSequence &sequence2)
+{
+    if (sequence1.card() != sequence2.card())
+        return OFFalse;
+    for (unsigned long i = 0; i < sequence1.card(); ++i)
+    {
+        DcmPixelItem *item1 = NULL;
+        DcmPixelItem *item2 = NULL;
+        Uint8 *data1 = NULL;
+        Uint8 *data2 = NULL;
+        if (sequence1.getItem(item1, i).bad() || sequence2.getItem(item2, i).bad() ||
+            (item1->getLength() != item2->getLength()))
+        {
+            return OFFalse;
+        }
+        if (item1->getLength() > 0)
+        {
+            if (item1->getUint8Array(data1).bad() || item2->getUint8Array(data2).bad() ||
+                (memcmp(data1, data2, item1->getLength()) != 0))
+            {
+                return OFFalse;
+            }
+        }
+    }
+    return OFTrue;
+}
+
+
+/* compress the image sequentially and in parallel, and compare the results */
+static void checkParallelCompression(const E_TransferSyntax xfer,
+                                     const DcmRepresentationParameter *rp,
+                                     const int samplesPerPixel,
+                                     const OFBool preferCookedEncoding)
+{
+    DcmDataset sequential;
+    DcmDataset parallel;
+    DcmPixelSequence *sequence1 = NULL;
+    DcmPixelSequence *sequence2 = NULL;
+    OFCHECK(compressImage(sequential, xfer, rp, samplesPerPixel, preferCookedEncoding, 1, sequence1));
+    OFCHECK(compressImage(parallel, xfer, rp, samplesPerPixel, preferCookedEncoding, NUMBER_OF_THREADS, sequence2));
+    if ((sequence1 != NULL) && (sequence2 != NULL))
+    {
+        // the offset table and at least two fragments per frame
+        DcmPixelItem *offsetTable = NULL;
+        OFCHECK(sequence1->getItem(offsetTable, 0).good());
+        if (offsetTable != NULL)
+            OFCHECK_EQUAL(offsetTable->getLength(), 4 * NUMBER_OF_FRAMES);
+        OFCHECK(sequence1->card() > 2 * NUMBER_OF_FRAMES);
+        OFCHECK(compareFragments(*sequence1, *sequence2));
+    }
+}
+
+
+OFTEST(dcmjpls_parallelCompression)
+{
+    // lossless mode, "raw" encoder (frames are taken directly from the pixel data)
+    DJLSRepresentationParameter lossless(2, OFTrue);
+    checkParallelCompression(EXS_JPEGLSLossless, &lossless, 1, OFFalse);
+    checkParallelCompression(EXS_JPEGLSLossless, &lossless, 3, OFFalse);
+    // lossless mode, "cooked" encoder (frames are rendered through DicomImage)
+    checkParallelCompression(EXS_JPEGLSLossless, &lossless, 1, OFTrue);
+    checkParallelCompression(EXS_JPEGLSLossless, &lossless, 3, OFTrue);
+    // near-lossless mode always uses the "cooked" encoder
+    DJLSRepresentationParameter nearLossless(2, OFFalse);
+    checkParallelCompression(EXS_JPEGLSLossy, &nearLossless, 1, OFFalse);
+    checkParallelCompression(EXS_JPEGLSLossy, &nearLossless, 3, OFFalse);
+}
@@ -91,6 +91,7 @@ int main(int argc, char *argv[])
     OFCmdUnsignedInt opt_dimseTimeout = 0;
     OFCmdUnsignedInt opt_acseTimeout = 30;
     OFCmdUnsignedInt opt_maxPDULength = ASC_DEFAULTMAXPDU;
+    OFCmdUnsignedInt opt_pipelinedBuffers = 0;
     T_DIMSE_BlockingMode opt_blockingMode = DIMSE_BLOCKING;
 
     OFBool opt_showPresentationContexts = OFFalse;  // default: do not show presentation contexts in verbose mode
@@ -152,6 +153,9 @@ int main(int argc, char *argv[])
         cmd.addOption("--normal",              "-B",      "allow implicit format conversions (default)");
         cmd.addOption("--bit-preserving",      "+B",      "write dataset exactly as received");
         cmd.addOption("--ignore",                         "ignore dataset, receive but do not store it");
+      cmd.addSubGroup("pipelined writing (only with --bit-preserving):");
+        cmd.addOption("--pipelined-write",     "+pw",  1, "[n]umber: integer (2..1024)",
+                                                          "write files in a separate thread using\nn buffers of 256 kB each");
 
     /* evaluate command line */
     prepareCmdLineArgs(argc, argv, OFFIS_CONSOLE_APPLICATION);
@@ -242,6 +246,12 @@ int main(int argc, char *argv[])
             opt_datasetStorage = DcmStorageSCP::DSM_Ignore;
         cmd.endOptionBlock();
 
+        if (cmd.findOption("--pipelined-write"))
+        {
+            app.checkDependence("--pipelined-write", "--bit-preserving", opt_datasetStorage == DcmStorageSCP::DGM_StoreBitPreserving);
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_pipelinedBuffers, 2, 1024));
+        }
+
         /* command line parameters */
         app.checkParam(cmd.getParamAndCheckMinMax(1, opt_port, 1, 65535));
     }
@@ -276,6 +286,7 @@ int main(int argc, char *argv[])
     storageSCP.setFilenameGenerationMode(opt_filenameGeneration);
     storageSCP.setFilenameExtension(opt_filenameExtension);
     storageSCP.setDatasetStorageMode(opt_datasetStorage);
+    storageSCP.setPipelinedFileWriting(OFstatic_cast(Uint32, opt_pipelinedBuffers));
 
     /* load association negotiation profile from configuration file (if specified) */
     if ((opt_configFile != NULL) && (opt_profileName != NULL))
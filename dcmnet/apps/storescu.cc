@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1996-2013, OFFIS e.V.
+ *  Copyright (C) 1996-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -127,6 +127,7 @@ int opt_acse_timeout = 30;
 
 #ifdef WITH_ZLIB
 static OFCmdUnsignedInt opt_compressionLevel = 0;
+static OFCmdUnsignedInt opt_compressionThreads = 1;
 #endif
 
 #ifdef WITH_OPENSSL
@@ -275,6 +276,9 @@ int main(int argc, char *argv[])
     cmd.addSubGroup("deflate compression level (only with --propose-deflated or --config-file):");
       cmd.addOption("--compression-level",    "+cl",  1, "[l]evel: integer (default: 6)",
                                                          "0=uncompressed, 1=fastest, 9=best compression");
+    cmd.addSubGroup("deflate multi-threading (only with --propose-deflated or --config-file):");
+      cmd.addOption("--compression-threads",  "+ct",  1, "[n]umber: integer (default: 1)",
+                                                         "compress blocks of data using n threads");
 #endif
     cmd.addSubGroup("user identity negotiation:");
       cmd.addOption("--user",                 "-usr", 1, "[u]ser name: string",
@@ -483,6 +487,13 @@ int main(int argc, char *argv[])
         app.checkValue(cmd.getValueAndCheckMinMax(opt_compressionLevel, 0, 9));
         dcmZlibCompressionLevel.set(OFstatic_cast(int, opt_compressionLevel));
       }
+      if (cmd.findOption("--compression-threads"))
+      {
+        app.checkDependence("--compression-threads", "--propose-deflated or --config-file",
+          (opt_networkTransferSyntax == EXS_DeflatedLittleEndianExplicit) || (opt_configFile != NULL));
+        app.checkValue(cmd.getValueAndCheckMin(opt_compressionThreads, OFstatic_cast(OFCmdUnsignedInt, 1)));
+        dcmZlibCompressionThreads.set(OFstatic_cast(Uint32, opt_compressionThreads));
+      }
 #endif
 
       cmd.beginOptionBlock();
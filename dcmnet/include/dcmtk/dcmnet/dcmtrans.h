@@ -157,6 +157,20 @@ public:
    */
   static OFBool selectReadableAssociation(DcmTransportConnection *connections[], int connCount, int timeout);
 
+  /** checks whether the given socket is ready for reading, i.e.\ whether data
+   *  is available on a connected socket or a connection request is pending on
+   *  a listening socket. If the socket is not ready, this method blocks up to
+   *  the specified timeout interval or until the socket becomes readable,
+   *  whatever occurs first. The poll() system call is used if available,
+   *  which - unlike select() - also works for socket descriptors that are
+   *  not smaller than FD_SETSIZE.
+   *  @param socket socket file descriptor
+   *  @param timeout number of seconds for timeout. If timeout is 0, this method
+   *    does not block.
+   *  @return OFTrue if the socket is ready for reading, OFFalse otherwise
+   */
+  static OFBool isSocketReadable(int socket, int timeout);
+
 protected:
 
   /** returns the socket file descriptor managed by this object.
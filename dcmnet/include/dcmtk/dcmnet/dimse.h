@@ -94,6 +94,7 @@
 #include "dcmtk/ofstd/ofglobal.h"
 
 class DcmOutputFileStream;
+class DcmOutputPipelinedFileStream;
 
 /** Global flag to enable/disable workaround code for some buggy Store SCUs
  * in DIMSE_storeProvider().  If enabled, an illegal space-padding in the
@@ -988,6 +989,25 @@ DIMSE_createFilestream(
                      /* out */
                      DcmOutputFileStream **filestream);
 
+/* same as DIMSE_createFilestream(), but creates a file stream that
+ * writes the data received by DIMSE_receiveDataSetInFile() to the file
+ * in a separate thread, using the given number of buffers of the given
+ * size (see class DcmOutputPipelinedFileStream). The caller should call
+ * close() on the returned stream and check the result before deleting it.
+ */
+DCMTK_DCMNET_EXPORT OFCondition
+DIMSE_createPipelinedFilestream(
+                     /* in */
+                     const OFFilename &filename,
+                     const T_DIMSE_C_StoreRQ *request,
+                     const T_ASC_Association *assoc,
+                     T_ASC_PresentationContextID presIdCmd,
+                     int writeMetaheader,
+                     Uint32 numberOfBuffers,
+                     Uint32 bufferSize,
+                     /* out */
+                     DcmOutputPipelinedFileStream **filestream);
+
 DCMTK_DCMNET_EXPORT OFCondition
 DIMSE_receiveDataSetInFile(T_ASC_Association *assoc,
                      T_DIMSE_BlockingMode blocking, int timeout,
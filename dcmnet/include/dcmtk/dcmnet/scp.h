@@ -280,6 +280,16 @@ public:
    */
   void setProgressNotificationMode(const OFBool mode);
 
+  /** Enables or disables pipelined writing of datasets that are received directly into
+   *  a file, i.e.\ by receiveSTORERequest() with a filename. If enabled, a separate thread
+   *  writes the received data to the file so that reading from the network does not block
+   *  on disk I/O. See DcmSCPConfig::setPipelinedFileWriting() for details.
+   *  @param numberOfBuffers [in] Number of buffers (minimum 2), 0 disables pipelined writing
+   *  @param bufferSize      [in] Size of each buffer in bytes, 0 selects the default (256 kB)
+   */
+  void setPipelinedFileWriting(const Uint32 numberOfBuffers,
+                               const Uint32 bufferSize = 0);
+
   /* Get methods for SCP settings */
 
   /** Returns TCP/IP port number SCP listens for new connection requests
@@ -354,6 +364,12 @@ public:
    */
   OFBool getProgressNotificationMode() const;
 
+  /** Returns the number of buffers used for pipelined writing of datasets that are
+   *  received directly into a file.
+   *  @return The number of buffers, 0 if pipelined writing is disabled (default)
+   */
+  Uint32 getPipelinedFileWritingBuffers() const;
+
   /** Get access to the configuration of the SCP. Note that the functionality
    *  on the configuration object is shadowed by other API functions of DcmSCP.
    *  The existing functions are provided in order to not break users of this
@@ -193,6 +193,19 @@ public:
    */
   void setProgressNotificationMode(const OFBool mode);
 
+  /** Enables or disables pipelined writing of datasets that are received directly
+   *  into a file (see DcmSCP::receiveSTORERequest()). If enabled, the received data
+   *  is copied into a fixed number of buffers, which are written to the file by a
+   *  separate thread (see DcmOutputPipelinedFileStream). Therefore, reading from the
+   *  network does not block on disk I/O, and the memory used per association is
+   *  limited to numberOfBuffers * bufferSize bytes. Pipelined writing is disabled by
+   *  default. Without thread support, the file is written synchronously.
+   *  @param numberOfBuffers [in] Number of buffers (minimum 2), 0 disables pipelined writing
+   *  @param bufferSize      [in] Size of each buffer in bytes, 0 selects the default (256 kB)
+   */
+  void setPipelinedFileWriting(const Uint32 numberOfBuffers,
+                               const Uint32 bufferSize);
+
   /* Get methods for SCP settings */
 
   /** Returns TCP/IP port number SCP listens for new connection requests
@@ -268,6 +281,18 @@ public:
    */
   OFBool getProgressNotificationMode() const;
 
+  /** Returns the number of buffers used for pipelined writing of datasets that are
+   *  received directly into a file.
+   *  @return The number of buffers, 0 if pipelined writing is disabled (default)
+   */
+  Uint32 getPipelinedFileWritingBuffers() const;
+
+  /** Returns the size of each buffer used for pipelined writing of datasets that are
+   *  received directly into a file.
+   *  @return The buffer size in bytes, 0 if the default size is used
+   */
+  Uint32 getPipelinedFileWritingBufferSize() const;
+
 protected:
 
   /// Association configuration. May be filled from association configuration file or by
@@ -333,6 +358,12 @@ protected:
 
   /// Progress notification mode (default: OFTrue)
   OFBool m_progressNotificationMode;
+
+  /// Number of buffers used for pipelined file writing, 0 if disabled (default: 0)
+  Uint32 m_pipelinedFileBuffers;
+
+  /// Size of each buffer used for pipelined file writing, 0 for default size (default: 0)
+  Uint32 m_pipelinedFileBufferSize;
 };
 
 /** Enables sharing configurations by multiple DcmSCPs.
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2012-2014, OFFIS e.V.
+ *  Copyright (C) 2012-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -30,14 +30,22 @@
 #ifdef WITH_THREADS // Without threads this does not make sense...
 
 #include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofmap.h"
 #include "dcmtk/dcmnet/scpthrd.h"
 #include "dcmtk/dcmnet/scpcfg.h"
 #include "dcmtk/dcmnet/assoc.h"
 
+class OFSemaphore;
+
 /** Base class for implementing an SCP pool with one thread listening for
- *  incoming TCP/IP connections and spawning a number of SCP worker threads
- *  that handle the incoming DICOM association on that connection. This base
- *  class is abstract.
+ *  incoming TCP/IP connections and a number of SCP worker threads that
+ *  handle the incoming DICOM associations on these connections. Worker
+ *  threads are created on demand (up to the configured maximum) and are
+ *  reused for subsequent associations until the pool is shut down.
+ *  If all workers are busy, incoming associations can be queued (see
+ *  setMaxQueuedAssociations()); queued associations are handed to the next
+ *  free worker, alternating between the calling AE titles so that a single
+ *  busy client cannot starve others. This base class is abstract.
  */
 class DCMTK_DCMNET_EXPORT DcmBaseSCPPool
 {
@@ -125,6 +133,29 @@ public:
   // Needed to keep MS VC6 happy
   friend class DcmBaseSCPWorker;
 
+  /** Statistics on associations waiting in the queue of the pool, see
+   *  getQueueStatistics(). All times are given in seconds.
+   */
+  struct DCMTK_DCMNET_EXPORT QueueStatistics
+  {
+    /** Constructor, initializes all values with zero
+     */
+    QueueStatistics();
+
+    /// Number of associations currently waiting for a worker
+    size_t currentLength;
+    /// Maximum number of associations that were waiting at the same time
+    size_t maxLength;
+    /// Number of associations that were handed over to a worker
+    unsigned long numAssociations;
+    /// Number of associations that were rejected since the queue was full
+    unsigned long numRejected;
+    /// Sum of the times the associations had to wait for a worker
+    double totalWaitTime;
+    /// Maximum time an association had to wait for a worker
+    double maxWaitTime;
+  };
+
   /** Virtual destructor, frees internal memory.
    */
   virtual ~DcmBaseSCPPool();
@@ -146,8 +177,35 @@ public:
    */
   virtual size_t numThreads(const OFBool onlyBusy);
 
-  /** Listen for incoming association requests. For each incoming request, a
-   *  new thread is started if number of maximum threads is not reached yet.
+  /** Set the maximum number of associations that may wait for a worker if
+   *  all workers are busy. If this number is exceeded, further association
+   *  requests are rejected with the reason "local limit exceeded". The
+   *  default is 0, i.e.\ requests are rejected if no worker is available.
+   *  @param maxQueued Maximum number of queued associations
+   */
+  virtual void setMaxQueuedAssociations(const Uint16 maxQueued);
+
+  /** Get the maximum number of associations that may wait for a worker.
+   *  @return Maximum number of queued associations
+   */
+  virtual Uint16 getMaxQueuedAssociations();
+
+  /** Get statistics on the associations that are or were waiting for a
+   *  worker, e.g.\ for monitoring the load of the pool.
+   *  @return Current queue statistics
+   */
+  virtual QueueStatistics getQueueStatistics();
+
+  /** Reset the queue statistics (except for the current queue length).
+   */
+  virtual void resetQueueStatistics();
+
+  /** Listen for incoming association requests. Each incoming request is
+   *  handed over to an idle worker thread; a new thread is started if there is
+   *  no idle worker and the number of maximum threads is not reached yet.
+   *  Otherwise, the request is queued or rejected, see setMaxQueuedAssociations().
+   *  Since the worker threads usually only read the global data dictionary, the
+   *  caller should freeze it before (see GlobalDcmDataDictionary::freeze()).
    *  @return DUL_NOASSOCIATIONREQUEST if no connection is requested during
    *          timeout. Returns other error code if serious error occurs during
    *          listening. Will not return EC_Normal since listens forever if
@@ -180,16 +238,30 @@ protected:
    */
   virtual DcmBaseSCPWorker* createSCPWorker() = 0;
 
-  /** Try to find worker to run the association. If worker could be found, a
-   *  side effect is that assoc is set to NULL.
+  /** Queue the association for being run by the next free worker. Starts a
+   *  new worker if necessary and permitted.
    *  @param assoc The association to be run. Must be not NULL.
    *  @param sharedConfig A DcmSharedSCPConfig object to be used by the worker.
-   *  @return EC_Normal if worker could be found and runs the association,
-   *          an error code otherwise.
+   *  @return EC_Normal if the association was queued, NET_EC_SCPBusy if the
+   *          maximum number of queued associations is reached, another error
+   *          code otherwise. In case of an error, the caller is responsible
+   *          for the association.
    */
   OFCondition runAssociation(T_ASC_Association* assoc,
                              const DcmSharedSCPConfig& sharedConfig);
 
+  /** Used by worker threads to wait for the next association to be run.
+   *  If several associations are waiting, the one with the calling AE title
+   *  that was least recently served is chosen (oldest first within the same
+   *  AE title).
+   *  @param worker The worker that is calling this function
+   *  @param assoc Returns the association to be run by the worker
+   *  @return OFTrue if an association was assigned, OFFalse if the pool is
+   *          shutting down and the worker should exit.
+   */
+  OFBool waitForAssociation(DcmBaseSCPWorker* worker,
+                            T_ASC_Association*& assoc);
+
   /** Drops association and clears internal structures to free memory
    *  @param assoc The association to free
    */
@@ -224,7 +296,28 @@ private:
     SHUTDOWN
   };
 
-  /// Mutex that guards the list of busy and idle workers
+  /// Association waiting for a worker
+  struct QueueEntry
+  {
+    /// The association
+    T_ASC_Association* assoc;
+    /// Calling AE title of the association
+    OFString callingAETitle;
+    /// Time when the association was queued
+    double queueTime;
+  };
+
+  /** Wake up the given number of workers waiting for an association.
+   *  @param count Number of workers to wake up
+   */
+  void signalWorkers(const size_t count);
+
+  /** Block until an association might be waiting or the pool shuts down.
+   */
+  void waitForWork();
+
+  /// Mutex that guards the list of busy and idle workers, the queue and
+  /// the statistics
   OFMutex m_criticalSection;
   /// List of all workers running a connection
   OFList<DcmBaseSCPWorker*> m_workersBusy;
@@ -238,14 +331,25 @@ private:
   /// one connection at a time.
   Uint16 m_maxWorkers;
 
-  // Not implemented yet: Can be helpful if all workers are busy but incoming
-  // associations should then not be rejected immediately but only after a
-  // specific timeout
-  // Uint16 m_workersBusyTimeout;
+  /// Maximum number of associations that can wait for a worker if all
+  /// workers are busy.
+  Uint16 m_maxQueued;
+
+  /// List of associations that are waiting for a worker
+  OFList<QueueEntry> m_queue;
+
+  /// Serial number of the last association handed over to a worker for
+  /// each calling AE title (only for AE titles in the queue)
+  OFMap<OFString, unsigned long> m_lastServed;
+
+  /// Serial number of the last association handed over to a worker
+  unsigned long m_servedCounter;
+
+  /// Queue statistics
+  QueueStatistics m_statistics;
 
-  // Not implemented yet: list of associations that are waiting for a worker
-  // becoming available
-  // OFList<T_ASC_Association*> m_waiting;
+  /// Counts associations waiting for a worker, NULL if not available
+  OFSemaphore* m_workAvailable;
 
   /// Current run mode of pool
   runmode m_runMode;
@@ -254,10 +358,10 @@ private:
 /** Implementation of DICOM SCP server pool. The pool waits for incoming
  *  TCP/IP connection requests, accepts them on TCP/IP level and hands the
  *  connection to a worker thread. The maximum number of worker threads, i.e.
- *  simultaneous connections, is configurable. The default is 5. At the moment,
- *  if no free worker slots are available, an incoming request is rejected with
- *  the error "local limit exceeded", i.e. those requests are not queued. This
- *  behaviour might change in the future.
+ *  simultaneous connections, is configurable. The default is 5. Worker threads
+ *  are reused for subsequent connections. If no free worker is available, an
+ *  incoming request is queued if permitted by setMaxQueuedAssociations() and
+ *  rejected with the error "local limit exceeded" otherwise.
  *  @tparam SCP the service class provider to be instantiated for each request,
  *    should follow the @ref SCPThread_Concept.
  *  @tparam SCPPool the base SCP pool class to use. Use this parameter if you
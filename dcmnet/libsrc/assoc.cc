@@ -1660,9 +1660,6 @@ OFBool
 ASC_associationWaiting(T_ASC_Network * network, int timeout)
 {
     int s;
-    struct timeval t;
-    fd_set fdset;
-    int nfound;
 
     if (network == NULL) return OFFalse;
 
@@ -1670,21 +1667,7 @@ ASC_associationWaiting(T_ASC_Network * network, int timeout)
     if (s < 0)
         return OFFalse;
 
-    FD_ZERO(&fdset);
-#ifdef __MINGW32__
-    // on MinGW, FD_SET expects an unsigned first argument
-    FD_SET((unsigned int) s, &fdset);
-#else
-    FD_SET(s, &fdset);
-#endif
-    t.tv_sec = timeout;
-    t.tv_usec = 0;
-#ifdef HAVE_INTP_SELECT
-    nfound = select(s + 1, (int *)(&fdset), NULL, NULL, &t);
-#else
-    nfound = select(s + 1, &fdset, NULL, NULL, &t);
-#endif
-    return nfound > 0;
+    return DcmTransportConnection::isSocketReadable(s, timeout);
 }
 
 /*
@@ -161,19 +161,18 @@ OFCondition DcmExtendedNegotiationMap::add(
   OFString skey(key);
   OFMap<OFString, DcmExtendedNegotiationList*>::iterator it = map_.find(skey);
 
-  DcmExtendedNegotiationList * const *value = NULL;
+  DcmExtendedNegotiationList *value = NULL;
   if (it == map_.end())
   {
-    DcmExtendedNegotiationList *newentry = new DcmExtendedNegotiationList();
-    map_.insert(OFPair<OFString, DcmExtendedNegotiationList*>(skey, newentry));
-    value = &newentry;
+    value = new DcmExtendedNegotiationList();
+    map_.insert(OFPair<OFString, DcmExtendedNegotiationList*>(skey, value));
   }
   else
   {
-    value = & ((*it).second);
+    value = (*it).second;
     // check if abstract syntax is already in list
-    OFListIterator(DcmExtendedNegotiationItem) first = (*value)->begin();
-    OFListIterator(DcmExtendedNegotiationItem) last = (*value)->end();
+    OFListIterator(DcmExtendedNegotiationItem) first = value->begin();
+    OFListIterator(DcmExtendedNegotiationItem) last = value->end();
     while (first != last)
     {
       if ((*first).matches(uid))
@@ -188,7 +187,7 @@ OFCondition DcmExtendedNegotiationMap::add(
   }
 
   // insert values into list.
-  (*value)->push_back(DcmExtendedNegotiationItem(uid, rawData, length));
+  value->push_back(DcmExtendedNegotiationItem(uid, rawData, length));
   return EC_Normal;
 }
 
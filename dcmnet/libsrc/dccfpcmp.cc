@@ -121,22 +121,21 @@ OFCondition DcmPresentationContextMap::add(
     return makeOFCondition(OFM_dcmnet, 1025, OF_error, s.c_str());
   }
 
-  DcmPresentationContextList * const *value = NULL;
+  DcmPresentationContextList *value = NULL;
   OFString skey(key);
   OFMap<OFString, DcmPresentationContextList*>::iterator it = map_.find(skey);
 
   // create new value if not existing yet
   if (it == map_.end())
   {
-    DcmPresentationContextList *newentry = new DcmPresentationContextList();
-    map_.insert(OFPair<OFString, DcmPresentationContextList*>(skey, newentry));
-    value = &newentry;
+    value = new DcmPresentationContextList();
+    map_.insert(OFPair<OFString, DcmPresentationContextList*>(skey, value));
   }
   else // use existing value
-    value = & ((*it).second);
+    value = (*it).second;
 
   // make sure list does not get longer than 128 entries
-  if (((*value)->size()) > 127)
+  if ((value->size()) > 127)
   {
     OFString s("presentation context list too long (> 128 entries): ");
     s += key;
@@ -144,7 +143,7 @@ OFCondition DcmPresentationContextMap::add(
   }
 
   // insert values into list.
-  (*value)->push_back(DcmPresentationContextItem(uid, OFString(transferSyntaxKey)));
+  value->push_back(DcmPresentationContextItem(uid, OFString(transferSyntaxKey)));
   return EC_Normal;
 }
 
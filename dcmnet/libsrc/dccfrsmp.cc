@@ -120,22 +120,21 @@ OFCondition DcmRoleSelectionMap::add(
     return makeOFCondition(OFM_dcmnet, 1026, OF_error, s.c_str());
   }
 
-  DcmRoleSelectionList * const *value = NULL;
+  DcmRoleSelectionList *value = NULL;
   OFString skey(key);
   OFMap<OFString, DcmRoleSelectionList*>::iterator it = map_.find(skey);
 
   if (it == map_.end())
   {
-    DcmRoleSelectionList *newentry = new DcmRoleSelectionList();
-    map_.insert(OFPair<OFString, DcmRoleSelectionList*>(skey, newentry));
-    value = &newentry;
+    value = new DcmRoleSelectionList();
+    map_.insert(OFPair<OFString, DcmRoleSelectionList*>(skey, value));
   }
   else
   {
-    value = & ((*it).second);
+    value = (*it).second;
     // check if abstract syntax is already in list
-    OFListIterator(DcmRoleSelectionItem) first = (*value)->begin();
-    OFListIterator(DcmRoleSelectionItem) last = (*value)->end();
+    OFListIterator(DcmRoleSelectionItem) first = value->begin();
+    OFListIterator(DcmRoleSelectionItem) last = value->end();
     while (first != last)
     {
       if ((*first).matches(uid))
@@ -150,7 +149,7 @@ OFCondition DcmRoleSelectionMap::add(
   }
 
   // insert values into list.
-  (*value)->push_back(DcmRoleSelectionItem(role, uid));
+  value->push_back(DcmRoleSelectionItem(role, uid));
   return EC_Normal;
 }
 
@@ -92,21 +92,20 @@ OFCondition DcmTransferSyntaxMap::add(
     return makeOFCondition(OFM_dcmnet, 1024, OF_error, s.c_str());
   }
 
-  DcmTransferSyntaxList * const *value = NULL;
+  DcmTransferSyntaxList *value = NULL;
   OFString skey(key);
   OFMap<OFString, DcmTransferSyntaxList*>::iterator it = map_.find(skey);
 
   if (it == map_.end())
   {
-    DcmTransferSyntaxList *newentry = new DcmTransferSyntaxList();
-    map_.insert(OFPair<OFString, DcmTransferSyntaxList*>(skey, newentry));
-    value = &newentry;
+    value = new DcmTransferSyntaxList();
+    map_.insert(OFPair<OFString, DcmTransferSyntaxList*>(skey, value));
   }
   else
-    value = & ((*it).second);
+    value = (*it).second;
 
   // insert UID into list.
-  (*value)->push_back(uid);
+  value->push_back(uid);
   return EC_Normal;
 }
 
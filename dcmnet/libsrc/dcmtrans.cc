@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1998-2012, OFFIS e.V.
+ *  Copyright (C) 1998-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -31,6 +31,7 @@
 #define INCLUDE_CTIME
 #define INCLUDE_CERRNO
 #define INCLUDE_CSIGNAL
+#define INCLUDE_CLIMITS
 #include "dcmtk/ofstd/ofstdinc.h"
 
 BEGIN_EXTERN_C
@@ -43,6 +44,9 @@ BEGIN_EXTERN_C
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
 END_EXTERN_C
 
 #ifdef HAVE_WINDOWS_H
@@ -160,11 +164,67 @@ OFBool DcmTransportConnection::safeSelectReadableAssociation(DcmTransportConnect
   return found;
 }
 
+#ifdef HAVE_POLL_H
+
+/* convert a timeout in seconds to milliseconds for poll(), avoiding an overflow */
+static int pollTimeout(int timeout)
+{
+  return (timeout > INT_MAX / 1000) ? INT_MAX : timeout * 1000;
+}
+
+/* check the events returned by poll(). A closed connection counts as readable,
+ * as with select(), whereas an invalid descriptor is an error. An error
+ * condition only counts as readable if it comes with input or a hangup,
+ * i.e. if a subsequent read() reports the error.
+ */
+static OFBool pollReadable(short revents)
+{
+  if (revents & POLLNVAL) return OFFalse;
+  return (revents & (POLLIN | POLLHUP)) != 0;
+}
+
+#endif
+
 OFBool DcmTransportConnection::fastSelectReadableAssociation(DcmTransportConnection *connections[], int connCount, int timeout)
 {
+  int i=0;
+#ifdef HAVE_POLL_H
+  /* poll() is not limited to socket descriptors smaller than FD_SETSIZE
+   * and does not need to scan a bit set up to the highest descriptor
+   */
+  struct pollfd *fds = new struct pollfd[connCount];
+  int fdCount = 0;
+  for (i=0; i<connCount; i++)
+  {
+    if (connections[i])
+    {
+      fds[fdCount].fd = connections[i]->getSocket();
+      fds[fdCount].events = POLLIN;
+      fds[fdCount].revents = 0;
+      fdCount++;
+    }
+  }
+
+  /* like select(), fail immediately if the timeout is negative */
+  int nfound = (timeout < 0) ? -1 : poll(fds, fdCount, pollTimeout(timeout));
+  OFBool found = OFFalse;
+  if (nfound > 0)
+  {
+    fdCount = 0;
+    for (i=0; i<connCount; i++)
+    {
+      if (connections[i])
+      {
+        /* if not available, set entry in array to NULL */
+        if (pollReadable(fds[fdCount++].revents)) found = OFTrue; else connections[i] = NULL;
+      }
+    }
+  }
+  delete[] fds;
+  return found;
+#else
   int socketfd = -1;
   int maxsocketfd = -1;
-  int i=0;
   struct timeval t;
   fd_set fdset;
 
@@ -205,6 +265,7 @@ OFBool DcmTransportConnection::fastSelectReadableAssociation(DcmTransportConnect
     }
   }
   return OFTrue;
+#endif
 }
 
 OFBool DcmTransportConnection::selectReadableAssociation(DcmTransportConnection *connections[], int connCount, int timeout)
@@ -218,6 +279,47 @@ OFBool DcmTransportConnection::selectReadableAssociation(DcmTransportConnection
   return safeSelectReadableAssociation(connections, connCount, timeout);
 }
 
+OFBool DcmTransportConnection::isSocketReadable(int socket, int timeout)
+{
+  int nfound;
+#ifdef HAVE_POLL_H
+  struct pollfd fd;
+  /* like select(), fail immediately if the timeout is negative */
+  if (timeout < 0) return OFFalse;
+  fd.fd = socket;
+  fd.events = POLLIN;
+  fd.revents = 0;
+  nfound = poll(&fd, 1, pollTimeout(timeout));
+  return (nfound > 0) && pollReadable(fd.revents);
+#else
+  struct timeval t;
+  fd_set fdset;
+
+  FD_ZERO(&fdset);
+#ifdef __MINGW32__
+  /* on MinGW, FD_SET expects an unsigned first argument */
+  FD_SET((unsigned int) socket, &fdset);
+#else
+  FD_SET(socket, &fdset);
+#endif
+
+  t.tv_sec = timeout;
+  t.tv_usec = 0;
+
+#ifdef HAVE_INTP_SELECT
+  nfound = select(socket + 1, (int *)(&fdset), NULL, NULL, &t);
+#else
+  nfound = select(socket + 1, &fdset, NULL, NULL, &t);
+#endif
+  if (nfound <= 0) return OFFalse;
+  else
+  {
+    if (FD_ISSET(socket, &fdset)) return OFTrue;
+    else return OFFalse;  /* This should not really happen */
+  }
+#endif
+}
+
 void DcmTransportConnection::dumpConnectionParameters(STD_NAMESPACE ostream& out)
 {
     OFString str;
@@ -296,33 +398,7 @@ unsigned long DcmTCPConnection::getPeerCertificate(void * /* buf */ , unsigned l
 
 OFBool DcmTCPConnection::networkDataAvailable(int timeout)
 {
-  struct timeval t;
-  fd_set fdset;
-  int nfound;
-
-  FD_ZERO(&fdset);
-
-#ifdef __MINGW32__
-  /* on MinGW, FD_SET expects an unsigned first argument */
-  FD_SET((unsigned int) getSocket(), &fdset);
-#else
-  FD_SET(getSocket(), &fdset);
-#endif
-
-  t.tv_sec = timeout;
-  t.tv_usec = 0;
-
-#ifdef HAVE_INTP_SELECT
-  nfound = select(getSocket() + 1, (int *)(&fdset), NULL, NULL, &t);
-#else
-  nfound = select(getSocket() + 1, &fdset, NULL, NULL, &t);
-#endif
-  if (nfound <= 0) return OFFalse;
-  else
-  {
-    if (FD_ISSET(getSocket(), &fdset)) return OFTrue;
-    else return OFFalse;  /* This should not really happen */
-  }
+  return isSocketReadable(getSocket(), timeout);
 }
 
 OFBool DcmTCPConnection::isTransparentConnection()
@@ -111,6 +111,7 @@
 #include "dcmtk/dcmdata/dcistrmb.h"    /* for class DcmInputBufferStream */
 #include "dcmtk/dcmdata/dcostrmb.h"    /* for class DcmOutputBufferStream */
 #include "dcmtk/dcmdata/dcostrmf.h"    /* for class DcmOutputFileStream */
+#include "dcmtk/dcmdata/dcostrmp.h"    /* for class DcmOutputPipelinedFileStream */
 #include "dcmtk/dcmdata/dcvrul.h"      /* for class DcmUnsignedLong */
 #include "dcmtk/dcmdata/dcvrobow.h"    /* for class DcmOtherByteOtherWord */
 #include "dcmtk/dcmdata/dcvrsh.h"      /* for class DcmShortString */
@@ -1321,13 +1322,19 @@ DIMSE_receiveCommand(
 }
 
 
-OFCondition DIMSE_createFilestream(
+/* creates the file stream for DIMSE_createFilestream() and
+ * DIMSE_createPipelinedFilestream(). If numberOfBuffers is 0,
+ * a DcmOutputFileStream is created, a DcmOutputPipelinedFileStream otherwise.
+ */
+static OFCondition createFilestream(
         const OFFilename &filename,
         const T_DIMSE_C_StoreRQ *request,
         const T_ASC_Association *assoc,
         T_ASC_PresentationContextID presIdCmd,
         int writeMetaheader,
-        DcmOutputFileStream **filestream)
+        Uint32 numberOfBuffers,
+        Uint32 bufferSize,
+        DcmOutputStream **filestream)
 {
   OFCondition cond = EC_Normal;
   DcmElement *elem=NULL;
@@ -1415,7 +1422,10 @@ OFCondition DIMSE_createFilestream(
     }
   }
 
-  *filestream = new DcmOutputFileStream(filename);
+  if (numberOfBuffers == 0)
+    *filestream = new DcmOutputFileStream(filename);
+  else
+    *filestream = new DcmOutputPipelinedFileStream(filename, numberOfBuffers, bufferSize);
   if ((*filestream == NULL)||(! (*filestream)->good()))
   {
      if (metainfo) delete metainfo;
@@ -1448,6 +1458,42 @@ OFCondition DIMSE_createFilestream(
 }
 
 
+OFCondition DIMSE_createFilestream(
+        const OFFilename &filename,
+        const T_DIMSE_C_StoreRQ *request,
+        const T_ASC_Association *assoc,
+        T_ASC_PresentationContextID presIdCmd,
+        int writeMetaheader,
+        DcmOutputFileStream **filestream)
+{
+  if (filestream == NULL) return DIMSE_NULLKEY;
+  DcmOutputStream *stream = NULL;
+  OFCondition cond = createFilestream(filename, request, assoc, presIdCmd, writeMetaheader,
+    0 /*numberOfBuffers*/, 0 /*bufferSize*/, &stream);
+  *filestream = OFstatic_cast(DcmOutputFileStream *, stream);
+  return cond;
+}
+
+
+OFCondition DIMSE_createPipelinedFilestream(
+        const OFFilename &filename,
+        const T_DIMSE_C_StoreRQ *request,
+        const T_ASC_Association *assoc,
+        T_ASC_PresentationContextID presIdCmd,
+        int writeMetaheader,
+        Uint32 numberOfBuffers,
+        Uint32 bufferSize,
+        DcmOutputPipelinedFileStream **filestream)
+{
+  if (filestream == NULL) return DIMSE_NULLKEY;
+  DcmOutputStream *stream = NULL;
+  OFCondition cond = createFilestream(filename, request, assoc, presIdCmd, writeMetaheader,
+    (numberOfBuffers < 2) ? 2 : numberOfBuffers, bufferSize, &stream);
+  *filestream = OFstatic_cast(DcmOutputPipelinedFileStream *, stream);
+  return cond;
+}
+
+
 OFCondition
 DIMSE_receiveDataSetInFile(
         T_ASC_Association *assoc,
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1994-2011, OFFIS e.V.
+ *  Copyright (C) 1994-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were partly developed by
@@ -264,7 +264,9 @@ DU_findSOPClassAndInstanceInFile(
   OFBool tolerateSpacePaddedUIDs)
 {
     DcmFileFormat ff;
-    if (! ff.loadFile(fname, EXS_Unknown, EGL_noChange).good())
+    /* no need to read the dataset beyond the SOP Instance UID */
+    if (! ff.loadFileUntilTag(fname, EXS_Unknown, EGL_noChange, DCM_MaxReadLength,
+        ERM_autoDetect, DcmTagKey(0x0008, 0x0019)).good())
         return OFFalse;
 
     /* look in the meta-header first */
@@ -1528,9 +1528,6 @@ receiveTransportConnectionTCP(PRIVATE_NETWORKKEY ** network,
                               DUL_ASSOCIATESERVICEPARAMETERS * params,
                               PRIVATE_ASSOCIATIONKEY ** association)
 {
-    fd_set
-    fdset;
-    struct timeval timeout_val;
 #ifdef HAVE_DECLARATION_SOCKLEN_T
     socklen_t len;
 #elif !defined(HAVE_PROTOTYPE_ACCEPT) || defined(HAVE_INTP_ACCEPT)
@@ -1538,7 +1535,7 @@ receiveTransportConnectionTCP(PRIVATE_NETWORKKEY ** network,
 #else
     size_t len;
 #endif
-    int nfound, connected;
+    int connected;
     struct sockaddr from;
     OFStandard::OFHostent remote;
     struct linger sockarg;
@@ -1574,55 +1571,16 @@ receiveTransportConnectionTCP(PRIVATE_NETWORKKEY ** network,
         if (block == DUL_NOBLOCK)
         {
             connected = 0;
-            FD_ZERO(&fdset);
-#ifdef __MINGW32__
-            // on MinGW, FD_SET expects an unsigned first argument
-            FD_SET((unsigned int)((*network)->networkSpecific.TCP.listenSocket), &fdset);
-#else
-            FD_SET((*network)->networkSpecific.TCP.listenSocket, &fdset);
-#endif
-
-            timeout_val.tv_sec = timeout;
-            timeout_val.tv_usec = 0;
-#ifdef HAVE_INTP_SELECT
-            nfound = select((*network)->networkSpecific.TCP.listenSocket + 1,
-                            (int *)(&fdset), NULL, NULL, &timeout_val);
-#else
-            nfound = select((*network)->networkSpecific.TCP.listenSocket + 1,
-                            &fdset, NULL, NULL, &timeout_val);
-#endif
-            if (nfound > 0) {
-                if (FD_ISSET((*network)->networkSpecific.TCP.listenSocket, &fdset))
-                    connected++;
-            }
+            if (DcmTransportConnection::isSocketReadable((*network)->networkSpecific.TCP.listenSocket, timeout))
+                connected++;
             if (!connected) return DUL_NOASSOCIATIONREQUEST;
         }
         else
         {
             connected = 0;
             do {
-                FD_ZERO(&fdset);
-#ifdef __MINGW32__
-                // on MinGW, FD_SET expects an unsigned first argument
-                FD_SET((unsigned int)((*network)->networkSpecific.TCP.listenSocket), &fdset);
-#else
-                FD_SET((*network)->networkSpecific.TCP.listenSocket, &fdset);
-#endif
-
-                timeout_val.tv_sec = 5;
-                timeout_val.tv_usec = 0;
-#ifdef HAVE_INTP_SELECT
-                nfound = select((*network)->networkSpecific.TCP.listenSocket + 1,
-                                (int *)(&fdset), NULL, NULL, &timeout_val);
-#else
-                nfound = select((*network)->networkSpecific.TCP.listenSocket + 1,
-                                &fdset, NULL, NULL, &timeout_val);
-#endif
-                if (nfound > 0) {
-                    if (FD_ISSET((*network)->networkSpecific.TCP.listenSocket,
-                                 &fdset))
-                        connected++;
-                }
+                if (DcmTransportConnection::isSocketReadable((*network)->networkSpecific.TCP.listenSocket, 5))
+                    connected++;
             } while (!connected);
         }
 
@@ -25,6 +25,7 @@
 #include "dcmtk/dcmnet/diutil.h"
 #include "dcmtk/dcmnet/assoc.h"
 #include "dcmtk/dcmdata/dcostrmf.h" /* for class DcmOutputFileStream */
+#include "dcmtk/dcmdata/dcostrmp.h" /* for class DcmOutputPipelinedFileStream */
 
 // ----------------------------------------------------------------------------
 
@@ -1493,10 +1494,23 @@ OFCondition DcmSCP::receiveSTORERequestDataset(T_ASC_PresentationContextID *pres
     return EC_InvalidFilename;
 
   OFString tempStr;
-  DcmOutputFileStream *filestream = NULL;
+  OFCondition cond;
+  DcmOutputStream *filestream = NULL;
+  DcmOutputPipelinedFileStream *pipelinedStream = NULL;
   // Receive dataset over the network and write it directly to a file
-  OFCondition cond = DIMSE_createFilestream(filename, &reqMessage, m_assoc, *presID,
-                                            OFTrue /*writeMetaheader*/, &filestream);
+  if (m_cfg->getPipelinedFileWritingBuffers() > 0)
+  {
+    // the file is written by a separate thread while the dataset is received
+    cond = DIMSE_createPipelinedFilestream(filename, &reqMessage, m_assoc, *presID, OFTrue /*writeMetaheader*/,
+                                           m_cfg->getPipelinedFileWritingBuffers(),
+                                           m_cfg->getPipelinedFileWritingBufferSize(), &pipelinedStream);
+    filestream = pipelinedStream;
+  } else {
+    DcmOutputFileStream *outputFileStream = NULL;
+    cond = DIMSE_createFilestream(filename, &reqMessage, m_assoc, *presID,
+                                  OFTrue /*writeMetaheader*/, &outputFileStream);
+    filestream = outputFileStream;
+  }
   if (cond.good())
   {
     if (m_cfg->getProgressNotificationMode())
@@ -1507,6 +1521,16 @@ OFCondition DcmSCP::receiveSTORERequestDataset(T_ASC_PresentationContextID *pres
       cond = DIMSE_receiveDataSetInFile(m_assoc, m_cfg->getDIMSEBlockingMode(), m_cfg->getDIMSETimeout(),
                                         presID, filestream, NULL /*callback*/, NULL /*callbackData*/);
     }
+    if (pipelinedStream != NULL)
+    {
+      // wait until the remaining data has been written to the file
+      OFCondition writeCond = pipelinedStream->close();
+      if (cond.good() && writeCond.bad())
+      {
+        tempStr = "Cannot write file: " + filename + " (" + writeCond.text() + ")";
+        cond = makeDcmnetCondition(DIMSEC_OUTOFRESOURCES, OF_error, tempStr.c_str());
+      }
+    }
     delete filestream;
     if (cond.good())
     {
@@ -1521,6 +1545,8 @@ OFCondition DcmSCP::receiveSTORERequestDataset(T_ASC_PresentationContextID *pres
 
   } else {
 
+    // the file stream may exist if the meta header could not be written
+    delete filestream;
     DCMNET_ERROR("Unable to receive dataset on presentation context "
       << OFstatic_cast(unsigned int, *presID) << ": " << DimseCondition::dump(tempStr, cond));
     // Could not create the filestream, so ignore the dataset
@@ -1725,6 +1751,14 @@ void DcmSCP::setProgressNotificationMode(const OFBool mode)
 
 // ----------------------------------------------------------------------------
 
+void DcmSCP::setPipelinedFileWriting(const Uint32 numberOfBuffers,
+                                     const Uint32 bufferSize)
+{
+  m_cfg->setPipelinedFileWriting(numberOfBuffers, bufferSize);
+}
+
+// ----------------------------------------------------------------------------
+
 /* Get methods for SCP settings and current association information */
 
 OFBool DcmSCP::getRefuseAssociation() const
@@ -1818,6 +1852,13 @@ OFBool DcmSCP::getProgressNotificationMode() const
 
 // ----------------------------------------------------------------------------
 
+Uint32 DcmSCP::getPipelinedFileWritingBuffers() const
+{
+  return m_cfg->getPipelinedFileWritingBuffers();
+}
+
+// ----------------------------------------------------------------------------
+
 OFBool DcmSCP::isConnected() const
 {
   return (m_assoc != NULL) && (m_assoc->DULassociation != NULL);
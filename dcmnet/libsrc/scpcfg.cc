@@ -40,7 +40,9 @@ DcmSCPConfig::DcmSCPConfig() :
   m_verbosePCMode(OFFalse),
   m_connectionTimeout(1000),
   m_respondWithCalledAETitle(OFTrue),
-  m_progressNotificationMode(OFTrue)
+  m_progressNotificationMode(OFTrue),
+  m_pipelinedFileBuffers(0),
+  m_pipelinedFileBufferSize(0)
 {
 }
 
@@ -67,7 +69,9 @@ DcmSCPConfig::DcmSCPConfig(const DcmSCPConfig &old) :
   m_verbosePCMode(old.m_verbosePCMode),
   m_connectionTimeout(old.m_connectionTimeout),
   m_respondWithCalledAETitle(old.m_respondWithCalledAETitle),
-  m_progressNotificationMode(old.m_progressNotificationMode)
+  m_progressNotificationMode(old.m_progressNotificationMode),
+  m_pipelinedFileBuffers(old.m_pipelinedFileBuffers),
+  m_pipelinedFileBufferSize(old.m_pipelinedFileBufferSize)
 {
   // nothing more to do
 }
@@ -93,6 +97,8 @@ DcmSCPConfig& DcmSCPConfig::operator=(const DcmSCPConfig &obj)
     m_connectionTimeout = obj.m_connectionTimeout;
     m_respondWithCalledAETitle = obj.m_respondWithCalledAETitle;
     m_progressNotificationMode = obj.m_progressNotificationMode;
+    m_pipelinedFileBuffers = obj.m_pipelinedFileBuffers;
+    m_pipelinedFileBufferSize = obj.m_pipelinedFileBufferSize;
   }
   return *this;
 }
@@ -197,6 +203,15 @@ void DcmSCPConfig::setProgressNotificationMode(const OFBool mode)
 
 // ----------------------------------------------------------------------------
 
+void DcmSCPConfig::setPipelinedFileWriting(const Uint32 numberOfBuffers,
+                                           const Uint32 bufferSize)
+{
+  m_pipelinedFileBuffers = numberOfBuffers;
+  m_pipelinedFileBufferSize = bufferSize;
+}
+
+// ----------------------------------------------------------------------------
+
 /* Get methods for SCP settings and current association information */
 
 
@@ -291,6 +306,20 @@ OFBool DcmSCPConfig::getProgressNotificationMode() const
 
 // ----------------------------------------------------------------------------
 
+Uint32 DcmSCPConfig::getPipelinedFileWritingBuffers() const
+{
+  return m_pipelinedFileBuffers;
+}
+
+// ----------------------------------------------------------------------------
+
+Uint32 DcmSCPConfig::getPipelinedFileWritingBufferSize() const
+{
+  return m_pipelinedFileBufferSize;
+}
+
+// ----------------------------------------------------------------------------
+
 // Reads association configuration from config file
 OFCondition DcmSCPConfig::loadAssociationCfgFile(const OFString &assocFile)
 {
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2012-2014, OFFIS e.V.
+ *  Copyright (C) 2012-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -28,6 +28,25 @@
 
 #include "dcmtk/dcmnet/scppool.h"
 #include "dcmtk/dcmnet/diutil.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/ofstd/ofstd.h"
+
+/* semaphores are not available on Mac OS X, see ofthread.h */
+#ifndef _DARWIN_C_SOURCE
+#define SCPPOOL_USE_SEMAPHORE
+#endif
+
+// ----------------------------------------------------------------------------
+
+DcmBaseSCPPool::QueueStatistics::QueueStatistics()
+  : currentLength(0),
+    maxLength(0),
+    numAssociations(0),
+    numRejected(0),
+    totalWaitTime(0.0),
+    maxWaitTime(0.0)
+{
+}
 
 // ----------------------------------------------------------------------------
 
@@ -37,16 +56,26 @@ DcmBaseSCPPool::DcmBaseSCPPool()
     m_workersIdle(),
     m_cfg(),
     m_maxWorkers(5),
+    m_maxQueued(0),
+    m_queue(),
+    m_lastServed(),
+    m_servedCounter(0),
+    m_statistics(),
+    m_workAvailable(NULL),
     m_runMode( LISTEN )
-    // not implemented yet: m_workersBusyTimeout(60),
-    // not implemented yet: m_waiting(),
 {
+#ifdef SCPPOOL_USE_SEMAPHORE
+  m_workAvailable = new OFSemaphore(0);
+#endif
 }
 
 // ----------------------------------------------------------------------------
 
 DcmBaseSCPPool::~DcmBaseSCPPool()
 {
+#ifdef SCPPOOL_USE_SEMAPHORE
+  delete m_workAvailable;
+#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -75,7 +104,7 @@ OFCondition DcmBaseSCPPool::listen()
     cond = ASC_receiveAssociation( network, &assoc, m_cfg.getMaxReceivePDULength(), NULL, NULL, OFFalse,
         m_cfg.getConnectionBlockingMode(), OFstatic_cast(int, m_cfg.getConnectionTimeout()) );
 
-    /* If we have a connection request, try to find/create a worker to handle it */
+    /* If we have a connection request, hand it over to a worker */
     if (cond.good())
     {
       cond = runAssociation(assoc, sharedConfig);
@@ -113,24 +142,36 @@ OFCondition DcmBaseSCPPool::listen()
     }
   }
 
+  /* Tell all workers to exit after the queued associations have been handled */
   m_criticalSection.lock();
   m_runMode = SHUTDOWN;
+  OFList<DcmBaseSCPPool::DcmBaseSCPWorker*> workers(m_workersBusy);
+  for
+  (
+    OFListIterator( DcmBaseSCPPool::DcmBaseSCPWorker* ) it = m_workersIdle.begin();
+    it != m_workersIdle.end();
+    ++it
+  )
+    workers.push_back(*it);
+  m_criticalSection.unlock();
+  signalWorkers(workers.size());
 
-  // iterate over all busy workers, join their threads and delete them.
+  // join the threads of all workers and delete them. Workers are not deleted
+  // by themselves during shutdown, so the pointers remain valid.
   for
   (
-    OFListIterator( DcmBaseSCPPool::DcmBaseSCPWorker* ) it = m_workersBusy.begin();
-    it != m_workersBusy.end();
+    OFListIterator( DcmBaseSCPPool::DcmBaseSCPWorker* ) it = workers.begin();
+    it != workers.end();
     ++it
   )
   {
-    m_criticalSection.unlock();
     (*it)->join();
     delete *it;
-    m_criticalSection.lock();
   }
 
+  m_criticalSection.lock();
   m_workersBusy.clear();
+  m_workersIdle.clear();
   m_criticalSection.unlock();
 
   /* In the end, clean up the rest of the memory and drop network */
@@ -179,63 +220,191 @@ void DcmBaseSCPPool::setMaxThreads(const Uint16 maxWorkers)
 
 // ----------------------------------------------------------------------------
 
+void DcmBaseSCPPool::setMaxQueuedAssociations(const Uint16 maxQueued)
+{
+  m_maxQueued = maxQueued;
+}
+
+// ----------------------------------------------------------------------------
+
+Uint16 DcmBaseSCPPool::getMaxQueuedAssociations()
+{
+  return m_maxQueued;
+}
+
+// ----------------------------------------------------------------------------
+
+DcmBaseSCPPool::QueueStatistics DcmBaseSCPPool::getQueueStatistics()
+{
+  m_criticalSection.lock();
+  QueueStatistics result = m_statistics;
+  result.currentLength = m_queue.size();
+  m_criticalSection.unlock();
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmBaseSCPPool::resetQueueStatistics()
+{
+  m_criticalSection.lock();
+  m_statistics = QueueStatistics();
+  m_statistics.maxLength = m_queue.size();
+  m_criticalSection.unlock();
+}
+
+// ----------------------------------------------------------------------------
+
 OFCondition DcmBaseSCPPool::runAssociation(T_ASC_Association *assoc,
                                            const DcmSharedSCPConfig& sharedConfig)
 {
-  /* Try to find idle worker thread */
   OFCondition result = EC_Normal;
-  DcmBaseSCPWorker *chosen = NULL;
 
-  /* Do we have idle worker threads that can handle the association? */
   m_criticalSection.lock();
-  if (m_workersIdle.empty())
+  const size_t numWorkers = m_workersBusy.size() + m_workersIdle.size();
+  /* Number of associations that can be handled without waiting */
+  const size_t numFree = m_workersIdle.size() + ((numWorkers < m_maxWorkers) ? m_maxWorkers - numWorkers : 0);
+  if (m_queue.size() >= numFree + m_maxQueued)
+  {
+    /* No free workers and maximum of waiting associations reached? Return busy */
+    ++m_statistics.numRejected;
+    result = NET_EC_SCPBusy;
+  }
+  /* Do we need another worker, i.e. are all idle workers already reserved? */
+  else if ((m_queue.size() >= m_workersIdle.size()) && (numWorkers < m_maxWorkers))
   {
-    if (m_workersBusy.size() >= m_maxWorkers)
+    DCMNET_DEBUG("DcmBaseSCPPool: Starting new DcmSCP worker thread");
+    DcmBaseSCPWorker* const worker = createSCPWorker();
+    if (!worker) /* Oops, we cannot allocate a new worker thread */
     {
-      /* No idle workers and maximum of busy workers reached? Return busy */
-      result = NET_EC_SCPBusy;
+      result = EC_MemoryExhausted;
     }
-    else /* Else we can produce another worker */
+    else /* Configure and start worker thread, it will wait for the association */
     {
-      DCMNET_DEBUG("DcmBaseSCPPool: Starting new DcmSCP worker thread");
-      DcmBaseSCPWorker* const worker = createSCPWorker();
-      if (!worker) /* Oops, we cannot allocate a new worker thread */
+      worker->setSharedConfig(sharedConfig);
+      m_workersIdle.push_back(worker);
+      if (worker->start() != 0)
       {
-        result = EC_MemoryExhausted;
-      }
-      else /* Configure worker thread */
-      {
-        m_workersBusy.push_back(worker);
-        worker->setSharedConfig(sharedConfig);
-        chosen = worker;
+        m_workersIdle.remove(worker);
+        delete worker;
+        result = NET_EC_CannotStartSCPThread;
       }
     }
   }
-  /* Else we have idle workers, use one of them */
-  else
+
+  /* Put association into queue */
+  if (result.good())
   {
-    chosen = m_workersIdle.front();
-    m_workersIdle.pop_front();
-    m_workersBusy.push_back(chosen);
-    result = EC_Normal;
+    QueueEntry entry;
+    entry.assoc = assoc;
+    if (assoc->params != NULL)
+      entry.callingAETitle = assoc->params->DULparams.callingAPTitle;
+    entry.queueTime = OFTimer::getTime();
+    m_queue.push_back(entry);
+    if (m_queue.size() > m_statistics.maxLength)
+      m_statistics.maxLength = m_queue.size();
   }
   m_criticalSection.unlock();
 
-  /* Hand association to worker */
   if (result.good())
+    signalWorkers(1);
+  /* Return to listen loop */
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool DcmBaseSCPPool::waitForAssociation(DcmBaseSCPWorker* worker,
+                                          T_ASC_Association*& assoc)
+{
+  assoc = NULL;
+  /* The worker is idle now */
+  m_criticalSection.lock();
+  if (m_runMode != SHUTDOWN)
   {
-    result = chosen->setAssociation(assoc);
+    m_workersBusy.remove(worker);
+    m_workersIdle.remove(worker);
+    m_workersIdle.push_back(worker);
   }
-  /* Start the thread */
-  if (result.good())
+  m_criticalSection.unlock();
+
+  while (assoc == NULL)
   {
-     if (chosen->start() != 0)
-     {
-       result = NET_EC_CannotStartSCPThread;
-     }
+    waitForWork();
+    m_criticalSection.lock();
+    if (!m_queue.empty())
+    {
+      /* Choose the oldest association of the least recently served calling AE title */
+      OFListIterator(QueueEntry) chosen = m_queue.end();
+      unsigned long chosenServed = 0;
+      for (OFListIterator(QueueEntry) it = m_queue.begin(); it != m_queue.end(); ++it)
+      {
+        OFMap<OFString, unsigned long>::iterator served = m_lastServed.find((*it).callingAETitle);
+        const unsigned long lastServed = (served != m_lastServed.end()) ? (*served).second : 0;
+        if ((chosen == m_queue.end()) || (lastServed < chosenServed))
+        {
+          chosen = it;
+          chosenServed = lastServed;
+        }
+      }
+      assoc = (*chosen).assoc;
+      m_lastServed[(*chosen).callingAETitle] = ++m_servedCounter;
+      /* Update statistics */
+      const double waitTime = OFTimer::getTime() - (*chosen).queueTime;
+      m_statistics.totalWaitTime += waitTime;
+      if (waitTime > m_statistics.maxWaitTime)
+        m_statistics.maxWaitTime = waitTime;
+      ++m_statistics.numAssociations;
+      m_queue.erase(chosen);
+      /* Fairness only matters for associations that are waiting */
+      if (m_queue.empty())
+        m_lastServed.clear();
+      if (m_runMode != SHUTDOWN)
+      {
+        m_workersIdle.remove(worker);
+        m_workersBusy.push_back(worker);
+      }
+    }
+    else if (m_runMode == SHUTDOWN)
+    {
+      m_criticalSection.unlock();
+      return OFFalse;
+    }
+    m_criticalSection.unlock();
   }
-  /* Return to listen loop */
-  return result;
+  return OFTrue;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmBaseSCPPool::signalWorkers(const size_t count)
+{
+#ifdef SCPPOOL_USE_SEMAPHORE
+  for (size_t i = 0; i < count; ++i)
+    m_workAvailable->post();
+#else
+  // workers are polling, see waitForWork()
+  (void) count;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmBaseSCPPool::waitForWork()
+{
+#ifdef SCPPOOL_USE_SEMAPHORE
+  m_workAvailable->wait();
+#else
+  OFBool ready = OFFalse;
+  while (!ready)
+  {
+    m_criticalSection.lock();
+    ready = !m_queue.empty() || (m_runMode == SHUTDOWN);
+    m_criticalSection.unlock();
+    if (!ready)
+      OFStandard::milliSleep(10);
+  }
+#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -279,6 +448,7 @@ void DcmBaseSCPPool::notifyThreadExit(DcmBaseSCPPool::DcmBaseSCPWorker* thread,
   {
     DCMNET_DEBUG("DcmBaseSCPPool: Worker thread #" << thread->threadID() << " exited with error: " << result.text());
     m_workersBusy.remove(thread);
+    m_workersIdle.remove(thread);
     delete thread;
     thread = NULL;
   }
@@ -322,18 +492,15 @@ OFCondition DcmBaseSCPPool::DcmBaseSCPWorker::setAssociation(T_ASC_Association*
 void DcmBaseSCPPool::DcmBaseSCPWorker::run()
 {
   OFCondition result;
-  if(!m_assoc)
-  {
-    DCMNET_ERROR("DcmBaseSCPPool: Worker thread #" << threadID() << " received run command but has no association, exiting");
-    m_pool.notifyThreadExit(this, ASC_NULLKEY);
-    thread_exit();
-  }
-  else
+  /* Run the association set before starting the thread (if any) and then
+   * all associations the pool hands over to this worker until shutdown */
+  T_ASC_Association *param = m_assoc;
+  m_assoc = NULL;
+  while ((param != NULL) || m_pool.waitForAssociation(this, param))
   {
-    T_ASC_Association *param = m_assoc;
-    m_assoc = NULL;
     result = workerListen(param);
     DCMNET_DEBUG("DcmBaseSCPPool: Worker thread #" << threadID() << " returns with code: " << result.text() );
+    param = NULL;
   }
   m_pool.notifyThreadExit(this, result);
   thread_exit();
@@ -27,6 +27,7 @@ OFTEST_REGISTER(dcmnet_dimseDump_nullByte);
 
 #ifdef WITH_THREADS
 OFTEST_REGISTER(dcmnet_scp_pool);
+OFTEST_REGISTER(dcmnet_scp_pool_queue);
 #endif // WITH_THREADS
 
 OFTEST_MAIN("dcmnet")
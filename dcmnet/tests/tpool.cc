@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 2013-2014, OFFIS e.V.
+ *  Copyright (C) 2013-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -27,6 +27,7 @@
 #include "dcmtk/ofstd/oftest.h"
 #include "dcmtk/dcmnet/scppool.h"
 #include "dcmtk/dcmnet/scu.h"
+#include "dcmtk/dcmdata/dcdict.h"
 
 struct TestSCU : DcmSCU, OFThread
 {
@@ -58,6 +59,8 @@ protected:
  */
 OFTEST_FLAGS(dcmnet_scp_pool, EF_Slow)
 {
+    // the workers only read the data dictionary, avoid locking it
+    dcmDataDict.freeze();
     TestPool pool;
     DcmSCPConfig& config = pool.getConfig();
 
@@ -108,6 +111,78 @@ OFTEST_FLAGS(dcmnet_scp_pool, EF_Slow)
     pool.join();
 
     OFCHECK(pool.result.good());
+    // all threads have terminated, the other tests might modify the dictionary
+    dcmDataDict.unfreeze();
+}
+
+
+/* Test starts pool with a maximum of 2 SCP workers and a queue for up
+ * to 20 associations. 20 SCU threads connect simultaneously to the pool,
+ * send C-ECHO messages and release the association. All associations
+ * must be accepted and handled by the (reused) two workers.
+ */
+OFTEST_FLAGS(dcmnet_scp_pool_queue, EF_Slow)
+{
+    // the workers only read the data dictionary, avoid locking it
+    dcmDataDict.freeze();
+    TestPool pool;
+    DcmSCPConfig& config = pool.getConfig();
+
+    config.setAETitle("PoolTestSCP");
+    config.setPort(11113);
+    config.setConnectionBlockingMode(DUL_NOBLOCK);
+    config.setConnectionTimeout(1);
+
+    pool.setMaxThreads(2);
+    pool.setMaxQueuedAssociations(20);
+    OFList<OFString> xfers;
+    xfers.push_back(UID_LittleEndianExplicitTransferSyntax);
+    xfers.push_back(UID_LittleEndianImplicitTransferSyntax);
+    config.addPresentationContext(UID_VerificationSOPClass, xfers);
+
+    pool.start();
+
+    OFVector<TestSCU*> scus(20);
+    int i = 0;
+    for (OFVector<TestSCU*>::iterator it1 = scus.begin(); it1 != scus.end(); ++it1)
+    {
+        *it1 = new TestSCU;
+        // use different calling AE titles
+        (*it1)->setAETitle((++i % 2) ? "PoolTestSCU1" : "PoolTestSCU2");
+        (*it1)->setPeerAETitle("PoolTestSCP");
+        (*it1)->setPeerHostName("localhost");
+        (*it1)->setPeerPort(11113);
+        (*it1)->addPresentationContext(UID_VerificationSOPClass, xfers);
+        (*it1)->initNetwork();
+    }
+
+    OFStandard::sleep(5);
+
+    for (OFVector<TestSCU*>::const_iterator it2 = scus.begin(); it2 != scus.end(); ++it2)
+        (*it2)->start();
+
+    for (OFVector<TestSCU*>::iterator it3 = scus.begin(); it3 != scus.end(); ++it3)
+    {
+        (*it3)->join();
+        OFCHECK((*it3)->result.good());
+        delete *it3;
+    }
+
+    // never more than two workers
+    OFCHECK(pool.numThreads(OFFalse) <= 2);
+    DcmBaseSCPPool::QueueStatistics stats = pool.getQueueStatistics();
+    OFCHECK_EQUAL(stats.numAssociations, 20);
+    OFCHECK_EQUAL(stats.numRejected, 0);
+    OFCHECK_EQUAL(stats.currentLength, 0);
+    OFCHECK(stats.maxLength <= 20);
+
+    // Request shutdown.
+    pool.stopAfterCurrentAssociations();
+    pool.join();
+
+    OFCHECK(pool.result.good());
+    // all threads have terminated, the other tests might modify the dictionary
+    dcmDataDict.unfreeze();
 }
 
 #endif // WITH_THREADS
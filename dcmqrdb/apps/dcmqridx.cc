@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2012, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -69,6 +69,8 @@ int main (int argc, char *argv[])
     const char *opt_storageArea = NULL;
     OFBool opt_print = OFFalse;
     OFBool opt_isNewFlag = OFTrue;
+    OFBool opt_createKeyFile = OFFalse;
+    DcmTagKey opt_stopParsingAtElement = DCM_UndefinedTagKey;
 
 #ifdef WITH_TCPWRAPPER
     // this code makes sure that the linker cannot optimize away
@@ -91,6 +93,9 @@ int main (int argc, char *argv[])
      OFLog::addOptions(cmd);
      cmd.addOption("--print",   "-p", "list contents of database index file");
      cmd.addOption("--not-new", "-n", "set instance reviewed status to 'not new'");
+     cmd.addOption("--create-key-file", "-k", "create key file of database index file");
+     cmd.addOption("--stop-before-elem", "+sb", 1, "[t]ag: \"gggg,eeee\" or dictionary name",
+                                                  "stop parsing image files before element\nspecified by t or any following element");
 
 #ifdef HAVE_GUSI_H
     /* needed for Macintosh */
@@ -134,6 +139,20 @@ int main (int argc, char *argv[])
 
         if (cmd.findOption("--not-new"))
             opt_isNewFlag = OFFalse;
+
+        if (cmd.findOption("--create-key-file"))
+            opt_createKeyFile = OFTrue;
+
+        if (cmd.findOption("--stop-before-elem"))
+        {
+            const char *tagName = NULL;
+            app.checkValue(cmd.getValue(tagName));
+            /* tag name has format "gggg,eeee" or is a dictionary name */
+            DcmTag tag;
+            if (DcmTag::findTagFromName(tagName, tag).bad())
+                app.printError("no valid key given for option --stop-before-elem");
+            opt_stopParsingAtElement = tag;
+        }
     }
 
     /* print resource identifier */
@@ -151,6 +170,7 @@ int main (int argc, char *argv[])
     if (cond.good())
     {
         hdl.enableQuotaSystem(OFFalse); /* disable deletion of images */
+        hdl.setStopParsingAtElement(opt_stopParsingAtElement);
         int paramCount = cmd.getParamCount();
         for (int param = 2; param <= paramCount; param++)
         {
@@ -173,12 +193,23 @@ int main (int argc, char *argv[])
                     OFLOG_ERROR(dcmqridxLogger, "cannot load dicom file: " << opt_imageFile);
             }
         }
+        int result = 0;
+        if (opt_createKeyFile)
+        {
+            OFLOG_INFO(dcmqridxLogger, "creating key file of database index file");
+            cond = hdl.createKeyFile();
+            if (cond.bad())
+            {
+                OFLOG_ERROR(dcmqridxLogger, "cannot create key file: " << cond.text());
+                result = 1;
+            }
+        }
         if (opt_print)
         {
             COUT << "-- DB Index File --" << OFendl;
             hdl.printIndexFile(OFconst_cast(char *, opt_storageArea));
         }
-        return 0;
+        return result;
     }
 
     return 1;
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2014, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -122,7 +122,7 @@ main(int argc, char *argv[])
 
   char tempstr[20];
   OFString temp_str;
-#ifdef HAVE_FORK
+#if defined(HAVE_FORK) || defined(WITH_THREADS)
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "DICOM image archive (central test node)", rcsid);
 #else
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "DICOM image archive (central test node)\nThis version of dcmqrscp supports only single process mode.", rcsid);
@@ -151,10 +151,15 @@ main(int argc, char *argv[])
         opt5 += ")";
         cmd.addOption("--config",               "-c",     1, opt5.c_str(), "use specific configuration file");
     }
-#ifdef HAVE_FORK
+#if defined(HAVE_FORK) || defined(WITH_THREADS)
   cmd.addGroup("multi-process options:", LONGCOL, SHORTCOL + 2);
     cmd.addOption("--single-process",           "-s",        "single process mode");
+#ifdef HAVE_FORK
     cmd.addOption("--fork",                                  "fork child process for each assoc. (default)");
+#endif
+#ifdef WITH_THREADS
+    cmd.addOption("--threads",                  "-mt",       "handle each association in a separate thread");
+#endif
 #endif
 
   cmd.addGroup("database options:");
@@ -323,10 +328,27 @@ main(int argc, char *argv[])
       OFLog::configureFromCommandLine(cmd, app);
 
       if (cmd.findOption("--config")) app.checkValue(cmd.getValue(opt_configFileName));
-#ifdef HAVE_FORK
+#if defined(HAVE_FORK) || defined(WITH_THREADS)
       cmd.beginOptionBlock();
-      if (cmd.findOption("--single-process")) options.singleProcess_ = OFTrue;
-      if (cmd.findOption("--fork")) options.singleProcess_ = OFFalse;
+      if (cmd.findOption("--single-process"))
+      {
+        options.singleProcess_ = OFTrue;
+        options.multiThreaded_ = OFFalse;
+      }
+#ifdef HAVE_FORK
+      if (cmd.findOption("--fork"))
+      {
+        options.singleProcess_ = OFFalse;
+        options.multiThreaded_ = OFFalse;
+      }
+#endif
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+      {
+        options.singleProcess_ = OFFalse;
+        options.multiThreaded_ = OFTrue;
+      }
+#endif
       cmd.endOptionBlock();
 #endif
 
@@ -649,6 +671,11 @@ main(int argc, char *argv[])
         << DCM_DICT_ENVIRONMENT_VARIABLE);
     }
 
+#ifdef WITH_THREADS
+    /* the dictionary is not modified any more, avoid locking it in each thread */
+    if (options.multiThreaded_) dcmDataDict.freeze();
+#endif
+
 #ifndef DISABLE_PORT_PERMISSION_CHECK
 #ifdef HAVE_GETEUID
     /* if port is privileged we must be as well */
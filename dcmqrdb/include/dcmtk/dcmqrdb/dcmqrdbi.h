@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2011, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -37,6 +37,7 @@ struct DB_ElementList;
 class DcmQueryRetrieveConfig;
 
 #define DBINDEXFILE "index.dat"
+#define DBKEYFILE "index.key"
 
 #ifndef _WIN32
 /* we lock image files on all platforms except Win32 where it does not work
@@ -256,6 +257,18 @@ public:
    */
   OFCondition pruneInvalidRecords();
 
+  /** create the key file (DBKEYFILE) of the index file in the storage area.
+   *  The key file allows for looking up the records that match a given
+   *  PatientID, AccessionNumber or Study, Series or SOP Instance UID without
+   *  reading the whole index file. It is kept up to date by this class and
+   *  created automatically by the first query if it is missing or does not
+   *  match the index file, e.g. because the index file has been modified by
+   *  an older version of this class. This method can be used to create it
+   *  in advance, e.g. for an existing index file.
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition createKeyFile();
+
   // methods not inherited from the base class
 
   /** enable/disable the DB quota system (default: enabled) which causes images
@@ -263,6 +276,18 @@ public:
    */
   void enableQuotaSystem(OFBool enable);
 
+  /** set the element at which the parsing of image files registered by storeRequest()
+   *  stops (default: none, i.e. the complete file is read).  The element itself and all
+   *  following elements on the main dataset level are not read, e.g. specify the tag of
+   *  the pixel data element in order to avoid reading large images.  Please note that
+   *  the index record will lack all attributes from the part of the file not being read,
+   *  e.g. the values of (0040,A4xx) or (0070,0081) for structured reports and the
+   *  presentation states, as well as the digital signatures (FFFA,FFFA).
+   *  @param tagKey tag of the element at which parsing stops, DCM_UndefinedTagKey to
+   *    read the complete file
+   */
+  void setStopParsingAtElement(const DcmTagKey &tagKey);
+
   /** dump database index file to stdout.
    *  @param storeArea name of storage area, must not be NULL
    */
@@ -313,6 +338,46 @@ public:
    */
   OFCondition DB_IdxRead(int idx, IdxRecord *idxRec);
 
+  /** read index record at given index through the read-ahead block buffer.
+   *  If the record is not contained in the current block, a block of
+   *  consecutive records starting at the given index is read from the
+   *  index file with a single read() call. The block buffer is only valid
+   *  while the database lock is held and is discarded by DB_lock(),
+   *  DB_unlock() and every write to the index file.
+   *  @param idx index
+   *  @param idxRec pointer to index record, links are not initialized
+   *  @param readAhead if true, a block of records is read. Otherwise, only
+   *    the given record is read (unless it is already contained in the block).
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition DB_IdxReadBlock(int idx, IdxRecord *idxRec, OFBool readAhead = OFTrue);
+
+  /** determine the candidate records for the current find or move request
+   *  by means of the key file of the index file, which is created if it does
+   *  not match the index file (see createKeyFile()). The key file is used if
+   *  the request contains a key that is checked by hierarchicalCompare() with
+   *  a single value and without wildcards, i.e. PatientID, AccessionNumber or
+   *  one of the Study, Series or SOP Instance UIDs. Otherwise, there are no
+   *  candidates and all records of the index file have to be checked.
+   *  The database lock must be held when calling this method.
+   *  @param infLevel highest level of the information model, i.e. the level
+   *    at which hierarchicalCompare() starts
+   */
+  void DB_IdxFindCandidates(DB_LEVEL infLevel);
+
+  /** get next index record that is a candidate for the current find or move
+   *  request (see DB_IdxFindCandidates()). If there are no candidates, the
+   *  next record that is in use is returned, i.e. the same as DB_IdxGetNext().
+   *  @param idx pointer to index number, updated upon successful return
+   *  @param idxRec pointer to index record structure
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition DB_IdxGetNextCandidate(int *idx, IdxRecord *idxRec);
+
+  /** discard the contents of the read-ahead block buffer
+   */
+  void DB_IdxInvalidateBlock();
+
   /** get study descriptor record from start of index file
    *  @param pStudyDesc pointer to study record descriptor structure
    *  @return EC_Normal upon success, an error code otherwise
@@ -386,6 +451,9 @@ private:
   /// flag indicating whether or not the quota system is enabled
   OFBool quotaSystemEnabled;
 
+  /// element at which the parsing of image files stops (DCM_UndefinedTagKey = none)
+  DcmTagKey stopParsingAtElement;
+
   /// flag indicating whether or not the check function for FIND requests is enabled
   OFBool doCheckFindIdentifier;
 
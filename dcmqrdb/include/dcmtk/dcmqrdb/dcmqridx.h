@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2011, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -38,6 +38,8 @@ BEGIN_EXTERN_C
 #endif
 END_EXTERN_C
 
+class OFReadWriteLock;
+
 /** types of query keys
  */
 enum DB_KEY_TYPE
@@ -122,6 +124,7 @@ enum DB_KEY_CLASS
 #define MAX_NUMBER_OF_IMAGES    10000
 #define SIZEOF_IDXRECORD        (sizeof (IdxRecord))
 #define SIZEOF_STUDYDESC        (sizeof (StudyDescRecord) * MAX_MAX_STUDIES)
+#define DB_IDXBLOCKSIZE         64      /* records per read-ahead block */
 
 /** this class provides a primitive interface for handling a flat DICOM element,
  *  similar to DcmElement, but only for use within the database module
@@ -211,6 +214,15 @@ struct DCMTK_DCMQRDB_EXPORT DB_Private_Handle
     int NumberRemainOperations ;
     DB_QUERY_CLASS rootLevel ;
     DB_UidList *uidList ;
+    char *idxBlock ;
+    int idxBlockStart ;
+    int idxBlockCount ;
+    OFReadWriteLock *idxLock ;
+    OFBool idxLockHeld ;
+    OFBool findLockHeld ;
+    int *idxCandidates ;
+    int idxCandidateCount ;
+    int idxCandidatePos ;
 
     DB_Private_Handle()
     : pidx(0)
@@ -226,6 +238,15 @@ struct DCMTK_DCMQRDB_EXPORT DB_Private_Handle
     , NumberRemainOperations(0)
     , rootLevel(STUDY_ROOT)
     , uidList(NULL)
+    , idxBlock(NULL)
+    , idxBlockStart(0)
+    , idxBlockCount(0)
+    , idxLock(NULL)
+    , idxLockHeld(OFFalse)
+    , findLockHeld(OFFalse)
+    , idxCandidates(NULL)
+    , idxCandidateCount(0)
+    , idxCandidatePos(0)
     {
     }
 };
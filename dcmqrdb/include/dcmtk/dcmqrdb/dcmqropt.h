@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2012, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -130,6 +130,12 @@ public:
   /// single process mode
   OFBool            singleProcess_;
 
+  /** multi-threaded mode: handle each association in a separate thread
+   *  of this process instead of a child process. Only evaluated if
+   *  singleProcess_ is false and DCMTK has been compiled with thread support.
+   */
+  OFBool            multiThreaded_;
+
   /// support for patient root q/r model
   OFBool            supportPatientRoot_;
 
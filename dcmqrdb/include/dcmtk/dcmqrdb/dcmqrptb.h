@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2011, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -55,7 +55,8 @@ public:
   virtual ~DcmQueryRetrieveProcessTable();
 
   /** adds a new child process to the process table.
-   *  @param pid process ID of the child process
+   *  @param pid process ID of the child process (or a unique number
+   *    identifying the thread in multi-threaded mode)
    *  @param assoc peer hostname and AEtitles are read from this object
    */
   void addProcessToTable(int pid, T_ASC_Association * assoc);
@@ -81,13 +82,13 @@ public:
    */
   OFBool haveProcessWithWriteAccess(const char *calledAETitle) const;
 
-private:
-
   /** remove the process with the given process ID from the table
    *  @param pid process ID
    */
   void removeProcessFromTable(int pid);
 
+private:
+
   /// the list of process entries maintained by this object.
   OFList<DcmQueryRetrieveProcessSlot *> table_;
 };
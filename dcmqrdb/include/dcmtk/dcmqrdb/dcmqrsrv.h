@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2011, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -24,6 +24,7 @@
 
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 #include "dcmtk/ofstd/oftypes.h"
+#include "dcmtk/ofstd/oflist.h"
 #include "dcmtk/dcmnet/assoc.h"
 #include "dcmtk/dcmnet/dimse.h"
 #include "dcmtk/dcmqrdb/dcmqrptb.h"
@@ -32,6 +33,8 @@ class DcmQueryRetrieveConfig;
 class DcmQueryRetrieveOptions;
 class DcmQueryRetrieveDatabaseHandle;
 class DcmQueryRetrieveDatabaseHandleFactory;
+class DcmQueryRetrieveSCPThread;
+class OFMutex;
 
 /// enumeration describing reasons for refusing an association request
 enum CTN_RefuseReason
@@ -66,12 +69,16 @@ public:
     const DcmQueryRetrieveOptions& options,
     const DcmQueryRetrieveDatabaseHandleFactory& factory);
 
-  /// destructor
-  virtual ~DcmQueryRetrieveSCP() { }
+  /** destructor. In multi-threaded mode, waits until all threads
+   *  handling associations have terminated.
+   */
+  virtual ~DcmQueryRetrieveSCP();
 
   /** wait for incoming A-ASSOCIATE requests, perform association negotiation
-   *  and serve the requests. May fork child processes depending on availability
-   *  of the fork() system function and configuration options.
+   *  and serve the requests. May fork child processes or start threads
+   *  depending on availability of the fork() system function, thread support
+   *  and configuration options. In multi-threaded mode, all associations share
+   *  the configuration and the database handle factory of this object.
    *  @param theNet network structure for listen socket
    *  @return EC_Normal if successful, an error code otherwise
    */
@@ -85,7 +92,8 @@ public:
     OFBool dbCheckFindIdentifier,
     OFBool dbCheckMoveIdentifier);
 
-  /** clean up terminated child processes.
+  /** clean up terminated child processes or, in multi-threaded mode,
+   *  terminated threads.
    */
   void cleanChildren();
 
@@ -147,12 +155,49 @@ private:
 
   static void refuseAnyStorageContexts(T_ASC_Association *assoc);
 
+  /** check whether associations are handled in separate threads
+   *  @return OFTrue if multi-threaded mode is enabled and available
+   */
+  OFBool multiThreaded() const;
+
+  /** start a new thread that handles the given association (multi-threaded
+   *  mode only). Upon success, the thread takes over the association.
+   *  @param assoc association to be handled
+   *  @return EC_Normal if successful, an error code otherwise
+   */
+  OFCondition startAssociationThread(T_ASC_Association *assoc);
+
+  /** handle the given association and remove the calling thread from
+   *  the process table afterwards. Called by DcmQueryRetrieveSCPThread.
+   *  @param assoc association to be handled
+   *  @param threadID number identifying the thread in the process table
+   */
+  void handleAssociationInThread(T_ASC_Association *assoc, int threadID);
+
+  /// lock the mutex protecting the process table (multi-threaded mode only)
+  void lockProcessTable();
+
+  /// unlock the mutex protecting the process table (multi-threaded mode only)
+  void unlockProcessTable();
+
+  /// the thread class needs access to handleAssociationInThread()
+  friend class DcmQueryRetrieveSCPThread;
+
   /// configuration facility
   const DcmQueryRetrieveConfig *config_;
 
-  /// child process table, only used in multi-processing mode
+  /// child process table, only used in multi-processing and multi-threaded mode
   DcmQueryRetrieveProcessTable processtable_;
 
+  /// mutex protecting processtable_ and threads_, only used in multi-threaded mode
+  OFMutex *threadMutex_;
+
+  /// threads handling associations, only used in multi-threaded mode
+  OFList<DcmQueryRetrieveSCPThread *> threads_;
+
+  /// number identifying the next thread in the process table
+  int nextThreadID_;
+
   /// flag for database interface: check C-FIND identifier
   OFBool dbCheckFindIdentifier_;
 
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2014, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -36,6 +36,8 @@ END_EXTERN_C
 
 #define INCLUDE_CCTYPE
 #define INCLUDE_CSTDARG
+#define INCLUDE_CSTDLIB
+#define INCLUDE_CTIME
 #include "dcmtk/ofstd/ofstdinc.h"
 
 #include "dcmtk/dcmqrdb/dcmqrdbs.h"
@@ -47,6 +49,9 @@ END_EXTERN_C
 #include "dcmtk/dcmnet/diutil.h"
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofmap.h"
+#include "dcmtk/ofstd/ofvector.h"
 
 /* ========================= static data ========================= */
 
@@ -109,8 +114,274 @@ static const DB_FindAttr TbFindAttr [] = {
 
 static int NbFindAttr = ((sizeof (TbFindAttr)) / (sizeof (TbFindAttr [0])));
 
+#ifdef WITH_THREADS
+
+/**** In the multi-threaded mode of the Query/Retrieve SCP, several handles
+ **** for the same index file exist within one process. Depending on the
+ **** platform, file locks do not synchronize the threads of a process
+ **** (e.g. if flock() is emulated using fcntl()). Therefore, each index file
+ **** is additionally protected by a read/write lock that is shared by all
+ **** handles of the process. Shared locks still allow for parallel queries.
+ **** A C-FIND only holds its lock while searching the index file, not while
+ **** the responses are sent, unless the records are looked up in the key file
+ **** (see DB_KeyFile). In this case, and for a C-MOVE or C-GET, the shared
+ **** lock is kept until all matches have been found or all sub-operations are
+ **** complete, since the records are read again by their position and must
+ **** not be replaced in the meantime.
+ ***/
+
+class DB_IndexLockTable
+{
+public:
+    DB_IndexLockTable() : mutex_(), locks_() { }
+
+    ~DB_IndexLockTable()
+    {
+        OFMap<OFString, OFReadWriteLock *>::iterator it = locks_.begin();
+        while (it != locks_.end())
+        {
+            delete (*it).second;
+            ++it;
+        }
+    }
+
+    /* get the lock for the given index file, create it if necessary */
+    OFReadWriteLock *getLock(const char *indexFilename)
+    {
+        mutex_.lock();
+        OFReadWriteLock *& lock = locks_[indexFilename];
+        if (lock == NULL) lock = new OFReadWriteLock();
+        OFReadWriteLock *result = lock;
+        mutex_.unlock();
+        return result;
+    }
+
+private:
+    DB_IndexLockTable(const DB_IndexLockTable&);
+    DB_IndexLockTable& operator=(const DB_IndexLockTable&);
+
+    OFMutex mutex_;
+    OFMap<OFString, OFReadWriteLock *> locks_;
+};
+
+static DB_IndexLockTable DB_indexLockTable;
+
+#endif
+
+/**** The key file allows for looking up the records of the index file
+ **** that match a given PatientID, AccessionNumber or Study, Series or
+ **** SOP Instance UID without reading the whole index file. For each of
+ **** these keys, it contains the hash values of the stored values together
+ **** with the record numbers, sorted by hash value, so that a lookup only
+ **** needs a binary search. Since different values may have the same hash
+ **** value, the records found are only candidates that still have to be
+ **** compared with the query keys. Records added later are appended to an
+ **** unsorted tail, which is merged into the sorted part when it is full.
+ **** Entries of removed records are kept until the key file is created
+ **** again, they only cause additional comparisons.
+ **** The key file is stored next to the index file and only accessed while
+ **** the index file is locked. It records the size, modification time and
+ **** i-node of the index file it describes. If these do not match, e.g.
+ **** because the index file has been modified by an older version of this
+ **** module, the key file is created again by the next query.
+ ***/
+
+#define DB_NUMBER_OF_INDEXED_KEYS 5
+#define DB_KEYFILE_MAGIC "DCMQRKEY"
+#define DB_KEYFILE_VERSION 1
+#define DB_KEYFILE_MAXTAIL 1024     /* maximum number of unsorted records */
+
+static const DcmTagKey DB_IndexedKeyTags[DB_NUMBER_OF_INDEXED_KEYS] = {
+    DCM_PatientID,
+    DCM_AccessionNumber,
+    DCM_StudyInstanceUID,
+    DCM_SeriesInstanceUID,
+    DCM_SOPInstanceUID
+};
+
+static const int DB_IndexedKeyParams[DB_NUMBER_OF_INDEXED_KEYS] = {
+    RECORDIDX_PatientID,
+    RECORDIDX_AccessionNumber,
+    RECORDIDX_StudyInstanceUID,
+    RECORDIDX_SeriesInstanceUID,
+    RECORDIDX_SOPInstanceUID
+};
+
+/* entry of the sorted part of the key file */
+struct DB_KeyIndexEntry
+{
+    Uint32 hash ;
+    Sint32 idx ;
+};
+
+/* entry of the unsorted tail of the key file, one per record */
+struct DB_KeyFileTailEntry
+{
+    Sint32 idx ;
+    Uint32 hash [DB_NUMBER_OF_INDEXED_KEYS] ;
+};
+
+/* header of the key file. It is followed by the sorted entries of each key
+ * (sortedCount entries per key) and by the tail (tailCount entries).
+ */
+struct DB_KeyFileHeader
+{
+    char magic [8] ;
+    Uint32 version ;
+    Uint32 sortedCount ;
+    Uint32 tailCount ;
+    Uint32 removedCount ;
+    off_t indexSize ;
+    time_t indexMtime ;
+    ino_t indexIno ;
+};
+
+class DB_KeyFile
+{
+public:
+    DB_KeyFile(DB_Private_Handle *phandle);
+    ~DB_KeyFile();
+
+    /* open the key file and check whether it describes the current state of
+     * the index file. Only a key file opened for writing can be updated.
+     */
+    OFBool open(OFBool writable);
+
+    /* determine the entries of all records by reading the index file.
+     * They are used by lookup() instead of the key file.
+     */
+    OFCondition scan();
+
+    /* write the entries determined by scan() to the key file */
+    OFCondition save();
+
+    /* append the numbers of the records whose key (index into
+     * DB_IndexedKeyTags) has the given hash value
+     */
+    void lookup(int key, Uint32 hash, OFVector<int>& result);
+
+    /* check whether a lookup failed, e.g. because the key file could not be read */
+    OFBool failed() const { return failed_; }
+
+    /* update the key file after the index file has been modified. If idxRec
+     * is given, it has been stored at position idx, otherwise the record at
+     * position idx (if not negative) has been removed. The key file is closed.
+     */
+    void update(int idx, const IdxRecord *idxRec);
+
+private:
+    DB_KeyFile(const DB_KeyFile&);
+    DB_KeyFile& operator=(const DB_KeyFile&);
+
+    void closeFile();
+    OFBool readAt(off_t offset, void *buffer, size_t length);
+    OFBool writeAt(off_t offset, const void *buffer, size_t length);
+    OFBool readTail();
+    void sortEntries();
+    void merge(const DB_KeyFileTailEntry& entry);
+
+    off_t sortedOffset(int key) const
+    {
+        return (off_t) sizeof (DB_KeyFileHeader) + (off_t) key * header_.sortedCount * sizeof (DB_KeyIndexEntry);
+    }
+
+    DB_Private_Handle *handle_;
+    OFString filename_;
+    int fd_;
+    DB_KeyFileHeader header_;
+    OFBool failed_;
+    OFBool tailRead_;
+    OFVector<DB_KeyFileTailEntry> tail_;
+    OFBool inMemory_;
+    Uint32 removedCount_;
+    OFVector<DB_KeyIndexEntry> entries_[DB_NUMBER_OF_INDEXED_KEYS];
+};
+
 /* ========================= static functions ========================= */
 
+/************
+**      Compute the hash value of a key value (FNV-1a). Like the matching
+**      functions, enclosing spaces are ignored unless STRICT_COMPARE is defined.
+**/
+
+static Uint32 DB_KeyHash (const char *value, size_t length)
+{
+#ifndef STRICT_COMPARE
+    while ((length > 0) && (*value == ' ')) {
+        value++ ;
+        length-- ;
+    }
+    while ((length > 0) && (value [length - 1] == ' '))
+        length-- ;
+#endif
+    Uint32 hash = 2166136261UL ;
+    for (size_t i = 0 ; i < length ; i++) {
+        hash ^= (Uint8) value [i] ;
+        hash *= 16777619UL ;
+    }
+    return hash ;
+}
+
+/************
+**      Length of a key value, which ends at the first NUL character
+**/
+
+static size_t DB_KeyLength (const char *value, size_t maxLength)
+{
+    const char *end = (const char *) memchr (value, '\0', maxLength) ;
+    return (end == NULL) ? maxLength : (size_t) (end - value) ;
+}
+
+/************
+**      Order of the key index entries: by hash value, then by record number
+**/
+
+static int DB_KeyIndexEntryCompare (const void *e1, const void *e2)
+{
+    const DB_KeyIndexEntry *entry1 = (const DB_KeyIndexEntry *) e1 ;
+    const DB_KeyIndexEntry *entry2 = (const DB_KeyIndexEntry *) e2 ;
+    if (entry1->hash != entry2->hash)
+        return (entry1->hash < entry2->hash) ? -1 : 1 ;
+    if (entry1->idx != entry2->idx)
+        return (entry1->idx < entry2->idx) ? -1 : 1 ;
+    return 0 ;
+}
+
+/************
+**      Order of record numbers
+**/
+
+static int DB_IdxCompare (const void *i1, const void *i2)
+{
+    const int idx1 = *(const int *) i1 ;
+    const int idx2 = *(const int *) i2 ;
+    return (idx1 < idx2) ? -1 : ((idx1 > idx2) ? 1 : 0) ;
+}
+
+/************
+**      Append the record numbers with the given hash value to a list
+**/
+
+static void DB_KeyIndexLookup (const OFVector<DB_KeyIndexEntry>& entries, Uint32 hash, OFVector<int>& result)
+{
+    /*** Binary search for the first entry with this hash value
+    **/
+
+    size_t lower = 0 ;
+    size_t upper = entries.size () ;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2 ;
+        if (entries [middle]. hash < hash)
+            lower = middle + 1 ;
+        else
+            upper = middle ;
+    }
+    while ((lower < entries.size ()) && (entries [lower]. hash == hash)) {
+        result.push_back (entries [lower]. idx) ;
+        lower++ ;
+    }
+}
+
 static char *DB_strdup(const char* str)
 {
     if (str == NULL) return NULL;
@@ -434,6 +705,338 @@ static long DB_lseek(int fildes, long offset, int whence)
     return pos;
 }
 
+/******************************
+ *      Compute the hash values of the indexed keys of a record
+ */
+
+static void DB_KeyHashRecord (const IdxRecord *idxRec, Uint32 *hash)
+{
+    for (int k = 0 ; k < DB_NUMBER_OF_INDEXED_KEYS ; k++) {
+        const DB_SmallDcmElmt *elt = &idxRec -> param [DB_IndexedKeyParams [k]] ;
+        hash [k] = DB_KeyHash (elt -> PValueField, DB_KeyLength (elt -> PValueField, elt -> ValueLength)) ;
+    }
+}
+
+/******************************
+ *      Key file of the index file, see declaration of DB_KeyFile
+ */
+
+DB_KeyFile::DB_KeyFile(DB_Private_Handle *phandle)
+: handle_(phandle)
+, filename_(phandle->storageArea)
+, fd_(-1)
+, header_()
+, failed_(OFFalse)
+, tailRead_(OFFalse)
+, tail_()
+, inMemory_(OFFalse)
+, removedCount_(0)
+{
+    filename_ += PATH_SEPARATOR;
+    filename_ += DBKEYFILE;
+    memset(&header_, 0, sizeof(header_));
+}
+
+DB_KeyFile::~DB_KeyFile()
+{
+    closeFile();
+}
+
+void DB_KeyFile::closeFile()
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+    fd_ = -1;
+    tailRead_ = OFFalse;
+    tail_.clear();
+}
+
+OFBool DB_KeyFile::readAt(off_t offset, void *buffer, size_t length)
+{
+    return (lseek(fd_, offset, SEEK_SET) == offset) &&
+        ((size_t) ::read(fd_, (char *) buffer, length) == length);
+}
+
+OFBool DB_KeyFile::writeAt(off_t offset, const void *buffer, size_t length)
+{
+    return (lseek(fd_, offset, SEEK_SET) == offset) &&
+        ((size_t) ::write(fd_, (const char *) buffer, length) == length);
+}
+
+OFBool DB_KeyFile::open(OFBool writable)
+{
+    closeFile();
+    inMemory_ = OFFalse;
+    struct stat st;
+    struct stat keySt;
+    if (fstat(handle_->pidx, &st) != 0)
+        return OFFalse;
+#ifdef O_BINARY
+    fd_ = ::open(filename_.c_str(), (writable ? O_RDWR : O_RDONLY) | O_BINARY);
+#else
+    fd_ = ::open(filename_.c_str(), writable ? O_RDWR : O_RDONLY);
+#endif
+    if (fd_ < 0)
+        return OFFalse;
+
+    /* the key file must describe the current state of the index file, and
+     * its size must match the header (e.g. after an interrupted update)
+     */
+    if (!readAt(0, &header_, sizeof(header_)) || (fstat(fd_, &keySt) != 0) ||
+        (memcmp(header_.magic, DB_KEYFILE_MAGIC, sizeof(header_.magic)) != 0) ||
+        (header_.version != DB_KEYFILE_VERSION) ||
+        (header_.indexSize != st.st_size) || (header_.indexMtime != st.st_mtime) || (header_.indexIno != st.st_ino) ||
+        (keySt.st_size != sortedOffset(DB_NUMBER_OF_INDEXED_KEYS) + (off_t) header_.tailCount * sizeof(DB_KeyFileTailEntry)))
+    {
+        DCMQRDB_DEBUG("DB_KeyFile: " << filename_ << " does not match the index file");
+        closeFile();
+        return OFFalse;
+    }
+    return OFTrue;
+}
+
+OFCondition DB_KeyFile::scan()
+{
+    closeFile();
+    struct stat st;
+    if (fstat(handle_->pidx, &st) != 0)
+        return QR_EC_IndexDatabaseError;
+    char *block = (char *) malloc(DB_IDXBLOCKSIZE * SIZEOF_IDXRECORD);
+    if (block == NULL)
+        return QR_EC_IndexDatabaseError;
+
+    /* reserve the maximum number of entries, OFVector::push_back() is slow for large vectors */
+    size_t count = 0;
+    if (st.st_size > (off_t) SIZEOF_STUDYDESC)
+        count = (size_t) ((st.st_size - SIZEOF_STUDYDESC) / SIZEOF_IDXRECORD);
+    int k;
+    for (k = 0; k < DB_NUMBER_OF_INDEXED_KEYS; k++)
+        entries_[k].resize(count);
+
+    IdxRecord idxRec;
+    Uint32 hash[DB_NUMBER_OF_INDEXED_KEYS];
+    size_t used = 0;
+    Sint32 idx = 0;
+    long bytesRead;
+    DB_lseek(handle_->pidx, (long) SIZEOF_STUDYDESC, SEEK_SET);
+    while ((bytesRead = read(handle_->pidx, block, DB_IDXBLOCKSIZE * SIZEOF_IDXRECORD)) >= (long) SIZEOF_IDXRECORD) {
+        for (long i = 0; i < bytesRead / (long) SIZEOF_IDXRECORD; i++, idx++) {
+            memcpy((void *) &idxRec, block + i * SIZEOF_IDXRECORD, SIZEOF_IDXRECORD);
+            if ((idxRec.filename[0] == '\0') || (used >= count))
+                continue;
+            DB_IdxInitRecord(&idxRec, 1);
+            DB_KeyHashRecord(&idxRec, hash);
+            for (k = 0; k < DB_NUMBER_OF_INDEXED_KEYS; k++) {
+                entries_[k][used].hash = hash[k];
+                entries_[k][used].idx = idx;
+            }
+            used++;
+        }
+    }
+    DB_lseek(handle_->pidx, 0L, SEEK_SET);
+    free(block);
+
+    for (k = 0; k < DB_NUMBER_OF_INDEXED_KEYS; k++)
+        entries_[k].resize(used);
+    sortEntries();
+    inMemory_ = OFTrue;
+    removedCount_ = 0;
+    return EC_Normal;
+}
+
+void DB_KeyFile::sortEntries()
+{
+    for (int k = 0; k < DB_NUMBER_OF_INDEXED_KEYS; k++)
+        if (!entries_[k].empty())
+            qsort(&entries_[k][0], entries_[k].size(), sizeof(DB_KeyIndexEntry), DB_KeyIndexEntryCompare);
+}
+
+OFCondition DB_KeyFile::save()
+{
+    closeFile();
+    struct stat st;
+    if (fstat(handle_->pidx, &st) != 0)
+        return QR_EC_IndexDatabaseError;
+    DB_KeyFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DB_KEYFILE_MAGIC, sizeof(header.magic));
+    header.version = DB_KEYFILE_VERSION;
+    header.sortedCount = (Uint32) entries_[0].size();
+    header.removedCount = removedCount_;
+    header.indexSize = st.st_size;
+    header.indexMtime = st.st_mtime;
+    header.indexIno = st.st_ino;
+
+    /* write a temporary file first, other processes may read the key file
+     * at the same time (while holding a shared lock on the index file)
+     */
+    char suffix[64];
+    sprintf(suffix, ".%ld.%lu", OFStandard::getProcessID(), (unsigned long) OFreinterpret_cast(OFuintptr_t, this));
+    OFString tempFilename = filename_ + suffix;
+#ifdef O_BINARY
+    int fd = ::open(tempFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+#else
+    int fd = ::open(tempFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#endif
+    OFBool ok = (fd >= 0);
+    if (ok) {
+        ok = ((size_t) ::write(fd, (const char *) &header, sizeof(header)) == sizeof(header));
+        for (int k = 0; ok && (k < DB_NUMBER_OF_INDEXED_KEYS); k++) {
+            const size_t length = entries_[k].size() * sizeof(DB_KeyIndexEntry);
+            if (length > 0)
+                ok = ((size_t) ::write(fd, (const char *) &entries_[k][0], length) == length);
+        }
+        ok = (::close(fd) == 0) && ok;
+    }
+    if (ok && (rename(tempFilename.c_str(), filename_.c_str()) != 0)) {
+        /* rename() does not replace an existing file on all platforms */
+        unlink(filename_.c_str());
+        ok = (rename(tempFilename.c_str(), filename_.c_str()) == 0);
+    }
+    if (!ok) {
+        char buf[256];
+        DCMQRDB_WARN("DB_KeyFile: cannot write " << filename_ << ": " << OFStandard::strerror(errno, buf, sizeof(buf)));
+        unlink(tempFilename.c_str());
+        return QR_EC_IndexDatabaseError;
+    }
+    return EC_Normal;
+}
+
+OFBool DB_KeyFile::readTail()
+{
+    if (!tailRead_) {
+        tail_.resize(header_.tailCount);
+        if (!tail_.empty() &&
+            !readAt(sortedOffset(DB_NUMBER_OF_INDEXED_KEYS), &tail_[0], tail_.size() * sizeof(DB_KeyFileTailEntry)))
+            return OFFalse;
+        tailRead_ = OFTrue;
+    }
+    return OFTrue;
+}
+
+void DB_KeyFile::lookup(int key, Uint32 hash, OFVector<int>& result)
+{
+    if (inMemory_) {
+        DB_KeyIndexLookup(entries_[key], hash, result);
+        return;
+    }
+    if ((fd_ < 0) || failed_) {
+        failed_ = OFTrue;
+        return;
+    }
+
+    /* binary search for the first entry with this hash value */
+    const off_t base = sortedOffset(key);
+    DB_KeyIndexEntry entry;
+    size_t lower = 0;
+    size_t upper = header_.sortedCount;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (!readAt(base + (off_t) (middle * sizeof(entry)), &entry, sizeof(entry))) {
+            failed_ = OFTrue;
+            return;
+        }
+        if (entry.hash < hash)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    while (lower < header_.sortedCount) {
+        if (!readAt(base + (off_t) (lower * sizeof(entry)), &entry, sizeof(entry))) {
+            failed_ = OFTrue;
+            return;
+        }
+        if (entry.hash != hash)
+            break;
+        result.push_back(entry.idx);
+        lower++;
+    }
+
+    /* the tail is searched sequentially */
+    if (!readTail()) {
+        failed_ = OFTrue;
+        return;
+    }
+    for (size_t i = 0; i < tail_.size(); i++)
+        if (tail_[i].hash[key] == hash)
+            result.push_back(tail_[i].idx);
+}
+
+void DB_KeyFile::update(int idx, const IdxRecord *idxRec)
+{
+    /* a key file that did not match before is created again by the next query */
+    if (fd_ < 0)
+        return;
+    struct stat st;
+    OFBool ok = (fstat(handle_->pidx, &st) == 0);
+    if (ok && (idxRec != NULL)) {
+        DB_KeyFileTailEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.idx = idx;
+        DB_KeyHashRecord(idxRec, entry.hash);
+        if (header_.tailCount >= DB_KEYFILE_MAXTAIL) {
+            merge(entry);
+            return;
+        }
+        ok = writeAt(sortedOffset(DB_NUMBER_OF_INDEXED_KEYS) + (off_t) header_.tailCount * sizeof(entry), &entry, sizeof(entry));
+        header_.tailCount++;
+    }
+    else if (idx >= 0)
+        header_.removedCount++;
+
+    /* the header is written last, so an interrupted update leaves a key file
+     * that does not match the index file
+     */
+    if (ok) {
+        header_.indexSize = st.st_size;
+        header_.indexMtime = st.st_mtime;
+        header_.indexIno = st.st_ino;
+        ok = writeAt(0, &header_, sizeof(header_));
+    }
+    if (!ok)
+        DCMQRDB_WARN("DB_KeyFile: cannot update " << filename_);
+    closeFile();
+}
+
+void DB_KeyFile::merge(const DB_KeyFileTailEntry& entry)
+{
+    OFCondition result = EC_Normal;
+    if (header_.removedCount > header_.sortedCount / 2) {
+
+        /* many entries belong to removed records, read the index file again */
+        result = scan();
+    }
+    else {
+        const size_t count = header_.sortedCount + header_.tailCount + 1;
+        OFBool ok = readTail();
+        int k;
+        for (k = 0; ok && (k < DB_NUMBER_OF_INDEXED_KEYS); k++) {
+            entries_[k].resize(count);
+            if (header_.sortedCount > 0)
+                ok = readAt(sortedOffset(k), &entries_[k][0], header_.sortedCount * sizeof(DB_KeyIndexEntry));
+            size_t pos = header_.sortedCount;
+            for (size_t i = 0; i < tail_.size(); i++, pos++) {
+                entries_[k][pos].hash = tail_[i].hash[k];
+                entries_[k][pos].idx = tail_[i].idx;
+            }
+            entries_[k][pos].hash = entry.hash[k];
+            entries_[k][pos].idx = entry.idx;
+        }
+        if (ok) {
+            sortEntries();
+            inMemory_ = OFTrue;
+            removedCount_ = header_.removedCount;
+        }
+        else
+            result = QR_EC_IndexDatabaseError;
+    }
+    if (result.good())
+        result = save();
+    if (result.bad())
+        DCMQRDB_WARN("DB_KeyFile: cannot merge " << filename_);
+    closeFile();
+}
+
 /******************************
  *      Read an Index record
  */
@@ -441,26 +1044,74 @@ static long DB_lseek(int fildes, long offset, int whence)
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxRead (int idx, IdxRecord *idxRec)
 {
 
-    /*** Goto the right index in file
+    /*** Read the record (from the read-ahead block if possible)
     **/
 
-    DB_lseek (handle_ -> pidx, (long) (SIZEOF_STUDYDESC + idx * SIZEOF_IDXRECORD), SEEK_SET) ;
+    if (DB_IdxReadBlock (idx, idxRec, OFFalse) != EC_Normal)
+        return (QR_EC_IndexDatabaseError) ;
 
-    /*** Read the record
+    /*** Initialize record links
     **/
 
-    if (read (handle_ -> pidx, (char *) idxRec, SIZEOF_IDXRECORD) != SIZEOF_IDXRECORD)
+    DB_IdxInitRecord (idxRec, 1) ;
+    return EC_Normal ;
+}
+
+
+/******************************
+ *      Read an Index record through the read-ahead block buffer
+ *
+ * Motivation:
+ * Sequential scans of the index file during C-FIND and C-MOVE used to issue
+ * one read() and several lseek() calls per record. Reading a whole block of
+ * records at once reduces the number of system calls by a factor of
+ * DB_IDXBLOCKSIZE. The block is only trusted while we hold the lock.
+ * Random accesses only read the requested record.
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxReadBlock (int idx, IdxRecord *idxRec, OFBool readAhead)
+{
+    if (idx < 0)
         return (QR_EC_IndexDatabaseError) ;
 
-    DB_lseek (handle_ -> pidx, 0L, SEEK_SET) ;
+    if ((idx < handle_ -> idxBlockStart) || (idx >= handle_ -> idxBlockStart + handle_ -> idxBlockCount)) {
 
-    /*** Initialize record links
-    **/
+        /*** Allocate block buffer on first use
+        **/
 
-    DB_IdxInitRecord (idxRec, 1) ;
+        if (handle_ -> idxBlock == NULL) {
+            handle_ -> idxBlock = (char *) malloc (DB_IDXBLOCKSIZE * SIZEOF_IDXRECORD) ;
+            if (handle_ -> idxBlock == NULL)
+                return (QR_EC_IndexDatabaseError) ;
+        }
+
+        /*** Read as many consecutive records as possible, starting at idx
+        **/
+
+        handle_ -> idxBlockStart = idx ;
+        handle_ -> idxBlockCount = 0 ;
+        DB_lseek (handle_ -> pidx, (long) (SIZEOF_STUDYDESC + idx * SIZEOF_IDXRECORD), SEEK_SET) ;
+        long bytesRead = read (handle_ -> pidx, handle_ -> idxBlock, (readAhead ? DB_IDXBLOCKSIZE : 1) * SIZEOF_IDXRECORD) ;
+        DB_lseek (handle_ -> pidx, 0L, SEEK_SET) ;
+        if (bytesRead < (long) SIZEOF_IDXRECORD)
+            return (QR_EC_IndexDatabaseError) ;
+        handle_ -> idxBlockCount = (int) (bytesRead / SIZEOF_IDXRECORD) ;
+    }
+
+    memcpy ((void *) idxRec, handle_ -> idxBlock + (idx - handle_ -> idxBlockStart) * SIZEOF_IDXRECORD, SIZEOF_IDXRECORD) ;
     return EC_Normal ;
 }
 
+/******************************
+ *      Discard the read-ahead block buffer
+ */
+
+void DcmQueryRetrieveIndexDatabaseHandle::DB_IdxInvalidateBlock ()
+{
+    handle_ -> idxBlockStart = 0 ;
+    handle_ -> idxBlockCount = 0 ;
+}
+
 
 /******************************
  *      Add an Index record
@@ -478,6 +1129,14 @@ static OFCondition DB_IdxAdd (DB_Private_Handle *phandle, int *idx, IdxRecord *i
 
     *idx = 0 ;
 
+    /*** The read-ahead block will be outdated after the write below
+    **/
+
+    phandle -> idxBlockCount = 0 ;
+
+    DB_KeyFile keyFile (phandle) ;
+    keyFile. open (OFTrue) ;
+
     DB_lseek (phandle -> pidx, (long) SIZEOF_STUDYDESC, SEEK_SET) ;
     while (read (phandle -> pidx, (char *) &rec, SIZEOF_IDXRECORD) == SIZEOF_IDXRECORD) {
         if (rec. filename [0] == '\0')
@@ -496,6 +1155,8 @@ static OFCondition DB_IdxAdd (DB_Private_Handle *phandle, int *idx, IdxRecord *i
         cond = EC_Normal ;
 
     DB_lseek (phandle -> pidx, 0L, SEEK_SET) ;
+    if (cond. good ())
+        keyFile. update (*idx, idxRec) ;
 
     return cond ;
 }
@@ -508,10 +1169,13 @@ static OFCondition DB_IdxAdd (DB_Private_Handle *phandle, int *idx, IdxRecord *i
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_StudyDescChange(StudyDescRecord *pStudyDesc)
 {
     OFCondition cond = EC_Normal;
+    DB_KeyFile keyFile (handle_) ;
+    keyFile. open (OFTrue) ;
     DB_lseek (handle_ -> pidx, 0L, SEEK_SET) ;
     if (write (handle_ -> pidx, (char *) pStudyDesc, SIZEOF_STUDYDESC) != SIZEOF_STUDYDESC)
         cond = QR_EC_IndexDatabaseError;
     DB_lseek (handle_ -> pidx, 0L, SEEK_SET) ;
+    keyFile. update (-1, NULL) ;
     return cond ;
 }
 
@@ -535,8 +1199,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxGetNext(int *idx, IdxReco
 {
 
     (*idx)++ ;
-    DB_lseek (handle_ -> pidx, SIZEOF_STUDYDESC + (long)(*idx) * SIZEOF_IDXRECORD, SEEK_SET) ;
-    while (read (handle_ -> pidx, (char *) idxRec, SIZEOF_IDXRECORD) == SIZEOF_IDXRECORD) {
+    while (DB_IdxReadBlock (*idx, idxRec) == EC_Normal) {
         if (idxRec -> filename [0] != '\0') {
             DB_IdxInitRecord (idxRec, 1) ;
 
@@ -545,7 +1208,33 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxGetNext(int *idx, IdxReco
         (*idx)++ ;
     }
 
-    DB_lseek (handle_ -> pidx, 0L, SEEK_SET) ;
+    return QR_EC_IndexDatabaseError ;
+}
+
+
+/******************************
+ *      Get next Index record that is a candidate for the current request
+ *      On return, idx is initialized with the index of the record read
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxGetNextCandidate(int *idx, IdxRecord *idxRec)
+{
+    if (handle_ -> idxCandidates == NULL)
+        return DB_IdxGetNext (idx, idxRec) ;
+
+    while (handle_ -> idxCandidatePos < handle_ -> idxCandidateCount) {
+        *idx = handle_ -> idxCandidates [handle_ -> idxCandidatePos++] ;
+
+        /*** Only read ahead if the next candidate is part of the block
+        **/
+
+        OFBool readAhead = (handle_ -> idxCandidatePos < handle_ -> idxCandidateCount) &&
+            (handle_ -> idxCandidates [handle_ -> idxCandidatePos] < *idx + DB_IDXBLOCKSIZE) ;
+        if ((DB_IdxReadBlock (*idx, idxRec, readAhead) == EC_Normal) && (idxRec -> filename [0] != '\0')) {
+            DB_IdxInitRecord (idxRec, 1) ;
+            return EC_Normal ;
+        }
+    }
 
     return QR_EC_IndexDatabaseError ;
 }
@@ -579,6 +1268,9 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxRemove(int idx)
     IdxRecord   rec ;
     OFCondition cond = EC_Normal;
 
+    DB_IdxInvalidateBlock () ;
+    DB_KeyFile keyFile (handle_) ;
+    keyFile. open (OFTrue) ;
     DB_lseek (handle_ -> pidx, SIZEOF_STUDYDESC + (long)idx * SIZEOF_IDXRECORD, SEEK_SET) ;
     DB_IdxInitRecord (&rec, 0) ;
 
@@ -589,6 +1281,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxRemove(int idx)
         cond = QR_EC_IndexDatabaseError ;
 
     DB_lseek (handle_ -> pidx, 0L, SEEK_SET) ;
+    keyFile. update (idx, NULL) ;
 
     return cond ;
 }
@@ -597,13 +1290,38 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_lock(OFBool exclusive)
 {
     int lockmode;
 
+    /* another process may have modified the index file since we last read it */
+    DB_IdxInvalidateBlock();
+
     if (exclusive) {
         lockmode = LOCK_EX;     /* exclusive lock */
     } else {
         lockmode = LOCK_SH;     /* shared lock */
     }
+#ifdef WITH_THREADS
+    /* synchronize with other handles of this process, see DB_IndexLockTable.
+     * Like flock(), a lock that is already held is replaced.
+     */
+    if (handle_->idxLockHeld) {
+        handle_->idxLock->unlock();
+        handle_->idxLockHeld = OFFalse;
+    }
+    if (handle_->idxLock) {
+        if ((exclusive ? handle_->idxLock->wrlock() : handle_->idxLock->rdlock()) != 0) {
+            DCMQRDB_ERROR("DB_lock: cannot lock index file within process");
+            return QR_EC_IndexDatabaseError;
+        }
+        handle_->idxLockHeld = OFTrue;
+    }
+#endif
     if (dcmtk_flock(handle_->pidx, lockmode) < 0) {
         dcmtk_plockerr("DB_lock");
+#ifdef WITH_THREADS
+        if (handle_->idxLockHeld) {
+            handle_->idxLock->unlock();
+            handle_->idxLockHeld = OFFalse;
+        }
+#endif
         return QR_EC_IndexDatabaseError;
     }
     return EC_Normal;
@@ -611,11 +1329,19 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_lock(OFBool exclusive)
 
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_unlock()
 {
+    DB_IdxInvalidateBlock();
+    OFCondition result = EC_Normal;
     if (dcmtk_flock(handle_->pidx, LOCK_UN) < 0) {
         dcmtk_plockerr("DB_unlock");
-        return QR_EC_IndexDatabaseError;
+        result = QR_EC_IndexDatabaseError;
     }
-    return EC_Normal;
+#ifdef WITH_THREADS
+    if (handle_->idxLockHeld) {
+        handle_->idxLock->unlock();
+        handle_->idxLockHeld = OFFalse;
+    }
+#endif
+    return result;
 }
 
 /*******************
@@ -1604,6 +2330,147 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::hierarchicalCompare (
     return QR_EC_IndexDatabaseError;
 }
 
+/********************
+**      Determine the candidate records of a find or move request
+**      by means of the key file (see DB_KeyFile)
+**/
+
+void DcmQueryRetrieveIndexDatabaseHandle::DB_IdxFindCandidates (DB_LEVEL infLevel)
+{
+    DB_ElementList *plist ;
+    DB_ElementList *keys [DB_NUMBER_OF_INDEXED_KEYS] ;
+    DB_LEVEL    XTagLevel = PATIENT_LEVEL ;
+    DB_KEY_CLASS keyClass = OTHER_CLASS ;
+    DcmTagKey   XTag ;
+    int         k ;
+
+    free (handle_ -> idxCandidates) ;
+    handle_ -> idxCandidates = NULL ;
+    handle_ -> idxCandidateCount = 0 ;
+    handle_ -> idxCandidatePos = 0 ;
+
+    /**** hierarchicalCompare() fails if a UID key above the query level
+    **** is missing. In this case, all records have to be compared.
+    ***/
+
+    if (infLevel > handle_ -> queryLevel)
+        return ;
+    for (int level = infLevel ; level < handle_ -> queryLevel ; level++) {
+        DB_GetUIDTag ((DB_LEVEL) level, &XTag) ;
+        for (plist = handle_ -> findRequestList ; plist ; plist = plist -> next)
+            if (plist -> elem. XTag == XTag)
+                break ;
+        if (plist == NULL)
+            return ;
+    }
+
+    /**** Find the indexed keys that hierarchicalCompare() compares with a
+    **** single value (or a list of UIDs), i.e. no universal or wildcard matching
+    ***/
+
+    OFBool found = OFFalse ;
+    for (k = 0 ; k < DB_NUMBER_OF_INDEXED_KEYS ; k++)
+        keys [k] = NULL ;
+    for (plist = handle_ -> findRequestList ; plist ; plist = plist -> next) {
+        for (k = 0 ; k < DB_NUMBER_OF_INDEXED_KEYS ; k++)
+            if (plist -> elem. XTag == DB_IndexedKeyTags [k])
+                break ;
+        if ((k == DB_NUMBER_OF_INDEXED_KEYS) || (plist -> elem. ValueLength == 0) || (plist -> elem. PValueField == NULL))
+            continue ;
+
+        /*** The key has to be compared at the query level, or it is the
+        *** UID key of a level above, or a patient key in the Study Root model
+        **/
+
+        DB_GetTagLevel (plist -> elem. XTag, &XTagLevel) ;
+        DB_GetUIDTag (XTagLevel, &XTag) ;
+        if (! (  (XTagLevel == handle_ -> queryLevel)
+              || ((XTagLevel >= infLevel) && (XTagLevel < handle_ -> queryLevel) && (XTag == plist -> elem. XTag))
+              || ((XTagLevel == PATIENT_LEVEL) && (handle_ -> queryLevel == STUDY_LEVEL) && (infLevel == STUDY_LEVEL))))
+            continue ;
+
+        DB_GetTagKeyClass (plist -> elem. XTag, &keyClass) ;
+        size_t length = DB_KeyLength (plist -> elem. PValueField, plist -> elem. ValueLength) ;
+        if ((keyClass == STRING_CLASS) &&
+            ((memchr (plist -> elem. PValueField, '*', length) != NULL) || (memchr (plist -> elem. PValueField, '?', length) != NULL)))
+            continue ;
+
+        keys [k] = plist ;
+        found = OFTrue ;
+    }
+    if (! found)
+        return ;
+
+    /**** (Re-)create the key file if it does not match the index file.
+    **** We hold the lock on the index file, so nobody modifies it meanwhile.
+    ***/
+
+    DB_KeyFile keyFile (handle_) ;
+    if (! keyFile. open (OFFalse)) {
+        DCMQRDB_DEBUG("DB_IdxFindCandidates () : creating key file for " << handle_ -> indexFilename);
+        if (keyFile. scan (). bad ())
+            return ;
+        keyFile. save () ;
+    }
+
+    /**** Look up each key, use the one with the fewest candidates
+    ***/
+
+    OFVector<int> candidates ;
+    OFVector<int> keyCandidates ;
+    found = OFFalse ;
+    for (k = 0 ; k < DB_NUMBER_OF_INDEXED_KEYS ; k++) {
+        if (keys [k] == NULL)
+            continue ;
+        keyCandidates. clear () ;
+        const char *value = keys [k] -> elem. PValueField ;
+        size_t length = DB_KeyLength (value, keys [k] -> elem. ValueLength) ;
+        DB_GetTagKeyClass (keys [k] -> elem. XTag, &keyClass) ;
+        if (keyClass == UID_CLASS) {
+
+            /*** List of UIDs, see matchUID()
+            **/
+
+            const char *end = value + length ;
+            for (const char *pc = value ; pc <= end ; ) {
+                const char *next = (const char *) memchr (pc, '\\', end - pc) ;
+                if (next == NULL)
+                    next = end ;
+                keyFile. lookup (k, DB_KeyHash (pc, next - pc), keyCandidates) ;
+                pc = next + 1 ;
+            }
+        }
+        else
+            keyFile. lookup (k, DB_KeyHash (value, length), keyCandidates) ;
+        if (! found || (keyCandidates. size () < candidates. size ())) {
+            candidates. swap (keyCandidates) ;
+            found = OFTrue ;
+        }
+    }
+
+    /**** Compare all records if the key file could not be read
+    ***/
+
+    if (keyFile. failed ())
+        return ;
+
+    /**** The candidates are read in the order of the index file
+    ***/
+
+    handle_ -> idxCandidates = (int *) malloc ((candidates. size () + 1) * sizeof (int)) ;
+    if (handle_ -> idxCandidates == NULL)
+        return ;
+    int count = 0 ;
+    if (! candidates. empty ()) {
+        qsort (&candidates [0], candidates. size (), sizeof (int), DB_IdxCompare) ;
+        for (size_t i = 0 ; i < candidates. size () ; i++)
+            if ((i == 0) || (candidates [i] != candidates [i - 1]))
+                handle_ -> idxCandidates [count++] = candidates [i] ;
+    }
+    handle_ -> idxCandidateCount = count ;
+    DCMQRDB_DEBUG("DB_IdxFindCandidates () : " << count << " candidate records");
+}
+
 /********************
 **      Start find in Database
 **/
@@ -1624,6 +2491,14 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
     OFCondition         cond = EC_Normal;
     OFBool qrLevelFound = OFFalse;
 
+    /**** Release the lock of a previous request that has not been completed
+    ***/
+
+    if (handle_->findLockHeld) {
+        handle_->findLockHeld = OFFalse ;
+        DB_unlock();
+    }
+
     /**** Is SOPClassUID supported ?
     ***/
 
@@ -1783,6 +2658,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
     DB_lock(OFFalse);
 
     DB_IdxInitLoop (&(handle_->idxCounter)) ;
+    DB_IdxFindCandidates (qLevel) ;
     MatchFound = OFFalse ;
     cond = EC_Normal ;
 
@@ -1791,7 +2667,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
         /*** Exit loop if read error (or end of file)
         **/
 
-        if (DB_IdxGetNext (&(handle_->idxCounter), &idxRec) != EC_Normal)
+        if (DB_IdxGetNextCandidate (&(handle_->idxCounter), &idxRec) != EC_Normal)
             break ;
 
         /*** Exit loop if error or matching OK
@@ -1804,6 +2680,17 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
             break ;
     }
 
+    /**** The index file is only locked while searching it, i.e. not while
+    **** the responses are sent. The next search continues at idxCounter.
+    **** If the candidates have been looked up in the key file, the lock is
+    **** kept until the last match has been found, since the candidates are
+    **** record numbers that must not be reused meanwhile.
+    ***/
+
+    handle_->findLockHeld = MatchFound && (cond == EC_Normal) && (handle_->idxCandidates != NULL) ;
+    if (! handle_->findLockHeld)
+        DB_unlock();
+
     /**** If an error occurred in Matching function
     ****    return a failed status
     ***/
@@ -1816,9 +2703,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
         DCMQRDB_DEBUG("DB_startFindRequest () : STATUS_FIND_Failed_UnableToProcess");
 #endif
         status->setStatus(STATUS_FIND_Failed_UnableToProcess);
-
-        DB_unlock();
-
         return (cond) ;
     }
 
@@ -1852,9 +2736,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
         DCMQRDB_DEBUG("DB_startFindRequest () : STATUS_Success");
 #endif
         status->setStatus(STATUS_Success);
-
-        DB_unlock();
-
         return (EC_Normal) ;
     }
 
@@ -1882,9 +2763,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
 #endif
         *findResponseIdentifiers = NULL ;
         status->setStatus(STATUS_Success);
-
-        DB_unlock();
-
         return (EC_Normal) ;
     }
 
@@ -1947,9 +2825,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
 #endif
     }
     else {
-
-        DB_unlock();
-
         return (QR_EC_IndexDatabaseError) ;
     }
 
@@ -1971,12 +2846,15 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
     MatchFound = OFFalse ;
     cond = EC_Normal ;
 
+    if (! handle_->findLockHeld)
+        DB_lock(OFFalse);
+
     while (1) {
 
         /*** Exit loop if read error (or end of file)
         **/
 
-        if (DB_IdxGetNext (&(handle_->idxCounter), &idxRec) != EC_Normal)
+        if (DB_IdxGetNextCandidate (&(handle_->idxCounter), &idxRec) != EC_Normal)
             break ;
 
         /*** If Response already found
@@ -1996,6 +2874,13 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
 
     }
 
+    /**** See startFindRequest()
+    ***/
+
+    handle_->findLockHeld = MatchFound && (cond == EC_Normal) && (handle_->idxCandidates != NULL) ;
+    if (! handle_->findLockHeld)
+        DB_unlock();
+
     /**** If an error occured in Matching function
     ****    return status is pending
     ***/
@@ -2008,9 +2893,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
         DCMQRDB_DEBUG("DB_nextFindResponse () : STATUS_FIND_Failed_UnableToProcess");
 #endif
         status->setStatus(STATUS_FIND_Failed_UnableToProcess);
-
-        DB_unlock();
-
         return (cond) ;
     }
 
@@ -2055,6 +2937,10 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
 
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::cancelFindRequest (DcmQueryRetrieveDatabaseStatus *status)
 {
+    if (handle_->findLockHeld) {
+        handle_->findLockHeld = OFFalse ;
+        DB_unlock();
+    }
 
     handle_->idxCounter = -1 ;
     DB_FreeElementList (handle_->findRequestList) ;
@@ -2065,9 +2951,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::cancelFindRequest (DcmQueryRetr
     handle_->uidList = NULL ;
 
     status->setStatus(STATUS_FIND_Cancel_MatchingTerminatedDueToCancelRequest);
-
-    DB_unlock();
-
     return (EC_Normal) ;
 }
 
@@ -2380,18 +3263,21 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startMoveRequest(
     handle_->moveCounterList = NULL ;
     handle_->NumberRemainOperations = 0 ;
 
-    /**** Find matching images
+    /**** Find matching images. The lock replaces the lock of a find
+    **** request that has not been completed.
     ***/
 
+    handle_->findLockHeld = OFFalse ;
     DB_lock(OFFalse);
 
     DB_IdxInitLoop (&(handle_->idxCounter)) ;
+    DB_IdxFindCandidates (qLevel) ;
     while (1) {
 
         /*** Exit loop if read error (or end of file)
         **/
 
-        if (DB_IdxGetNext (&(handle_->idxCounter), &idxRec) != EC_Normal)
+        if (DB_IdxGetNextCandidate (&(handle_->idxCounter), &idxRec) != EC_Normal)
             break ;
 
         /*** If matching found
@@ -2533,6 +3419,12 @@ void DcmQueryRetrieveIndexDatabaseHandle::enableQuotaSystem(OFBool enable)
 }
 
 
+void DcmQueryRetrieveIndexDatabaseHandle::setStopParsingAtElement(const DcmTagKey &tagKey)
+{
+    stopParsingAtElement = tagKey;
+}
+
+
 /*
 ** Image file deleting
 */
@@ -2890,7 +3782,8 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
     ***/
 
     DcmFileFormat dcmff;
-    if (dcmff.loadFile(imageFileName).bad())
+    if (dcmff.loadFileUntilTag(imageFileName, EXS_Unknown, EGL_noChange, DCM_MaxReadLength,
+        ERM_autoDetect, stopParsingAtElement).bad())
     {
       char buf[256];
       DCMQRDB_WARN("DB: Cannot open file: " << imageFileName << ": "
@@ -3271,6 +4164,7 @@ DcmQueryRetrieveIndexDatabaseHandle::DcmQueryRetrieveIndexDatabaseHandle(
     OFCondition& result)
 : handle_(NULL)
 , quotaSystemEnabled(OFTrue)
+, stopParsingAtElement(DCM_UndefinedTagKey)
 , doCheckFindIdentifier(OFFalse)
 , doCheckMoveIdentifier(OFFalse)
 , fnamecreator()
@@ -3329,6 +4223,9 @@ DcmQueryRetrieveIndexDatabaseHandle::DcmQueryRetrieveIndexDatabaseHandle(
            return;
         }
         else {
+#ifdef WITH_THREADS
+            handle_ -> idxLock = DB_indexLockTable.getLock(handle_ -> indexFilename);
+#endif
             handle_ -> idxCounter = -1;
             handle_ -> findRequestList = NULL;
             handle_ -> findResponseList = NULL;
@@ -3361,6 +4258,11 @@ DcmQueryRetrieveIndexDatabaseHandle::~DcmQueryRetrieveIndexDatabaseHandle()
        * and this gives an unnecessary error message on stderr.
        */
       DB_unlock();
+#else
+#ifdef WITH_THREADS
+      /* release the lock within the process in any case */
+      if (handle_ -> idxLockHeld) handle_ -> idxLock -> unlock();
+#endif
 #endif
       close( handle_ -> pidx);
 
@@ -3368,6 +4270,8 @@ DcmQueryRetrieveIndexDatabaseHandle::~DcmQueryRetrieveIndexDatabaseHandle()
       DB_FreeElementList (handle_ -> findRequestList);
       DB_FreeElementList (handle_ -> findResponseList);
       DB_FreeUidList (handle_ -> uidList);
+      free (handle_ -> idxBlock);
+      free (handle_ -> idxCandidates);
 
       delete handle_;
     }
@@ -3416,9 +4320,12 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::instanceReviewed(int idx)
       if (result.bad()) return result;
 
       record.hstat = DVIF_objectIsNotNew;
+      DB_KeyFile keyFile(handle_);
+      keyFile.open(OFTrue);
       DB_lseek(handle_->pidx, OFstatic_cast(long, SIZEOF_STUDYDESC + idx * SIZEOF_IDXRECORD), SEEK_SET);
       write(handle_->pidx, OFreinterpret_cast(char *, &record), SIZEOF_IDXRECORD);
       DB_lseek(handle_->pidx, 0L, SEEK_SET);
+      keyFile.update(-1, NULL);
       DB_unlock();
     }
 
@@ -3426,6 +4333,18 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::instanceReviewed(int idx)
 }
 
 
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::createKeyFile()
+{
+    OFCondition result = DB_lock(OFTrue);
+    if (result.bad()) return result;
+    DB_KeyFile keyFile(handle_);
+    result = keyFile.scan();
+    if (result.good()) result = keyFile.save();
+    DB_unlock();
+    return result;
+}
+
+
 /***********************
  *    Default constructors for struct IdxRecord and DB_SSmallDcmElmt
  */
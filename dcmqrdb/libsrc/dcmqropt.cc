@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2012, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -58,6 +58,7 @@ DcmQueryRetrieveOptions::DcmQueryRetrieveOptions()
 #else
 , singleProcess_(OFTrue)
 #endif
+, multiThreaded_(OFFalse)
 , supportPatientRoot_(OFTrue)
 #ifdef NO_PATIENTSTUDYONLY_SUPPORT
 , supportPatientStudyOnly_(OFFalse)
@@ -1,6 +1,6 @@
 /*
  *
- *  Copyright (C) 1993-2012, OFFIS e.V.
+ *  Copyright (C) 1993-2015, OFFIS e.V.
  *  All rights reserved.  See COPYRIGHT file for details.
  *
  *  This software and supporting documentation were developed by
@@ -30,6 +30,88 @@
 #include "dcmtk/dcmqrdb/dcmqrcbm.h"    /* for class DcmQueryRetrieveMoveContext */
 #include "dcmtk/dcmqrdb/dcmqrcbg.h"    /* for class DcmQueryRetrieveGetContext */
 #include "dcmtk/dcmqrdb/dcmqrcbs.h"    /* for class DcmQueryRetrieveStoreContext */
+#include "dcmtk/ofstd/ofthread.h"
+
+
+#ifdef WITH_THREADS
+
+/** thread that handles a single association in the multi-threaded mode
+ *  of class DcmQueryRetrieveSCP
+ */
+class DcmQueryRetrieveSCPThread: public OFThread
+{
+public:
+
+  /** constructor
+   *  @param scp the SCP object that accepted the association
+   *  @param assoc the association to be handled by this thread
+   *  @param threadID number identifying the thread in the process table
+   */
+  DcmQueryRetrieveSCPThread(DcmQueryRetrieveSCP& scp, T_ASC_Association *assoc, int threadID)
+  : OFThread()
+  , scp_(scp)
+  , assoc_(assoc)
+  , threadID_(threadID)
+  , finished_(OFFalse)
+  {
+  }
+
+  /** get the number identifying the thread in the process table
+   *  @return thread number
+   */
+  int threadID() const
+  {
+    return threadID_;
+  }
+
+  /** check whether the association has been handled completely.
+   *  Must only be called while the process table of the SCP is locked.
+   *  @return OFTrue if the thread is about to terminate, OFFalse otherwise
+   */
+  OFBool finished() const
+  {
+    return finished_;
+  }
+
+  /** mark the thread as finished.
+   *  Must only be called while the process table of the SCP is locked.
+   */
+  void setFinished()
+  {
+    finished_ = OFTrue;
+  }
+
+protected:
+
+  /// thread workload
+  virtual void run()
+  {
+    scp_.handleAssociationInThread(assoc_, threadID_);
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmQueryRetrieveSCPThread(const DcmQueryRetrieveSCPThread& other);
+
+  /// private undefined assignment operator
+  DcmQueryRetrieveSCPThread& operator=(const DcmQueryRetrieveSCPThread& other);
+
+  /// the SCP object that accepted the association
+  DcmQueryRetrieveSCP& scp_;
+
+  /// the association handled by this thread
+  T_ASC_Association *assoc_;
+
+  /// number identifying the thread in the process table
+  int threadID_;
+
+  /// true if the association has been handled completely
+  OFBool finished_;
+};
+
+#endif
+
 
 
 static void findCallback(
@@ -102,11 +184,106 @@ DcmQueryRetrieveSCP::DcmQueryRetrieveSCP(
   const DcmQueryRetrieveDatabaseHandleFactory& factory)
 : config_(&config)
 , processtable_()
+, threadMutex_(NULL)
+, threads_()
+, nextThreadID_(1)
 , dbCheckFindIdentifier_(OFFalse)
 , dbCheckMoveIdentifier_(OFFalse)
 , factory_(factory)
 , options_(options)
 {
+#ifdef WITH_THREADS
+  if (options_.multiThreaded_) threadMutex_ = new OFMutex();
+#endif
+}
+
+
+DcmQueryRetrieveSCP::~DcmQueryRetrieveSCP()
+{
+#ifdef WITH_THREADS
+  /* wait until all associations have been handled */
+  OFListIterator(DcmQueryRetrieveSCPThread *) it = threads_.begin();
+  while (it != threads_.end())
+  {
+    (*it)->join();
+    delete *it;
+    it = threads_.erase(it);
+  }
+  delete threadMutex_;
+#endif
+}
+
+
+OFBool DcmQueryRetrieveSCP::multiThreaded() const
+{
+  return !options_.singleProcess_ && (threadMutex_ != NULL);
+}
+
+
+void DcmQueryRetrieveSCP::lockProcessTable()
+{
+#ifdef WITH_THREADS
+  if (threadMutex_) threadMutex_->lock();
+#endif
+}
+
+
+void DcmQueryRetrieveSCP::unlockProcessTable()
+{
+#ifdef WITH_THREADS
+  if (threadMutex_) threadMutex_->unlock();
+#endif
+}
+
+
+OFCondition DcmQueryRetrieveSCP::startAssociationThread(T_ASC_Association *assoc)
+{
+#ifdef WITH_THREADS
+  lockProcessTable();
+  const int threadID = nextThreadID_++;
+  DcmQueryRetrieveSCPThread *thread = new DcmQueryRetrieveSCPThread(*this, assoc, threadID);
+  /* the thread removes itself from the process table, so add it first */
+  processtable_.addProcessToTable(threadID, assoc);
+  if (thread->start() != 0)
+  {
+    processtable_.removeProcessFromTable(threadID);
+    unlockProcessTable();
+    delete thread;
+    DCMQRDB_ERROR("Cannot create association thread");
+    return EC_IllegalCall;
+  }
+  threads_.push_back(thread);
+  unlockProcessTable();
+  DCMQRDB_DEBUG("Started association thread (" << threadID << ")");
+  return EC_Normal;
+#else
+  (void) assoc;
+  return EC_IllegalCall;
+#endif
+}
+
+
+void DcmQueryRetrieveSCP::handleAssociationInThread(T_ASC_Association *assoc, int threadID)
+{
+#ifdef WITH_THREADS
+  handleAssociation(assoc, options_.correctUIDPadding_);
+
+  /* the thread object is deleted by cleanChildren() or the destructor */
+  lockProcessTable();
+  processtable_.removeProcessFromTable(threadID);
+  for (OFListIterator(DcmQueryRetrieveSCPThread *) it = threads_.begin(); it != threads_.end(); ++it)
+  {
+    if ((*it)->threadID() == threadID)
+    {
+      (*it)->setFinished();
+      break;
+    }
+  }
+  unlockProcessTable();
+#else
+  (void) assoc;
+  (void) threadID;
+#endif
 }
 
 
@@ -894,7 +1071,10 @@ OFCondition DcmQueryRetrieveSCP::negotiateAssociation(T_ASC_Association * assoc)
     {
         if (config_->writableStorageArea(calledAETitle))
         {
-          if (processtable_.haveProcessWithWriteAccess(calledAETitle))
+          lockProcessTable();
+          const OFBool haveWriteAccess = processtable_.haveProcessWithWriteAccess(calledAETitle);
+          unlockProcessTable();
+          if (haveWriteAccess)
           {
             refuseAnyStorageContexts(assoc);
           }
@@ -917,10 +1097,14 @@ OFCondition DcmQueryRetrieveSCP::waitForAssociation(T_ASC_Network * theNet)
     int timeout;
     OFBool go_cleanup = OFFalse;
 
+    lockProcessTable();
+    size_t activeAssociations = processtable_.countChildProcesses();
+    unlockProcessTable();
+
     if (options_.singleProcess_) timeout = 1000;
     else
     {
-      if (processtable_.countChildProcesses() > 0)
+      if (activeAssociations > 0)
       {
         timeout = 1;
       } else {
@@ -999,7 +1183,10 @@ OFCondition DcmQueryRetrieveSCP::waitForAssociation(T_ASC_Network * theNet)
     if (! go_cleanup)
     {
         // too many concurrent associations ??
-        if (processtable_.countChildProcesses() >= OFstatic_cast(size_t, options_.maxAssociations_))
+        lockProcessTable();
+        activeAssociations = processtable_.countChildProcesses();
+        unlockProcessTable();
+        if (activeAssociations >= OFstatic_cast(size_t, options_.maxAssociations_))
         {
             cond = refuseAssociation(&assoc, CTN_TooManyAssociations);
             go_cleanup = OFTrue;
@@ -1034,6 +1221,21 @@ OFCondition DcmQueryRetrieveSCP::waitForAssociation(T_ASC_Network * theNet)
             /* don't spawn a sub-process to handle the association */
             cond = handleAssociation(assoc, options_.correctUIDPadding_);
         }
+        else if (multiThreaded())
+        {
+            /* start a thread to handle the association */
+            cond = startAssociationThread(assoc);
+            if (cond.good())
+            {
+                /* the thread has taken over the association */
+                assoc = NULL;
+            }
+            else
+            {
+                cond = refuseAssociation(&assoc, CTN_CannotFork);
+                go_cleanup = OFTrue;
+            }
+        }
 #ifdef HAVE_FORK
         else
         {
@@ -1065,7 +1267,7 @@ OFCondition DcmQueryRetrieveSCP::waitForAssociation(T_ASC_Network * theNet)
 
     // cleanup code
     OFCondition oldcond = cond;    /* store condition flag for later use */
-    if (!options_.singleProcess_ && (cond != ASC_SHUTDOWNAPPLICATION))
+    if (!options_.singleProcess_ && (cond != ASC_SHUTDOWNAPPLICATION) && (assoc != NULL))
     {
         /* the child will handle the association, we can drop it */
         cond = ASC_dropAssociation(assoc);
@@ -1087,6 +1289,32 @@ OFCondition DcmQueryRetrieveSCP::waitForAssociation(T_ASC_Network * theNet)
 
 void DcmQueryRetrieveSCP::cleanChildren()
 {
+#ifdef WITH_THREADS
+  if (multiThreaded())
+  {
+    /* join all threads that have finished handling their association */
+    OFList<DcmQueryRetrieveSCPThread *> finishedThreads;
+    lockProcessTable();
+    OFListIterator(DcmQueryRetrieveSCPThread *) it = threads_.begin();
+    while (it != threads_.end())
+    {
+      if ((*it)->finished())
+      {
+        finishedThreads.push_back(*it);
+        it = threads_.erase(it);
+      }
+      else ++it;
+    }
+    unlockProcessTable();
+    for (it = finishedThreads.begin(); it != finishedThreads.end(); ++it)
+    {
+      (*it)->join();
+      DCMQRDB_DEBUG("Cleaned up after association thread (" << (*it)->threadID() << ")");
+      delete *it;
+    }
+    return;
+  }
+#endif
   processtable_.cleanChildren();
 }
 
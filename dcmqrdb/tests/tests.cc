@@ -0,0 +1,35 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: main test program
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oftest.h"
+
+OFTEST_REGISTER(dcmqrdb_keyFileFind);
+OFTEST_REGISTER(dcmqrdb_keyFileUpdate);
+OFTEST_REGISTER(dcmqrdb_keyFileMerge);
+OFTEST_REGISTER(dcmqrdb_storeWhileFind);
+
+#ifdef WITH_THREADS
+OFTEST_REGISTER(dcmqrdb_storeWhileFindThreads);
+#endif // WITH_THREADS
+
+OFTEST_MAIN("dcmqrdb")
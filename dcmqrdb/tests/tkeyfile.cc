@@ -0,0 +1,486 @@
+/*
+ *
+ *  Copyright (C) 2015, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the key file and the locking of the database
+ *           index file
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#define INCLUDE_CSTDIO
+#include "dcmtk/ofstd/ofstdinc.h"
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/dcmqrdb/dcmqrdbi.h"
+#include "dcmtk/dcmqrdb/dcmqrdbs.h"
+#include "dcmtk/dcmqrdb/dcmqridx.h"
+#include "dcmtk/dcmnet/dimse.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+
+
+#define UID_ROOT "1.2.276.0.7230010.3.99"
+
+
+/* create the UID of a study, series or image of the given patient */
+static OFString makeUID(int patient, int study, int series = 0, int image = 0)
+{
+    char buf[80];
+    if (series == 0)
+        sprintf(buf, "%s.%d.%d", UID_ROOT, patient, study);
+    else if (image == 0)
+        sprintf(buf, "%s.%d.%d.%d", UID_ROOT, patient, study, series);
+    else
+        sprintf(buf, "%s.%d.%d.%d.%d", UID_ROOT, patient, study, series, image);
+    return buf;
+}
+
+
+/* create an empty storage area, i.e. a directory without index file */
+static OFString createStorageArea(const char *name)
+{
+    OFString dirName(name);
+    OFCHECK(OFStandard::createDirectory(dirName, "").good());
+    OFStandard::deleteFile(dirName + PATH_SEPARATOR + DBINDEXFILE);
+    OFStandard::deleteFile(dirName + PATH_SEPARATOR + DBKEYFILE);
+    return dirName;
+}
+
+
+/* create an image file in the storage area and register it in the index file */
+static void storeImage(DcmQueryRetrieveIndexDatabaseHandle& handle,
+                       const OFString& storageArea,
+                       int patient, int study, int series, int image)
+{
+    char buf[80];
+    sprintf(buf, "PAT%d", patient);
+    const OFString patientID(buf);
+    sprintf(buf, "ACC%d%d", patient, study);
+    const OFString accessionNumber(buf);
+    const OFString sopInstanceUID = makeUID(patient, study, series, image);
+    const OFString filename = storageArea + PATH_SEPARATOR + sopInstanceUID + ".dcm";
+
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    OFCHECK(dataset->putAndInsertString(DCM_SOPClassUID, UID_CTImageStorage).good());
+    OFCHECK(dataset->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID.c_str()).good());
+    OFCHECK(dataset->putAndInsertString(DCM_StudyInstanceUID, makeUID(patient, study).c_str()).good());
+    OFCHECK(dataset->putAndInsertString(DCM_SeriesInstanceUID, makeUID(patient, study, series).c_str()).good());
+    OFCHECK(dataset->putAndInsertString(DCM_PatientID, patientID.c_str()).good());
+    OFCHECK(dataset->putAndInsertString(DCM_PatientName, "Test^Patient").good());
+    OFCHECK(dataset->putAndInsertString(DCM_AccessionNumber, accessionNumber.c_str()).good());
+    OFCHECK(dataset->putAndInsertString(DCM_Modality, "CT").good());
+    OFCHECK(fileformat.saveFile(filename.c_str(), EXS_LittleEndianExplicit).good());
+
+    DcmQueryRetrieveDatabaseStatus status;
+    OFCHECK(handle.storeRequest(UID_CTImageStorage, sopInstanceUID.c_str(), filename.c_str(), &status).good());
+    OFCHECK_EQUAL(status.status(), STATUS_Success);
+}
+
+
+/* perform a query (Study Root) and return the values of the given key
+ * of all responses, separated by backslashes, in the order of the responses
+ */
+static OFString findValues(DcmQueryRetrieveIndexDatabaseHandle& handle,
+                           DcmDataset& query,
+                           const DcmTagKey& returnKey)
+{
+    if (!query.tagExists(returnKey))
+        OFCHECK(query.insertEmptyElement(returnKey).good());
+    OFString result;
+    DcmQueryRetrieveDatabaseStatus status;
+    OFCHECK(handle.startFindRequest(UID_FINDStudyRootQueryRetrieveInformationModel, &query, &status).good());
+    while (DICOM_PENDING_STATUS(status.status()))
+    {
+        DcmDataset *response = NULL;
+        OFCHECK(handle.nextFindResponse(&response, &status).good());
+        if (response != NULL)
+        {
+            OFString value;
+            OFCHECK(response->findAndGetOFStringArray(returnKey, value).good());
+            if (!result.empty())
+                result += '\\';
+            result += value;
+            delete response;
+        }
+    }
+    OFCHECK_EQUAL(status.status(), STATUS_Success);
+    return result;
+}
+
+
+/* perform a query without and with a key file and compare the results with
+ * the expected result, which is also the result of comparing all records
+ */
+static void checkQuery(DcmQueryRetrieveIndexDatabaseHandle& handle,
+                       const OFString& storageArea,
+                       DcmDataset& query,
+                       const DcmTagKey& returnKey,
+                       const OFString& expected)
+{
+    const OFString keyFilename = storageArea + PATH_SEPARATOR + DBKEYFILE;
+    OFStandard::deleteFile(keyFilename);
+    OFCHECK_EQUAL(findValues(handle, query, returnKey), expected);
+    OFCHECK_EQUAL(findValues(handle, query, returnKey), expected);
+}
+
+
+/* create a query with the given level and key */
+static void createQuery(DcmDataset& query,
+                        const char *level,
+                        const DcmTagKey& key,
+                        const OFString& value)
+{
+    query.clear();
+    OFCHECK(query.putAndInsertString(DCM_QueryRetrieveLevel, level).good());
+    OFCHECK(query.putAndInsertString(key, value.c_str()).good());
+}
+
+
+/* delete the image files and the index file of a storage area */
+static void deleteStorageArea(const OFString& storageArea)
+{
+    OFList<OFString> files;
+    OFStandard::searchDirectoryRecursively(storageArea, files, "*.dcm");
+    OFListIterator(OFString) it = files.begin();
+    while (it != files.end())
+        OFStandard::deleteFile(*(it++));
+    OFStandard::deleteFile(storageArea + PATH_SEPARATOR + DBINDEXFILE);
+    OFStandard::deleteFile(storageArea + PATH_SEPARATOR + DBKEYFILE);
+}
+
+
+OFTEST(dcmqrdb_keyFileFind)
+{
+    const OFString storageArea = createStorageArea("tkeyfile1.dir");
+    OFCondition cond;
+    DcmQueryRetrieveIndexDatabaseHandle handle(storageArea.c_str(), DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
+    OFCHECK(cond.good());
+    handle.enableQuotaSystem(OFFalse);
+    int patient, study, series, image;
+    for (patient = 1; patient <= 3; patient++)
+        for (study = 1; study <= 2; study++)
+            for (series = 1; series <= 2; series++)
+                for (image = 1; image <= 3; image++)
+                    storeImage(handle, storageArea, patient, study, series, image);
+
+    DcmDataset query;
+    createQuery(query, "STUDY", DCM_PatientID, "PAT2");
+    checkQuery(handle, storageArea, query, DCM_StudyInstanceUID, makeUID(2, 1) + "\\" + makeUID(2, 2));
+    OFCHECK(OFStandard::fileExists(storageArea + PATH_SEPARATOR + DBKEYFILE));
+
+    createQuery(query, "STUDY", DCM_AccessionNumber, "ACC31");
+    checkQuery(handle, storageArea, query, DCM_StudyInstanceUID, makeUID(3, 1));
+
+    createQuery(query, "STUDY", DCM_PatientID, "PAT9");
+    checkQuery(handle, storageArea, query, DCM_StudyInstanceUID, "");
+
+    // list of UIDs, including an unknown one, in a different order than in the index file
+    createQuery(query, "STUDY", DCM_StudyInstanceUID, makeUID(3, 2) + "\\1.2.3.4\\" + makeUID(1, 1));
+    checkQuery(handle, storageArea, query, DCM_StudyInstanceUID, makeUID(1, 1) + "\\" + makeUID(3, 2));
+
+    // the key file is not used for wildcards, all records are compared
+    createQuery(query, "STUDY", DCM_PatientID, "PAT*");
+    OFString expected;
+    for (patient = 1; patient <= 3; patient++)
+        for (study = 1; study <= 2; study++)
+            expected += (expected.empty() ? "" : "\\") + makeUID(patient, study);
+    checkQuery(handle, storageArea, query, DCM_StudyInstanceUID, expected);
+    createQuery(query, "STUDY", DCM_AccessionNumber, "ACC?2");
+    checkQuery(handle, storageArea, query, DCM_StudyInstanceUID, makeUID(1, 2) + "\\" + makeUID(2, 2) + "\\" + makeUID(3, 2));
+
+    // a wildcard key and a key that is looked up in the key file
+    createQuery(query, "STUDY", DCM_PatientID, "PAT*");
+    OFCHECK(query.putAndInsertString(DCM_AccessionNumber, "ACC22").good());
+    checkQuery(handle, storageArea, query, DCM_StudyInstanceUID, makeUID(2, 2));
+
+    createQuery(query, "SERIES", DCM_StudyInstanceUID, makeUID(1, 2));
+    OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, (makeUID(1, 2, 2) + "\\" + makeUID(1, 2, 1)).c_str()).good());
+    checkQuery(handle, storageArea, query, DCM_SeriesInstanceUID, makeUID(1, 2, 1) + "\\" + makeUID(1, 2, 2));
+
+    // the series does not belong to the study
+    createQuery(query, "SERIES", DCM_StudyInstanceUID, makeUID(1, 2));
+    OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, makeUID(2, 2, 1).c_str()).good());
+    checkQuery(handle, storageArea, query, DCM_SeriesInstanceUID, "");
+
+    createQuery(query, "IMAGE", DCM_StudyInstanceUID, makeUID(2, 2));
+    OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, makeUID(2, 2, 1).c_str()).good());
+    OFCHECK(query.putAndInsertString(DCM_SOPInstanceUID, (makeUID(2, 2, 1, 3) + "\\" + makeUID(2, 2, 1, 1)).c_str()).good());
+    checkQuery(handle, storageArea, query, DCM_SOPInstanceUID, makeUID(2, 2, 1, 1) + "\\" + makeUID(2, 2, 1, 3));
+
+    // all images of a series, found by the series UID
+    createQuery(query, "IMAGE", DCM_StudyInstanceUID, makeUID(3, 1));
+    OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, makeUID(3, 1, 2).c_str()).good());
+    checkQuery(handle, storageArea, query, DCM_SOPInstanceUID,
+        makeUID(3, 1, 2, 1) + "\\" + makeUID(3, 1, 2, 2) + "\\" + makeUID(3, 1, 2, 3));
+
+    deleteStorageArea(storageArea);
+}
+
+
+OFTEST(dcmqrdb_keyFileUpdate)
+{
+    const OFString storageArea = createStorageArea("tkeyfile2.dir");
+    const OFString keyFilename = storageArea + PATH_SEPARATOR + DBKEYFILE;
+    OFCondition cond;
+    DcmQueryRetrieveIndexDatabaseHandle handle(storageArea.c_str(), DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
+    OFCHECK(cond.good());
+    handle.enableQuotaSystem(OFFalse);
+    int image;
+    for (image = 1; image <= 4; image++)
+        storeImage(handle, storageArea, 1, 1, 1, image);
+    OFCHECK(handle.createKeyFile().good());
+    OFCHECK(OFStandard::fileExists(keyFilename));
+
+    // images added after the key file has been created
+    storeImage(handle, storageArea, 2, 1, 1, 1);
+    storeImage(handle, storageArea, 1, 1, 1, 5);
+    DcmDataset query;
+    createQuery(query, "IMAGE", DCM_StudyInstanceUID, makeUID(1, 1));
+    OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, makeUID(1, 1, 1).c_str()).good());
+    OFString expected;
+    for (image = 1; image <= 5; image++)
+        expected += (expected.empty() ? "" : "\\") + makeUID(1, 1, 1, image);
+    OFCHECK_EQUAL(findValues(handle, query, DCM_SOPInstanceUID), expected);
+    createQuery(query, "STUDY", DCM_PatientID, "PAT2");
+    OFCHECK_EQUAL(findValues(handle, query, DCM_StudyInstanceUID), makeUID(2, 1));
+
+    // a key file that does not match the index file (e.g. modified by an older version)
+    OFFile file;
+    OFCHECK(file.fopen(keyFilename, "rb"));
+    char buffer[4096];
+    const size_t length = file.fread(buffer, 1, sizeof(buffer));
+    OFCHECK(length < sizeof(buffer));
+    file.fclose();
+    storeImage(handle, storageArea, 3, 1, 1, 1);
+    OFCHECK(file.fopen(keyFilename, "wb"));
+    OFCHECK_EQUAL(file.fwrite(buffer, 1, length), length);
+    file.fclose();
+    createQuery(query, "STUDY", DCM_PatientID, "PAT3");
+    OFCHECK_EQUAL(findValues(handle, query, DCM_StudyInstanceUID), makeUID(3, 1));
+
+    // a truncated key file
+    OFCHECK(file.fopen(keyFilename, "wb"));
+    OFCHECK_EQUAL(file.fwrite(buffer, 1, length - 10), length - 10);
+    file.fclose();
+    OFCHECK_EQUAL(findValues(handle, query, DCM_StudyInstanceUID), makeUID(3, 1));
+
+    // removed records, the free record is used again for another patient
+    OFCHECK(OFStandard::deleteFile(storageArea + PATH_SEPARATOR + makeUID(2, 1, 1, 1) + ".dcm"));
+    OFCHECK(handle.pruneInvalidRecords().good());
+    createQuery(query, "STUDY", DCM_PatientID, "PAT2");
+    OFCHECK_EQUAL(findValues(handle, query, DCM_StudyInstanceUID), "");
+    storeImage(handle, storageArea, 4, 1, 1, 1);
+    OFCHECK_EQUAL(findValues(handle, query, DCM_StudyInstanceUID), "");
+    createQuery(query, "STUDY", DCM_PatientID, "PAT4");
+    OFCHECK_EQUAL(findValues(handle, query, DCM_StudyInstanceUID), makeUID(4, 1));
+
+    // a duplicate image replaces the previous record
+    storeImage(handle, storageArea, 4, 1, 1, 1);
+    createQuery(query, "IMAGE", DCM_StudyInstanceUID, makeUID(4, 1));
+    OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, makeUID(4, 1, 1).c_str()).good());
+    OFCHECK_EQUAL(findValues(handle, query, DCM_SOPInstanceUID), makeUID(4, 1, 1, 1));
+
+    deleteStorageArea(storageArea);
+}
+
+
+OFTEST(dcmqrdb_keyFileMerge)
+{
+    const OFString storageArea = createStorageArea("tkeyfile3.dir");
+    OFCondition cond;
+    DcmQueryRetrieveIndexDatabaseHandle handle(storageArea.c_str(), DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
+    OFCHECK(cond.good());
+    handle.enableQuotaSystem(OFFalse);
+    OFCHECK(handle.createKeyFile().good());
+    const size_t emptySize = OFStandard::getFileSize(storageArea + PATH_SEPARATOR + DBKEYFILE);
+
+    // more images than fit into the unsorted part of the key file
+    const int count = 1100;
+    int image;
+    for (image = 1; image <= count; image++)
+        storeImage(handle, storageArea, image % 7 + 1, image % 3 + 1, 1, image);
+    OFCHECK(OFStandard::getFileSize(storageArea + PATH_SEPARATOR + DBKEYFILE) > emptySize);
+
+    DcmDataset query;
+    for (int patient = 1; patient <= 7; patient++)
+    {
+        for (int study = 1; study <= 3; study++)
+        {
+            OFString expected;
+            for (image = 1; image <= count; image++)
+            {
+                if ((image % 7 + 1 == patient) && (image % 3 + 1 == study))
+                    expected += (expected.empty() ? "" : "\\") + makeUID(patient, study, 1, image);
+            }
+            createQuery(query, "IMAGE", DCM_StudyInstanceUID, makeUID(patient, study));
+            OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, makeUID(patient, study, 1).c_str()).good());
+            OFCHECK_EQUAL(findValues(handle, query, DCM_SOPInstanceUID), expected);
+        }
+    }
+
+    deleteStorageArea(storageArea);
+}
+
+
+OFTEST(dcmqrdb_storeWhileFind)
+{
+    const OFString storageArea = createStorageArea("tkeyfile4.dir");
+    OFCondition cond;
+    DcmQueryRetrieveIndexDatabaseHandle findHandle(storageArea.c_str(), DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
+    OFCHECK(cond.good());
+    DcmQueryRetrieveIndexDatabaseHandle storeHandle(storageArea.c_str(), DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
+    OFCHECK(cond.good());
+    storeHandle.enableQuotaSystem(OFFalse);
+    storeImage(storeHandle, storageArea, 1, 1, 1, 1);
+    storeImage(storeHandle, storageArea, 2, 1, 1, 1);
+
+    // a query with wildcards does not lock the index file while the responses
+    // are sent, so another handle can store an image in the meantime, which is
+    // found by the running query
+    DcmDataset query;
+    createQuery(query, "STUDY", DCM_PatientID, "PAT*");
+    OFCHECK(query.insertEmptyElement(DCM_StudyInstanceUID).good());
+    DcmQueryRetrieveDatabaseStatus status;
+    OFCHECK(findHandle.startFindRequest(UID_FINDStudyRootQueryRetrieveInformationModel, &query, &status).good());
+    OFCHECK_EQUAL(status.status(), STATUS_Pending);
+    storeImage(storeHandle, storageArea, 3, 1, 1, 1);
+    int responses = 0;
+    while (DICOM_PENDING_STATUS(status.status()))
+    {
+        DcmDataset *response = NULL;
+        OFCHECK(findHandle.nextFindResponse(&response, &status).good());
+        if (response != NULL)
+            ++responses;
+        delete response;
+    }
+    OFCHECK_EQUAL(responses, 3);
+
+    // a query that uses the key file releases its lock when it is cancelled
+    createQuery(query, "STUDY", DCM_PatientID, "PAT1");
+    OFCHECK(query.insertEmptyElement(DCM_StudyInstanceUID).good());
+    OFCHECK(findHandle.startFindRequest(UID_FINDStudyRootQueryRetrieveInformationModel, &query, &status).good());
+    OFCHECK_EQUAL(status.status(), STATUS_Pending);
+    OFCHECK(findHandle.cancelFindRequest(&status).good());
+    storeImage(storeHandle, storageArea, 4, 1, 1, 1);
+
+    deleteStorageArea(storageArea);
+}
+
+
+#ifdef WITH_THREADS
+
+/* thread that stores an image through its own database handle */
+class StoreThread : public OFThread
+{
+public:
+    StoreThread(DcmQueryRetrieveIndexDatabaseHandle& handle, const OFString& storageArea)
+    : OFThread()
+    , handle_(handle)
+    , storageArea_(storageArea)
+    , mutex_()
+    , done_(OFFalse)
+    {
+    }
+
+    OFBool done()
+    {
+        mutex_.lock();
+        const OFBool result = done_;
+        mutex_.unlock();
+        return result;
+    }
+
+protected:
+    virtual void run()
+    {
+        storeImage(handle_, storageArea_, 1, 1, 2, 1);
+        mutex_.lock();
+        done_ = OFTrue;
+        mutex_.unlock();
+    }
+
+private:
+    DcmQueryRetrieveIndexDatabaseHandle& handle_;
+    OFString storageArea_;
+    OFMutex mutex_;
+    OFBool done_;
+};
+
+
+OFTEST(dcmqrdb_storeWhileFindThreads)
+{
+    const OFString storageArea = createStorageArea("tkeyfile5.dir");
+    OFCondition cond;
+    DcmQueryRetrieveIndexDatabaseHandle findHandle(storageArea.c_str(), DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
+    OFCHECK(cond.good());
+    DcmQueryRetrieveIndexDatabaseHandle storeHandle(storageArea.c_str(), DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
+    OFCHECK(cond.good());
+    storeHandle.enableQuotaSystem(OFFalse);
+    int image;
+    for (image = 1; image <= 3; image++)
+        storeImage(storeHandle, storageArea, 1, 1, 1, image);
+    // the record of this image is free again
+    storeImage(storeHandle, storageArea, 2, 1, 1, 1);
+    OFCHECK(OFStandard::deleteFile(storageArea + PATH_SEPARATOR + makeUID(2, 1, 1, 1) + ".dcm"));
+    OFCHECK(storeHandle.pruneInvalidRecords().good());
+
+    // a query that uses the key file keeps its shared lock until the last
+    // match has been found, so storing an image in another thread has to wait
+    DcmDataset query;
+    createQuery(query, "SERIES", DCM_StudyInstanceUID, makeUID(1, 1));
+    OFCHECK(query.insertEmptyElement(DCM_SeriesInstanceUID).good());
+    DcmQueryRetrieveDatabaseStatus status;
+    OFCHECK(findHandle.startFindRequest(UID_FINDStudyRootQueryRetrieveInformationModel, &query, &status).good());
+    OFCHECK_EQUAL(status.status(), STATUS_Pending);
+    StoreThread thread(storeHandle, storageArea);
+    OFCHECK_EQUAL(thread.start(), 0);
+    OFStandard::milliSleep(200);
+    OFCHECK(!thread.done());
+    OFString result;
+    while (DICOM_PENDING_STATUS(status.status()))
+    {
+        DcmDataset *response = NULL;
+        OFCHECK(findHandle.nextFindResponse(&response, &status).good());
+        if (response != NULL)
+        {
+            OFString value;
+            OFCHECK(response->findAndGetOFString(DCM_SeriesInstanceUID, value).good());
+            result += (result.empty() ? "" : "\\") + value;
+            delete response;
+        }
+        OFCHECK(!thread.done());
+    }
+    // the new series has not been found by the running query
+    OFCHECK_EQUAL(result, makeUID(1, 1, 1));
+    OFCHECK_EQUAL(thread.join(), 0);
+    OFCHECK(thread.done());
+
+    // but by the next one
+    createQuery(query, "SERIES", DCM_StudyInstanceUID, makeUID(1, 1));
+    OFCHECK_EQUAL(findValues(findHandle, query, DCM_SeriesInstanceUID), makeUID(1, 1, 1) + "\\" + makeUID(1, 1, 2));
+
+    deleteStorageArea(storageArea);
+}
+
+#endif
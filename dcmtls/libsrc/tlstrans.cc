@@ -254,31 +254,12 @@ OFBool DcmTLSConnection::networkDataAvailable(int timeout)
 {
   /* this is an approximation since SSL_pending does not support
    * waiting with a timeout. We first check SSL_pending and then
-   * perform a conventional select().
+   * wait until the socket becomes readable.
    */
   if (tlsConnection == NULL) return OFFalse;
   if (SSL_pending(tlsConnection)) return OFTrue;
 
-  struct timeval t;
-  fd_set fdset;
-  int nfound;
-
-  FD_ZERO(&fdset);
-  FD_SET(getSocket(), &fdset);
-  t.tv_sec = timeout;
-  t.tv_usec = 0;
-
-#ifdef HAVE_INTP_SELECT
-  nfound = select(getSocket() + 1, (int *)(&fdset), NULL, NULL, &t);
-#else
-  nfound = select(getSocket() + 1, &fdset, NULL, NULL, &t);
-#endif
-  if (nfound <= 0) return OFFalse;
-  else
-  {
-    if (FD_ISSET(getSocket(), &fdset)) return OFTrue;
-    else return OFFalse;  /* This should not really happen */
-  }
+  return isSocketReadable(getSocket(), timeout);
 }
 
 OFBool DcmTLSConnection::isTransparentConnection()